@@ -42,6 +42,15 @@ if(PLATFORM EQUAL 32)
 endif()
 message(STATUS "GCC: SFMT enabled, SSE2 flags forced")
 
+if(WITH_AVX2)
+	target_compile_options(typhoon-compile-option-interface
+		INTERFACE
+			-mavx2
+			-mbmi2
+		)
+	message(STATUS "GCC: AVX2 and BMI2 flags enabled")
+endif()
+
 if(WITH_WARNINGS)
 	target_compile_options(typhoon-warning-interface
 		INTERFACE
@@ -71,6 +71,14 @@ else()
   message(STATUS "MSVC: Disabled Safe Exception Handlers for debug builds")
 endif()
 
+if(WITH_AVX2)
+  target_compile_options(typhoon-compile-option-interface
+    INTERFACE
+      /arch:AVX2
+  	)
+  message(STATUS "MSVC: Enabled AVX2 support")
+endif()
+
 # Set build-directive (used in core to tell which buildtype we used)
 # msbuild/devenv don't set CMAKE_MAKE_PROGRAM, you can choose build type from a 
 # dropdown after generating projects
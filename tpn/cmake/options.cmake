@@ -107,6 +107,9 @@ if(WITH_SSL)
 	add_definitions(-DTPN_USE_SSL)
 endif()
 
+# avx2
+option(WITH_AVX2 "Enable AVX2 and BMI2 codecs" OFF)
+
 # unicode
 option(WITH_UNICODE "Enable utf-8" ON)
 if(WITH_UNICODE)
@@ -165,6 +165,13 @@ else()
   message(STATUS "Use ssl in network                                 : OFF (default)")
 endif()
 
+# avx2
+if(WITH_AVX2)
+  message(STATUS "Use avx2 and bmi2 codecs                           : ON")
+else()
+  message(STATUS "Use avx2 and bmi2 codecs                           : OFF (default)")
+endif()
+
 # unicode
 if(WITH_UNICODE)
   message(STATUS "Use unicode                                        : ON (default)")
@@ -32,6 +32,13 @@ namespace aoi {
 class AOINode;
 class AOIMgr;
 
+struct EntitySnapshot;
+struct SnapshotView;
+class SnapshotFrame;
+class SnapshotWatcher;
+class SnapshotEncoder;
+class SnapshotDecoder;
+
 }  // namespace aoi
 
 }  // namespace tpn
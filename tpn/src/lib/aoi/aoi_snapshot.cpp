@@ -0,0 +1,425 @@
+//
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "aoi_snapshot.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+#include "debug_hub.h"
+
+namespace tpn {
+
+namespace aoi {
+
+namespace {
+
+constexpr uint8_t ToMask(SnapshotField field) {
+  return static_cast<uint8_t>(field);
+}
+
+constexpr uint8_t kFieldX      = ToMask(SnapshotField::kSnapshotFieldX);
+constexpr uint8_t kFieldY      = ToMask(SnapshotField::kSnapshotFieldY);
+constexpr uint8_t kFieldZ      = ToMask(SnapshotField::kSnapshotFieldZ);
+constexpr uint8_t kFieldYaw    = ToMask(SnapshotField::kSnapshotFieldYaw);
+constexpr uint8_t kFieldState  = ToMask(SnapshotField::kSnapshotFieldState);
+constexpr uint8_t kFieldHp     = ToMask(SnapshotField::kSnapshotFieldHp);
+constexpr uint8_t kFieldRemove = ToMask(SnapshotField::kSnapshotFieldRemove);
+constexpr uint8_t kFieldFull   = ToMask(SnapshotField::kSnapshotFieldFull);
+constexpr uint8_t kFieldValues = ToMask(SnapshotField::kSnapshotFieldValues);
+
+/// 偏航角量化的单位数
+constexpr double kYawUnits = 65536.0;
+
+int32_t QuantizePosition(float v) {
+  double q = std::nearbyint(static_cast<double>(v) * kSnapshotPositionScale);
+  q        = std::clamp(q, double(std::numeric_limits<int32_t>::min()),
+                        double(std::numeric_limits<int32_t>::max()));
+  return static_cast<int32_t>(q);
+}
+
+uint16_t QuantizeYaw(float yaw) {
+  double turns = static_cast<double>(yaw) / (2.0 * std::numbers::pi);
+  turns -= std::floor(turns);
+  return static_cast<uint16_t>(std::lround(turns * kYawUnits) & 0xFFFF);
+}
+
+/// 回绕减法，避免有符号溢出
+int32_t WrapSub(int32_t a, int32_t b) {
+  return static_cast<int32_t>(static_cast<uint32_t>(a) -
+                              static_cast<uint32_t>(b));
+}
+
+/// 回绕加法，避免有符号溢出
+int32_t WrapAdd(int32_t a, int32_t b) {
+  return static_cast<int32_t>(static_cast<uint32_t>(a) +
+                              static_cast<uint32_t>(b));
+}
+
+/// 小的正负差值映射为小的无符号数，packed编码只写非零字节
+uint64_t ZigZag(int32_t v) {
+  return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+}
+
+int32_t UnZigZag(uint64_t v) {
+  uint32_t u = static_cast<uint32_t>(v);
+  return static_cast<int32_t>((u >> 1) ^ (0u - (u & 1)));
+}
+
+/// 按字段位从低到高应用一条记录的字段值
+///  @param[in,out]   curr      基准快照，输出为还原后的快照
+///  @param[in]       mask      字段掩码
+///  @param[in,out]   value     当前字段值，输出为下一条记录的字段值
+void ApplyRecord(EntitySnapshot &curr, uint8_t mask, const uint64_t *&value) {
+  if (mask & kFieldX) {
+    curr.x = WrapAdd(curr.x, UnZigZag(*value++));
+  }
+  if (mask & kFieldY) {
+    curr.y = WrapAdd(curr.y, UnZigZag(*value++));
+  }
+  if (mask & kFieldZ) {
+    curr.z = WrapAdd(curr.z, UnZigZag(*value++));
+  }
+  if (mask & kFieldYaw) {
+    curr.yaw = static_cast<uint16_t>(curr.yaw + UnZigZag(*value++));
+  }
+  if (mask & kFieldState) {
+    curr.state ^= static_cast<uint32_t>(*value++);
+  }
+  if (mask & kFieldHp) {
+    curr.hp = static_cast<uint32_t>(
+        WrapAdd(static_cast<int32_t>(curr.hp), UnZigZag(*value++)));
+  }
+}
+
+bool LessGuid(const EntitySnapshot &left, const EntitySnapshot &right) {
+  return left.guid < right.guid;
+}
+
+}  // namespace
+
+EntitySnapshot EntitySnapshot::Quantize(uint64_t guid, const Position3D &pos,
+                                        const Direction3D &dir,
+                                        uint32_t state, uint32_t hp) {
+  EntitySnapshot snapshot;
+  snapshot.guid  = guid;
+  snapshot.x     = QuantizePosition(pos.x);
+  snapshot.y     = QuantizePosition(pos.y);
+  snapshot.z     = QuantizePosition(pos.z);
+  snapshot.yaw   = QuantizeYaw(dir.GetYaw());
+  snapshot.state = state;
+  snapshot.hp    = hp;
+  return snapshot;
+}
+
+Position3D EntitySnapshot::GetPosition() const {
+  return Position3D(static_cast<float>(x / kSnapshotPositionScale),
+                    static_cast<float>(y / kSnapshotPositionScale),
+                    static_cast<float>(z / kSnapshotPositionScale));
+}
+
+float EntitySnapshot::GetYaw() const {
+  return static_cast<float>(yaw * (2.0 * std::numbers::pi / kYawUnits));
+}
+
+uint8_t EntitySnapshot::GetChangedFields(const EntitySnapshot &base) const {
+  uint8_t mask = 0;
+  mask |= x != base.x ? kFieldX : 0;
+  mask |= y != base.y ? kFieldY : 0;
+  mask |= z != base.z ? kFieldZ : 0;
+  mask |= yaw != base.yaw ? kFieldYaw : 0;
+  mask |= state != base.state ? kFieldState : 0;
+  mask |= hp != base.hp ? kFieldHp : 0;
+  return mask;
+}
+
+void SnapshotFrame::Reset(uint32_t tick) {
+  TPN_ASSERT(kSnapshotNoBaseline != tick, "snapshot tick must start from 1");
+  tick_ = tick;
+  entities_.clear();
+}
+
+uint32_t SnapshotFrame::Add(uint64_t guid, const Position3D &pos,
+                            const Direction3D &dir, uint32_t state,
+                            uint32_t hp) {
+  entities_.emplace_back(EntitySnapshot::Quantize(guid, pos, dir, state, hp));
+  return static_cast<uint32_t>(entities_.size() - 1);
+}
+
+SnapshotWatcher::SnapshotWatcher(size_t history_size)
+    : history_(std::max<size_t>(history_size, 2)) {}
+
+bool SnapshotWatcher::Ack(uint32_t tick) {
+  if (kSnapshotNoBaseline == tick) {
+    return false;
+  }
+
+  // 乱序到达的旧确认不能让基准回退
+  if (has_baseline_ && tick <= history_[baseline_].tick) {
+    return false;
+  }
+
+  for (size_t i = 0; i < history_.size(); ++i) {
+    if (history_[i].tick == tick) {
+      baseline_     = i;
+      has_baseline_ = true;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void SnapshotWatcher::Reset() {
+  has_baseline_ = false;
+  // 之前发送的帧客户端可能已经没有了，迟到的确认不能再作为基准
+  for (auto &view : history_) {
+    view.tick = kSnapshotNoBaseline;
+  }
+}
+
+uint32_t SnapshotWatcher::GetBaselineTick() const {
+  return has_baseline_ ? history_[baseline_].tick : kSnapshotNoBaseline;
+}
+
+const SnapshotView *SnapshotWatcher::GetBaseline() const {
+  return has_baseline_ ? &history_[baseline_] : nullptr;
+}
+
+SnapshotView &SnapshotWatcher::NextView(uint32_t tick) {
+  if (has_baseline_ && baseline_ == next_) {
+    has_baseline_ = false;
+  }
+
+  SnapshotView &view = history_[next_];
+  view.tick          = tick;
+  next_              = (next_ + 1) % history_.size();
+  return view;
+}
+
+void SnapshotEncoder::Encode(const SnapshotFrame &frame,
+                             SnapshotWatcher &watcher, ByteBuffer &buffer) {
+  SnapshotView &view         = watcher.NextView(frame.GetTick());
+  const SnapshotView *base   = watcher.GetBaseline();
+  const auto &frame_entities = frame.GetEntities();
+
+  view.entities.clear();
+  for (uint32_t index : watcher.GetVisible()) {
+    view.entities.emplace_back(frame_entities[index]);
+  }
+  if (!std::is_sorted(view.entities.begin(), view.entities.end(), LessGuid)) {
+    std::sort(view.entities.begin(), view.entities.end(), LessGuid);
+  }
+
+  guids_.clear();
+  masks_.clear();
+  values_.clear();
+
+  // 按guid归并基准视图和当前视图
+  // 新进入视野的实体相对零值快照写全量记录
+  EntitySnapshot zero;
+  const EntitySnapshot *curr_iter = view.entities.data();
+  const EntitySnapshot *curr_end  = curr_iter + view.entities.size();
+  const EntitySnapshot *base_iter = nullptr;
+  const EntitySnapshot *base_end  = nullptr;
+  if (nullptr != base) {
+    base_iter = base->entities.data();
+    base_end  = base_iter + base->entities.size();
+  }
+  while (curr_iter != curr_end || base_iter != base_end) {
+    if (curr_iter == curr_end ||
+        (base_iter != base_end && base_iter->guid < curr_iter->guid)) {
+      AddRecord(*base_iter, *base_iter, kFieldRemove);
+      ++base_iter;
+    } else if (base_iter == base_end || curr_iter->guid < base_iter->guid) {
+      zero.guid = curr_iter->guid;
+      AddRecord(zero, *curr_iter,
+                kFieldFull | curr_iter->GetChangedFields(zero));
+      ++curr_iter;
+    } else {
+      uint8_t mask = curr_iter->GetChangedFields(*base_iter);
+      if (mask) {
+        AddRecord(*base_iter, *curr_iter, mask);
+      }
+      ++base_iter;
+      ++curr_iter;
+    }
+  }
+
+  // guid升序排列，写差值
+  for (size_t i = guids_.size(); i > 1; --i) {
+    guids_[i - 1] -= guids_[i - 2];
+  }
+
+  buffer << frame.GetTick();
+  buffer << (nullptr != base ? base->tick : kSnapshotNoBaseline);
+  buffer << static_cast<uint32_t>(guids_.size());
+  if (!guids_.empty()) {
+    buffer.AppendPackedUInt64(guids_.data(), guids_.size());
+    buffer.Append(masks_.data(), masks_.size());
+  }
+  if (!values_.empty()) {
+    buffer.AppendPackedUInt64(values_.data(), values_.size());
+  }
+}
+
+void SnapshotEncoder::EncodeBatch(const SnapshotFrame &frame,
+                                  SnapshotWatcher *watchers,
+                                  ByteBuffer *buffers, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    Encode(frame, watchers[i], buffers[i]);
+  }
+}
+
+void SnapshotEncoder::AddRecord(const EntitySnapshot &base,
+                                const EntitySnapshot &curr, uint8_t mask) {
+  guids_.emplace_back(curr.guid);
+  masks_.emplace_back(mask);
+  if (mask & kFieldX) {
+    values_.emplace_back(ZigZag(WrapSub(curr.x, base.x)));
+  }
+  if (mask & kFieldY) {
+    values_.emplace_back(ZigZag(WrapSub(curr.y, base.y)));
+  }
+  if (mask & kFieldZ) {
+    values_.emplace_back(ZigZag(WrapSub(curr.z, base.z)));
+  }
+  if (mask & kFieldYaw) {
+    // 沿最短方向旋转
+    uint16_t turn = static_cast<uint16_t>(curr.yaw - base.yaw);
+    values_.emplace_back(ZigZag(static_cast<int16_t>(turn)));
+  }
+  if (mask & kFieldState) {
+    values_.emplace_back(curr.state ^ base.state);
+  }
+  if (mask & kFieldHp) {
+    values_.emplace_back(ZigZag(WrapSub(static_cast<int32_t>(curr.hp),
+                                        static_cast<int32_t>(base.hp))));
+  }
+}
+
+SnapshotDecoder::SnapshotDecoder(size_t history_size)
+    : history_(std::max<size_t>(history_size, 2)) {}
+
+bool SnapshotDecoder::Decode(ByteBuffer &buffer) {
+  uint32_t tick      = 0;
+  uint32_t base_tick = 0;
+  uint32_t count     = 0;
+  buffer >> tick >> base_tick >> count;
+
+  const SnapshotView *base = nullptr;
+  if (kSnapshotNoBaseline != base_tick) {
+    base = FindView(base_tick);
+    if (nullptr == base) {
+      return false;
+    }
+  }
+
+  guids_.resize(count);
+  masks_.resize(count);
+  size_t value_count = 0;
+  if (0 != count) {
+    buffer.ReadPackedUInt64(guids_.data(), count);
+    buffer.Read(masks_.data(), count);
+    for (size_t i = 1; i < count; ++i) {
+      if (0 == guids_[i]) {
+        return false;
+      }
+      guids_[i] += guids_[i - 1];
+    }
+    for (uint8_t mask : masks_) {
+      value_count += std::popcount(static_cast<uint8_t>(mask & kFieldValues));
+    }
+  }
+  values_.resize(value_count);
+  if (0 != value_count) {
+    buffer.ReadPackedUInt64(values_.data(), value_count);
+  }
+
+  // 按guid归并基准视图和记录
+  decoded_.clear();
+  const EntitySnapshot *base_iter = nullptr;
+  const EntitySnapshot *base_end  = nullptr;
+  if (nullptr != base) {
+    base_iter = base->entities.data();
+    base_end  = base_iter + base->entities.size();
+  }
+  const uint64_t *value = values_.data();
+  for (size_t i = 0; i < count; ++i) {
+    uint64_t guid = guids_[i];
+    uint8_t mask  = masks_[i];
+    while (base_iter != base_end && base_iter->guid < guid) {
+      decoded_.emplace_back(*base_iter++);
+    }
+
+    bool found = base_iter != base_end && base_iter->guid == guid;
+    if (mask & kFieldRemove) {
+      if (!found) {
+        return false;
+      }
+      ++base_iter;
+      continue;
+    }
+
+    EntitySnapshot curr;
+    if (mask & kFieldFull) {
+      curr.guid = guid;
+      if (found) {
+        ++base_iter;
+      }
+    } else {
+      if (!found) {
+        return false;
+      }
+      curr = *base_iter++;
+    }
+    ApplyRecord(curr, mask, value);
+    decoded_.emplace_back(curr);
+  }
+  while (base_iter != base_end) {
+    decoded_.emplace_back(*base_iter++);
+  }
+
+  SnapshotView &view = history_[next_];
+  view.tick          = tick;
+  view.entities.swap(decoded_);
+  last_ = next_;
+  next_ = (next_ + 1) % history_.size();
+  return true;
+}
+
+const SnapshotView *SnapshotDecoder::FindView(uint32_t tick) const {
+  for (const auto &view : history_) {
+    if (view.tick == tick) {
+      return &view;
+    }
+  }
+
+  return nullptr;
+}
+
+}  // namespace aoi
+
+}  // namespace tpn
@@ -0,0 +1,259 @@
+//
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_AOI_AOI_SNAPSHOT_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_AOI_AOI_SNAPSHOT_H_
+
+#include <vector>
+
+#include "aoi_fwd.h"
+#include "byte_buffer.h"
+#include "g3d_wrap.h"
+
+namespace tpn {
+
+namespace aoi {
+
+/// 位置量化倍数，精度为1/64单位
+constexpr float kSnapshotPositionScale = 64.0f;
+/// 观察者保留的历史快照帧数，超过这个帧数未确认则退回全量同步
+constexpr size_t kSnapshotHistorySize = 32;
+/// 无基准快照的帧号，帧号必须从1开始
+constexpr uint32_t kSnapshotNoBaseline = 0;
+
+/// 快照字段标志
+/// 每条实体记录以一个字节的掩码标记其后跟随的字段
+enum class SnapshotField : uint8_t {
+  kSnapshotFieldNone   = 0x0,         ///< 无变化
+  kSnapshotFieldX      = 0x1,         ///< x坐标
+  kSnapshotFieldY      = (0x1 << 1),  ///< y坐标
+  kSnapshotFieldZ      = (0x1 << 2),  ///< z坐标
+  kSnapshotFieldYaw    = (0x1 << 3),  ///< 偏航角
+  kSnapshotFieldState  = (0x1 << 4),  ///< 状态标志
+  kSnapshotFieldHp     = (0x1 << 5),  ///< 血量
+  kSnapshotFieldRemove = (0x1 << 6),  ///< 离开视野
+  kSnapshotFieldFull   = (0x1 << 7),  ///< 全量记录(基准为零值快照)
+  kSnapshotFieldValues = 0x3F,        ///< 所有携带数值的字段
+};
+
+/// 量化后的实体快照
+/// 差分和比较都在量化值上进行，客户端还原的结果与服务器完全一致
+struct EntitySnapshot {
+  /// 量化实体状态
+  ///  @param[in]   guid      实体guid
+  ///  @param[in]   pos       实体位置
+  ///  @param[in]   dir       实体方向，只同步偏航角
+  ///  @param[in]   state     状态标志
+  ///  @param[in]   hp        血量
+  ///  @return 量化后的快照
+  static EntitySnapshot Quantize(uint64_t guid, const Position3D &pos,
+                                 const Direction3D &dir, uint32_t state,
+                                 uint32_t hp);
+
+  /// 获取还原后的位置
+  ///  @return 还原后的位置
+  Position3D GetPosition() const;
+  /// 获取还原后的偏航角(弧度，范围[0, 2pi))
+  ///  @return 还原后的偏航角
+  float GetYaw() const;
+
+  /// 获取相对基准快照发生变化的字段
+  ///  @param[in]   base      基准快照
+  ///  @return 变化字段的掩码
+  uint8_t GetChangedFields(const EntitySnapshot &base) const;
+
+  bool operator==(const EntitySnapshot &other) const = default;
+
+  uint64_t guid{0};   ///< 实体guid
+  int32_t x{0};       ///< 量化x坐标
+  int32_t y{0};       ///< 量化y坐标
+  int32_t z{0};       ///< 量化z坐标
+  uint16_t yaw{0};    ///< 量化偏航角
+  uint32_t state{0};  ///< 状态标志
+  uint32_t hp{0};     ///< 血量
+};
+
+/// 快照视图
+/// 某一帧观察者可见的实体集合，按guid升序排列
+struct SnapshotView {
+  uint32_t tick{kSnapshotNoBaseline};     ///< 帧号
+  std::vector<EntitySnapshot> entities;  ///< 可见实体
+};
+
+/// 一帧的全部实体快照
+/// 每帧只量化一次，所有观察者通过下标引用其中的实体
+class SnapshotFrame {
+ public:
+  /// 开始新的一帧
+  ///  @param[in]   tick      帧号，必须大于0
+  void Reset(uint32_t tick);
+
+  /// 添加实体
+  ///  @param[in]   guid      实体guid
+  ///  @param[in]   pos       实体位置
+  ///  @param[in]   dir       实体方向
+  ///  @param[in]   state     状态标志
+  ///  @param[in]   hp        血量
+  ///  @return 实体在帧中的下标
+  uint32_t Add(uint64_t guid, const Position3D &pos, const Direction3D &dir,
+               uint32_t state, uint32_t hp);
+
+  /// 获取帧号
+  ///  @return 帧号
+  uint32_t GetTick() const { return tick_; }
+  /// 获取帧中的实体
+  ///  @return 帧中的实体
+  const std::vector<EntitySnapshot> &GetEntities() const { return entities_; }
+
+ private:
+  uint32_t tick_{kSnapshotNoBaseline};    ///< 帧号
+  std::vector<EntitySnapshot> entities_;  ///< 量化后的实体
+};
+
+/// 快照观察者
+/// 记录观察者已发送的历史视图和客户端最后确认的基准视图
+class SnapshotWatcher {
+ public:
+  /// 构造函数
+  ///  @param[in]   history_size    历史快照帧数
+  explicit SnapshotWatcher(size_t history_size = kSnapshotHistorySize);
+
+  /// 清空当前帧的可见实体
+  void ClearVisible() { visible_.clear(); }
+  /// 添加当前帧的可见实体
+  ///  @param[in]   index     实体在SnapshotFrame中的下标
+  void AddVisible(uint32_t index) { visible_.emplace_back(index); }
+  /// 获取当前帧的可见实体
+  ///  @return 可见实体在SnapshotFrame中的下标
+  const std::vector<uint32_t> &GetVisible() const { return visible_; }
+
+  /// 客户端确认收到某一帧
+  ///  @param[in]   tick      确认的帧号
+  ///  @return 帧仍在历史中且比当前基准新返回true
+  bool Ack(uint32_t tick);
+
+  /// 丢弃基准，下一帧使用全量同步
+  void Reset();
+
+  /// 获取当前基准帧号
+  ///  @return 当前基准帧号，没有基准返回kSnapshotNoBaseline
+  uint32_t GetBaselineTick() const;
+
+ private:
+  friend class SnapshotEncoder;
+
+  /// 获取基准视图
+  ///  @return 基准视图，没有基准返回nullptr
+  const SnapshotView *GetBaseline() const;
+
+  /// 分配新一帧的视图
+  /// 覆盖基准视图时丢弃基准
+  ///  @param[in]   tick      帧号
+  ///  @return 新一帧的视图
+  SnapshotView &NextView(uint32_t tick);
+
+  std::vector<uint32_t> visible_;      ///< 当前帧可见实体下标
+  std::vector<SnapshotView> history_;  ///< 已发送的历史视图
+  size_t next_{0};                     ///< 下一个写入的历史位置
+  size_t baseline_{0};                 ///< 基准视图位置
+  bool has_baseline_{false};           ///< 是否有基准视图
+};
+
+/// 快照差分编码器
+/// 只写入相对基准变化的字段，未变化的实体不写入
+///
+/// 帧格式:
+///   uint32    帧号
+///   uint32    基准帧号，kSnapshotNoBaseline为全量帧
+///   uint32    记录数量n
+///   packed    n个guid，第一个为原值，之后为与前一个的差值
+///   uint8     n个字段掩码
+///   packed    所有字段值，按记录顺序和字段位从低到高排列
+///             坐标和血量为zigzag差值，偏航角为环绕差值，状态为异或值
+class SnapshotEncoder {
+ public:
+  /// 编码一个观察者的快照
+  ///  @param[in]   frame       当前帧
+  ///  @param[in]   watcher     观察者
+  ///  @param[out]  buffer      输出缓冲
+  void Encode(const SnapshotFrame &frame, SnapshotWatcher &watcher,
+              ByteBuffer &buffer);
+
+  /// 批量编码一帧所有观察者的快照
+  /// 编码过程中的临时缓冲在所有观察者间复用
+  ///  @param[in]   frame       当前帧
+  ///  @param[in]   watchers    观察者数组
+  ///  @param[out]  buffers     输出缓冲数组，与观察者一一对应
+  ///  @param[in]   count       观察者数量
+  void EncodeBatch(const SnapshotFrame &frame, SnapshotWatcher *watchers,
+                   ByteBuffer *buffers, size_t count);
+
+ private:
+  /// 添加一条记录
+  ///  @param[in]   base      基准快照
+  ///  @param[in]   curr      当前快照
+  ///  @param[in]   mask      字段掩码
+  void AddRecord(const EntitySnapshot &base, const EntitySnapshot &curr,
+                 uint8_t mask);
+
+  std::vector<uint64_t> guids_;   ///< 记录guid
+  std::vector<uint8_t> masks_;    ///< 记录字段掩码
+  std::vector<uint64_t> values_;  ///< 字段值
+};
+
+/// 快照解码器
+/// 客户端使用，保存已解码的历史视图作为后续差分帧的基准
+class SnapshotDecoder {
+ public:
+  /// 构造函数
+  ///  @param[in]   history_size    历史快照帧数
+  explicit SnapshotDecoder(size_t history_size = kSnapshotHistorySize);
+
+  /// 解码一帧快照
+  ///  @param[in]   buffer      输入缓冲
+  ///  @return 成功返回true，基准帧已丢失或数据不一致返回false
+  bool Decode(ByteBuffer &buffer);
+
+  /// 获取最后解码的视图
+  ///  @return 最后解码的视图
+  const SnapshotView &GetView() const { return history_[last_]; }
+
+ private:
+  /// 查找历史视图
+  ///  @param[in]   tick      帧号
+  ///  @return 历史视图，没有找到返回nullptr
+  const SnapshotView *FindView(uint32_t tick) const;
+
+  std::vector<SnapshotView> history_;    ///< 已解码的历史视图
+  std::vector<EntitySnapshot> decoded_;  ///< 解码中的实体
+  std::vector<uint64_t> guids_;          ///< 记录guid
+  std::vector<uint8_t> masks_;           ///< 记录字段掩码
+  std::vector<uint64_t> values_;         ///< 字段值
+  size_t next_{0};                       ///< 下一个写入的历史位置
+  size_t last_{0};                       ///< 最后解码的视图位置
+};
+
+}  // namespace aoi
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_AOI_AOI_SNAPSHOT_H_
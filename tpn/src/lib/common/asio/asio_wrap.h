@@ -23,6 +23,9 @@
 #ifndef TYPHOON_ZERO_TPN_SRC_LIB_COMMON_ASIO_ASIO_WRAP_H_
 #define TYPHOON_ZERO_TPN_SRC_LIB_COMMON_ASIO_ASIO_WRAP_H_
 
+// asio/awaitable.hpp 使用 std::exchange 但没有包含 <utility>
+#include <utility>
+
 #include <asio.hpp>
 
 #if defined(TPN_USE_SSL)
@@ -129,11 +129,15 @@ void SetAutomaticRegistration(bool automatic_registration);
 #  define LOGGER_CALL_END
 #endif
 
-#define LOGGER_CALL(logger, level, format, ...)                              \
-  LOGGER_CALL_BEGIN do {                                                     \
-    (logger)->Log(SourceLocation{__FILE__, __FUNCTION__, __LINE__}, (level), \
-                  FMT_STRING((format)), ##__VA_ARGS__);                      \
-  }                                                                          \
+/// 级别不满足时不求值日志参数，调试日志里的序列化等开销只在打开时产生
+#define LOGGER_CALL(logger, level, format, ...)                               \
+  LOGGER_CALL_BEGIN do {                                                      \
+    auto &&tpn_logger = (logger);                                             \
+    if (tpn_logger->ShouldLog((level))) {                                     \
+      tpn_logger->Log(SourceLocation{__FILE__, __FUNCTION__, __LINE__},       \
+                      (level), FMT_STRING((format)), ##__VA_ARGS__);          \
+    }                                                                         \
+  }                                                                           \
   while (0) LOGGER_CALL_END
 
 #define LOGGER_TRACE(logger, ...) \
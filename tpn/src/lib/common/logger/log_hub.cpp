@@ -27,6 +27,7 @@
 #include "utils.h"
 #include "debug_hub.h"
 #include "config.h"
+#include "coarse_clock.h"
 #include "logger.h"
 #include "async_logger.h"
 #include "exception_hub.h"
@@ -94,6 +95,11 @@ void LogHub::Init() {
 
   uint32_t flush_interval = g_config->GetU32Default("log_flush_interval", 1000);
   FlushEvery(MilliSeconds(flush_interval));
+
+  // 日志时间戳与时间字符串改用粗粒度时钟
+  if (g_config->GetBoolDefault("log_coarse_clock", false)) {
+    g_coarse_clock->Enable(CoarseClockUser::kCoarseClockUserLog);
+  }
 }
 
 void LogHub::RegisterLogger(LoggerSptr new_logger) {
@@ -204,6 +210,7 @@ void LogHub::DropAll() {
 
 void LogHub::Shutdown() {
   FlushAll();
+  g_coarse_clock->Disable(CoarseClockUser::kCoarseClockUserLog);
   {
     std::lock_guard<std::mutex> lock(flush_mutex_);
     periodic_flusher_.reset();
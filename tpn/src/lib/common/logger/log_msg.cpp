@@ -23,6 +23,7 @@
 #include "log_msg.h"
 
 #include "platform.h"
+#include "coarse_clock.h"
 
 namespace tpn {
 
@@ -40,13 +41,15 @@ LogMsg::LogMsg(std::string_view logger_name_in, LogLevel level_in,
 
 LogMsg::LogMsg(std::string_view logger_name_in, LogLevel level_in,
                SourceLocation src_loc_in, std::string_view content_in)
-    : LogMsg(logger_name_in, level_in, LogClock::now(), src_loc_in,
-             content_in) {}
+    : LogMsg(logger_name_in, level_in,
+             g_coarse_clock->SystemNow(CoarseClockUser::kCoarseClockUserLog),
+             src_loc_in, content_in) {}
 
 LogMsg::LogMsg(std::string_view logger_name_in, LogLevel level_in,
                std::string_view content_in)
-    : LogMsg(logger_name_in, level_in, LogClock::now(), SourceLocation{},
-             content_in) {}
+    : LogMsg(logger_name_in, level_in,
+             g_coarse_clock->SystemNow(CoarseClockUser::kCoarseClockUserLog),
+             SourceLocation{}, content_in) {}
 
 AsyncLogMsg::AsyncLogMsg(const LogMsg &msg) : LogMsg{msg} {
   buf_.append(logger_name.data(), logger_name.data() + logger_name.size());
@@ -24,6 +24,7 @@
 #define TYPHOON_ZERO_TPN_SRC_LIB_COMMON_LOGGER_PATTERN_H_
 
 #include "chrono_wrap.h"
+#include "coarse_clock.h"
 #include "utils.h"
 #include "log_common.h"
 #include "log_msg.h"
@@ -42,6 +43,20 @@ class TPN_COMMON_API Pattern {
   auto Format(const LogMsg &msg, FormatContext &ctx) {
     uint32_t format_type = g_log_hub->GetFormatType();
 
+    // 粗粒度时钟缓存了当前秒的时间字符串，只需要补上毫秒
+    char datetime[kCoarseDateTimeSize];
+    if (g_coarse_clock->IsEnabled(CoarseClockUser::kCoarseClockUserLog) &&
+        g_coarse_clock->CopyDateTime(
+            msg.time,
+            PatternTimeType::kPatternTimeTypeUtc ==
+                g_log_hub->GetPatternTimeType(),
+            datetime)) {
+      return this->FormatRest(
+          msg, ctx, format_type,
+          "[{}.{:03}] "_format(std::string_view(datetime, kCoarseDateTimeSize),
+                               TimeFraction<MilliSeconds>(msg.time).count()));
+    }
+
     if (format_type & EnumToUnderlyType(FormatType::kFormatTypeTimeCache)) {
       auto secs =
           std::chrono::duration_cast<Seconds>(msg.time.time_since_epoch());
@@ -54,14 +69,26 @@ class TPN_COMMON_API Pattern {
       }
     }
 
+    return this->FormatRest(
+        msg, ctx, format_type,
+        format_type & EnumToUnderlyType(FormatType::kFormatTypeTimeCache)
+            ? "[{}] "_format(cache_datetime_.data())
+            : "[{:%Y-%m-%d %H:%M:%S}.{:03}] "_format(
+                  g_log_hub->GetTime(msg.time),
+                  TimeFraction<MilliSeconds>(msg.time).count()));
+  }
+
+ private:
+  /// 格式化时间以外的部分
+  ///  @param[in]   msg           日志信息
+  ///  @param[in]   ctx           格式化上下文
+  ///  @param[in]   format_type   格式类型
+  ///  @param[in]   time          格式化好的时间
+  template <typename FormatContext>
+  auto FormatRest(const LogMsg &msg, FormatContext &ctx, uint32_t format_type,
+                  const std::string &time) {
     return fmt::format_to(
-        ctx.out(), "{time}{level}{tid}{src_loc}{content}",
-        "time"_a =
-            (format_type & EnumToUnderlyType(FormatType::kFormatTypeTimeCache)
-                 ? "[{}] "_format(cache_datetime_.data())
-                 : "[{:%Y-%m-%d %H:%M:%S}.{:03}] "_format(
-                       g_log_hub->GetTime(msg.time),
-                       TimeFraction<MilliSeconds>(msg.time).count())),
+        ctx.out(), "{time}{level}{tid}{src_loc}{content}", "time"_a = time,
         "level"_a =
             (format_type & EnumToUnderlyType(FormatType::kFormatTypeDebugLevel)
                  ? "[{:>5}] "_format(ToLogLevelStr(msg.level))
@@ -0,0 +1,276 @@
+//
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "buffer_pool.h"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <new>
+#include <thread>
+#include <algorithm>
+
+namespace tpn {
+
+namespace {
+
+static constexpr size_t kBufferPoolClassCount =
+    kBufferPoolMaxBlockShift - kBufferPoolMinBlockShift + 1;
+
+/// 空闲块链表节点
+struct BufferPoolNode {
+  BufferPoolNode *next;
+};
+
+/// 线程缓存，平凡类型在线程启动时零初始化，不依赖构造顺序
+struct BufferThreadCache {
+  std::array<BufferPoolNode *, kBufferPoolClassCount> free;  ///< 空闲块链表
+  std::array<size_t, kBufferPoolClassCount> count;           ///< 空闲块数
+  bool closed;  ///< 线程退出时已经清理，之后的归还直接交给中心空闲链表
+};
+
+/// 中心空闲链表，只在批量交换时加锁
+struct BufferCentralList {
+  std::atomic_flag lock;  ///< 自旋锁
+  BufferPoolNode *head;   ///< 空闲块链表
+  size_t count;           ///< 空闲块数
+};
+
+thread_local BufferThreadCache t_buffer_cache{};
+
+/// 平凡析构，线程在静态对象析构之后退出也可以安全访问
+constinit std::array<BufferCentralList, kBufferPoolClassCount> s_central{};
+
+std::atomic<size_t> s_heap_allocations{0};    ///< 向全局堆申请的次数
+std::atomic<size_t> s_heap_deallocations{0};  ///< 归还全局堆的次数
+std::atomic<size_t> s_central_transfers{0};   ///< 批量交换次数
+
+/// 获取分级块大小
+constexpr size_t GetBlockSize(size_t index) {
+  return size_t(1) << (index + kBufferPoolMinBlockShift);
+}
+
+/// 获取分级线程缓存的块数
+constexpr size_t GetThreadDepth(size_t index) {
+  return std::clamp(kBufferPoolThreadBytes / GetBlockSize(index), size_t(4),
+                    kBufferPoolMaxDepth);
+}
+
+/// 获取分级中心空闲链表的块数
+constexpr size_t GetCentralDepth(size_t index) {
+  return kBufferPoolCentralBytes / GetBlockSize(index);
+}
+
+/// 获取申请大小对应的分级
+///  @param[in]   size      申请大小
+///  @return 分级下标，超出最大分级返回kBufferPoolClassCount
+size_t GetBufferPoolClass(size_t size) {
+  if (size <= GetBlockSize(0)) {
+    return 0;
+  }
+  if (size > GetBlockSize(kBufferPoolClassCount - 1)) {
+    return kBufferPoolClassCount;
+  }
+  return std::bit_width(size - 1) - kBufferPoolMinBlockShift;
+}
+
+/// 中心空闲链表加锁
+class BufferCentralGuard {
+ public:
+  explicit BufferCentralGuard(BufferCentralList &list) : list_(list) {
+    while (list_.lock.test_and_set(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+  }
+
+  ~BufferCentralGuard() { list_.lock.clear(std::memory_order_release); }
+
+ private:
+  BufferCentralList &list_;
+};
+
+/// 把线程缓存的前count个块交给中心空闲链表，中心空闲链表满了归还全局堆
+///  @param[in]   cache     线程缓存
+///  @param[in]   index     分级
+///  @param[in]   count     块数
+void FlushToCentral(BufferThreadCache &cache, size_t index, size_t count) {
+  BufferPoolNode *first = cache.free[index];
+  BufferPoolNode *last  = first;
+  for (size_t i = 1; i < count; ++i) {
+    last = last->next;
+  }
+  cache.free[index] = last->next;
+  cache.count[index] -= count;
+
+  BufferCentralList &list = s_central[index];
+  {
+    BufferCentralGuard guard(list);
+    if (list.count + count <= GetCentralDepth(index)) {
+      last->next = list.head;
+      list.head  = first;
+      list.count += count;
+      first      = nullptr;
+    }
+  }
+
+  s_central_transfers.fetch_add(1, std::memory_order_relaxed);
+  if (nullptr != first) {
+    last->next = nullptr;
+  }
+  while (nullptr != first) {
+    BufferPoolNode *node = first;
+    first                = node->next;
+    ::operator delete(node);
+    s_heap_deallocations.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+/// 从中心空闲链表批量取回
+///  @param[in]   cache     线程缓存
+///  @param[in]   index     分级
+///  @return 取回了块返回true
+bool RefillFromCentral(BufferThreadCache &cache, size_t index) {
+  BufferCentralList &list = s_central[index];
+  BufferPoolNode *first   = nullptr;
+  size_t count            = 0;
+  {
+    BufferCentralGuard guard(list);
+    if (nullptr == list.head) {
+      return false;
+    }
+
+    count = (std::min)(list.count, GetThreadDepth(index) / 2);
+    first = list.head;
+    BufferPoolNode *last = first;
+    for (size_t i = 1; i < count; ++i) {
+      last = last->next;
+    }
+    list.head = last->next;
+    list.count -= count;
+    last->next = cache.free[index];
+  }
+
+  s_central_transfers.fetch_add(1, std::memory_order_relaxed);
+  cache.free[index] = first;
+  cache.count[index] += count;
+  return true;
+}
+
+/// 线程退出时把缓存的块交给中心空闲链表
+struct BufferThreadCacheCleaner {
+  ~BufferThreadCacheCleaner() {
+    auto &cache = t_buffer_cache;
+    for (size_t index = 0; index < kBufferPoolClassCount; ++index) {
+      if (cache.count[index] > 0) {
+        FlushToCentral(cache, index, cache.count[index]);
+      }
+    }
+    cache.closed = true;
+  }
+
+  bool registered{false};  ///< 访问一次使析构函数注册到线程退出
+};
+
+thread_local BufferThreadCacheCleaner t_buffer_cache_cleaner;
+
+}  // namespace
+
+uint8_t *BufferPool::Allocate(size_t size, size_t &capacity) {
+  if (0 == size) {
+    capacity = 0;
+    return nullptr;
+  }
+
+  size_t index = GetBufferPoolClass(size);
+  if (kBufferPoolClassCount > index) {
+    capacity    = GetBlockSize(index);
+    auto &cache = t_buffer_cache;
+    if ((nullptr == cache.free[index]) && !cache.closed) {
+      // 从中心空闲链表取块前注册清理，只申请不归还的线程退出时也要交回缓存
+      t_buffer_cache_cleaner.registered = true;
+      RefillFromCentral(cache, index);
+    }
+    if (nullptr != cache.free[index]) {
+      BufferPoolNode *node = cache.free[index];
+      cache.free[index]    = node->next;
+      --cache.count[index];
+      return reinterpret_cast<uint8_t *>(node);
+    }
+  } else {
+    capacity = size;
+  }
+
+  s_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+  return static_cast<uint8_t *>(::operator new(capacity));
+}
+
+void BufferPool::Deallocate(uint8_t *pointer, size_t capacity) {
+  if (nullptr == pointer) {
+    return;
+  }
+
+  size_t index = GetBufferPoolClass(capacity);
+  if (kBufferPoolClassCount > index) {
+    auto &cache = t_buffer_cache;
+    auto *node  = reinterpret_cast<BufferPoolNode *>(pointer);
+    if (cache.closed) {
+      node->next = cache.free[index];
+      ++cache.count[index];
+      cache.free[index] = node;
+      FlushToCentral(cache, index, 1);
+      return;
+    }
+
+    t_buffer_cache_cleaner.registered = true;
+    if (GetThreadDepth(index) <= cache.count[index]) {
+      FlushToCentral(cache, index, cache.count[index] / 2);
+    }
+
+    node->next        = cache.free[index];
+    cache.free[index] = node;
+    ++cache.count[index];
+    return;
+  }
+
+  s_heap_deallocations.fetch_add(1, std::memory_order_relaxed);
+  ::operator delete(pointer);
+}
+
+void *BufferPool::AllocateObject(size_t size) {
+  size_t capacity = 0;
+  return Allocate(size, capacity);
+}
+
+void BufferPool::DeallocateObject(void *pointer, size_t size) {
+  size_t index = GetBufferPoolClass(size);
+  Deallocate(static_cast<uint8_t *>(pointer),
+             kBufferPoolClassCount > index ? GetBlockSize(index) : size);
+}
+
+BufferPoolStats BufferPool::GetStats() {
+  return BufferPoolStats{
+      s_heap_allocations.load(std::memory_order_relaxed),
+      s_heap_deallocations.load(std::memory_order_relaxed),
+      s_central_transfers.load(std::memory_order_relaxed)};
+}
+
+}  // namespace tpn
@@ -0,0 +1,85 @@
+//
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_COMMON_UTILITY_BUFFER_POOL_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_COMMON_UTILITY_BUFFER_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "define.h"
+
+namespace tpn {
+
+/// 缓冲池最小块大小 64B
+static constexpr size_t kBufferPoolMinBlockShift = 6;
+/// 缓冲池最大块大小 64KB，更大的申请直接交给全局堆
+static constexpr size_t kBufferPoolMaxBlockShift = 16;
+/// 线程缓存每个分级最多缓存的字节数，小块最多缓存 kBufferPoolMaxDepth 个
+static constexpr size_t kBufferPoolThreadBytes = 256 * 1024;
+/// 线程缓存每个分级最多缓存的块数
+static constexpr size_t kBufferPoolMaxDepth = 64;
+/// 中心空闲链表每个分级最多缓存的字节数，多出的归还全局堆
+static constexpr size_t kBufferPoolCentralBytes = 8 * 1024 * 1024;
+
+/// 缓冲池统计
+struct BufferPoolStats {
+  size_t heap_allocations{0};    ///< 向全局堆申请的次数
+  size_t heap_deallocations{0};  ///< 归还全局堆的次数
+  size_t central_transfers{0};   ///< 线程缓存与中心空闲链表之间的批量交换次数
+};
+
+/// 消息缓冲池
+/// 按2的幂分级，每个线程一份缓存，线程缓存满了把一半的块交给中心空闲链表，
+/// 空了从中心空闲链表批量取回。io线程接收、逻辑线程释放这种跨线程的用法
+/// 也只在批量交换时加锁。
+class TPN_COMMON_API BufferPool {
+ public:
+  /// 申请缓冲，内容未初始化
+  ///  @param[in]   size      申请大小
+  ///  @param[out]  capacity  实际可用大小，释放时需要传回
+  ///  @return 缓冲地址，size为0时返回nullptr
+  static uint8_t *Allocate(size_t size, size_t &capacity);
+
+  /// 释放缓冲
+  ///  @param[in]   pointer   缓冲地址
+  ///  @param[in]   capacity  申请时返回的可用大小
+  static void Deallocate(uint8_t *pointer, size_t capacity);
+
+  /// 申请小对象，与缓冲共用分级
+  ///  @param[in]   size      对象大小
+  ///  @return 对象地址
+  static void *AllocateObject(size_t size);
+
+  /// 释放小对象
+  ///  @param[in]   pointer   对象地址
+  ///  @param[in]   size      对象大小
+  static void DeallocateObject(void *pointer, size_t size);
+
+  /// 获取统计
+  ///  @return 统计数据
+  static BufferPoolStats GetStats();
+};
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_COMMON_UTILITY_BUFFER_POOL_H_
@@ -22,6 +22,8 @@
 
 #include "byte_buffer.h"
 
+#include <algorithm>
+#include <bit>
 #include <sstream>
 
 #include "exception_hub.h"
@@ -29,45 +31,192 @@
 #include "platform.h"
 #include "log.h"
 #include "message_buffer.h"
+#include "buffer_pool.h"
+
+// 批量编解码的向量化路径，x86-64默认有SSE2，打开 WITH_AVX2 后使用AVX2与BMI2
+#if defined(__AVX2__)
+#  define TPN_BYTE_BUFFER_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define TPN_BYTE_BUFFER_SSE2
+#  include <emmintrin.h>
+#endif
+#if defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__))
+#  define TPN_BYTE_BUFFER_BMI2
+#endif
+#if defined(TPN_BYTE_BUFFER_AVX2) || defined(TPN_BYTE_BUFFER_BMI2)
+#  include <immintrin.h>
+#endif
 
 namespace tpn {
 
-ByteBuffer::ByteBuffer()
-    : rpos_{0}, wpos_{0}, bitpos_{kInitialBitPos}, cur_bit_val_{0} {
-  storage_.reserve(kByteBufferDefaultSize);
+namespace {
+
+/// 64位数据中非零字节的掩码
+///  @param[in]   value   64位数据
+///  @return 第i位对应第i个字节
+inline uint8_t GetNonZeroByteMask(uint64_t value) {
+  uint64_t bits = value | (value >> 4);
+  bits |= bits >> 2;
+  bits |= bits >> 1;
+  bits &= 0x0101010101010101ull;
+  return static_cast<uint8_t>((bits * 0x0102040810204080ull) >> 56);
+}
+
+#ifdef TPN_BYTE_BUFFER_BMI2
+/// 字节掩码展开为位掩码
+///  @param[in]   mask    字节掩码
+///  @return 掩码中每一位对应一个0xFF字节
+inline uint64_t ExpandByteMask(uint8_t mask) {
+  return _pdep_u64(mask, 0x0101010101010101ull) * 0xFF;
+}
+#endif
+
+/// 按掩码依次写出64位数据的字节
+/// BMI2路径固定写8字节，调用方需要预留 ByteBuffer::kPackedUInt64MaxSize
+///  @param[in]   value   64位数据
+///  @param[in]   mask    字节掩码
+///  @param[out]  dest    写入地址
+///  @return 写入长度
+inline size_t CompactBytes(uint64_t value, uint8_t mask, uint8_t *dest) {
+#ifdef TPN_BYTE_BUFFER_BMI2
+  uint64_t packed = _pext_u64(value, ExpandByteMask(mask));
+  std::memcpy(dest, &packed, sizeof(packed));
+  return std::popcount(mask);
+#else
+  uint8_t *begin = dest;
+  for (uint32_t bits = mask; 0 != bits; bits &= bits - 1) {
+    *dest++ = static_cast<uint8_t>(value >> (std::countr_zero(bits) * 8));
+  }
+  return dest - begin;
+#endif
+}
+
+/// 按掩码把字节还原为64位数据
+///  @param[in]   src     数据地址，长度为掩码中1的个数
+///  @param[in]   mask    字节掩码
+///  @return 64位数据
+inline uint64_t ExpandBytes(const uint8_t *src, uint8_t mask) {
+  uint64_t value = 0;
+  for (uint32_t bits = mask; 0 != bits; bits &= bits - 1) {
+    value |= uint64_t(*src++) << (std::countr_zero(bits) * 8);
+  }
+  return value;
 }
 
+#ifdef TPN_BYTE_BUFFER_SSE2
+/// 4个交错存放的坐标拆分为x、y、z
+///  @param[in]   xyz     12个float
+///  @param[out]  x       x坐标
+///  @param[out]  y       y坐标
+///  @param[out]  z       z坐标
+inline void DeinterleaveXYZ(const float *xyz, __m128 &x, __m128 &y,
+                            __m128 &z) {
+  __m128 a = _mm_loadu_ps(xyz);      // x0 y0 z0 x1
+  __m128 b = _mm_loadu_ps(xyz + 4);  // y1 z1 x2 y2
+  __m128 c = _mm_loadu_ps(xyz + 8);  // z2 x3 y3 z3
+  x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)),
+                     _MM_SHUFFLE(2, 0, 3, 0));
+  y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+                     _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)),
+                     _MM_SHUFFLE(2, 0, 2, 0));
+  z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)),
+                     _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)),
+                     _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+/// x、y、z合并为4个交错存放的坐标
+///  @param[in]   x       x坐标
+///  @param[in]   y       y坐标
+///  @param[in]   z       z坐标
+///  @param[out]  xyz     12个float
+inline void InterleaveXYZ(__m128 x, __m128 y, __m128 z, float *xyz) {
+  __m128 a = _mm_shuffle_ps(_mm_unpacklo_ps(x, y),
+                            _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)),
+                            _MM_SHUFFLE(2, 0, 1, 0));
+  __m128 b = _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)),
+                            _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)),
+                            _MM_SHUFFLE(2, 0, 2, 0));
+  __m128 c = _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)),
+                            _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)),
+                            _MM_SHUFFLE(2, 0, 2, 0));
+  _mm_storeu_ps(xyz, a);
+  _mm_storeu_ps(xyz + 4, b);
+  _mm_storeu_ps(xyz + 8, c);
+}
+
+/// 打包4个坐标，与 ByteBuffer::PackXYZ 相同，x / 0.25 与 x * 4 结果一致
+inline __m128i PackXYZ4(__m128 x, __m128 y, __m128 z) {
+  const __m128 scale = _mm_set1_ps(4.0f);
+  __m128i px = _mm_and_si128(_mm_cvttps_epi32(_mm_mul_ps(x, scale)),
+                             _mm_set1_epi32(0x7FF));
+  __m128i py = _mm_and_si128(_mm_cvttps_epi32(_mm_mul_ps(y, scale)),
+                             _mm_set1_epi32(0x7FF));
+  __m128i pz = _mm_and_si128(_mm_cvttps_epi32(_mm_mul_ps(z, scale)),
+                             _mm_set1_epi32(0x3FF));
+  return _mm_or_si128(_mm_or_si128(px, _mm_slli_epi32(py, 11)),
+                      _mm_slli_epi32(pz, 22));
+}
+
+/// 解包4个坐标，与 ByteBuffer::UnpackXYZ 相同
+inline void UnpackXYZ4(__m128i packed, __m128 &x, __m128 &y, __m128 &z) {
+  const __m128 scale = _mm_set1_ps(0.25f);
+  x = _mm_mul_ps(
+      _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(packed, 21), 21)), scale);
+  y = _mm_mul_ps(
+      _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(packed, 10), 21)), scale);
+  z = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(packed, 22)), scale);
+}
+#endif
+
+}  // namespace
+
+ByteBuffer::ByteBuffer()
+    : rpos_{0}, wpos_{0}, bitpos_{kInitialBitPos}, cur_bit_val_{0} {}
+
 ByteBuffer::ByteBuffer(size_t size, ReserveFlag)
     : rpos_{0}, wpos_{0}, bitpos_{kInitialBitPos}, cur_bit_val_{0} {
-  storage_.reserve(size);
+  Reserve(size);
 }
 
 ByteBuffer::ByteBuffer(size_t size, ResizeFlag)
     : rpos_{0}, wpos_{0}, bitpos_{kInitialBitPos}, cur_bit_val_{0} {
-  storage_.resize(size);
+  Reserve(size);
+  std::memset(storage_, 0, size);
+  size_ = size;
 }
 
 ByteBuffer::ByteBuffer(MessageBuffer &&buffer)
-    : rpos_{0},
-      wpos_{0},
-      bitpos_{kInitialBitPos},
-      cur_bit_val_{0},
-      storage_(buffer.Move()) {}
+    : rpos_{0}, wpos_{0}, bitpos_{kInitialBitPos}, cur_bit_val_{0} {
+  Reserve(buffer.GetBufferSize());
+  if (buffer.GetBufferSize()) {
+    std::memcpy(storage_, buffer.GetBasePointer(), buffer.GetBufferSize());
+  }
+  size_ = buffer.GetBufferSize();
+}
 
-ByteBuffer::storage_type &&ByteBuffer::Move() noexcept {
-  rpos_        = 0;
-  wpos_        = 0;
-  bitpos_      = kInitialBitPos;
-  cur_bit_val_ = 0;
-  return std::move(storage_);
+ByteBuffer::ByteBuffer(const ByteBuffer &other)
+    : rpos_{other.rpos_},
+      wpos_{other.wpos_},
+      bitpos_{other.bitpos_},
+      cur_bit_val_{other.cur_bit_val_} {
+  Reserve(other.size_);
+  if (other.size_) {
+    std::memcpy(storage_, other.storage_, other.size_);
+  }
+  size_ = other.size_;
 }
 
 ByteBuffer::ByteBuffer(ByteBuffer &&other) noexcept
     : rpos_{other.rpos_},
       wpos_{other.wpos_},
       bitpos_{other.bitpos_},
-      cur_bit_val_{other.cur_bit_val_},
-      storage_{other.Move()} {}
+      cur_bit_val_{other.cur_bit_val_} {
+  TakeStorage(other);
+}
+
+ByteBuffer::~ByteBuffer() { ReleaseStorage(); }
 
 ByteBuffer &ByteBuffer::operator=(const ByteBuffer &other) {
   if (this != &other) {
@@ -75,7 +224,12 @@ ByteBuffer &ByteBuffer::operator=(const ByteBuffer &other) {
     wpos_        = 0;
     bitpos_      = kInitialBitPos;
     cur_bit_val_ = 0;
-    storage_     = other.storage_;
+    size_        = 0;
+    Reserve(other.size_);
+    if (other.size_) {
+      std::memcpy(storage_, other.storage_, other.size_);
+    }
+    size_ = other.size_;
   }
   return *this;
 }
@@ -86,11 +240,53 @@ ByteBuffer &ByteBuffer::operator=(ByteBuffer &&other) noexcept {
     wpos_        = 0;
     bitpos_      = kInitialBitPos;
     cur_bit_val_ = 0;
-    storage_     = other.Move();
+    ReleaseStorage();
+    TakeStorage(other);
   }
   return *this;
 }
 
+void ByteBuffer::TakeStorage(ByteBuffer &other) noexcept {
+  if (other.IsInline()) {
+    std::memcpy(storage_, other.storage_, other.size_);
+  } else {
+    storage_        = other.storage_;
+    capacity_       = other.capacity_;
+    other.storage_  = other.inline_storage_;
+    other.capacity_ = kByteBufferInlineSize;
+  }
+  size_              = other.size_;
+  other.size_        = 0;
+  other.rpos_        = 0;
+  other.wpos_        = 0;
+  other.bitpos_      = kInitialBitPos;
+  other.cur_bit_val_ = 0;
+}
+
+void ByteBuffer::Grow(size_t min_capacity) {
+  size_t capacity  = 0;
+  uint8_t *storage = BufferPool::Allocate(
+      (std::max)(min_capacity, capacity_ + capacity_ / 2), capacity);
+  if (size_) {
+    std::memcpy(storage, storage_, size_);
+  }
+  ReleaseStorage();
+  storage_  = storage;
+  capacity_ = capacity;
+}
+
+void ByteBuffer::ReleaseStorage() {
+  if (!IsInline()) {
+    BufferPool::Deallocate(storage_, capacity_);
+    storage_  = inline_storage_;
+    capacity_ = kByteBufferInlineSize;
+  }
+}
+
+void ByteBuffer::ThrowReadOverflow(size_t pos, size_t len) const {
+  TPN_THROW(ByteBufferException(pos, len, GetSize()));
+}
+
 size_t ByteBuffer::GetReadPos() const { return rpos_; }
 
 size_t ByteBuffer::SetReadPos(size_t rpos) {
@@ -116,66 +312,110 @@ size_t ByteBuffer::SetLastWriteBitPos(size_t new_pos) {
 }
 
 uint8_t *ByteBuffer::GetContents() {
-  if (storage_.empty()) {
+  if (0 == size_) {
     TPN_THROW(TpnException());
   }
-  return storage_.data();
+  return storage_;
 }
 
 const uint8_t *ByteBuffer::GetContents() const {
-  if (storage_.empty()) {
+  if (0 == size_) {
     TPN_THROW(TpnException());
   }
-  return storage_.data();
+  return storage_;
 }
 
-size_t ByteBuffer::GetSize() const { return storage_.size(); }
+size_t ByteBuffer::GetSize() const { return size_; }
 
-bool ByteBuffer::IsEmpty() const { return storage_.empty(); }
+bool ByteBuffer::IsEmpty() const { return 0 == size_; }
 
 void ByteBuffer::Resize(size_t new_size) {
-  storage_.resize(new_size, 0);
+  Reserve(new_size);
+  if (new_size > size_) {
+    std::memset(storage_ + size_, 0, new_size - size_);
+  }
+  size_ = new_size;
   rpos_ = 0;
   wpos_ = GetSize();
 }
 
 void ByteBuffer::Reserve(size_t res_size) {
-  if (res_size > storage_.size()) {
-    storage_.reserve(res_size);
+  if (res_size > capacity_) {
+    Grow(res_size);
   }
 }
 
-void ByteBuffer::Clear() {
-  rpos_        = 0;
-  wpos_        = 0;
-  bitpos_      = kInitialBitPos;
-  cur_bit_val_ = 0;
-  storage_.clear();
+size_t ByteBuffer::GetCapacity() const { return capacity_; }
+
+ByteBuffer::Writer ByteBuffer::BeginWrite(size_t bytes) {
+  FlushBits();
+  Reserve(wpos_ + bytes);
+  if (wpos_ > size_) [[unlikely]] {
+    std::memset(storage_ + size_, 0, wpos_ - size_);
+    size_ = wpos_;
+  }
+  return Writer(storage_ + wpos_, storage_ + wpos_ + bytes);
 }
 
-bool ByteBuffer::HasUnfinishedBitPack() const {
-  return bitpos_ != kInitialBitPos;
+void ByteBuffer::EndWrite(const Writer &writer) {
+  TPN_ASSERT(writer.cursor_ <= writer.end_,
+             "Writer overflow in ByteBuffer (pos: {} size: {})", wpos_,
+             GetSize());
+  wpos_ = writer.cursor_ - storage_;
+  if (wpos_ > size_) {
+    size_ = wpos_;
+  }
 }
 
-void ByteBuffer::FlushBits() {
-  if (kInitialBitPos == bitpos_) {
-    return;
+ByteBuffer::Reader ByteBuffer::BeginRead(size_t bytes) {
+  if (rpos_ + bytes > size_) [[unlikely]] {
+    ThrowReadOverflow(rpos_, bytes);
   }
-  bitpos_ = kInitialBitPos;
-  Append(reinterpret_cast<uint8_t *>(&cur_bit_val_), sizeof(uint8_t));
-  cur_bit_val_ = 0;
+  ResetBitPos();
+  return Reader(storage_ + rpos_, storage_ + rpos_ + bytes);
 }
 
-void ByteBuffer::ReadFinish() { rpos_ = GetWritePos(); }
+void ByteBuffer::EndRead(const Reader &reader) {
+  rpos_ = reader.cursor_ - storage_;
+}
 
-void ByteBuffer::ResetBitPos() {
-  if (bitpos_ > kBoundaryBitPos) {
-    return;
+void ByteBuffer::Writer::WritePackedUInt64(uint64_t guid) {
+  uint8_t mask = GetNonZeroByteMask(guid);
+  *cursor_++   = mask;
+  cursor_ += CompactBytes(guid, mask, cursor_);
+}
+
+void ByteBuffer::Writer::WritePackXYZ(float x, float y, float z) {
+  Write<uint32_t>(PackXYZ(x, y, z));
+}
+
+uint64_t ByteBuffer::Reader::ReadPackedUInt64() {
+  if (0 == GetRemaining()) [[unlikely]] {
+    TPN_THROW(ByteBufferException(0, 1, 0));
   }
+  uint8_t mask = *cursor_++;
+  if (size_t(std::popcount(mask)) > GetRemaining()) [[unlikely]] {
+    TPN_THROW(ByteBufferException(0, std::popcount(mask), GetRemaining()));
+  }
+  uint64_t value = ExpandBytes(cursor_, mask);
+  cursor_ += std::popcount(mask);
+  return value;
+}
+
+void ByteBuffer::Clear() {
+  rpos_        = 0;
+  wpos_        = 0;
   bitpos_      = kInitialBitPos;
   cur_bit_val_ = 0;
+  size_        = 0;
+}
+
+bool ByteBuffer::HasUnfinishedBitPack() const {
+  return bitpos_ != kInitialBitPos;
 }
 
+void ByteBuffer::ReadFinish() { rpos_ = GetWritePos(); }
+
 bool ByteBuffer::WriteBit(bool bit) {
   --bitpos_;
   if (bit) {
@@ -199,23 +439,104 @@ bool ByteBuffer::ReadBit() {
 }
 
 void ByteBuffer::WriteBits(size_t value, int32_t bits) {
-  for (int32_t i = bits - 1; i >= 0; --i) {
-    WriteBit((value >> i) & 0x1);
+  // 按当前字节剩余的位数成段写入
+  while (bits > 0) {
+    int32_t cnt = (std::min)(bits, static_cast<int32_t>(bitpos_));
+    bits -= cnt;
+    bitpos_ -= cnt;
+    cur_bit_val_ |=
+        static_cast<uint8_t>(((value >> bits) & ((1u << cnt) - 1)) << bitpos_);
+    if (0 == bitpos_) {
+      bitpos_ = kInitialBitPos;
+      Append(&cur_bit_val_, sizeof(uint8_t));
+      cur_bit_val_ = 0;
+    }
   }
 }
 
 uint32_t ByteBuffer::ReadBits(int32_t bits) {
   uint32_t value = 0;
 
-  for (int32_t i = bits - 1; i >= 0; --i) {
-    if (ReadBit()) {
-      value |= (0x1 << (i));
+  while (bits > 0) {
+    uint32_t remain =
+        bitpos_ < kBoundaryBitPos ? uint32_t(kBoundaryBitPos - bitpos_) : 0;
+    if (0 == remain) {
+      cur_bit_val_ = Read<uint8_t>();
+      remain       = kInitialBitPos;
     }
+    int32_t cnt = (std::min)(bits, static_cast<int32_t>(remain));
+    bits -= cnt;
+    remain -= cnt;
+    value   = (value << cnt) | ((cur_bit_val_ >> remain) & ((1u << cnt) - 1));
+    bitpos_ = kBoundaryBitPos - remain;
   }
 
   return value;
 }
 
+void ByteBuffer::WriteBits(const uint32_t *values, size_t count,
+                           int32_t bits) {
+  TPN_ASSERT(bits >= 0 && bits <= 32, "WriteBits bits {} out of range", bits);
+  if (0 == count || 0 == bits) {
+    return;
+  }
+
+  // 未满字节中已写的位放进累加器，整字节直接写出，剩余的位留在当前字节
+  uint64_t acc     = cur_bit_val_ >> bitpos_;
+  uint32_t pending = kInitialBitPos - static_cast<uint32_t>(bitpos_);
+  bitpos_          = kInitialBitPos;
+  cur_bit_val_     = 0;
+
+  Writer writer   = BeginWrite((pending + count * bits) / kInitialBitPos);
+  uint8_t *cursor = writer.cursor_;
+  uint64_t mask   = (uint64_t(1) << bits) - 1;
+  for (size_t i = 0; i < count; ++i) {
+    acc = (acc << bits) | (values[i] & mask);
+    pending += bits;
+    while (pending >= kInitialBitPos) {
+      pending -= kInitialBitPos;
+      *cursor++ = static_cast<uint8_t>(acc >> pending);
+    }
+  }
+  writer.cursor_ = cursor;
+  EndWrite(writer);
+
+  bitpos_      = kInitialBitPos - pending;
+  cur_bit_val_ = static_cast<uint8_t>(acc << bitpos_);
+}
+
+void ByteBuffer::ReadBits(uint32_t *values, size_t count, int32_t bits) {
+  TPN_ASSERT(bits >= 0 && bits <= 32, "ReadBits bits {} out of range", bits);
+  if (0 == count || 0 == bits) {
+    return;
+  }
+
+  // 当前字节未读的位放进累加器，不足时整字节读入
+  uint32_t remain =
+      bitpos_ < kBoundaryBitPos ? uint32_t(kBoundaryBitPos - bitpos_) : 0;
+  uint8_t last  = cur_bit_val_;
+  uint64_t acc  = last & ((1u << remain) - 1);
+  size_t total  = count * bits;
+  Reader reader = BeginRead(
+      total > remain ? (total - remain + kBoundaryBitPos) / kInitialBitPos : 0);
+  const uint8_t *cursor = reader.cursor_;
+  uint64_t mask         = (uint64_t(1) << bits) - 1;
+  for (size_t i = 0; i < count; ++i) {
+    while (remain < uint32_t(bits)) {
+      last = *cursor++;
+      acc  = (acc << kInitialBitPos) | last;
+      remain += kInitialBitPos;
+    }
+    remain -= bits;
+    values[i] = static_cast<uint32_t>((acc >> remain) & mask);
+  }
+  reader.cursor_ = cursor;
+  EndRead(reader);
+
+  cur_bit_val_ = last;
+  bitpos_      = kBoundaryBitPos - remain;
+}
+
 void ByteBuffer::Put(size_t pos, const uint8_t *src, size_t cnt) {
   TPN_ASSERT(pos + cnt <= GetSize(),
              fmt::format("Attempted to put value with size: {} "
@@ -424,36 +745,10 @@ void ByteBuffer::Read(uint8_t *dest, size_t len) {
   }
 
   ResetBitPos();
-  std::memcpy(dest, &storage_[rpos_], len);
+  std::memcpy(dest, storage_ + rpos_, len);
   rpos_ += len;
 }
 
-template <typename T>
-void ByteBuffer::Read(T *dest, size_t count) {
-  static_assert(std::is_trivially_copyable<T>::value,
-                "Read(T*, size_t) must be used with trivially copyable types");
-  return Read(reinterpret_cast<uint8_t *>(dest), count * sizeof(T));
-}
-
-template <typename T, typename Underlying /* = T */>
-T ByteBuffer::Read() {
-  ResetBitPos();
-  T r = Read<T, Underlying>(rpos_);
-  rpos_ += sizeof(Underlying);
-  return r;
-}
-
-template <typename T, typename Underlying /* = T */>
-T ByteBuffer::Read(size_t pos) const {
-  if (pos + sizeof(Underlying) > GetSize()) {
-    TPN_THROW(ByteBufferException(pos, sizeof(Underlying), GetSize()));
-  }
-  Underlying val;
-  std::memcpy(&val, &storage_[pos], sizeof(Underlying));
-  tpn::EndianRefMakeLittle(val);
-  return static_cast<T>(val);
-}
-
 template <typename T>
 void ByteBuffer::ReadSkip() {
   ReadSkip(sizeof(T));
@@ -494,11 +789,58 @@ void ByteBuffer::ReadPackedUInt64(uint64_t &guid) {
 }
 
 void ByteBuffer::ReadPackedUInt64(uint8_t mask, uint64_t &value) {
-  for (uint32_t i = 0; i < kInitialBitPos; ++i) {
-    if (mask & (uint8_t(1) << i)) {
-      value |= (uint64_t(Read<uint8_t>()) << (i * kInitialBitPos));
+  Reader reader = BeginRead(std::popcount(mask));
+  value |= ExpandBytes(reader.cursor_, mask);
+  reader.cursor_ += std::popcount(mask);
+  EndRead(reader);
+}
+
+void ByteBuffer::ReadPackedUInt64(uint64_t *values, size_t count) {
+  Reader reader = BeginRead(size_ > rpos_ ? size_ - rpos_ : 0);
+  const uint8_t *cursor = reader.cursor_;
+  for (size_t i = 0; i < count; ++i) {
+    if (cursor == reader.end_) [[unlikely]] {
+      ThrowReadOverflow(cursor - storage_, 1);
+    }
+    uint8_t mask = *cursor++;
+    size_t size  = std::popcount(mask);
+    if (size > size_t(reader.end_ - cursor)) [[unlikely]] {
+      ThrowReadOverflow(cursor - storage_, size);
     }
+#ifdef TPN_BYTE_BUFFER_BMI2
+    // 后面还有8字节时整块读入再按掩码分散
+    if (reader.end_ - cursor >= 8) [[likely]] {
+      uint64_t raw;
+      std::memcpy(&raw, cursor, sizeof(raw));
+      values[i] = _pdep_u64(raw, ExpandByteMask(mask));
+      cursor += size;
+      continue;
+    }
+#endif
+    values[i] = ExpandBytes(cursor, mask);
+    cursor += size;
+  }
+  reader.cursor_ = cursor;
+  EndRead(reader);
+}
+
+void ByteBuffer::ReadPackXYZ(float *xyz, size_t count) {
+  Reader reader = BeginRead(count * kPackedXYZSize);
+  size_t i      = 0;
+#ifdef TPN_BYTE_BUFFER_SSE2
+  for (; i + 4 <= count; i += 4, xyz += 12) {
+    __m128 x, y, z;
+    UnpackXYZ4(_mm_loadu_si128(reinterpret_cast<const __m128i *>(
+                   reader.cursor_)),
+               x, y, z);
+    InterleaveXYZ(x, y, z, xyz);
+    reader.cursor_ += 4 * kPackedXYZSize;
   }
+#endif
+  for (; i < count; ++i, xyz += 3) {
+    UnpackXYZ(reader.Read<uint32_t>(), xyz[0], xyz[1], xyz[2]);
+  }
+  EndRead(reader);
 }
 
 std::string ByteBuffer::ReadString(uint32_t length) {
@@ -511,7 +853,7 @@ std::string ByteBuffer::ReadString(uint32_t length) {
     return std::string();
   }
 
-  std::string str(reinterpret_cast<const char *>(&storage_[rpos_]), length);
+  std::string str(reinterpret_cast<const char *>(storage_ + rpos_), length);
   rpos_ += length;
   return str;
 }
@@ -560,56 +902,19 @@ void ByteBuffer::Append(const uint8_t *src, size_t cnt) {
              "Attempted to put larger value in ByteBuffer (pos: {} size: {})",
              wpos_, GetSize());
 
-  FlushBits();
-
-  size_t const newSize = wpos_ + cnt;
-  if (storage_.capacity() < newSize) {
-    if (newSize < 100) {
-      storage_.reserve(300);
-    } else if (newSize < 750) {
-      storage_.reserve(2500);
-    } else if (newSize < 6000) {
-      storage_.reserve(10000);
-    } else {
-      storage_.reserve(400000);
-    }
-  }
-
-  if (storage_.size() < newSize) {
-    storage_.resize(newSize);
-  }
-  std::memcpy(&storage_[wpos_], src, cnt);
-  wpos_ = newSize;
+  std::memcpy(PrepareWrite(cnt), src, cnt);
 }
 
 void ByteBuffer::Append(const char *src, size_t cnt) {
   return Append(reinterpret_cast<const uint8_t *>(src), cnt);
 }
 
-template <typename T>
-void ByteBuffer::Append(const T *src, size_t cnt) {
-  return Append(reinterpret_cast<const uint8_t *>(src), cnt * sizeof(T));
-}
-
-template <typename T>
-void ByteBuffer::Append(T value) {
-  static_assert(std::is_trivially_copyable_v<T>,
-                "Append(T) must be used with trivially copyable types");
-  tpn::EndianRefMakeLittle(value);
-  Append(reinterpret_cast<uint8_t *>(&value), sizeof(value));
-}
-
 void ByteBuffer::Append(const ByteBuffer &buf) {
   if (!buf.IsEmpty()) {
     Append(buf.GetContents(), buf.GetSize());
   }
 }
 
-template <size_t Size>
-void ByteBuffer::Append(const std::array<uint8_t, Size> &arr) {
-  Append(arr.data(), Size);
-}
-
 void ByteBuffer::AppendPackedTime(time_t time) {
   auto lt = Localtime();
   Append<uint32_t>((lt.tm_year - 100) << 24 | lt.tm_mon << 20 |
@@ -618,40 +923,112 @@ void ByteBuffer::AppendPackedTime(time_t time) {
 }
 
 void ByteBuffer::AppendPackXYZ(float x, float y, float z) {
+  *this << PackXYZ(x, y, z);
+}
+
+void ByteBuffer::AppendPackXYZ(const float *xyz, size_t count) {
+  Writer writer = BeginWrite(count * kPackedXYZSize);
+  size_t i      = 0;
+#if defined(TPN_BYTE_BUFFER_AVX2)
+  for (; i + 8 <= count; i += 8, xyz += 24) {
+    __m128 x0, y0, z0, x1, y1, z1;
+    DeinterleaveXYZ(xyz, x0, y0, z0);
+    DeinterleaveXYZ(xyz + 12, x1, y1, z1);
+    const __m256 scale = _mm256_set1_ps(4.0f);
+    __m256i px = _mm256_and_si256(
+        _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_set_m128(x1, x0), scale)),
+        _mm256_set1_epi32(0x7FF));
+    __m256i py = _mm256_and_si256(
+        _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_set_m128(y1, y0), scale)),
+        _mm256_set1_epi32(0x7FF));
+    __m256i pz = _mm256_and_si256(
+        _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_set_m128(z1, z0), scale)),
+        _mm256_set1_epi32(0x3FF));
+    __m256i packed = _mm256_or_si256(
+        _mm256_or_si256(px, _mm256_slli_epi32(py, 11)),
+        _mm256_slli_epi32(pz, 22));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(writer.cursor_), packed);
+    writer.cursor_ += 8 * kPackedXYZSize;
+  }
+#endif
+#ifdef TPN_BYTE_BUFFER_SSE2
+  for (; i + 4 <= count; i += 4, xyz += 12) {
+    __m128 x, y, z;
+    DeinterleaveXYZ(xyz, x, y, z);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(writer.cursor_),
+                     PackXYZ4(x, y, z));
+    writer.cursor_ += 4 * kPackedXYZSize;
+  }
+#endif
+  for (; i < count; ++i, xyz += 3) {
+    writer.WritePackXYZ(xyz[0], xyz[1], xyz[2]);
+  }
+  EndWrite(writer);
+}
+
+uint32_t ByteBuffer::PackXYZ(float x, float y, float z) {
   uint32_t packed = 0;
   packed |= (static_cast<int>(x / 0.25f) & 0x7FF);
   packed |= (static_cast<int>(y / 0.25f) & 0x7FF) << 11;
   packed |= (static_cast<int>(z / 0.25f) & 0x3FF) << 22;
-  *this << packed;
+  return packed;
+}
+
+void ByteBuffer::UnpackXYZ(uint32_t packed, float &x, float &y, float &z) {
+  // 各分量按有符号数还原
+  x = float(static_cast<int32_t>(packed << 21) >> 21) * 0.25f;
+  y = float(static_cast<int32_t>(packed << 10) >> 21) * 0.25f;
+  z = float(static_cast<int32_t>(packed) >> 22) * 0.25f;
 }
 
 size_t ByteBuffer::PackUInt64(uint64_t value, uint8_t *mask, uint8_t *result) {
-  size_t result_size = 0;
-  *mask              = 0;
+  *mask = GetNonZeroByteMask(value);
   memset(result, 0, kInitialBitPos);
-
-  for (uint8_t i = 0; value != 0; ++i) {
-    if (value & 0xFF) {
-      *mask |= uint8_t(1 << i);
-      result[result_size++] = uint8_t(value & 0xFF);
-    }
-
-    value >>= 8;
-  }
-
-  return result_size;
+  return CompactBytes(value, *mask, result);
 }
 
 void ByteBuffer::AppendPackedUInt64(uint64_t guid) {
-  uint8_t mask = 0;
-  size_t pos   = GetWritePos();
-  *this << uint8_t(mask);
-
-  uint8_t packed[8];
-  if (size_t packed_size = PackUInt64(guid, &mask, packed)) {
-    Append(packed, packed_size);
+  Writer writer = BeginWrite(kPackedUInt64MaxSize);
+  writer.WritePackedUInt64(guid);
+  EndWrite(writer);
+}
+
+void ByteBuffer::AppendPackedUInt64(const uint64_t *values, size_t count) {
+  Writer writer   = BeginWrite(count * kPackedUInt64MaxSize);
+  uint8_t *cursor = writer.cursor_;
+  size_t i        = 0;
+  // 向量比较一次得到多个值的零字节掩码
+#if defined(TPN_BYTE_BUFFER_AVX2)
+  for (; i + 4 <= count; i += 4) {
+    __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+    uint32_t zero = static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(v, _mm256_setzero_si256())));
+    for (size_t j = 0; j < 4; ++j) {
+      uint8_t mask = static_cast<uint8_t>(~(zero >> (j * 8)));
+      *cursor++    = mask;
+      cursor += CompactBytes(values[i + j], mask, cursor);
+    }
+  }
+#elif defined(TPN_BYTE_BUFFER_SSE2)
+  for (; i + 2 <= count; i += 2) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+    uint32_t zero = static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())));
+    for (size_t j = 0; j < 2; ++j) {
+      uint8_t mask = static_cast<uint8_t>(~(zero >> (j * 8)));
+      *cursor++    = mask;
+      cursor += CompactBytes(values[i + j], mask, cursor);
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    uint8_t mask = GetNonZeroByteMask(values[i]);
+    *cursor++    = mask;
+    cursor += CompactBytes(values[i], mask, cursor);
   }
-  Put<uint8_t>(pos, mask);
+  writer.cursor_ = cursor;
+  EndWrite(writer);
 }
 
 void ByteBuffer::PrintStorage() const {
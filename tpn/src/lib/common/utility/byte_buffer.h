@@ -30,20 +30,109 @@
 #include <string>
 
 #include "common.h"
+#include "byte_converter.h"
 
 namespace tpn {
 
 class MessageBuffer;
 
 /// 字节流
+/// 小于 kByteBufferInlineSize 的内容存放在对象内部，更大时从缓冲池申请，
+/// 扩容不初始化新增的内存
 class TPN_COMMON_API ByteBuffer {
  public:
-  using storage_type = std::vector<uint8_t>;
-  using size_type    = storage_type::size_type;
-
-  static constexpr size_t kByteBufferDefaultSize = 0x1000;  ///< 默认字节流大小
-  static constexpr uint8_t kBoundaryBitPos       = 7;  ///< 边界字节位置
-  static constexpr uint8_t kInitialBitPos = 8;  ///< 字节位初始位置
+  using size_type = size_t;
+
+  static constexpr size_t kByteBufferInlineSize = 256;  ///< 内联存储大小
+  static constexpr uint8_t kBoundaryBitPos      = 7;    ///< 边界字节位置
+  static constexpr uint8_t kInitialBitPos       = 8;    ///< 字节位初始位置
+  static constexpr size_t kPackedUInt64MaxSize  = 9;  ///< 打包64位数据最大长度
+  static constexpr size_t kPackedXYZSize        = 4;  ///< 打包坐标长度
+
+  /// 无检查写游标
+  /// 由 @see BeginWrite 一次预留空间，之后的写入不再检查容量，
+  /// 写完调用 @see EndWrite 提交，期间不能再操作字节流
+  class TPN_COMMON_API Writer {
+   public:
+    /// 写入T类型数据，要求T类型是可平凡复制对象
+    ///  @tparam      T       T类型时可平凡复制对象
+    ///  @param[in]   value   T类型数据
+    template <typename T>
+    void Write(T value) {
+      static_assert(std::is_trivially_copyable_v<T>,
+                    "Write(T) must be used with trivially copyable types");
+      tpn::EndianRefMakeLittle(value);
+      std::memcpy(cursor_, &value, sizeof(value));
+      cursor_ += sizeof(value);
+    }
+
+    /// 写入数据
+    ///  @param[in]   src     数据地址
+    ///  @param[in]   cnt     数据字节个数
+    void Write(const void *src, size_t cnt) {
+      std::memcpy(cursor_, src, cnt);
+      cursor_ += cnt;
+    }
+
+    /// 写入打包的64位数据，最多 kPackedUInt64MaxSize 字节
+    ///  @param[in]   guid    64位数据
+    void WritePackedUInt64(uint64_t guid);
+
+    /// 写入打包的xyz坐标，kPackedXYZSize 字节
+    void WritePackXYZ(float x, float y, float z);
+
+   private:
+    friend class ByteBuffer;
+
+    Writer(uint8_t *begin, uint8_t *end) : cursor_(begin), end_(end) {}
+
+    uint8_t *cursor_;  ///< 写位置
+    uint8_t *end_;     ///< 预留空间结尾
+  };
+
+  /// 无检查读游标
+  /// 由 @see BeginRead 一次检查边界，之后的读取不再检查，
+  /// 读完调用 @see EndRead 提交，期间不能再操作字节流
+  class TPN_COMMON_API Reader {
+   public:
+    /// 读取指定类型的数据
+    ///  @tparam      T           读取的数据类型
+    ///  @tparam      Underlying  T底层类型
+    template <typename T, typename Underlying = T>
+    T Read() {
+      Underlying val;
+      std::memcpy(&val, cursor_, sizeof(Underlying));
+      cursor_ += sizeof(Underlying);
+      tpn::EndianRefMakeLittle(val);
+      return static_cast<T>(val);
+    }
+
+    /// 读取数据
+    ///  @param[out]  dest    读取数据存放地址
+    ///  @param[in]   len     读取的长度
+    void Read(void *dest, size_t len) {
+      std::memcpy(dest, cursor_, len);
+      cursor_ += len;
+    }
+
+    /// 读取打包的64位数据
+    /// 长度由掩码决定，超出检查范围时抛出异常
+    ///  @return 64位数据
+    uint64_t ReadPackedUInt64();
+
+    /// 获取剩余可读字节数
+    ///  @return 剩余可读字节数
+    size_t GetRemaining() const { return end_ - cursor_; }
+
+   private:
+    friend class ByteBuffer;
+
+    Reader(const uint8_t *begin, const uint8_t *end)
+        : cursor_(begin), end_(end) {}
+
+    const uint8_t *cursor_;  ///< 读位置
+    const uint8_t *end_;     ///< 检查范围结尾
+  };
 
   /// 构造函数预留标志
   struct ReserveFlag {};
@@ -64,15 +153,12 @@ class TPN_COMMON_API ByteBuffer {
   ByteBuffer(size_t size, ResizeFlag);
 
   /// 消息缓冲构造字节流
+  /// 消息缓冲来自缓冲池，数据会拷贝一份
   ///  @param[in]   buffer        消息缓冲
   ByteBuffer(MessageBuffer &&buffer);
 
-  /// 移动字节流
-  ///  @return 字节流缓冲区
-  storage_type &&Move() noexcept;
-
   /// 拷贝构造函数
-  ByteBuffer(const ByteBuffer &other) = default;
+  ByteBuffer(const ByteBuffer &other);
 
   /// 移动构造函数
   ByteBuffer(ByteBuffer &&other) noexcept;
@@ -84,7 +170,7 @@ class TPN_COMMON_API ByteBuffer {
   ByteBuffer &operator=(ByteBuffer &&other) noexcept;
 
   /// 析构函数
-  virtual ~ByteBuffer() = default;
+  virtual ~ByteBuffer();
 
   /// 获取读位置
   ///  @return 当前读位置
@@ -140,6 +226,30 @@ class TPN_COMMON_API ByteBuffer {
   ///  @param[in]   res_size    预留大小，如果预留大小小于原有长度则无效
   void Reserve(size_t res_size);
 
+  /// 获取字节流容量
+  ///  @return 不扩容最多可以写入的大小
+  size_t GetCapacity() const;
+
+  /// 开始批量写入
+  /// 只检查一次容量，适合按结构体编码
+  ///  @param[in]   bytes   最多写入的字节数
+  ///  @return 写游标
+  Writer BeginWrite(size_t bytes);
+
+  /// 结束批量写入，按实际写入的长度更新写位置
+  ///  @param[in]   writer  @see BeginWrite 返回的写游标
+  void EndWrite(const Writer &writer);
+
+  /// 开始批量读取
+  /// 只检查一次边界，不足时抛出异常，适合按结构体解码
+  ///  @param[in]   bytes   读取的字节数
+  ///  @return 读游标
+  Reader BeginRead(size_t bytes);
+
+  /// 结束批量读取，按实际读取的长度更新读位置
+  ///  @param[in]   reader  @see BeginRead 返回的读游标
+  void EndRead(const Reader &reader);
+
   /// 清空字节流
   void Clear();
 
@@ -174,6 +284,18 @@ class TPN_COMMON_API ByteBuffer {
   ///  @return 长度bits位的数据
   uint32_t ReadBits(int32_t bits);
 
+  /// 批量以bit方式写入，结果与逐个调用 @see WriteBits 相同
+  ///  @param[in]   values    写入的值
+  ///  @param[in]   count     值个数
+  ///  @param[in]   bits      每个值的位数，不超过32
+  void WriteBits(const uint32_t *values, size_t count, int32_t bits);
+
+  /// 批量读取bit值，结果与逐个调用 @see ReadBits 相同
+  ///  @param[out]  values    读出的值
+  ///  @param[in]   count     值个数
+  ///  @param[in]   bits      每个值的位数，不超过32
+  void ReadBits(uint32_t *values, size_t count, int32_t bits);
+
   /// 指定数量的值放置在数据包中的指定位置
   ///  @param[in]   pos       放置值得位置，以bit为单位
   ///  @param[in]   src       写入值的地址
@@ -268,6 +390,16 @@ class TPN_COMMON_API ByteBuffer {
   ///  @param[in]   mask        掩码 字节中bit位为1的位置将被读取 64 / 8 对应字节中的8位
   void ReadPackedUInt64(uint8_t mask, uint64_t &value);
 
+  /// 批量读取打包的64位数据
+  ///  @param[out]  values      读取存放的64位数据
+  ///  @param[in]   count       个数
+  void ReadPackedUInt64(uint64_t *values, size_t count);
+
+  /// 批量读取xyz类型坐标数据
+  ///  @param[out]  xyz         按x、y、z交错存放的坐标
+  ///  @param[in]   count       坐标个数
+  void ReadPackXYZ(float *xyz, size_t count);
+
   /// 读取指定长度字符串
   ///  @param[in]   length      指定长度
   ///  @return 读取的结果字符串
@@ -327,6 +459,22 @@ class TPN_COMMON_API ByteBuffer {
   /// 字节流中添加 xyz类型坐标数据
   void AppendPackXYZ(float x, float y, float z);
 
+  /// 字节流中批量添加 xyz类型坐标数据，结果与逐个添加相同
+  ///  @param[in]   xyz     按x、y、z交错存放的坐标
+  ///  @param[in]   count   坐标个数
+  void AppendPackXYZ(const float *xyz, size_t count);
+
+  /// 打包xyz类型坐标数据
+  ///  @return 打包结果
+  static uint32_t PackXYZ(float x, float y, float z);
+
+  /// 解包xyz类型坐标数据，精度为打包时的0.25
+  ///  @param[in]   packed  打包结果
+  ///  @param[out]  x       x坐标
+  ///  @param[out]  y       y坐标
+  ///  @param[out]  z       z坐标
+  static void UnpackXYZ(uint32_t packed, float &x, float &y, float &z);
+
   /// 打包64位数据
   ///  @param[in]   value   64位数据
   ///  @param[out]  mask    掩码
@@ -337,6 +485,11 @@ class TPN_COMMON_API ByteBuffer {
   /// 字节流中添加64位数据
   void AppendPackedUInt64(uint64_t guid);
 
+  /// 字节流中批量添加64位数据，结果与逐个添加相同
+  ///  @param[in]   values  64位数据
+  ///  @param[in]   count   个数
+  void AppendPackedUInt64(const uint64_t *values, size_t count);
+
   /// 打印字节流数据
   /// 日志模式打开 并且允许TRACE模式本函数有效
   void PrintStorage() const;
@@ -350,13 +503,117 @@ class TPN_COMMON_API ByteBuffer {
   void Hexlike() const;
 
  private:
-  size_type rpos_{0};       ///< 读位置
-  size_type wpos_{0};       ///< 写位置
-  size_type bitpos_{0};     ///< 字节流位置
-  uint8_t cur_bit_val_{0};  ///< 当前字节流位置的值
-  storage_type storage_;    ///< 字节流存储器
+  /// 是否使用内联存储
+  bool IsInline() const { return storage_ == inline_storage_; }
+
+  /// 扩容，保留已有内容
+  ///  @param[in]   min_capacity  最小容量
+  void Grow(size_t min_capacity);
+
+  /// 归还缓冲池申请的存储，恢复内联存储
+  void ReleaseStorage();
+
+  /// 接管另一个字节流的存储，另一个字节流被清空
+  ///  @param[in]   other   另一个字节流
+  void TakeStorage(ByteBuffer &other) noexcept;
+
+  /// 准备写入
+  ///  @param[in]   cnt     写入字节个数
+  ///  @return 写入地址
+  uint8_t *PrepareWrite(size_t cnt) {
+    FlushBits();
+    size_t const new_size = wpos_ + cnt;
+    if (new_size > capacity_) [[unlikely]] {
+      Grow(new_size);
+    }
+    if (new_size > size_) {
+      if (wpos_ > size_) [[unlikely]] {
+        std::memset(storage_ + size_, 0, wpos_ - size_);
+      }
+      size_ = new_size;
+    }
+    uint8_t *dest = storage_ + wpos_;
+    wpos_         = new_size;
+    return dest;
+  }
+
+  /// 读越界
+  ///  @param[in]   pos     读位置
+  ///  @param[in]   len     读取长度
+  void ThrowReadOverflow(size_t pos, size_t len) const;
+
+ private:
+  size_type rpos_{0};                          ///< 读位置
+  size_type wpos_{0};                          ///< 写位置
+  size_type bitpos_{0};                        ///< 字节流位置
+  uint8_t cur_bit_val_{0};                     ///< 当前字节流位置的值
+  size_type size_{0};                          ///< 字节流大小
+  size_type capacity_{kByteBufferInlineSize};  ///< 字节流容量
+  uint8_t *storage_{inline_storage_};          ///< 字节流存储器
+  alignas(8) uint8_t inline_storage_[kByteBufferInlineSize];  ///< 内联存储
 };
 
+inline void ByteBuffer::FlushBits() {
+  if (kInitialBitPos == bitpos_) [[likely]] {
+    return;
+  }
+  bitpos_ = kInitialBitPos;
+  Append(&cur_bit_val_, sizeof(uint8_t));
+  cur_bit_val_ = 0;
+}
+
+inline void ByteBuffer::ResetBitPos() {
+  if (bitpos_ > kBoundaryBitPos) [[likely]] {
+    return;
+  }
+  bitpos_      = kInitialBitPos;
+  cur_bit_val_ = 0;
+}
+
+template <typename T>
+void ByteBuffer::Read(T *dest, size_t count) {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "Read(T*, size_t) must be used with trivially copyable types");
+  return Read(reinterpret_cast<uint8_t *>(dest), count * sizeof(T));
+}
+
+template <typename T, typename Underlying /* = T */>
+T ByteBuffer::Read() {
+  ResetBitPos();
+  T r = Read<T, Underlying>(rpos_);
+  rpos_ += sizeof(Underlying);
+  return r;
+}
+
+template <typename T, typename Underlying /* = T */>
+T ByteBuffer::Read(size_t pos) const {
+  if (pos + sizeof(Underlying) > size_) [[unlikely]] {
+    ThrowReadOverflow(pos, sizeof(Underlying));
+  }
+  Underlying val;
+  std::memcpy(&val, storage_ + pos, sizeof(Underlying));
+  tpn::EndianRefMakeLittle(val);
+  return static_cast<T>(val);
+}
+
+template <typename T>
+void ByteBuffer::Append(const T *src, size_t cnt) {
+  return Append(reinterpret_cast<const uint8_t *>(src), cnt * sizeof(T));
+}
+
+template <typename T>
+void ByteBuffer::Append(T value) {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "Append(T) must be used with trivially copyable types");
+  tpn::EndianRefMakeLittle(value);
+  std::memcpy(PrepareWrite(sizeof(value)), &value, sizeof(value));
+}
+
+template <size_t Size>
+void ByteBuffer::Append(const std::array<uint8_t, Size> &arr) {
+  Append(arr.data(), Size);
+}
+
 }  // namespace tpn
 
 #endif  // TYPHOON_ZERO_TPN_SRC_LIB_COMMON_UTILITY_BYTE_BUFFER_H_
@@ -0,0 +1,152 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "coarse_clock.h"
+
+#include <cstring>
+
+#include "fmt_wrap.h"
+#include "platform.h"
+#include "periodic_worker.h"
+
+namespace tpn {
+
+namespace {
+
+/// 打包时间字符串
+///  @param[in]   str       时间字符串
+///  @param[out]  packed    打包后的字符串
+template <typename Packed>
+void PackDateTime(const char *str, Packed &packed) {
+  char buf[sizeof(uint64_t) * std::tuple_size_v<Packed>] = {};
+  std::memcpy(buf, str, kCoarseDateTimeSize);
+  for (size_t i = 0; i < packed.size(); ++i) {
+    uint64_t word = 0;
+    std::memcpy(&word, buf + i * sizeof(uint64_t), sizeof(uint64_t));
+    packed[i].store(word, std::memory_order_relaxed);
+  }
+}
+
+/// 解包时间字符串
+///  @param[in]   packed    打包的字符串
+///  @param[out]  str       时间字符串
+template <typename Packed>
+void UnpackDateTime(const Packed &packed, char *str) {
+  char buf[sizeof(uint64_t) * std::tuple_size_v<Packed>];
+  for (size_t i = 0; i < packed.size(); ++i) {
+    uint64_t word = packed[i].load(std::memory_order_relaxed);
+    std::memcpy(buf + i * sizeof(uint64_t), &word, sizeof(uint64_t));
+  }
+  std::memcpy(str, buf, kCoarseDateTimeSize);
+}
+
+}  // namespace
+
+void CoarseClock::Enable(CoarseClockUser user) {
+  std::lock_guard<std::mutex> lock(this->worker_mutex_);
+
+  if (!this->worker_) {
+    this->Update();
+    this->worker_ = std::make_unique<PeriodicWorker>([this]() { Update(); },
+                                                     kCoarseClockResolution);
+  }
+  this->users_.fetch_or(EnumToUnderlyType(user), std::memory_order_relaxed);
+}
+
+void CoarseClock::Disable(CoarseClockUser user) {
+  std::lock_guard<std::mutex> lock(this->worker_mutex_);
+
+  uint32_t users = this->users_.fetch_and(~EnumToUnderlyType(user),
+                                          std::memory_order_relaxed) &
+                   ~EnumToUnderlyType(user);
+  if (0 == users) {
+    this->worker_.reset();
+  }
+}
+
+void CoarseClock::Update() {
+  // 多个线程同时刷新时只需要一个生效
+  if (this->updating_.test_and_set(std::memory_order_acquire)) {
+    return;
+  }
+
+  auto now = SystemClock::now();
+  this->system_now_.store(now.time_since_epoch().count(),
+                          std::memory_order_relaxed);
+  this->steady_now_.store(SteadyClock::now().time_since_epoch().count(),
+                          std::memory_order_relaxed);
+
+  if (std::chrono::duration_cast<Seconds>(now.time_since_epoch()).count() !=
+      this->datetime_secs_.load(std::memory_order_relaxed)) {
+    this->UpdateDateTime(now);
+  }
+
+  this->updating_.clear(std::memory_order_release);
+}
+
+void CoarseClock::UpdateDateTime(SystemClock::time_point now) {
+  std::time_t now_tt = SystemClock::to_time_t(now);
+  auto secs = std::chrono::duration_cast<Seconds>(now.time_since_epoch());
+
+  FmtMemoryBuf local_buf, utc_buf;
+  fmt::format_to(local_buf, "{:%Y-%m-%d %H:%M:%S}", Localtime(now_tt));
+  fmt::format_to(utc_buf, "{:%Y-%m-%d %H:%M:%S}", GmTime(now_tt));
+  if (kCoarseDateTimeSize != local_buf.size() ||
+      kCoarseDateTimeSize != utc_buf.size()) {
+    return;
+  }
+
+  // 顺序锁，写入期间序号为奇数
+  this->datetime_seq_.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  PackDateTime(local_buf.data(), this->datetime_local_);
+  PackDateTime(utc_buf.data(), this->datetime_utc_);
+  this->datetime_secs_.store(secs.count(), std::memory_order_relaxed);
+
+  this->datetime_seq_.fetch_add(1, std::memory_order_release);
+}
+
+bool CoarseClock::CopyDateTime(SystemClock::time_point tp, bool utc,
+                               char (&out)[kCoarseDateTimeSize]) const {
+  auto secs = std::chrono::duration_cast<Seconds>(tp.time_since_epoch());
+
+  for (int retry = 0; retry < 3; ++retry) {
+    uint32_t seq = this->datetime_seq_.load(std::memory_order_acquire);
+    if (seq & 1) {
+      continue;
+    }
+
+    int64_t cached_secs = this->datetime_secs_.load(std::memory_order_relaxed);
+    UnpackDateTime(utc ? this->datetime_utc_ : this->datetime_local_, out);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq == this->datetime_seq_.load(std::memory_order_relaxed)) {
+      return secs.count() == cached_secs;
+    }
+  }
+  return false;
+}
+
+TPN_SINGLETON_IMPL(CoarseClock)
+
+}  // namespace tpn
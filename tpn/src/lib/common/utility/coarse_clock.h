@@ -0,0 +1,139 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_COMMON_UTILITY_COARSE_CLOCK_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_COMMON_UTILITY_COARSE_CLOCK_H_
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "define.h"
+#include "chrono_wrap.h"
+#include "utils.h"
+
+namespace tpn {
+
+class PeriodicWorker;
+
+/// 粗粒度时钟刷新间隔 1毫秒
+static constexpr MilliSeconds kCoarseClockResolution{1};
+
+/// 缓存的时间字符串长度 "%Y-%m-%d %H:%M:%S"
+static constexpr size_t kCoarseDateTimeSize = 19;
+
+/// 粗粒度时钟使用者，每个子系统单独开启
+enum class CoarseClockUser : uint32_t {
+  kCoarseClockUserNone = 0x0,
+  /// 日志时间戳与时间字符串
+  kCoarseClockUserLog = 0x1,
+  /// 网络存活时间、连接时间与kcp时钟
+  kCoarseClockUserNet = 0x1 << 1,
+};
+
+/// 粗粒度时钟
+/// 后台线程每 kCoarseClockResolution 读取一次系统时钟和稳定时钟写入原子变量，
+/// 热点代码用一次relaxed读取代替clock_gettime，同时每秒缓存一次格式化好的时间字符串。
+/// 只有开启了的子系统才会读取缓存，未开启的子系统仍然直接读取时钟，
+/// 第一个子系统开启时启动后台线程，全部关闭时停止。
+class TPN_COMMON_API CoarseClock {
+ public:
+  /// 开启子系统
+  ///  @param[in]   user      子系统
+  void Enable(CoarseClockUser user);
+
+  /// 关闭子系统
+  ///  @param[in]   user      子系统
+  void Disable(CoarseClockUser user);
+
+  /// 子系统是否开启
+  ///  @param[in]   user      子系统
+  ///  @return 开启返回true
+  TPN_INLINE bool IsEnabled(CoarseClockUser user) const {
+    return 0 != (this->users_.load(std::memory_order_relaxed) &
+                 EnumToUnderlyType(user));
+  }
+
+  /// 刷新一次缓存，后台线程定时调用，io循环等也可以主动调用提高精度
+  void Update();
+
+  /// 获取系统时间，子系统未开启时直接读取系统时钟
+  ///  @param[in]   user      子系统
+  ///  @return 系统时间
+  TPN_INLINE SystemClock::time_point SystemNow(CoarseClockUser user) const {
+    if (!this->IsEnabled(user)) {
+      return SystemClock::now();
+    }
+    return SystemClock::time_point(SystemClock::duration(
+        this->system_now_.load(std::memory_order_relaxed)));
+  }
+
+  /// 获取稳定时钟时间，子系统未开启时直接读取稳定时钟
+  ///  @param[in]   user      子系统
+  ///  @return 稳定时钟时间
+  TPN_INLINE SteadyClock::time_point SteadyNow(CoarseClockUser user) const {
+    if (!this->IsEnabled(user)) {
+      return SteadyClock::now();
+    }
+    return SteadyClock::time_point(SteadyClock::duration(
+        this->steady_now_.load(std::memory_order_relaxed)));
+  }
+
+  /// 复制缓存的时间字符串 "%Y-%m-%d %H:%M:%S"
+  ///  @param[in]   tp        时间点，只有和缓存同一秒时才复制
+  ///  @param[in]   utc       true为世界协调时间，false为当地时间
+  ///  @param[out]  out       时间字符串，不以0结尾
+  ///  @return 缓存与时间点同一秒返回true
+  bool CopyDateTime(SystemClock::time_point tp, bool utc,
+                    char (&out)[kCoarseDateTimeSize]) const;
+
+ private:
+  /// 按8字节打包的时间字符串，便于原子读写
+  using PackedDateTime =
+      std::array<std::atomic<uint64_t>, (kCoarseDateTimeSize + 7) / 8>;
+
+  /// 更新缓存的时间字符串
+  ///  @param[in]   now       当前时间
+  void UpdateDateTime(SystemClock::time_point now);
+
+ private:
+  std::atomic<uint32_t> users_{0};                 ///< 开启的子系统
+  std::atomic<SystemClock::rep> system_now_{0};    ///< 缓存的系统时间
+  std::atomic<SteadyClock::rep> steady_now_{0};    ///< 缓存的稳定时钟时间
+  std::atomic_flag updating_ = ATOMIC_FLAG_INIT;   ///< 是否有线程正在刷新
+  std::atomic<uint32_t> datetime_seq_{0};          ///< 时间字符串顺序锁
+  std::atomic<int64_t> datetime_secs_{-1};         ///< 时间字符串对应的秒
+  PackedDateTime datetime_local_{};                ///< 当地时间字符串
+  PackedDateTime datetime_utc_{};                  ///< 世界协调时间字符串
+  std::mutex worker_mutex_;                        ///< 后台线程锁
+  std::unique_ptr<PeriodicWorker> worker_;         ///< 后台刷新线程
+
+  TPN_SINGLETON_DECL(CoarseClock)
+};
+
+}  // namespace tpn
+
+/// global coarse clock instance
+#define g_coarse_clock tpn::CoarseClock::Instance()
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_COMMON_UTILITY_COARSE_CLOCK_H_
@@ -0,0 +1,374 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "flat_data.h"
+
+#include <cstring>
+
+#include <filesystem>
+#include <fstream>
+
+#if (TPN_PLATFORM == TPN_PLATFORM_WIN)
+#  include <Windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+#include "fmt_wrap.h"
+
+namespace fs = std::filesystem;
+
+namespace tpn {
+
+namespace {
+
+/// 按对齐向上取整
+constexpr uint64_t AlignUp(uint64_t value, uint64_t align) {
+  return (value + align - 1) / align * align;
+}
+
+}  // namespace
+
+void FlatDataWriter::Reset() {
+  tables_.clear();
+  string_pool_.clear();
+  string_index_.clear();
+}
+
+FlatDataStr FlatDataWriter::AppendString(std::string_view str) {
+  if (str.empty()) {
+    return {0, 0};
+  }
+
+  std::string key(str.data(), str.length());
+  auto iter = string_index_.find(key);
+  if (string_index_.end() != iter) {
+    return iter->second;
+  }
+
+  FlatDataStr ret{static_cast<uint32_t>(string_pool_.size()),
+                  static_cast<uint32_t>(str.length())};
+  string_pool_.append(str.data(), str.length());
+  string_index_.emplace(std::move(key), ret);
+  return ret;
+}
+
+std::string_view FlatDataWriter::GetString(const FlatDataStr &str) const {
+  if (static_cast<uint64_t>(str.offset) + str.length > string_pool_.size()) {
+    return {};
+  }
+  return {string_pool_.data() + str.offset, str.length};
+}
+
+bool FlatDataWriter::AddTable(std::string_view name, uint32_t row_size,
+                              std::vector<uint8_t> &&rows) {
+  if (name.empty() || name.length() >= kFlatDataTableNameSize ||
+      0 == row_size || 0 != rows.size() % row_size) {
+    return false;
+  }
+
+  for (auto &&table : tables_) {
+    if (table.name == name) {
+      return false;
+    }
+  }
+
+  tables_.emplace_back(
+      TableData{std::string(name.data(), name.length()), row_size,
+                std::move(rows)});
+  return true;
+}
+
+std::vector<uint8_t> FlatDataWriter::Serialize() const {
+  uint64_t offset = sizeof(FlatDataHeader) +
+                    sizeof(FlatDataTable) * static_cast<uint64_t>(tables_.size());
+
+  std::vector<FlatDataTable> table_descs(tables_.size());
+  for (size_t i = 0; i < tables_.size(); ++i) {
+    auto &desc = table_descs[i];
+    std::memset(&desc, 0, sizeof(desc));
+    std::memcpy(desc.name, tables_[i].name.data(), tables_[i].name.length());
+    offset           = AlignUp(offset, kFlatDataAlignment);
+    desc.rows_offset = offset;
+    desc.row_size    = tables_[i].row_size;
+    desc.row_count =
+        static_cast<uint32_t>(tables_[i].rows.size() / tables_[i].row_size);
+    offset += tables_[i].rows.size();
+  }
+
+  FlatDataHeader header;
+  std::memset(&header, 0, sizeof(header));
+  header.magic              = kFlatDataMagic;
+  header.version            = kFlatDataVersion;
+  header.table_count        = static_cast<uint32_t>(tables_.size());
+  header.string_pool_offset = AlignUp(offset, kFlatDataAlignment);
+  header.string_pool_size   = string_pool_.size();
+
+  std::vector<uint8_t> ret(header.string_pool_offset + string_pool_.size(), 0);
+  std::memcpy(ret.data(), &header, sizeof(header));
+  if (!table_descs.empty()) {
+    std::memcpy(ret.data() + sizeof(header), table_descs.data(),
+                sizeof(FlatDataTable) * table_descs.size());
+  }
+  for (size_t i = 0; i < tables_.size(); ++i) {
+    if (!tables_[i].rows.empty()) {
+      std::memcpy(ret.data() + table_descs[i].rows_offset,
+                  tables_[i].rows.data(), tables_[i].rows.size());
+    }
+  }
+  if (!string_pool_.empty()) {
+    std::memcpy(ret.data() + header.string_pool_offset, string_pool_.data(),
+                string_pool_.size());
+  }
+
+  return ret;
+}
+
+bool FlatDataWriter::Write(std::string_view path, std::string &error) const {
+  auto flat_path = fs::path(path);
+  flat_path.make_preferred();
+  auto flat_file = fs::absolute(flat_path);
+
+  try {
+    if (!fs::exists(flat_file.parent_path())) {
+      fs::create_directories(flat_file.parent_path());
+    }
+
+    auto content = Serialize();
+    std::fstream output(flat_file, std::fstream::out | std::fstream::trunc |
+                                       std::fstream::binary);
+    if (!output) {
+      error = fmt::format("file open failed ({}) ", path);
+      return false;
+    }
+    output.write(reinterpret_cast<const char *>(content.data()),
+                 static_cast<std::streamsize>(content.size()));
+    if (!output) {
+      error = fmt::format("file write failed ({}) ", path);
+      return false;
+    }
+  } catch (fs::filesystem_error &e) {
+    error = fmt::format("{} ({}) ", e.what(), path);
+    return false;
+  } catch (const std::exception &ex) {
+    error = fmt::format("{} ({}) ", ex.what(), path);
+    return false;
+  }
+
+  return true;
+}
+
+FlatDataFile::~FlatDataFile() { Close(); }
+
+bool FlatDataFile::Open(std::string_view path, std::string &error) {
+  Close();
+
+  path_ = {path.data(), path.size()};
+
+  auto flat_path = fs::path(path_);
+  flat_path.make_preferred();
+  auto flat_file = fs::absolute(flat_path);
+
+#if (TPN_PLATFORM == TPN_PLATFORM_WIN)
+  HANDLE file = ::CreateFileW(flat_file.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+  if (INVALID_HANDLE_VALUE == file) {
+    error = "file not found (" + path_ + ") ";
+    return false;
+  }
+
+  LARGE_INTEGER file_size;
+  if (!::GetFileSizeEx(file, &file_size) || 0 == file_size.QuadPart) {
+    ::CloseHandle(file);
+    error = "file empty (" + path_ + ") ";
+    return false;
+  }
+
+  HANDLE mapping =
+      ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (nullptr == mapping) {
+    ::CloseHandle(file);
+    error = "file mapping failed (" + path_ + ") ";
+    return false;
+  }
+
+  auto *addr = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (nullptr == addr) {
+    ::CloseHandle(mapping);
+    ::CloseHandle(file);
+    error = "file mapping failed (" + path_ + ") ";
+    return false;
+  }
+
+  file_handle_ = file;
+  map_handle_  = mapping;
+  data_        = static_cast<const uint8_t *>(addr);
+  size_        = static_cast<size_t>(file_size.QuadPart);
+#else
+  int fd = ::open(flat_file.c_str(), O_RDONLY);
+  if (-1 == fd) {
+    error = "file not found (" + path_ + ") ";
+    return false;
+  }
+
+  struct stat st;
+  if (0 != ::fstat(fd, &st) || 0 == st.st_size) {
+    ::close(fd);
+    error = "file empty (" + path_ + ") ";
+    return false;
+  }
+
+  auto *addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                      MAP_SHARED, fd, 0);
+  // 映射建立后文件描述符可以直接关闭
+  ::close(fd);
+  if (MAP_FAILED == addr) {
+    error = "file mapping failed (" + path_ + ") ";
+    return false;
+  }
+
+  data_ = static_cast<const uint8_t *>(addr);
+  size_ = static_cast<size_t>(st.st_size);
+#endif
+
+  if (!Validate(error)) {
+    Close();
+    return false;
+  }
+
+  return true;
+}
+
+void FlatDataFile::Close() {
+  if (nullptr == data_) {
+    return;
+  }
+
+#if (TPN_PLATFORM == TPN_PLATFORM_WIN)
+  ::UnmapViewOfFile(data_);
+  ::CloseHandle(static_cast<HANDLE>(map_handle_));
+  ::CloseHandle(static_cast<HANDLE>(file_handle_));
+#else
+  ::munmap(const_cast<uint8_t *>(data_), size_);
+#endif
+
+  data_        = nullptr;
+  size_        = 0;
+  file_handle_ = nullptr;
+  map_handle_  = nullptr;
+}
+
+bool FlatDataFile::IsOpen() const { return nullptr != data_; }
+
+size_t FlatDataFile::Size() const { return size_; }
+
+const FlatDataTable *FlatDataFile::FindTable(std::string_view name) const {
+  if (nullptr == data_) {
+    return nullptr;
+  }
+
+  auto *header = reinterpret_cast<const FlatDataHeader *>(data_);
+  auto *tables =
+      reinterpret_cast<const FlatDataTable *>(data_ + sizeof(FlatDataHeader));
+  for (uint32_t i = 0; i < header->table_count; ++i) {
+    if (name == tables[i].name) {
+      return &tables[i];
+    }
+  }
+
+  return nullptr;
+}
+
+std::string_view FlatDataFile::GetString(const FlatDataStr &str) const {
+  auto *header = reinterpret_cast<const FlatDataHeader *>(data_);
+  if (nullptr == data_ ||
+      static_cast<uint64_t>(str.offset) + str.length >
+          header->string_pool_size) {
+    return {};
+  }
+
+  return {reinterpret_cast<const char *>(data_ + header->string_pool_offset +
+                                         str.offset),
+          str.length};
+}
+
+bool FlatDataFile::Validate(std::string &error) const {
+  if (size_ < sizeof(FlatDataHeader)) {
+    error = "file too small (" + path_ + ") ";
+    return false;
+  }
+
+  auto *header = reinterpret_cast<const FlatDataHeader *>(data_);
+  if (kFlatDataMagic != header->magic) {
+    error = "file magic error (" + path_ + ") ";
+    return false;
+  }
+
+  if (kFlatDataVersion != header->version) {
+    error = fmt::format("file version error, {} != {} ({}) ", header->version,
+                        kFlatDataVersion, path_);
+    return false;
+  }
+
+  uint64_t tables_end =
+      sizeof(FlatDataHeader) +
+      sizeof(FlatDataTable) * static_cast<uint64_t>(header->table_count);
+  if (tables_end > size_) {
+    error = "file table overflow (" + path_ + ") ";
+    return false;
+  }
+
+  // 先确认偏移在文件内 再与剩余大小比较 避免偏移加大小回绕
+  if (header->string_pool_offset < tables_end ||
+      header->string_pool_offset > size_ ||
+      header->string_pool_size > size_ - header->string_pool_offset) {
+    error = "file string pool overflow (" + path_ + ") ";
+    return false;
+  }
+
+  auto *tables =
+      reinterpret_cast<const FlatDataTable *>(data_ + sizeof(FlatDataHeader));
+  for (uint32_t i = 0; i < header->table_count; ++i) {
+    auto &table = tables[i];
+    if (0 != table.name[kFlatDataTableNameSize - 1]) {
+      error = fmt::format("file table {} name error ({}) ", i, path_);
+      return false;
+    }
+
+    if (0 != table.rows_offset % kFlatDataAlignment ||
+        table.rows_offset < tables_end || table.rows_offset > size_ ||
+        static_cast<uint64_t>(table.row_count) * table.row_size >
+            size_ - table.rows_offset) {
+      error = fmt::format("file table {} rows overflow ({}) ", table.name,
+                          path_);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace tpn
@@ -0,0 +1,211 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_COMMON_UTILITY_FLAT_DATA_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_COMMON_UTILITY_FLAT_DATA_H_
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "define.h"
+
+namespace tpn {
+
+/// 平坦数据格式
+/// 文件布局(小端, 所有偏移相对文件起始):
+///   FlatDataHeader | FlatDataTable[table_count] | 各表行数据 | 字符串池
+/// 每张表为定长行, 行内字段按自然对齐排列, 行起始按 kFlatDataAlignment 对齐
+/// 字符串统一存放在字符串池中, 行内仅保存 FlatDataStr 引用
+/// 文件可以直接 mmap 后原地查询, 无需解析
+
+/// 平坦数据文件魔数 "TPNF"
+inline constexpr uint32_t kFlatDataMagic = 0x464E5054;
+/// 平坦数据格式版本
+inline constexpr uint32_t kFlatDataVersion = 1;
+/// 行数据起始对齐
+inline constexpr size_t kFlatDataAlignment = 8;
+/// 表名最大长度(包含结尾0)
+inline constexpr size_t kFlatDataTableNameSize = 64;
+
+/// 字符串引用
+struct FlatDataStr {
+  uint32_t offset;  ///< 字符串池内偏移
+  uint32_t length;  ///< 字符串长度
+};
+
+/// 文件头
+struct FlatDataHeader {
+  uint32_t magic;               ///< 魔数
+  uint32_t version;             ///< 版本
+  uint32_t table_count;         ///< 表数量
+  uint32_t reserved;            ///< 保留
+  uint64_t string_pool_offset;  ///< 字符串池偏移
+  uint64_t string_pool_size;    ///< 字符串池大小
+};
+
+/// 表描述
+struct FlatDataTable {
+  char name[kFlatDataTableNameSize];  ///< 表名
+  uint64_t rows_offset;               ///< 行数据偏移
+  uint32_t row_count;                 ///< 行数
+  uint32_t row_size;                  ///< 行大小
+};
+
+static_assert(8 == sizeof(FlatDataStr), "FlatDataStr layout changed");
+static_assert(32 == sizeof(FlatDataHeader), "FlatDataHeader layout changed");
+static_assert(80 == sizeof(FlatDataTable), "FlatDataTable layout changed");
+
+/// 平坦数据写入器
+/// 生成工具使用, 表按添加顺序写入, 字符串按首次出现顺序写入字符串池
+class TPN_COMMON_API FlatDataWriter {
+ public:
+  FlatDataWriter() = default;
+  ~FlatDataWriter() = default;
+
+  /// 重置
+  void Reset();
+
+  /// 添加字符串到字符串池
+  /// 相同内容的字符串只存一份
+  ///  @param[in]   str       字符串
+  ///  @return 字符串引用
+  FlatDataStr AppendString(std::string_view str);
+
+  /// 获取字符串池中的字符串
+  ///  @param[in]   str       字符串引用
+  ///  @return 字符串
+  std::string_view GetString(const FlatDataStr &str) const;
+
+  /// 添加表
+  ///  @param[in]   name      表名
+  ///  @param[in]   row_size  行大小
+  ///  @param[in]   rows      行数据 大小必须为row_size的整数倍
+  ///  @return 成功返回true
+  bool AddTable(std::string_view name, uint32_t row_size,
+                std::vector<uint8_t> &&rows);
+
+  /// 序列化
+  ///  @return 文件内容
+  std::vector<uint8_t> Serialize() const;
+
+  /// 写入文件
+  ///  @param[in]   path      文件路径
+  ///  @param[out]  error     错误信息
+  ///  @return 成功返回true
+  bool Write(std::string_view path, std::string &error) const;
+
+ private:
+  /// 表数据
+  struct TableData {
+    std::string name;           ///< 表名
+    uint32_t row_size{0};       ///< 行大小
+    std::vector<uint8_t> rows;  ///< 行数据
+  };
+
+  std::vector<TableData> tables_;  ///< 表
+  std::string string_pool_;        ///< 字符串池
+  std::unordered_map<std::string, FlatDataStr> string_index_;  ///< 字符串索引
+
+  TPN_NO_COPYABLE(FlatDataWriter)
+};
+
+/// 平坦数据文件
+/// 只读映射文件, 映射期间通过 GetRows 拿到的行数据保持有效
+class TPN_COMMON_API FlatDataFile {
+ public:
+  FlatDataFile() = default;
+  ~FlatDataFile();
+
+  /// 打开并映射文件
+  /// 已经打开的文件会先关闭
+  ///  @param[in]   path      文件路径
+  ///  @param[out]  error     错误信息
+  ///  @return 成功返回true
+  bool Open(std::string_view path, std::string &error);
+
+  /// 关闭文件
+  void Close();
+
+  /// 是否已经打开
+  ///  @return 已打开返回true
+  bool IsOpen() const;
+
+  /// 获取映射大小
+  ///  @return 映射大小
+  size_t Size() const;
+
+  /// 查找表
+  ///  @param[in]   name      表名
+  ///  @return 表描述 不存在返回nullptr
+  const FlatDataTable *FindTable(std::string_view name) const;
+
+  /// 获取表行数据
+  ///  @tparam      RowType   行类型 大小必须与表中行大小一致
+  ///  @param[in]   name      表名
+  ///  @param[out]  rows      行数据
+  ///  @return 表存在且行大小一致返回true
+  template <typename RowType>
+  bool GetRows(std::string_view name, std::span<const RowType> &rows) const {
+    static_assert(std::is_trivially_copyable_v<RowType>,
+                  "flat row type must be trivially copyable");
+    static_assert(alignof(RowType) <= kFlatDataAlignment,
+                  "flat row type alignment overflow");
+
+    auto *table = FindTable(name);
+    if (nullptr == table || sizeof(RowType) != table->row_size) {
+      return false;
+    }
+
+    rows = {reinterpret_cast<const RowType *>(data_ + table->rows_offset),
+            table->row_count};
+    return true;
+  }
+
+  /// 获取字符串
+  ///  @param[in]   str       字符串引用
+  ///  @return 字符串 越界返回空
+  std::string_view GetString(const FlatDataStr &str) const;
+
+ private:
+  /// 校验映射内容
+  ///  @param[out]  error     错误信息
+  ///  @return 成功返回true
+  bool Validate(std::string &error) const;
+
+ private:
+  const uint8_t *data_{nullptr};  ///< 映射地址
+  size_t size_{0};                ///< 映射大小
+  void *file_handle_{nullptr};    ///< 文件句柄 windows
+  void *map_handle_{nullptr};     ///< 映射句柄 windows
+  std::string path_;              ///< 文件路径
+
+  TPN_NO_COPYABLE(FlatDataFile)
+  TPN_NO_MOVEABLE(FlatDataFile)
+};
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_COMMON_UTILITY_FLAT_DATA_H_
@@ -21,63 +21,119 @@
 //
 
 #include <cstring>
+#include <new>
 
 #include "message_buffer.h"
 
 namespace tpn {
 
-MessageBuffer::MessageBuffer() : wpos_(0), rpos_(0), storage_() {
-  storage_.resize(4096);
-}
+MessageBuffer::MessageBuffer() : MessageBuffer(kMessageBufferDefaultSize) {}
 
 MessageBuffer::MessageBuffer(size_type initial_size)
-    : wpos_(0), rpos_(0), storage_() {
-  storage_.resize(initial_size);
-}
+    : wpos_(0),
+      rpos_(0),
+      size_(initial_size),
+      capacity_(0),
+      storage_(BufferPool::Allocate(initial_size, capacity_)) {}
 
 MessageBuffer::MessageBuffer(const MessageBuffer &other)
-    : wpos_(other.wpos_), rpos_(other.rpos_), storage_(other.storage_) {}
+    : wpos_(other.wpos_),
+      rpos_(other.rpos_),
+      size_(other.size_),
+      capacity_(0),
+      storage_(BufferPool::Allocate(other.size_, capacity_)) {
+  if (size_) {
+    memcpy(storage_, other.storage_, size_);
+  }
+}
 
-MessageBuffer::MessageBuffer(MessageBuffer &&other)
-    : wpos_(other.wpos_), rpos_(other.rpos_), storage_(other.Move()) {}
+MessageBuffer::MessageBuffer(MessageBuffer &&other) noexcept
+    : wpos_(other.wpos_),
+      rpos_(other.rpos_),
+      size_(other.size_),
+      capacity_(other.capacity_),
+      storage_(other.storage_) {
+  other.wpos_     = 0;
+  other.rpos_     = 0;
+  other.size_     = 0;
+  other.capacity_ = 0;
+  other.storage_  = nullptr;
+}
 
 MessageBuffer &MessageBuffer::operator=(const MessageBuffer &other) {
   if (this != &other) {
-    wpos_    = other.wpos_;
-    rpos_    = other.rpos_;
-    storage_ = other.storage_;
+    if (other.size_ > capacity_) {
+      Release();
+      storage_ = BufferPool::Allocate(other.size_, capacity_);
+    }
+    if (other.size_) {
+      memcpy(storage_, other.storage_, other.size_);
+    }
+    wpos_ = other.wpos_;
+    rpos_ = other.rpos_;
+    size_ = other.size_;
   }
 
   return *this;
 }
 
-MessageBuffer &MessageBuffer::operator=(MessageBuffer &&other) {
+MessageBuffer &MessageBuffer::operator=(MessageBuffer &&other) noexcept {
   if (this != &other) {
-    wpos_    = other.wpos_;
-    rpos_    = other.rpos_;
-    storage_ = other.Move();
+    Release();
+    wpos_           = other.wpos_;
+    rpos_           = other.rpos_;
+    size_           = other.size_;
+    capacity_       = other.capacity_;
+    storage_        = other.storage_;
+    other.wpos_     = 0;
+    other.rpos_     = 0;
+    other.size_     = 0;
+    other.capacity_ = 0;
+    other.storage_  = nullptr;
   }
 
   return *this;
 }
 
+MessageBuffer::~MessageBuffer() { Release(); }
+
+void MessageBuffer::Release() {
+  BufferPool::Deallocate(storage_, capacity_);
+  storage_  = nullptr;
+  capacity_ = 0;
+}
+
 void MessageBuffer::Reset() {
   wpos_ = 0;
   rpos_ = 0;
 }
 
-void MessageBuffer::Resize(size_type bytes) { storage_.resize(bytes); }
+void MessageBuffer::Resize(size_type bytes) {
+  if (bytes > capacity_) {
+    size_type capacity = 0;
+    pointer storage    = BufferPool::Allocate(bytes, capacity);
+    if (size_) {
+      memcpy(storage, storage_, size_);
+    }
+    Release();
+    storage_  = storage;
+    capacity_ = capacity;
+  }
+  size_ = bytes;
+}
 
-MessageBuffer::pointer MessageBuffer::GetBasePointer() {
-  return storage_.data();
+MessageBuffer::pointer MessageBuffer::GetBasePointer() { return storage_; }
+
+MessageBuffer::const_pointer MessageBuffer::GetBasePointer() const {
+  return storage_;
 }
 
 MessageBuffer::pointer MessageBuffer::GetReadPointer() {
-  return storage_.data() + rpos_;
+  return storage_ + rpos_;
 }
 
 MessageBuffer::pointer MessageBuffer::GetWritePointer() {
-  return storage_.data() + wpos_;
+  return storage_ + wpos_;
 }
 
 void MessageBuffer::ReadCompleted(size_type bytes) { rpos_ += bytes; }
@@ -89,11 +145,13 @@ MessageBuffer::size_type MessageBuffer::GetActiveSize() const {
 }
 
 MessageBuffer::size_type MessageBuffer::GetRemainingSpace() const {
-  return storage_.size() - wpos_;
+  return size_ - wpos_;
 }
 
-MessageBuffer::size_type MessageBuffer::GetBufferSize() const {
-  return storage_.size();
+MessageBuffer::size_type MessageBuffer::GetBufferSize() const { return size_; }
+
+MessageBuffer::size_type MessageBuffer::GetCapacity() const {
+  return capacity_;
 }
 
 void MessageBuffer::Normalize() {
@@ -108,7 +166,7 @@ void MessageBuffer::Normalize() {
 
 void MessageBuffer::EnsureFreeSpace() {
   if (0 == GetRemainingSpace()) {
-    storage_.resize(storage_.size() * 1.5);
+    Resize(size_ ? size_ + size_ / 2 : kMessageBufferDefaultSize);
   }
 }
 
@@ -119,10 +177,16 @@ void MessageBuffer::Write(const void *data, size_type size) {
   }
 }
 
-MessageBuffer::storage_type &&MessageBuffer::Move() {
-  wpos_ = 0;
-  rpos_ = 0;
-  return std::move(storage_);
+SharedMessageBuffer::SharedMessageBuffer(MessageBuffer &&buffer)
+    : node_(new (BufferPool::AllocateObject(sizeof(Node)))
+                Node(std::move(buffer))) {}
+
+void SharedMessageBuffer::Release() {
+  if (1 == node_->refs.fetch_sub(1, std::memory_order_acq_rel)) {
+    node_->~Node();
+    BufferPool::DeallocateObject(node_, sizeof(Node));
+  }
+  node_ = nullptr;
 }
 
 }  // namespace tpn
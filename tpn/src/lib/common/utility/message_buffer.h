@@ -23,18 +23,24 @@
 #ifndef TYPHOON_ZERO_TPN_SRC_LIB_COMMON_UTILITY_MESSAGE_BUFFER_H_
 #define TYPHOON_ZERO_TPN_SRC_LIB_COMMON_UTILITY_MESSAGE_BUFFER_H_
 
-#include <vector>
+#include <atomic>
+#include <memory>
 
 #include "define.h"
+#include "buffer_pool.h"
 
 namespace tpn {
 
 /// 消息缓冲
+/// 缓冲内存来自 @see BufferPool ，按2的幂分级复用，扩容时不初始化新增的内存
 class TPN_COMMON_API MessageBuffer {
  public:
-  using storage_type = std::vector<uint8_t>;
-  using size_type    = storage_type::size_type;
-  using pointer      = storage_type::pointer;
+  using size_type     = size_t;
+  using pointer       = uint8_t *;
+  using const_pointer = const uint8_t *;
+
+  /// 默认缓冲区大小
+  static constexpr size_type kMessageBufferDefaultSize = 4096;
 
   /// 构造函数
   /// 默认大小为4096
@@ -48,19 +54,23 @@ class TPN_COMMON_API MessageBuffer {
   MessageBuffer(const MessageBuffer &other);
 
   /// 移动构造函数
-  MessageBuffer(MessageBuffer &&other);
+  MessageBuffer(MessageBuffer &&other) noexcept;
 
   /// 拷贝赋值函数
   MessageBuffer &operator=(const MessageBuffer &other);
 
   /// 移动赋值函数
-  MessageBuffer &operator=(MessageBuffer &&other);
+  MessageBuffer &operator=(MessageBuffer &&other) noexcept;
+
+  /// 析构函数，缓冲归还缓冲池
+  ~MessageBuffer();
 
   /// 重置读写
   /// 只重置读写位置 内存不会变化
   void Reset();
 
   /// 重置缓冲区
+  /// 缩小时不释放内存，超过容量时换用更大的块并保留原有数据，新增部分不初始化
   ///  @param[in]   bytes     重置后的大小
   void Resize(size_type bytes);
 
@@ -68,6 +78,10 @@ class TPN_COMMON_API MessageBuffer {
   ///  @return 缓冲区地址
   pointer GetBasePointer();
 
+  /// 获取缓冲区地址
+  ///  @return 缓冲区地址
+  const_pointer GetBasePointer() const;
+
   /// 获取读位置地址
   ///  @return 读位置地址
   pointer GetReadPointer();
@@ -98,6 +112,10 @@ class TPN_COMMON_API MessageBuffer {
   ///  @return 缓冲区总字节大小
   size_type GetBufferSize() const;
 
+  /// 获取缓冲区容量
+  ///  @return 不换块最多可以重置到的大小
+  size_type GetCapacity() const;
+
   /// 缓冲区初始化
   /// 重新使用时需要调用,缓冲区会清理掉已读数据
   void Normalize();
@@ -111,16 +129,114 @@ class TPN_COMMON_API MessageBuffer {
   ///  @param[in]   size    数据大小
   void Write(const void *data, size_type size);
 
-  /// 移动缓冲区数据
-  ///  @return 移动后的缓冲区数据
-  storage_type &&Move();
+ private:
+  /// 归还缓冲
+  void Release();
 
  private:
-  size_type wpos_{0};     ///< 写位置
-  size_type rpos_{0};     ///< 读位置
-  storage_type storage_;  ///< 缓冲区
+  size_type wpos_{0};         ///< 写位置
+  size_type rpos_{0};         ///< 读位置
+  size_type size_{0};         ///< 缓冲区大小
+  size_type capacity_{0};     ///< 缓冲区容量
+  pointer storage_{nullptr};  ///< 缓冲区
 };
 
+/// 共享的只读消息缓冲
+/// 广播时消息只序列化一次，所有会话的发送队列引用同一份缓冲。
+/// 引用计数与消息缓冲在同一个池化节点里，共享与释放都不经过全局堆
+class TPN_COMMON_API SharedMessageBuffer {
+ public:
+  SharedMessageBuffer() = default;
+
+  /// 接管消息缓冲，不拷贝数据
+  ///  @param[in]   buffer    消息缓冲
+  explicit SharedMessageBuffer(MessageBuffer &&buffer);
+
+  /// 拷贝构造函数，增加引用
+  SharedMessageBuffer(const SharedMessageBuffer &other) noexcept
+      : node_(other.node_) {
+    if (nullptr != node_) {
+      node_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /// 移动构造函数
+  SharedMessageBuffer(SharedMessageBuffer &&other) noexcept
+      : node_(other.node_) {
+    other.node_ = nullptr;
+  }
+
+  /// 拷贝赋值函数
+  SharedMessageBuffer &operator=(const SharedMessageBuffer &other) noexcept {
+    SharedMessageBuffer(other).Swap(*this);
+    return *this;
+  }
+
+  /// 移动赋值函数
+  SharedMessageBuffer &operator=(SharedMessageBuffer &&other) noexcept {
+    SharedMessageBuffer(std::move(other)).Swap(*this);
+    return *this;
+  }
+
+  /// 析构函数，最后一个引用释放时缓冲归还缓冲池
+  ~SharedMessageBuffer() {
+    if (nullptr != node_) {
+      Release();
+    }
+  }
+
+  /// 交换
+  ///  @param[in]   other     另一个共享缓冲
+  void Swap(SharedMessageBuffer &other) noexcept {
+    std::swap(node_, other.node_);
+  }
+
+  /// 获取消息缓冲
+  ///  @return 消息缓冲
+  const MessageBuffer &operator*() const { return node_->buffer; }
+
+  /// 获取消息缓冲
+  ///  @return 消息缓冲
+  const MessageBuffer *operator->() const { return &node_->buffer; }
+
+  /// 获取消息缓冲
+  ///  @return 消息缓冲，为空时返回nullptr
+  const MessageBuffer *Get() const {
+    return nullptr != node_ ? &node_->buffer : nullptr;
+  }
+
+  /// 是否持有缓冲
+  explicit operator bool() const { return nullptr != node_; }
+
+  /// 获取引用数
+  ///  @return 引用数
+  uint32_t GetUseCount() const {
+    return nullptr != node_ ? node_->refs.load(std::memory_order_relaxed) : 0;
+  }
+
+ private:
+  /// 共享节点
+  struct Node {
+    explicit Node(MessageBuffer &&buffer) : buffer(std::move(buffer)) {}
+
+    std::atomic<uint32_t> refs{1};  ///< 引用数
+    MessageBuffer buffer;           ///< 消息缓冲
+  };
+
+  /// 减少引用
+  void Release();
+
+ private:
+  Node *node_{nullptr};  ///< 共享节点
+};
+
+/// 创建共享的只读消息缓冲
+///  @param[in]   buffer    消息缓冲，数据被接管
+///  @return 共享的只读消息缓冲
+inline SharedMessageBuffer MakeSharedMessageBuffer(MessageBuffer &&buffer) {
+  return SharedMessageBuffer(std::move(buffer));
+}
+
 }  // namespace tpn
 
 #endif  // TYPHOON_ZERO_TPN_SRC_LIB_COMMON_UTILITY_MESSAGE_BUFFER_H_
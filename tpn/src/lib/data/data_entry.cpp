@@ -34,6 +34,10 @@ namespace data {
 #  define _TPN_DATA_FILE_PATH "data/data_hub.bin"
 #endif
 
+#ifndef _TPN_DATA_FLAT_FILE_PATH
+#  define _TPN_DATA_FLAT_FILE_PATH "data/data_hub.flat"
+#endif
+
 bool Init() {
   std::string data_error;
   if (!g_data_hub->Load(_TPN_DATA_FILE_PATH, data_error)) {
@@ -44,6 +48,16 @@ bool Init() {
   return true;
 }
 
+bool InitFlat() {
+  std::string data_error;
+  if (!g_data_hub->LoadFlat(_TPN_DATA_FLAT_FILE_PATH, data_error)) {
+    printf("Error in flat data file: %s\n", data_error.c_str());
+    return false;
+  }
+
+  return true;
+}
+
 }  // namespace data
 
 }  // namespace tpn
@@ -33,6 +33,11 @@ namespace data {
 ///  @return 成功返回true
 bool Init();
 
+/// 数据模块初始化 平坦数据
+/// 直接映射平坦数据文件，无需解析
+///  @return 成功返回true
+bool InitFlat();
+
 }  // namespace data
 
 }  // namespace tpn
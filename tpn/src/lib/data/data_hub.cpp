@@ -22,7 +22,9 @@
 
 #include "data_hub.h"
 
+#include <tuple>
 #include <fstream>
+#include <algorithm>
 #include <filesystem>
 
 #include "utils.h"
@@ -73,6 +75,10 @@ bool DataHubMgr::Reload(std::string &error) { return Load({}, error, true); }
 
 std::string_view DataHubMgr::GetPath() { return path_; }
 
+std::string_view DataHubMgr::GetFlatString(const FlatDataStr &str) const {
+  return flat_file_.GetString(str);
+}
+
 /// uint32_t-id
 const DataHubEntryItem::Item *DataHubMgr::GetDataHubEntryItem(
     uint32_t id) const {
@@ -81,6 +87,22 @@ const DataHubEntryItem::Item *DataHubMgr::GetDataHubEntryItem(
   return item_map_.end() == iter ? nullptr : &(iter->second);
 }
 
+/// uint32_t-id
+const DataHubMgr::FlatDataHubEntryItem *DataHubMgr::GetFlatDataHubEntryItem(
+    uint32_t id) const {
+  auto map_key = std::make_tuple(id);
+  auto iter    = std::lower_bound(
+      flat_item_rows_.begin(), flat_item_rows_.end(), map_key,
+      [](const FlatDataHubEntryItem &row, const auto &key) {
+        return std::make_tuple(row.id) < key;
+      });
+  if (flat_item_rows_.end() == iter ||
+      std::make_tuple(iter->id) != map_key) {
+    return nullptr;
+  }
+  return &(*iter);
+}
+
 /// uint32_t-level
 const DataHubEntryLevel::Level *DataHubMgr::GetDataHubEntryLevel(
     uint32_t level) const {
@@ -89,6 +111,22 @@ const DataHubEntryLevel::Level *DataHubMgr::GetDataHubEntryLevel(
   return level_map_.end() == iter ? nullptr : &(iter->second);
 }
 
+/// uint32_t-level
+const DataHubMgr::FlatDataHubEntryLevel *DataHubMgr::GetFlatDataHubEntryLevel(
+    uint32_t level) const {
+  auto map_key = std::make_tuple(level);
+  auto iter    = std::lower_bound(
+      flat_level_rows_.begin(), flat_level_rows_.end(), map_key,
+      [](const FlatDataHubEntryLevel &row, const auto &key) {
+        return std::make_tuple(row.level) < key;
+      });
+  if (flat_level_rows_.end() == iter ||
+      std::make_tuple(iter->level) != map_key) {
+    return nullptr;
+  }
+  return &(*iter);
+}
+
 /// uint32_t-id
 const DataHubEntryPack::Pack *DataHubMgr::GetDataHubEntryPack(
     uint32_t id) const {
@@ -97,6 +135,22 @@ const DataHubEntryPack::Pack *DataHubMgr::GetDataHubEntryPack(
   return pack_map_.end() == iter ? nullptr : &(iter->second);
 }
 
+/// uint32_t-id
+const DataHubMgr::FlatDataHubEntryPack *DataHubMgr::GetFlatDataHubEntryPack(
+    uint32_t id) const {
+  auto map_key = std::make_tuple(id);
+  auto iter    = std::lower_bound(
+      flat_pack_rows_.begin(), flat_pack_rows_.end(), map_key,
+      [](const FlatDataHubEntryPack &row, const auto &key) {
+        return std::make_tuple(row.id) < key;
+      });
+  if (flat_pack_rows_.end() == iter ||
+      std::make_tuple(iter->id) != map_key) {
+    return nullptr;
+  }
+  return &(*iter);
+}
+
 /// uint32_t-id
 const DataHubEntryShop::Shop *DataHubMgr::GetDataHubEntryShop(
     uint32_t id) const {
@@ -105,6 +159,22 @@ const DataHubEntryShop::Shop *DataHubMgr::GetDataHubEntryShop(
   return shop_map_.end() == iter ? nullptr : &(iter->second);
 }
 
+/// uint32_t-id
+const DataHubMgr::FlatDataHubEntryShop *DataHubMgr::GetFlatDataHubEntryShop(
+    uint32_t id) const {
+  auto map_key = std::make_tuple(id);
+  auto iter    = std::lower_bound(
+      flat_shop_rows_.begin(), flat_shop_rows_.end(), map_key,
+      [](const FlatDataHubEntryShop &row, const auto &key) {
+        return std::make_tuple(row.id) < key;
+      });
+  if (flat_shop_rows_.end() == iter ||
+      std::make_tuple(iter->id) != map_key) {
+    return nullptr;
+  }
+  return &(*iter);
+}
+
 /// uint32_t-id uint32_t-level
 const DataHubEntrySkill::Skill *DataHubMgr::GetDataHubEntrySkill(
     uint32_t id, uint32_t level) const {
@@ -113,6 +183,22 @@ const DataHubEntrySkill::Skill *DataHubMgr::GetDataHubEntrySkill(
   return skill_map_.end() == iter ? nullptr : &(iter->second);
 }
 
+/// uint32_t-id uint32_t-level
+const DataHubMgr::FlatDataHubEntrySkill *DataHubMgr::GetFlatDataHubEntrySkill(
+    uint32_t id, uint32_t level) const {
+  auto map_key = std::make_tuple(id, level);
+  auto iter    = std::lower_bound(
+      flat_skill_rows_.begin(), flat_skill_rows_.end(), map_key,
+      [](const FlatDataHubEntrySkill &row, const auto &key) {
+        return std::make_tuple(row.id, row.level) < key;
+      });
+  if (flat_skill_rows_.end() == iter ||
+      std::make_tuple(iter->id, iter->level) != map_key) {
+    return nullptr;
+  }
+  return &(*iter);
+}
+
 bool DataHubMgr::Init(DataHubMap &data_map) {
   for (auto &&[key, val] : data_map.datas()) {
     if (val.Is<DataHubEntryItem>()) {
@@ -165,6 +251,55 @@ bool DataHubMgr::Init(DataHubMap &data_map) {
   return true;
 }
 
+bool DataHubMgr::LoadFlat(std::string_view path, std::string &error) {
+  // 重新打开会先关闭旧映射，任一步失败都不能留下指向映射的行数据
+  ResetFlat();
+  if (!flat_file_.Open(path, error)) {
+    return false;
+  }
+
+  if (!flat_file_.GetRows("item", flat_item_rows_)) {
+    error = "flat table error (item) ";
+    ResetFlat();
+    return false;
+  }
+
+  if (!flat_file_.GetRows("level", flat_level_rows_)) {
+    error = "flat table error (level) ";
+    ResetFlat();
+    return false;
+  }
+
+  if (!flat_file_.GetRows("pack", flat_pack_rows_)) {
+    error = "flat table error (pack) ";
+    ResetFlat();
+    return false;
+  }
+
+  if (!flat_file_.GetRows("shop", flat_shop_rows_)) {
+    error = "flat table error (shop) ";
+    ResetFlat();
+    return false;
+  }
+
+  if (!flat_file_.GetRows("skill", flat_skill_rows_)) {
+    error = "flat table error (skill) ";
+    ResetFlat();
+    return false;
+  }
+
+  return true;
+}
+
+void DataHubMgr::ResetFlat() {
+  flat_item_rows_  = {};
+  flat_level_rows_ = {};
+  flat_pack_rows_  = {};
+  flat_shop_rows_  = {};
+  flat_skill_rows_ = {};
+  flat_file_.Close();
+}
+
 TPN_SINGLETON_IMPL(DataHubMgr)
 }  // namespace data
 
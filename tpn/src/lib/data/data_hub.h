@@ -24,10 +24,12 @@
 #define __TYPHOON_DATA_HUB_H__
 
 #include <map>
+#include <span>
 #include <string>
 #include <string_view>
 
 #include "define.h"
+#include "flat_data.h"
 #include "data_hub.pb.h"
 
 namespace tpn {
@@ -40,6 +42,8 @@ class TPN_DATA_API DataHubMgr {
   bool Reload(std::string &error);
   bool Init(DataHubMap &data_map);
   std::string_view GetPath();
+  bool LoadFlat(std::string_view path, std::string &error);
+  std::string_view GetFlatString(const FlatDataStr &str) const;
 
  public:
   /// uint32_t-id
@@ -48,6 +52,23 @@ class TPN_DATA_API DataHubMgr {
  private:
   std::map<uint32_t, DataHubEntryItem::Item> item_map_;
 
+ public:
+  /// Item 平坦数据行
+  struct FlatDataHubEntryItem {
+    uint32_t id;
+    uint32_t type;
+    uint32_t sub_type;
+    FlatDataStr name;
+    uint32_t quality;
+  };
+  static_assert(24 == sizeof(FlatDataHubEntryItem), "flat row layout changed");
+
+  /// uint32_t-id
+  const FlatDataHubEntryItem *GetFlatDataHubEntryItem(uint32_t id) const;
+
+ private:
+  std::span<const FlatDataHubEntryItem> flat_item_rows_;
+
  public:
   /// uint32_t-level
   const DataHubEntryLevel::Level *GetDataHubEntryLevel(uint32_t level) const;
@@ -55,6 +76,20 @@ class TPN_DATA_API DataHubMgr {
  private:
   std::map<uint32_t, DataHubEntryLevel::Level> level_map_;
 
+ public:
+  /// Level 平坦数据行
+  struct FlatDataHubEntryLevel {
+    uint32_t level;
+    uint64_t exp;
+  };
+  static_assert(16 == sizeof(FlatDataHubEntryLevel), "flat row layout changed");
+
+  /// uint32_t-level
+  const FlatDataHubEntryLevel *GetFlatDataHubEntryLevel(uint32_t level) const;
+
+ private:
+  std::span<const FlatDataHubEntryLevel> flat_level_rows_;
+
  public:
   /// uint32_t-id
   const DataHubEntryPack::Pack *GetDataHubEntryPack(uint32_t id) const;
@@ -62,6 +97,22 @@ class TPN_DATA_API DataHubMgr {
  private:
   std::map<uint32_t, DataHubEntryPack::Pack> pack_map_;
 
+ public:
+  /// Pack 平坦数据行
+  struct FlatDataHubEntryPack {
+    uint32_t id;
+    FlatDataStr pool;
+    FlatDataStr pool2;
+    FlatDataStr pool3;
+  };
+  static_assert(28 == sizeof(FlatDataHubEntryPack), "flat row layout changed");
+
+  /// uint32_t-id
+  const FlatDataHubEntryPack *GetFlatDataHubEntryPack(uint32_t id) const;
+
+ private:
+  std::span<const FlatDataHubEntryPack> flat_pack_rows_;
+
  public:
   /// uint32_t-id
   const DataHubEntryShop::Shop *GetDataHubEntryShop(uint32_t id) const;
@@ -69,6 +120,22 @@ class TPN_DATA_API DataHubMgr {
  private:
   std::map<uint32_t, DataHubEntryShop::Shop> shop_map_;
 
+ public:
+  /// Shop 平坦数据行
+  struct FlatDataHubEntryShop {
+    uint32_t id;
+    uint32_t type;
+    FlatDataStr item;
+    FlatDataStr price;
+  };
+  static_assert(24 == sizeof(FlatDataHubEntryShop), "flat row layout changed");
+
+  /// uint32_t-id
+  const FlatDataHubEntryShop *GetFlatDataHubEntryShop(uint32_t id) const;
+
+ private:
+  std::span<const FlatDataHubEntryShop> flat_shop_rows_;
+
  public:
   /// uint32_t-id uint32_t-level
   const DataHubEntrySkill::Skill *GetDataHubEntrySkill(uint32_t id,
@@ -77,8 +144,28 @@ class TPN_DATA_API DataHubMgr {
  private:
   std::map<std::string, DataHubEntrySkill::Skill> skill_map_;
 
+ public:
+  /// Skill 平坦数据行
+  struct FlatDataHubEntrySkill {
+    uint32_t id;
+    uint32_t level;
+    FlatDataStr name;
+    uint32_t type;
+  };
+  static_assert(20 == sizeof(FlatDataHubEntrySkill), "flat row layout changed");
+
+  /// uint32_t-id uint32_t-level
+  const FlatDataHubEntrySkill *GetFlatDataHubEntrySkill(
+      uint32_t id, uint32_t level) const;
+
  private:
+  std::span<const FlatDataHubEntrySkill> flat_skill_rows_;
+
+ private:
+  void ResetFlat();
+
   std::string path_;
+  FlatDataFile flat_file_;
 
   TPN_SINGLETON_DECL(DataHubMgr)
 };
@@ -123,13 +123,46 @@ class ServerBase : public CRTPObject<Derived, false>,
   }
 
   /// 对注册过的网络会话进行条件查找
-  ///  @param[in]   fn      函数操作 函数签名 void(std::shared_ptr<SessionType> &)
+  ///  @param[in]   fn      函数操作 函数签名 bool(std::shared_ptr<SessionType> &)
   ///  @return 满足条件的对象，找不到返回空对象
   TPN_INLINE std::shared_ptr<SessionType> FindSessionIf(
-      const std::function<void(std::shared_ptr<SessionType> &)> &fn) {
+      const std::function<bool(std::shared_ptr<SessionType> &)> &fn) {
     return std::shared_ptr<SessionType>(this->session_mgr_.FindIf(fn));
   }
 
+  /// 通过会话句柄查找网络会话，不加锁
+  ///  @param[in]   handle  会话句柄
+  ///  @return 网络会话，句柄失效返回空对象
+  TPN_INLINE std::shared_ptr<SessionType> FindSession(SessionHandle handle) {
+    return this->session_mgr_.Resolve(handle);
+  }
+
+  /// 广播消息给所有会话
+  ///  @param[in]   buffer    调用需要保证buffer满足底层拆包逻辑
+  ///  @return 广播的会话数
+  TPN_INLINE size_t Broadcast(MessageBuffer &&buffer) {
+    return this->session_mgr_.Broadcast(std::move(buffer));
+  }
+
+  /// 广播共享的只读消息给所有会话
+  ///  @param[in]   buffer    调用需要保证buffer满足底层拆包逻辑
+  ///  @return 广播的会话数
+  TPN_INLINE size_t Broadcast(const SharedMessageBuffer &buffer) {
+    return this->session_mgr_.Broadcast(buffer);
+  }
+
+  /// 广播共享的只读消息给指定的会话
+  ///  @tparam      Iterator  迭代器类型，解引用得到 std::shared_ptr<SessionType>
+  ///  @param[in]   buffer    调用需要保证buffer满足底层拆包逻辑
+  ///  @param[in]   first     第一个会话
+  ///  @param[in]   last      最后一个会话的下一个位置
+  ///  @return 广播的会话数
+  template <typename Iterator>
+  TPN_INLINE size_t Broadcast(const SharedMessageBuffer &buffer,
+                              Iterator first, Iterator last) {
+    return SessionMgr<SessionType>::Broadcast(buffer, first, last);
+  }
+
   /// 服务分发
   ///  @param[in]   session_sptr
   ///  @param[in]   service_hash
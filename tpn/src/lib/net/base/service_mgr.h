@@ -23,8 +23,11 @@
 #ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_SERVICE_MGR_H_
 #define TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_SERVICE_MGR_H_
 
+#include <algorithm>
+#include <bit>
 #include <functional>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "message_buffer.h"
 #include "net_common.h"
@@ -46,8 +49,17 @@ class ServiceMgr {
   ///  @tparam  ServiceType     服务类型
   template <typename ServiceType>
   TPN_INLINE void AddService() {
-    dispatchers_[ServiceType::ServiceHash::value] =
-        &ServiceMgr::Dispatch<ServiceType>;
+    uint32_t service_hash = ServiceType::ServiceHash::value;
+    auto iter = std::find_if(
+        services_.begin(), services_.end(),
+        [service_hash](auto &&entry) { return entry.first == service_hash; });
+    if (services_.end() != iter) {
+      iter->second = &ServiceMgr::Dispatch<ServiceType>;
+    } else {
+      services_.emplace_back(service_hash,
+                             &ServiceMgr::Dispatch<ServiceType>);
+    }
+    RebuildDispatchers();
   }
 
   /// 分发协议
@@ -62,9 +74,9 @@ class ServiceMgr {
   TPN_INLINE void Dispatch(std::shared_ptr<SessionType> session_sptr,
                            uint32_t service_hash, uint32_t token,
                            uint32_t method_id, MessageBuffer buffer) {
-    auto iter = dispatchers_.find(service_hash);
-    if (dispatchers_.end() != iter) {
-      iter->second(session_sptr, token, method_id, std::move(buffer));
+    const DispatcherEntry &entry = dispatchers_[GetSlot(service_hash)];
+    if (nullptr != entry.dispatcher && entry.service_hash == service_hash) {
+      entry.dispatcher(session_sptr, token, method_id, std::move(buffer));
     } else {
       NET_DEBUG("{} tried to call invalid service {:#x}",
                 session_sptr->GetCallerInfo(), service_hash);
@@ -92,7 +104,59 @@ class ServiceMgr {
   using ServiceMethod = void (*)(std::shared_ptr<SessionType>, uint32_t,
                                  uint32_t, MessageBuffer);
 
-  std::unordered_map<uint32_t, ServiceMethod> dispatchers_;  ///< 服务分发器
+  /// 分发表项
+  struct DispatcherEntry {
+    uint32_t service_hash{0};           ///< 服务索引
+    ServiceMethod dispatcher{nullptr};  ///< 服务分发器
+  };
+
+  /// 计算服务在分发表中的位置
+  ///  @param[in]   service_hash    服务索引
+  ///  @return 位置
+  TPN_INLINE size_t GetSlot(uint32_t service_hash) const {
+    return static_cast<uint32_t>(service_hash * seed_) >> shift_;
+  }
+
+  /// 重建分发表
+  /// 服务索引在注册后固定，这里找一个乘数使所有服务落在不同位置，
+  /// 分发时只需一次乘法移位和一次比较。表长从服务数的两倍起，
+  /// 一定次数内找不到则加倍
+  void RebuildDispatchers() {
+    static constexpr uint32_t kSeedTries = 256;
+
+    uint32_t bits = static_cast<uint32_t>(
+        std::bit_width((std::max)(services_.size() * 2, size_t(2)) - 1));
+    for (;; ++bits) {
+      std::vector<DispatcherEntry> dispatchers(size_t(1) << bits);
+      uint32_t seed = 0x9E3779B1u;
+      for (uint32_t i = 0; i < kSeedTries; ++i, seed += 0x6A09E668u) {
+        seed_  = seed | 1;
+        shift_ = 32 - bits;
+        std::fill(dispatchers.begin(), dispatchers.end(), DispatcherEntry{});
+
+        bool perfect = true;
+        for (auto &&[service_hash, dispatcher] : services_) {
+          DispatcherEntry &entry = dispatchers[GetSlot(service_hash)];
+          if (nullptr != entry.dispatcher) {
+            perfect = false;
+            break;
+          }
+          entry.service_hash = service_hash;
+          entry.dispatcher   = dispatcher;
+        }
+        if (perfect) {
+          dispatchers_.swap(dispatchers);
+          return;
+        }
+      }
+    }
+  }
+
+  std::vector<std::pair<uint32_t, ServiceMethod>> services_;  ///< 已注册服务
+  std::vector<DispatcherEntry> dispatchers_ =
+      std::vector<DispatcherEntry>(2);  ///< 完美散列的服务分发表
+  uint32_t seed_{1};                    ///< 散列乘数
+  uint32_t shift_{31};                  ///< 散列右移位数
 };
 
 }  // namespace net
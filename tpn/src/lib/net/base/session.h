@@ -40,6 +40,7 @@
 #include "send_wrap.h"
 #include "socket_wrap.h"
 #include "buffer_wrap.h"
+#include "session_pool.h"
 
 namespace tpn {
 
@@ -88,14 +89,17 @@ class SessionBase : public CRTPObject<Derived>,
         ConnectTime<Derived, ArgsType>(),
         ConnectTimeoutTimer<Derived, ArgsType>(io_handle),
         SilenceTimer<Derived, ArgsType>(io_handle),
-        EventQueue<Derived, ArgsType>(),
+        EventQueue<Derived, ArgsType>(io_handle),
         SendWrap<Derived, ArgsType>(),
         Socket<Derived, ArgsType>(std::forward<Args>(args)...),
         io_handle_(io_handle),
         session_mgr_(session_mgr),
-        buffer_(buffer_max, buffer_prepare) {}
+        buffer_(buffer_max, buffer_prepare,
+                SessionPoolAllocator<char>(io_handle.GetSessionPool())) {
+    this->io_handle_.GetLoad().AddSession();
+  }
 
-  ~SessionBase() = default;
+  ~SessionBase() { this->io_handle_.GetLoad().RemoveSession(); }
 
   /// 网络会话基类停止
   TPN_INLINE void Stop() {
@@ -143,6 +147,13 @@ class SessionBase : public CRTPObject<Derived>,
   ///  @return io句柄
   TPN_INLINE IoHandle &GetIoHandle() { return this->io_handle_; }
 
+  /// 获取会话句柄，注册到会话管理器后有效
+  /// 跨线程保存句柄代替共享指针，用 SessionMgr::Resolve 解析
+  ///  @return 会话句柄
+  TPN_INLINE SessionHandle GetSessionHandle() const {
+    return this->session_handle_;
+  }
+
   /// 获取缓冲区
   ///  @return 缓冲区
   TPN_INLINE BufferWrap<buffer_type> &GetBuffer() { return this->buffer_; }
@@ -183,6 +194,7 @@ class SessionBase : public CRTPObject<Derived>,
   std::shared_ptr<void>
       counter_sptr_;  ///< 用来确保服务器在所有会话停止后才停止
   bool in_session_mgr_{false};      ///< 是否在已连接的会话管理器中
+  SessionHandle session_handle_{kInvalidSessionHandle};  ///< 会话句柄
   BufferWrap<buffer_type> buffer_;  ///< 缓冲区
 };
 
@@ -25,12 +25,18 @@
 
 #include <mutex>
 #include <shared_mutex>
+#include <thread>
 #include <memory>
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <functional>
 #include <unordered_map>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "message_buffer.h"
 #include "net_common.h"
 #include "custom_allocator.h"
 
@@ -39,6 +45,10 @@ namespace tpn {
 namespace net {
 
 /// 网络会话管理器
+/// 会话按key散列到 kSessionMgrShards 个分片，每个分片一把读写锁，
+/// 注册、移除、查找只锁一个分片，遍历逐个分片加锁，没有全局锁。
+/// 注册成功的会话同时分配一个带代数的整数句柄，
+/// 句柄通过槽位表的下标和代数校验无锁解析到会话
 ///  @tparam  SessionType     网络会话类型
 template <typename SessionType>
 class SessionMgr {
@@ -49,13 +59,12 @@ class SessionMgr {
 
   /// 构造函数
   ///  @param[in]   io_handle     io句柄引用
-  explicit SessionMgr(IoHandle &io_handle) : acceptor_io_handle_(io_handle) {
-    this->sessions_.reserve(64);
-  }
+  explicit SessionMgr(IoHandle &io_handle) : acceptor_io_handle_(io_handle) {}
 
   ~SessionMgr() = default;
 
   /// 插入一个网络会话
+  /// 在调用者线程中直接注册，回调也在调用者线程中执行
   ///  @param[in]   session_sptr    网络层会话
   ///  @param[in]   callback        插入是否成功的回调函数
   TPN_INLINE void Emplace(std::shared_ptr<SessionType> session_sptr,
@@ -64,30 +73,28 @@ class SessionMgr {
       return;
     }
 
-    if (!this->acceptor_io_handle_.GetStrand().running_in_this_thread()) {
-      return asio::post(
-          this->acceptor_io_handle_.GetStrand(),
-          MakeAllocator(
-              this->allocator_, [this, session_sptr = std::move(session_sptr),
-                                 callback = std::move(callback)]() mutable {
-                this->Emplace(std::move(session_sptr), std::move(callback));
-              }));
-    }
-
     bool inserted = false;
+    auto key      = session_sptr->GetHashKey();
+    auto &shard   = this->GetShard(key);
 
     {
-      std::unique_lock<std::shared_mutex> guard(this->mutex_);
-      inserted =
-          this->sessions_.try_emplace(session_sptr->GetHashKey(), session_sptr)
-              .second;
+      std::unique_lock<std::shared_mutex> guard(shard.mutex);
+      inserted = shard.sessions.try_emplace(key, session_sptr).second;
       session_sptr->in_session_mgr_ = inserted;
+      if (inserted) {
+        session_sptr->session_handle_ = this->AllocateHandle(session_sptr);
+      }
+    }
+
+    if (inserted) {
+      this->size_.fetch_add(1, std::memory_order_relaxed);
     }
 
     (callback)(inserted);
   }
 
   /// 移除一个网络会话
+  /// 在调用者线程中直接移除，回调也在调用者线程中执行
   ///  @param[in]   session_sptr    网络层会话
   ///  @param[in]   callback        删除是否成功的回调函数
   TPN_INLINE void Erase(std::shared_ptr<SessionType> session_sptr,
@@ -96,25 +103,25 @@ class SessionMgr {
       return;
     }
 
-    if (!this->acceptor_io_handle_.GetStrand().running_in_this_thread()) {
-      return asio::post(
-          this->acceptor_io_handle_.GetStrand(),
-          MakeAllocator(
-              this->allocator_, [this, session_sptr = std::move(session_sptr),
-                                 callback = std::move(callback)]() mutable {
-                this->Erase(std::move(session_sptr), std::move(callback));
-              }));
-    }
-
     bool erased = false;
+    auto key    = session_sptr->GetHashKey();
+    auto &shard = this->GetShard(key);
 
     {
-      std::unique_lock<std::shared_mutex> guard(this->mutex_);
+      std::unique_lock<std::shared_mutex> guard(shard.mutex);
       if (session_sptr->in_session_mgr_) {
-        erased = (this->sessions_.erase(session_sptr->GetHashKey()) > 0);
+        erased = (shard.sessions.erase(key) > 0);
+      }
+      if (erased) {
+        this->FreeHandle(session_sptr->session_handle_);
+        session_sptr->session_handle_ = kInvalidSessionHandle;
       }
     }
 
+    if (erased) {
+      this->size_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
     (callback)(erased);
   }
 
@@ -126,49 +133,281 @@ class SessionMgr {
   }
 
   /// 对注册的网络会话进行函数操作
+  /// 逐个分片加读锁，函数操作只阻塞同一分片的注册与移除
   ///  @param[in]   fn      函数操作 函数签名 void(std::shared_ptr<SessionType> &)
   TPN_INLINE void ApplyAll(
       const std::function<void(std::shared_ptr<SessionType> &)> &fn) {
-    std::shared_lock<std::shared_mutex> guard(this->mutex_);
-    for (auto &[_, session_sptr] : this->sessions_) {
-      fn(session_sptr);
+    for (auto &shard : this->shards_) {
+      std::shared_lock<std::shared_mutex> guard(shard.mutex);
+      for (auto &[_, session_sptr] : shard.sessions) {
+        fn(session_sptr);
+      }
+    }
+  }
+
+  /// 广播消息给所有注册的网络会话
+  ///  @param[in]   buffer    调用需要保证buffer满足底层拆包逻辑
+  ///  @return 广播的会话数
+  TPN_INLINE size_t Broadcast(MessageBuffer &&buffer) {
+    return this->Broadcast(MakeSharedMessageBuffer(std::move(buffer)));
+  }
+
+  /// 广播共享的只读消息给所有注册的网络会话
+  /// 按会话所在的io句柄分组，每个io线程只提交一个任务，
+  /// 任务中每个会话的发送队列只引用同一份缓冲
+  ///  @param[in]   buffer    调用需要保证buffer满足底层拆包逻辑
+  ///  @return 广播的会话数
+  TPN_INLINE size_t Broadcast(const SharedMessageBuffer &buffer) {
+    BroadcastGroups groups;
+    size_t count = 0;
+
+    for (auto &shard : this->shards_) {
+      std::shared_lock<std::shared_mutex> guard(shard.mutex);
+      for (auto &[_, session_sptr] : shard.sessions) {
+        Self::AddBroadcastTarget(groups, session_sptr);
+        ++count;
+      }
     }
+
+    Self::PostBroadcast(buffer, groups);
+    return count;
+  }
+
+  /// 广播共享的只读消息给指定的网络会话，例如频道成员或视野内的玩家
+  ///  @tparam      Iterator  迭代器类型，解引用得到 std::shared_ptr<SessionType>
+  ///  @param[in]   buffer    调用需要保证buffer满足底层拆包逻辑
+  ///  @param[in]   first     第一个会话
+  ///  @param[in]   last      最后一个会话的下一个位置
+  ///  @return 广播的会话数
+  template <typename Iterator>
+  static size_t Broadcast(const SharedMessageBuffer &buffer, Iterator first,
+                          Iterator last) {
+    BroadcastGroups groups;
+    size_t count = 0;
+
+    for (; first != last; ++first) {
+      if (*first) {
+        Self::AddBroadcastTarget(groups, *first);
+        ++count;
+      }
+    }
+
+    Self::PostBroadcast(buffer, groups);
+    return count;
   }
 
   /// 对注册过的网络会话查找
   ///  @param[in]   key     网络会话哈希key
   TPN_INLINE std::shared_ptr<SessionType> Find(const key_type &key) {
-    std::shared_lock<std::shared_mutex> guard(this->mutex_);
-    auto iter = this->sessions_.find(key);
-    return (this->sessions_.end() == iter) ? std::shared_ptr<SessionType>()
-                                           : iter->second;
+    auto &shard = this->GetShard(key);
+    std::shared_lock<std::shared_mutex> guard(shard.mutex);
+    auto iter = shard.sessions.find(key);
+    return (shard.sessions.end() == iter) ? std::shared_ptr<SessionType>()
+                                          : iter->second;
+  }
+
+  /// 通过会话句柄查找，不加锁
+  /// 读者先登记到槽位再校验代数，释放槽位时先增加代数再等登记的读者离开，
+  /// 所以代数一致时复制会话是安全的，槽位被释放或复用后旧句柄解析为空
+  ///  @param[in]   handle  会话句柄
+  ///  @return 会话，句柄失效返回空
+  TPN_INLINE std::shared_ptr<SessionType> Resolve(SessionHandle handle) {
+    auto index      = static_cast<uint32_t>(handle);
+    auto generation = static_cast<uint32_t>(handle >> 32);
+    if (0 == generation) {
+      return {};
+    }
+
+    SlotChunk *chunk = this->GetChunk(index);
+    if (!chunk) {
+      return {};
+    }
+
+    Slot &slot = chunk->slots[index & (kSessionSlotChunkSize - 1)];
+    std::shared_ptr<SessionType> session_sptr;
+    slot.readers.fetch_add(1, std::memory_order_seq_cst);
+    if (generation == slot.generation.load(std::memory_order_seq_cst)) {
+      session_sptr = slot.session;
+    }
+    slot.readers.fetch_sub(1, std::memory_order_release);
+    return session_sptr;
   }
 
   /// 对注册过的网络会话进行条件查找
-  ///  @param[in]   fn      函数操作 函数签名 void(std::shared_ptr<SessionType> &)
+  ///  @param[in]   fn      函数操作 函数签名 bool(std::shared_ptr<SessionType> &)
   TPN_INLINE std::shared_ptr<SessionType> FindIf(
-      const std::function<void(std::shared_ptr<SessionType> &)> &fn) {
-    std::shared_lock<std::shared_mutex> guard(this->mutex_);
-    auto iter =
-        std::find_if(this->sessions_.begin(), this->sessions_.end(),
-                     [this, &fn](auto &pair) { return fn(pair.second); });
-    return (this->sessions_.end() == iter) ? std::shared_ptr<SessionType>()
-                                           : iter->second;
+      const std::function<bool(std::shared_ptr<SessionType> &)> &fn) {
+    for (auto &shard : this->shards_) {
+      std::shared_lock<std::shared_mutex> guard(shard.mutex);
+      for (auto &[_, session_sptr] : shard.sessions) {
+        if (fn(session_sptr)) {
+          return session_sptr;
+        }
+      }
+    }
+    return {};
   }
 
   /// 获取网络会话管理器中注册的会话数量
   ///  @return 网络会话管理器中注册的会话数量
-  TPN_INLINE size_t GetSize() { return this->sessions_.size(); }
+  TPN_INLINE size_t GetSize() {
+    return this->size_.load(std::memory_order_relaxed);
+  }
 
   /// 网络会话管理器中是否有会话注册过
   ///  @return 网络会话管理器为空时返回true
-  TPN_INLINE bool IsEmpty() { return this->sessions_.empty(); }
+  TPN_INLINE bool IsEmpty() { return 0 == this->GetSize(); }
+
+ protected:
+  /// 同一个io句柄上的广播目标
+  using BroadcastTargets = std::vector<std::shared_ptr<SessionType>>;
+  using BroadcastGroups  = std::vector<std::pair<IoHandle *, BroadcastTargets>>;
+
+  /// 会话分片，独占缓存行避免分片之间的伪共享
+  struct alignas(64) Shard {
+    std::shared_mutex mutex;  ///< 分片读写锁
+    std::unordered_map<key_type, std::shared_ptr<SessionType>>
+        sessions;  ///< 分片中的会话
+  };
+
+  /// 会话句柄槽位，释放时先增加代数再清空会话
+  struct Slot {
+    std::atomic<uint32_t> generation{1};  ///< 代数，从1开始
+    std::atomic<uint32_t> readers{0};     ///< 正在复制会话的读者数
+    std::shared_ptr<SessionType> session;  ///< 会话
+  };
+
+  /// 槽位块，分配后地址不变，解析句柄时不需要加锁
+  struct SlotChunk {
+    std::array<Slot, kSessionSlotChunkSize> slots;  ///< 槽位
+  };
+
+  /// 获取key所在的分片
+  ///  @param[in]   key     网络会话哈希key
+  ///  @return 分片
+  TPN_INLINE Shard &GetShard(const key_type &key) {
+    // 会话key可能是对象地址，低位对齐为0，混合高位后再取模
+    size_t hash = std::hash<key_type>()(key);
+    hash ^= hash >> 16;
+    hash ^= hash >> 7;
+    return this->shards_[hash & (kSessionMgrShards - 1)];
+  }
+
+  /// 获取槽位下标所在的块
+  ///  @param[in]   index   槽位下标
+  ///  @return 槽位块，未分配返回空
+  TPN_INLINE SlotChunk *GetChunk(uint32_t index) {
+    size_t chunk_index = index / kSessionSlotChunkSize;
+    if (chunk_index >= kSessionSlotMaxChunks) {
+      return nullptr;
+    }
+    return this->chunks_[chunk_index].load(std::memory_order_acquire);
+  }
+
+  /// 为会话分配句柄，槽位用完时返回无效句柄，会话仍然可以用key查找
+  ///  @param[in]   session_sptr  会话
+  ///  @return 会话句柄
+  SessionHandle AllocateHandle(const std::shared_ptr<SessionType> &session_sptr) {
+    std::lock_guard<std::mutex> guard(this->slot_mutex_);
+
+    if (this->free_slots_.empty()) {
+      size_t chunk_index = this->chunk_uptrs_.size();
+      if (chunk_index >= kSessionSlotMaxChunks) {
+        NET_WARN("SessionMgr session slots exhausted");
+        return kInvalidSessionHandle;
+      }
+
+      auto &chunk_uptr =
+          this->chunk_uptrs_.emplace_back(std::make_unique<SlotChunk>());
+      this->chunks_[chunk_index].store(chunk_uptr.get(),
+                                       std::memory_order_release);
+
+      // 倒序放入，先分配下标小的槽位
+      auto base = static_cast<uint32_t>(chunk_index * kSessionSlotChunkSize);
+      for (uint32_t i = kSessionSlotChunkSize; i > 0; --i) {
+        this->free_slots_.emplace_back(base + i - 1);
+      }
+    }
+
+    uint32_t index = this->free_slots_.back();
+    this->free_slots_.pop_back();
+
+    Slot &slot = this->chunk_uptrs_[index / kSessionSlotChunkSize]
+                     ->slots[index & (kSessionSlotChunkSize - 1)];
+    // 当前代数还没有发出过句柄，读者都会校验失败，不会读取会话
+    slot.session = session_sptr;
+    return (static_cast<SessionHandle>(
+                slot.generation.load(std::memory_order_relaxed))
+            << 32) |
+           index;
+  }
+
+  /// 释放会话句柄，代数加一使旧句柄失效
+  ///  @param[in]   handle  会话句柄
+  void FreeHandle(SessionHandle handle) {
+    if (kInvalidSessionHandle == handle) {
+      return;
+    }
+
+    auto index = static_cast<uint32_t>(handle);
+
+    std::lock_guard<std::mutex> guard(this->slot_mutex_);
+
+    Slot &slot = this->chunk_uptrs_[index / kSessionSlotChunkSize]
+                     ->slots[index & (kSessionSlotChunkSize - 1)];
+    uint32_t generation = slot.generation.load(std::memory_order_relaxed) + 1;
+    // 代数回绕时跳过0，保证句柄不为0
+    slot.generation.store(0 == generation ? 1 : generation,
+                          std::memory_order_seq_cst);
+    // 等待已经通过代数校验的读者复制完会话
+    while (0 != slot.readers.load(std::memory_order_seq_cst)) {
+      std::this_thread::yield();
+    }
+    slot.session.reset();
+    this->free_slots_.emplace_back(index);
+  }
+
+  /// 把会话加入所在io句柄的分组，io线程数很少，线性查找即可
+  ///  @param[in]   groups        分组
+  ///  @param[in]   session_sptr  会话
+  static void AddBroadcastTarget(
+      BroadcastGroups &groups,
+      const std::shared_ptr<SessionType> &session_sptr) {
+    IoHandle *io_handle = &session_sptr->GetIoHandle();
+    auto iter =
+        std::find_if(groups.begin(), groups.end(), [io_handle](auto &group) {
+          return io_handle == group.first;
+        });
+    if (groups.end() == iter) {
+      iter = groups.emplace(groups.end(), io_handle, BroadcastTargets{});
+    }
+    iter->second.emplace_back(session_sptr);
+  }
+
+  /// 每个io句柄提交一个任务，在strand上依次把缓冲放入会话的发送队列
+  ///  @param[in]   buffer    共享的只读缓冲
+  ///  @param[in]   groups    分组
+  static void PostBroadcast(const SharedMessageBuffer &buffer,
+                            BroadcastGroups &groups) {
+    for (auto &[io_handle, sessions] : groups) {
+      asio::post(io_handle->GetStrand(),
+                 [buffer, sessions = std::move(sessions)]() {
+                   for (auto &session_sptr : sessions) {
+                     session_sptr->Send(buffer);
+                   }
+                 });
+    }
+  }
 
  protected:
-  std::unordered_map<key_type, std::shared_ptr<SessionType>>
-      sessions_;             ///< 会话哈希树，存放已经连接的会话
-  std::shared_mutex mutex_;  ///< 使用rwlock确保会话树线程安全
-  IoHandle &acceptor_io_handle_;                       ///< 接受io句柄
+  std::array<Shard, kSessionMgrShards> shards_;  ///< 会话分片，存放已经连接的会话
+  std::atomic<size_t> size_{0};                  ///< 注册的会话数
+  std::array<std::atomic<SlotChunk *>, kSessionSlotMaxChunks>
+      chunks_{};                                        ///< 槽位块，供无锁解析
+  std::vector<std::unique_ptr<SlotChunk>> chunk_uptrs_;  ///< 槽位块所有权
+  std::vector<uint32_t> free_slots_;                    ///< 空闲槽位下标
+  std::mutex slot_mutex_;                               ///< 槽位分配锁
+  IoHandle &acceptor_io_handle_;                        ///< 接受io句柄
   HandlerMemory<SizeOp<>, std::true_type> allocator_;  ///< 用户自定义内存分配
 };
 
@@ -0,0 +1,280 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_AWAITABLE_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_AWAITABLE_H_
+
+#include <new>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+
+#include "buffer_pool.h"
+#include "net_common.h"
+
+// 下面对 asio::detail::awaitable_frame 的特化照搬了 asio 1.18.2 的实现，
+// 升级asio时需要一起核对
+static_assert(ASIO_VERSION == 101802,
+              "awaitable_frame specialization must follow bundled asio");
+
+namespace tpn {
+
+namespace net {
+
+/// 协程执行器
+/// 就是会话所在io句柄的strand，单独成为一个类型是为了给它的协程帧
+/// 换上按io线程缓存的内存，见下方 awaitable_frame 的特化
+class IoExecutor : public asio::io_context::strand {
+ public:
+  using asio::io_context::strand::strand;
+
+  /// 构造函数
+  ///  @param[in]   strand    io句柄的strand
+  IoExecutor(const asio::io_context::strand &strand)
+      : asio::io_context::strand(strand) {}
+};
+
+/// 运行在io句柄strand上的协程
+///  @tparam  T   返回值类型
+template <typename T = void>
+using Awaitable = asio::awaitable<T, IoExecutor>;
+
+/// 协程完成标记，出错时在 co_await 处抛出 std::system_error
+inline constexpr asio::use_awaitable_t<IoExecutor> kUseAwaitable{};
+
+/// 异步操作完成方式
+enum class AwaitOpMode : uint8_t {
+  kDispatch,  ///< 在处理程序的执行器上立即执行，不在同一个strand时提交
+  kPost,      ///< 总是提交，发起函数中完成时使用
+  kDiscard,   ///< 不调用处理程序
+};
+
+/// 等待完成的异步操作
+/// 发起时把处理程序移进从缓冲池申请的节点，完成时移出并释放节点，
+/// 节点只保存指针，回调和协程使用同一套登记逻辑。
+/// 完成签名为 void(std::error_code, Args...)
+///  @tparam  Args...   错误码之后的完成参数类型
+template <typename... Args>
+class AwaitOp {
+ public:
+  using OpBase = AwaitOp;
+
+  /// 完成，调用后节点被释放
+  ///  @param[in]   mode      完成方式
+  ///  @param[in]   ec        错误码
+  ///  @param[in]   args...   完成参数
+  TPN_INLINE void Complete(AwaitOpMode mode, const std::error_code &ec,
+                           Args... args) {
+    this->invoke_(this, mode, ec, std::move(args)...);
+  }
+
+  /// 以错误码完成，其余参数默认构造，调用后节点被释放
+  ///  @param[in]   mode      完成方式
+  ///  @param[in]   ec        错误码
+  TPN_INLINE void Abort(AwaitOpMode mode, const std::error_code &ec) {
+    this->invoke_(this, mode, ec, Args()...);
+  }
+
+ protected:
+  using InvokeFunc = void (*)(AwaitOp *op, AwaitOpMode mode,
+                              const std::error_code &ec, Args &&...args);
+
+  InvokeFunc invoke_{nullptr};  ///< 完成函数
+};
+
+/// 等待发送完成，完成参数为写出的字节数
+/// 随发送事件存放在事件队列里，写完后由事件队列完成
+using SendOp = AwaitOp<size_t>;
+
+/// 携带处理程序的异步操作
+///  @tparam  Op        异步操作类型，派生自 AwaitOp
+///  @tparam  Handler   处理程序类型
+template <typename Op, typename Handler, typename Base = typename Op::OpBase>
+class AwaitOpImpl;
+
+template <typename Op, typename Handler, typename... Args>
+class AwaitOpImpl<Op, Handler, AwaitOp<Args...>> final : public Op {
+ public:
+  using executor_type = asio::associated_executor_t<Handler, IoExecutor>;
+
+  /// 创建
+  ///  @param[in]   handler   处理程序
+  ///  @param[in]   executor  处理程序没有关联执行器时使用的执行器
+  ///  @return 异步操作
+  template <typename H>
+  static Op *Create(H &&handler, const IoExecutor &executor) {
+    void *pointer = BufferPool::AllocateObject(sizeof(AwaitOpImpl));
+    return ::new (pointer) AwaitOpImpl(std::forward<H>(handler), executor);
+  }
+
+ private:
+  template <typename H>
+  AwaitOpImpl(H &&handler, const IoExecutor &executor)
+      : handler_(std::forward<H>(handler)),
+        executor_(asio::get_associated_executor(handler_, executor)) {
+    this->invoke_ = &AwaitOpImpl::Invoke;
+  }
+
+  static void Invoke(AwaitOp<Args...> *op, AwaitOpMode mode,
+                     const std::error_code &ec, Args &&...args) {
+    auto *impl = static_cast<AwaitOpImpl *>(op);
+    Handler handler(std::move(impl->handler_));
+    executor_type executor(std::move(impl->executor_));
+    impl->~AwaitOpImpl();
+    BufferPool::DeallocateObject(impl, sizeof(AwaitOpImpl));
+
+    auto task = [handler = std::move(handler), ec,
+                 ... args = std::move(args)]() mutable {
+      std::move(handler)(ec, std::move(args)...);
+    };
+    if (AwaitOpMode::kDispatch == mode) {
+      asio::dispatch(executor, std::move(task));
+    } else if (AwaitOpMode::kPost == mode) {
+      asio::post(executor, std::move(task));
+    }
+  }
+
+ private:
+  Handler handler_;        ///< 处理程序
+  executor_type executor_;  ///< 处理程序的执行器
+};
+
+/// 异步操作守护，交给不保证回调的接口时使用，析构时仍未完成则以 operation_aborted 完成
+///  @tparam  Op    异步操作类型
+template <typename Op>
+class AwaitOpGuard {
+ public:
+  AwaitOpGuard() = default;
+  explicit AwaitOpGuard(Op *op) : op_(op) {}
+  AwaitOpGuard(AwaitOpGuard &&other) noexcept
+      : op_(std::exchange(other.op_, nullptr)) {}
+  ~AwaitOpGuard() {
+    if (this->op_) {
+      this->op_->Abort(AwaitOpMode::kPost, asio::error::operation_aborted);
+    }
+  }
+
+  AwaitOpGuard(const AwaitOpGuard &) = delete;
+  AwaitOpGuard &operator=(const AwaitOpGuard &) = delete;
+  AwaitOpGuard &operator=(AwaitOpGuard &&) = delete;
+
+  /// 取出异步操作，之后由调用者负责完成
+  TPN_INLINE Op *Release() { return std::exchange(this->op_, nullptr); }
+
+ private:
+  Op *op_{nullptr};  ///< 异步操作
+};
+
+}  // namespace net
+
+}  // namespace tpn
+
+namespace asio {
+
+namespace detail {
+
+/// IoExecutor 上协程的帧
+/// 与通用实现相同，只是帧内存从缓冲池的线程缓存申请。asio自带的回收
+/// 每个线程只留一块，流水线上同时挂起的多个调用仍然要走全局堆
+///  @tparam  T   返回值类型
+template <typename T>
+class awaitable_frame<T, tpn::net::IoExecutor>
+    : public awaitable_frame_base<tpn::net::IoExecutor> {
+ public:
+  void *operator new(std::size_t size) {
+    return tpn::BufferPool::AllocateObject(size);
+  }
+
+  void operator delete(void *pointer, std::size_t size) {
+    tpn::BufferPool::DeallocateObject(pointer, size);
+  }
+
+  awaitable_frame() noexcept {}
+
+  awaitable_frame(awaitable_frame &&other) noexcept
+      : awaitable_frame_base<tpn::net::IoExecutor>(std::move(other)) {}
+
+  ~awaitable_frame() {
+    if (this->has_result_) {
+      static_cast<T *>(static_cast<void *>(this->result_))->~T();
+    }
+  }
+
+  awaitable<T, tpn::net::IoExecutor> get_return_object() noexcept {
+    this->coro_ = coroutine_handle<awaitable_frame>::from_promise(*this);
+    return awaitable<T, tpn::net::IoExecutor>(this);
+  }
+
+  template <typename U>
+  void return_value(U &&u) {
+    new (&this->result_) T(std::forward<U>(u));
+    this->has_result_ = true;
+  }
+
+  template <typename... Us>
+  void return_values(Us &&...us) {
+    this->return_value(std::forward_as_tuple(std::forward<Us>(us)...));
+  }
+
+  T get() {
+    this->caller_ = nullptr;
+    this->rethrow_exception();
+    return std::move(*static_cast<T *>(static_cast<void *>(this->result_)));
+  }
+
+ private:
+  alignas(T) unsigned char result_[sizeof(T)];
+  bool has_result_ = false;
+};
+
+/// IoExecutor 上无返回值协程的帧
+template <>
+class awaitable_frame<void, tpn::net::IoExecutor>
+    : public awaitable_frame_base<tpn::net::IoExecutor> {
+ public:
+  void *operator new(std::size_t size) {
+    return tpn::BufferPool::AllocateObject(size);
+  }
+
+  void operator delete(void *pointer, std::size_t size) {
+    tpn::BufferPool::DeallocateObject(pointer, size);
+  }
+
+  awaitable<void, tpn::net::IoExecutor> get_return_object() {
+    this->coro_ = coroutine_handle<awaitable_frame>::from_promise(*this);
+    return awaitable<void, tpn::net::IoExecutor>(this);
+  }
+
+  void return_void() {}
+
+  void get() {
+    this->caller_ = nullptr;
+    this->rethrow_exception();
+  }
+};
+
+}  // namespace detail
+
+}  // namespace asio
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_AWAITABLE_H_
@@ -25,6 +25,7 @@
 
 #include <limits>
 #include <memory>
+#include <type_traits>
 
 #include "common.h"
 #include "traits_hub.h"
@@ -103,6 +104,18 @@ class BufferWrap<BufferType, true> : public BufferType {
     BufferType::prepare(this->prepare_);
   }
 
+  /// 构造函数
+  /// 缓冲区类型支持分配器时使用指定的分配器，否则忽略
+  ///  @tparam      Allocator 分配器类型
+  ///  @param[in]   max       缓冲区最大长度
+  ///  @param[in]   prepare   缓冲区准备长度
+  ///  @param[in]   allocator 分配器
+  template <typename Allocator>
+  BufferWrap(size_type max, size_type prepare, const Allocator &allocator)
+      : BufferWrap(max, prepare, allocator,
+                   std::is_constructible<BufferType, size_type,
+                                         const Allocator &>{}) {}
+
   /// 获取基类
   ///  @return 获取CRTP基类
   TPN_INLINE BufferType &GetBase() { return (*this); }
@@ -140,6 +153,18 @@ class BufferWrap<BufferType, true> : public BufferType {
   }
 
  private:
+  template <typename Allocator>
+  BufferWrap(size_type max, size_type prepare, const Allocator &allocator,
+             std::true_type)
+      : BufferType(max, allocator), prepare_{prepare} {
+    BufferType::prepare(this->prepare_);
+  }
+
+  template <typename Allocator>
+  BufferWrap(size_type max, size_type prepare, const Allocator & /* allocator */,
+             std::false_type)
+      : BufferWrap(max, prepare) {}
+
   size_type prepare_{kBufferDefaultSize};  ///< 缓冲区准备长度
 
   TPN_DEFAULT_COPY(BufferWrap)
@@ -171,6 +196,14 @@ class BufferWrap<BufferType, false> : public BufferType {
     BufferType::prepare(this->prepare_);
   }
 
+  /// 构造函数
+  /// 本特化忽略分配器
+  ///  @param[in]   max       缓冲区最大长度
+  ///  @param[in]   prepare   缓冲区准备长度
+  template <typename Allocator>
+  BufferWrap(size_type max, size_type prepare, const Allocator & /* allocator */)
+      : BufferWrap(max, prepare) {}
+
   /// 获取基类
   ///  @return 获取CRTP基类
   TPN_INLINE BufferType &GetBase() { return (*this); }
@@ -235,6 +268,11 @@ class BufferWrap<EmptyBuffer, true> : public EmptyBuffer {
   /// 构造函数
   BufferWrap(size_type /* max */, size_type /* prepare */) {}
 
+  /// 构造函数
+  template <typename Allocator>
+  BufferWrap(size_type /* max */, size_type /* prepare */,
+             const Allocator & /* allocator */) {}
+
   /// 获取基类
   TPN_INLINE EmptyBuffer &GetBase() { return (*this); }
 
@@ -277,6 +315,11 @@ class BufferWrap<EmptyBuffer, false> : public EmptyBuffer {
   /// 构造函数
   BufferWrap(size_type /* max */, size_type /* prepare */) {}
 
+  /// 构造函数
+  template <typename Allocator>
+  BufferWrap(size_type /* max */, size_type /* prepare */,
+             const Allocator & /* allocator */) {}
+
   /// 获取基类
   TPN_INLINE EmptyBuffer &GetBase() { return (*this); }
 
@@ -0,0 +1,133 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "custom_allocator.h"
+
+#include <new>
+#include <bit>
+
+namespace tpn {
+
+namespace net {
+
+namespace {
+
+static constexpr size_t kHandlerCacheClassCount =
+    kHandlerCacheMaxBlockShift - kHandlerCacheMinBlockShift + 1;
+
+/// 空闲块链表节点
+struct HandlerCacheNode {
+  HandlerCacheNode *next;
+};
+
+/// 线程缓存，平凡类型在线程启动时零初始化，不依赖构造顺序
+struct HandlerThreadCache {
+  std::array<HandlerCacheNode *, kHandlerCacheClassCount> free;  ///< 空闲块链表
+  std::array<size_t, kHandlerCacheClassCount> count;             ///< 空闲块数
+  bool closed;  ///< 线程退出时已经清理，之后的归还直接交给全局堆
+};
+
+thread_local HandlerThreadCache t_handler_cache{};
+
+std::atomic<size_t> s_heap_allocations{0};    ///< 向全局堆申请的次数
+std::atomic<size_t> s_heap_deallocations{0};  ///< 归还全局堆的次数
+
+/// 线程退出时把缓存的块归还全局堆
+struct HandlerThreadCacheCleaner {
+  ~HandlerThreadCacheCleaner() {
+    auto &cache = t_handler_cache;
+    for (auto &head : cache.free) {
+      while (nullptr != head) {
+        HandlerCacheNode *node = head;
+        head                   = node->next;
+        ::operator delete(node);
+        s_heap_deallocations.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    cache.count.fill(0);
+    cache.closed = true;
+  }
+
+  bool registered{false};  ///< 访问一次使析构函数注册到线程退出
+};
+
+thread_local HandlerThreadCacheCleaner t_handler_cache_cleaner;
+
+/// 获取申请大小对应的分级
+///  @param[in]   size      申请大小
+///  @return 分级下标，超出最大分级返回kHandlerCacheClassCount
+size_t GetHandlerCacheClass(size_t size) {
+  if (size <= (size_t(1) << kHandlerCacheMinBlockShift)) {
+    return 0;
+  }
+  return std::bit_width(size - 1) - kHandlerCacheMinBlockShift;
+}
+
+}  // namespace
+
+void *HandlerCache::Allocate(size_t size) {
+  size_t index = GetHandlerCacheClass(size);
+  if (kHandlerCacheClassCount > index) {
+    auto &cache = t_handler_cache;
+    if (HandlerCacheNode *node = cache.free[index]) {
+      cache.free[index] = node->next;
+      --cache.count[index];
+      return node;
+    }
+    size = size_t(1) << (index + kHandlerCacheMinBlockShift);
+  }
+
+  s_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+  return ::operator new(size);
+}
+
+void HandlerCache::Deallocate(void *pointer, size_t size) {
+  if (nullptr == pointer) {
+    return;
+  }
+
+  size_t index = GetHandlerCacheClass(size);
+  auto &cache  = t_handler_cache;
+  if (kHandlerCacheClassCount > index && !cache.closed &&
+      kHandlerCacheDepth > cache.count[index]) {
+    t_handler_cache_cleaner.registered = true;
+
+    auto *node        = static_cast<HandlerCacheNode *>(pointer);
+    node->next        = cache.free[index];
+    cache.free[index] = node;
+    ++cache.count[index];
+    return;
+  }
+
+  s_heap_deallocations.fetch_add(1, std::memory_order_relaxed);
+  ::operator delete(pointer);
+}
+
+HandlerAllocStats HandlerCache::GetStats() {
+  return HandlerAllocStats{
+      s_heap_allocations.load(std::memory_order_relaxed),
+      s_heap_deallocations.load(std::memory_order_relaxed)};
+}
+
+}  // namespace net
+
+}  // namespace tpn
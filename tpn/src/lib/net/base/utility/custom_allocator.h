@@ -23,6 +23,8 @@
 #ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_CUSTOM_ALLOCATOR_H_
 #define TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_CUSTOM_ALLOCATOR_H_
 
+#include <array>
+#include <cstdint>
 #include <memory>
 #include <type_traits>
 #include <utility>
@@ -38,16 +40,53 @@ namespace {
 static constexpr size_t s_default_allocator_size = 1024;
 }  // namespace
 
+/// 处理程序内存的槽位数，总大小平分给各槽位
+static constexpr size_t kHandlerMemorySlots = 4;
+/// 处理程序线程缓存最小块大小 64B
+static constexpr size_t kHandlerCacheMinBlockShift = 6;
+/// 处理程序线程缓存最大块大小 4KB，更大的申请直接交给全局堆
+static constexpr size_t kHandlerCacheMaxBlockShift = 12;
+/// 处理程序线程缓存每个分级最多保留的块数，多出的归还全局堆
+static constexpr size_t kHandlerCacheDepth = 64;
+
 /// 内存操作类，封装了每次操作内存的长度
 template <size_t N = s_default_allocator_size>
 struct SizeOp {
   static constexpr size_t Size = N;  ///<  每次操作内存的大小
 };
 
-/// 用于管理用于基于处理程序的自定义分配的内存的类，它包含一个内存块，可以为分配请求返回该内存块。
-/// 如果申请的内存呗使用，或者申请的大小超过内存处理程序的持有的内存大小，交给全局堆初始化内存
-///  @tparam SizeN        申请大小
-///  @tparam IsAtomicUse  是否使用atomic_flag 默认为std::false_type
+/// 处理程序分配统计
+struct HandlerAllocStats {
+  size_t heap_allocations{0};    ///< 向全局堆申请的次数
+  size_t heap_deallocations{0};  ///< 归还全局堆的次数
+};
+
+/// 处理程序线程缓存
+/// 处理程序内存槽位用完或者申请过大时使用，按2的幂分级的空闲链表，每个线程一份，
+/// 相当于asio recycling_allocator每线程只缓存一块的扩展，稳定运行后不再访问全局堆。
+/// 块可以在一个线程申请、另一个线程归还，归还到当前线程的缓存
+class TPN_NET_API HandlerCache {
+ public:
+  /// 申请内存
+  ///  @param[in]   size      申请大小
+  ///  @return 内存地址
+  static void *Allocate(size_t size);
+
+  /// 归还内存
+  ///  @param[in]   pointer   内存地址
+  ///  @param[in]   size      申请时的大小
+  static void Deallocate(void *pointer, size_t size);
+
+  /// 获取所有线程的分配统计
+  ///  @return 分配统计
+  static HandlerAllocStats GetStats();
+};
+
+/// 用于管理用于基于处理程序的自定义分配的内存的类，
+/// 持有 kHandlerMemorySlots 个等大的槽位，同时进行的多个异步操作各占一个槽位。
+/// 槽位用完，或者申请的大小超过槽位大小，交给处理程序线程缓存
+///  @tparam SizeN        总大小
+///  @tparam IsAtomicUse  是否使用原子操作分配槽位 默认为std::false_type
 ///  @sa https://think-async.com/Asio/asio-1.18.0/src/examples/cpp11/allocation/server.cpp
 template <typename SizeN       = SizeOp<s_default_allocator_size>,
           typename IsAtomicUse = std::false_type>
@@ -56,28 +95,35 @@ class HandlerMemory;
 template <typename SizeN>
 class HandlerMemory<SizeN, std::false_type> {
  public:
-  explicit HandlerMemory() : in_use_(false) {}
+  static constexpr size_t kSlotSize = SizeN::Size / kHandlerMemorySlots;
+
+  explicit HandlerMemory() = default;
 
   inline void *allocate(size_t size) {
-    if (!in_use_ && size < sizeof(storage_)) {
-      in_use_ = true;
-      return &storage_;
-    } else {
-      return ::operator new(size);
+    if (size <= kSlotSize) {
+      for (size_t i = 0; i < kHandlerMemorySlots; ++i) {
+        if (0 == (this->in_use_ & (1u << i))) {
+          this->in_use_ |= (1u << i);
+          return &this->storage_[i];
+        }
+      }
     }
+    return HandlerCache::Allocate(size);
   }
 
-  inline void deallocate(void *pointer) {
-    if (pointer == &storage_) {
-      in_use_ = false;
+  inline void deallocate(void *pointer, size_t size) {
+    auto *base = reinterpret_cast<uint8_t *>(&this->storage_);
+    auto *ptr  = static_cast<uint8_t *>(pointer);
+    if (ptr >= base && ptr < base + sizeof(this->storage_)) {
+      this->in_use_ &= ~(1u << ((ptr - base) / sizeof(this->storage_[0])));
     } else {
-      ::operator delete(pointer);
+      HandlerCache::Deallocate(pointer, size);
     }
   }
 
  private:
-  std::aligned_storage_t<SizeN::Size> storage_;
-  bool in_use_{false};
+  std::array<std::aligned_storage_t<kSlotSize>, kHandlerMemorySlots> storage_;
+  uint32_t in_use_{0};  ///< 槽位占用位图
 
   TPN_NO_COPYABLE(HandlerMemory)
 };
@@ -85,27 +131,42 @@ class HandlerMemory<SizeN, std::false_type> {
 template <typename SizeN>
 class HandlerMemory<SizeN, std::true_type> {
  public:
-  HandlerMemory() { in_use_.clear(); }
+  static constexpr size_t kSlotSize = SizeN::Size / kHandlerMemorySlots;
+
+  HandlerMemory() = default;
 
   inline void *allocate(size_t size) {
-    if (!in_use_.test_and_set() && size < sizeof(storage_)) {
-      return &storage_;
-    } else {
-      return ::operator new(size);
+    if (size <= kSlotSize) {
+      uint32_t in_use = this->in_use_.load(std::memory_order_relaxed);
+      for (size_t i = 0; i < kHandlerMemorySlots; ++i) {
+        uint32_t bit = 1u << i;
+        while (0 == (in_use & bit)) {
+          if (this->in_use_.compare_exchange_weak(in_use, in_use | bit,
+                                                  std::memory_order_acquire,
+                                                  std::memory_order_relaxed)) {
+            return &this->storage_[i];
+          }
+        }
+      }
     }
+    return HandlerCache::Allocate(size);
   }
 
-  inline void deallocate(void *pointer) {
-    if (pointer == &storage_) {
-      in_use_.clear();
+  inline void deallocate(void *pointer, size_t size) {
+    auto *base = reinterpret_cast<uint8_t *>(&this->storage_);
+    auto *ptr  = static_cast<uint8_t *>(pointer);
+    if (ptr >= base && ptr < base + sizeof(this->storage_)) {
+      this->in_use_.fetch_and(
+          ~(1u << ((ptr - base) / sizeof(this->storage_[0]))),
+          std::memory_order_release);
     } else {
-      ::operator delete(pointer);
+      HandlerCache::Deallocate(pointer, size);
     }
   }
 
  private:
-  std::aligned_storage_t<SizeN::Size> storage_;
-  std::atomic_flag in_use_;
+  std::array<std::aligned_storage_t<kSlotSize>, kHandlerMemorySlots> storage_;
+  std::atomic<uint32_t> in_use_{0};  ///< 槽位占用位图
 
   TPN_NO_COPYABLE(HandlerMemory)
 };
@@ -136,8 +197,8 @@ class HandlerAllocator {
     return static_cast<T *>(memory_.allocate(sizeof(T) * n));
   }
 
-  inline void deallocate(T *p, size_t /* n */) const {
-    return memory_.deallocate(p);
+  inline void deallocate(T *p, size_t n) const {
+    return memory_.deallocate(p, sizeof(T) * n);
   }
 
  private:
@@ -25,17 +25,34 @@
 
 #include <memory>
 #include <functional>
-#include <queue>
+#include <mutex>
+#include <variant>
 
 #include "debug_hub.h"
+#include "message_buffer.h"
 #include "net_common.h"
 #include "io_pool.h"
+#include "session_pool.h"
+#include "event_ring.h"
+#include "awaitable.h"
 
 namespace tpn {
 
 namespace net {
 
-TEMPLATE_DECL_2 class EventQueue;
+TPN_NET_FORWARD_DECL_BASE_CLASS
+
+/// 事件队列内部存放的事件数，超出后从会话内存池扩容
+static constexpr size_t kEventQueueInlineSize = 8;
+/// 跨线程入队的收件箱内部存放的事件数
+static constexpr size_t kEventInboxInlineSize = 4;
+
+/// 事件标志，发送可以被丢弃
+static constexpr uint8_t kEventFlagDroppable = 0x1;
+/// 事件标志，发送只关心同key的最新值
+static constexpr uint8_t kEventFlagLatest = 0x2;
+/// 事件标志，已被丢弃，轮到时跳过
+static constexpr uint8_t kEventFlagSkipped = 0x4;
 
 /// 事件队列守护
 ///  @tparam  Derived
@@ -85,45 +102,151 @@ class EventQueueGuard {
 };
 
 /// 事件队列
+/// 事件按类型存放在环形队列里，发送事件只存缓冲描述，不经过std::function，
+/// 稳定后入队不申请内存；其他事件（连接、断开等）仍然是通用回调。
+/// 同一时刻只有一个事件在执行，执行完成（守护析构）后处理下一个。
+/// strand上同步完成的事件在同一次循环中连续处理，不递归也不重新提交；
+/// 其他线程入队的事件先放入收件箱，每批只向strand提交一次。
 ///  @tparam  Derived
 ///  @tparam  ArgsType
 template <typename Derived, typename ArgsType = void>
 class EventQueue {
+  TPN_NET_FRIEND_DECL_BASE_CLASS
+
  public:
-  EventQueue()  = default;
-  ~EventQueue() = default;
+  using EventFunction = std::function<bool(EventQueueGuard<Derived> &&)>;
+
+  /// 事件
+  struct Event {
+    std::variant<EventFunction, MessageBuffer, SharedMessageBuffer>
+        data;             ///< 通用回调或要发送的帧
+    size_t accounted{0};  ///< 计入受限发送队列的字节数
+    uint64_t key{0};      ///< 合并用的key
+    uint8_t flags{0};     ///< 事件标志
+    SendOp *op{nullptr};  ///< 写完后完成的异步发送
+  };
+
+  EventQueue() = default;
+
+  /// 析构时归还未执行事件的负载计数，未执行的异步发送以 operation_aborted 完成
+  ~EventQueue() {
+    size_t pending = this->events_.Size() + this->inbox_.Size() +
+                     (this->busy_ ? 1 : 0);
+    if (this->load_ && pending > 0) {
+      this->load_->RemovePending(pending);
+    }
+
+    auto abort = [](auto &ring) {
+      for (uint64_t seq = ring.GetHead(); seq != ring.GetTail(); ++seq) {
+        if (SendOp *op = std::exchange(ring.At(seq).op, nullptr)) {
+          op->Abort(AwaitOpMode::kPost, asio::error::operation_aborted);
+        }
+      }
+    };
+    abort(this->events_);
+    abort(this->inbox_);
+  }
+
+  /// 构造函数
+  /// 事件队列扩容的存储从io句柄的会话内存池申请
+  ///  @param[in]   io_handle   io句柄
+  explicit EventQueue(IoHandle &io_handle)
+      : events_(EventAllocator(io_handle.GetSessionPool())),
+        inbox_(EventAllocator(io_handle.GetSessionPool())),
+        load_(&io_handle.GetLoad()) {}
 
   /// 事件入队
   ///  @tparam      Callback    事件函数类型
   ///  @param[in]   callback    事件回调
   template <typename Callback>
   TPN_INLINE Derived &EventEnqueue(Callback &&callback) {
+    return this->EventPush(
+        Event{EventFunction(std::forward<Callback>(callback))});
+  }
+
+  /// 发送事件入队
+  ///  @param[in]   buffer      调用需要保证buffer满足底层拆包逻辑
+  TPN_INLINE Derived &EventEnqueueSend(MessageBuffer &&buffer) {
+    return this->EventPush(Event{std::move(buffer)});
+  }
+
+  /// 发送事件入队，写完后完成异步发送
+  ///  @param[in]   buffer      调用需要保证buffer满足底层拆包逻辑
+  ///  @param[in]   op          异步发送操作
+  TPN_INLINE Derived &EventEnqueueSend(MessageBuffer &&buffer, SendOp *op) {
+    return this->EventPush(Event{std::move(buffer), 0, 0, 0, op});
+  }
+
+  /// 发送共享缓冲事件入队
+  ///  @param[in]   buffer      调用需要保证buffer满足底层拆包逻辑
+  TPN_INLINE Derived &EventEnqueueSend(const SharedMessageBuffer &buffer) {
+    return this->EventPush(Event{buffer});
+  }
+
+ protected:
+  using EventAllocator = SessionPoolAllocator<Event>;
+
+  /// 事件入队
+  /// strand上直接放入事件队列，否则放入收件箱
+  ///  @param[in]   event       事件
+  TPN_INLINE Derived &EventPush(Event &&event) {
     Derived &derive = CRTP_CAST(this);
 
     // 必须确保在strand上运行，否则不能保证串行
     if (derive.GetIoHandle().GetStrand().running_in_this_thread()) {
-      bool empty = this->events_.empty();
-      this->events_.emplace(std::forward<Callback>(callback));
-      if (empty) {
-        (this->events_.front())(EventQueueGuard<Derived>{derive});
-      }
+      this->EventPushInStrand(std::move(event));
       return derive;
     }
 
-    // 非strand 提交到对应的strand上运行
-    derive.Post([this, &derive, self_ptr = derive.GetSelfSptr(),
-                 callback = std::forward<Callback>(callback)]() mutable {
-      bool empty = this->events_.empty();
-      this->events_.emplace(std::move(callback));
-      if (empty) {
-        (this->events_.front())(EventQueueGuard<Derived>{derive});
-      }
-    });
+    // 非strand 放入收件箱，已经提交过的批次不再提交
+    bool post = false;
+    {
+      std::lock_guard<std::mutex> lock(this->inbox_mutex_);
+      this->inbox_.EmplaceBack(std::move(event));
+      post                = !this->inbox_posted_;
+      this->inbox_posted_ = true;
+    }
+    this->AddPending();
 
-    return (derive);
+    if (post) {
+      derive.Post([this, self_ptr = derive.GetSelfSptr()]() mutable {
+        this->DrainInbox();
+      });
+    }
+    return derive;
+  }
+
+  /// 在strand上事件入队
+  ///  @param[in]   event       事件
+  ///  @return 事件序号，用 FindEvent 查找还未执行的事件
+  TPN_INLINE uint64_t EventPushInStrand(Event &&event) {
+    uint64_t seq = this->events_.GetTail();
+    this->events_.EmplaceBack(std::move(event));
+    this->AddPending();
+    this->RunEvents();
+    return seq;
+  }
+
+  /// 查找还未执行的事件，在strand上调用
+  ///  @param[in]   seq         事件序号
+  ///  @return 事件，已经执行或不存在返回nullptr
+  TPN_INLINE Event *FindEvent(uint64_t seq) {
+    return this->events_.Contains(seq) ? &this->events_.At(seq) : nullptr;
+  }
+
+  /// 从最旧的开始遍历还未执行的事件，在strand上调用
+  ///  @tparam      Func        函数类型 bool(Event &)，返回false停止遍历
+  ///  @param[in]   func        函数
+  template <typename Func>
+  TPN_INLINE void ForEachEvent(Func &&func) {
+    for (uint64_t seq = this->events_.GetHead(); seq != this->events_.GetTail();
+         ++seq) {
+      if (!func(this->events_.At(seq))) {
+        break;
+      }
+    }
   }
 
- protected:
   /// 事件链上处理下一个事件
   template <typename = void>
   TPN_INLINE Derived &NextEvent() {
@@ -131,33 +254,147 @@ class EventQueue {
 
     // 必须确保在strand上运行，否则不能保证串行
     if (derive.GetIoHandle().GetStrand().running_in_this_thread()) {
-      TPN_ASSERT(!this->events_.empty(), "EventQueue events empty");
-      if (!this->events_.empty()) {
-        this->events_.pop();
-        if (!this->events_.empty()) {
-          (this->events_.front())(EventQueueGuard<Derived>{derive});
-        }
-      }
+      this->FinishEvent();
       return derive;
     }
 
     // 非strand 提交到对应的strand上运行
-    derive.Post([this, &derive, self_ptr = derive.GetSelfSptr()]() mutable {
-      TPN_ASSERT(!this->events_.empty(), "EventQueue events empty");
-      if (!this->events_.empty()) {
-        this->events_.pop();
-        if (!this->events_.empty()) {
-          (this->events_.front())(EventQueueGuard<Derived>{derive});
+    derive.Post([this, self_ptr = derive.GetSelfSptr()]() mutable {
+      this->FinishEvent();
+    });
+
+    return (derive);
+  }
+
+ private:
+  /// 依次执行事件，直到有事件异步执行或队列为空，在strand上调用
+  void RunEvents() {
+    if (this->busy_ || this->draining_) {
+      return;
+    }
+
+    this->draining_ = true;
+    while (!this->busy_ && !this->events_.Empty()) {
+      this->current_ = std::move(this->events_.Front());
+      this->events_.PopFront();
+
+      if (this->current_.flags & kEventFlagSkipped) {
+        if (SendOp *op = std::exchange(this->current_.op, nullptr)) {
+          op->Abort(AwaitOpMode::kPost, asio::error::operation_aborted);
         }
+        this->current_ = Event{};
+        this->RemovePending();
+        continue;
+      }
+
+      this->busy_ = true;
+      this->DispatchEvent(this->current_);
+
+      // 同步完成的事件在这里释放，执行中的回调不会被析构
+      if (!this->busy_) {
+        this->current_ = Event{};
+      }
+    }
+    this->draining_ = false;
+  }
+
+  /// 当前事件执行完成，在strand上调用
+  void FinishEvent() {
+    TPN_ASSERT(this->busy_, "EventQueue no event running");
+    if (!this->busy_) {
+      return;
+    }
+
+    this->busy_ = false;
+    this->RemovePending();
+
+    // 在RunEvents循环中同步完成的由循环继续处理
+    if (!this->draining_) {
+      this->current_ = Event{};
+      this->RunEvents();
+    }
+  }
+
+  /// 执行事件
+  ///  @param[in]   event       事件
+  void DispatchEvent(Event &event) {
+    Derived &derive = CRTP_CAST(this);
+
+    if (auto *function = std::get_if<EventFunction>(&event.data)) {
+      (*function)(EventQueueGuard<Derived>{derive});
+      return;
+    }
+
+    // 写操作不保证回调，异步发送由守护在未完成时以 operation_aborted 完成
+    AwaitOpGuard<SendOp> op(std::exchange(event.op, nullptr));
+
+    // 受限发送队列超限断开后，排队的发送直接跳过
+    if ((event.accounted > 0) && !derive.IsStarted()) {
+      derive.ReleaseSendQueue(event.accounted);
+      if (SendOp *send_op = op.Release()) {
+        send_op->Abort(AwaitOpMode::kPost, asio::error::not_connected);
+      }
+      this->FinishEvent();
+      return;
+    }
+
+    NET_DEBUG("EventQueue DispatchEvent DoSend");
+    const MessageBuffer *frame = std::get_if<MessageBuffer>(&event.data);
+    if (!frame) {
+      frame = std::get<SharedMessageBuffer>(event.data).Get();
+    }
+    derive.DoSend(*frame, [&derive, accounted = event.accounted,
+                           op    = std::move(op),
+                           guard = EventQueueGuard<Derived>{derive}](
+                              const std::error_code &ec,
+                              size_t bytes_sent) mutable {
+      if (accounted > 0) {
+        derive.ReleaseSendQueue(accounted);
+      }
+      if (SendOp *send_op = op.Release()) {
+        send_op->Complete(AwaitOpMode::kDispatch, ec, bytes_sent);
       }
     });
+  }
 
-    return (derive);
+  /// 收件箱中的事件移入事件队列，在strand上调用
+  void DrainInbox() {
+    {
+      std::lock_guard<std::mutex> lock(this->inbox_mutex_);
+      while (!this->inbox_.Empty()) {
+        this->events_.EmplaceBack(std::move(this->inbox_.Front()));
+        this->inbox_.PopFront();
+      }
+      this->inbox_posted_ = false;
+    }
+    this->RunEvents();
   }
 
  protected:
-  std::queue<std::function<bool(EventQueueGuard<Derived> &&)>>
-      events_;  ///<  事件
+  /// 计入io句柄负载
+  TPN_INLINE void AddPending() {
+    if (this->load_) {
+      this->load_->AddPending();
+    }
+  }
+
+  /// 从io句柄负载中移除
+  TPN_INLINE void RemovePending() {
+    if (this->load_) {
+      this->load_->RemovePending();
+    }
+  }
+
+  EventRing<Event, kEventQueueInlineSize, EventAllocator>
+      events_;  ///<  事件，只在strand上访问
+  EventRing<Event, kEventInboxInlineSize, EventAllocator>
+      inbox_;                 ///<  其他线程入队的事件
+  std::mutex inbox_mutex_;    ///<  收件箱锁
+  bool inbox_posted_{false};  ///<  收件箱是否已提交到strand
+  Event current_;             ///<  正在执行的事件
+  bool busy_{false};          ///<  是否有事件正在执行
+  bool draining_{false};      ///<  是否在RunEvents循环中
+  IoLoad *load_{nullptr};     ///<  所在io句柄的负载计数
 };
 
 }  // namespace net
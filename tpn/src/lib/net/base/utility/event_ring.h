@@ -0,0 +1,168 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_EVENT_RING_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_EVENT_RING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "define.h"
+
+namespace tpn {
+
+namespace net {
+
+/// 事件环形队列
+/// 前 InlineN 个元素存放在对象内部，超出后按2的幂向分配器申请更大的连续空间，
+/// 空间只增不减，稳定后入队出队都不申请内存。
+/// 每个元素有一个递增的序号，元素在队列中时可以通过序号随机访问，
+/// 扩容时元素按序号搬到新空间的对应位置，序号不变。
+///  @tparam  T           元素类型，移动构造需要noexcept
+///  @tparam  InlineN     内部存放的元素个数，需要是2的幂
+///  @tparam  Allocator   超出内部空间后使用的分配器
+template <typename T, size_t InlineN, typename Allocator = std::allocator<T>>
+class EventRing {
+  static_assert(InlineN > 0 && 0 == (InlineN & (InlineN - 1)),
+                "EventRing InlineN must be power of 2");
+  static_assert(std::is_nothrow_move_constructible_v<T>,
+                "EventRing T must be nothrow move constructible");
+
+ public:
+  /// 构造函数
+  ///  @param[in]   allocator   分配器
+  explicit EventRing(const Allocator &allocator = Allocator())
+      : allocator_(allocator) {}
+
+  /// 析构函数
+  ~EventRing() {
+    this->Clear();
+    if (!this->IsInline()) {
+      this->allocator_.deallocate(this->slots_, this->mask_ + 1);
+    }
+  }
+
+  /// 尾部构造元素
+  ///  @tparam      Args...   构造参数类型
+  ///  @param[in]   args...   构造参数
+  ///  @return 元素
+  template <typename... Args>
+  TPN_INLINE T &EmplaceBack(Args &&...args) {
+    if (this->tail_ - this->head_ > this->mask_) [[unlikely]] {
+      this->Grow();
+    }
+    T *slot = this->slots_ + (this->tail_ & this->mask_);
+    ::new (static_cast<void *>(slot)) T(std::forward<Args>(args)...);
+    ++this->tail_;
+    return *slot;
+  }
+
+  /// 获取头部元素
+  ///  @return 头部元素
+  TPN_INLINE T &Front() { return this->slots_[this->head_ & this->mask_]; }
+
+  /// 移除头部元素
+  TPN_INLINE void PopFront() {
+    this->slots_[this->head_ & this->mask_].~T();
+    ++this->head_;
+  }
+
+  /// 通过序号访问元素，调用者需要保证序号在 [GetHead(), GetTail()) 中
+  ///  @param[in]   seq       序号
+  ///  @return 元素
+  TPN_INLINE T &At(uint64_t seq) { return this->slots_[seq & this->mask_]; }
+
+  /// 序号对应的元素是否还在队列中
+  ///  @param[in]   seq       序号
+  ///  @return 在队列中返回true
+  TPN_INLINE bool Contains(uint64_t seq) const {
+    return seq >= this->head_ && seq < this->tail_;
+  }
+
+  /// 获取头部元素的序号
+  TPN_INLINE uint64_t GetHead() const { return this->head_; }
+
+  /// 获取下一个入队元素的序号
+  TPN_INLINE uint64_t GetTail() const { return this->tail_; }
+
+  /// 获取元素个数
+  TPN_INLINE size_t Size() const {
+    return static_cast<size_t>(this->tail_ - this->head_);
+  }
+
+  /// 是否为空
+  TPN_INLINE bool Empty() const { return this->head_ == this->tail_; }
+
+  /// 获取容量
+  TPN_INLINE size_t GetCapacity() const { return this->mask_ + 1; }
+
+  /// 清空所有元素，保留空间
+  void Clear() {
+    while (!this->Empty()) {
+      this->PopFront();
+    }
+  }
+
+ private:
+  /// 是否使用内部空间
+  TPN_INLINE bool IsInline() const {
+    return this->slots_ == reinterpret_cast<const T *>(this->storage_);
+  }
+
+  /// 扩容为两倍
+  void Grow() {
+    size_t capacity = (this->mask_ + 1) * 2;
+    T *slots        = this->allocator_.allocate(capacity);
+    for (uint64_t seq = this->head_; seq != this->tail_; ++seq) {
+      T &old = this->slots_[seq & this->mask_];
+      ::new (static_cast<void *>(slots + (seq & (capacity - 1))))
+          T(std::move(old));
+      old.~T();
+    }
+    if (!this->IsInline()) {
+      this->allocator_.deallocate(this->slots_, this->mask_ + 1);
+    }
+    this->slots_ = slots;
+    this->mask_  = capacity - 1;
+  }
+
+ private:
+  alignas(T) unsigned char storage_[sizeof(T) * InlineN];  ///< 内部空间
+  T *slots_{reinterpret_cast<T *>(storage_)};              ///< 当前空间
+  size_t mask_{InlineN - 1};                               ///< 容量掩码
+  uint64_t head_{0};                                       ///< 头部序号
+  uint64_t tail_{0};                                       ///< 尾部序号
+  Allocator allocator_;                                    ///< 分配器
+
+  TPN_NO_COPYABLE(EventRing)
+};
+
+}  // namespace net
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_EVENT_RING_H_
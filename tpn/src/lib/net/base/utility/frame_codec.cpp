@@ -0,0 +1,318 @@
+//
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "frame_codec.h"
+
+#include <queue>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <zlib.h>
+
+#include "byte_converter.h"
+
+namespace tpn {
+
+namespace net {
+
+namespace {
+
+/// 字典训练统计的片段长度
+static constexpr size_t kDictionaryGram = 8;
+/// 字典训练挑选的区段长度
+static constexpr size_t kDictionarySegment = 64;
+/// 字典训练候选区段的步长
+static constexpr size_t kDictionaryStride = 16;
+
+/// 默认压缩参数
+const std::shared_ptr<const FrameCompressOptions> &GetDefaultOptions() {
+  static const auto s_options = std::make_shared<const FrameCompressOptions>();
+  return s_options;
+}
+
+}  // namespace
+
+FrameCodec::FrameCodec(std::shared_ptr<const FrameCompressOptions> options)
+    : options_(options ? std::move(options) : GetDefaultOptions()) {
+  if (options_->dictionary && !options_->dictionary->empty()) {
+    dictionary_id_ = static_cast<uint32_t>(::adler32(
+        ::adler32(0L, Z_NULL, 0),
+        reinterpret_cast<const Bytef *>(options_->dictionary->data()),
+        static_cast<uInt>(options_->dictionary->size())));
+  }
+}
+
+FrameCodec::~FrameCodec() {
+  if (deflate_) {
+    ::deflateEnd(deflate_.get());
+  }
+  if (inflate_) {
+    ::inflateEnd(inflate_.get());
+  }
+}
+
+bool FrameCodec::PrepareDeflate() {
+  if (!deflate_) {
+    auto strm = std::make_unique<z_stream>();
+    if (Z_OK != ::deflateInit2(strm.get(), options_->level, Z_DEFLATED,
+                               MAX_WBITS, 8, Z_DEFAULT_STRATEGY)) {
+      return false;
+    }
+    deflate_ = std::move(strm);
+  } else if (Z_OK != ::deflateReset(deflate_.get())) {
+    return false;
+  }
+
+  // 重置会丢弃字典，每帧都需要重新设置
+  if (0 != dictionary_id_) {
+    const std::string &dictionary = *options_->dictionary;
+    if (Z_OK != ::deflateSetDictionary(
+                    deflate_.get(),
+                    reinterpret_cast<const Bytef *>(dictionary.data()),
+                    static_cast<uInt>(dictionary.size()))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool FrameCodec::PrepareInflate() {
+  if (!inflate_) {
+    auto strm = std::make_unique<z_stream>();
+    if (Z_OK != ::inflateInit2(strm.get(), MAX_WBITS)) {
+      return false;
+    }
+    inflate_ = std::move(strm);
+    return true;
+  }
+  return Z_OK == ::inflateReset(inflate_.get());
+}
+
+bool FrameCodec::CompressFrame(const uint8_t *frame, size_t size,
+                               MessageBuffer &out) {
+  if (size < kHeaderBytes) {
+    return false;
+  }
+
+  uint16_t header_length = *(reinterpret_cast<const uint16_t *>(frame));
+  tpn::EndianRefMakeLittle(header_length);
+  if ((0 == header_length) || (header_length + kHeaderBytes > size)) {
+    return false;
+  }
+
+  if (!header_.ParseFromArray(frame + kHeaderBytes, header_length)) {
+    return false;
+  }
+
+  const size_t body_size = header_.size();
+  if ((header_.flags() & kHeaderFlagCompressed) ||
+      (body_size < options_->threshold) ||
+      (body_size + header_length + kHeaderBytes != size)) {
+    return false;
+  }
+
+  if (!PrepareDeflate()) {
+    return false;
+  }
+
+  scratch_.resize(
+      ::deflateBound(deflate_.get(), static_cast<uLong>(body_size)));
+
+  z_stream &strm = *deflate_;
+  strm.next_in   = const_cast<Bytef *>(frame + kHeaderBytes + header_length);
+  strm.avail_in  = static_cast<uInt>(body_size);
+  strm.next_out  = scratch_.data();
+  strm.avail_out = static_cast<uInt>(scratch_.size());
+  if (Z_STREAM_END != ::deflate(&strm, Z_FINISH)) {
+    return false;
+  }
+
+  // 压缩后没有变小直接发送原始帧
+  const size_t compressed_size = strm.total_out;
+  if (compressed_size >= body_size) {
+    return false;
+  }
+
+  header_.set_flags(header_.flags() | kHeaderFlagCompressed);
+  header_.set_raw_size(static_cast<uint32_t>(body_size));
+  header_.set_size(static_cast<uint32_t>(compressed_size));
+
+  const size_t new_header_length = header_.ByteSizeLong();
+  if (new_header_length > (std::numeric_limits<uint16_t>::max)()) {
+    return false;
+  }
+
+  uint16_t header_bytes = static_cast<uint16_t>(new_header_length);
+  tpn::EndianRefMakeLittle(header_bytes);
+
+  out.Resize(kHeaderBytes + new_header_length + compressed_size);
+  out.Reset();
+  out.Write(&header_bytes, kHeaderBytes);
+  header_.SerializeWithCachedSizesToArray(out.GetWritePointer());
+  out.WriteCompleted(new_header_length);
+  out.Write(scratch_.data(), compressed_size);
+  return true;
+}
+
+bool FrameCodec::DecompressPacket(protocol::Header &header, const uint8_t *data,
+                                  size_t size, size_t max_size,
+                                  MessageBuffer &packet) {
+  // raw_size由对端填写，先检查再按它申请内存
+  const size_t raw_size = header.raw_size();
+  max_size = (std::min)(max_size, size_t(options_->max_raw_size));
+  if ((0 == raw_size) || (raw_size > max_size) || !PrepareInflate()) {
+    return false;
+  }
+
+  packet.Resize(raw_size);
+  packet.Reset();
+
+  z_stream &strm = *inflate_;
+  strm.next_in   = const_cast<Bytef *>(data);
+  strm.avail_in  = static_cast<uInt>(size);
+  strm.next_out  = packet.GetWritePointer();
+  strm.avail_out = static_cast<uInt>(raw_size);
+
+  int ret = ::inflate(&strm, Z_FINISH);
+  if (Z_NEED_DICT == ret) {
+    // 对端使用的字典与本端不一致
+    if ((0 == dictionary_id_) || (strm.adler != dictionary_id_)) {
+      return false;
+    }
+
+    const std::string &dictionary = *options_->dictionary;
+    if (Z_OK != ::inflateSetDictionary(
+                    &strm, reinterpret_cast<const Bytef *>(dictionary.data()),
+                    static_cast<uInt>(dictionary.size()))) {
+      return false;
+    }
+    ret = ::inflate(&strm, Z_FINISH);
+  }
+
+  if ((Z_STREAM_END != ret) || (strm.total_out != raw_size)) {
+    return false;
+  }
+
+  packet.WriteCompleted(raw_size);
+  header.set_flags(header.flags() & ~kHeaderFlagCompressed);
+  header.set_size(static_cast<uint32_t>(raw_size));
+  header.set_raw_size(0);
+  return true;
+}
+
+std::string FrameCodec::TrainDictionary(const std::vector<std::string> &samples,
+                                        size_t max_size) {
+  max_size = (std::min)(max_size, kFrameDictionaryMaxSize);
+
+  // 统计每个片段出现在多少个样本中
+  std::unordered_map<std::string_view, uint32_t> frequency;
+  for (const auto &sample : samples) {
+    std::unordered_set<std::string_view> seen;
+    for (size_t pos = 0; pos + kDictionaryGram <= sample.size(); ++pos) {
+      std::string_view gram(sample.data() + pos, kDictionaryGram);
+      if (seen.insert(gram).second) {
+        ++frequency[gram];
+      }
+    }
+  }
+
+  // 区段得分是其中出现在多个样本里的片段的频次之和
+  auto score = [&frequency, &samples](uint32_t index, size_t pos) {
+    const std::string &sample = samples[index];
+    const size_t end = (std::min)(pos + kDictionarySegment, sample.size());
+    uint64_t total   = 0;
+    for (; pos + kDictionaryGram <= end; ++pos) {
+      auto iter = frequency.find(
+          std::string_view(sample.data() + pos, kDictionaryGram));
+      if ((frequency.end() != iter) && (iter->second > 1)) {
+        total += iter->second;
+      }
+    }
+    return total;
+  };
+
+  struct Candidate {
+    uint64_t score;
+    uint32_t index;
+    size_t pos;
+
+    bool operator<(const Candidate &other) const { return score < other.score; }
+  };
+
+  std::priority_queue<Candidate> candidates;
+  for (uint32_t index = 0; index < samples.size(); ++index) {
+    for (size_t pos = 0; pos + kDictionaryGram <= samples[index].size();
+         pos += kDictionaryStride) {
+      uint64_t value = score(index, pos);
+      if (0 != value) {
+        candidates.push({value, index, pos});
+      }
+    }
+  }
+
+  // 惰性贪心，取出的区段得分下降后重新入队
+  std::vector<std::string_view> segments;
+  size_t total_size = 0;
+  while (!candidates.empty() && (total_size < max_size)) {
+    Candidate top = candidates.top();
+    candidates.pop();
+
+    top.score = score(top.index, top.pos);
+    if (0 == top.score) {
+      continue;
+    }
+    if (!candidates.empty() && (top.score < candidates.top().score)) {
+      candidates.push(top);
+      continue;
+    }
+
+    const std::string &sample = samples[top.index];
+    const size_t end = (std::min)(top.pos + kDictionarySegment, sample.size());
+    for (size_t pos = top.pos; pos + kDictionaryGram <= end; ++pos) {
+      auto iter = frequency.find(
+          std::string_view(sample.data() + pos, kDictionaryGram));
+      if (frequency.end() != iter) {
+        iter->second = 0;
+      }
+    }
+
+    segments.emplace_back(sample.data() + top.pos, end - top.pos);
+    total_size += end - top.pos;
+  }
+
+  // 先选中的区段价值更高，放在字典末尾
+  std::string dictionary;
+  dictionary.reserve(total_size);
+  for (auto iter = segments.rbegin(); iter != segments.rend(); ++iter) {
+    dictionary.append(iter->data(), iter->size());
+  }
+  if (dictionary.size() > max_size) {
+    dictionary.erase(0, dictionary.size() - max_size);
+  }
+  return dictionary;
+}
+
+}  // namespace net
+
+}  // namespace tpn
@@ -0,0 +1,124 @@
+//
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_FRAME_CODEC_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_FRAME_CODEC_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "define.h"
+#include "message_buffer.h"
+#include "rpc_type.pb.h"
+#include "net_common.h"
+
+struct z_stream_s;
+
+namespace tpn {
+
+namespace net {
+
+/// 帧压缩参数
+/// 没有握手协商，通信双方需要配置相同的预设字典，
+/// 每帧携带zlib的字典id(adler32)，不一致时接收方解压失败并断开
+struct FrameCompressOptions {
+  bool enable{false};  ///< 发送时是否压缩，接收时总会解压带压缩标志的帧
+  uint32_t threshold{kFrameCompressThreshold};  ///< 包体不小于该长度才压缩
+  int level{kFrameCompressLevel};               ///< zlib压缩等级 1-9
+  uint32_t max_raw_size{kFrameDecompressMaxSize};  ///< 解压后允许的最大长度
+  std::shared_ptr<const std::string> dictionary;  ///< 预设字典，可以为空
+};
+
+/// 帧压缩编解码器
+/// 帧格式 [u16 header_len][protocol::Header][body]，只压缩包体，
+/// 包头设置 kHeaderFlagCompressed 并在raw_size记录压缩前长度。
+/// 每帧独立压缩，deflate与inflate流在帧之间复用，不重复申请zlib内部状态。
+/// 非线程安全，需要在会话的strand中使用。
+class TPN_NET_API FrameCodec {
+ public:
+  /// 构造函数
+  ///  @param[in]   options   压缩参数，为空时使用默认参数
+  explicit FrameCodec(std::shared_ptr<const FrameCompressOptions> options);
+  ~FrameCodec();
+
+  FrameCodec(const FrameCodec &)            = delete;
+  FrameCodec &operator=(const FrameCodec &) = delete;
+
+  /// 压缩一个完整的帧
+  ///  @param[in]   frame     原始帧
+  ///  @param[in]   size      原始帧长度
+  ///  @param[out]  out       压缩后的帧
+  ///  @return 压缩成功返回true，包体小于阈值、已经压缩过、
+  ///          格式无法识别或压缩后没有变小返回false，此时应发送原始帧
+  bool CompressFrame(const uint8_t *frame, size_t size, MessageBuffer &out);
+
+  /// 解压包体
+  ///  @param[in]   header    包头，成功后清除压缩标志并把size改为解压后长度
+  ///  @param[in]   data      压缩的包体
+  ///  @param[in]   size      压缩的包体长度
+  ///  @param[in]   max_size  解压后允许的最大长度，与 max_raw_size 取较小值
+  ///  @param[out]  packet    解压后的包体
+  ///  @return 成功返回true，数据损坏、字典不一致或超过最大长度返回false，
+  ///          超过最大长度时不申请内存
+  bool DecompressPacket(protocol::Header &header, const uint8_t *data,
+                        size_t size, size_t max_size, MessageBuffer &packet);
+
+  /// 获取压缩参数
+  ///  @return 压缩参数
+  const FrameCompressOptions &GetOptions() const { return *options_; }
+
+  /// 获取预设字典的id
+  ///  @return 字典的adler32校验值，没有字典返回0
+  uint32_t GetDictionaryId() const { return dictionary_id_; }
+
+  /// 从样本流量中训练预设字典
+  /// 统计在多个样本中出现的8字节片段，贪心挑选覆盖最多未覆盖片段的区段，
+  /// 价值高的区段放在字典末尾，离被压缩数据更近，引用距离更短
+  ///  @param[in]   samples   样本包体
+  ///  @param[in]   max_size  字典最大长度，不超过 kFrameDictionaryMaxSize
+  ///  @return 字典，样本之间没有公共片段时为空
+  static std::string TrainDictionary(const std::vector<std::string> &samples,
+                                     size_t max_size = kFrameDictionaryMaxSize);
+
+ private:
+  /// 准备压缩流
+  bool PrepareDeflate();
+
+  /// 准备解压流
+  bool PrepareInflate();
+
+ private:
+  std::shared_ptr<const FrameCompressOptions> options_;  ///< 压缩参数
+  uint32_t dictionary_id_{0};                           ///< 预设字典id
+  std::unique_ptr<z_stream_s> deflate_;                 ///< 压缩流
+  std::unique_ptr<z_stream_s> inflate_;                 ///< 解压流
+  std::vector<uint8_t> scratch_;                        ///< 压缩输出缓冲
+  protocol::Header header_;                             ///< 压缩时解析的包头
+};
+
+}  // namespace net
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_FRAME_CODEC_H_
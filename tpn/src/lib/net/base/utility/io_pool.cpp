@@ -22,12 +22,22 @@
 
 #include "io_pool.h"
 
+#include <algorithm>
 #include <vector>
 #include <thread>
 #include <mutex>
 #include <chrono>
+#include <fstream>
+#include <random>
+#include <string>
+#include <tuple>
 #include <type_traits>
 
+#if defined(__linux__)
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
 #include "log.h"
 #include "chrono_wrap.h"
 
@@ -35,6 +45,99 @@ namespace tpn {
 
 namespace net {
 
+namespace {
+
+/// 解析cpu列表字符串，格式如 "0-3,8-11"
+///  @param[in]   str       cpu列表字符串
+///  @return cpu编号
+std::vector<int> ParseCpuList(const std::string &str) {
+  std::vector<int> cpus;
+  size_t pos = 0;
+  while (pos < str.size()) {
+    size_t end = str.find(',', pos);
+    if (std::string::npos == end) {
+      end = str.size();
+    }
+
+    std::string range = str.substr(pos, end - pos);
+    size_t dash       = range.find('-');
+    try {
+      int first = std::stoi(range.substr(0, dash));
+      int last = std::string::npos == dash ? first
+                                           : std::stoi(range.substr(dash + 1));
+      for (int cpu = first; cpu <= last; ++cpu) {
+        cpus.emplace_back(cpu);
+      }
+    } catch (std::exception &) {
+      // 忽略无法解析的部分，如行尾换行
+    }
+    pos = end + 1;
+  }
+  return cpus;
+}
+
+/// 按numa节点交错排列cpu，节点0的第一个cpu、节点1的第一个cpu……
+/// 读取不到numa节点信息时返回空
+///  @return cpu编号
+std::vector<int> GetNumaInterleavedCpus() {
+  std::vector<std::vector<int>> nodes;
+  for (size_t node = 0;; ++node) {
+    std::ifstream file(fmt::format("/sys/devices/system/node/node{}/cpulist",
+                                   node));
+    if (!file) {
+      break;
+    }
+
+    std::string line;
+    std::getline(file, line);
+    if (auto cpus = ParseCpuList(line); !cpus.empty()) {
+      nodes.emplace_back(std::move(cpus));
+    }
+  }
+
+  std::vector<int> cpus;
+  for (size_t i = 0;; ++i) {
+    bool found = false;
+    for (auto &node : nodes) {
+      if (i < node.size()) {
+        cpus.emplace_back(node[i]);
+        found = true;
+      }
+    }
+    if (!found) {
+      break;
+    }
+  }
+  return cpus;
+}
+
+}  // namespace
+
+size_t IoLoad::GetScore() {
+  auto now   = SteadyClock::now().time_since_epoch().count();
+  auto last  = this->sample_time_.load(std::memory_order_relaxed);
+  auto delta = std::chrono::duration_cast<MilliSeconds>(
+                   SteadyClock::duration(now - last))
+                   .count();
+
+  // 只有一个线程能抢到本次采样，其他线程沿用上次的结果
+  if (delta >= kIoLoadSampleInterval &&
+      this->sample_time_.compare_exchange_strong(last, now,
+                                                 std::memory_order_relaxed)) {
+    uint64_t bytes = this->GetBytes();
+    uint64_t rate  = bytes - this->sample_bytes_.load(std::memory_order_relaxed);
+    // 第一次采样没有参照，之后按实际间隔折算
+    rate = 0 == last ? 0
+                     : rate * kIoLoadSampleInterval / static_cast<uint64_t>(delta);
+    this->sample_bytes_.store(bytes, std::memory_order_relaxed);
+    this->sample_rate_.store(rate, std::memory_order_relaxed);
+  }
+
+  return this->GetSessions() + this->GetPending() +
+         static_cast<size_t>(this->sample_rate_.load(std::memory_order_relaxed) /
+                             kIoLoadBytesPerSession);
+}
+
 /// io_context 对象池
 class IoPool::IoPoolImpl {
  public:
@@ -61,6 +164,8 @@ class IoPool::IoPoolImpl {
       return false;
     }
 
+    std::vector<int> cpus = this->GetAffinityCpus();
+
     // 创建对象池 并且 启动所有的io_context对象
     for (auto &io : this->ios_) {
       // 重新启动io_context以准备后续的run()调用
@@ -82,6 +187,11 @@ class IoPool::IoPoolImpl {
         NET_DEBUG("io context run");
         io.GetIoContext().run();
       });
+
+      if (!cpus.empty()) {
+        size_t index = this->threads_.size() - 1;
+        PinThread(this->threads_.back(), cpus[index % cpus.size()]);
+      }
     }
 
     this->stopped_ = false;
@@ -123,7 +233,9 @@ class IoPool::IoPoolImpl {
       }
 
       for (auto &thread : this->threads_) {
-        thread.join();
+        if (thread.joinable()) {
+          thread.join();
+        }
       }
 
       this->workers_.clear();
@@ -135,12 +247,60 @@ class IoPool::IoPoolImpl {
 
   TPN_INLINE bool IsStopped() const { return this->stopped_; }
 
+  TPN_INLINE size_t GetSize() const { return this->ios_.size(); }
+
   TPN_INLINE IoHandle &GetIoHandleByIndex(size_t index) {
-    return this->ios_[index < this->ios_.size()
-                          ? index
-                          : ((++(this->next_)) % this->ios_.size())];
+    if (index < this->ios_.size()) {
+      return this->ios_[index];
+    }
+
+    size_t size = this->ios_.size();
+    size_t next = this->next_.fetch_add(1, std::memory_order_relaxed) + 1;
+    switch (this->select_policy_.load(std::memory_order_relaxed)) {
+      case IoSelectPolicy::kIoSelectPolicyLeastLoaded: {
+        // 从轮询位置开始遍历，负载相同时仍然按轮询分散
+        size_t best       = next % size;
+        size_t best_score = this->ios_[best].GetLoad().GetScore();
+        for (size_t i = 1; i < size && 0 != best_score; ++i) {
+          size_t curr       = (next + i) % size;
+          size_t curr_score = this->ios_[curr].GetLoad().GetScore();
+          if (curr_score < best_score) {
+            best       = curr;
+            best_score = curr_score;
+          }
+        }
+        return this->ios_[best];
+      }
+      case IoSelectPolicy::kIoSelectPolicyPowerOfTwo: {
+        thread_local std::minstd_rand random(
+            static_cast<std::minstd_rand::result_type>(
+                std::hash<std::thread::id>()(std::this_thread::get_id())));
+        // 两个候选不重复，只有一个io句柄时都是0
+        size_t first  = random() % size;
+        size_t second = size > 1 ? (first + 1 + random() % (size - 1)) % size
+                                 : first;
+        return this->ios_[this->ios_[second].GetLoad().GetScore() <
+                                  this->ios_[first].GetLoad().GetScore()
+                              ? second
+                              : first];
+      }
+      default:
+        return this->ios_[next % size];
+    }
+  }
+
+  TPN_INLINE void SetOptions(const IoPoolOptions &options) {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    if (!this->stopped_) {
+      NET_WARN("io pool options should be set before start");
+    }
+    this->options_ = options;
+    this->select_policy_.store(options.select_policy,
+                               std::memory_order_relaxed);
   }
 
+  TPN_INLINE const IoPoolOptions &GetOptions() const { return this->options_; }
+
  private:
   /// 检查当前线程是否在对象池中
   ///  @return 线程是否在对象池中
@@ -155,7 +315,51 @@ class IoPool::IoPoolImpl {
     return false;
   }
 
+  /// 获取io线程绑定的cpu列表
+  ///  @return cpu列表，不绑定时为空
+  TPN_INLINE std::vector<int> GetAffinityCpus() const {
+    if (!this->options_.cpu_affinity) {
+      return {};
+    }
+
+    if (!this->options_.cpus.empty()) {
+      return this->options_.cpus;
+    }
+
+    std::vector<int> cpus;
+    if (this->options_.numa_aware) {
+      cpus = GetNumaInterleavedCpus();
+    }
+    if (cpus.empty()) {
+      cpus.resize((std::max)(std::thread::hardware_concurrency(), 1u));
+      for (size_t i = 0; i < cpus.size(); ++i) {
+        cpus[i] = static_cast<int>(i);
+      }
+    }
+    return cpus;
+  }
+
+  /// 把线程绑定到cpu
+  ///  @param[in]   thread    线程
+  ///  @param[in]   cpu       cpu编号
+  static void PinThread(std::thread &thread, int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (int err =
+            pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set)) {
+      NET_WARN("io pool pin thread to cpu {} error {}", cpu, err);
+    }
+#else
+    std::ignore = thread;
+    std::ignore = cpu;
+#endif
+  }
+
   /// 确保asio::post(...)事件被调用
+  /// 先等第一个io线程结束，其上的停止流程可能还会向其他io句柄投递事件，
+  /// 再让其他io线程结束，用join等待，不再轮询io_context是否停止
   TPN_INLINE void WaitIoThreads() {
     {
       NET_DEBUG("io pool wait io threads");
@@ -171,22 +375,9 @@ class IoPool::IoPoolImpl {
       }
     }
 
-    constexpr auto max = MilliSeconds(10);
-    constexpr auto min = MilliSeconds(1);
-
-    if (!this->ios_.empty()) {
-      auto t1          = SteadyClock::now();
-      auto &io_context = this->ios_.front().GetIoContext();
-      while (!io_context.stopped()) {
-        NET_DEBUG("wait io context to stop");
-        auto t2 = SteadyClock::now();
-        std::this_thread::sleep_for((
-            std::max<SteadyClock::duration>)((std::min<
-                                                 SteadyClock::duration>)(t2 -
-                                                                             t1,
-                                                                         max),
-                                             min));
-      }
+    if (!this->threads_.empty() && this->threads_.front().joinable()) {
+      NET_DEBUG("wait io context to stop");
+      this->threads_.front().join();
       NET_DEBUG("wait io context to stoped");
     }
 
@@ -198,20 +389,12 @@ class IoPool::IoPoolImpl {
       }
     }
 
-    for (size_t i = 1; i < this->ios_.size(); ++i) {
-      auto t1          = SteadyClock::now();
-      auto &io_context = this->ios_[i].GetIoContext();
-      while (!io_context.stopped()) {
+    for (size_t i = 1; i < this->threads_.size(); ++i) {
+      if (this->threads_[i].joinable()) {
         NET_DEBUG("wait io context to stop ios_ index {}", i);
-        auto t2 = SteadyClock::now();
-        std::this_thread::sleep_for((
-            std::max<SteadyClock::duration>)((std::min<
-                                                 SteadyClock::duration>)(t2 -
-                                                                             t1,
-                                                                         max),
-                                             min));
+        this->threads_[i].join();
+        NET_DEBUG("wait io context to stoped ios_ index {}", i);
       }
-      NET_DEBUG("wait io context to stoped ios_ index {}", i);
     }
   }
 
@@ -220,7 +403,11 @@ class IoPool::IoPoolImpl {
   std::vector<IoHandle> ios_;         ///< io_context对象池
   std::mutex mutex_;
   bool stopped_{true};  ///< io_context对象池是否停止标志
-  size_t next_{0};  ///< 下一个可用的io_context对象池ios_中的下标
+  std::atomic<size_t> next_{0};  ///< 下一个可用的io_context对象池ios_中的下标
+  IoPoolOptions options_;        ///< io对象池选项
+  /// io句柄选择策略 选择io句柄时不加锁读取
+  std::atomic<IoSelectPolicy> select_policy_{
+      IoSelectPolicy::kIoSelectPolicyRoundRobin};
   std::vector<asio::executor_work_guard<asio::io_context::executor_type>>
       workers_;  ///< 执行io_context的工作线程 他们的run函数不会停止
 };
@@ -251,6 +438,16 @@ IoHandle &IoPool::GetIoHandleByIndex(
   return this->io_pool_uptr_->GetIoHandleByIndex(index);
 }
 
+size_t IoPool::GetIoPoolSize() const { return this->io_pool_uptr_->GetSize(); }
+
+void IoPool::SetIoPoolOptions(const IoPoolOptions &options) {
+  this->io_pool_uptr_->SetOptions(options);
+}
+
+const IoPoolOptions &IoPool::GetIoPoolOptions() const {
+  return this->io_pool_uptr_->GetOptions();
+}
+
 }  // namespace net
 
 }  // namespace tpn
@@ -23,27 +23,125 @@
 #ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_IO_POOL_H_
 #define TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_IO_POOL_H_
 
+#include <atomic>
 #include <memory>
+#include <vector>
 
+#include "chrono_wrap.h"
 #include "net_common.h"
+#include "session_pool.h"
+#include "idle_reaper.h"
+#include "timer_wheel.h"
 
 namespace tpn {
 
 namespace net {
 
+/// io句柄选择策略
+enum class IoSelectPolicy : uint8_t {
+  /// 轮询
+  kIoSelectPolicyRoundRobin = 0,
+  /// 遍历所有io句柄取负载最小的
+  kIoSelectPolicyLeastLoaded,
+  /// 随机取两个io句柄，选负载小的
+  kIoSelectPolicyPowerOfTwo,
+};
+
+/// io对象池选项，需要在启动前设置
+struct IoPoolOptions {
+  /// io句柄选择策略
+  IoSelectPolicy select_policy{IoSelectPolicy::kIoSelectPolicyRoundRobin};
+  /// 是否把io线程绑定到cpu，只对linux有效
+  bool cpu_affinity{false};
+  /// 绑定的cpu列表，第i个io线程绑定到cpus[i % cpus.size()]，
+  /// 为空时按cpu编号顺序绑定
+  std::vector<int> cpus;
+  /// cpus为空时，按numa节点交错排列cpu，使相邻的io线程分布到不同节点
+  bool numa_aware{false};
+};
+
+/// io句柄负载计数
+/// 由会话在所在io线程上更新，选择io句柄时在其他线程读取，只需要relaxed的原子操作
+class TPN_NET_API IoLoad {
+ public:
+  IoLoad()  = default;
+  ~IoLoad() = default;
+
+  inline void AddSession() {
+    this->sessions_.fetch_add(1, std::memory_order_relaxed);
+  }
+  inline void RemoveSession() {
+    this->sessions_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  inline void AddBytes(size_t bytes) {
+    this->bytes_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+  inline void AddPending(size_t count = 1) {
+    this->pending_.fetch_add(count, std::memory_order_relaxed);
+  }
+  inline void RemovePending(size_t count = 1) {
+    this->pending_.fetch_sub(count, std::memory_order_relaxed);
+  }
+
+  /// 获取会话数
+  inline size_t GetSessions() const {
+    return this->sessions_.load(std::memory_order_relaxed);
+  }
+
+  /// 获取收发字节总数
+  inline uint64_t GetBytes() const {
+    return this->bytes_.load(std::memory_order_relaxed);
+  }
+
+  /// 获取会话事件队列中排队的事件数
+  inline size_t GetPending() const {
+    return this->pending_.load(std::memory_order_relaxed);
+  }
+
+  /// 获取负载评分
+  /// 会话数 + 排队事件数 + 最近一个采样间隔的流量折合的会话数，
+  /// 距上次采样超过 kIoLoadSampleInterval 时重新采样
+  ///  @return 负载评分
+  size_t GetScore();
+
+ private:
+  std::atomic<size_t> sessions_{0};                ///< 会话数
+  std::atomic<size_t> pending_{0};                 ///< 排队事件数
+  std::atomic<uint64_t> bytes_{0};                 ///< 收发字节总数
+  std::atomic<uint64_t> sample_bytes_{0};          ///< 上次采样时的字节总数
+  std::atomic<uint64_t> sample_rate_{0};           ///< 上个采样间隔的字节数
+  std::atomic<SteadyClock::rep> sample_time_{0};  ///< 上次采样时间
+};
+
 /// asio操作句柄，用来封装asio上下文与线程串行保护
 /// 使用一个context绑定一个strand方式封装成io句柄
 class TPN_NET_API IoHandle {
  public:
-  IoHandle() : context_(1), strand_(context_) {}
+  IoHandle()
+      : context_(1),
+        strand_(context_),
+        load_(),
+        session_pool_(std::make_shared<SessionPool>()),
+        idle_reaper_(strand_),
+        timer_wheel_(strand_) {}
   ~IoHandle() = default;
 
   inline asio::io_context &GetIoContext() { return this->context_; }
   inline asio::io_context::strand &GetStrand() { return this->strand_; }
+  inline const std::shared_ptr<SessionPool> &GetSessionPool() {
+    return this->session_pool_;
+  }
+  inline IdleReaper &GetIdleReaper() { return this->idle_reaper_; }
+  inline TimerWheel &GetTimerWheel() { return this->timer_wheel_; }
+  inline IoLoad &GetLoad() { return this->load_; }
 
  private:
   asio::io_context context_;         ///< asio::io_context
   asio::io_context::strand strand_;  ///< asio::io_context::strand
+  IoLoad load_;  ///< 负载计数，会话析构时会更新，要在持有会话的成员之前声明
+  std::shared_ptr<SessionPool> session_pool_;  ///< 会话内存池
+  IdleReaper idle_reaper_;  ///< 空闲回收器，会话释放会用到内存池和负载计数
+  TimerWheel timer_wheel_;  ///< 延迟任务时间轮，同样要在内存池和负载计数之后声明
 };
 
 /// io_context对象池
@@ -78,10 +176,22 @@ class TPN_NET_API IoPool {
   bool IsIoPoolStopped() const;
 
   /// 获取一个可用的io_context对象
-  ///  @param[in]   index     指定编号，默认取下一个可用的
+  ///  @param[in]   index     指定编号，默认按选择策略取下一个可用的
   ///  @return 可用的io_context对象
   IoHandle &GetIoHandleByIndex(size_t index = static_cast<size_t>(-1));
 
+  /// 获取io_context对象池的大小
+  ///  @return 对象池中io_context对象的数量
+  size_t GetIoPoolSize() const;
+
+  /// 设置io对象池选项，需要在启动前设置
+  ///  @param[in]   options   io对象池选项
+  void SetIoPoolOptions(const IoPoolOptions &options);
+
+  /// 获取io对象池选项
+  ///  @return io对象池选项
+  const IoPoolOptions &GetIoPoolOptions() const;
+
  private:
   class IoPoolImpl;
   std::unique_ptr<IoPoolImpl> io_pool_uptr_;  ///< io_context 对象池
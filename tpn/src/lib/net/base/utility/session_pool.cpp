@@ -0,0 +1,98 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "session_pool.h"
+
+#include <new>
+#include <bit>
+
+namespace tpn {
+
+namespace net {
+
+SessionPool::~SessionPool() {
+  for (auto slab : this->slabs_) {
+    ::operator delete(slab);
+  }
+}
+
+void *SessionPool::Allocate(size_t size) {
+  size_t index = GetClassIndex(size);
+  if (kClassCount <= index) {
+    return ::operator new(size);
+  }
+
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  if (nullptr == this->free_[index]) {
+    Refill(index);
+  }
+
+  FreeNode *node     = this->free_[index];
+  this->free_[index] = node->next;
+  return node;
+}
+
+void SessionPool::Deallocate(void *pointer, size_t size) {
+  if (nullptr == pointer) {
+    return;
+  }
+
+  size_t index = GetClassIndex(size);
+  if (kClassCount <= index) {
+    return ::operator delete(pointer);
+  }
+
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  FreeNode *node     = static_cast<FreeNode *>(pointer);
+  node->next         = this->free_[index];
+  this->free_[index] = node;
+}
+
+size_t SessionPool::GetReservedSize() {
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  return this->slabs_.size() * kSessionPoolSlabSize;
+}
+
+size_t SessionPool::GetClassIndex(size_t size) {
+  if (size <= (size_t(1) << kSessionPoolMinBlockShift)) {
+    return 0;
+  }
+  return std::bit_width(size - 1) - kSessionPoolMinBlockShift;
+}
+
+void SessionPool::Refill(size_t index) {
+  size_t block_size = size_t(1) << (index + kSessionPoolMinBlockShift);
+  auto *slab = static_cast<std::byte *>(::operator new(kSessionPoolSlabSize));
+  this->slabs_.emplace_back(slab);
+
+  // 倒序串入链表，使申请顺序与地址顺序一致
+  for (size_t offset = kSessionPoolSlabSize; offset >= block_size;) {
+    offset -= block_size;
+    FreeNode *node     = reinterpret_cast<FreeNode *>(slab + offset);
+    node->next         = this->free_[index];
+    this->free_[index] = node;
+  }
+}
+
+}  // namespace net
+
+}  // namespace tpn
@@ -0,0 +1,160 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_SESSION_POOL_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_SESSION_POOL_H_
+
+#include <array>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+#include "define.h"
+
+namespace tpn {
+
+namespace net {
+
+/// 会话内存池最小块大小 64B
+static constexpr size_t kSessionPoolMinBlockShift = 6;
+/// 会话内存池最大块大小 64KB，更大的申请直接交给全局堆
+static constexpr size_t kSessionPoolMaxBlockShift = 16;
+/// 会话内存池每次向全局堆申请的整片大小 256KB
+static constexpr size_t kSessionPoolSlabSize = 256 * 1024;
+
+/// 会话内存池
+/// 按2的幂分级的定长块空闲链表，块从整片slab中切分，
+/// 归还后回到空闲链表，直到内存池析构才交还全局堆。
+/// 每个IoHandle持有一个，会话对象及其缓冲区、事件队列从所属io线程的内存池申请，
+/// 断线重连时直接复用上一个会话归还的块，避免大量建连时全局堆的竞争。
+/// 申请一般在接受器线程，归还一般在会话所属io线程，使用互斥锁保护。
+class TPN_NET_API SessionPool {
+ public:
+  SessionPool() = default;
+  ~SessionPool();
+
+  /// 申请内存
+  ///  @param[in]   size      申请大小
+  ///  @return 内存地址
+  void *Allocate(size_t size);
+
+  /// 归还内存
+  ///  @param[in]   pointer   内存地址
+  ///  @param[in]   size      申请时的大小
+  void Deallocate(void *pointer, size_t size);
+
+  /// 获取已向全局堆申请的slab总大小
+  ///  @return slab总大小
+  size_t GetReservedSize();
+
+ private:
+  /// 空闲块链表节点
+  struct FreeNode {
+    FreeNode *next;
+  };
+
+  static constexpr size_t kClassCount =
+      kSessionPoolMaxBlockShift - kSessionPoolMinBlockShift + 1;
+
+  /// 获取申请大小对应的分级
+  ///  @param[in]   size      申请大小
+  ///  @return 分级下标，超出最大分级返回kClassCount
+  static size_t GetClassIndex(size_t size);
+
+  /// 为指定分级切分一片新的slab
+  ///  @param[in]   index     分级下标
+  void Refill(size_t index);
+
+ private:
+  std::mutex mutex_;                             ///< 互斥锁
+  std::array<FreeNode *, kClassCount> free_{};  ///< 各分级空闲块链表
+  std::vector<void *> slabs_;                    ///< 已申请的slab
+
+  TPN_NO_COPYABLE(SessionPool)
+};
+
+/// 会话内存池分配器
+/// 满足标准库分配器要求，可用于std::allocate_shared与容器。
+/// 分配器持有内存池的引用计数，已分配的内存归还前内存池不会析构。
+/// 未绑定内存池时退化为全局堆分配。
+///  @tparam  T     分配类型
+template <typename T>
+class SessionPoolAllocator {
+ public:
+  using value_type = T;
+
+  SessionPoolAllocator() noexcept = default;
+
+  /// 构造函数
+  ///  @param[in]   pool      会话内存池
+  explicit SessionPoolAllocator(std::shared_ptr<SessionPool> pool) noexcept
+      : pool_(std::move(pool)) {}
+
+  template <typename U>
+  SessionPoolAllocator(const SessionPoolAllocator<U> &other) noexcept
+      : pool_(other.pool_) {}
+
+  inline T *allocate(size_t n) {
+    if (UsePool()) {
+      return static_cast<T *>(this->pool_->Allocate(sizeof(T) * n));
+    }
+    return static_cast<T *>(::operator new(sizeof(T) * n));
+  }
+
+  inline void deallocate(T *p, size_t n) {
+    if (UsePool()) {
+      return this->pool_->Deallocate(p, sizeof(T) * n);
+    }
+    ::operator delete(p);
+  }
+
+  template <typename U>
+  inline bool operator==(const SessionPoolAllocator<U> &other) const noexcept {
+    return this->pool_ == other.pool_;
+  }
+
+  template <typename U>
+  inline bool operator!=(const SessionPoolAllocator<U> &other) const noexcept {
+    return !(*this == other);
+  }
+
+ private:
+  /// 是否使用内存池，内存池只保证std::max_align_t对齐
+  inline bool UsePool() const noexcept {
+    return nullptr != this->pool_ &&
+           alignof(T) <= alignof(std::max_align_t);
+  }
+
+ private:
+  template <typename>
+  friend class SessionPoolAllocator;
+
+  std::shared_ptr<SessionPool> pool_;  ///< 会话内存池
+};
+
+}  // namespace net
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_SESSION_POOL_H_
@@ -45,19 +45,21 @@ class AliveTime {
     return this->last_alive_time_;
   }
 
-  /// 更新存活时间
+  /// 更新存活时间，读取io句柄缓存的时间，精度为空闲回收器的扫描间隔
   ///  @return CRTP调用链对象
   TPN_INLINE Derived &UpdateAliveTime() {
-    this->last_alive_time_ = SystemClock::now();
+    this->last_alive_time_ =
+        CRTP_CAST(this).GetIoHandle().GetIdleReaper().GetNow();
     NET_DEBUG("update alive time");
     return (CRTP_CAST(this));
   }
 
   /// 获取静默时长
   ///  @return 静默时长
-  TPN_INLINE SystemClock::duration GetSilenceDuration() const {
+  TPN_INLINE SystemClock::duration GetSilenceDuration() {
     return std::chrono::duration_cast<SystemClock::duration>(
-        SystemClock::now() - this->last_alive_time_);
+        CRTP_CAST(this).GetIoHandle().GetIdleReaper().GetNow() -
+        this->last_alive_time_);
   }
 
  protected:
@@ -25,6 +25,7 @@
 
 #include "net_common.h"
 #include "chrono_wrap.h"
+#include "coarse_clock.h"
 
 namespace tpn {
 
@@ -47,7 +48,8 @@ class ConnectTime {
 
   /// 重置连接时间点
   TPN_INLINE Derived &ResetConnectTime() {
-    this->connect_time_ = SystemClock::now();
+    this->connect_time_ =
+        g_coarse_clock->SystemNow(CoarseClockUser::kCoarseClockUserNet);
     NET_DEBUG("reset connect time");
     return (CRTP_CAST(this));
   }
@@ -55,7 +57,8 @@ class ConnectTime {
   /// 获取连接时长
   TPN_INLINE SystemClock::duration GetConnectDuration() const {
     return std::chrono::duration_cast<SystemClock::duration>(
-        SystemClock::now() - this->connect_time_);
+        g_coarse_clock->SystemNow(CoarseClockUser::kCoarseClockUserNet) -
+        this->connect_time_);
   }
 
  protected:
@@ -0,0 +1,150 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "idle_reaper.h"
+
+#include <algorithm>
+
+namespace tpn {
+
+namespace net {
+
+IdleReaper::IdleReaper(asio::io_context::strand &strand,
+                       SteadyClock::duration tick)
+    : strand_(strand),
+      timer_(strand.context()),
+      tick_((std::max)(tick, SteadyClock::duration(MilliSeconds(1)))) {}
+
+IdleReaper::~IdleReaper() {
+  this->timer_.cancel(s_ec_ignore);
+
+  // 打破节点持有的循环引用
+  for (auto &slot : this->slots_) {
+    while (slot.IsLinked()) {
+      IdleNode &node = static_cast<IdleNode &>(*slot.next);
+      Detach(node);
+      node.holder.reset();
+    }
+  }
+}
+
+void IdleReaper::Link(IdleNode &node, SteadyClock::duration timeout) {
+  if (node.IsLinked()) {
+    Detach(node);
+    --this->size_;
+  }
+
+  if (!this->armed_.load(std::memory_order_relaxed)) {
+    this->Arm();
+  }
+
+  // 向上取整到刻度，超过一圈的先挂在最远的槽上，到期后按剩余时长重新登记
+  auto ticks = static_cast<uint64_t>((timeout + this->tick_ -
+                                      SteadyClock::duration(1)) /
+                                     this->tick_);
+  ticks = std::clamp<uint64_t>(ticks, 1, kIdleReaperSlots - 1);
+
+  Append(this->slots_[(this->current_ + ticks) % kIdleReaperSlots], node);
+  ++this->size_;
+}
+
+void IdleReaper::Unlink(IdleNode &node) {
+  if (node.IsLinked()) {
+    Detach(node);
+    --this->size_;
+  }
+
+  // 调用者可能正处在所属对象的成员函数中，不能在这里释放最后一个引用
+  if (node.holder) {
+    asio::post(this->strand_, [holder = std::move(node.holder)]() {});
+  }
+}
+
+void IdleReaper::Arm() {
+  this->now_.store(SystemClock::now().time_since_epoch().count(),
+                   std::memory_order_relaxed);
+  this->armed_.store(true, std::memory_order_relaxed);
+
+  this->timer_.expires_after(this->tick_);
+  this->timer_.async_wait(asio::bind_executor(
+      this->strand_,
+      [this](const std::error_code &ec) { this->HandleTick(ec); }));
+}
+
+void IdleReaper::HandleTick(const std::error_code &ec) {
+  if (asio::error::operation_aborted == ec) {
+    return;
+  }
+
+  this->now_.store(SystemClock::now().time_since_epoch().count(),
+                   std::memory_order_relaxed);
+
+  ++this->current_;
+
+  // 先把到期槽整体移到临时链表，回调中重新登记的节点不会在本刻度再次被处理
+  IdleLink pending;
+  IdleLink &slot = this->slots_[this->current_ % kIdleReaperSlots];
+  if (slot.IsLinked()) {
+    pending.next       = slot.next;
+    pending.prev       = slot.prev;
+    pending.next->prev = &pending;
+    pending.prev->next = &pending;
+    slot.next          = &slot;
+    slot.prev          = &slot;
+  }
+
+  while (pending.IsLinked()) {
+    IdleNode &node = static_cast<IdleNode &>(*pending.next);
+    Detach(node);
+    --this->size_;
+    node.expire(node);
+  }
+
+  if (0 == this->size_) {
+    this->armed_.store(false, std::memory_order_relaxed);
+    return;
+  }
+
+  // 按固定节拍推进，io线程繁忙时后续刻度会立即补上
+  this->timer_.expires_at(this->timer_.expiry() + this->tick_);
+  this->timer_.async_wait(asio::bind_executor(
+      this->strand_,
+      [this](const std::error_code &ec) { this->HandleTick(ec); }));
+}
+
+void IdleReaper::Detach(IdleLink &link) {
+  link.prev->next = link.next;
+  link.next->prev = link.prev;
+  link.prev       = &link;
+  link.next       = &link;
+}
+
+void IdleReaper::Append(IdleLink &head, IdleLink &link) {
+  link.prev       = head.prev;
+  link.next       = &head;
+  head.prev->next = &link;
+  head.prev       = &link;
+}
+
+}  // namespace net
+
+}  // namespace tpn
@@ -0,0 +1,142 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_TIMER_IDLE_REAPER_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_TIMER_IDLE_REAPER_H_
+
+#include <array>
+#include <atomic>
+#include <memory>
+
+#include "chrono_wrap.h"
+#include "coarse_clock.h"
+#include "net_common.h"
+
+namespace tpn {
+
+namespace net {
+
+/// 空闲回收器时间轮槽数，扫描间隔1秒时约17分钟一圈
+static constexpr size_t kIdleReaperSlots = 1024;
+
+/// 空闲回收链表指针
+struct IdleLink {
+  IdleLink *prev{this};  ///< 前一个节点
+  IdleLink *next{this};  ///< 后一个节点
+
+  IdleLink() = default;
+
+  /// 是否已经在链表中
+  TPN_INLINE bool IsLinked() const { return this->next != this; }
+
+  TPN_NO_COPYABLE(IdleLink)
+};
+
+/// 空闲回收节点，嵌入在需要静默检测的对象中，登记和摘除都不申请内存
+struct IdleNode : public IdleLink {
+  /// 到期回调，调用时节点已经从回收器中摘除
+  using ExpireFunc = void (*)(IdleNode &node);
+
+  void *owner{nullptr};           ///< 节点所属对象
+  ExpireFunc expire{nullptr};     ///< 到期回调
+  std::shared_ptr<void> holder;   ///< 登记期间延长所属对象的生命周期
+};
+
+/// 空闲回收器
+/// 每个IoHandle持有一个，替代每个会话各自的静默定时器。
+/// 节点按到期刻度挂在时间轮的槽上，回收器只用一个定时器每个刻度扫描一个槽，
+/// 到期的节点交给回调自行判断是否真的超时，未超时的按剩余时长重新登记。
+/// 同时缓存一个每刻度刷新一次的当前时间，收包时读取缓存而不是系统时钟。
+/// 除 GetNow 外只能在所属io线程中调用。
+class TPN_NET_API IdleReaper {
+ public:
+  /// 构造函数
+  ///  @param[in]   strand    回收器所在的strand
+  ///  @param[in]   tick      扫描间隔
+  explicit IdleReaper(
+      asio::io_context::strand &strand,
+      SteadyClock::duration tick = MilliSeconds(kIdleReaperTick));
+
+  /// 析构函数，释放所有仍在登记中的对象
+  ~IdleReaper();
+
+  /// 获取缓存的当前时间
+  /// 有节点登记时每个刻度刷新一次，没有节点登记时直接读取系统时钟，
+  /// 网络层开启了粗粒度时钟时改为读取粗粒度时钟，精度为毫秒
+  ///  @return 当前时间
+  TPN_INLINE SystemClock::time_point GetNow() const {
+    if (g_coarse_clock->IsEnabled(CoarseClockUser::kCoarseClockUserNet) ||
+        !this->armed_.load(std::memory_order_relaxed)) {
+      return g_coarse_clock->SystemNow(CoarseClockUser::kCoarseClockUserNet);
+    }
+    return SystemClock::time_point(
+        SystemClock::duration(this->now_.load(std::memory_order_relaxed)));
+  }
+
+  /// 登记节点，至少经过timeout后调用一次到期回调，已经登记的节点重新登记
+  ///  @param[in]   node      节点
+  ///  @param[in]   timeout   超时时长
+  void Link(IdleNode &node, SteadyClock::duration timeout);
+
+  /// 摘除节点，节点持有的对象投递到strand中释放
+  ///  @param[in]   node      节点
+  void Unlink(IdleNode &node);
+
+  /// 获取登记中的节点数
+  ///  @return 节点数
+  TPN_INLINE size_t GetSize() const { return this->size_; }
+
+ private:
+  /// 启动扫描定时器
+  void Arm();
+
+  /// 处理一个刻度
+  ///  @param[in]   ec        错误码
+  void HandleTick(const std::error_code &ec);
+
+  /// 把节点从所在链表中摘除
+  ///  @param[in]   link      节点
+  static void Detach(IdleLink &link);
+
+  /// 把节点挂到链表尾部
+  ///  @param[in]   head      链表头
+  ///  @param[in]   link      节点
+  static void Append(IdleLink &head, IdleLink &link);
+
+ private:
+  asio::io_context::strand &strand_;                ///< 所在strand
+  asio::steady_timer timer_;                        ///< 扫描定时器
+  SteadyClock::duration tick_;                      ///< 扫描间隔
+  std::array<IdleLink, kIdleReaperSlots> slots_;    ///< 时间轮
+  uint64_t current_{0};                             ///< 已扫描的刻度
+  size_t size_{0};                                  ///< 登记中的节点数
+  std::atomic<bool> armed_{false};                  ///< 扫描定时器是否在运行
+  std::atomic<SystemClock::rep> now_{0};            ///< 缓存的当前时间
+
+  TPN_NO_COPYABLE(IdleReaper)
+};
+
+}  // namespace net
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_TIMER_IDLE_REAPER_H_
@@ -23,28 +23,31 @@
 #ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_TIMER_SILENCE_TIMER_H_
 #define TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_TIMER_SILENCE_TIMER_H_
 
-#include <atomic>
 #include <memory>
 
 #include "chrono_wrap.h"
 #include "net_common.h"
 #include "io_pool.h"
+#include "idle_reaper.h"
 
 namespace tpn {
 
 namespace net {
 
 /// 静默定时器 收包间隔
+/// 会话不再各自持有asio定时器，统一登记到所属IoHandle的空闲回收器，
+/// 回收器每个刻度扫描一次，到期后仍按静默时长判断是否断开。
 ///  @tparam  Derived
 ///  @tparam  ArgsType
 template <typename Derived, typename ArgsType = void>
 class SilenceTimer {
  public:
   /// 构造函数
-  ///  @param[in]  io_handle    timer执行的io句柄
+  ///  @param[in]  io_handle    登记的io句柄
   explicit SilenceTimer(IoHandle &io_handle)
-      : silence_timer_(io_handle.GetIoContext()) {
-    this->silence_timer_canceled_.clear();
+      : idle_reaper_(io_handle.GetIdleReaper()) {
+    this->silence_node_.owner  = this;
+    this->silence_node_.expire = &SilenceTimer::HandleIdleExpire;
   }
 
   ~SilenceTimer() = default;
@@ -83,17 +86,12 @@ class SilenceTimer {
     NET_DEBUG("SilenceTimer PostSilenceTimer session {} duration {}",
               derive.GetHashKey(), duration);
 
-    // 启动检查静音超时计时器
+    // 登记到空闲回收器，登记期间持有会话
     if (duration > MilliSeconds(0)) {
-      this->silence_timer_.expires_after(duration);
-      this->silence_timer_.async_wait(asio::bind_executor(
-          derive.GetIoHandle().GetStrand(),
-          [&derive, self_ptr = std::move(this_ptr)](const std::error_code &ec) {
-            NET_DEBUG(
-                "SilenceTimer PostSilenceTimer session {} HandleSilenceTimer",
-                derive.GetHashKey());
-            derive.HandleSilenceTimer(ec, std::move(self_ptr));
-          }));
+      this->silence_node_.holder = std::move(this_ptr);
+      this->idle_reaper_.Link(
+          this->silence_node_,
+          std::chrono::duration_cast<SteadyClock::duration>(duration));
     }
   }
 
@@ -107,15 +105,12 @@ class SilenceTimer {
     NET_DEBUG("SilenceTimer HandleSilenceTimer session {} error {}",
               this_ptr->GetHashKey(), ec);
 
-    if (asio::error::operation_aborted == ec ||
-        this->silence_timer_canceled_.test_and_set()) {
+    if (asio::error::operation_aborted == ec) {
       NET_WARN("SilenceTimer HandleSilenceTimer error {} or canceled", ec);
       return;
     }
 
-    this->silence_timer_canceled_.clear();
-
-    // 静默持续时间秒数不超过静默超时时间，请重新启动计时器事件，以避免此会话shared_ptr对象消失。
+    // 静默持续时间秒数不超过静默超时时间，重新登记，以避免此会话shared_ptr对象消失。
     if (derive.GetSilenceDuration() < this->silence_timeout_) {
       NET_DEBUG(
           "SilenceTimer HandleSilenceTimer session {} PostSilenceTimer again",
@@ -124,7 +119,7 @@ class SilenceTimer {
           this->silence_timeout_ - derive.GetSilenceDuration(),
           std::move(this_ptr));
     } else {
-      // 沉默超时已经消除，但是没有数据传输，不再发布计时器事件，因此在此会话中，
+      // 沉默超时已经消除，但是没有数据传输，不再登记，因此在此会话中，
       // shared_ptr将消失，并且此处理程序返回后，对象将被自动销毁。
       NET_DEBUG(
           "SilenceTimer HandleSilenceTimer session {} timeout, so DoDisconnect",
@@ -137,13 +132,23 @@ class SilenceTimer {
   /// 停止静默定时器
   TPN_INLINE void StopSilenceTimer() {
     NET_DEBUG("SilenceTimer StopSilenceTimer");
-    this->silence_timer_canceled_.test_and_set();
-    this->silence_timer_.cancel(s_ec_ignore);
+    this->idle_reaper_.Unlink(this->silence_node_);
+  }
+
+ private:
+  /// 空闲回收器到期回调
+  ///  @param[in]   node        登记的节点
+  static void HandleIdleExpire(IdleNode &node) {
+    Derived &derive = static_cast<Derived &>(
+        *static_cast<SilenceTimer *>(node.owner));
+    derive.HandleSilenceTimer(
+        std::error_code{},
+        std::static_pointer_cast<Derived>(std::move(node.holder)));
   }
 
  protected:
-  asio::steady_timer silence_timer_;                    ///<  静默定时器
-  std::atomic_flag silence_timer_canceled_;             ///<  取消标志
+  IdleReaper &idle_reaper_;                             ///<  空闲回收器
+  IdleNode silence_node_;                               ///<  回收器节点
   SteadyClock::duration silence_timeout_{Minutes(60)};  ///<  超时时间
 };
 
@@ -0,0 +1,162 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "timer_wheel.h"
+
+#include <algorithm>
+
+#include "coarse_clock.h"
+
+namespace tpn {
+
+namespace net {
+
+TimerWheel::TimerWheel(asio::io_context::strand &strand,
+                       SteadyClock::duration tick)
+    : strand_(strand),
+      timer_(strand.context()),
+      tick_((std::max)(tick, SteadyClock::duration(MilliSeconds(1)))) {}
+
+TimerWheel::~TimerWheel() {
+  this->timer_.cancel(s_ec_ignore);
+
+  for (auto &slot : this->slots_) {
+    while (LinkedListElement *elem_ptr = slot.GetFirst()) {
+      TimerWheelTask *task = TimerWheelTask::FromWheel(elem_ptr);
+      task->wheel_elem.Delink();
+      task->owner_elem.Delink();
+      task->invoke(task, false);
+    }
+  }
+}
+
+void TimerWheel::Add(TimerWheelTaskPtr task, SteadyClock::duration delay,
+                     LinkedListHead &owner) {
+  auto now = g_coarse_clock->SteadyNow(CoarseClockUser::kCoarseClockUserNet);
+  if (!this->armed_) {
+    this->base_time_ = now;
+    this->base_tick_ = this->current_;
+  }
+
+  // 到期时间向上取整到刻度，至少推迟到下一个刻度
+  auto due = now + (std::max)(delay, SteadyClock::duration::zero()) +
+             this->tick_ - SteadyClock::duration(1);
+  TimerWheelTask *task_ptr = task.release();
+  task_ptr->expire_tick    = (std::max)(this->ToTick(due), this->current_ + 1);
+
+  this->slots_[task_ptr->expire_tick % kTimerWheelSlots].InsertLast(
+      &task_ptr->wheel_elem);
+  owner.InsertLast(&task_ptr->owner_elem);
+  ++this->size_;
+
+  if (!this->armed_) {
+    this->Arm();
+  }
+}
+
+size_t TimerWheel::Flush(LinkedListHead &owner) {
+  // 先整体摘下，执行期间重新登记的任务留在所属对象链表上
+  LinkedListHead flushed;
+  while (LinkedListElement *elem_ptr = owner.GetFirst()) {
+    TimerWheelTask *task = TimerWheelTask::FromOwner(elem_ptr);
+    task->owner_elem.Delink();
+    task->wheel_elem.Delink();
+    flushed.InsertLast(&task->wheel_elem);
+    --this->size_;
+  }
+
+  return Run(flushed);
+}
+
+void TimerWheel::Arm() {
+  this->armed_ = true;
+
+  this->timer_.expires_at(this->base_time_ + this->tick_);
+  this->timer_.async_wait(asio::bind_executor(
+      this->strand_,
+      [this](const std::error_code &ec) { this->HandleTick(ec); }));
+}
+
+void TimerWheel::HandleTick(const std::error_code &ec) {
+  if (asio::error::operation_aborted == ec) {
+    return;
+  }
+
+  // io线程繁忙时一次补上所有落后的刻度，到期任务整批执行
+  uint64_t target = this->ToTick(SteadyClock::now());
+  LinkedListHead expired;
+  while (this->current_ < target) {
+    ++this->current_;
+    this->Collect(this->slots_[this->current_ % kTimerWheelSlots], expired);
+  }
+
+  Run(expired);
+
+  if (0 == this->size_) {
+    this->armed_ = false;
+    return;
+  }
+
+  this->timer_.expires_at(this->base_time_ +
+                          (this->current_ - this->base_tick_ + 1) * this->tick_);
+  this->timer_.async_wait(asio::bind_executor(
+      this->strand_,
+      [this](const std::error_code &ec) { this->HandleTick(ec); }));
+}
+
+void TimerWheel::Collect(LinkedListHead &slot, LinkedListHead &expired) {
+  LinkedListElement *elem_ptr = slot.GetFirst();
+  while (elem_ptr) {
+    LinkedListElement *next_ptr = elem_ptr->GetNext();
+    TimerWheelTask *task        = TimerWheelTask::FromWheel(elem_ptr);
+    if (task->expire_tick <= this->current_) {
+      task->wheel_elem.Delink();
+      task->owner_elem.Delink();
+      expired.InsertLast(&task->wheel_elem);
+      --this->size_;
+    }
+    elem_ptr = next_ptr;
+  }
+}
+
+size_t TimerWheel::Run(LinkedListHead &tasks) {
+  size_t count = 0;
+  while (LinkedListElement *elem_ptr = tasks.GetFirst()) {
+    TimerWheelTask *task = TimerWheelTask::FromWheel(elem_ptr);
+    task->wheel_elem.Delink();
+    task->invoke(task, true);
+    ++count;
+  }
+  return count;
+}
+
+uint64_t TimerWheel::ToTick(SteadyClock::time_point tp) const {
+  if (tp <= this->base_time_) {
+    return this->base_tick_;
+  }
+  return this->base_tick_ +
+         static_cast<uint64_t>((tp - this->base_time_) / this->tick_);
+}
+
+}  // namespace net
+
+}  // namespace tpn
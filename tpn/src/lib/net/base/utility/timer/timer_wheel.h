@@ -0,0 +1,187 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_TIMER_TIMER_WHEEL_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_TIMER_TIMER_WHEEL_H_
+
+#include <array>
+#include <memory>
+
+#include "buffer_pool.h"
+#include "chrono_wrap.h"
+#include "linked_list.h"
+#include "net_common.h"
+
+namespace tpn {
+
+namespace net {
+
+/// 延迟任务时间轮槽数，刻度10毫秒时约5秒一圈，更长的延迟按圈数留在槽上
+static constexpr size_t kTimerWheelSlots = 512;
+
+/// 时间轮任务节点
+/// 同时挂在时间轮的槽上和所属对象的任务链表上，登记和摘除都不申请内存
+struct TimerWheelTask {
+  /// 执行或丢弃任务，调用时节点已经从两个链表中摘除，调用后节点被释放
+  using InvokeFunc = void (*)(TimerWheelTask *task, bool run);
+
+  LinkedListElement wheel_elem;   ///< 时间轮槽链表节点
+  LinkedListElement owner_elem;   ///< 所属对象任务链表节点
+  uint64_t expire_tick{0};        ///< 到期刻度
+  InvokeFunc invoke{nullptr};     ///< 执行函数
+  std::shared_ptr<void> holder;   ///< 登记期间延长所属对象的生命周期
+
+  /// 从时间轮槽链表节点获取任务
+  static TimerWheelTask *FromWheel(LinkedListElement *elem_ptr) {
+    return TPN_CONTAINER_OF(elem_ptr, TimerWheelTask, wheel_elem);
+  }
+
+  /// 从所属对象任务链表节点获取任务
+  static TimerWheelTask *FromOwner(LinkedListElement *elem_ptr) {
+    return TPN_CONTAINER_OF(elem_ptr, TimerWheelTask, owner_elem);
+  }
+};
+
+/// 携带任务函数的时间轮任务
+/// 节点从缓冲池的线程缓存申请，登记延迟任务不走全局堆
+///  @tparam  Func    任务函数类型
+template <typename Func>
+struct TimerWheelTaskImpl : public TimerWheelTask {
+  Func func;  ///< 任务函数
+
+  template <typename F>
+  explicit TimerWheelTaskImpl(F &&f) : func(std::forward<F>(f)) {
+    this->invoke = &TimerWheelTaskImpl::Invoke;
+  }
+
+  static void *operator new(size_t size) {
+    return BufferPool::AllocateObject(size);
+  }
+
+  static void operator delete(void *pointer, size_t size) {
+    BufferPool::DeallocateObject(pointer, size);
+  }
+
+  static void Invoke(TimerWheelTask *task, bool run) {
+    std::unique_ptr<TimerWheelTaskImpl> impl(
+        static_cast<TimerWheelTaskImpl *>(task));
+    if (run) {
+      impl->func();
+    }
+  }
+};
+
+/// 时间轮任务删除器，任务没有登记就被释放时丢弃任务
+struct TimerWheelTaskDeleter {
+  void operator()(TimerWheelTask *task) const { task->invoke(task, false); }
+};
+
+using TimerWheelTaskPtr = std::unique_ptr<TimerWheelTask, TimerWheelTaskDeleter>;
+
+/// 创建时间轮任务
+///  @tparam      Func      任务函数类型
+///  @param[in]   func      任务函数
+///  @param[in]   holder    登记期间需要保持存活的对象
+///  @return 任务
+template <typename Func>
+TPN_INLINE TimerWheelTaskPtr MakeTimerWheelTask(Func &&func,
+                                                std::shared_ptr<void> holder) {
+  auto *task = new TimerWheelTaskImpl<std::decay_t<Func>>(std::forward<Func>(func));
+  task->holder = std::move(holder);
+  return TimerWheelTaskPtr(task);
+}
+
+/// 延迟任务时间轮
+/// 每个IoHandle持有一个，替代每个延迟任务各自的asio定时器。
+/// 任务按到期刻度哈希到槽上，只用一个定时器在有任务时按刻度推进，
+/// 每个刻度把到期的任务整批摘下再依次执行。
+/// 所有接口只能在所属io线程中调用。
+class TPN_NET_API TimerWheel {
+ public:
+  /// 构造函数
+  ///  @param[in]   strand    时间轮所在的strand
+  ///  @param[in]   tick      刻度
+  explicit TimerWheel(
+      asio::io_context::strand &strand,
+      SteadyClock::duration tick = MilliSeconds(kTimerWheelTick));
+
+  /// 析构函数，丢弃所有未到期的任务
+  ~TimerWheel();
+
+  /// 登记任务，在延迟到期后的第一个刻度执行
+  ///  @param[in]   task      任务
+  ///  @param[in]   delay     延迟
+  ///  @param[in]   owner     所属对象任务链表
+  void Add(TimerWheelTaskPtr task, SteadyClock::duration delay,
+           LinkedListHead &owner);
+
+  /// 摘下所属对象的全部任务并依次执行，执行期间新登记的任务不受影响
+  ///  @param[in]   owner     所属对象任务链表
+  ///  @return 执行的任务数
+  size_t Flush(LinkedListHead &owner);
+
+  /// 获取登记中的任务数
+  ///  @return 任务数
+  TPN_INLINE size_t GetSize() const { return this->size_; }
+
+ private:
+  /// 启动刻度定时器
+  void Arm();
+
+  /// 处理到期的刻度
+  ///  @param[in]   ec        错误码
+  void HandleTick(const std::error_code &ec);
+
+  /// 摘下一个槽上到期的任务
+  ///  @param[in]   slot      槽
+  ///  @param[in]   expired   到期任务链表
+  void Collect(LinkedListHead &slot, LinkedListHead &expired);
+
+  /// 依次执行链表上的任务
+  ///  @param[in]   tasks     由时间轮节点组成的任务链表
+  ///  @return 执行的任务数
+  static size_t Run(LinkedListHead &tasks);
+
+  /// 获取时间点对应的刻度
+  ///  @param[in]   tp        时间点
+  ///  @return 刻度
+  uint64_t ToTick(SteadyClock::time_point tp) const;
+
+ private:
+  asio::io_context::strand &strand_;                      ///< 所在strand
+  asio::steady_timer timer_;                              ///< 刻度定时器
+  SteadyClock::duration tick_;                            ///< 刻度
+  std::array<LinkedListHead, kTimerWheelSlots> slots_;    ///< 时间轮
+  SteadyClock::time_point base_time_;                     ///< 启动定时器的时间
+  uint64_t base_tick_{0};                                 ///< 启动定时器时的刻度
+  uint64_t current_{0};                                   ///< 已处理的刻度
+  size_t size_{0};                                        ///< 登记中的任务数
+  bool armed_{false};                                     ///< 刻度定时器是否在运行
+
+  TPN_NO_COPYABLE(TimerWheel)
+};
+
+}  // namespace net
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_TIMER_TIMER_WHEEL_H_
@@ -0,0 +1,501 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_WRAPPER_COROUTINE_WRAP_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_WRAPPER_COROUTINE_WRAP_H_
+
+#include <memory>
+#include <utility>
+
+#include <google/protobuf/message.h>
+
+#include "byte_converter.h"
+#include "chrono_wrap.h"
+#include "message_buffer.h"
+#include "rpc_type.pb.h"
+#include "net_common.h"
+#include "awaitable.h"
+#include "event_ring.h"
+
+namespace tpn {
+
+namespace net {
+
+TPN_NET_FORWARD_DECL_BASE_CLASS
+
+/// 等待回应的RPC调用内部存放的个数
+static constexpr size_t kCoroutineCallInlineSize = 8;
+/// 等待协程取走的帧内部存放的个数
+static constexpr size_t kCoroutineFrameInlineSize = 2;
+
+/// 协程收到的帧
+struct RpcFrame {
+  protocol::Header header;  ///< 协议头
+  MessageBuffer packet;     ///< 协议体
+};
+
+/// 等待连接完成
+using ConnectOp = AwaitOp<>;
+/// 等待收到帧
+using RecvFrameOp = AwaitOp<RpcFrame>;
+
+/// 等待回应的RPC调用
+struct RpcCallOp : public AwaitOp<RpcFrame> {
+  uint32_t service_hash{0};          ///< 服务key
+  uint32_t method_id{0};             ///< 方法编号
+  SteadyClock::time_point deadline;  ///< 超时时间点
+  RpcCallOp *next{nullptr};          ///< 批量完成时的链表
+};
+
+/// 协程接口封装
+/// 连接、发送、收帧和RPC调用的异步版本，完成标记可以是回调，
+/// 也可以是 kUseAwaitable，在 IoExecutor 上的协程中 co_await。
+/// 操作在会话的strand上登记和完成，协程也运行在该strand上时完成不需要再次提交。
+///  @tparam  Derived
+///  @tparam  ArgsType
+template <typename Derived, typename ArgsType = void>
+class CoroutineWrap {
+  TPN_NET_FRIEND_DECL_BASE_CLASS
+
+ public:
+  using UseAwaitable = const asio::use_awaitable_t<IoExecutor> &;
+
+  CoroutineWrap() = default;
+
+  ~CoroutineWrap() {
+    this->CoroutineAbort(asio::error::operation_aborted, AwaitOpMode::kPost);
+  }
+
+  /// 获取协程执行器
+  ///  @return 会话所在io句柄的strand
+  TPN_INLINE IoExecutor GetIoExecutor() {
+    Derived &derive = CRTP_CAST(this);
+    return IoExecutor(derive.GetIoHandle().GetStrand());
+  }
+
+  /// 在会话所在的strand上启动协程
+  ///  @tparam      T           协程返回值类型
+  ///  @tparam      CompletionToken   完成标记类型
+  ///  @param[in]   awaitable   协程
+  ///  @param[in]   token       完成标记，默认不关心结果
+  template <typename T, typename CompletionToken = const asio::detached_t &>
+  TPN_INLINE auto CoSpawn(Awaitable<T> awaitable,
+                          CompletionToken &&token = asio::detached) {
+    return asio::co_spawn(this->GetIoExecutor(), std::move(awaitable),
+                          std::forward<CompletionToken>(token));
+  }
+
+  /// 异步连接，只用于客户端，完成签名 void(std::error_code)
+  ///  @tparam      String      字符串
+  ///  @tparam      StrOrInt    字符串或整数
+  ///  @tparam      CompletionToken   完成标记类型
+  ///  @param[in]   host        地址
+  ///  @param[in]   port        端口
+  ///  @param[in]   token       完成标记
+  template <typename String, typename StrOrInt,
+            typename CompletionToken = UseAwaitable>
+  TPN_INLINE auto AsyncConnect(String &&host, StrOrInt &&port,
+                               CompletionToken &&token = kUseAwaitable) {
+    static_assert(ArgsType::is_client, "AsyncConnect is for clients only");
+
+    return asio::async_initiate<CompletionToken, void(std::error_code)>(
+        [this](auto handler, std::decay_t<String> host,
+               std::decay_t<StrOrInt> port) {
+          using Handler = decltype(handler);
+
+          Derived &derive = CRTP_CAST(this);
+
+          ConnectOp *op = AwaitOpImpl<ConnectOp, Handler>::Create(
+              std::move(handler), this->GetIoExecutor());
+          if (this->connect_op_) {
+            op->Abort(AwaitOpMode::kPost, asio::error::already_started);
+            return;
+          }
+
+          // 启动前登记，连接完成时在客户端的strand上取走
+          this->connect_op_ = op;
+          if (!derive.AsyncStart(std::move(host), std::move(port))) {
+            std::error_code ec = GetLastError();
+            this->CoroutineConnect(ec ? ec : asio::error::not_connected);
+          }
+        },
+        token, std::forward<String>(host), std::forward<StrOrInt>(port));
+  }
+
+  /// 异步发送，完成签名 void(std::error_code, size_t)
+  ///  @tparam      CompletionToken   完成标记类型
+  ///  @param[in]   buffer      调用需要保证buffer满足底层拆包逻辑
+  ///  @param[in]   token       完成标记
+  template <typename CompletionToken = UseAwaitable>
+  TPN_INLINE auto AsyncSend(MessageBuffer &&buffer,
+                            CompletionToken &&token = kUseAwaitable) {
+    return asio::async_initiate<CompletionToken,
+                                void(std::error_code, size_t)>(
+        [this](auto handler, MessageBuffer &&buffer) {
+          using Handler = decltype(handler);
+
+          Derived &derive = CRTP_CAST(this);
+
+          SendOp *op = AwaitOpImpl<SendOp, Handler>::Create(
+              std::move(handler), this->GetIoExecutor());
+
+          // 操作随发送事件存放，写完、跳过或失败时完成
+          derive.SendAndComplete(std::move(buffer), op);
+        },
+        token, std::move(buffer));
+  }
+
+  /// 异步接收一帧，完成签名 void(std::error_code, RpcFrame)
+  /// 第一次调用后不再通知 FireRecv，之后没有回应匹配的帧都排队等待协程取走
+  ///  @tparam      CompletionToken   完成标记类型
+  ///  @param[in]   token       完成标记
+  template <typename CompletionToken = UseAwaitable>
+  TPN_INLINE auto AsyncRecvFrame(CompletionToken &&token = kUseAwaitable) {
+    return asio::async_initiate<CompletionToken,
+                                void(std::error_code, RpcFrame)>(
+        [this](auto handler) {
+          using Handler = decltype(handler);
+
+          RecvFrameOp *op = AwaitOpImpl<RecvFrameOp, Handler>::Create(
+              std::move(handler), this->GetIoExecutor());
+          this->CoroutineDispatch(
+              [this, guard = AwaitOpGuard<RecvFrameOp>(op)]() mutable {
+                this->StartRecvFrame(guard.Release());
+              });
+        },
+        token);
+  }
+
+  /// 异步RPC调用，完成签名 void(std::error_code, RpcFrame)
+  /// 回应的状态在 RpcFrame::header 中，超时以 asio::error::timed_out 完成，
+  /// 断开时以断开的错误码完成
+  ///  @tparam      CompletionToken   完成标记类型
+  ///  @param[in]   service_hash    服务key
+  ///  @param[in]   method_id       服务中对应的方法编号
+  ///  @param[in]   request         请求数据
+  ///  @param[in]   timeout         超时时间，不大于0时不超时
+  ///  @param[in]   token           完成标记
+  template <typename CompletionToken = UseAwaitable>
+  TPN_INLINE auto AsyncCall(uint32_t service_hash, uint32_t method_id,
+                            const google::protobuf::Message &request,
+                            SteadyClock::duration timeout,
+                            CompletionToken &&token = kUseAwaitable) {
+    return asio::async_initiate<CompletionToken,
+                                void(std::error_code, RpcFrame)>(
+        [this, service_hash, method_id, timeout,
+         &request](auto handler) {
+          using Handler = decltype(handler);
+
+          Derived &derive = CRTP_CAST(this);
+
+          RpcCallOp *op = AwaitOpImpl<RpcCallOp, Handler>::Create(
+              std::move(handler), this->GetIoExecutor());
+          op->service_hash = service_hash;
+          op->method_id    = method_id;
+          op->deadline     = timeout > SteadyClock::duration::zero()
+                                 ? SteadyClock::now() + timeout
+                                 : SteadyClock::time_point::max();
+
+          if (derive.GetIoHandle().GetStrand().running_in_this_thread()) {
+            this->StartCall(op, &request, nullptr);
+            return;
+          }
+
+          // 跨线程调用时请求对象不一定活到strand上，先序列化
+          MessageBuffer body(request.ByteSizeLong());
+          request.SerializeWithCachedSizesToArray(body.GetWritePointer());
+          body.WriteCompleted(body.GetBufferSize());
+          derive.Post([this, self_ptr = derive.GetSelfSptr(),
+                       body  = std::move(body),
+                       guard = AwaitOpGuard<RpcCallOp>(op)]() mutable {
+            this->StartCall(guard.Release(), nullptr, &body);
+          });
+        },
+        token);
+  }
+
+  /// 获取等待回应的RPC调用数，在strand上调用
+  TPN_INLINE size_t GetPendingCallCount() const { return this->call_count_; }
+
+ protected:
+  /// 收到帧，先匹配等待回应的调用，再交给等待收帧的协程，都不需要时通知 FireRecv
+  ///  @param[in]   this_ptr    延长生命周期的智能指针
+  ///  @param[in]   header      协议头
+  ///  @param[in]   packet      协议体
+  void CoroutineRecv(std::shared_ptr<Derived> &this_ptr,
+                     protocol::Header &&header, MessageBuffer &&packet) {
+    Derived &derive = CRTP_CAST(this);
+
+    if (this->call_count_ > 0) {
+      // 令牌是调用序号的低32位
+      uint64_t head = this->calls_.GetHead();
+      uint64_t seq =
+          head + static_cast<uint32_t>(header.token() -
+                                       static_cast<uint32_t>(head));
+      if (this->calls_.Contains(seq)) {
+        RpcCallOp *op = this->calls_.At(seq);
+        if (op && (op->service_hash == header.service_hash()) &&
+            (op->method_id == header.method_id())) {
+          this->calls_.At(seq) = nullptr;
+          --this->call_count_;
+          this->TrimCalls();
+          op->Complete(AwaitOpMode::kDispatch, std::error_code(),
+                       RpcFrame{std::move(header), std::move(packet)});
+          return;
+        }
+      }
+    }
+
+    if (this->recv_enabled_) {
+      if (RecvFrameOp *op = std::exchange(this->recv_op_, nullptr)) {
+        op->Complete(AwaitOpMode::kDispatch, std::error_code(),
+                     RpcFrame{std::move(header), std::move(packet)});
+      } else {
+        this->frames_.EmplaceBack(
+            RpcFrame{std::move(header), std::move(packet)});
+      }
+      return;
+    }
+
+    derive.FireRecv(this_ptr, std::move(header), std::move(packet));
+  }
+
+  /// 连接完成，取走等待的连接操作
+  ///  @param[in]   ec          错误码
+  void CoroutineConnect(const std::error_code &ec) {
+    if (ConnectOp *op = std::exchange(this->connect_op_, nullptr)) {
+      // 同步启动失败时还在发起函数中
+      op->Complete(AwaitOpMode::kPost, ec);
+    }
+  }
+
+  /// 断开时以错误码完成所有等待中的操作，在strand上调用
+  ///  @param[in]   ec          错误码
+  ///  @param[in]   mode        完成方式
+  void CoroutineAbort(std::error_code ec,
+                      AwaitOpMode mode = AwaitOpMode::kDispatch) {
+    if (!ec) {
+      ec = asio::error::operation_aborted;
+    }
+
+    RpcCallOp *aborted = nullptr;
+    for (uint64_t seq = this->calls_.GetHead(); seq != this->calls_.GetTail();
+         ++seq) {
+      if (RpcCallOp *op = this->calls_.At(seq)) {
+        op->next = aborted;
+        aborted  = op;
+      }
+    }
+    this->calls_.Clear();
+    this->call_count_ = 0;
+    this->frames_.Clear();
+    this->recv_enabled_ = false;
+
+    RecvFrameOp *recv_op = std::exchange(this->recv_op_, nullptr);
+    ConnectOp *connect_op = std::exchange(this->connect_op_, nullptr);
+
+    // 状态清理完再完成，协程可能在完成中再次发起操作
+    this->CompleteCalls(aborted, ec, mode);
+    if (recv_op) {
+      recv_op->Abort(mode, ec);
+    }
+    if (connect_op) {
+      connect_op->Abort(AwaitOpMode::kPost, ec);
+    }
+  }
+
+ private:
+  /// 在strand上执行，已经在strand上时直接执行
+  ///  @tparam      Func      函数类型
+  ///  @param[in]   func      函数
+  template <typename Func>
+  TPN_INLINE void CoroutineDispatch(Func &&func) {
+    Derived &derive = CRTP_CAST(this);
+
+    if (derive.GetIoHandle().GetStrand().running_in_this_thread()) {
+      func();
+      return;
+    }
+    derive.Post([self_ptr = derive.GetSelfSptr(),
+                 func     = std::forward<Func>(func)]() mutable { func(); });
+  }
+
+  /// 开始等待收帧，在strand上调用
+  ///  @param[in]   op          收帧操作
+  void StartRecvFrame(RecvFrameOp *op) {
+    Derived &derive = CRTP_CAST(this);
+
+    // 仍在发起函数中，完成需要提交
+    if (!this->frames_.Empty()) {
+      RpcFrame frame(std::move(this->frames_.Front()));
+      this->frames_.PopFront();
+      op->Complete(AwaitOpMode::kPost, std::error_code(), std::move(frame));
+      return;
+    }
+
+    if (!derive.IsStarted()) {
+      op->Abort(AwaitOpMode::kPost, asio::error::not_connected);
+      return;
+    }
+
+    if (this->recv_op_) {
+      op->Abort(AwaitOpMode::kPost, asio::error::in_progress);
+      return;
+    }
+
+    this->recv_enabled_ = true;
+    this->recv_op_      = op;
+  }
+
+  /// 登记调用并发送请求，在strand上调用
+  ///  @param[in]   op          调用操作
+  ///  @param[in]   request     请求数据，为空时使用body
+  ///  @param[in]   body        序列化好的请求数据
+  void StartCall(RpcCallOp *op, const google::protobuf::Message *request,
+                 MessageBuffer *body) {
+    Derived &derive = CRTP_CAST(this);
+
+    if (!derive.IsStarted()) {
+      op->Abort(AwaitOpMode::kPost, asio::error::not_connected);
+      return;
+    }
+
+    uint64_t seq = this->calls_.GetTail();
+
+    protocol::Header header;
+    header.set_service_hash(op->service_hash);
+    header.set_method_id(op->method_id);
+    header.set_token(static_cast<uint32_t>(seq));
+    header.set_size(static_cast<uint32_t>(
+        request ? request->ByteSizeLong() : body->GetActiveSize()));
+
+    uint16_t header_length = static_cast<uint16_t>(header.ByteSizeLong());
+    uint16_t header_bytes  = header_length;
+    EndianRefMakeLittle(header_bytes);
+
+    MessageBuffer frame(kHeaderBytes + header_length + header.size());
+    frame.Write(&header_bytes, kHeaderBytes);
+    header.SerializeWithCachedSizesToArray(frame.GetWritePointer());
+    frame.WriteCompleted(header_length);
+    if (request) {
+      request->SerializeWithCachedSizesToArray(frame.GetWritePointer());
+      frame.WriteCompleted(header.size());
+    } else if (header.size() > 0) {
+      frame.Write(body->GetReadPointer(), header.size());
+    }
+
+    this->calls_.EmplaceBack(op);
+    ++this->call_count_;
+    if (op->deadline != SteadyClock::time_point::max()) {
+      this->ArmCallSweep(op->deadline);
+    }
+
+    derive.Send(std::move(frame));
+  }
+
+  /// 按最早的超时时间登记一次检查，已登记更早的检查时不重复登记
+  ///  @param[in]   deadline    超时时间点
+  void ArmCallSweep(SteadyClock::time_point deadline) {
+    Derived &derive = CRTP_CAST(this);
+
+    if (deadline >= this->sweep_deadline_) {
+      return;
+    }
+
+    this->sweep_deadline_ = deadline;
+    derive.Post([this, deadline]() { this->SweepCalls(deadline); },
+                (std::max)(deadline - SteadyClock::now(),
+                           SteadyClock::duration::zero()));
+  }
+
+  /// 以超时完成到期的调用，再为剩下最早的超时登记检查
+  ///  @param[in]   armed       本次检查登记时的超时时间点
+  void SweepCalls(SteadyClock::time_point armed) {
+    if (armed == this->sweep_deadline_) {
+      this->sweep_deadline_ = SteadyClock::time_point::max();
+    }
+
+    SteadyClock::time_point now  = SteadyClock::now();
+    SteadyClock::time_point next = SteadyClock::time_point::max();
+    RpcCallOp *expired           = nullptr;
+    for (uint64_t seq = this->calls_.GetHead(); seq != this->calls_.GetTail();
+         ++seq) {
+      RpcCallOp *op = this->calls_.At(seq);
+      if (!op) {
+        continue;
+      }
+      if (op->deadline <= now) {
+        this->calls_.At(seq) = nullptr;
+        --this->call_count_;
+        op->next = expired;
+        expired  = op;
+      } else {
+        next = (std::min)(next, op->deadline);
+      }
+    }
+    this->TrimCalls();
+
+    if (next != SteadyClock::time_point::max()) {
+      this->ArmCallSweep(next);
+    }
+    this->CompleteCalls(expired, asio::error::timed_out,
+                        AwaitOpMode::kDispatch);
+  }
+
+  /// 移除头部已完成的调用
+  TPN_INLINE void TrimCalls() {
+    while (!this->calls_.Empty() && !this->calls_.Front()) {
+      this->calls_.PopFront();
+    }
+  }
+
+  /// 以错误码完成链表上的调用
+  ///  @param[in]   ops         调用链表
+  ///  @param[in]   ec          错误码
+  ///  @param[in]   mode        完成方式
+  static void CompleteCalls(RpcCallOp *ops, const std::error_code &ec,
+                            AwaitOpMode mode) {
+    while (ops) {
+      RpcCallOp *op = std::exchange(ops, ops->next);
+      op->Abort(mode, ec);
+    }
+  }
+
+ private:
+  EventRing<RpcCallOp *, kCoroutineCallInlineSize>
+      calls_;              ///< 按序号排列的等待回应的调用，已完成的置空
+  size_t call_count_{0};  ///< 等待回应的调用数
+  SteadyClock::time_point sweep_deadline_{
+      SteadyClock::time_point::max()};  ///< 已登记的最早一次超时检查
+  EventRing<RpcFrame, kCoroutineFrameInlineSize>
+      frames_;                      ///< 等待协程取走的帧
+  RecvFrameOp *recv_op_{nullptr};   ///< 等待收帧的操作
+  ConnectOp *connect_op_{nullptr};  ///< 等待连接完成的操作
+  bool recv_enabled_{false};        ///< 是否由协程接收帧
+};
+
+}  // namespace net
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_WRAPPER_COROUTINE_WRAP_H_
@@ -23,12 +23,12 @@
 #ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_WRAPPER_POST_WRAP_H_
 #define TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_WRAPPER_POST_WRAP_H_
 
-#include <set>
 #include <future>
 #include <functional>
 
 #include "net_common.h"
 #include "io_pool.h"
+#include "linked_list.h"
 #include "custom_allocator.h"
 
 namespace tpn {
@@ -61,43 +61,22 @@ class PostWrap {
   }
 
   /// 提交函数对象以延迟指定时间执行
-  /// 此函数使用指定的执行程序提交对象以供执行。 函数对象已排队等待执行，
-  /// 并且从 asio::post() 返回之前，不会从当前线程中调用该函数对象。
+  /// 任务登记到所在io线程的时间轮上，不再为每个任务创建asio定时器，
+  /// 在延迟到期后的第一个刻度执行，精度为 kTimerWheelTick 毫秒。
   ///  @tparam      Func    任务函数类型
   ///  @tparam      Rep     表示计次数的算术类型
   ///  @tparam      Period  表示计次周期的 std::ratio （即每秒的次数）
   ///  @param[in]   func    任务函数
   ///  @param[in]   delay   延迟周期
-  /// @sa asio::post
+  /// @sa TimerWheel
   template <typename Func, typename Rep, typename Period>
   TPN_INLINE Derived &Post(Func &&func,
                            std::chrono::duration<Rep, Period> delay) {
     Derived &derive = CRTP_CAST(this);
 
-    auto timer = std::make_unique<asio::steady_timer>(
-        derive.GetIoHandle().GetIoContext());
-
-    asio::dispatch(
-        derive.GetIoHandle().GetStrand(),
-        MakeAllocator(
-            derive.GetWriteAllocator(),
-            [this, self = derive.GetSelfSptr(), key = timer.get()]() mutable {
-              NET_DEBUG("PostWrap Post asio::dispatch {} to task set", key);
-              this->timed_tasks_.emplace(key);
-            }));
-
-    timer.expires_after(delay);
-    timer.async_wait(asio::bind_executor(
-        derive.GetIoHandle().GetStrand(),
-        MakeAllocator(
-            derive.GetWriteAllocator(),
-            [this, self = derive.GetSelfSptr(), timer = std::move(timer),
-             func =
-                 std::forward<Func>(func)](const std::error_code &ec) mutable {
-              NET_DEBUG("PostWrap Post async_wait error {}", ec);
-              func();
-              this->timed_tasks_.erase(timer.get());
-            })));
+    this->PostTimedTask(
+        MakeTimerWheelTask(std::forward<Func>(func), derive.GetSelfSptr()),
+        std::chrono::duration_cast<SteadyClock::duration>(delay));
 
     return (derive);
   }
@@ -152,32 +131,10 @@ class PostWrap {
 
     std::future<ReturnType> ret = task.get_future();
 
-    auto timer = std::make_unique<asio::steady_timer>(
-        derive.GetIoHandle().GetIoContext());
-
-    asio::dispatch(
-        derive.GetIoHandle().GetStrand(),
-        MakeAllocator(derive.GetWriteAllocator(), [this,
-                                                   self = derive.GetSelfSptr(),
-                                                   key =
-                                                       timer.get()]() mutable {
-          NET_DEBUG(
-              "PostWrap Post asio::use_future_t asio::dispatch {} to task set",
-              key);
-          this->timed_tasks_.emplace(key);
-        }));
-
-    timer.expires_after(delay);
-    timer.async_wait(asio::bind_executor(
-        derive.GetIoHandle().GetStrand(),
-        MakeAllocator(
-            derive.GetWriteAllocator(),
-            [this, self = derive.GetSelfSptr(), timer = std::move(timer),
-             task = std::move(task)](const std::error_code &ec) mutable {
-              NET_DEBUG("PostWrap Post async_wait error {}", ec);
-              task();
-              this->timed_tasks_.erase(timer.get());
-            })));
+    this->PostTimedTask(
+        MakeTimerWheelTask([task = std::move(task)]() mutable { task(); },
+                           derive.GetSelfSptr()),
+        std::chrono::duration_cast<SteadyClock::duration>(delay));
 
     return ret;
   }
@@ -247,18 +204,34 @@ class PostWrap {
       return (derive);
     }
 
-    NET_DEBUG("PostWrap StopAllPostedTasks timed_task num {}",
-              this->timed_tasks_.size());
+    // 与取消asio定时器后回调仍会执行的行为保持一致，未到期的任务立即执行
+    size_t count =
+        derive.GetIoHandle().GetTimerWheel().Flush(this->posted_tasks_);
 
-    for (auto &timer : this->timed_tasks_) {
-      timer->cancel(s_ec_ignore);
-    }
+    NET_DEBUG("PostWrap StopAllPostedTasks timed_task num {}", count);
 
     return (derive);
   }
 
  protected:
-  std::set<asio::steady_timer *> timed_tasks_;  ///< 准备停止时，停止计时任务
+  /// 把延迟任务登记到所在io线程的时间轮
+  ///  @param[in]   task    任务
+  ///  @param[in]   delay   延迟周期
+  TPN_INLINE void PostTimedTask(TimerWheelTaskPtr task,
+                                SteadyClock::duration delay) {
+    Derived &derive = CRTP_CAST(this);
+
+    asio::dispatch(
+        derive.GetIoHandle().GetStrand(),
+        MakeAllocator(derive.GetWriteAllocator(),
+                      [this, task = std::move(task), delay]() mutable {
+                        CRTP_CAST(this).GetIoHandle().GetTimerWheel().Add(
+                            std::move(task), delay, this->posted_tasks_);
+                      }));
+  }
+
+ protected:
+  LinkedListHead posted_tasks_;  ///< 登记在时间轮上的计时任务，停止时一并执行
 };
 
 }  // namespace net
@@ -23,11 +23,15 @@
 #ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_WRAPPER_SEND_WRAP_H_
 #define TYPHOON_ZERO_TPN_SRC_LIB_NET_BASE_UTILITY_WRAPPER_SEND_WRAP_H_
 
+#include <atomic>
+#include <unordered_map>
+
 #include "traits_hub.h"
 #include "message_buffer.h"
 #include "net_common.h"
 #include "io_pool.h"
 #include "event_queue.h"
+#include "awaitable.h"
 #include "callback_helper.h"
 
 namespace tpn {
@@ -36,7 +40,32 @@ namespace net {
 
 TPN_NET_FORWARD_DECL_BASE_CLASS
 
+/// 发送队列超限策略
+enum class SendOverflowPolicy : uint8_t {
+  kDisconnect = 0,  ///< 断开连接
+  kDropUnreliable,  ///< 从最旧的开始丢弃未写出的可丢弃消息，仍超限时断开连接
+};
+
+/// 会话发送队列参数，需要在会话启动前设置
+/// max_bytes 与 high_watermark 都为0时发送队列不计数，与不设置相同
+struct SendQueueOptions {
+  /// 发送队列最大字节数，包括正在写的帧，0表示不限制
+  size_t max_bytes{0};
+  /// 队列字节数达到高水位时通知 FireSendHighWatermark，0表示不通知
+  size_t high_watermark{0};
+  /// 达到高水位后回落到低水位时通知 FireSendLowWatermark
+  size_t low_watermark{0};
+  /// 超限策略
+  SendOverflowPolicy overflow{SendOverflowPolicy::kDisconnect};
+  /// 为true时 SendLatest 替换队列中同key未写出的消息
+  bool coalesce_latest{true};
+};
+
 /// 数据发送包裹
+/// 发送队列受限时队列字节数在strand上计数，消息分为三类：
+/// Send 不可丢弃，超限时断开连接；
+/// SendUnreliable 可丢弃，超限时按策略从最旧的开始丢弃；
+/// SendLatest 可丢弃，只关心最新值，同key的消息未写出时被新值替换
 ///  @tparam  Derived
 ///  @tparam  ArgsType
 template <typename Derived, typename ArgsType = void>
@@ -60,13 +89,83 @@ class SendWrap {
         asio::detail::throw_error(asio::error::not_connected);
       }
 
-      derive.EventEnqueue([&derive, buffer = std::move(buffer)](
-                              EventQueueGuard<Derived> &&guard) mutable {
-        NET_DEBUG("SendWrap Send DoSend");
-        return derive.DoSend(std::move(buffer),
-                             [guard = std::move(guard)](const std::error_code &,
-                                                        size_t) mutable {});
-      });
+      if (this->IsSendQueueBounded()) {
+        this->SendReliable(std::move(buffer));
+        return true;
+      }
+
+      derive.EventEnqueueSend(std::move(buffer));
+      return true;
+    } catch (std::system_error &e) {
+      NET_ERROR("SendWrap Send error {}", e.code());
+      SetLastError(e);
+    } catch (std::exception &ex) {
+      NET_ERROR("SendWrap Send exception {}", ex.what());
+      SetLastError(asio::error::eof);
+    }
+    return false;
+  }
+
+  /// 发送数据，写完后完成异步发送
+  /// 操作随发送事件存放，不经过回调，发送失败时以错误码完成
+  ///  @param[in]   buffer    调用需要保证buffer满足底层拆包逻辑
+  ///  @param[in]   op        异步发送操作
+  ///  @return 发送成功返回true
+  TPN_INLINE bool SendAndComplete(MessageBuffer &&buffer, SendOp *op) {
+    Derived &derive = CRTP_CAST(this);
+
+    NET_DEBUG("SendWrap SendAndComplete");
+
+    AwaitOpGuard<SendOp> guard(op);
+    try {
+      if (!derive.IsStarted()) {
+        NET_WARN("SendWrap derive is not started");
+        asio::detail::throw_error(asio::error::not_connected);
+      }
+
+      if (this->IsSendQueueBounded()) {
+        this->SendReliable(std::move(buffer), std::move(guard));
+        return true;
+      }
+
+      derive.EventEnqueueSend(std::move(buffer), guard.Release());
+      return true;
+    } catch (std::system_error &e) {
+      NET_ERROR("SendWrap SendAndComplete error {}", e.code());
+      SetLastError(e);
+    } catch (std::exception &ex) {
+      NET_ERROR("SendWrap SendAndComplete exception {}", ex.what());
+      SetLastError(asio::error::eof);
+    }
+
+    // 仍在发起函数中，完成需要提交
+    if (SendOp *send_op = guard.Release()) {
+      send_op->Abort(AwaitOpMode::kPost, GetLastError());
+    }
+    return false;
+  }
+
+  /// 发送共享的只读数据
+  /// 发送队列只持有缓冲的引用计数，不拷贝数据
+  ///  @param[in]   buffer    调用需要保证buffer满足底层拆包逻辑
+  ///  @return 发送成功返回true
+  TPN_INLINE bool Send(const SharedMessageBuffer &buffer) {
+    Derived &derive = CRTP_CAST(this);
+
+    NET_DEBUG("SendWrap Send shared");
+
+    try {
+      if (!derive.IsStarted()) {
+        NET_WARN("SendWrap derive is not started");
+        asio::detail::throw_error(asio::error::not_connected);
+      }
+
+      if (this->IsSendQueueBounded()) {
+        this->SendReliable(SharedMessageBuffer(buffer));
+        return true;
+      }
+
+      derive.EventEnqueueSend(buffer);
       return true;
     } catch (std::system_error &e) {
       NET_ERROR("SendWrap Send error {}", e.code());
@@ -96,6 +195,12 @@ class SendWrap {
         asio::detail::throw_error(asio::error::not_connected);
       }
 
+      if (this->IsSendQueueBounded()) {
+        this->SendReliable(std::move(buffer),
+                           std::forward<Callback>(callback));
+        return true;
+      }
+
       derive.EventEnqueue([&derive, buffer = std::move(buffer),
                            callback = std::forward<Callback>(callback)](
                               EventQueueGuard<Derived> &&guard) mutable {
@@ -117,6 +222,386 @@ class SendWrap {
     }
     return false;
   }
+
+  /// 发送可丢弃的数据
+  /// 发送队列不受限时与 Send 相同
+  ///  @param[in]   buffer    调用需要保证buffer满足底层拆包逻辑
+  ///  @return 发送成功返回true，之后仍可能被丢弃
+  TPN_INLINE bool SendUnreliable(MessageBuffer &&buffer) {
+    return this->SendUnreliable(MakeSharedMessageBuffer(std::move(buffer)));
+  }
+
+  /// 发送可丢弃的共享只读数据
+  ///  @param[in]   buffer    调用需要保证buffer满足底层拆包逻辑
+  ///  @return 发送成功返回true，之后仍可能被丢弃
+  TPN_INLINE bool SendUnreliable(const SharedMessageBuffer &buffer) {
+    return this->SendDroppable(buffer, false, 0);
+  }
+
+  /// 发送只关心最新值的数据，例如位置、血量
+  /// 队列中同key的消息还未写出时直接替换为新值
+  ///  @param[in]   key       合并用的key
+  ///  @param[in]   buffer    调用需要保证buffer满足底层拆包逻辑
+  ///  @return 发送成功返回true，之后仍可能被替换或丢弃
+  TPN_INLINE bool SendLatest(uint64_t key, MessageBuffer &&buffer) {
+    return this->SendLatest(key, MakeSharedMessageBuffer(std::move(buffer)));
+  }
+
+  /// 发送只关心最新值的共享只读数据
+  ///  @param[in]   key       合并用的key
+  ///  @param[in]   buffer    调用需要保证buffer满足底层拆包逻辑
+  ///  @return 发送成功返回true，之后仍可能被替换或丢弃
+  TPN_INLINE bool SendLatest(uint64_t key, const SharedMessageBuffer &buffer) {
+    return this->SendDroppable(buffer, true, key);
+  }
+
+  /// 设置发送队列参数，需要在会话启动前设置
+  ///  @param[in]   options   发送队列参数
+  ///  @return CRTP调用链对象
+  TPN_INLINE Derived &SetSendQueueOptions(const SendQueueOptions &options) {
+    this->send_queue_options_ = options;
+    return CRTP_CAST(this);
+  }
+
+  /// 获取发送队列参数
+  ///  @return 发送队列参数
+  TPN_INLINE const SendQueueOptions &GetSendQueueOptions() const {
+    return this->send_queue_options_;
+  }
+
+  /// 获取发送队列中的字节数，包括正在写的帧
+  ///  @return 字节数，发送队列不受限时为0
+  TPN_INLINE size_t GetSendQueueBytes() const {
+    return this->send_queue_bytes_.load(std::memory_order_relaxed);
+  }
+
+  /// 获取被丢弃或被新值替换的消息数
+  ///  @return 消息数
+  TPN_INLINE size_t GetSendQueueDropped() const {
+    return this->send_queue_dropped_.load(std::memory_order_relaxed);
+  }
+
+ protected:
+  /// 发送队列达到高水位通知，逻辑层可以在这里降低发送频率
+  ///  @param[in]   this_ptr    延长生命周期的智能指针
+  ///  @param[in]   bytes       发送队列字节数
+  TPN_INLINE void [[maybe_unused]] FireSendHighWatermark(
+      std::shared_ptr<Derived> &this_ptr, size_t bytes) {}
+
+  /// 发送队列回落到低水位通知
+  ///  @param[in]   this_ptr    延长生命周期的智能指针
+  ///  @param[in]   bytes       发送队列字节数
+  TPN_INLINE void [[maybe_unused]] FireSendLowWatermark(
+      std::shared_ptr<Derived> &this_ptr, size_t bytes) {}
+
+ private:
+  using Event = typename EventQueue<Derived, ArgsType>::Event;
+
+  /// 发送队列是否受限
+  TPN_INLINE bool IsSendQueueBounded() const {
+    return (this->send_queue_options_.max_bytes > 0) ||
+           (this->send_queue_options_.high_watermark > 0);
+  }
+
+  /// 在strand上执行，发送队列的计数只在strand上修改
+  ///  @tparam      Func      函数类型
+  ///  @param[in]   func      函数
+  template <typename Func>
+  TPN_INLINE void SendQueueDispatch(Func &&func) {
+    Derived &derive = CRTP_CAST(this);
+
+    if (derive.GetIoHandle().GetStrand().running_in_this_thread()) {
+      func();
+      return;
+    }
+
+    derive.Post([self_ptr = derive.GetSelfSptr(),
+                 func     = std::forward<Func>(func)]() mutable { func(); });
+  }
+
+  /// 受限发送队列中发送不可丢弃的数据
+  ///  @tparam      Buffer    MessageBuffer 或 SharedMessageBuffer
+  ///  @param[in]   buffer    调用需要保证buffer满足底层拆包逻辑
+  ///  @param[in]   op        写完后完成的异步发送，可以为空
+  template <typename Buffer>
+  TPN_INLINE void SendReliable(
+      Buffer &&buffer, AwaitOpGuard<SendOp> op = AwaitOpGuard<SendOp>()) {
+    Derived &derive = CRTP_CAST(this);
+
+    this->SendQueueDispatch([this, &derive, buffer = std::move(buffer),
+                             op = std::move(op)]() mutable {
+      size_t size = Self::GetFrameSize(buffer);
+      // 超限时未完成的异步发送由守护以 operation_aborted 完成
+      if (!this->ReserveSendQueue(size, false)) {
+        return;
+      }
+      derive.EventPushInStrand(
+          Event{std::move(buffer), size, 0, 0, op.Release()});
+    });
+  }
+
+  /// 受限发送队列中发送不可丢弃的数据，写完后回调
+  ///  @tparam      Callback  发送数据完回调类型
+  ///  @param[in]   buffer    调用需要保证buffer满足底层拆包逻辑
+  ///  @param[in]   callback  发送数据回调
+  template <typename Callback,
+            typename = std::enable_if_t<is_callable_v<Callback>>>
+  TPN_INLINE void SendReliable(MessageBuffer &&buffer, Callback &&callback) {
+    Derived &derive = CRTP_CAST(this);
+
+    this->SendQueueDispatch([this, &derive, buffer = std::move(buffer),
+                             callback = std::forward<Callback>(
+                                 callback)]() mutable {
+      size_t size = buffer.GetBufferSize();
+      if (!this->ReserveSendQueue(size, false)) {
+        return;
+      }
+
+      derive.EventEnqueue([this, &derive, size, buffer = std::move(buffer),
+                           callback = std::move(callback)](
+                              EventQueueGuard<Derived> &&guard) mutable {
+        // 超限断开后排队的发送直接跳过
+        if (!derive.IsStarted()) {
+          this->ReleaseSendQueue(size);
+          return true;
+        }
+
+        NET_DEBUG("SendWrap SendReliable DoSend");
+        return derive.DoSend(
+            buffer, [this, size, &callback, guard = std::move(guard)](
+                        const std::error_code &, size_t bytes_sent) mutable {
+              this->ReleaseSendQueue(size);
+              CallbackHelper::Call(callback, bytes_sent);
+            });
+      });
+    });
+  }
+
+  /// 发送可丢弃的数据
+  ///  @param[in]   buffer    调用需要保证buffer满足底层拆包逻辑
+  ///  @param[in]   latest    是否只关心最新值
+  ///  @param[in]   key       合并用的key
+  ///  @return 发送成功返回true
+  TPN_INLINE bool SendDroppable(const SharedMessageBuffer &buffer, bool latest,
+                                uint64_t key) {
+    Derived &derive = CRTP_CAST(this);
+
+    if (!this->IsSendQueueBounded()) {
+      return this->Send(buffer);
+    }
+
+    NET_DEBUG("SendWrap SendDroppable latest {} key {}", latest, key);
+
+    try {
+      if (!derive.IsStarted()) {
+        NET_WARN("SendWrap derive is not started");
+        asio::detail::throw_error(asio::error::not_connected);
+      }
+
+      this->SendQueueDispatch(
+          [this, buffer = SharedMessageBuffer(buffer), latest, key]() mutable {
+            this->EnqueueDroppable(std::move(buffer), latest, key);
+          });
+      return true;
+    } catch (std::system_error &e) {
+      NET_ERROR("SendWrap SendDroppable error {}", e.code());
+      SetLastError(e);
+    } catch (std::exception &ex) {
+      NET_ERROR("SendWrap SendDroppable exception {}", ex.what());
+      SetLastError(asio::error::eof);
+    }
+    return false;
+  }
+
+  /// 可丢弃的数据进入发送队列，在strand上调用
+  ///  @param[in]   buffer    调用需要保证buffer满足底层拆包逻辑
+  ///  @param[in]   latest    是否只关心最新值
+  ///  @param[in]   key       合并用的key
+  void EnqueueDroppable(SharedMessageBuffer &&buffer, bool latest,
+                        uint64_t key) {
+    Derived &derive = CRTP_CAST(this);
+
+    size_t size   = buffer->GetBufferSize();
+    bool coalesce = latest && this->send_queue_options_.coalesce_latest;
+
+    // 同key的消息还未写出，原位替换，不改变发送顺序
+    if (coalesce) {
+      if (Event *event = this->FindLatest(key)) {
+        size_t replaced = event->accounted;
+        this->send_queue_dropped_.fetch_add(1, std::memory_order_relaxed);
+        if (size <= replaced) {
+          event->data      = std::move(buffer);
+          event->accounted = size;
+          this->ReleaseSendQueue(replaced - size);
+        } else if (this->ReserveSendQueue(size - replaced, true, event)) {
+          event->data      = std::move(buffer);
+          event->accounted = size;
+        } else {
+          // 新值放不下时旧值也已过期，一起丢弃
+          event->data      = SharedMessageBuffer();
+          event->accounted = 0;
+          event->flags |= kEventFlagSkipped;
+          this->ReleaseSendQueue(replaced);
+        }
+        return;
+      }
+    }
+
+    if (!this->ReserveSendQueue(size, true)) {
+      return;
+    }
+
+    uint8_t flags = kEventFlagDroppable | (coalesce ? kEventFlagLatest : 0);
+    uint64_t seq =
+        derive.EventPushInStrand(Event{std::move(buffer), size, key, flags});
+    if (coalesce) {
+      // 索引只增不删，旧序号查找时校验，key稳定后不再申请内存
+      if (this->send_latest_.size() >= kSendLatestCompactSize) {
+        std::erase_if(this->send_latest_, [&derive](const auto &pair) {
+          return nullptr == derive.FindEvent(pair.second);
+        });
+      }
+      this->send_latest_.insert_or_assign(key, seq);
+    }
+  }
+
+  /// 查找队列中同key还未写出的最新值消息，在strand上调用
+  ///  @param[in]   key       合并用的key
+  ///  @return 消息事件，没有返回nullptr
+  TPN_INLINE Event *FindLatest(uint64_t key) {
+    Derived &derive = CRTP_CAST(this);
+
+    auto iter = this->send_latest_.find(key);
+    if (this->send_latest_.end() == iter) {
+      return nullptr;
+    }
+
+    Event *event = derive.FindEvent(iter->second);
+    if (!event || (event->flags & kEventFlagSkipped) ||
+        !(event->flags & kEventFlagLatest) || (key != event->key)) {
+      return nullptr;
+    }
+    return event;
+  }
+
+  /// 计入发送队列字节数，超限时按策略处理，在strand上调用
+  ///  @param[in]   size        新增字节数
+  ///  @param[in]   droppable   新增的是否可丢弃
+  ///  @param[in]   keep        超限丢弃时跳过的消息
+  ///  @return 可以进入发送队列返回true
+  bool ReserveSendQueue(size_t size, bool droppable,
+                        const Event *keep = nullptr) {
+    Derived &derive = CRTP_CAST(this);
+
+    const SendQueueOptions &options = this->send_queue_options_;
+    size_t bytes = this->send_queue_bytes_.load(std::memory_order_relaxed);
+
+    if ((options.max_bytes > 0) && (bytes + size > options.max_bytes)) {
+      if (SendOverflowPolicy::kDropUnreliable == options.overflow) {
+        bytes = this->DropPending(bytes + size - options.max_bytes, keep);
+      }
+
+      if (bytes + size > options.max_bytes) {
+        if (droppable &&
+            (SendOverflowPolicy::kDropUnreliable == options.overflow)) {
+          this->send_queue_dropped_.fetch_add(1, std::memory_order_relaxed);
+          return false;
+        }
+
+        NET_WARN("SendWrap send queue bytes {} + {} over max {}, disconnect",
+                 bytes, size, options.max_bytes);
+        derive.DoDisconnect(asio::error::no_buffer_space);
+
+        // 对端不读取时正在写的帧不会完成，断开事件排在它之后，
+        // 取消后排队的发送被跳过，断开事件才能执行。udp会话共用服务器套接字，不取消
+        if constexpr (std::is_same_v<typename ArgsType::socket_type,
+                                     asio::ip::tcp::socket>) {
+          derive.GetSocket().cancel(s_ec_ignore);
+        }
+        return false;
+      }
+    }
+
+    bytes += size;
+    this->send_queue_bytes_.store(bytes, std::memory_order_relaxed);
+
+    if ((options.high_watermark > 0) && !this->send_queue_high_ &&
+        (bytes >= options.high_watermark)) {
+      this->send_queue_high_ = true;
+      std::shared_ptr<Derived> this_ptr = derive.GetSelfSptr();
+      derive.FireSendHighWatermark(this_ptr, bytes);
+    }
+    return true;
+  }
+
+  /// 从发送队列字节数中移除，在strand上调用
+  ///  @param[in]   size      移除的字节数
+  void ReleaseSendQueue(size_t size) {
+    Derived &derive = CRTP_CAST(this);
+
+    size_t bytes = this->send_queue_bytes_.load(std::memory_order_relaxed);
+    bytes        = bytes > size ? bytes - size : 0;
+    this->send_queue_bytes_.store(bytes, std::memory_order_relaxed);
+
+    if (this->send_queue_high_ &&
+        (bytes <= this->send_queue_options_.low_watermark)) {
+      this->send_queue_high_ = false;
+      std::shared_ptr<Derived> this_ptr = derive.GetSelfSptr();
+      derive.FireSendLowWatermark(this_ptr, bytes);
+    }
+  }
+
+  /// 从最旧的开始丢弃未写出的可丢弃消息，在strand上调用
+  /// 丢弃的消息留在事件队列中，轮到时直接跳过
+  ///  @param[in]   need      需要腾出的字节数
+  ///  @param[in]   keep      跳过的消息
+  ///  @return 丢弃后的发送队列字节数
+  size_t DropPending(size_t need, const Event *keep) {
+    Derived &derive = CRTP_CAST(this);
+
+    size_t dropped = 0;
+    size_t count   = 0;
+    derive.ForEachEvent([&](Event &event) {
+      if ((event.flags & kEventFlagDroppable) &&
+          !(event.flags & kEventFlagSkipped) && (keep != &event)) {
+        dropped += event.accounted;
+        event.data      = SharedMessageBuffer();
+        event.accounted = 0;
+        event.flags |= kEventFlagSkipped;
+        ++count;
+      }
+      return dropped < need;
+    });
+
+    size_t bytes = this->send_queue_bytes_.load(std::memory_order_relaxed);
+    bytes        = bytes > dropped ? bytes - dropped : 0;
+    this->send_queue_bytes_.store(bytes, std::memory_order_relaxed);
+    this->send_queue_dropped_.fetch_add(count, std::memory_order_relaxed);
+    return bytes;
+  }
+
+  /// 获取要写的帧长度
+  static size_t GetFrameSize(const MessageBuffer &buffer) {
+    return buffer.GetBufferSize();
+  }
+
+  /// 获取要写的帧长度
+  static size_t GetFrameSize(const SharedMessageBuffer &buffer) {
+    return buffer->GetBufferSize();
+  }
+
+ private:
+  using Self = SendWrap<Derived, ArgsType>;
+
+  /// 最新值消息索引超过该数量时清理已写出的项
+  static constexpr size_t kSendLatestCompactSize = 1024;
+
+  SendQueueOptions send_queue_options_;        ///< 发送队列参数
+  std::atomic<size_t> send_queue_bytes_{0};    ///< 发送队列字节数
+  std::atomic<size_t> send_queue_dropped_{0};  ///< 丢弃或替换的消息数
+  bool send_queue_high_{false};                ///< 是否在高水位之上
+  std::unordered_map<uint64_t, uint64_t>
+      send_latest_;  ///< 最新值消息的key到事件序号的索引
 };
 
 }  // namespace net
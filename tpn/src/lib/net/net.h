@@ -27,6 +27,9 @@
 #include "tcp_client.h"
 #include "tcp_server.h"
 #include "tcp_session.h"
+#include "udp_client.h"
+#include "udp_server.h"
+#include "udp_session.h"
 
 #if defined(TPN_USE_SSL)
 #endif
@@ -34,6 +34,7 @@
 // base
 #define TPN_NET_BASE_CLASS_DECL(Keyword)       \
   TEMPLATE_DECL_2 Keyword Connect;             \
+  TEMPLATE_DECL_2 Keyword CoroutineWrap;       \
   TEMPLATE_DECL_2 Keyword Disconnect;          \
   TEMPLATE_DECL_2 Keyword EventQueue;          \
   TEMPLATE_DECL_2 Keyword EventQueueGuard;     \
@@ -52,6 +53,8 @@
 
 // tcp base
 #define TPN_NET_TCP_BASE_CLASS_DECL(Keyword) \
+  TEMPLATE_DECL_2 Keyword TcpBatch;          \
+  TEMPLATE_DECL_2 Keyword TcpCompress;       \
   TEMPLATE_DECL_2 Keyword TcpKeepAlive;      \
   TEMPLATE_DECL_2 Keyword TcpRecv;           \
   TEMPLATE_DECL_2 Keyword TcpSendWrap;       \
@@ -184,6 +187,18 @@ static constexpr long kUdpSilenceTimeout = 60000;
 /// http静默超时时长 85 * 1000
 static constexpr long kHttpSilenceTimeout = 85000;
 
+/// 空闲回收器扫描间隔 1000
+static constexpr long kIdleReaperTick = 1000;
+
+/// 延迟任务时间轮刻度 10
+static constexpr long kTimerWheelTick = 10;
+
+/// io句柄负载流量采样间隔 1000
+static constexpr long kIoLoadSampleInterval = 1000;
+
+/// io句柄负载中折合一个会话的流量 每个采样间隔16K字节
+static constexpr uint64_t kIoLoadBytesPerSession = 16 * 1024;
+
 /// http执行超时时长 5 * 1000
 static constexpr long kHttpExecuteTimeout = 5000;
 
@@ -204,9 +219,45 @@ static constexpr size_t kUdpFrameSize = 1024;
 /// http帧大小
 static constexpr size_t kHttpFrameSize = 1536;
 
+/// 会话管理器分片数，按会话key散列，必须是2的幂
+static constexpr size_t kSessionMgrShards = 16;
+
+/// 会话句柄槽位表每块的槽位数，必须是2的幂
+static constexpr size_t kSessionSlotChunkSize = 1024;
+
+/// 会话句柄槽位表最多的块数，最多 4M 个同时注册的会话
+static constexpr size_t kSessionSlotMaxChunks = 4096;
+
+/// 会话句柄，高32位是槽位的代数，低32位是槽位下标，0为无效句柄
+using SessionHandle = uint64_t;
+
+/// 无效的会话句柄
+static constexpr SessionHandle kInvalidSessionHandle = 0;
+
 /// 协议头长度固定2字节
 static constexpr uint32_t kHeaderBytes = 2;
 
+/// 包头标志位，包体经过zlib压缩，raw_size是压缩前长度
+static constexpr uint32_t kHeaderFlagCompressed = 0x1;
+
+/// 包头标志位，包体是多个完整帧 [u16 header_len][Header][body] 的拼接
+static constexpr uint32_t kHeaderFlagBatch = 0x2;
+
+/// 合批帧包体默认最大长度
+static constexpr size_t kFrameBatchMaxBytes = 64 * 1024;
+
+/// 包体不小于该长度才压缩，小包压缩收益抵不上cpu开销
+static constexpr uint32_t kFrameCompressThreshold = 1024;
+
+/// 默认压缩等级，游戏消息以低延迟优先
+static constexpr int kFrameCompressLevel = 1;
+
+/// 解压后包体的默认最大长度，raw_size由对端填写，申请内存前必须先检查
+static constexpr uint32_t kFrameDecompressMaxSize = 4 * 1024 * 1024;
+
+/// 预设字典最大长度，zlib窗口为32K，更长的部分不会被引用
+static constexpr size_t kFrameDictionaryMaxSize = 32 * 1024;
+
 }  // namespace net
 
 }  // namespace tpn
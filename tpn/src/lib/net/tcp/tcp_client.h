@@ -27,9 +27,12 @@
 #include "rpc_type.pb.h"
 #include "net_common.h"
 #include "client.h"
+#include "tcp_batch.h"
+#include "tcp_compress.h"
 #include "tcp_keepalive.h"
 #include "tcp_recv.h"
 #include "tcp_send_wrap.h"
+#include "coroutine_wrap.h"
 
 namespace tpn {
 
@@ -55,7 +58,10 @@ template <typename Derived, typename ArgsType>
 class TcpClientBase : public ClientBase<Derived, ArgsType>,
                       public TcpKeepAlive<Derived, ArgsType>,
                       public TcpRecv<Derived, ArgsType>,
-                      public TcpSendWrap<Derived, ArgsType> {
+                      public TcpSendWrap<Derived, ArgsType>,
+                      public TcpCompress<Derived, ArgsType>,
+                      public TcpBatch<Derived, ArgsType>,
+                      public CoroutineWrap<Derived, ArgsType> {
   TPN_NET_FRIEND_DECL_BASE_CLASS
   TPN_NET_FRIEND_DECL_TCP_BASE_CLASS
   TPN_NET_FRIEND_DECL_TCP_CLIENT_CLASS
@@ -77,7 +83,10 @@ class TcpClientBase : public ClientBase<Derived, ArgsType>,
       : Super(1, buffer_max, buffer_prepare),
         TcpKeepAlive<Derived, ArgsType>(this->socket_),
         TcpRecv<Derived, ArgsType>(),
-        TcpSendWrap<Derived, ArgsType>() {
+        TcpSendWrap<Derived, ArgsType>(),
+        TcpCompress<Derived, ArgsType>(),
+        TcpBatch<Derived, ArgsType>(),
+        CoroutineWrap<Derived, ArgsType>() {
     this->SetConnectTimeoutDuration(MilliSeconds(kTcpConnectTimeout));
   };
 
@@ -331,6 +340,26 @@ class TcpClientBase : public ClientBase<Derived, ArgsType>,
         });
   }
 
+  /// 连接完成处理
+  /// 本函数重写了connect模块的DoneConnect的方法，完成后通知等待连接的协程
+  ///  @param[in]   ec          错误码
+  ///  @param[in]   this_ptr    延长生命周期句柄
+  TPN_INLINE void DoneConnect(std::error_code ec,
+                              std::shared_ptr<Derived> this_ptr) {
+    NET_DEBUG("TcpClientBase DoneConnect error {}", ec);
+
+    Super::DoneConnect(ec, std::move(this_ptr));
+
+    if (this->IsStarted()) {
+      ec.clear();
+    } else if (this->IsConnectTimeout()) {
+      ec = asio::error::timed_out;
+    } else if (!ec) {
+      ec = asio::error::operation_aborted;
+    }
+    this->CoroutineConnect(ec);
+  }
+
   /// 处理断开连接
   ///  @param[in]   ec          错误码
   ///  @param[in]   this_ptr    延长生命周期的智能指针
@@ -340,6 +369,9 @@ class TcpClientBase : public ClientBase<Derived, ArgsType>,
 
     IgnoreUnused(ec, this_ptr);
 
+    // 等待中的协程操作以断开的错误码完成
+    this->CoroutineAbort(ec);
+
     // 我们应该在 HandleDisconnect 函数中关闭套接字吗？
     // 否则当发送数据失败时，会导致DoDisconnect 函数被调用，然后导致自动重连执行，
     // 然后PostRecv 将返回一些错误，而PostRecv 将导致自动重连再次执行。
@@ -358,10 +390,10 @@ class TcpClientBase : public ClientBase<Derived, ArgsType>,
   ///  @param[in]   callback  发送数据回调
   ///  @return 发送成功返回true
   template <typename Callback>
-  TPN_INLINE bool DoSend(MessageBuffer &&buffer, Callback &&callback) {
+  TPN_INLINE bool DoSend(const MessageBuffer &buffer, Callback &&callback) {
     NET_DEBUG("TcpClientBase DoSend");
 
-    return this->GetDerivedObj().TcpSend(std::move(buffer),
+    return this->GetDerivedObj().TcpSend(buffer,
                                          std::forward<Callback>(callback));
   }
 
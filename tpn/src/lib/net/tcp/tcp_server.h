@@ -23,8 +23,12 @@
 #ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_TCP_TCP_SERVER_H_
 #define TYPHOON_ZERO_TPN_SRC_LIB_NET_TCP_TCP_SERVER_H_
 
+#include <memory>
+#include <vector>
+
 #include "net_common.h"
 #include "server.h"
+#include "frame_codec.h"
 #include "tcp_session.h"
 
 namespace tpn {
@@ -35,6 +39,49 @@ TPN_NET_FORWARD_DECL_BASE_CLASS
 TPN_NET_FORWARD_DECL_TCP_BASE_CLASS
 TPN_NET_FORWARD_DECL_TCP_SERVER_CLASS
 
+/// tcp服务器监听选项，需要在启动前设置
+struct TcpServerOptions {
+  /// 每个io线程一个接受器，通过SO_REUSEPORT由内核分配连接，
+  /// 接受的会话留在接受它的io线程上，不支持SO_REUSEPORT的平台忽略
+  bool reuse_port{false};
+  /// 监听队列长度
+  int backlog{asio::socket_base::max_listen_connections};
+  /// 每次接受完成后最多连续接受的连接数，大于1时接受器使用非阻塞模式
+  size_t accept_batch{1};
+  /// 接受的套接字是否禁用Nagle算法
+  bool no_delay{false};
+  /// 接受的套接字发送缓冲区大小，0表示使用系统默认值
+  int send_buffer_size{0};
+  /// 接受的套接字接收缓冲区大小，0表示使用系统默认值
+  int receive_buffer_size{0};
+  /// 接受的套接字是否开启TCP_QUICKACK，只在接受时设置一次，只对linux有效
+  bool quick_ack{false};
+  /// 接受的会话使用的帧压缩参数，为空时会话只解压收到的压缩帧
+  std::shared_ptr<const FrameCompressOptions> compress;
+  /// 接受的会话使用的帧合批参数，默认不合批
+  FrameBatchOptions batch;
+  /// 接受的会话使用的发送队列参数，默认不限制
+  SendQueueOptions send_queue;
+};
+
+/// tcp服务器接受器
+/// 由共享指针持有，投递到io线程的处理函数持有一份引用，
+/// 重新启动时收缩接受器列表也不会释放仍有处理函数未执行的接受器
+struct TcpServerAcceptor
+    : public std::enable_shared_from_this<TcpServerAcceptor> {
+  /// 构造函数
+  ///  @param[in]   io_handle   接受器所在的io句柄
+  explicit TcpServerAcceptor(IoHandle &io_handle)
+      : io_handle(io_handle),
+        acceptor(io_handle.GetIoContext()),
+        timer(io_handle.GetIoContext()) {}
+
+  IoHandle &io_handle;               ///< 所在io句柄
+  asio::ip::tcp::acceptor acceptor;  ///< 接受者
+  asio::steady_timer timer;          ///< 用来处理接受者异常定时器
+  HandlerMemory<> allocator;         ///< 接受用的内存分配
+};
+
 /// 网络层tcp服务器基类
 ///  @tparam  Derived     tcp服务器子类
 ///  @tparam  SessionType 网络层会话类型
@@ -59,11 +106,12 @@ class TcpServerBase : public ServerBase<Derived, SessionType> {
       size_t buffer_max       = (std::numeric_limits<size_t>::max)(),
       size_t buffer_prepare   = kTcpFrameSize)
       : Super(concurrency_hint),
-        acceptor_(this->io_handle_.GetIoContext()),
-        acceptor_timer_(this->io_handle_.GetIoContext()),
         counter_timer_(this->io_handle_.GetIoContext()),
         buffer_max_(buffer_max),
-        buffer_prepare_(buffer_prepare) {}
+        buffer_prepare_(buffer_prepare) {
+    this->acceptors_.emplace_back(
+        std::make_shared<TcpServerAcceptor>(this->io_handle_));
+  }
 
   /// 析构函数
   ~TcpServerBase() { this->Stop(); }
@@ -103,17 +151,37 @@ class TcpServerBase : public ServerBase<Derived, SessionType> {
   /// 服务器是否启动
   ///  @return 启动返回true
   TPN_INLINE bool IsStarted() {
-    return (Super::IsStarted() && this->acceptor_.is_open());
+    return (Super::IsStarted() && this->GetAcceptor().is_open());
   }
 
   /// 服务器是否关闭
   ///  @return 关闭返回true
   TPN_INLINE bool IsStopped() {
-    return (Super::IsStopped() && this->acceptor_.is_open());
+    return (Super::IsStopped() && this->GetAcceptor().is_open());
+  }
+
+  /// 获取接受器，开启端口复用时返回第一个io线程上的接受器
+  TPN_INLINE asio::ip::tcp::acceptor &GetAcceptor() {
+    return this->acceptors_.front()->acceptor;
   }
 
-  /// 获取接受器
-  TPN_INLINE asio::ip::tcp::acceptor &GetAcceptor() { return this->acceptor_; }
+  /// 获取接受器数量
+  ///  @return 接受器数量
+  TPN_INLINE size_t GetAcceptorCount() const { return this->acceptors_.size(); }
+
+  /// 设置监听选项，需要在启动前设置
+  ///  @param[in]   options   监听选项
+  ///  @return CRTP调用链对象
+  TPN_INLINE Derived &SetServerOptions(const TcpServerOptions &options) {
+    this->options_ = options;
+    return this->GetDerivedObj();
+  }
+
+  /// 获取监听选项
+  ///  @return 监听选项
+  TPN_INLINE const TcpServerOptions &GetServerOptions() const {
+    return this->options_;
+  }
 
  protected:
   /// tcp服务器执行开始
@@ -170,7 +238,7 @@ class TcpServerBase : public ServerBase<Derived, SessionType> {
             });
           });
 
-      this->acceptor_.close(s_ec_ignore);
+      this->CloseAcceptors();
 
       std::string h = ToString(std::forward<String>(host));
       std::string p = ToString(std::forward<StrOrInt>(service));
@@ -187,22 +255,53 @@ class TcpServerBase : public ServerBase<Derived, SessionType> {
       NET_DEBUG("TcpServerBase {}:{} resolver {}:{}", h, p,
                 endpoint.address().to_string(), endpoint.port());
 
-      // 接收器开启
-      this->acceptor_.open(endpoint.protocol());
+      // 开启端口复用时每个io线程一个接受器
+      size_t acceptor_count = 1;
+#if defined(SO_REUSEPORT)
+      if (this->options_.reuse_port) {
+        acceptor_count = this->GetIoPoolSize();
+      }
+#endif
+      for (size_t i = 1; i < acceptor_count; ++i) {
+        this->acceptors_.emplace_back(
+            std::make_shared<TcpServerAcceptor>(this->GetIoHandleByIndex(i)));
+      }
 
-      // 当您在linux系统中关闭套接字并立即启动套接字时，您将得到如下所示的“地址正在使用”，
-      // 并且绑定失败，但是我很抱歉，我之前已经正确地关闭了套接字，为什么会这样？
-      // 原因是套接字选项“ TIME_WAIT”，尽管您关闭了套接字，但是系统没有释放套接字，
-      // 直到2到4秒后才释放套接字，所以我们可以使用SO_REUSEADDR选项来避免此问题，如下所示
-      this->acceptor_.set_option(asio::ip::tcp::acceptor::reuse_address(true));
+      for (auto &acceptor_sptr : this->acceptors_) {
+        auto &acceptor = acceptor_sptr->acceptor;
+
+        // 接收器开启
+        acceptor.open(endpoint.protocol());
+
+        // 当您在linux系统中关闭套接字并立即启动套接字时，您将得到如下所示的“地址正在使用”，
+        // 并且绑定失败，但是我很抱歉，我之前已经正确地关闭了套接字，为什么会这样？
+        // 原因是套接字选项“ TIME_WAIT”，尽管您关闭了套接字，但是系统没有释放套接字，
+        // 直到2到4秒后才释放套接字，所以我们可以使用SO_REUSEADDR选项来避免此问题，如下所示
+        acceptor.set_option(asio::ip::tcp::acceptor::reuse_address(true));
+
+#if defined(SO_REUSEPORT)
+        if (acceptor_count > 1) {
+          acceptor.set_option(
+              asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(
+                  true));
+        }
+#endif
+
+        // 批量接受时用非阻塞的同步接受取走已经完成握手的连接
+        if (this->options_.accept_batch > 1) {
+          acceptor.non_blocking(true);
+        }
+      }
 
       // 通知启动成功
       this->GetDerivedObj().FireInit();
 
-      // 绑定端口
-      this->acceptor_.bind(endpoint);
-      // 监听
-      this->acceptor_.listen();
+      for (auto &acceptor_sptr : this->acceptors_) {
+        // 绑定端口
+        acceptor_sptr->acceptor.bind(endpoint);
+        // 监听
+        acceptor_sptr->acceptor.listen(this->options_.backlog);
+      }
 
       NET_DEBUG("TcpServerBase DoStart HandleStart");
       this->GetDerivedObj().HandleStart(std::error_code{});
@@ -248,8 +347,12 @@ class TcpServerBase : public ServerBase<Derived, SessionType> {
       asio::detail::throw_error(ec);
 
       NET_DEBUG("TcpServerBase HandleStart PostWrap PostAccept");
-      this->GetDerivedObj().Post(
-          [this]() mutable { this->GetDerivedObj().PostAccept(); });
+      for (auto &acceptor_sptr : this->acceptors_) {
+        asio::post(acceptor_sptr->io_handle.GetStrand(),
+                   [this, acceptor_sptr]() mutable {
+                     this->GetDerivedObj().PostAccept(*acceptor_sptr);
+                   });
+      }
     } catch (std::system_error &e) {
       NET_ERROR("TcpServerBase HandleStart error {} state {}", e.code(),
                 ToNetStateStr(this->state_));
@@ -335,7 +438,6 @@ class TcpServerBase : public ServerBase<Derived, SessionType> {
     // 通知停止
     this->GetDerivedObj().FireStop(ec);
 
-    this->acceptor_timer_.cancel(s_ec_ignore);
     this->counter_timer_.cancel(s_ec_ignore);
 
     // 调用父类的关闭程序
@@ -344,23 +446,44 @@ class TcpServerBase : public ServerBase<Derived, SessionType> {
     // 调用acceptor的close函数通知HandleAccept函数响应error > 0，
     // 那么监听socket可以得到通知退出必须保证close函数已经被调用，
     // 否则_handle_accept永远不会返回
-    this->acceptor_.close(s_ec_ignore);
+    // 其他io线程上的接受器要在各自的strand上关闭，
+    // 关闭前可能重新启动并收缩接受器列表，故持有共享指针
+    for (auto &acceptor_sptr : this->acceptors_) {
+      asio::dispatch(acceptor_sptr->io_handle.GetStrand(), [acceptor_sptr]() {
+        acceptor_sptr->timer.cancel(s_ec_ignore);
+        acceptor_sptr->acceptor.close(s_ec_ignore);
+      });
+    }
+  }
+
+  /// 关闭所有接受器，只保留第一个io线程上的接受器
+  /// 只在启动时调用，移除的接受器由尚未执行的处理函数持有到结束
+  TPN_INLINE void CloseAcceptors() {
+    this->acceptors_.resize(1);
+    this->acceptors_.front()->acceptor.close(s_ec_ignore);
   }
 
   /// 创造一个tcp会话
+  /// 会话对象从所分配io句柄的会话内存池申请，断开后内存归还该池供下一次接受复用
   ///  @tapram      Args        会话子类所需额外参数预留类型
   ///  @param[in]   args...     会话子类所需额外参数预留
   template <typename... Args>
   TPN_INLINE std::shared_ptr<SessionType> MakeSession(Args &&...args) {
+    IoHandle &io_handle = accept_io_handle_ ? *accept_io_handle_
+                                            : this->GetIoHandleByIndex();
     NET_DEBUG("TcpServerBase MakeSession state {}",
               ToNetStateStr(this->state_));
-    return std::make_shared<SessionType>(
-        std::forward<Args>(args)..., this->GetIoHandleByIndex(),
-        this->session_mgr_, this->buffer_max_, this->buffer_prepare_);
+    return std::allocate_shared<SessionType>(
+        SessionPoolAllocator<SessionType>(io_handle.GetSessionPool()),
+        std::forward<Args>(args)..., io_handle, this->session_mgr_,
+        this->buffer_max_, this->buffer_prepare_);
   }
 
   /// 提交接受
-  TPN_INLINE void PostAccept() {
+  ///  @param[in]   acceptor      接受器
+  ///  @param[in]   session_sptr  上次批量接受剩下的会话，为空时新建
+  TPN_INLINE void PostAccept(TcpServerAcceptor &acceptor,
+                             std::shared_ptr<SessionType> session_sptr = {}) {
     NET_DEBUG("TcpServerBase PostAccept state {}", ToNetStateStr(this->state_));
 
     if (!this->IsStarted()) {
@@ -370,49 +493,58 @@ class TcpServerBase : public ServerBase<Derived, SessionType> {
     }
 
     try {
-      std::shared_ptr<SessionType> session_sptr =
-          this->GetDerivedObj().MakeSession();
+      if (!session_sptr) {
+        session_sptr = this->MakeAcceptSession(acceptor);
+      }
 
       NET_DEBUG("TcpServerBase PostAccept new session {}",
                 session_sptr->GetHashKey());
 
       auto &socket = session_sptr->GetSocket().lowest_layer();
-      this->acceptor_.async_accept(
-          socket, asio::bind_executor(
-                      this->io_handle_.GetStrand(),
-                      MakeAllocator(this->rallocator_,
-                                    [this, sptr = std::move(session_sptr)](
-                                        const std::error_code &ec) mutable {
-                                      this->GetDerivedObj().HandleAccept(
-                                          ec, std::move(sptr));
-                                    })));
+      acceptor.acceptor.async_accept(
+          socket,
+          asio::bind_executor(
+              acceptor.io_handle.GetStrand(),
+              MakeAllocator(acceptor.allocator,
+                            [this, acceptor_sptr = acceptor.shared_from_this(),
+                             sptr = std::move(session_sptr)](
+                                const std::error_code &ec) mutable {
+                              this->GetDerivedObj().HandleAccept(
+                                  *acceptor_sptr, ec, std::move(sptr));
+                            })));
     } catch (std::system_error &e) {
       NET_ERROR("TcpServerBase PostAccept error {}", e.code());
 
       SetLastError(e);
 
-      this->acceptor_timer_.expires_after(Seconds(1));
-      this->acceptor_timer_.async_wait(asio::bind_executor(
-          this->io_handle_.GetStrand(),
+      acceptor.timer.expires_after(Seconds(1));
+      acceptor.timer.async_wait(asio::bind_executor(
+          acceptor.io_handle.GetStrand(),
           MakeAllocator(
-              this->rallocator_, [this](const std::error_code &ec) mutable {
+              acceptor.allocator,
+              [this, acceptor_sptr = acceptor.shared_from_this()](
+                  const std::error_code &ec) mutable {
                 SetLastError(ec);
                 if (ec) {
                   NET_ERROR("TcpServerBase PostAccept async_wait error {}", ec);
                   return;
                 }
-                asio::post(this->io_handle_.GetStrand(),
-                           MakeAllocator(this->rallocator_, [this]() mutable {
-                             this->GetDerivedObj().PostAccept();
-                           }));
+                asio::post(acceptor_sptr->io_handle.GetStrand(),
+                           MakeAllocator(acceptor_sptr->allocator,
+                                         [this, acceptor_sptr]() mutable {
+                                           this->GetDerivedObj().PostAccept(
+                                               *acceptor_sptr);
+                                         }));
               })));
     }
   }
 
   /// tcp服务器处理接收
+  ///  @param[in]   acceptor      接受器
   ///  @param[in]   ec            错误码
   ///  @param[in]   session_sptr  网络会话
-  TPN_INLINE void HandleAccept(const std::error_code &ec,
+  TPN_INLINE void HandleAccept(TcpServerAcceptor &acceptor,
+                               const std::error_code &ec,
                                std::shared_ptr<SessionType> session_sptr) {
     NET_DEBUG("TcpServerBase HandleAccept error {} state {} session {} {}", ec,
               ToNetStateStr(this->state_), session_sptr->GetHashKey(),
@@ -427,19 +559,88 @@ class TcpServerBase : public ServerBase<Derived, SessionType> {
     }
 
     if (!ec) {
-      if (this->IsStarted()) {
-        NET_DEBUG("TcpServerBase HandleAccept session {} start {}",
-                  session_sptr->GetHashKey(),
-                  ToNetStateStr(session_sptr->GetNetState()));
-        session_sptr->counter_sptr_ = this->counter_sptr_;
-        session_sptr->Start();
+      this->StartAcceptSession(session_sptr);
+      session_sptr.reset();
+
+      // 批量接受：继续用非阻塞的同步接受取走已经完成握手的连接，
+      // 取不到时剩下的会话留给下一次异步接受
+      for (size_t i = 1; i < this->options_.accept_batch; ++i) {
+        session_sptr = this->MakeAcceptSession(acceptor);
+
+        std::error_code accept_ec;
+        acceptor.acceptor.accept(session_sptr->GetSocket().lowest_layer(),
+                                 accept_ec);
+        if (accept_ec) {
+          break;
+        }
+
+        this->StartAcceptSession(session_sptr);
+        session_sptr.reset();
       }
+    } else {
+      session_sptr.reset();
     }
 
-    NET_DEBUG("TcpServerBase HandleAccept error {} state {} session {} {}", ec,
-              ToNetStateStr(this->state_), session_sptr->GetHashKey(),
+    NET_DEBUG("TcpServerBase HandleAccept error {} state {}", ec,
+              ToNetStateStr(this->state_));
+    this->GetDerivedObj().PostAccept(acceptor, std::move(session_sptr));
+  }
+
+  /// 为接受器创造一个会话
+  /// 只有一个接受器时按轮询分配io句柄，每个io线程一个接受器时留在接受器所在的io句柄
+  ///  @param[in]   acceptor      接受器
+  ///  @return 网络会话
+  TPN_INLINE std::shared_ptr<SessionType> MakeAcceptSession(
+      TcpServerAcceptor &acceptor) {
+    if (1 == this->acceptors_.size()) {
+      return this->GetDerivedObj().MakeSession();
+    }
+
+    // 经由子类的MakeSession创造，使子类追加的构造参数依然生效
+    accept_io_handle_ = &acceptor.io_handle;
+    auto session_sptr = this->GetDerivedObj().MakeSession();
+    accept_io_handle_ = nullptr;
+    return session_sptr;
+  }
+
+  /// 设置接受的套接字选项并启动会话
+  ///  @param[in]   session_sptr  网络会话
+  TPN_INLINE void StartAcceptSession(
+      const std::shared_ptr<SessionType> &session_sptr) {
+    if (!this->IsStarted()) {
+      return;
+    }
+
+    NET_DEBUG("TcpServerBase HandleAccept session {} start {}",
+              session_sptr->GetHashKey(),
               ToNetStateStr(session_sptr->GetNetState()));
-    this->GetDerivedObj().PostAccept();
+
+    if (this->options_.no_delay) {
+      session_sptr->SetNoDelay(true);
+    }
+    if (this->options_.send_buffer_size > 0) {
+      session_sptr->SetSendBufferSize(this->options_.send_buffer_size);
+    }
+    if (this->options_.receive_buffer_size > 0) {
+      session_sptr->SetReceiveBufferSize(this->options_.receive_buffer_size);
+    }
+#if defined(TCP_QUICKACK)
+    if (this->options_.quick_ack) {
+      session_sptr->GetSocket().lowest_layer().set_option(
+          asio::detail::socket_option::boolean<IPPROTO_TCP, TCP_QUICKACK>(true),
+          s_ec_ignore);
+    }
+#endif
+    if (this->options_.compress) {
+      session_sptr->SetCompressOptions(this->options_.compress);
+    }
+    if (this->options_.batch.max_messages > 1) {
+      session_sptr->SetBatchOptions(this->options_.batch);
+    }
+    session_sptr->SetSendQueueOptions(this->options_.send_queue);
+
+    session_sptr->counter_sptr_ = this->counter_sptr_;
+    session_sptr->Start();
   }
 
   /// tcp服务器初始化通知
@@ -454,11 +655,15 @@ class TcpServerBase : public ServerBase<Derived, SessionType> {
   TPN_INLINE [[maybe_unused]] void FireStop(std::error_code ec) {}
 
  protected:
-  asio::ip::tcp::acceptor acceptor_;   ///< 接受者
-  asio::steady_timer acceptor_timer_;  ///< 用来处理接受者异常定时器
+  std::vector<std::shared_ptr<TcpServerAcceptor>>
+      acceptors_;                      ///< 接受者，开启端口复用时每个io线程一个
+  TcpServerOptions options_;           ///< 监听选项
   asio::steady_timer counter_timer_;  ///< 确保持有的io_handle直到所有的会话关闭
   size_t buffer_max_{(std::numeric_limits<size_t>::max)()};  ///< 缓冲区最大值
   size_t buffer_prepare_{kTcpFrameSize};  ///< 缓冲区初始大小
+
+  /// 正在接受的io句柄，每个接受器在各自io线程上创造会话，故按线程保存
+  static inline thread_local IoHandle *accept_io_handle_ = nullptr;
 };
 
 /// tcp服务器桥梁
@@ -27,9 +27,12 @@
 #include "rpc_type.pb.h"
 #include "net_common.h"
 #include "session.h"
+#include "tcp_batch.h"
+#include "tcp_compress.h"
 #include "tcp_keepalive.h"
 #include "tcp_recv.h"
 #include "tcp_send_wrap.h"
+#include "coroutine_wrap.h"
 
 namespace tpn {
 
@@ -46,7 +49,7 @@ struct TemplateArgsTcpSession {
   static constexpr bool is_client  = false;
 
   using socket_type = asio::ip::tcp::socket;
-  using buffer_type = asio::streambuf;
+  using buffer_type = asio::basic_streambuf<SessionPoolAllocator<char>>;
 };
 
 /// tcp网络会话基类
@@ -56,7 +59,10 @@ template <typename Derived, typename ArgsType>
 class TcpSessionBase : public SessionBase<Derived, ArgsType>,
                        public TcpKeepAlive<Derived, ArgsType>,
                        public TcpRecv<Derived, ArgsType>,
-                       public TcpSendWrap<Derived, ArgsType> {
+                       public TcpSendWrap<Derived, ArgsType>,
+                       public TcpCompress<Derived, ArgsType>,
+                       public TcpBatch<Derived, ArgsType>,
+                       public CoroutineWrap<Derived, ArgsType> {
   TPN_NET_FRIEND_DECL_BASE_CLASS
   TPN_NET_FRIEND_DECL_TCP_BASE_CLASS
   TPN_NET_FRIEND_DECL_TCP_SERVER_CLASS
@@ -83,6 +89,9 @@ class TcpSessionBase : public SessionBase<Derived, ArgsType>,
         TcpKeepAlive<Derived, ArgsType>(this->socket_),
         TcpRecv<Derived, ArgsType>(),
         TcpSendWrap<Derived, ArgsType>(),
+        TcpCompress<Derived, ArgsType>(),
+        TcpBatch<Derived, ArgsType>(),
+        CoroutineWrap<Derived, ArgsType>(),
         rallocator_(),
         wallocator_() {
     this->SetSilenceTimeoutDuration(MilliSeconds(kTcpSilenceTimeout));
@@ -268,6 +277,9 @@ class TcpSessionBase : public SessionBase<Derived, ArgsType>,
               ToNetStateStr(this->state_), this->GetHashKey(), ec);
     IgnoreUnused(ec, this_ptr);
 
+    // 等待中的协程操作以断开的错误码完成
+    this->CoroutineAbort(ec);
+
     this->GetDerivedObj().DoStop(ec);
   }
 
@@ -277,11 +289,11 @@ class TcpSessionBase : public SessionBase<Derived, ArgsType>,
   ///  @param[in]   callback  发送数据回调
   ///  @return 发送成功返回true
   template <typename Callback>
-  TPN_INLINE bool DoSend(MessageBuffer &&buffer, Callback &&callback) {
+  TPN_INLINE bool DoSend(const MessageBuffer &buffer, Callback &&callback) {
     NET_DEBUG("TcpSessionBase DoSend state {} key {}",
               ToNetStateStr(this->state_), this->GetHashKey());
 
-    return this->GetDerivedObj().TcpSend(std::move(buffer),
+    return this->GetDerivedObj().TcpSend(buffer,
                                          std::forward<Callback>(callback));
   }
 
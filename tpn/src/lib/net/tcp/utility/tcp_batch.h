@@ -0,0 +1,238 @@
+//
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_TCP_UTILITY_TCP_BATCH_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_NET_TCP_UTILITY_TCP_BATCH_H_
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "byte_converter.h"
+#include "message_buffer.h"
+#include "net_common.h"
+#include "rpc_type.pb.h"
+
+namespace tpn {
+
+namespace net {
+
+/// 帧合批参数
+struct FrameBatchOptions {
+  /// 每帧最多合并的消息数，达到后立即发送，不大于1时不合批
+  size_t max_messages{0};
+  /// 合批帧包体的最大长度，加入下一条消息会超过时先发送已合批的消息
+  size_t max_bytes{kFrameBatchMaxBytes};
+  /// 为true时第一条消息入批后向strand投递一次刷新，
+  /// 同一轮事件处理中产生的消息合为一帧；
+  /// 为false时由调用者在逻辑帧结束时调用FlushBatch
+  bool auto_flush{true};
+};
+
+/// tcp帧合批
+/// 多个完整的帧拼接为一个设置了 kHeaderFlagBatch 的帧发送，
+/// 接收方在一次处理中拆出每个帧并逐个通知会话。
+/// 合批帧整体经过发送路径，开启压缩时压缩的是整个合批包体。
+/// 合批中只有一条消息时原样发送，不增加包头开销。
+///  @tparam  Derived
+///  @tparam  ArgsType
+template <typename Derived, typename ArgsType = void>
+class TcpBatch {
+ public:
+  TcpBatch()  = default;
+  ~TcpBatch() = default;
+
+  /// 设置帧合批参数，需要在会话启动前设置
+  ///  @param[in]   options   合批参数
+  ///  @return CRTP调用链对象
+  TPN_INLINE Derived &SetBatchOptions(const FrameBatchOptions &options) {
+    std::lock_guard<std::mutex> lock(this->batch_mutex_);
+    this->batch_options_ = options;
+    return CRTP_CAST(this);
+  }
+
+  /// 获取帧合批参数
+  ///  @return 合批参数
+  TPN_INLINE const FrameBatchOptions &GetBatchOptions() const {
+    return this->batch_options_;
+  }
+
+  /// 合批发送一个完整的帧
+  /// 可以在任意线程调用，与Send混用时合批中的帧在刷新时才进入发送队列
+  ///  @param[in]   frame     调用需要保证frame满足底层拆包逻辑
+  ///  @return 成功加入合批或发送返回true
+  TPN_INLINE bool SendBatched(MessageBuffer &&frame) {
+    Derived &derive = CRTP_CAST(this);
+
+    std::lock_guard<std::mutex> lock(this->batch_mutex_);
+    if (this->batch_options_.max_messages <= 1) {
+      this->batch_frames_sent_.fetch_add(1, std::memory_order_relaxed);
+      return derive.Send(std::move(frame));
+    }
+
+    size_t size = frame.GetBufferSize();
+    if (!this->batch_frames_.empty() &&
+        (this->batch_bytes_ + size > this->batch_options_.max_bytes)) {
+      FlushBatchLocked();
+    }
+
+    this->batch_frames_.emplace_back(std::move(frame));
+    this->batch_bytes_ += size;
+    if (this->batch_frames_.size() >= this->batch_options_.max_messages) {
+      return FlushBatchLocked();
+    }
+
+    if (this->batch_options_.auto_flush && !this->batch_flush_posted_) {
+      this->batch_flush_posted_ = true;
+      derive.Post([this, self_ptr = derive.GetSelfSptr()]() {
+        std::lock_guard<std::mutex> lock(this->batch_mutex_);
+        this->batch_flush_posted_ = false;
+        FlushBatchLocked();
+      });
+    }
+    return true;
+  }
+
+  /// 发送合批中的所有帧
+  /// 逻辑帧结束时调用
+  ///  @return 没有待发送的帧或发送成功返回true
+  TPN_INLINE bool FlushBatch() {
+    std::lock_guard<std::mutex> lock(this->batch_mutex_);
+    return FlushBatchLocked();
+  }
+
+  /// 获取经合批路径发出的帧数
+  ///  @return 帧数，一个合批帧计为一帧
+  TPN_INLINE size_t GetBatchFramesSent() const {
+    return this->batch_frames_sent_.load(std::memory_order_relaxed);
+  }
+
+ protected:
+  /// 拆分合批帧的包体并逐个通知会话
+  /// 帧不允许嵌套合批，也不允许单独压缩
+  ///  @param[in]   this_ptr    延长生命周期句柄
+  ///  @param[in]   data        合批帧包体
+  ///  @param[in]   size        合批帧包体长度
+  ///  @return 格式正确返回true
+  TPN_INLINE bool TcpFireBatch(std::shared_ptr<Derived> &this_ptr,
+                               const uint8_t *data, size_t size) {
+    Derived &derive = CRTP_CAST(this);
+
+    protocol::Header header;
+    size_t pos = 0;
+    while (pos < size) {
+      if (size - pos < kHeaderBytes) [[unlikely]] {
+        return false;
+      }
+
+      uint16_t header_length = 0;
+      std::memcpy(&header_length, data + pos, kHeaderBytes);
+      tpn::EndianRefMakeLittle(header_length);
+      pos += kHeaderBytes;
+      if ((0 == header_length) || (header_length > size - pos)) [[unlikely]] {
+        return false;
+      }
+
+      if (!header.ParseFromArray(data + pos, header_length)) [[unlikely]] {
+        return false;
+      }
+      pos += header_length;
+
+      if ((header.flags() & (kHeaderFlagBatch | kHeaderFlagCompressed)) ||
+          (header.size() > size - pos)) [[unlikely]] {
+        return false;
+      }
+
+      MessageBuffer packet(header.size());
+      if (header.size() > 0) {
+        packet.Write(data + pos, header.size());
+      }
+      pos += header.size();
+
+      derive.CoroutineRecv(this_ptr, std::move(header), std::move(packet));
+
+      // 会话可能在回调中被关闭
+      if (!derive.IsStarted()) {
+        break;
+      }
+    }
+    return true;
+  }
+
+ private:
+  /// 发送合批中的所有帧，需要持有锁
+  /// 在锁内进入发送队列，保证多个线程刷新时帧的顺序
+  ///  @return 没有待发送的帧或发送成功返回true
+  bool FlushBatchLocked() {
+    Derived &derive = CRTP_CAST(this);
+
+    if (this->batch_frames_.empty()) {
+      return true;
+    }
+
+    this->batch_frames_sent_.fetch_add(1, std::memory_order_relaxed);
+
+    bool result = false;
+    if (1 == this->batch_frames_.size()) {
+      result = derive.Send(std::move(this->batch_frames_.front()));
+    } else {
+      this->batch_header_.set_flags(kHeaderFlagBatch);
+      this->batch_header_.set_size(static_cast<uint32_t>(this->batch_bytes_));
+
+      uint16_t header_length =
+          static_cast<uint16_t>(this->batch_header_.ByteSizeLong());
+      uint16_t header_bytes = header_length;
+      tpn::EndianRefMakeLittle(header_bytes);
+
+      MessageBuffer frame(kHeaderBytes + header_length + this->batch_bytes_);
+      frame.Write(&header_bytes, kHeaderBytes);
+      this->batch_header_.SerializeWithCachedSizesToArray(
+          frame.GetWritePointer());
+      frame.WriteCompleted(header_length);
+      for (const auto &batch_frame : this->batch_frames_) {
+        frame.Write(batch_frame.GetBasePointer(),
+                    batch_frame.GetBufferSize());
+      }
+      result = derive.Send(std::move(frame));
+    }
+
+    this->batch_frames_.clear();
+    this->batch_bytes_ = 0;
+    return result;
+  }
+
+ protected:
+  FrameBatchOptions batch_options_;           ///< 合批参数
+  std::mutex batch_mutex_;                    ///< 合批锁
+  std::vector<MessageBuffer> batch_frames_;   ///< 待发送的帧
+  size_t batch_bytes_{0};                     ///< 待发送的帧总长度
+  bool batch_flush_posted_{false};            ///< 是否已投递刷新
+  protocol::Header batch_header_;             ///< 合批帧包头
+  std::atomic<size_t> batch_frames_sent_{0};  ///< 经合批路径发出的帧数
+};
+
+}  // namespace net
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_NET_TCP_UTILITY_TCP_BATCH_H_
@@ -0,0 +1,121 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_TCP_UTILITY_TCP_COMPRESS_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_NET_TCP_UTILITY_TCP_COMPRESS_H_
+
+#include "message_buffer.h"
+#include "net_common.h"
+#include "frame_codec.h"
+
+namespace tpn {
+
+namespace net {
+
+/// tcp帧压缩
+/// 编解码器在第一次压缩或收到压缩帧时才创建，不使用压缩的会话没有额外开销
+///  @tparam  Derived
+///  @tparam  ArgsType
+template <typename Derived, typename ArgsType = void>
+class TcpCompress {
+ public:
+  TcpCompress()  = default;
+  ~TcpCompress() = default;
+
+  /// 设置帧压缩参数，需要在会话启动前设置
+  ///  @param[in]   options   压缩参数
+  ///  @return CRTP调用链对象
+  TPN_INLINE Derived &SetCompressOptions(
+      std::shared_ptr<const FrameCompressOptions> options) {
+    this->compress_options_ = std::move(options);
+    this->frame_codec_.reset();
+    return CRTP_CAST(this);
+  }
+
+  /// 获取帧压缩参数
+  ///  @return 压缩参数，未设置时为空
+  TPN_INLINE const std::shared_ptr<const FrameCompressOptions> &
+  GetCompressOptions() const {
+    return this->compress_options_;
+  }
+
+ protected:
+  /// 发送前压缩帧
+  /// 发送队列保证同一时间只有一个写操作，压缩缓冲可以在帧之间复用
+  ///  @param[in]   frame     原始帧
+  ///  @return 实际需要发送的帧，不压缩时返回原始帧
+  TPN_INLINE const MessageBuffer &TcpCompressFrame(const MessageBuffer &frame) {
+    if (!this->compress_options_ || !this->compress_options_->enable ||
+        (frame.GetBufferSize() < this->compress_options_->threshold)) {
+      return frame;
+    }
+
+    if (GetFrameCodec().CompressFrame(frame.GetBasePointer(),
+                                      frame.GetBufferSize(),
+                                      this->compress_buffer_)) {
+      return this->compress_buffer_;
+    }
+    return frame;
+  }
+
+  /// 接收后解压包体
+  /// 没有设置压缩参数的会话不接受压缩帧
+  ///  @param[in]   header    包头，成功后清除压缩标志
+  ///  @param[in]   data      压缩的包体
+  ///  @param[in]   size      压缩的包体长度
+  ///  @param[out]  packet    解压后的包体
+  ///  @return 成功返回true
+  TPN_INLINE bool TcpDecompressPacket(protocol::Header &header,
+                                      const uint8_t *data, size_t size,
+                                      MessageBuffer &packet) {
+    Derived &derive = CRTP_CAST(this);
+
+    if (!this->compress_options_) {
+      return false;
+    }
+
+    return GetFrameCodec().DecompressPacket(
+        header, data, size, derive.GetBuffer().max_size(), packet);
+  }
+
+ private:
+  /// 获取编解码器
+  TPN_INLINE FrameCodec &GetFrameCodec() {
+    if (!this->frame_codec_) {
+      this->frame_codec_ =
+          std::make_unique<FrameCodec>(this->compress_options_);
+    }
+    return *this->frame_codec_;
+  }
+
+ protected:
+  std::shared_ptr<const FrameCompressOptions>
+      compress_options_;                     ///< 压缩参数
+  std::unique_ptr<FrameCodec> frame_codec_;  ///< 编解码器
+  MessageBuffer compress_buffer_{0};         ///< 压缩后的帧
+};
+
+}  // namespace net
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_NET_TCP_UTILITY_TCP_COMPRESS_H_
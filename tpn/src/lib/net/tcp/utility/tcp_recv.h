@@ -107,9 +107,11 @@ class TcpRecv {
     if (!ec) {
       // 更新收到包的时间
       derive.UpdateAliveTime();
+      derive.GetIoHandle().GetLoad().AddBytes(bytes_recvd);
 
       protocol::Header header;
-      MessageBuffer packet;
+      MessageBuffer packet(0);
+      bool fired = false;
 
       do {
         const uint8_t *buffer =
@@ -152,13 +154,53 @@ class TcpRecv {
           return;
         }
 
+        // 压缩的包体直接解压到packet
+        if (header.flags() & kHeaderFlagCompressed) {
+          if (!derive.TcpDecompressPacket(
+                  header, buffer + kHeaderBytes + header_length,
+                  header.size(), packet)) [[unlikely]] {
+            NET_ERROR(
+                "TcpRecv TcpHandleRecv decompress packet_length {} "
+                "raw_size {} error",
+                header.size(), header.raw_size());
+            derive.DoDisconnect(asio::error::message_size);
+            return;
+          }
+          break;
+        }
+
+        // 未压缩的合批帧直接在接收缓冲中拆分，不拷贝包体
+        if (header.flags() & kHeaderFlagBatch) {
+          if (!derive.TcpFireBatch(this_ptr,
+                                   buffer + kHeaderBytes + header_length,
+                                   header.size())) [[unlikely]] {
+            NET_ERROR("TcpRecv TcpHandleRecv batch packet_length {} error",
+                      header.size());
+            derive.DoDisconnect(asio::error::message_size);
+            return;
+          }
+          fired = true;
+          break;
+        }
+
         packet.Resize(header.size());
         packet.Reset();
         packet.Write(buffer + kHeaderBytes + header_length, header.size());
       } while (0);
 
-      // 通知会话拆包后的数据
-      derive.FireRecv(this_ptr, std::move(header), std::move(packet));
+      if (!fired && (header.flags() & kHeaderFlagBatch)) {
+        // 解压后的合批帧
+        if (!derive.TcpFireBatch(this_ptr, packet.GetReadPointer(),
+                                 packet.GetActiveSize())) [[unlikely]] {
+          NET_ERROR("TcpRecv TcpHandleRecv batch packet_length {} error",
+                    packet.GetActiveSize());
+          derive.DoDisconnect(asio::error::message_size);
+          return;
+        }
+      } else if (!fired) {
+        // 通知会话拆包后的数据，等待中的协程优先
+        derive.CoroutineRecv(this_ptr, std::move(header), std::move(packet));
+      }
 
       // asio缓冲区中将数据移除
       derive.GetBuffer().consume(bytes_recvd);
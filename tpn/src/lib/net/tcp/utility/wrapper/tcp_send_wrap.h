@@ -47,12 +47,15 @@ class TcpSendWrap {
   ///  @param[in]   callback  发送数据回调
   ///  @return 发送成功返回true
   template <typename Callback>
-  TPN_INLINE bool TcpSend(MessageBuffer &&buffer, Callback &&callback) {
+  TPN_INLINE bool TcpSend(const MessageBuffer &buffer, Callback &&callback) {
     Derived &derive = CRTP_CAST(this);
 
+    // 压缩后的帧由会话持有，写完成前不会被下一帧覆盖
+    const MessageBuffer &frame = derive.TcpCompressFrame(buffer);
+
     asio::async_write(
         derive.GetStream(),
-        asio::buffer(buffer.GetBasePointer(), buffer.GetBufferSize()),
+        asio::buffer(frame.GetBasePointer(), frame.GetBufferSize()),
         asio::bind_executor(
             derive.GetIoHandle().GetStrand(),
             MakeAllocator(
@@ -65,6 +68,7 @@ class TcpSendWrap {
                       "{}",
                       ec, bytes_sent);
                   SetLastError(ec);
+                  derive.GetIoHandle().GetLoad().AddBytes(bytes_sent);
 
                   callback(ec, bytes_sent);
 
@@ -0,0 +1,494 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UDP_CLIENT_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UDP_CLIENT_H_
+
+#include "message_buffer.h"
+#include "random_hub.h"
+#include "rpc_type.pb.h"
+#include "net_common.h"
+#include "client.h"
+#include "udp_batch.h"
+#include "kcp_stream.h"
+#include "udp_send_wrap.h"
+
+namespace tpn {
+
+namespace net {
+
+TPN_NET_FORWARD_DECL_BASE_CLASS
+TPN_NET_FORWARD_DECL_UDP_BASE_CLASS
+TPN_NET_FORWARD_DECL_UDP_CLIENT_CLASS
+
+/// udp握手请求重传间隔 200
+static constexpr long kUdpHandshakeInterval = 200;
+
+/// udp网络客户端模板参数
+struct TemplateArgsUdpClient {
+  static constexpr bool is_session = false;
+  static constexpr bool is_client  = true;
+
+  using socket_type = asio::ip::udp::socket;
+  using buffer_type = EmptyBuffer;
+};
+
+/// udp网络客户端基类
+/// 套接字 connect 之后发送握手请求并定时重传，收到服务器分配的kcp会话编号后才算连接成功，
+/// 连接超时沿用 ConnectTimeoutTimer。
+///  @tparam  Derived     udp客户端子类
+///  @tparam  ArgsType    udp网络客户端模板参数
+template <typename Derived, typename ArgsType>
+class UdpClientBase : public ClientBase<Derived, ArgsType>,
+                      public KcpStream<Derived, ArgsType>,
+                      public UdpSendWrap<Derived, ArgsType> {
+  TPN_NET_FRIEND_DECL_BASE_CLASS
+  TPN_NET_FRIEND_DECL_UDP_BASE_CLASS
+  TPN_NET_FRIEND_DECL_UDP_CLIENT_CLASS
+
+ public:
+  using buffer_type = typename ArgsType::buffer_type;
+
+  using Super = ClientBase<Derived, ArgsType>;
+  using Self  = UdpClientBase<Derived, ArgsType>;
+
+  using Super::Send;
+
+  /// 构造函数
+  ///  @param[in]   buffer_max      缓冲区最大长度 默认无限制
+  ///  @param[in]   buffer_prepare  缓冲区准备长度 默认 @sa kUdpFrameSize
+  explicit UdpClientBase(
+      size_t buffer_max     = (std::numeric_limits<size_t>::max)(),
+      size_t buffer_prepare = kUdpFrameSize)
+      : Super(1, buffer_max, buffer_prepare),
+        KcpStream<Derived, ArgsType>(this->GetIoHandleByIndex(0)),
+        UdpSendWrap<Derived, ArgsType>(),
+        handshake_timer_(this->GetIoHandleByIndex(0).GetIoContext()),
+        recv_batch_(kUdpClientBatchSize) {
+    this->SetConnectTimeoutDuration(MilliSeconds(kUdpConnectTimeout));
+  };
+
+  /// 析构函数
+  ~UdpClientBase() { this->Stop(); }
+
+  /// 启动udp客户端
+  ///  @tparam      String      字符串
+  ///  @tparam      StrOrInt    字符串或整数
+  ///  @param[in]   host        标识地址的字符串。可以是描述性名称或数字地址字符串。
+  ///  @param[in]   service     标识请求的服务的字符串。
+  ///                           可以是描述性名称，也可以是与端口号相对应的数字字符串。
+  ///  @return 启动成功返回true
+  template <typename String, typename StrOrInt>
+  bool Start(String &&host, StrOrInt &&port) {
+    NET_DEBUG("UdpClientBase Start {}:{}", host, port);
+    return this->GetDerivedObj().template DoConnect<false>(
+        std::forward<String>(host), std::forward<StrOrInt>(port));
+  }
+
+  /// 异步启动udp客户端
+  ///  @tparam      String      字符串
+  ///  @tparam      StrOrInt    字符串或整数
+  ///  @param[in]   host        标识地址的字符串。可以是描述性名称或数字地址字符串。
+  ///  @param[in]   service     标识请求的服务的字符串。
+  ///                           可以是描述性名称，也可以是与端口号相对应的数字字符串。
+  ///  @return 启动成功返回true
+  template <typename String, typename StrOrInt>
+  bool AsyncStart(String &&host, StrOrInt &&port) {
+    NET_DEBUG("UdpClientBase async Start {}:{}", host, port);
+    return this->GetDerivedObj().template DoConnect<true>(
+        std::forward<String>(host), std::forward<StrOrInt>(port));
+  }
+
+  /// udp客户端关闭
+  TPN_INLINE void Stop() {
+    NET_DEBUG("UdpClientBase Stop");
+
+    this->GetDerivedObj().Post(
+        [this]() mutable { this->StopReconnectTimer(); });
+
+    this->GetDerivedObj().DoDisconnect(
+        asio::error::operation_aborted, std::make_shared<DeferWrap>([this]() {
+          NET_DEBUG("UdpClientBase Stop DoDisconnect DoStop");
+          this->GetDerivedObj().DoStop(asio::error::operation_aborted);
+        }));
+
+    this->IoPoolStop();
+  }
+
+ protected:
+  /// 启动udp客户端
+  ///  @tparam      IsAsync     异步启动为true
+  ///  @tparam      String      字符串
+  ///  @tparam      StrOrInt    字符串或整数
+  ///  @param[in]   host        标识地址的字符串。可以是描述性名称或数字地址字符串。
+  ///  @param[in]   service     标识请求的服务的字符串。
+  ///                           可以是描述性名称，也可以是与端口号相对应的数字字符串。
+  ///  @return 启动成功返回true
+  template <bool IsAsync, typename String, typename StrOrInt>
+  bool DoConnect(String &&host, StrOrInt &&port) {
+    NET_DEBUG("UdpClientBase DoConnect state {}", ToNetStateStr(this->state_));
+
+    NetState expected = NetState::kNetStateStopped;
+    if (!this->state_.compare_exchange_strong(expected,
+                                              NetState::kNetStateStarting)) {
+      NET_ERROR("UdpClientBase already starting state {}",
+                ToNetStateStr(this->state_));
+      SetLastError(asio::error::already_started);
+      return false;
+    }
+
+    try {
+      ClearLastError();
+
+      // 启动对象池
+      this->IoPoolStart();
+
+      if (this->IsIoPoolStopped()) {
+        NET_ERROR("UdpClientBase io_pool start error");
+        SetLastError(asio::error::shut_down);
+        return false;
+      }
+
+      // 加载重连定时器
+      this->GetDerivedObj().LoadReconnectTimer(host, port);
+
+      // 初始化
+      this->GetDerivedObj().DoInit();
+
+      // 基类启动
+      Super::Start();
+
+      return this->GetDerivedObj().template ClientStartConnect<IsAsync>(
+          std::forward<String>(host), std::forward<StrOrInt>(port),
+          this->GetSelfSptr());
+    } catch (std::system_error &e) {
+      NET_DEBUG("UdpClientBase DoConnect error {}", e.code());
+      this->GetDerivedObj().HandleConnect(e.code(),
+                                          this->GetDerivedObj().GetSelfSptr());
+    }
+
+    return false;
+  }
+
+  /// 初始化
+  TPN_INLINE void DoInit() { NET_DEBUG("UdpClientBase DoInit"); }
+
+  /// 处理连接
+  /// 本函数重写了connect模块的HandleConnect的方法，
+  /// 套接字 connect 成功后先进行kcp握手
+  ///  @param[in]   ec          错误码
+  ///  @param[in]   this_ptr    延长生命周期句柄
+  TPN_INLINE void HandleConnect(const std::error_code ec,
+                                std::shared_ptr<Derived> this_ptr) {
+    NET_DEBUG("UdpClientBase HandleConnect error {}", ec);
+
+    if (ec) {
+      Connect<Derived, ArgsType>::HandleConnect(ec, std::move(this_ptr));
+      return;
+    }
+
+    this->kcp_.reset();
+    this->conv_            = 0;
+    this->handshake_nonce_ = RandU32() | 1;
+
+    this->GetDerivedObj().PostRecv(this_ptr);
+    this->GetDerivedObj().PostHandshake(std::move(this_ptr));
+  }
+
+  /// 发送握手请求，直到收到回复或连接超时
+  ///  @param[in]   this_ptr    延长生命周期句柄
+  TPN_INLINE void PostHandshake(std::shared_ptr<Derived> this_ptr) {
+    if (NetState::kNetStateStarting != this->state_ || this->kcp_) {
+      return;
+    }
+
+    this->UdpSendControl(
+        KcpControl{0, KcpControl::kSyn, this->handshake_nonce_});
+
+    this->handshake_timer_.expires_after(MilliSeconds(kUdpHandshakeInterval));
+    this->handshake_timer_.async_wait(asio::bind_executor(
+        this->io_handle_.GetStrand(),
+        [this, self_ptr = std::move(this_ptr)](
+            const std::error_code &ec) mutable {
+          if (!ec) {
+            this->GetDerivedObj().PostHandshake(std::move(self_ptr));
+          }
+        }));
+  }
+
+  /// udp提交接收数据，套接字可读时批量读取
+  ///  @param[in]   this_ptr    延长生命周期句柄
+  TPN_INLINE void PostRecv(std::shared_ptr<Derived> this_ptr) {
+    this->socket_.async_wait(
+        asio::socket_base::wait_read,
+        asio::bind_executor(
+            this->io_handle_.GetStrand(),
+            MakeAllocator(this->rallocator_,
+                          [this, self_ptr = std::move(this_ptr)](
+                              const std::error_code &ec) mutable {
+                            this->GetDerivedObj().HandleRecv(
+                                ec, std::move(self_ptr));
+                          })));
+  }
+
+  /// udp处理可读事件
+  ///  @param[in]   ec          错误码
+  ///  @param[in]   this_ptr    延长生命周期句柄
+  TPN_INLINE void HandleRecv(const std::error_code &ec,
+                             std::shared_ptr<Derived> this_ptr) {
+    NET_DEBUG("UdpClientBase HandleRecv state {} error {}",
+              ToNetStateStr(this->state_), ec);
+
+    if (ec) {
+      // 握手过程中套接字被连接超时关闭
+      if (NetState::kNetStateStarting == this->state_ && !this->kcp_) {
+        Connect<Derived, ArgsType>::HandleConnect(ec, std::move(this_ptr));
+      } else {
+        this->GetDerivedObj().DoDisconnect(ec);
+      }
+      return;
+    }
+
+    std::error_code recv_ec;
+    size_t count = 0;
+    do {
+      count = this->recv_batch_.Receive(this->socket_, recv_ec);
+      for (size_t i = 0; i < count; ++i) {
+        this->GetDerivedObj().HandleDatagram(this->recv_batch_.GetData(i),
+                                             this->recv_batch_.GetSize(i),
+                                             this_ptr);
+      }
+    } while (kUdpClientBatchSize == count && this->socket_.is_open());
+
+    // 服务器端口不可达，握手继续重传直到超时，连接中由kcp判定断开
+    if (recv_ec) {
+      NET_DEBUG("UdpClientBase HandleRecv receive error {}", recv_ec);
+    }
+
+    if (this->socket_.is_open()) {
+      this->GetDerivedObj().PostRecv(std::move(this_ptr));
+    }
+  }
+
+  /// 处理一个数据报
+  ///  @param[in]   data        数据报
+  ///  @param[in]   size        数据报长度
+  ///  @param[in]   this_ptr    延长生命周期句柄
+  TPN_INLINE void HandleDatagram(const uint8_t *data, size_t size,
+                                 std::shared_ptr<Derived> &this_ptr) {
+    KcpControl control;
+    if (control.Decode(data, size)) {
+      if (KcpControl::kAck == control.cmd && !this->kcp_ &&
+          this->handshake_nonce_ == control.nonce &&
+          NetState::kNetStateStarting == this->state_) {
+        NET_DEBUG("UdpClientBase handshake done conv {}", control.conv);
+        this->handshake_timer_.cancel(s_ec_ignore);
+        this->KcpCreate(control.conv);
+        Connect<Derived, ArgsType>::HandleConnect(std::error_code{}, this_ptr);
+      } else if (KcpControl::kFin == control.cmd && this->kcp_ &&
+                 this->conv_ == control.conv) {
+        NET_DEBUG("UdpClientBase server closed conv {}", control.conv);
+        this->GetDerivedObj().DoDisconnect(asio::error::connection_reset);
+      }
+      return;
+    }
+
+    if (this->IsStarted()) {
+      this->GetDerivedObj().KcpHandleDatagram(data, size, this_ptr);
+    }
+  }
+
+  /// 启动
+  ///  @param[in]   this_ptr    延长生命周期的智能指针
+  TPN_INLINE void DoStart(std::shared_ptr<Derived> this_ptr) {
+    NET_DEBUG("UdpClientBase DoStart");
+    IgnoreUnused(this_ptr);
+
+    this->UpdateAliveTime();
+    this->ResetConnectTime();
+  }
+
+  /// 关闭
+  ///  @param[in]   ec    错误码
+  TPN_INLINE void DoStop(const std::error_code &ec) {
+    NET_DEBUG("UdpClientBase DoStop error {}", ec);
+    this->GetDerivedObj().PostStop(ec, this->GetSelfSptr());
+  }
+
+  /// 提交关闭
+  ///  @param[in]   ec          错误码
+  ///  @param[in]   self_ptr    延长生命周期的智能指针
+  TPN_INLINE void PostStop(const std::error_code &ec,
+                           std::shared_ptr<Derived> self_ptr) {
+    NET_DEBUG("UdpClientBase PostStop error {}", ec);
+    auto task = [this, ec, this_ptr = std::move(self_ptr)](
+                    EventQueueGuard<Derived> &&guard) mutable {
+      SetLastError(ec);
+
+      // 父类关闭
+      Super::Stop();
+
+      // 处理关闭
+      this->GetDerivedObj().HandleStop(ec, std::move(this_ptr));
+    };
+
+    this->GetDerivedObj().EventEnqueue(
+        [this, t = std::move(task)](EventQueueGuard<Derived> &&guard) mutable {
+          auto task = [guard = std::move(guard), t = std::move(t)]() mutable {
+            t(std::move(guard));
+          };
+
+          this->GetDerivedObj().Post(std::move(task));
+          return true;
+        });
+  }
+
+  /// 处理关闭
+  ///  @param[in]   ec          错误码
+  ///  @param[in]   self_ptr    延长生命周期的智能指针
+  TPN_INLINE void HandleStop(const std::error_code &ec,
+                             std::shared_ptr<Derived> this_ptr) {
+    NET_DEBUG("UdpClientBase HandleStop error {}", ec);
+    IgnoreUnused(ec, this_ptr);
+  }
+
+  /// 加载重连定时器
+  ///  @tparam      String      字符串
+  ///  @tparam      StrOrInt    字符串或整数
+  ///  @param[in]   host        标识地址的字符串。可以是描述性名称或数字地址字符串。
+  ///  @param[in]   service     标识请求的服务的字符串。
+  ///                           可以是描述性名称，也可以是与端口号相对应的数字字符串。
+  template <typename String, typename StrOrInt>
+  void LoadReconnectTimer(String &&host, StrOrInt &&port) {
+    NET_DEBUG("UdpClientBase LoadReconnectTimer {}:{}", host, port);
+
+    this->GetDerivedObj().MakeReconnectTimer(
+        this->GetSelfSptr(),
+        [this, h = ToString(host), p = ToString(port)]() mutable {
+          NetState expected = NetState::kNetStateStopped;
+          if (this->state_.compare_exchange_strong(
+                  expected, NetState::kNetStateStarting)) {
+            auto task = [this, h, p](EventQueueGuard<Derived> &&guard) mutable {
+              this->GetDerivedObj().template ClientStartConnect<true>(
+                  std::move(h), std::move(p), this->GetSelfSptr());
+            };
+
+            this->GetDerivedObj().EventEnqueue(
+                [this, t = std::move(task)](
+                    EventQueueGuard<Derived> &&guard) mutable {
+                  auto task = [guard = std::move(guard),
+                               t     = std::move(t)]() mutable {
+                    t(std::move(guard));
+                  };
+                  this->GetDerivedObj().Post(std::move(task));
+                  return true;
+                });
+          }
+        });
+  }
+
+  /// 处理断开连接
+  ///  @param[in]   ec          错误码
+  ///  @param[in]   this_ptr    延长生命周期的智能指针
+  TPN_INLINE void HandleDisconnect(const std::error_code &ec,
+                                   std::shared_ptr<Derived> this_ptr) {
+    NET_DEBUG("UdpClientBase HandleDisconnect error {}", ec);
+
+    IgnoreUnused(this_ptr);
+
+    this->handshake_timer_.cancel(s_ec_ignore);
+    this->KcpStop();
+
+    // 通知服务器尽快释放会话，服务器主动关闭时不需要
+    if (this->kcp_ && asio::error::connection_reset != ec) {
+      this->UdpSendControl(KcpControl{this->conv_, KcpControl::kFin, 0});
+    }
+    this->send_batch_.Clear();
+
+    // 调用close，否则HandleRecv永远不会返回
+    this->socket_.close(s_ec_ignore);
+  }
+
+  /// 发送数据
+  ///  @tparam      Callback  发送数据完回调类型
+  ///  @param[in]   buffer    调用需要保证buffer满足底层拆包逻辑
+  ///  @param[in]   callback  发送数据回调
+  ///  @return 发送成功返回true
+  template <typename Callback>
+  TPN_INLINE bool DoSend(const MessageBuffer &buffer, Callback &&callback) {
+    NET_DEBUG("UdpClientBase DoSend");
+
+    return this->GetDerivedObj().KcpSend(buffer,
+                                         std::forward<Callback>(callback));
+  }
+
+  /// 获取发送用的套接字
+  TPN_INLINE asio::ip::udp::socket &GetSendSocket() { return this->socket_; }
+
+  /// 获取发送目标地址，套接字已连接
+  TPN_INLINE const asio::ip::udp::endpoint *GetSendEndpoint() const {
+    return nullptr;
+  }
+
+  /// udp客户端通知启动
+  TPN_INLINE [[maybe_unused]] void FireInit() {}
+
+  /// udp客户端通知接收数据
+  ///  @param[in]   this_ptr    延长生命周期的智能指针
+  ///  @param[in]   header      协议头
+  ///  @param[in]   packet      协议体
+  TPN_INLINE [[maybe_unused]] void FireRecv(std::shared_ptr<Derived> &this_ptr,
+                                            protocol::Header &&header,
+                                            MessageBuffer &&packet) {}
+
+  /// udp客户端通知连接
+  ///  @param[in]   this_ptr    延长生命周期的智能指针
+  ///  @param[in]   ec          错误码
+  TPN_INLINE [[maybe_unused]] void FireConnect(
+      std::shared_ptr<Derived> &this_ptr, std::error_code ec) {}
+
+  /// udp客户端通知断开连接
+  ///  @param[in]   this_ptr    延长生命周期的智能指针
+  ///  @param[in]   ec          错误码
+  TPN_INLINE [[maybe_unused]] void FireDisconnect(
+      std::shared_ptr<Derived> &this_ptr, std::error_code ec) {}
+
+ protected:
+  /// 客户端单次最多接收的数据报数
+  static constexpr size_t kUdpClientBatchSize = 16;
+
+  asio::steady_timer handshake_timer_;  ///< 握手请求重传定时器
+  UdpRecvBatch recv_batch_;             ///< 批量接收缓冲区
+  uint32_t handshake_nonce_{0};         ///< 本次握手的随机数
+};
+
+/// udp客户端
+class UdpClient : public UdpClientBase<UdpClient, TemplateArgsUdpClient> {
+ public:
+  using UdpClientBase<UdpClient, TemplateArgsUdpClient>::UdpClientBase;
+};
+
+}  // namespace net
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UDP_CLIENT_H_
@@ -0,0 +1,618 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UDP_SERVER_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UDP_SERVER_H_
+
+#include <unordered_map>
+
+#include "random_hub.h"
+#include "net_common.h"
+#include "server.h"
+#include "udp_batch.h"
+#include "udp_session.h"
+
+namespace tpn {
+
+namespace net {
+
+TPN_NET_FORWARD_DECL_BASE_CLASS
+TPN_NET_FORWARD_DECL_UDP_BASE_CLASS
+TPN_NET_FORWARD_DECL_UDP_SERVER_CLASS
+
+/// 网络层udp服务器基类
+/// 只有一个套接字，在接受器strand上通过 recvmmsg 批量读取数据报，
+/// 握手报文在这里完成会话的创建，kcp数据报按来源地址投递给对应会话。
+///  @tparam  Derived     udp服务器子类
+///  @tparam  SessionType 网络层会话类型
+template <typename Derived, typename SessionType>
+class UdpServerBase : public ServerBase<Derived, SessionType> {
+  TPN_NET_FRIEND_DECL_BASE_CLASS
+  TPN_NET_FRIEND_DECL_UDP_BASE_CLASS
+  TPN_NET_FRIEND_DECL_UDP_SERVER_CLASS
+
+ public:
+  using session_type = SessionType;
+
+  using Super = ServerBase<Derived, SessionType>;
+  using Self  = UdpServerBase<Derived, SessionType>;
+
+  /// 构造函数
+  ///  @param[in]   concurrency_hint    io对象池大小 默认 cpu个数 x2
+  ///  @param[in]   buffer_max          缓冲区最大长度
+  ///  @param[in]   buffer_prepare      缓冲区准备长度
+  explicit UdpServerBase(
+      size_t concurrency_hint = std::thread::hardware_concurrency() * 2,
+      size_t buffer_max       = (std::numeric_limits<size_t>::max)(),
+      size_t buffer_prepare   = kUdpFrameSize)
+      : Super(concurrency_hint),
+        socket_(this->io_handle_.GetIoContext()),
+        counter_timer_(this->io_handle_.GetIoContext()),
+        recv_batch_(kUdpBatchSize),
+        next_conv_(RandU32()),
+        buffer_max_(buffer_max),
+        buffer_prepare_(buffer_prepare) {}
+
+  /// 析构函数
+  ~UdpServerBase() { this->Stop(); }
+
+  /// 启动udp服务器
+  ///  @tparam      StrOrInt    字符串或整数
+  ///  @param[in]   service     标识请求的服务的字符串。
+  ///                           可以是描述性名称，也可以是与端口号相对应的数字字符串。
+  ///  @return 启动成功返回true
+  template <typename StrOrInt>
+  TPN_INLINE bool Start(StrOrInt &&service) {
+    return this->Start(std::string_view{}, std::forward<StrOrInt>(service));
+  }
+
+  /// 启动udp服务器
+  ///  @tparam      String      字符串
+  ///  @tparam      StrOrInt    字符串或整数
+  ///  @param[in]   host        标识地址的字符串。可以是描述性名称或数字地址字符串。
+  ///  @param[in]   service     标识请求的服务的字符串。
+  ///                           可以是描述性名称，也可以是与端口号相对应的数字字符串。
+  ///  @return 启动成功返回true
+  template <typename String, typename StrOrInt>
+  TPN_INLINE bool Start(String &&host, StrOrInt &&service) {
+    NET_DEBUG("UdpServerBase Start {}:{} state {}", host, service,
+              ToNetStateStr(this->state_));
+    return this->GetDerivedObj().DoStart(std::forward<String>(host),
+                                         std::forward<StrOrInt>(service));
+  }
+
+  /// 关闭udp服务器
+  TPN_INLINE void Stop() {
+    NET_DEBUG("UdpServerBase Stop state {}", ToNetStateStr(this->state_));
+    this->GetDerivedObj().DoStop(asio::error::operation_aborted);
+    this->IoPoolStop();
+  }
+
+  /// 服务器是否启动
+  ///  @return 启动返回true
+  TPN_INLINE bool IsStarted() {
+    return (Super::IsStarted() && this->socket_.is_open());
+  }
+
+  /// 服务器是否关闭
+  ///  @return 关闭返回true
+  TPN_INLINE bool IsStopped() {
+    return (Super::IsStopped() && !this->socket_.is_open());
+  }
+
+  /// 获取套接字
+  TPN_INLINE asio::ip::udp::socket &GetSocket() { return this->socket_; }
+
+  /// 设置新建会话的kcp传输参数
+  ///  @param[in]   options   传输参数
+  ///  @return CRTP对象自身引用 用于链式调用
+  TPN_INLINE Derived &SetKcpOptions(const KcpOptions &options) {
+    this->kcp_options_ = options;
+    return this->GetDerivedObj();
+  }
+
+  /// 获取新建会话的kcp传输参数
+  TPN_INLINE const KcpOptions &GetKcpOptions() const {
+    return this->kcp_options_;
+  }
+
+ protected:
+  /// udp服务器执行开始
+  ///  @tparam      String      字符串
+  ///  @tparam      StrOrInt    字符串或整数
+  ///  @param[in]   host        标识地址的字符串。可以是描述性名称或数字地址字符串。
+  ///  @param[in]   service     标识请求的服务的字符串。
+  ///                           可以是描述性名称，也可以是与端口号相对应的数字字符串。
+  ///  @return 启动成功返回true
+  template <typename String, typename StrOrInt>
+  TPN_INLINE bool DoStart(String &&host, StrOrInt &&service) {
+    NET_DEBUG("UdpServerBase DoStart {}:{} state{}", host, service,
+              ToNetStateStr(this->state_));
+
+    NetState expected = NetState::kNetStateStopped;
+    if (!this->state_.compare_exchange_strong(expected,
+                                              NetState::kNetStateStarting)) {
+      NET_ERROR("UdpServerBase net already started state {}",
+                ToNetStateStr(this->state_));
+      SetLastError(asio::error::already_started);
+      return false;
+    }
+
+    Super::Start();
+
+    try {
+      ClearLastError();
+
+      // 启动对象池
+      this->IoPoolStart();
+
+      if (this->IsIoPoolStopped()) {
+        NET_ERROR("UdpServerBase io_pool start error");
+        SetLastError(asio::error::shut_down);
+        return false;
+      }
+
+      // 确保引用计数为0时 做最后的关闭处理
+      this->counter_sptr_ =
+          std::shared_ptr<void>(reinterpret_cast<void *>(1), [this](void *) {
+            this->GetDerivedObj().Post([this]() mutable {
+              NetState expected = NetState::kNetStateStopping;
+              if (this->state_.compare_exchange_strong(
+                      expected, NetState::kNetStateStopped)) {
+                NET_DEBUG("UdpServerBase counter final stop state {}",
+                          ToNetStateStr(this->state_));
+                this->GetDerivedObj().HandleStop(asio::error::operation_aborted,
+                                                 this->GetSelfSptr());
+              } else {
+                TPN_ASSERT(false, "UdpServerBase counter final stop error");
+              }
+            });
+          });
+
+      this->socket_.close(s_ec_ignore);
+
+      std::string h = ToString(std::forward<String>(host));
+      std::string p = ToString(std::forward<StrOrInt>(service));
+
+      // 解析地址端口
+      asio::ip::udp::resolver resolver(this->io_handle_.GetIoContext());
+      asio::ip::udp::endpoint endpoint =
+          *resolver
+               .resolve(h, p,
+                        asio::ip::resolver_base::flags::passive |
+                            asio::ip::resolver_base::flags::address_configured)
+               .begin();
+
+      NET_DEBUG("UdpServerBase {}:{} resolver {}:{}", h, p,
+                endpoint.address().to_string(), endpoint.port());
+
+      this->socket_.open(endpoint.protocol());
+      this->socket_.set_option(asio::ip::udp::socket::reuse_address(true));
+
+      // 通知启动成功
+      this->GetDerivedObj().FireInit();
+
+      // 绑定端口
+      this->socket_.bind(endpoint);
+
+      this->GetDerivedObj().HandleStart(std::error_code{});
+
+      NET_DEBUG("UdpServerBase DoStart {}:{} state {} done", host, service,
+                ToNetStateStr(this->state_));
+      return (this->IsStarted());
+    } catch (std::system_error &e) {
+      NET_ERROR("UdpServerBase DoStart HandleStart error {}", e.code());
+      this->GetDerivedObj().HandleStart(e.code());
+    }
+    return false;
+  }
+
+  /// udp服务器处理启动
+  ///  @param[in]   ec    错误码
+  TPN_INLINE void HandleStart(std::error_code ec) {
+    NET_DEBUG("UdpServerBase HandleStart error {} state {}", ec,
+              ToNetStateStr(this->state_));
+
+    try {
+      NetState expected = NetState::kNetStateStarting;
+      if (!ec && !this->state_.compare_exchange_strong(
+                     expected, NetState::kNetStateStarted)) {
+        NET_WARN("UdpServerBase HandleStart not starting state {}",
+                 ToNetStateStr(this->state_));
+        ec = asio::error::operation_aborted;
+      }
+
+      SetLastError(ec);
+
+      // 无论启动成功或是失败，都需要通知Start事件
+      this->GetDerivedObj().FireStart(ec);
+
+      expected = NetState::kNetStateStarted;
+      if (!ec && !this->state_.compare_exchange_strong(
+                     expected, NetState::kNetStateStarted)) {
+        NET_WARN("UdpServerBase HandleStart not started state {}",
+                 ToNetStateStr(this->state_));
+        asio::detail::throw_error(asio::error::operation_aborted);
+      }
+
+      asio::detail::throw_error(ec);
+
+      this->GetDerivedObj().Post(
+          [this]() mutable { this->GetDerivedObj().PostRecv(); });
+    } catch (std::system_error &e) {
+      NET_ERROR("UdpServerBase HandleStart error {} state {}", e.code(),
+                ToNetStateStr(this->state_));
+      SetLastError(e);
+      this->GetDerivedObj().DoStop(e.code());
+    }
+  }
+
+  /// udp服务器处理关闭
+  ///  @param[in]   ec    错误码
+  TPN_INLINE void DoStop(const std::error_code &ec) {
+    NET_DEBUG("UdpServerBase DoStop error {} state {}", ec,
+              ToNetStateStr(this->state_));
+
+    // 启动中停止
+    NetState expected = NetState::kNetStateStarting;
+    if (this->state_.compare_exchange_strong(expected,
+                                             NetState::kNetStateStopping)) {
+      return this->GetDerivedObj().PostStop(ec, this->GetSelfSptr(), expected);
+    }
+
+    // 已经启动停止
+    expected = NetState::kNetStateStarted;
+    if (this->state_.compare_exchange_strong(expected,
+                                             NetState::kNetStateStopping)) {
+      return this->GetDerivedObj().PostStop(ec, this->GetSelfSptr(), expected);
+    }
+  }
+
+  /// udp服务器提交关闭
+  ///  @param[in]   ec          错误码
+  ///  @param[in]   self_ptr    延长生命周期的智能指针
+  ///  @param[in]   old_state   转移到stopping之前的状态
+  TPN_INLINE void PostStop(const std::error_code &ec,
+                           std::shared_ptr<Derived> self_ptr,
+                           NetState old_state) {
+    NET_DEBUG("UdpServerBase PostStop error {} old_state {} state {}", ec,
+              ToNetStateStr(old_state), ToNetStateStr(this->state_));
+
+    this->GetDerivedObj().Post(
+        [this, ec, this_ptr = std::move(self_ptr), old_state]() mutable {
+          IgnoreUnused(this, old_state);
+
+          SetLastError(ec);
+
+          // 确保持有的io_handle直到所有的会话关闭
+          this->counter_timer_.expires_after(NanoSeconds::max());
+          this->counter_timer_.async_wait(asio::bind_executor(
+              this->io_handle_.GetStrand(), [](const std::error_code &) {}));
+
+          // 停止所有会话，会话关闭时在服务器套接字上通知对端
+          this->GetDerivedObj().ApplyAllSession(
+              [](std::shared_ptr<SessionType> &session_sptr) mutable {
+                session_sptr->Stop();
+              });
+
+          this->routes_.clear();
+
+          // 引用计数归0
+          this->counter_sptr_.reset();
+        });
+  }
+
+  /// udp服务器处理关闭
+  ///  @param[in]   ec          错误码
+  ///  @param[in]   self_ptr    延长生命周期的智能指针
+  TPN_INLINE void HandleStop(const std::error_code &ec,
+                             std::shared_ptr<Derived> this_ptr) {
+    NET_DEBUG("UdpServerBase HandleStop error {} state {}", ec,
+              ToNetStateStr(this->state_));
+
+    IgnoreUnused(ec, this_ptr);
+
+    // 通知停止
+    this->GetDerivedObj().FireStop(ec);
+
+    this->counter_timer_.cancel(s_ec_ignore);
+
+    // 调用父类的关闭程序
+    Super::Stop();
+
+    // 关闭套接字，等待中的 async_wait 返回错误后不再提交
+    this->socket_.close(s_ec_ignore);
+  }
+
+  /// 创造一个udp会话
+  /// 会话对象从所分配io句柄的会话内存池申请
+  ///  @tapram      Args        会话子类所需额外参数预留类型
+  ///  @param[in]   args...     会话子类所需额外参数预留
+  template <typename... Args>
+  TPN_INLINE std::shared_ptr<SessionType> MakeSession(Args &&...args) {
+    NET_DEBUG("UdpServerBase MakeSession state {}",
+              ToNetStateStr(this->state_));
+    IoHandle &io_handle = this->GetIoHandleByIndex();
+    return std::allocate_shared<SessionType>(
+        SessionPoolAllocator<SessionType>(io_handle.GetSessionPool()),
+        std::forward<Args>(args)..., io_handle, this->session_mgr_,
+        this->buffer_max_, this->buffer_prepare_);
+  }
+
+  /// 提交接收，套接字可读时批量读取
+  TPN_INLINE void PostRecv() {
+    if (!this->IsStarted()) {
+      NET_DEBUG("UdpServerBase PostRecv state {}",
+                ToNetStateStr(this->state_));
+      return;
+    }
+
+    this->socket_.async_wait(
+        asio::socket_base::wait_read,
+        asio::bind_executor(this->io_handle_.GetStrand(),
+                            MakeAllocator(this->rallocator_,
+                                          [this](const std::error_code &ec) {
+                                            this->GetDerivedObj().HandleRecv(
+                                                ec);
+                                          })));
+  }
+
+  /// 处理可读事件
+  ///  @param[in]   ec    错误码
+  TPN_INLINE void HandleRecv(const std::error_code &ec) {
+    if (asio::error::operation_aborted == ec) {
+      NET_DEBUG("UdpServerBase HandleRecv aborted and do stop");
+      this->GetDerivedObj().DoStop(ec);
+      return;
+    }
+
+    if (ec) {
+      NET_ERROR("UdpServerBase HandleRecv error {}", ec);
+      SetLastError(ec);
+    } else {
+      // 一次可读事件最多读取若干批，避免其他任务饥饿
+      for (size_t round = 0; round < kUdpRecvRounds; ++round) {
+        std::error_code recv_ec;
+        size_t count = this->recv_batch_.Receive(this->socket_, recv_ec);
+        if (recv_ec) {
+          NET_DEBUG("UdpServerBase HandleRecv receive error {}", recv_ec);
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+          this->GetDerivedObj().HandleDatagram(
+              this->recv_batch_.GetData(i), this->recv_batch_.GetSize(i),
+              this->recv_batch_.GetEndpoint(i));
+        }
+
+        if (kUdpBatchSize > count && !recv_ec) {
+          break;
+        }
+      }
+    }
+
+    this->GetDerivedObj().PostRecv();
+  }
+
+  /// 处理一个数据报
+  ///  @param[in]   data      数据报
+  ///  @param[in]   size      数据报长度
+  ///  @param[in]   endpoint  来源地址
+  TPN_INLINE void HandleDatagram(const uint8_t *data, size_t size,
+                                 const asio::ip::udp::endpoint &endpoint) {
+    KcpControl control;
+    if (control.Decode(data, size)) {
+      if (KcpControl::kSyn == control.cmd) {
+        this->GetDerivedObj().HandleHandshake(endpoint, control.nonce);
+      } else if (KcpControl::kFin == control.cmd) {
+        if (auto session_sptr = this->FindRoute(endpoint, control.conv)) {
+          session_sptr->DoDisconnect(asio::error::eof);
+        }
+      }
+      return;
+    }
+
+    if (kKcpOverhead > size) {
+      return;
+    }
+
+    uint32_t conv = Kcp::ReadConv(data);
+
+    std::shared_ptr<SessionType> session_sptr = this->FindRoute(endpoint, conv);
+    if (!session_sptr) {
+      // 会话已经不存在，通知对端尽快断开
+      this->SendControl(endpoint, KcpControl{conv, KcpControl::kFin, 0});
+      return;
+    }
+
+    MessageBuffer datagram(size);
+    datagram.Write(data, size);
+
+    SessionType *session_rptr = session_sptr.get();
+    asio::post(session_rptr->GetIoHandle().GetStrand(),
+               MakeAllocator(session_rptr->GetWriteAllocator(),
+                             [session_sptr = std::move(session_sptr),
+                              datagram = std::move(datagram)]() mutable {
+                               SessionType *session = session_sptr.get();
+                               session->HandleDatagram(std::move(datagram),
+                                                       std::move(session_sptr));
+                             }));
+  }
+
+  /// 处理握手请求
+  ///  @param[in]   endpoint  来源地址
+  ///  @param[in]   nonce     客户端随机数
+  TPN_INLINE void HandleHandshake(const asio::ip::udp::endpoint &endpoint,
+                                  uint32_t nonce) {
+    auto iter = this->routes_.find(endpoint);
+    if (this->routes_.end() != iter) {
+      std::shared_ptr<SessionType> session_sptr = iter->second.session.lock();
+      if (iter->second.nonce == nonce) {
+        // 重传的握手请求，ack丢失了，重新回复
+        if (session_sptr && session_sptr->IsStarted()) {
+          this->SendControl(endpoint,
+                            KcpControl{session_sptr->GetConv(),
+                                       KcpControl::kAck, nonce});
+        }
+        return;
+      }
+
+      // 同一地址发起了新的握手，旧会话作废
+      if (session_sptr) {
+        session_sptr->Stop();
+      }
+      this->routes_.erase(iter);
+    }
+
+    this->PurgeRoutes();
+
+    uint32_t conv = this->NextConv();
+
+    std::shared_ptr<SessionType> session_sptr = this->GetDerivedObj().MakeSession(
+        conv, endpoint, this->socket_, this->kcp_options_);
+
+    NET_DEBUG("UdpServerBase HandleHandshake {}:{} new session {}",
+              endpoint.address().to_string(), endpoint.port(), conv);
+
+    session_sptr->counter_sptr_ = this->counter_sptr_;
+    session_sptr->Start();
+
+    if (!session_sptr->IsStarted()) {
+      NET_WARN("UdpServerBase HandleHandshake session {} start failed", conv);
+      return;
+    }
+
+    this->routes_.try_emplace(endpoint, Route{nonce, session_sptr});
+    this->SendControl(endpoint, KcpControl{conv, KcpControl::kAck, nonce});
+  }
+
+  /// 根据来源地址查找会话
+  ///  @param[in]   endpoint  来源地址
+  ///  @param[in]   conv      kcp会话编号
+  ///  @return 地址与会话编号都匹配且已启动的会话
+  TPN_INLINE std::shared_ptr<SessionType> FindRoute(
+      const asio::ip::udp::endpoint &endpoint, uint32_t conv) {
+    auto iter = this->routes_.find(endpoint);
+    if (this->routes_.end() == iter) {
+      return nullptr;
+    }
+
+    std::shared_ptr<SessionType> session_sptr = iter->second.session.lock();
+    if (!session_sptr || session_sptr->GetConv() != conv ||
+        !session_sptr->IsStarted()) {
+      return nullptr;
+    }
+    return session_sptr;
+  }
+
+  /// 路由表超过阈值时清理已经关闭的会话
+  TPN_INLINE void PurgeRoutes() {
+    if (this->routes_.size() < this->purge_threshold_) {
+      return;
+    }
+
+    for (auto iter = this->routes_.begin(); iter != this->routes_.end();) {
+      std::shared_ptr<SessionType> session_sptr = iter->second.session.lock();
+      if (!session_sptr || session_sptr->IsStopped()) {
+        iter = this->routes_.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+
+    this->purge_threshold_ =
+        (std::max)(kUdpRoutePurgeThreshold, this->routes_.size() * 2);
+  }
+
+  /// 分配一个未使用的kcp会话编号，0保留给握手请求
+  TPN_INLINE uint32_t NextConv() {
+    uint32_t conv = 0;
+    do {
+      conv = ++this->next_conv_;
+    } while (0 == conv || this->session_mgr_.Find(conv));
+    return conv;
+  }
+
+  /// 在服务器套接字上发送控制报文
+  ///  @param[in]   endpoint  目标地址
+  ///  @param[in]   control   控制报文
+  TPN_INLINE void SendControl(const asio::ip::udp::endpoint &endpoint,
+                              const KcpControl &control) {
+    uint8_t data[kKcpControlSize];
+    control.Encode(data);
+
+    std::error_code ec;
+    this->control_batch_.Append(data, sizeof(data));
+    this->control_batch_.Send(this->socket_, &endpoint, ec);
+  }
+
+  /// udp服务器初始化通知
+  TPN_INLINE [[maybe_unused]] void FireInit() {}
+
+  /// udp服务器启动通知
+  ///  @param[in]   ec    错误码
+  TPN_INLINE [[maybe_unused]] void FireStart(std::error_code ec) {}
+
+  /// udp服务器停止通知
+  ///  @param[in]   ec    错误码
+  TPN_INLINE [[maybe_unused]] void FireStop(std::error_code ec) {}
+
+ protected:
+  /// 来源地址路由
+  struct Route {
+    uint32_t nonce;                       ///< 建立会话时的客户端随机数
+    std::weak_ptr<SessionType> session;  ///< 会话
+  };
+
+  /// 一次可读事件最多读取的批数
+  static constexpr size_t kUdpRecvRounds = 16;
+  /// 路由表清理阈值下限
+  static constexpr size_t kUdpRoutePurgeThreshold = 64;
+
+  asio::ip::udp::socket socket_;      ///< 服务器套接字
+  asio::steady_timer counter_timer_;  ///< 确保持有的io_handle直到所有的会话关闭
+  UdpRecvBatch recv_batch_;           ///< 批量接收缓冲区
+  UdpSendBatch control_batch_;        ///< 控制报文发送缓冲区
+  std::unordered_map<asio::ip::udp::endpoint, Route>
+      routes_;                        ///< 来源地址到会话的路由，只在接受器strand访问
+  size_t purge_threshold_{kUdpRoutePurgeThreshold};  ///< 路由表清理阈值
+  uint32_t next_conv_;                ///< 下一个kcp会话编号
+  KcpOptions kcp_options_;            ///< 新建会话的kcp传输参数
+  size_t buffer_max_{(std::numeric_limits<size_t>::max)()};  ///< 缓冲区最大值
+  size_t buffer_prepare_{kUdpFrameSize};  ///< 缓冲区初始大小
+};
+
+/// udp服务器桥梁
+template <typename SessionType>
+class UdpServerBridge
+    : public UdpServerBase<UdpServerBridge<SessionType>, SessionType> {
+ public:
+  using UdpServerBase<UdpServerBridge<SessionType>, SessionType>::UdpServerBase;
+};
+
+/// udp服务器
+using UdpServer = UdpServerBridge<UdpSession>;
+
+}  // namespace net
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UDP_SERVER_H_
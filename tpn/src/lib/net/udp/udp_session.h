@@ -0,0 +1,355 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UDP_SESSION_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UDP_SESSION_H_
+
+#include "message_buffer.h"
+#include "rpc_type.pb.h"
+#include "net_common.h"
+#include "session.h"
+#include "kcp_stream.h"
+#include "udp_send_wrap.h"
+
+namespace tpn {
+
+namespace net {
+
+TPN_NET_FORWARD_DECL_BASE_CLASS
+TPN_NET_FORWARD_DECL_UDP_BASE_CLASS
+TPN_NET_FORWARD_DECL_UDP_SERVER_CLASS
+TPN_NET_FORWARD_DECL_UDP_SESSION_CLASS
+
+/// udp网络会话模板参数
+struct TemplateArgsUdpSession {
+  static constexpr bool is_session = true;
+  static constexpr bool is_client  = false;
+
+  using socket_type = asio::ip::udp::socket;
+  using buffer_type = EmptyBuffer;
+};
+
+/// udp网络会话基类
+/// 所有会话共用服务器的套接字，服务器按来源地址把数据报投递到会话所在的strand，
+/// 会话通过kcp保证可靠有序，发送时直接在服务器套接字上批量发出。
+///  @tparam  Derived     udp会话子类
+///  @tparam  ArgsType    网络会话模板参数
+template <typename Derived, typename ArgsType>
+class UdpSessionBase : public SessionBase<Derived, ArgsType>,
+                       public KcpStream<Derived, ArgsType>,
+                       public UdpSendWrap<Derived, ArgsType> {
+  TPN_NET_FRIEND_DECL_BASE_CLASS
+  TPN_NET_FRIEND_DECL_UDP_BASE_CLASS
+  TPN_NET_FRIEND_DECL_UDP_SERVER_CLASS
+  TPN_NET_FRIEND_DECL_UDP_SESSION_CLASS
+
+ public:
+  using key_type    = uint32_t;
+  using buffer_type = typename ArgsType::buffer_type;
+
+  using Super = SessionBase<Derived, ArgsType>;
+  using Self  = UdpSessionBase<Derived, ArgsType>;
+
+  using Super::Send;
+
+  /// 构造函数
+  ///  @param[in]   conv            kcp会话编号
+  ///  @param[in]   remote_endpoint 对端地址
+  ///  @param[in]   server_socket   服务器套接字
+  ///  @param[in]   kcp_options     kcp传输参数
+  ///  @param[in]   io_handle       io句柄
+  ///  @param[in]   session_mgr     所在的会话管理器引用
+  ///  @param[in]   buffer_max      缓冲区最大长度
+  ///  @param[in]   buffer_prepare  缓冲区准备长度
+  explicit UdpSessionBase(uint32_t conv,
+                          const asio::ip::udp::endpoint &remote_endpoint,
+                          asio::ip::udp::socket &server_socket,
+                          const KcpOptions &kcp_options, IoHandle &io_handle,
+                          SessionMgr<Derived> &session_mgr, size_t buffer_max,
+                          size_t buffer_prepare)
+      : Super(io_handle, session_mgr, buffer_max, buffer_prepare,
+              io_handle.GetIoContext()),
+        KcpStream<Derived, ArgsType>(io_handle),
+        UdpSendWrap<Derived, ArgsType>(),
+        remote_endpoint_(remote_endpoint),
+        server_socket_(server_socket),
+        rallocator_(),
+        wallocator_() {
+    this->SetSilenceTimeoutDuration(MilliSeconds(kUdpSilenceTimeout));
+    this->SetConnectTimeoutDuration(MilliSeconds(kUdpConnectTimeout));
+    this->SetKcpOptions(kcp_options);
+    this->KcpCreate(conv);
+  }
+
+  ~UdpSessionBase() = default;
+
+  /// udp会话关闭
+  TPN_INLINE void Stop() {
+    NET_DEBUG("UdpSessionBase Stop state {}", ToNetStateStr(this->state_));
+    this->GetDerivedObj().DoDisconnect(asio::error::operation_aborted);
+  }
+
+  /// udp会话是否启动
+  /// 会话没有自己的套接字，只看状态
+  ///  @return 启动返回true
+  TPN_INLINE bool IsStarted() {
+    return (NetState::kNetStateStarted == this->state_);
+  }
+
+  /// udp会话是否关闭
+  ///  @return 关闭返回true
+  TPN_INLINE bool IsStopped() {
+    return (NetState::kNetStateStopped == this->state_);
+  }
+
+  /// udp会话哈希key，即kcp会话编号
+  TPN_INLINE const key_type GetHashKey() const { return this->conv_; }
+
+  /// 获取对端地址
+  TPN_INLINE const asio::ip::udp::endpoint &GetRemoteEndpoint() const {
+    return this->remote_endpoint_;
+  }
+
+  /// 获取远端地址
+  TPN_INLINE std::string GetRemoteAddress() {
+    return this->remote_endpoint_.address().to_string();
+  }
+
+  /// 获取远端端口
+  TPN_INLINE unsigned short GetRemotePort() {
+    return this->remote_endpoint_.port();
+  }
+
+ protected:
+  /// udp会话启动
+  TPN_INLINE void Start() {
+    NET_DEBUG("UdpSessionBase Start state {} key {}",
+              ToNetStateStr(this->state_), this->GetHashKey());
+
+    try {
+      NetState expected = NetState::kNetStateStopped;
+
+      if (!this->state_.compare_exchange_strong(expected,
+                                                NetState::kNetStateStarting)) {
+        NET_ERROR("UdpSessionBase already starting state {}",
+                  ToNetStateStr(this->state_));
+        asio::detail::throw_error(asio::error::already_started);
+      }
+
+      std::shared_ptr<Derived> this_ptr = this->GetSelfSptr();
+
+      // udp session 启动
+      this->GetDerivedObj().DoInit(this_ptr);
+
+      // 通知接受器
+      this->GetDerivedObj().FireAccept(this_ptr);
+
+      expected = NetState::kNetStateStarting;
+      if (!this->state_.compare_exchange_strong(expected,
+                                                NetState::kNetStateStarting)) {
+        NET_ERROR("UdpSessionBase not starting state {}",
+                  ToNetStateStr(this->state_));
+        asio::detail::throw_error(asio::error::already_started);
+      }
+
+      // 父类启动函数
+      Super::Start();
+
+      // 连接处理，握手已经由服务器完成
+      this->GetDerivedObj().HandleConnect(std::error_code{},
+                                          std::move(this_ptr));
+    } catch (std::system_error &e) {
+      NET_ERROR("UdpSessionBase Start error {} key {}", e.code(),
+                this->GetHashKey());
+
+      SetLastError(e);
+
+      this->GetDerivedObj().DoDisconnect(e.code());
+    }
+  }
+
+  /// udp会话初始化
+  ///  @param[in]   this_ptr    延长生命周期句柄
+  TPN_INLINE void DoInit(std::shared_ptr<Derived> this_ptr) {
+    NET_DEBUG("UdpSessionBase DoInit state {} key {}",
+              ToNetStateStr(this->state_), this->GetHashKey());
+
+    IgnoreUnused(this_ptr);
+
+    // 重置初始状态
+    this->ResetConnectTime();
+    // 更新存活时间
+    this->UpdateAliveTime();
+  }
+
+  /// udp开始接收数据
+  /// 数据报由服务器投递，这里只需要开启静默定时器
+  ///  @param[in]   this_ptr    延长生命周期句柄
+  TPN_INLINE void StartRecv(std::shared_ptr<Derived> this_ptr) {
+    NET_DEBUG("UdpSessionBase StartRecv state {} key {}",
+              ToNetStateStr(this->state_), this->GetHashKey());
+
+    this->GetDerivedObj().Post([this, self_ptr = std::move(this_ptr)]() mutable {
+      this->GetDerivedObj().PostSilenceTimer(this->silence_timeout_, self_ptr);
+    });
+  }
+
+  /// udp处理服务器投递的数据报，在会话strand中执行
+  ///  @param[in]   datagram    数据报
+  ///  @param[in]   this_ptr    延长生命周期句柄
+  TPN_INLINE void HandleDatagram(MessageBuffer &&datagram,
+                                 std::shared_ptr<Derived> this_ptr) {
+    if (!this->IsStarted()) {
+      return;
+    }
+
+    this->GetDerivedObj().KcpHandleDatagram(datagram.GetReadPointer(),
+                                            datagram.GetActiveSize(),
+                                            this_ptr);
+  }
+
+  /// 会话注册
+  ///  @param[in]   this_ptr    延长生命周期句柄
+  TPN_INLINE void JoinSession(std::shared_ptr<Derived> this_ptr) {
+    NET_DEBUG("UdpSessionBase JoinSession state {} key {}",
+              ToNetStateStr(this->state_), this->GetHashKey());
+
+    this->session_mgr_.Emplace(this_ptr, [this,
+                                          this_ptr](bool inserted) mutable {
+      if (inserted) {
+        this->GetDerivedObj().StartRecv(std::move(this_ptr));
+      } else {
+        NET_DEBUG("UdpSessionBase JoinSession {} key {} DoDisconnect",
+                  inserted, this->GetHashKey());
+        this->GetDerivedObj().DoDisconnect(asio::error::address_in_use);
+      }
+    });
+  }
+
+  /// udp会话启动处理
+  TPN_INLINE void DoStart(std::shared_ptr<Derived> this_ptr) {
+    NET_DEBUG("UdpSessionBase DoStart state {} key {}",
+              ToNetStateStr(this->state_), this->GetHashKey());
+
+    this->GetDerivedObj().JoinSession(std::move(this_ptr));
+  }
+
+  /// udp会话关闭处理
+  ///  @param[in]   ec          错误码
+  TPN_INLINE void DoStop(const std::error_code &ec) {
+    NET_DEBUG("UdpSessionBase DoStop state {} key {} error {}",
+              ToNetStateStr(this->state_), this->GetHashKey(), ec);
+
+    this->KcpStop();
+
+    // 对端主动关闭时不需要再通知
+    // 必须在父类释放服务器引用计数之前发送，之后服务器套接字可能已经关闭
+    if (asio::error::eof != ec) {
+      this->UdpSendControl(KcpControl{this->conv_, KcpControl::kFin, 0});
+    }
+
+    Super::Stop();
+  }
+
+  /// 处理断开连接
+  /// 本函数重写了disconnect模块的HandleDisconnect的方法
+  ///  @param[in]   ec          错误码
+  ///  @param[in]   this_ptr    延长生命周期的智能指针
+  TPN_INLINE void HandleDisconnect(const std::error_code &ec,
+                                   std::shared_ptr<Derived> this_ptr) {
+    NET_DEBUG("UdpSessionBase HandleDisconnect state {} key {} error: {}",
+              ToNetStateStr(this->state_), this->GetHashKey(), ec);
+    IgnoreUnused(this_ptr);
+
+    this->GetDerivedObj().DoStop(ec);
+  }
+
+  /// 发送数据
+  ///  @tparam      Callback  发送数据完回调类型
+  ///  @param[in]   buffer    调用需要保证buffer满足底层拆包逻辑
+  ///  @param[in]   callback  发送数据回调
+  ///  @return 发送成功返回true
+  template <typename Callback>
+  TPN_INLINE bool DoSend(const MessageBuffer &buffer, Callback &&callback) {
+    return this->GetDerivedObj().KcpSend(buffer,
+                                         std::forward<Callback>(callback));
+  }
+
+  /// 获取发送用的套接字
+  TPN_INLINE asio::ip::udp::socket &GetSendSocket() {
+    return this->server_socket_;
+  }
+
+  /// 获取发送目标地址
+  TPN_INLINE const asio::ip::udp::endpoint *GetSendEndpoint() const {
+    return &this->remote_endpoint_;
+  }
+
+  /// udp会话通知接收数据
+  ///  @param[in]   this_ptr    延长生命周期的智能指针
+  ///  @param[in]   header      协议头
+  ///  @param[in]   packet      协议体
+  TPN_INLINE void [[maybe_unused]] FireRecv(std::shared_ptr<Derived> &this_ptr,
+                                            protocol::Header &&header,
+                                            MessageBuffer &&packet) {}
+
+  /// udp会话通知接收
+  ///  @param[in]   this_ptr    延长生命周期的智能指针
+  TPN_INLINE void
+      [[maybe_unused]] FireAccept(std::shared_ptr<Derived> &this_ptr) {}
+
+  /// udp会话通知连接
+  ///  @param[in]   this_ptr    延长生命周期的智能指针
+  TPN_INLINE void
+      [[maybe_unused]] FireConnect(std::shared_ptr<Derived> &this_ptr) {}
+
+  /// udp会话通知断开连接
+  ///  @param[in]   this_ptr    延长生命周期的智能指针
+  TPN_INLINE void
+      [[maybe_unused]] FireDisconnect(std::shared_ptr<Derived> &this_ptr) {}
+
+  /// 获取用于 recv/read 的内存分配器
+  TPN_INLINE auto &GetReadAllocator() { return this->rallocator_; }
+
+  /// 获取用于 send/write 的内存分配器
+  TPN_INLINE auto &GetWriteAllocator() { return this->wallocator_; }
+
+ protected:
+  asio::ip::udp::endpoint remote_endpoint_;  ///< 对端地址
+  asio::ip::udp::socket &server_socket_;     ///< 服务器套接字
+  HandlerMemory<SizeOp<>, std::false_type>
+      rallocator_;  ///< 用户自定义内存用来处理 kcp定时器
+  HandlerMemory<SizeOp<>, std::true_type>
+      wallocator_;  ///< 用户自定义内存用来处理 send/post/数据报投递
+};
+
+/// udp会话
+class UdpSession : public UdpSessionBase<UdpSession, TemplateArgsUdpSession> {
+ public:
+  using UdpSessionBase<UdpSession, TemplateArgsUdpSession>::UdpSessionBase;
+};
+
+}  // namespace net
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UDP_SESSION_H_
@@ -0,0 +1,664 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "kcp.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "byte_converter.h"
+
+namespace tpn {
+
+namespace net {
+
+namespace {
+
+constexpr int32_t kRtoNoDelay        = 30;      ///< 快速模式最小rto
+constexpr int32_t kRtoMin            = 100;     ///< 普通模式最小rto
+constexpr int32_t kRtoDefault        = 200;     ///< 默认rto
+constexpr int32_t kRtoMax            = 60000;   ///< 最大rto
+constexpr uint8_t kCmdPush           = 81;      ///< 数据
+constexpr uint8_t kCmdAck            = 82;      ///< 确认
+constexpr uint8_t kCmdWindowAsk      = 83;      ///< 询问窗口
+constexpr uint8_t kCmdWindowTell     = 84;      ///< 告知窗口
+constexpr uint32_t kAskSend          = 1;       ///< 需要发送询问窗口
+constexpr uint32_t kAskTell          = 2;       ///< 需要发送告知窗口
+constexpr uint32_t kWindowSend       = 32;      ///< 默认发送窗口
+constexpr uint32_t kWindowRecv       = 128;     ///< 默认接收窗口，同时是最小值
+constexpr uint32_t kInterval         = 100;     ///< 默认刷新间隔
+constexpr uint32_t kDeadLink         = 20;      ///< 默认断开判定重传次数
+constexpr uint32_t kThreshInit       = 2;       ///< 初始慢启动阈值
+constexpr uint32_t kThreshMin        = 2;       ///< 最小慢启动阈值
+constexpr uint32_t kProbeInit        = 7000;    ///< 窗口探测初始间隔
+constexpr uint32_t kProbeLimit       = 120000;  ///< 窗口探测最大间隔
+constexpr uint32_t kFastAckLimit     = 5;       ///< 快速重传次数上限
+constexpr uint32_t kMaxFragmentCount = 255;     ///< frg字段为u8
+
+/// 时间戳/序号差值，处理回绕
+TPN_INLINE int32_t TimeDiff(uint32_t later, uint32_t earlier) {
+  return static_cast<int32_t>(later - earlier);
+}
+
+template <typename T>
+TPN_INLINE uint8_t *EncodeValue(uint8_t *ptr, T value) {
+  EndianRefMakeLittle(value);
+  std::memcpy(ptr, &value, sizeof(T));
+  return ptr + sizeof(T);
+}
+
+template <typename T>
+TPN_INLINE const uint8_t *DecodeValue(const uint8_t *ptr, T &value) {
+  std::memcpy(&value, ptr, sizeof(T));
+  EndianRefMakeLittle(value);
+  return ptr + sizeof(T);
+}
+
+}  // namespace
+
+void KcpControl::Encode(uint8_t *data) const {
+  data = EncodeValue(data, this->conv);
+  data = EncodeValue(data, this->cmd);
+  EncodeValue(data, this->nonce);
+}
+
+bool KcpControl::Decode(const uint8_t *data, size_t size) {
+  if (kKcpControlSize != size) {
+    return false;
+  }
+  data = DecodeValue(data, this->conv);
+  data = DecodeValue(data, this->cmd);
+  DecodeValue(data, this->nonce);
+  return (kSyn == this->cmd || kAck == this->cmd || kFin == this->cmd);
+}
+
+Kcp::Kcp(uint32_t conv, OutputFunc output)
+    : conv_(conv),
+      mtu_(kKcpDefaultMtu),
+      mss_(kKcpDefaultMtu - kKcpOverhead),
+      ssthresh_(kThreshInit),
+      rx_rto_(kRtoDefault),
+      rx_minrto_(kRtoMin),
+      snd_wnd_(kWindowSend),
+      rcv_wnd_(kWindowRecv),
+      rmt_wnd_(kWindowRecv),
+      interval_(kInterval),
+      ts_flush_(kInterval),
+      dead_link_(kDeadLink),
+      fastlimit_(kFastAckLimit),
+      buffer_((kKcpDefaultMtu + kKcpOverhead) * 3),
+      output_(std::move(output)) {}
+
+void Kcp::SetOptions(const KcpOptions &options) {
+  this->nodelay_   = options.nodelay;
+  this->rx_minrto_ = options.nodelay ? kRtoNoDelay : kRtoMin;
+  this->interval_  = std::clamp<uint32_t>(options.interval, 10, 5000);
+  this->fastresend_ = options.fast_resend;
+  this->nocwnd_     = options.no_congestion;
+
+  if (0 < options.send_window) {
+    this->snd_wnd_ = options.send_window;
+  }
+  if (0 < options.recv_window) {
+    this->rcv_wnd_ = (std::max)(options.recv_window, kWindowRecv);
+  }
+
+  uint32_t mtu =
+      std::clamp<uint32_t>(options.mtu, 50, static_cast<uint32_t>(kKcpDatagramMax));
+  if (mtu != this->mtu_) {
+    this->mtu_ = mtu;
+    this->mss_ = mtu - kKcpOverhead;
+    this->buffer_.resize((mtu + kKcpOverhead) * 3);
+  }
+
+  if (0 < options.dead_link) {
+    this->dead_link_ = options.dead_link;
+  }
+}
+
+uint32_t Kcp::ReadConv(const uint8_t *data) {
+  uint32_t conv = 0;
+  DecodeValue(data, conv);
+  return conv;
+}
+
+uint8_t *Kcp::Encode(uint8_t *ptr, const Segment &seg) {
+  ptr = EncodeValue(ptr, seg.conv);
+  ptr = EncodeValue(ptr, seg.cmd);
+  ptr = EncodeValue(ptr, seg.frg);
+  ptr = EncodeValue(ptr, seg.wnd);
+  ptr = EncodeValue(ptr, seg.ts);
+  ptr = EncodeValue(ptr, seg.sn);
+  ptr = EncodeValue(ptr, seg.una);
+  ptr = EncodeValue(ptr, static_cast<uint32_t>(seg.data.size()));
+  return ptr;
+}
+
+int Kcp::PeekSize() const {
+  if (this->rcv_queue_.empty()) {
+    return -1;
+  }
+
+  const Segment &front = this->rcv_queue_.front();
+  if (0 == front.frg) {
+    return static_cast<int>(front.data.size());
+  }
+
+  // 分片还没有全部到达
+  if (this->rcv_queue_.size() < static_cast<size_t>(front.frg) + 1) {
+    return -1;
+  }
+
+  int length = 0;
+  for (const auto &seg : this->rcv_queue_) {
+    length += static_cast<int>(seg.data.size());
+    if (0 == seg.frg) {
+      break;
+    }
+  }
+  return length;
+}
+
+bool Kcp::Send(const uint8_t *data, size_t size) {
+  size_t count = (size <= this->mss_) ? 1 : (size + this->mss_ - 1) / this->mss_;
+
+  // 分片数超过对端接收窗口将永远无法组装完整
+  if (count >= (std::min)(this->rcv_wnd_, kMaxFragmentCount)) {
+    return false;
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    size_t length = (std::min)(size, static_cast<size_t>(this->mss_));
+
+    Segment seg;
+    seg.data.assign(data, data + length);
+    seg.frg = static_cast<uint8_t>(count - i - 1);
+    this->snd_queue_.emplace_back(std::move(seg));
+
+    data += length;
+    size -= length;
+  }
+  return true;
+}
+
+bool Kcp::Recv(MessageBuffer &buffer) {
+  int peek_size = this->PeekSize();
+  if (0 > peek_size) {
+    return false;
+  }
+
+  bool recover = (this->rcv_queue_.size() >= this->rcv_wnd_);
+
+  buffer.Resize(static_cast<size_t>(peek_size));
+  buffer.Reset();
+
+  // 合并分片
+  while (!this->rcv_queue_.empty()) {
+    Segment &seg = this->rcv_queue_.front();
+    uint8_t frg  = seg.frg;
+    if (!seg.data.empty()) {
+      buffer.Write(seg.data.data(), seg.data.size());
+    }
+    this->rcv_queue_.pop_front();
+    if (0 == frg) {
+      break;
+    }
+  }
+
+  this->MoveToRecvQueue();
+
+  // 接收窗口从满变为可用，主动告知对端
+  if (this->rcv_queue_.size() < this->rcv_wnd_ && recover) {
+    this->probe_ |= kAskTell;
+  }
+  return true;
+}
+
+uint16_t Kcp::GetUnusedWindow() const {
+  if (this->rcv_queue_.size() < this->rcv_wnd_) {
+    return static_cast<uint16_t>(this->rcv_wnd_ - this->rcv_queue_.size());
+  }
+  return 0;
+}
+
+void Kcp::UpdateAck(int32_t rtt) {
+  if (0 == this->rx_srtt_) {
+    this->rx_srtt_   = rtt;
+    this->rx_rttval_ = rtt / 2;
+  } else {
+    int32_t delta    = std::abs(rtt - this->rx_srtt_);
+    this->rx_rttval_ = (3 * this->rx_rttval_ + delta) / 4;
+    this->rx_srtt_   = (7 * this->rx_srtt_ + rtt) / 8;
+    if (1 > this->rx_srtt_) {
+      this->rx_srtt_ = 1;
+    }
+  }
+
+  int32_t rto = this->rx_srtt_ + (std::max)(static_cast<int32_t>(this->interval_),
+                                            4 * this->rx_rttval_);
+  this->rx_rto_ = std::clamp(rto, this->rx_minrto_, kRtoMax);
+}
+
+void Kcp::ShrinkBuffer() {
+  this->snd_una_ =
+      this->snd_buf_.empty() ? this->snd_nxt_ : this->snd_buf_.front().sn;
+}
+
+void Kcp::ParseAck(uint32_t sn) {
+  if (0 > TimeDiff(sn, this->snd_una_) || 0 <= TimeDiff(sn, this->snd_nxt_)) {
+    return;
+  }
+
+  for (auto it = this->snd_buf_.begin(); it != this->snd_buf_.end(); ++it) {
+    if (sn == it->sn) {
+      this->snd_buf_.erase(it);
+      break;
+    }
+    if (0 > TimeDiff(sn, it->sn)) {
+      break;
+    }
+  }
+}
+
+void Kcp::ParseUna(uint32_t una) {
+  while (!this->snd_buf_.empty() &&
+         0 > TimeDiff(this->snd_buf_.front().sn, una)) {
+    this->snd_buf_.pop_front();
+  }
+}
+
+void Kcp::ParseFastAck(uint32_t sn) {
+  if (0 > TimeDiff(sn, this->snd_una_) || 0 <= TimeDiff(sn, this->snd_nxt_)) {
+    return;
+  }
+
+  for (auto &seg : this->snd_buf_) {
+    if (0 > TimeDiff(sn, seg.sn)) {
+      break;
+    }
+    if (sn != seg.sn) {
+      ++seg.fastack;
+    }
+  }
+}
+
+void Kcp::ParseData(Segment &&seg) {
+  uint32_t sn = seg.sn;
+  if (0 <= TimeDiff(sn, this->rcv_nxt_ + this->rcv_wnd_) ||
+      0 > TimeDiff(sn, this->rcv_nxt_)) {
+    return;
+  }
+
+  // 从尾部找插入位置，按序到达时只比较一次
+  auto it = this->rcv_buf_.end();
+  while (it != this->rcv_buf_.begin()) {
+    auto prev = std::prev(it);
+    if (prev->sn == sn) {
+      return;
+    }
+    if (0 < TimeDiff(sn, prev->sn)) {
+      break;
+    }
+    it = prev;
+  }
+  this->rcv_buf_.insert(it, std::move(seg));
+
+  this->MoveToRecvQueue();
+}
+
+void Kcp::MoveToRecvQueue() {
+  while (!this->rcv_buf_.empty()) {
+    Segment &seg = this->rcv_buf_.front();
+    if (seg.sn != this->rcv_nxt_ ||
+        this->rcv_queue_.size() >= this->rcv_wnd_) {
+      break;
+    }
+    this->rcv_queue_.emplace_back(std::move(seg));
+    this->rcv_buf_.pop_front();
+    ++this->rcv_nxt_;
+  }
+}
+
+bool Kcp::Input(const uint8_t *data, size_t size, uint32_t current) {
+  if (nullptr == data || size < kKcpOverhead) {
+    return false;
+  }
+
+  this->current_ = current;
+
+  uint32_t prev_una = this->snd_una_;
+  uint32_t maxack   = 0;
+  bool has_ack      = false;
+
+  while (size >= kKcpOverhead) {
+    Segment seg;
+    uint32_t length = 0;
+
+    data = DecodeValue(data, seg.conv);
+    if (seg.conv != this->conv_) {
+      return false;
+    }
+    data = DecodeValue(data, seg.cmd);
+    data = DecodeValue(data, seg.frg);
+    data = DecodeValue(data, seg.wnd);
+    data = DecodeValue(data, seg.ts);
+    data = DecodeValue(data, seg.sn);
+    data = DecodeValue(data, seg.una);
+    data = DecodeValue(data, length);
+    size -= kKcpOverhead;
+
+    if (size < length) {
+      return false;
+    }
+
+    if (kCmdPush != seg.cmd && kCmdAck != seg.cmd &&
+        kCmdWindowAsk != seg.cmd && kCmdWindowTell != seg.cmd) {
+      return false;
+    }
+
+    this->rmt_wnd_ = seg.wnd;
+    this->ParseUna(seg.una);
+    this->ShrinkBuffer();
+
+    switch (seg.cmd) {
+      case kCmdAck: {
+        if (0 <= TimeDiff(this->current_, seg.ts)) {
+          this->UpdateAck(TimeDiff(this->current_, seg.ts));
+        }
+        this->ParseAck(seg.sn);
+        this->ShrinkBuffer();
+        if (!has_ack || 0 < TimeDiff(seg.sn, maxack)) {
+          has_ack = true;
+          maxack  = seg.sn;
+        }
+      } break;
+      case kCmdPush: {
+        if (0 > TimeDiff(seg.sn, this->rcv_nxt_ + this->rcv_wnd_)) {
+          this->acklist_.emplace_back(seg.sn, seg.ts);
+          if (0 <= TimeDiff(seg.sn, this->rcv_nxt_)) {
+            seg.data.assign(data, data + length);
+            this->ParseData(std::move(seg));
+          }
+        }
+      } break;
+      case kCmdWindowAsk: {
+        this->probe_ |= kAskTell;
+      } break;
+      default:
+        break;
+    }
+
+    data += length;
+    size -= length;
+  }
+
+  if (has_ack) {
+    this->ParseFastAck(maxack);
+  }
+
+  // 有新的确认，增大拥塞窗口
+  if (0 < TimeDiff(this->snd_una_, prev_una) && this->cwnd_ < this->rmt_wnd_) {
+    uint32_t mss = this->mss_;
+    if (this->cwnd_ < this->ssthresh_) {
+      ++this->cwnd_;
+      this->incr_ += mss;
+    } else {
+      if (this->incr_ < mss) {
+        this->incr_ = mss;
+      }
+      this->incr_ += (mss * mss) / this->incr_ + (mss / 16);
+      if ((this->cwnd_ + 1) * mss <= this->incr_) {
+        this->cwnd_ = (this->incr_ + mss - 1) / mss;
+      }
+    }
+    if (this->cwnd_ > this->rmt_wnd_) {
+      this->cwnd_ = this->rmt_wnd_;
+      this->incr_ = this->rmt_wnd_ * mss;
+    }
+  }
+  return true;
+}
+
+uint8_t *Kcp::FlushBuffer(uint8_t *ptr, size_t need) {
+  uint8_t *base = this->buffer_.data();
+  if (static_cast<size_t>(ptr - base) + need > this->mtu_) {
+    this->output_(base, static_cast<size_t>(ptr - base));
+    return base;
+  }
+  return ptr;
+}
+
+void Kcp::Flush(uint32_t current) {
+  this->current_ = current;
+  if (this->updated_) {
+    this->DoFlush();
+  }
+}
+
+void Kcp::DoFlush() {
+  uint32_t current = this->current_;
+  uint8_t *base    = this->buffer_.data();
+  uint8_t *ptr     = base;
+
+  Segment seg;
+  seg.conv = this->conv_;
+  seg.cmd  = kCmdAck;
+  seg.wnd  = this->GetUnusedWindow();
+  seg.una  = this->rcv_nxt_;
+
+  // ack
+  for (const auto &[sn, ts] : this->acklist_) {
+    ptr    = this->FlushBuffer(ptr, kKcpOverhead);
+    seg.sn = sn;
+    seg.ts = ts;
+    ptr    = Encode(ptr, seg);
+  }
+  this->acklist_.clear();
+
+  // 对端窗口为0时定时探测
+  if (0 == this->rmt_wnd_) {
+    if (0 == this->probe_wait_) {
+      this->probe_wait_ = kProbeInit;
+      this->ts_probe_   = current + this->probe_wait_;
+    } else if (0 <= TimeDiff(current, this->ts_probe_)) {
+      this->probe_wait_ = (std::max)(this->probe_wait_, kProbeInit);
+      this->probe_wait_ += this->probe_wait_ / 2;
+      this->probe_wait_ = (std::min)(this->probe_wait_, kProbeLimit);
+      this->ts_probe_   = current + this->probe_wait_;
+      this->probe_ |= kAskSend;
+    }
+  } else {
+    this->ts_probe_   = 0;
+    this->probe_wait_ = 0;
+  }
+
+  seg.sn = 0;
+  seg.ts = 0;
+  if (this->probe_ & kAskSend) {
+    seg.cmd = kCmdWindowAsk;
+    ptr     = this->FlushBuffer(ptr, kKcpOverhead);
+    ptr     = Encode(ptr, seg);
+  }
+  if (this->probe_ & kAskTell) {
+    seg.cmd = kCmdWindowTell;
+    ptr     = this->FlushBuffer(ptr, kKcpOverhead);
+    ptr     = Encode(ptr, seg);
+  }
+  this->probe_ = 0;
+
+  // 发送窗口
+  uint32_t cwnd = (std::min)(this->snd_wnd_, this->rmt_wnd_);
+  if (!this->nocwnd_) {
+    cwnd = (std::min)(this->cwnd_, cwnd);
+  }
+
+  // 发送队列移入发送缓冲区
+  while (0 > TimeDiff(this->snd_nxt_, this->snd_una_ + cwnd) &&
+         !this->snd_queue_.empty()) {
+    Segment &next = this->snd_buf_.emplace_back(
+        std::move(this->snd_queue_.front()));
+    this->snd_queue_.pop_front();
+
+    next.conv     = this->conv_;
+    next.cmd      = kCmdPush;
+    next.wnd      = seg.wnd;
+    next.ts       = current;
+    next.sn       = this->snd_nxt_++;
+    next.una      = this->rcv_nxt_;
+    next.resendts = current;
+    next.rto      = static_cast<uint32_t>(this->rx_rto_);
+    next.fastack  = 0;
+    next.xmit     = 0;
+  }
+
+  uint32_t resent = (0 < this->fastresend_) ? this->fastresend_ : 0xffffffff;
+  uint32_t rtomin = this->nodelay_ ? 0 : static_cast<uint32_t>(this->rx_rto_ >> 3);
+  bool change     = false;
+  bool lost       = false;
+
+  for (auto &segment : this->snd_buf_) {
+    bool need_send = false;
+
+    if (0 == segment.xmit) {  // 首次发送
+      need_send = true;
+      ++segment.xmit;
+      segment.rto      = static_cast<uint32_t>(this->rx_rto_);
+      segment.resendts = current + segment.rto + rtomin;
+    } else if (0 <= TimeDiff(current, segment.resendts)) {  // 超时重传
+      need_send = true;
+      ++segment.xmit;
+      ++this->xmit_;
+      if (!this->nodelay_) {
+        segment.rto += (std::max)(segment.rto,
+                                  static_cast<uint32_t>(this->rx_rto_));
+      } else {
+        segment.rto += segment.rto / 2;
+      }
+      segment.resendts = current + segment.rto;
+      lost             = true;
+    } else if (segment.fastack >= resent) {  // 快速重传
+      if (segment.xmit <= this->fastlimit_ || 0 == this->fastlimit_) {
+        need_send = true;
+        ++segment.xmit;
+        ++this->xmit_;
+        segment.fastack  = 0;
+        segment.resendts = current + segment.rto;
+        change           = true;
+      }
+    }
+
+    if (need_send) {
+      segment.ts  = current;
+      segment.wnd = seg.wnd;
+      segment.una = this->rcv_nxt_;
+
+      ptr = this->FlushBuffer(ptr, kKcpOverhead + segment.data.size());
+      ptr = Encode(ptr, segment);
+      if (!segment.data.empty()) {
+        std::memcpy(ptr, segment.data.data(), segment.data.size());
+        ptr += segment.data.size();
+      }
+
+      if (segment.xmit >= this->dead_link_) {
+        this->dead_ = true;
+      }
+    }
+  }
+
+  if (ptr > base) {
+    this->output_(base, static_cast<size_t>(ptr - base));
+  }
+
+  // 调整拥塞窗口
+  if (change) {
+    uint32_t inflight = this->snd_nxt_ - this->snd_una_;
+    this->ssthresh_   = (std::max)(inflight / 2, kThreshMin);
+    this->cwnd_       = this->ssthresh_ + resent;
+    this->incr_       = this->cwnd_ * this->mss_;
+  }
+  if (lost) {
+    this->ssthresh_ = (std::max)(cwnd / 2, kThreshMin);
+    this->cwnd_     = 1;
+    this->incr_     = this->mss_;
+  }
+  if (1 > this->cwnd_) {
+    this->cwnd_ = 1;
+    this->incr_ = this->mss_;
+  }
+}
+
+void Kcp::Update(uint32_t current) {
+  this->current_ = current;
+
+  if (!this->updated_) {
+    this->updated_  = true;
+    this->ts_flush_ = current;
+  }
+
+  int32_t slap = TimeDiff(current, this->ts_flush_);
+  if (10000 <= slap || -10000 > slap) {
+    this->ts_flush_ = current;
+    slap            = 0;
+  }
+
+  if (0 <= slap) {
+    this->ts_flush_ += this->interval_;
+    if (0 <= TimeDiff(current, this->ts_flush_)) {
+      this->ts_flush_ = current + this->interval_;
+    }
+    this->DoFlush();
+  }
+}
+
+uint32_t Kcp::Check(uint32_t current) const {
+  if (!this->updated_) {
+    return current;
+  }
+
+  uint32_t ts_flush = this->ts_flush_;
+  int32_t diff      = TimeDiff(current, ts_flush);
+  if (10000 <= diff || -10000 > diff) {
+    ts_flush = current;
+  }
+
+  if (0 <= TimeDiff(current, ts_flush)) {
+    return current;
+  }
+
+  int32_t tm_flush  = TimeDiff(ts_flush, current);
+  int32_t tm_packet = 0x7fffffff;
+  for (const auto &seg : this->snd_buf_) {
+    int32_t resend_diff = TimeDiff(seg.resendts, current);
+    if (0 >= resend_diff) {
+      return current;
+    }
+    tm_packet = (std::min)(tm_packet, resend_diff);
+  }
+
+  uint32_t minimal = static_cast<uint32_t>((std::min)(tm_packet, tm_flush));
+  return current + (std::min)(minimal, this->interval_);
+}
+
+}  // namespace net
+
+}  // namespace tpn
@@ -0,0 +1,267 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UTILITY_KCP_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UTILITY_KCP_H_
+
+#include <list>
+#include <deque>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+#include "define.h"
+#include "message_buffer.h"
+
+namespace tpn {
+
+namespace net {
+
+/// kcp默认mtu，需要小于链路mtu减去ip与udp头
+static constexpr uint32_t kKcpDefaultMtu = 1400;
+/// kcp单个数据报最大长度
+static constexpr size_t kKcpDatagramMax = 1500;
+/// kcp分片头长度
+static constexpr uint32_t kKcpOverhead = 24;
+
+/// kcp握手控制报文长度，小于 kKcpOverhead 以区分kcp数据报
+static constexpr size_t kKcpControlSize = 12;
+
+/// kcp握手控制报文 [conv u32][cmd u32][nonce u32] 小端
+/// 客户端以conv 0发送SYN，服务器分配conv后以ACK回复同一个nonce，
+/// 任意一方关闭时发送FIN，对端无需等待静默超时。
+struct TPN_NET_API KcpControl {
+  /// 控制命令
+  enum Command : uint32_t {
+    kSyn = 0x4b435001,  ///< 请求建立会话
+    kAck = 0x4b435002,  ///< 会话已建立
+    kFin = 0x4b435003,  ///< 会话关闭
+  };
+
+  uint32_t conv{0};   ///< 会话编号
+  uint32_t cmd{0};    ///< 控制命令
+  uint32_t nonce{0};  ///< 客户端随机数，用于识别重传的SYN
+
+  /// 编码
+  ///  @param[out]  data    长度至少 kKcpControlSize
+  void Encode(uint8_t *data) const;
+
+  /// 解码
+  ///  @param[in]   data    数据报
+  ///  @param[in]   size    数据报长度
+  ///  @return 是合法的控制报文返回true
+  bool Decode(const uint8_t *data, size_t size);
+};
+
+/// kcp可靠传输参数
+struct KcpOptions {
+  bool nodelay{true};          ///< 快速模式，最小rto 30ms且超时重传不翻倍
+  uint32_t interval{10};       ///< 内部刷新间隔(毫秒)，范围[10, 5000]
+  uint32_t fast_resend{2};     ///< 被跳过多少次ack后快速重传，0关闭
+  bool no_congestion{true};    ///< 关闭拥塞控制
+  uint32_t send_window{128};   ///< 发送窗口(分片数)
+  uint32_t recv_window{128};   ///< 接收窗口(分片数)
+  uint32_t mtu{kKcpDefaultMtu};  ///< 单个数据报最大长度
+  uint32_t dead_link{20};      ///< 单个分片重传多少次后认为链路断开
+};
+
+/// kcp可靠传输协议
+/// 与 https://github.com/skywind3000/kcp 的报文格式兼容的ARQ实现，
+/// 分片头 [conv u32][cmd u8][frg u8][wnd u16][ts u32][sn u32][una u32][len u32]
+/// 全部为小端。本类不做任何io，收到的数据报通过 Input 送入，
+/// 需要发送的数据报通过输出回调交给调用者，由调用者定时调用 Update。
+/// 非线程安全，需要在会话的strand中使用。
+class TPN_NET_API Kcp {
+ public:
+  /// 数据报输出回调 void(const uint8_t *data, size_t size)
+  using OutputFunc = std::function<void(const uint8_t *, size_t)>;
+
+  /// 构造函数
+  ///  @param[in]   conv      会话编号，通信双方必须一致
+  ///  @param[in]   output    数据报输出回调
+  Kcp(uint32_t conv, OutputFunc output);
+  ~Kcp() = default;
+
+  Kcp(const Kcp &)            = delete;
+  Kcp &operator=(const Kcp &) = delete;
+
+  /// 应用传输参数
+  ///  @param[in]   options   传输参数
+  void SetOptions(const KcpOptions &options);
+
+  /// 发送一条消息，消息过大会被切分，接收方会合并后整条返回
+  ///  @param[in]   data      消息
+  ///  @param[in]   size      消息长度
+  ///  @return 成功返回true，消息超过接收窗口能容纳的长度返回false
+  bool Send(const uint8_t *data, size_t size);
+
+  /// 接收一条完整的消息
+  ///  @param[out]  buffer    消息，成功时被重置为消息内容
+  ///  @return 有完整消息返回true
+  bool Recv(MessageBuffer &buffer);
+
+  /// 输入一个收到的数据报
+  ///  @param[in]   data      数据报
+  ///  @param[in]   size      数据报长度
+  ///  @param[in]   current   当前毫秒时间戳，用于计算rtt
+  ///  @return 成功返回true，会话编号不匹配或格式错误返回false
+  bool Input(const uint8_t *data, size_t size, uint32_t current);
+
+  /// 驱动协议时钟，到达刷新时间时发送ack、新数据与重传数据
+  ///  @param[in]   current   当前毫秒时间戳
+  void Update(uint32_t current);
+
+  /// 计算下一次需要调用 Update 的时间
+  ///  @param[in]   current   当前毫秒时间戳
+  ///  @return 下一次调用 Update 的毫秒时间戳
+  uint32_t Check(uint32_t current) const;
+
+  /// 立即发送ack与可发送的数据，不等待刷新间隔
+  ///  @param[in]   current   当前毫秒时间戳
+  void Flush(uint32_t current);
+
+  /// 是否空闲，没有待发送、待确认的数据与待回复的ack，
+  /// 空闲时不需要定时调用 Update
+  bool IsIdle() const {
+    return this->snd_buf_.empty() && this->snd_queue_.empty() &&
+           this->acklist_.empty() && 0 == this->probe_ && 0 != this->rmt_wnd_;
+  }
+
+  /// 获取等待发送(未被确认)的分片数
+  size_t GetWaitSend() const {
+    return this->snd_buf_.size() + this->snd_queue_.size();
+  }
+
+  /// 获取会话编号
+  uint32_t GetConv() const { return this->conv_; }
+
+  /// 获取平滑往返时间(毫秒)
+  uint32_t GetSrtt() const { return static_cast<uint32_t>(this->rx_srtt_); }
+
+  /// 获取累计重传次数
+  uint32_t GetRetransmit() const { return this->xmit_; }
+
+  /// 链路是否断开，某个分片重传次数超过 dead_link
+  bool IsDeadLink() const { return this->dead_; }
+
+  /// 从数据报中读取会话编号
+  ///  @param[in]   data      数据报，长度需要不小于 kKcpOverhead
+  static uint32_t ReadConv(const uint8_t *data);
+
+ private:
+  /// 分片
+  struct Segment {
+    uint32_t conv{0};
+    uint8_t cmd{0};
+    uint8_t frg{0};
+    uint16_t wnd{0};
+    uint32_t ts{0};
+    uint32_t sn{0};
+    uint32_t una{0};
+    uint32_t resendts{0};
+    uint32_t rto{0};
+    uint32_t fastack{0};
+    uint32_t xmit{0};
+    std::vector<uint8_t> data;
+  };
+
+  /// 编码分片头
+  static uint8_t *Encode(uint8_t *ptr, const Segment &seg);
+
+  /// 获取下一条完整消息长度，没有返回-1
+  int PeekSize() const;
+
+  /// 接收窗口剩余大小
+  uint16_t GetUnusedWindow() const;
+
+  /// 更新rtt与rto
+  void UpdateAck(int32_t rtt);
+
+  /// 根据发送缓冲区更新 snd_una_
+  void ShrinkBuffer();
+
+  /// 移除被确认的分片
+  void ParseAck(uint32_t sn);
+
+  /// 移除una之前的分片
+  void ParseUna(uint32_t una);
+
+  /// 统计被跳过的ack
+  void ParseFastAck(uint32_t sn);
+
+  /// 收到数据分片
+  void ParseData(Segment &&seg);
+
+  /// 将接收缓冲区中连续的分片移到接收队列
+  void MoveToRecvQueue();
+
+  /// 发送ack、窗口探测、新数据与重传数据
+  void DoFlush();
+
+  /// 缓冲区数据超过mtu时输出
+  uint8_t *FlushBuffer(uint8_t *ptr, size_t need);
+
+ private:
+  uint32_t conv_;       ///< 会话编号
+  uint32_t mtu_;        ///< 数据报最大长度
+  uint32_t mss_;        ///< 分片数据最大长度
+  bool dead_{false};    ///< 链路是否断开
+  uint32_t snd_una_{0};  ///< 第一个未确认的发送序号
+  uint32_t snd_nxt_{0};  ///< 下一个发送序号
+  uint32_t rcv_nxt_{0};  ///< 下一个期待的接收序号
+  uint32_t ssthresh_;   ///< 慢启动阈值
+  int32_t rx_rttval_{0};  ///< rtt偏差
+  int32_t rx_srtt_{0};  ///< 平滑rtt
+  int32_t rx_rto_;      ///< 重传超时
+  int32_t rx_minrto_;   ///< 最小重传超时
+  uint32_t snd_wnd_;    ///< 发送窗口
+  uint32_t rcv_wnd_;    ///< 接收窗口
+  uint32_t rmt_wnd_;    ///< 远端接收窗口
+  uint32_t cwnd_{0};    ///< 拥塞窗口
+  uint32_t probe_{0};   ///< 窗口探测标记
+  uint32_t current_{0};  ///< 当前时间
+  uint32_t interval_;   ///< 刷新间隔
+  uint32_t ts_flush_;   ///< 下一次刷新时间
+  uint32_t xmit_{0};    ///< 累计重传次数
+  bool nodelay_{false};  ///< 快速模式
+  bool updated_{false};  ///< 是否调用过Update
+  uint32_t ts_probe_{0};    ///< 下一次窗口探测时间
+  uint32_t probe_wait_{0};  ///< 窗口探测等待时长
+  uint32_t dead_link_;  ///< 判定断开的重传次数
+  uint32_t incr_{0};    ///< 拥塞窗口增量
+  uint32_t fastresend_{0};  ///< 快速重传跳过次数
+  uint32_t fastlimit_;  ///< 快速重传次数上限
+  bool nocwnd_{false};  ///< 关闭拥塞控制
+  std::deque<Segment> snd_queue_;  ///< 等待进入发送窗口的分片
+  std::deque<Segment> rcv_queue_;  ///< 已按序到达等待用户读取的分片
+  std::list<Segment> snd_buf_;     ///< 已发送等待确认的分片
+  std::list<Segment> rcv_buf_;     ///< 乱序到达的分片
+  std::vector<std::pair<uint32_t, uint32_t>> acklist_;  ///< 待发送的ack(sn, ts)
+  std::vector<uint8_t> buffer_;  ///< 输出数据报拼装缓冲区
+  OutputFunc output_;            ///< 数据报输出回调
+};
+
+}  // namespace net
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UTILITY_KCP_H_
@@ -0,0 +1,305 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UTILITY_KCP_STREAM_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UTILITY_KCP_STREAM_H_
+
+#include <memory>
+#include <cstring>
+
+#include "byte_converter.h"
+#include "chrono_wrap.h"
+#include "coarse_clock.h"
+#include "message_buffer.h"
+#include "rpc_type.pb.h"
+#include "net_common.h"
+#include "io_pool.h"
+#include "custom_allocator.h"
+#include "kcp.h"
+
+namespace tpn {
+
+namespace net {
+
+/// kcp可靠流
+/// 持有kcp状态机与驱动它的定时器，把收到的数据报送入kcp，
+/// 把kcp组装好的消息按tcp相同的格式 [u16 header_length][header][body]
+/// 拆包后通过 FireRecv 通知子类，因此服务分发与tcp完全一致。
+/// 没有待发送与待确认的数据时定时器不再提交，空闲会话不占用定时器。
+///  @tparam  Derived
+///  @tparam  ArgsType
+template <typename Derived, typename ArgsType = void>
+class KcpStream {
+ public:
+  /// 构造函数
+  ///  @param[in]   io_handle   io句柄
+  explicit KcpStream(IoHandle &io_handle)
+      : kcp_timer_(io_handle.GetIoContext()) {}
+
+  ~KcpStream() = default;
+
+  /// 设置kcp传输参数，下一次建立会话时生效
+  ///  @param[in]   options   传输参数
+  ///  @return CRTP对象自身引用 用于链式调用
+  TPN_INLINE Derived &SetKcpOptions(const KcpOptions &options) {
+    this->kcp_options_ = options;
+    return (CRTP_CAST(this));
+  }
+
+  /// 获取kcp传输参数
+  TPN_INLINE const KcpOptions &GetKcpOptions() const {
+    return this->kcp_options_;
+  }
+
+  /// 获取kcp会话编号，未建立返回0
+  TPN_INLINE uint32_t GetConv() const { return this->conv_; }
+
+ protected:
+  /// kcp毫秒时钟
+  static TPN_INLINE uint32_t KcpClock() {
+    return static_cast<uint32_t>(
+        std::chrono::duration_cast<MilliSeconds>(
+            g_coarse_clock->SteadyNow(CoarseClockUser::kCoarseClockUserNet)
+                .time_since_epoch())
+            .count());
+  }
+
+  /// 建立kcp状态机
+  ///  @param[in]   conv      会话编号
+  TPN_INLINE void KcpCreate(uint32_t conv) {
+    Derived &derive = CRTP_CAST(this);
+
+    this->conv_ = conv;
+    this->kcp_  = std::make_unique<Kcp>(
+        conv, [&derive](const uint8_t *data, size_t size) {
+          derive.UdpSendAppend(data, size);
+        });
+    this->kcp_->SetOptions(this->kcp_options_);
+    this->kcp_->Update(KcpClock());
+  }
+
+  /// 停止kcp定时器
+  TPN_INLINE void KcpStop() {
+    this->kcp_timer_armed_ = false;
+    this->kcp_timer_.cancel(s_ec_ignore);
+  }
+
+  /// 发送一条消息
+  ///  @tparam      Callback  发送数据完回调类型
+  ///  @param[in]   buffer    调用需要保证buffer满足底层拆包逻辑
+  ///  @param[in]   callback  发送数据回调
+  ///  @return 发送成功返回true
+  template <typename Callback>
+  TPN_INLINE bool KcpSend(const MessageBuffer &buffer, Callback &&callback) {
+    Derived &derive = CRTP_CAST(this);
+
+    std::error_code ec;
+    size_t bytes_sent = buffer.GetBufferSize();
+
+    if (!derive.IsStarted() || !this->kcp_) {
+      ec         = asio::error::not_connected;
+      bytes_sent = 0;
+    } else if (!this->kcp_->Send(buffer.GetBasePointer(), bytes_sent)) {
+      NET_WARN("KcpStream KcpSend message size {} error", bytes_sent);
+      ec         = asio::error::message_size;
+      bytes_sent = 0;
+    } else {
+      derive.GetIoHandle().GetLoad().AddBytes(bytes_sent);
+
+      // 不等待下一次刷新，窗口允许时立即发出
+      this->kcp_->Flush(KcpClock());
+      derive.UdpSendFlush();
+      this->KcpArmTimer();
+    }
+
+    SetLastError(ec);
+
+    // 回调会释放事件队列守卫，必须在当前事件函数返回之后执行
+    asio::post(derive.GetIoHandle().GetStrand(),
+               MakeAllocator(derive.GetWriteAllocator(),
+                             [ec, bytes_sent, self_ptr = derive.GetSelfSptr(),
+                              callback = std::forward<Callback>(
+                                  callback)]() mutable {
+                               callback(ec, bytes_sent);
+                             }));
+    return true;
+  }
+
+  /// 处理收到的kcp数据报
+  ///  @param[in]   data      数据报
+  ///  @param[in]   size      数据报长度
+  ///  @param[in]   this_ptr  延长生命周期句柄
+  TPN_INLINE void KcpHandleDatagram(const uint8_t *data, size_t size,
+                                    std::shared_ptr<Derived> &this_ptr) {
+    Derived &derive = CRTP_CAST(this);
+
+    if (!this->kcp_) {
+      return;
+    }
+
+    uint32_t current = KcpClock();
+    if (!this->kcp_->Input(data, size, current)) {
+      NET_DEBUG("KcpStream KcpHandleDatagram conv {} size {} error",
+                this->conv_, size);
+      return;
+    }
+
+    // 更新收到包的时间
+    derive.UpdateAliveTime();
+    derive.GetIoHandle().GetLoad().AddBytes(size);
+
+    while (this->kcp_->Recv(this->kcp_message_)) {
+      if (!this->KcpHandleMessage(this_ptr)) {
+        derive.DoDisconnect(asio::error::message_size);
+        return;
+      }
+
+      // FireRecv 中可能关闭了会话
+      if (!derive.IsStarted()) {
+        return;
+      }
+    }
+
+    // 立即回复ack，不等待刷新间隔
+    this->kcp_->Flush(current);
+    derive.UdpSendFlush();
+
+    this->KcpArmTimer();
+  }
+
+  /// 需要时提交kcp定时器
+  TPN_INLINE void KcpArmTimer() {
+    Derived &derive = CRTP_CAST(this);
+
+    if (this->kcp_timer_armed_ || !this->kcp_ || this->kcp_->IsIdle()) {
+      return;
+    }
+
+    this->kcp_timer_armed_ = true;
+
+    uint32_t current = KcpClock();
+    uint32_t next    = this->kcp_->Check(current);
+
+    this->kcp_timer_.expires_after(MilliSeconds(next - current));
+    this->kcp_timer_.async_wait(asio::bind_executor(
+        derive.GetIoHandle().GetStrand(),
+        MakeAllocator(derive.GetReadAllocator(),
+                      [&derive, self_ptr = derive.GetSelfSptr()](
+                          const std::error_code &ec) mutable {
+                        derive.KcpHandleTimer(ec);
+                      })));
+  }
+
+  /// 处理kcp定时器
+  ///  @param[in]   ec        错误码
+  TPN_INLINE void KcpHandleTimer(const std::error_code &ec) {
+    Derived &derive = CRTP_CAST(this);
+
+    if (ec || !this->kcp_timer_armed_) {
+      return;
+    }
+
+    this->kcp_timer_armed_ = false;
+
+    if (!this->kcp_ || !derive.IsStarted()) {
+      return;
+    }
+
+    this->kcp_->Update(KcpClock());
+    derive.UdpSendFlush();
+
+    if (this->kcp_->IsDeadLink()) {
+      NET_WARN("KcpStream conv {} dead link retransmit {}", this->conv_,
+               this->kcp_->GetRetransmit());
+      derive.DoDisconnect(asio::error::timed_out);
+      return;
+    }
+
+    this->KcpArmTimer();
+  }
+
+  /// 拆包kcp组装好的消息并通知子类
+  ///  @param[in]   this_ptr  延长生命周期句柄
+  ///  @return 格式错误返回false
+  TPN_INLINE bool KcpHandleMessage(std::shared_ptr<Derived> &this_ptr) {
+    Derived &derive = CRTP_CAST(this);
+
+    const uint8_t *buffer = this->kcp_message_.GetReadPointer();
+    size_t size           = this->kcp_message_.GetActiveSize();
+
+    if (kHeaderBytes > size) [[unlikely]] {
+      NET_ERROR("KcpStream KcpHandleMessage size {} error", size);
+      return false;
+    }
+
+    // 解析包头长度
+    uint16_t header_length = 0;
+    std::memcpy(&header_length, buffer, sizeof(header_length));
+    tpn::EndianRefMakeLittle(header_length);
+    if ((0 == header_length) || (header_length + kHeaderBytes > size))
+        [[unlikely]] {
+      NET_ERROR("KcpStream KcpHandleMessage header_length {} error",
+                header_length);
+      return false;
+    }
+
+    // 解析包头
+    protocol::Header header;
+    if (!header.ParseFromArray(buffer + kHeaderBytes, header_length))
+        [[unlikely]] {
+      NET_ERROR("KcpStream KcpHandleMessage header parse header_length {} error",
+                header_length);
+      return false;
+    }
+
+    if (header.size() + header_length + kHeaderBytes > size) [[unlikely]] {
+      NET_ERROR("KcpStream KcpHandleMessage header_length {} packet_length {} error",
+                header_length, header.size());
+      return false;
+    }
+
+    MessageBuffer packet(0);
+    packet.Resize(header.size());
+    packet.Reset();
+    if (0 != header.size()) {
+      packet.Write(buffer + kHeaderBytes + header_length, header.size());
+    }
+
+    // 通知会话拆包后的数据
+    derive.FireRecv(this_ptr, std::move(header), std::move(packet));
+    return true;
+  }
+
+ protected:
+  KcpOptions kcp_options_;          ///< kcp传输参数
+  uint32_t conv_{0};                ///< kcp会话编号
+  std::unique_ptr<Kcp> kcp_;        ///< kcp状态机
+  asio::steady_timer kcp_timer_;    ///< kcp刷新定时器
+  bool kcp_timer_armed_{false};     ///< kcp刷新定时器是否已提交
+  MessageBuffer kcp_message_;       ///< kcp组装好的消息
+};
+
+}  // namespace net
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UTILITY_KCP_STREAM_H_
@@ -0,0 +1,176 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "udp_batch.h"
+
+#include <array>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__linux__)
+#  include <cerrno>
+#  include <sys/socket.h>
+#  include <sys/uio.h>
+#endif
+
+namespace tpn {
+
+namespace net {
+
+void UdpSendBatch::Append(const uint8_t *data, size_t size) {
+  this->data_.insert(this->data_.end(), data, data + size);
+  this->sizes_.emplace_back(size);
+}
+
+size_t UdpSendBatch::Send(asio::ip::udp::socket &socket,
+                          const asio::ip::udp::endpoint *endpoint,
+                          std::error_code &ec) {
+  size_t count = this->sizes_.size();
+  size_t sent  = 0;
+
+#if defined(__linux__)
+  std::array<mmsghdr, kUdpBatchSize> msgs;
+  std::array<iovec, kUdpBatchSize> iovs;
+
+  size_t offset = 0;
+  for (size_t i = 0; i < count; ++i) {
+    iovs[i].iov_base = this->data_.data() + offset;
+    iovs[i].iov_len  = this->sizes_[i];
+    offset += this->sizes_[i];
+
+    std::memset(&msgs[i], 0, sizeof(mmsghdr));
+    if (nullptr != endpoint) {
+      msgs[i].msg_hdr.msg_name    = const_cast<void *>(
+          static_cast<const void *>(endpoint->data()));
+      msgs[i].msg_hdr.msg_namelen = static_cast<socklen_t>(endpoint->size());
+    }
+    msgs[i].msg_hdr.msg_iov    = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  while (sent < count) {
+    int result = ::sendmmsg(socket.native_handle(), msgs.data() + sent,
+                            static_cast<unsigned int>(count - sent),
+                            MSG_DONTWAIT);
+    if (0 > result) {
+      if (EINTR == errno) {
+        continue;
+      }
+      // 发送缓冲区满或对端不可达，剩余数据报交给kcp重传
+      ec = std::error_code(errno, asio::error::get_system_category());
+      break;
+    }
+    sent += static_cast<size_t>(result);
+  }
+#else
+  size_t offset = 0;
+  for (size_t i = 0; i < count; ++i) {
+    asio::const_buffer buffer(this->data_.data() + offset, this->sizes_[i]);
+    offset += this->sizes_[i];
+    if (nullptr != endpoint) {
+      socket.send_to(buffer, *endpoint, 0, ec);
+    } else {
+      socket.send(buffer, 0, ec);
+    }
+    if (ec) {
+      break;
+    }
+    ++sent;
+  }
+#endif
+
+  this->Clear();
+  return sent;
+}
+
+UdpRecvBatch::UdpRecvBatch(size_t capacity)
+    : capacity_((std::min)((std::max)(capacity, static_cast<size_t>(1)),
+                           kUdpBatchSize)),
+      data_(capacity_ * kKcpDatagramMax),
+      sizes_(capacity_),
+      endpoints_(capacity_) {}
+
+size_t UdpRecvBatch::Receive(asio::ip::udp::socket &socket,
+                             std::error_code &ec) {
+#if defined(__linux__)
+  std::array<mmsghdr, kUdpBatchSize> msgs;
+  std::array<iovec, kUdpBatchSize> iovs;
+
+  for (size_t i = 0; i < this->capacity_; ++i) {
+    iovs[i].iov_base = this->data_.data() + i * kKcpDatagramMax;
+    iovs[i].iov_len  = kKcpDatagramMax;
+
+    std::memset(&msgs[i], 0, sizeof(mmsghdr));
+    msgs[i].msg_hdr.msg_name    = this->endpoints_[i].data();
+    msgs[i].msg_hdr.msg_namelen =
+        static_cast<socklen_t>(this->endpoints_[i].capacity());
+    msgs[i].msg_hdr.msg_iov    = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  int result = 0;
+  do {
+    result = ::recvmmsg(socket.native_handle(), msgs.data(),
+                        static_cast<unsigned int>(this->capacity_),
+                        MSG_DONTWAIT, nullptr);
+  } while (0 > result && EINTR == errno);
+
+  if (0 > result) {
+    if (EAGAIN != errno && EWOULDBLOCK != errno) {
+      ec = std::error_code(errno, asio::error::get_system_category());
+    }
+    return 0;
+  }
+
+  for (int i = 0; i < result; ++i) {
+    this->sizes_[i] = msgs[i].msg_len;
+    this->endpoints_[i].resize(msgs[i].msg_hdr.msg_namelen);
+  }
+  return static_cast<size_t>(result);
+#else
+  socket.non_blocking(true, ec);
+  if (ec) {
+    return 0;
+  }
+
+  size_t count = 0;
+  while (count < this->capacity_) {
+    std::error_code recv_ec;
+    size_t size = socket.receive_from(
+        asio::buffer(this->data_.data() + count * kKcpDatagramMax,
+                     kKcpDatagramMax),
+        this->endpoints_[count], 0, recv_ec);
+    if (recv_ec) {
+      if (asio::error::would_block != recv_ec) {
+        ec = recv_ec;
+      }
+      break;
+    }
+    this->sizes_[count++] = size;
+  }
+  return count;
+#endif
+}
+
+}  // namespace net
+
+}  // namespace tpn
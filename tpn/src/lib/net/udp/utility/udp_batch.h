@@ -0,0 +1,119 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UTILITY_UDP_BATCH_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UTILITY_UDP_BATCH_H_
+
+#include <vector>
+#include <cstdint>
+
+#include "define.h"
+#include "asio_wrap.h"
+#include "kcp.h"
+
+namespace tpn {
+
+namespace net {
+
+/// 单次系统调用批量收发的最大数据报数
+static constexpr size_t kUdpBatchSize = 64;
+
+/// udp批量发送
+/// 数据报依次拷贝进连续缓冲区，Linux下通过一次 sendmmsg 全部发出，
+/// 其他平台退化为逐个非阻塞 send_to。
+/// 缓冲区只增不减，会话稳定后不再有内存申请。
+class TPN_NET_API UdpSendBatch {
+ public:
+  UdpSendBatch()  = default;
+  ~UdpSendBatch() = default;
+
+  /// 追加一个数据报
+  ///  @param[in]   data    数据报
+  ///  @param[in]   size    数据报长度
+  void Append(const uint8_t *data, size_t size);
+
+  /// 发送所有数据报并清空
+  ///  @param[in]   socket    udp套接字
+  ///  @param[in]   endpoint  目标地址，已连接的套接字传nullptr
+  ///  @param[out]  ec        错误码，对端不可达等错误不影响其余数据报
+  ///  @return 发出的数据报数
+  size_t Send(asio::ip::udp::socket &socket,
+              const asio::ip::udp::endpoint *endpoint, std::error_code &ec);
+
+  /// 是否已满，满了需要立即发送
+  bool IsFull() const { return this->sizes_.size() >= kUdpBatchSize; }
+
+  /// 是否为空
+  bool IsEmpty() const { return this->sizes_.empty(); }
+
+  /// 丢弃所有未发送的数据报
+  void Clear() {
+    this->data_.clear();
+    this->sizes_.clear();
+  }
+
+ private:
+  std::vector<uint8_t> data_;   ///< 数据报连续存放
+  std::vector<size_t> sizes_;   ///< 每个数据报长度
+};
+
+/// udp批量接收
+/// Linux下通过一次 recvmmsg 非阻塞读取最多 capacity 个数据报，
+/// 其他平台退化为逐个非阻塞 receive_from。
+class TPN_NET_API UdpRecvBatch {
+ public:
+  /// 构造函数
+  ///  @param[in]   capacity  单次最多接收的数据报数，不超过 kUdpBatchSize
+  explicit UdpRecvBatch(size_t capacity = kUdpBatchSize);
+  ~UdpRecvBatch() = default;
+
+  /// 非阻塞接收一批数据报
+  ///  @param[in]   socket    udp套接字
+  ///  @param[out]  ec        错误码，没有数据时不设置错误
+  ///  @return 收到的数据报数，0表示当前没有数据
+  size_t Receive(asio::ip::udp::socket &socket, std::error_code &ec);
+
+  /// 获取第index个数据报
+  const uint8_t *GetData(size_t index) const {
+    return this->data_.data() + index * kKcpDatagramMax;
+  }
+
+  /// 获取第index个数据报长度
+  size_t GetSize(size_t index) const { return this->sizes_[index]; }
+
+  /// 获取第index个数据报来源地址
+  const asio::ip::udp::endpoint &GetEndpoint(size_t index) const {
+    return this->endpoints_[index];
+  }
+
+ private:
+  size_t capacity_;                                ///< 单次最多接收数
+  std::vector<uint8_t> data_;                      ///< 接收缓冲区
+  std::vector<size_t> sizes_;                      ///< 每个数据报长度
+  std::vector<asio::ip::udp::endpoint> endpoints_;  ///< 每个数据报来源
+};
+
+}  // namespace net
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UTILITY_UDP_BATCH_H_
@@ -0,0 +1,90 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UTILITY_WRAPPER_UDP_SEND_WRAP_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UTILITY_WRAPPER_UDP_SEND_WRAP_H_
+
+#include "net_common.h"
+#include "udp_batch.h"
+
+namespace tpn {
+
+namespace net {
+
+/// udp数据报发送
+/// kcp输出的数据报先攒进批量缓冲区，在一次收包处理或定时刷新结束时
+/// 通过 UdpSendFlush 一次系统调用全部发出。
+/// 子类需要提供 GetSendSocket() 与 GetSendEndpoint()，已连接的套接字端点返回nullptr。
+///  @tparam  Derived
+///  @tparam  ArgsType
+template <typename Derived, typename ArgsType = void>
+class UdpSendWrap {
+ public:
+  UdpSendWrap()  = default;
+  ~UdpSendWrap() = default;
+
+ protected:
+  /// 追加一个待发送的数据报，批量缓冲区满时立即发送
+  ///  @param[in]   data    数据报
+  ///  @param[in]   size    数据报长度
+  TPN_INLINE void UdpSendAppend(const uint8_t *data, size_t size) {
+    this->send_batch_.Append(data, size);
+    if (this->send_batch_.IsFull()) {
+      this->UdpSendFlush();
+    }
+  }
+
+  /// 发送所有待发送的数据报
+  TPN_INLINE void UdpSendFlush() {
+    if (this->send_batch_.IsEmpty()) {
+      return;
+    }
+
+    Derived &derive = CRTP_CAST(this);
+
+    std::error_code ec;
+    this->send_batch_.Send(derive.GetSendSocket(), derive.GetSendEndpoint(),
+                           ec);
+    if (ec) {
+      // udp发送失败不断开，丢失的数据报由kcp重传
+      NET_DEBUG("UdpSendWrap UdpSendFlush error {}", ec);
+    }
+  }
+
+  /// 立即发送一个控制报文
+  ///  @param[in]   control   控制报文
+  TPN_INLINE void UdpSendControl(const KcpControl &control) {
+    uint8_t data[kKcpControlSize];
+    control.Encode(data);
+    this->UdpSendAppend(data, sizeof(data));
+    this->UdpSendFlush();
+  }
+
+ protected:
+  UdpSendBatch send_batch_;  ///< 批量发送缓冲区
+};
+
+}  // namespace net
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_NET_UDP_UTILITY_WRAPPER_UDP_SEND_WRAP_H_
@@ -14,6 +14,7 @@
 #include <google/protobuf/wire_format.h>
 #include "log.h"
 #include "debug_hub.h"
+#include "service_arena.h"
 // @@protoc_insertion_point(includes)
 #include <google/protobuf/port_def.inc>
 
@@ -96,11 +97,53 @@ struct TChatNtfDefaultTypeInternal {
   };
 };
 PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT TChatNtfDefaultTypeInternal _TChatNtf_default_instance_;
+constexpr TItem::TItem(
+  ::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized)
+  : attrs_()
+  , _attrs_cached_byte_size_(0)
+  , gems_()
+  , name_(&::PROTOBUF_NAMESPACE_ID::internal::fixed_address_empty_string)
+  , guid_(uint64_t{0u})
+  , config_id_(0u)
+  , count_(0u){}
+struct TItemDefaultTypeInternal {
+  constexpr TItemDefaultTypeInternal()
+    : _instance(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized{}) {}
+  ~TItemDefaultTypeInternal() {}
+  union {
+    TItem _instance;
+  };
+};
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT TItemDefaultTypeInternal _TItem_default_instance_;
+constexpr TInventoryRequest::TInventoryRequest(
+  ::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized)
+  : items_(){}
+struct TInventoryRequestDefaultTypeInternal {
+  constexpr TInventoryRequestDefaultTypeInternal()
+    : _instance(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized{}) {}
+  ~TInventoryRequestDefaultTypeInternal() {}
+  union {
+    TInventoryRequest _instance;
+  };
+};
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT TInventoryRequestDefaultTypeInternal _TInventoryRequest_default_instance_;
+constexpr TInventoryResponse::TInventoryResponse(
+  ::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized)
+  : items_(){}
+struct TInventoryResponseDefaultTypeInternal {
+  constexpr TInventoryResponseDefaultTypeInternal()
+    : _instance(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized{}) {}
+  ~TInventoryResponseDefaultTypeInternal() {}
+  union {
+    TInventoryResponse _instance;
+  };
+};
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT TInventoryResponseDefaultTypeInternal _TInventoryResponse_default_instance_;
 }  // namespace protocol
 }  // namespace tpn
-static ::PROTOBUF_NAMESPACE_ID::Metadata file_level_metadata_protocol_2ftest_5fservice_2eproto[6];
+static ::PROTOBUF_NAMESPACE_ID::Metadata file_level_metadata_protocol_2ftest_5fservice_2eproto[9];
 static constexpr ::PROTOBUF_NAMESPACE_ID::EnumDescriptor const** file_level_enum_descriptors_protocol_2ftest_5fservice_2eproto = nullptr;
-static const ::PROTOBUF_NAMESPACE_ID::ServiceDescriptor* file_level_service_descriptors_protocol_2ftest_5fservice_2eproto[5];
+static const ::PROTOBUF_NAMESPACE_ID::ServiceDescriptor* file_level_service_descriptors_protocol_2ftest_5fservice_2eproto[7];
 
 const ::PROTOBUF_NAMESPACE_ID::uint32 TableStruct_protocol_2ftest_5fservice_2eproto::offsets[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
   ~0u,  // no _has_bits_
@@ -143,6 +186,29 @@ const ::PROTOBUF_NAMESPACE_ID::uint32 TableStruct_protocol_2ftest_5fservice_2epr
   ~0u,  // no _oneof_case_
   ~0u,  // no _weak_field_map_
   PROTOBUF_FIELD_OFFSET(::tpn::protocol::TChatNtf, message_list_),
+  ~0u,  // no _has_bits_
+  PROTOBUF_FIELD_OFFSET(::tpn::protocol::TItem, _internal_metadata_),
+  ~0u,  // no _extensions_
+  ~0u,  // no _oneof_case_
+  ~0u,  // no _weak_field_map_
+  PROTOBUF_FIELD_OFFSET(::tpn::protocol::TItem, guid_),
+  PROTOBUF_FIELD_OFFSET(::tpn::protocol::TItem, config_id_),
+  PROTOBUF_FIELD_OFFSET(::tpn::protocol::TItem, count_),
+  PROTOBUF_FIELD_OFFSET(::tpn::protocol::TItem, name_),
+  PROTOBUF_FIELD_OFFSET(::tpn::protocol::TItem, attrs_),
+  PROTOBUF_FIELD_OFFSET(::tpn::protocol::TItem, gems_),
+  ~0u,  // no _has_bits_
+  PROTOBUF_FIELD_OFFSET(::tpn::protocol::TInventoryRequest, _internal_metadata_),
+  ~0u,  // no _extensions_
+  ~0u,  // no _oneof_case_
+  ~0u,  // no _weak_field_map_
+  PROTOBUF_FIELD_OFFSET(::tpn::protocol::TInventoryRequest, items_),
+  ~0u,  // no _has_bits_
+  PROTOBUF_FIELD_OFFSET(::tpn::protocol::TInventoryResponse, _internal_metadata_),
+  ~0u,  // no _extensions_
+  ~0u,  // no _oneof_case_
+  ~0u,  // no _weak_field_map_
+  PROTOBUF_FIELD_OFFSET(::tpn::protocol::TInventoryResponse, items_),
 };
 static const ::PROTOBUF_NAMESPACE_ID::internal::MigrationSchema schemas[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
   { 0, -1, sizeof(::tpn::protocol::SearchRequest)},
@@ -151,6 +217,9 @@ static const ::PROTOBUF_NAMESPACE_ID::internal::MigrationSchema schemas[] PROTOB
   { 22, -1, sizeof(::tpn::protocol::TUpdateInfoRequest)},
   { 28, -1, sizeof(::tpn::protocol::TChatRequest)},
   { 34, -1, sizeof(::tpn::protocol::TChatNtf)},
+  { 40, -1, sizeof(::tpn::protocol::TItem)},
+  { 51, -1, sizeof(::tpn::protocol::TInventoryRequest)},
+  { 57, -1, sizeof(::tpn::protocol::TInventoryResponse)},
 };
 
 static ::PROTOBUF_NAMESPACE_ID::Message const * const file_default_instances[] = {
@@ -160,6 +229,9 @@ static ::PROTOBUF_NAMESPACE_ID::Message const * const file_default_instances[] =
   reinterpret_cast<const ::PROTOBUF_NAMESPACE_ID::Message*>(&::tpn::protocol::_TUpdateInfoRequest_default_instance_),
   reinterpret_cast<const ::PROTOBUF_NAMESPACE_ID::Message*>(&::tpn::protocol::_TChatRequest_default_instance_),
   reinterpret_cast<const ::PROTOBUF_NAMESPACE_ID::Message*>(&::tpn::protocol::_TChatNtf_default_instance_),
+  reinterpret_cast<const ::PROTOBUF_NAMESPACE_ID::Message*>(&::tpn::protocol::_TItem_default_instance_),
+  reinterpret_cast<const ::PROTOBUF_NAMESPACE_ID::Message*>(&::tpn::protocol::_TInventoryRequest_default_instance_),
+  reinterpret_cast<const ::PROTOBUF_NAMESPACE_ID::Message*>(&::tpn::protocol::_TInventoryResponse_default_instance_),
 };
 
 const char descriptor_table_protodef_protocol_2ftest_5fservice_2eproto[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) =
@@ -171,42 +243,59 @@ const char descriptor_table_protodef_protocol_2ftest_5fservice_2eproto[] PROTOBU
   "6\n\006Result\022\013\n\003url\030\001 \001(\t\022\r\n\005title\030\002 \001(\t\022\020\n"
   "\010snippets\030\003 \003(\t\"\"\n\022TUpdateInfoRequest\022\014\n"
   "\004name\030\001 \001(\t\"\037\n\014TChatRequest\022\017\n\007message\030\001"
-  " \001(\t\" \n\010TChatNtf\022\024\n\014message_list\030\001 \003(\t2\347"
-  "\001\n\014TestService1\022W\n\026ProcessClientRequest1"
-  "1\022\033.tpn.protocol.SearchRequest\032\030.tpn.pro"
-  "tocol.NoResponse\"\006\202\371+\002\010\001\022[\n\026ProcessClien"
-  "tRequest12\022\033.tpn.protocol.SearchRequest\032"
-  "\034.tpn.protocol.SearchResponse\"\006\202\371+\002\010\002\032!\202"
-  "\371+\035\n\031tpn.protocol.testservice1\020\0012\350\001\n\014Tes"
-  "tService2\022W\n\026ProcessClientRequest21\022\033.tp"
-  "n.protocol.SearchRequest\032\030.tpn.protocol."
-  "NoResponse\"\006\202\371+\002\010\001\022[\n\026ProcessClientReque"
-  "st22\022\033.tpn.protocol.SearchRequest\032\034.tpn."
-  "protocol.SearchResponse\"\006\202\371+\002\010\002\032\"\202\371+\036\n\032t"
-  "pn.protocol.testservices2\030\0012\352\001\n\014TestServ"
-  "ice3\022W\n\026ProcessClientRequest31\022\033.tpn.pro"
-  "tocol.SearchRequest\032\030.tpn.protocol.NoRes"
-  "ponse\"\006\202\371+\002\010\001\022[\n\026ProcessClientRequest32\022"
-  "\033.tpn.protocol.SearchRequest\032\034.tpn.proto"
-  "col.SearchResponse\"\006\202\371+\002\010\002\032$\202\371+ \n\032tpn.pr"
-  "otocol.testservices3\020\001\030\0012\313\001\n\014TChatServic"
-  "e\022P\n\nUpdateInfo\022 .tpn.protocol.TUpdateIn"
-  "foRequest\032\030.tpn.protocol.NoResponse\"\006\202\371+"
-  "\002\010\001\022D\n\004Chat\022\032.tpn.protocol.TChatRequest\032"
-  "\030.tpn.protocol.NoResponse\"\006\202\371+\002\010\002\032#\202\371+\037\n"
-  "\031tpn.protocol.TChatService\020\001\030\0012x\n\rTChatL"
-  "istener\022C\n\007ChatNtf\022\026.tpn.protocol.TChatN"
-  "tf\032\030.tpn.protocol.NoResponse\"\006\202\371+\002\010\001\032\"\202\371"
-  "+\036\n\032tpn.protocol.TChatListener\020\001B\005H\001\200\001\001b"
-  "\006proto3"
+  " \001(\t\" \n\010TChatNtf\022\024\n\014message_list\030\001 \003(\t\"w"
+  "\n\005TItem\022\014\n\004guid\030\001 \001(\004\022\021\n\tconfig_id\030\002 \001(\r"
+  "\022\r\n\005count\030\003 \001(\r\022\014\n\004name\030\004 \001(\t\022\r\n\005attrs\030\005"
+  " \003(\r\022!\n\004gems\030\006 \003(\0132\023.tpn.protocol.TItem\""
+  "7\n\021TInventoryRequest\022\"\n\005items\030\001 \003(\0132\023.tp"
+  "n.protocol.TItem\"8\n\022TInventoryResponse\022\""
+  "\n\005items\030\001 \003(\0132\023.tpn.protocol.TItem2\347\001\n\014T"
+  "estService1\022W\n\026ProcessClientRequest11\022\033."
+  "tpn.protocol.SearchRequest\032\030.tpn.protoco"
+  "l.NoResponse\"\006\202\371+\002\010\001\022[\n\026ProcessClientReq"
+  "uest12\022\033.tpn.protocol.SearchRequest\032\034.tp"
+  "n.protocol.SearchResponse\"\006\202\371+\002\010\002\032!\202\371+\035\n"
+  "\031tpn.protocol.testservice1\020\0012\350\001\n\014TestSer"
+  "vice2\022W\n\026ProcessClientRequest21\022\033.tpn.pr"
+  "otocol.SearchRequest\032\030.tpn.protocol.NoRe"
+  "sponse\"\006\202\371+\002\010\001\022[\n\026ProcessClientRequest22"
+  "\022\033.tpn.protocol.SearchRequest\032\034.tpn.prot"
+  "ocol.SearchResponse\"\006\202\371+\002\010\002\032\"\202\371+\036\n\032tpn.p"
+  "rotocol.testservices2\030\0012\352\001\n\014TestService3"
+  "\022W\n\026ProcessClientRequest31\022\033.tpn.protoco"
+  "l.SearchRequest\032\030.tpn.protocol.NoRespons"
+  "e\"\006\202\371+\002\010\001\022[\n\026ProcessClientRequest32\022\033.tp"
+  "n.protocol.SearchRequest\032\034.tpn.protocol."
+  "SearchResponse\"\006\202\371+\002\010\002\032$\202\371+ \n\032tpn.protoc"
+  "ol.testservices3\020\001\030\0012\313\001\n\014TChatService\022P\n"
+  "\nUpdateInfo\022 .tpn.protocol.TUpdateInfoRe"
+  "quest\032\030.tpn.protocol.NoResponse\"\006\202\371+\002\010\001\022"
+  "D\n\004Chat\022\032.tpn.protocol.TChatRequest\032\030.tp"
+  "n.protocol.NoResponse\"\006\202\371+\002\010\002\032#\202\371+\037\n\031tpn"
+  ".protocol.TChatService\020\001\030\0012x\n\rTChatListe"
+  "ner\022C\n\007ChatNtf\022\026.tpn.protocol.TChatNtf\032\030"
+  ".tpn.protocol.NoResponse\"\006\202\371+\002\010\001\032\"\202\371+\036\n\032"
+  "tpn.protocol.TChatListener\020\0012\333\001\n\021TInvent"
+  "oryService\022Q\n\004Sync\022\037.tpn.protocol.TInven"
+  "toryRequest\032 .tpn.protocol.TInventoryRes"
+  "ponse\"\006\202\371+\002\010\001\022K\n\006Update\022\037.tpn.protocol.T"
+  "InventoryRequest\032\030.tpn.protocol.NoRespon"
+  "se\"\006\202\371+\002\010\002\032&\202\371+\"\n\036tpn.protocol.TInventor"
+  "yService\030\0012\347\001\n\026TInventoryArenaService\022Q\n"
+  "\004Sync\022\037.tpn.protocol.TInventoryRequest\032 "
+  ".tpn.protocol.TInventoryResponse\"\006\202\371+\002\010\001"
+  "\022K\n\006Update\022\037.tpn.protocol.TInventoryRequ"
+  "est\032\030.tpn.protocol.NoResponse\"\006\202\371+\002\010\002\032-\202"
+  "\371+)\n#tpn.protocol.TInventoryArenaService"
+  "\030\001 \001B\005H\001\200\001\001b\006proto3"
   ;
 static const ::PROTOBUF_NAMESPACE_ID::internal::DescriptorTable*const descriptor_table_protocol_2ftest_5fservice_2eproto_deps[1] = {
   &::descriptor_table_type_2frpc_5ftype_2eproto,
 };
 static ::PROTOBUF_NAMESPACE_ID::internal::once_flag descriptor_table_protocol_2ftest_5fservice_2eproto_once;
 const ::PROTOBUF_NAMESPACE_ID::internal::DescriptorTable descriptor_table_protocol_2ftest_5fservice_2eproto = {
-  false, false, 1407, descriptor_table_protodef_protocol_2ftest_5fservice_2eproto, "protocol/test_service.proto", 
-  &descriptor_table_protocol_2ftest_5fservice_2eproto_once, descriptor_table_protocol_2ftest_5fservice_2eproto_deps, 1, 6,
+  false, false, 2099, descriptor_table_protodef_protocol_2ftest_5fservice_2eproto, "protocol/test_service.proto", 
+  &descriptor_table_protocol_2ftest_5fservice_2eproto_once, descriptor_table_protocol_2ftest_5fservice_2eproto_deps, 1, 9,
   schemas, file_default_instances, TableStruct_protocol_2ftest_5fservice_2eproto::offsets,
   file_level_metadata_protocol_2ftest_5fservice_2eproto, file_level_enum_descriptors_protocol_2ftest_5fservice_2eproto, file_level_service_descriptors_protocol_2ftest_5fservice_2eproto,
 };
@@ -1547,199 +1636,949 @@ void TChatNtf::InternalSwap(TChatNtf* other) {
 
 // ===================================================================
 
-TestService1::TestService1()
-  : service_hash_(ServiceHash::value) {}
-
-TestService1::~TestService1() {}
+class TItem::_Internal {
+ public:
+};
 
-const ::google::protobuf::ServiceDescriptor *TestService1::descriptor() {
-  ::google::protobuf::internal::AssignDescriptors(&descriptor_table_protocol_2ftest_5fservice_2eproto);
-  return file_level_service_descriptors_protocol_2ftest_5fservice_2eproto[0];
+TItem::TItem(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                         bool is_message_owned)
+  : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned),
+  attrs_(arena),
+  gems_(arena) {
+  SharedCtor();
+  if (!is_message_owned) {
+    RegisterArenaDtor(arena);
+  }
+  // @@protoc_insertion_point(arena_constructor:tpn.protocol.TItem)
 }
-
-void TestService1::ProcessClientRequest11(const ::tpn::protocol::SearchRequest *request, bool client /*= false*/, bool server /*= false*/) {
-  LOG_DEBUG("{} Server called client method TestService1.ProcessClientRequest11(tpn.protocol.SearchRequest{{ {}  }})", GetCallerInfo(), request->ShortDebugString());
-  SendRequest(service_hash_, 1 | (client ? 0x40000000 : 0) | (server ? 0x80000000 : 0), request);
+TItem::TItem(const TItem& from)
+  : ::PROTOBUF_NAMESPACE_ID::Message(),
+      attrs_(from.attrs_),
+      gems_(from.gems_) {
+  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+  name_.UnsafeSetDefault(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited());
+  if (!from._internal_name().empty()) {
+    name_.Set(::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr::EmptyDefault{}, from._internal_name(), 
+      GetArenaForAllocation());
+  }
+  ::memcpy(&guid_, &from.guid_,
+    static_cast<size_t>(reinterpret_cast<char*>(&count_) -
+    reinterpret_cast<char*>(&guid_)) + sizeof(count_));
+  // @@protoc_insertion_point(copy_constructor:tpn.protocol.TItem)
 }
 
-void TestService1::ProcessClientRequest12(const ::tpn::protocol::SearchRequest *request, std::function<void(const ::tpn::protocol::SearchResponse *)> response_callback, bool client /*= false*/, bool server /*= false*/) {
-  LOG_DEBUG("{} Server called client method TestService1.ProcessClientRequest12(tpn.protocol.SearchRequest{{ {} }})", GetCallerInfo(), request->ShortDebugString());
-  std::function<void(MessageBuffer)> callback = [response_callback](MessageBuffer buffer) -> void {
-    ::tpn::protocol::SearchResponse response;
-    if (response.ParseFromArray(buffer.GetReadPointer(), buffer.GetActiveSize()))
-      response_callback(&response);
-  };
-  SendRequest(service_hash_, 2 | (client ? 0x40000000 : 0) | (server ? 0x80000000 : 0), request, std::move(callback));
+inline void TItem::SharedCtor() {
+name_.UnsafeSetDefault(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited());
+::memset(reinterpret_cast<char*>(this) + static_cast<size_t>(
+    reinterpret_cast<char*>(&guid_) - reinterpret_cast<char*>(this)),
+    0, static_cast<size_t>(reinterpret_cast<char*>(&count_) -
+    reinterpret_cast<char*>(&guid_)) + sizeof(count_));
 }
 
-void TestService1::CallServerMethod(uint32_t token, uint32_t method_id, MessageBuffer /*buffer*/) {
-  LOG_ERROR("{} Server tried to call server method {}", GetCallerInfo(), method_id);
+TItem::~TItem() {
+  // @@protoc_insertion_point(destructor:tpn.protocol.TItem)
+  if (GetArenaForAllocation() != nullptr) return;
+  SharedDtor();
+  _internal_metadata_.Delete<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
 }
 
-// ===================================================================
+inline void TItem::SharedDtor() {
+  GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
+  name_.DestroyNoArena(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited());
+}
 
-TestService2::TestService2()
-  : service_hash_(ServiceHash::value) {}
+void TItem::ArenaDtor(void* object) {
+  TItem* _this = reinterpret_cast< TItem* >(object);
+  (void)_this;
+}
+void TItem::RegisterArenaDtor(::PROTOBUF_NAMESPACE_ID::Arena*) {
+}
+void TItem::SetCachedSize(int size) const {
+  _cached_size_.Set(size);
+}
 
-TestService2::~TestService2() {}
+void TItem::Clear() {
+// @@protoc_insertion_point(message_clear_start:tpn.protocol.TItem)
+  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
 
-const ::google::protobuf::ServiceDescriptor *TestService2::descriptor() {
-  ::google::protobuf::internal::AssignDescriptors(&descriptor_table_protocol_2ftest_5fservice_2eproto);
-  return file_level_service_descriptors_protocol_2ftest_5fservice_2eproto[1];
+  attrs_.Clear();
+  gems_.Clear();
+  name_.ClearToEmpty();
+  ::memset(&guid_, 0, static_cast<size_t>(
+      reinterpret_cast<char*>(&count_) -
+      reinterpret_cast<char*>(&guid_)) + sizeof(count_));
+  _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
 }
 
-void TestService2::CallServerMethod(uint32_t token, uint32_t method_id, MessageBuffer buffer) {
-  switch(method_id & 0x3FFFFFFF) {
-    case 1: {
-      ::tpn::protocol::SearchRequest request;
-      if (!request.ParseFromArray(buffer.GetReadPointer(), buffer.GetActiveSize())) {
-        LOG_DEBUG("{} Failed to parse request for TestService2.ProcessClientRequest21 server method call.", GetCallerInfo());
-        SendResponse(service_hash_, method_id, token, kErrorCodeMalformedRequest);
-        return;
-      }
-      ::tpn::protocol::ErrorCode status = HandleProcessClientRequest21(&request);
-      LOG_DEBUG("{} Client called server method TestService2.ProcessClientRequest21(tpn.protocol.SearchRequest{{ {} }}) status {}.", GetCallerInfo(), request.ShortDebugString(), status);
-      if (kErrorCodeOk != status)
-        SendResponse(service_hash_, method_id, token, status);
-      break;
-    }
-    case 2: {
-      ::tpn::protocol::SearchRequest request;
-      if (!request.ParseFromArray(buffer.GetReadPointer(), buffer.GetActiveSize())) {
-        LOG_DEBUG("{} Failed to parse request for TestService2.ProcessClientRequest22 server method call.", GetCallerInfo());
-        SendResponse(service_hash_, method_id, token, kErrorCodeMalformedRequest);
-        return;
+const char* TItem::_InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) {
+#define CHK_(x) if (PROTOBUF_PREDICT_FALSE(!(x))) goto failure
+  while (!ctx->Done(&ptr)) {
+    ::PROTOBUF_NAMESPACE_ID::uint32 tag;
+    ptr = ::PROTOBUF_NAMESPACE_ID::internal::ReadTag(ptr, &tag);
+    switch (tag >> 3) {
+      // uint64 guid = 1;
+      case 1:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 8)) {
+          guid_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else goto handle_unusual;
+        continue;
+      // uint32 config_id = 2;
+      case 2:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 16)) {
+          config_id_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+          CHK_(ptr);
+        } else goto handle_unusual;
+        continue;
+      // uint32 count = 3;
+      case 3:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 24)) {
+          count_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+          CHK_(ptr);
+        } else goto handle_unusual;
+        continue;
+      // string name = 4;
+      case 4:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 34)) {
+          auto str = _internal_mutable_name();
+          ptr = ::PROTOBUF_NAMESPACE_ID::internal::InlineGreedyStringParser(str, ptr, ctx);
+          CHK_(::PROTOBUF_NAMESPACE_ID::internal::VerifyUTF8(str, "tpn.protocol.TItem.name"));
+          CHK_(ptr);
+        } else goto handle_unusual;
+        continue;
+      // repeated uint32 attrs = 5;
+      case 5:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 42)) {
+          ptr = ::PROTOBUF_NAMESPACE_ID::internal::PackedUInt32Parser(_internal_mutable_attrs(), ptr, ctx);
+          CHK_(ptr);
+        } else if (static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 40) {
+          _internal_add_attrs(::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr));
+          CHK_(ptr);
+        } else goto handle_unusual;
+        continue;
+      // repeated .tpn.protocol.TItem gems = 6;
+      case 6:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 50)) {
+          ptr -= 1;
+          do {
+            ptr += 1;
+            ptr = ctx->ParseMessage(_internal_add_gems(), ptr);
+            CHK_(ptr);
+            if (!ctx->DataAvailable(ptr)) break;
+          } while (::PROTOBUF_NAMESPACE_ID::internal::ExpectTag<50>(ptr));
+        } else goto handle_unusual;
+        continue;
+      default: {
+      handle_unusual:
+        if ((tag == 0) || ((tag & 7) == 4)) {
+          CHK_(ptr);
+          ctx->SetLastTag(tag);
+          goto success;
+        }
+        ptr = UnknownFieldParse(tag,
+            _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
+            ptr, ctx);
+        CHK_(ptr != nullptr);
+        continue;
       }
-      LOG_DEBUG("{} Client called server method TestService2.ProcessClientRequest22(tpn.protocol.SearchRequest{{ {} }}).", GetCallerInfo(), request.ShortDebugString());
-      std::function<void(ServiceBase*, ::tpn::protocol::ErrorCode, const ::google::protobuf::Message *)> continuation = [token, method_id](ServiceBase *service, ::tpn::protocol::ErrorCode status, const ::google::protobuf::Message *response) {
-        TPN_ASSERT(response->GetDescriptor() == ::tpn::protocol::SearchResponse::descriptor(), "response descriptor error {} != {}", response->GetDescriptor()->DebugString(), ::tpn::protocol::SearchResponse::descriptor()->DebugString());
-        TestService2* self = static_cast<TestService2*>(service);
-        LOG_DEBUG("{} Client called server method TestService2.ProcessClientRequest22() returned tpn.protocol.SearchResponse{{ {} }} status {}.", self->GetCallerInfo(), response->ShortDebugString(), status);
-        if (kErrorCodeOk == status)
-          self->SendResponse(self->service_hash_, method_id, token, response);
-        else
-          self->SendResponse(self->service_hash_, method_id, token, status);
-      };
-      ::tpn::protocol::SearchResponse response;
-      ::tpn::protocol::ErrorCode status = HandleProcessClientRequest22(&request, &response, continuation);
-      if (continuation)
-        continuation(this, status, &response);
-      break;
-    }
-    default:
-      LOG_ERROR("Bad method id {}.", method_id);
-      SendResponse(service_hash_, method_id, token, kErrorCodeInvalidMethod);
-      break;
-    }
+    }  // switch
+  }  // while
+success:
+  return ptr;
+failure:
+  ptr = nullptr;
+  goto success;
+#undef CHK_
 }
 
-::tpn::protocol::ErrorCode TestService2::HandleProcessClientRequest21(const ::tpn::protocol::SearchRequest *request) {
-  LOG_ERROR("{} Client tried to call not implemented method TestService2.ProcessClientRequest21({{ {} }})", GetCallerInfo(), request->ShortDebugString());
-  return kErrorCodeNotImplemented;
-}
+::PROTOBUF_NAMESPACE_ID::uint8* TItem::_InternalSerialize(
+    ::PROTOBUF_NAMESPACE_ID::uint8* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
+  // @@protoc_insertion_point(serialize_to_array_start:tpn.protocol.TItem)
+  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  (void) cached_has_bits;
 
-::tpn::protocol::ErrorCode TestService2::HandleProcessClientRequest22(const ::tpn::protocol::SearchRequest *request, ::tpn::protocol::SearchResponse *response, std::function<void(ServiceBase*, ::tpn::protocol::ErrorCode, const ::google::protobuf::Message *)>& continuation) {
-  LOG_ERROR("{} Client tried to call not implemented method TestService2.ProcessClientRequest22({{ {} }})", GetCallerInfo(), request->ShortDebugString());
-  return kErrorCodeNotImplemented;
-}
+  // uint64 guid = 1;
+  if (this->_internal_guid() != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteUInt64ToArray(1, this->_internal_guid(), target);
+  }
 
-// ===================================================================
+  // uint32 config_id = 2;
+  if (this->_internal_config_id() != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteUInt32ToArray(2, this->_internal_config_id(), target);
+  }
 
-TestService3::TestService3()
-  : service_hash_(ServiceHash::value) {}
+  // uint32 count = 3;
+  if (this->_internal_count() != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteUInt32ToArray(3, this->_internal_count(), target);
+  }
 
-TestService3::~TestService3() {}
+  // string name = 4;
+  if (!this->_internal_name().empty()) {
+    ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::VerifyUtf8String(
+      this->_internal_name().data(), static_cast<int>(this->_internal_name().length()),
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::SERIALIZE,
+      "tpn.protocol.TItem.name");
+    target = stream->WriteStringMaybeAliased(
+        4, this->_internal_name(), target);
+  }
 
-const ::google::protobuf::ServiceDescriptor *TestService3::descriptor() {
-  ::google::protobuf::internal::AssignDescriptors(&descriptor_table_protocol_2ftest_5fservice_2eproto);
-  return file_level_service_descriptors_protocol_2ftest_5fservice_2eproto[2];
-}
+  // repeated uint32 attrs = 5;
+  {
+    int byte_size = _attrs_cached_byte_size_.load(std::memory_order_relaxed);
+    if (byte_size > 0) {
+      target = stream->WriteUInt32Packed(
+          5, _internal_attrs(), byte_size, target);
+    }
+  }
 
-void TestService3::ProcessClientRequest31(const ::tpn::protocol::SearchRequest *request, bool client /*= false*/, bool server /*= false*/) {
-  LOG_DEBUG("{} Server called client method TestService3.ProcessClientRequest31(tpn.protocol.SearchRequest{{ {}  }})", GetCallerInfo(), request->ShortDebugString());
-  SendRequest(service_hash_, 1 | (client ? 0x40000000 : 0) | (server ? 0x80000000 : 0), request);
-}
+  // repeated .tpn.protocol.TItem gems = 6;
+  for (unsigned int i = 0,
+      n = static_cast<unsigned int>(this->_internal_gems_size()); i < n; i++) {
+    target = stream->EnsureSpace(target);
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::
+      InternalWriteMessage(6, this->_internal_gems(i), target, stream);
+  }
 
-void TestService3::ProcessClientRequest32(const ::tpn::protocol::SearchRequest *request, std::function<void(const ::tpn::protocol::SearchResponse *)> response_callback, bool client /*= false*/, bool server /*= false*/) {
-  LOG_DEBUG("{} Server called client method TestService3.ProcessClientRequest32(tpn.protocol.SearchRequest{{ {} }})", GetCallerInfo(), request->ShortDebugString());
-  std::function<void(MessageBuffer)> callback = [response_callback](MessageBuffer buffer) -> void {
-    ::tpn::protocol::SearchResponse response;
-    if (response.ParseFromArray(buffer.GetReadPointer(), buffer.GetActiveSize()))
-      response_callback(&response);
-  };
-  SendRequest(service_hash_, 2 | (client ? 0x40000000 : 0) | (server ? 0x80000000 : 0), request, std::move(callback));
+  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormat::InternalSerializeUnknownFieldsToArray(
+        _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:tpn.protocol.TItem)
+  return target;
 }
 
-void TestService3::CallServerMethod(uint32_t token, uint32_t method_id, MessageBuffer buffer) {
-  switch(method_id & 0x3FFFFFFF) {
-    case 1: {
-      ::tpn::protocol::SearchRequest request;
-      if (!request.ParseFromArray(buffer.GetReadPointer(), buffer.GetActiveSize())) {
-        LOG_DEBUG("{} Failed to parse request for TestService3.ProcessClientRequest31 server method call.", GetCallerInfo());
-        SendResponse(service_hash_, method_id, token, kErrorCodeMalformedRequest);
-        return;
-      }
-      ::tpn::protocol::ErrorCode status = HandleProcessClientRequest31(&request);
-      LOG_DEBUG("{} Client called server method TestService3.ProcessClientRequest31(tpn.protocol.SearchRequest{{ {} }}) status {}.", GetCallerInfo(), request.ShortDebugString(), status);
-      if (kErrorCodeOk != status)
-        SendResponse(service_hash_, method_id, token, status);
-      break;
-    }
-    case 2: {
-      ::tpn::protocol::SearchRequest request;
-      if (!request.ParseFromArray(buffer.GetReadPointer(), buffer.GetActiveSize())) {
-        LOG_DEBUG("{} Failed to parse request for TestService3.ProcessClientRequest32 server method call.", GetCallerInfo());
-        SendResponse(service_hash_, method_id, token, kErrorCodeMalformedRequest);
-        return;
-      }
-      LOG_DEBUG("{} Client called server method TestService3.ProcessClientRequest32(tpn.protocol.SearchRequest{{ {} }}).", GetCallerInfo(), request.ShortDebugString());
-      std::function<void(ServiceBase*, ::tpn::protocol::ErrorCode, const ::google::protobuf::Message *)> continuation = [token, method_id](ServiceBase *service, ::tpn::protocol::ErrorCode status, const ::google::protobuf::Message *response) {
-        TPN_ASSERT(response->GetDescriptor() == ::tpn::protocol::SearchResponse::descriptor(), "response descriptor error {} != {}", response->GetDescriptor()->DebugString(), ::tpn::protocol::SearchResponse::descriptor()->DebugString());
-        TestService3* self = static_cast<TestService3*>(service);
-        LOG_DEBUG("{} Client called server method TestService3.ProcessClientRequest32() returned tpn.protocol.SearchResponse{{ {} }} status {}.", self->GetCallerInfo(), response->ShortDebugString(), status);
-        if (kErrorCodeOk == status)
-          self->SendResponse(self->service_hash_, method_id, token, response);
-        else
-          self->SendResponse(self->service_hash_, method_id, token, status);
-      };
-      ::tpn::protocol::SearchResponse response;
-      ::tpn::protocol::ErrorCode status = HandleProcessClientRequest32(&request, &response, continuation);
-      if (continuation)
-        continuation(this, status, &response);
-      break;
-    }
-    default:
-      LOG_ERROR("Bad method id {}.", method_id);
-      SendResponse(service_hash_, method_id, token, kErrorCodeInvalidMethod);
-      break;
+size_t TItem::ByteSizeLong() const {
+// @@protoc_insertion_point(message_byte_size_start:tpn.protocol.TItem)
+  size_t total_size = 0;
+
+  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  // repeated uint32 attrs = 5;
+  {
+    size_t data_size = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::
+      UInt32Size(this->attrs_);
+    if (data_size > 0) {
+      total_size += 1 +
+        ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::Int32Size(
+            static_cast<::PROTOBUF_NAMESPACE_ID::int32>(data_size));
     }
-}
+    int cached_size = ::PROTOBUF_NAMESPACE_ID::internal::ToCachedSize(data_size);
+    _attrs_cached_byte_size_.store(cached_size,
+                                    std::memory_order_relaxed);
+    total_size += data_size;
+  }
 
-::tpn::protocol::ErrorCode TestService3::HandleProcessClientRequest31(const ::tpn::protocol::SearchRequest *request) {
-  LOG_ERROR("{} Client tried to call not implemented method TestService3.ProcessClientRequest31({{ {} }})", GetCallerInfo(), request->ShortDebugString());
-  return kErrorCodeNotImplemented;
-}
+  // repeated .tpn.protocol.TItem gems = 6;
+  total_size += 1UL * this->_internal_gems_size();
+  for (const auto& msg : this->gems_) {
+    total_size +=
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::MessageSize(msg);
+  }
 
-::tpn::protocol::ErrorCode TestService3::HandleProcessClientRequest32(const ::tpn::protocol::SearchRequest *request, ::tpn::protocol::SearchResponse *response, std::function<void(ServiceBase*, ::tpn::protocol::ErrorCode, const ::google::protobuf::Message *)>& continuation) {
-  LOG_ERROR("{} Client tried to call not implemented method TestService3.ProcessClientRequest32({{ {} }})", GetCallerInfo(), request->ShortDebugString());
-  return kErrorCodeNotImplemented;
-}
+  // string name = 4;
+  if (!this->_internal_name().empty()) {
+    total_size += 1 +
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::StringSize(
+        this->_internal_name());
+  }
 
-// ===================================================================
+  // uint64 guid = 1;
+  if (this->_internal_guid() != 0) {
+    total_size += 1 +
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::UInt64Size(
+        this->_internal_guid());
+  }
 
-TChatService::TChatService()
-  : service_hash_(ServiceHash::value) {}
+  // uint32 config_id = 2;
+  if (this->_internal_config_id() != 0) {
+    total_size += 1 +
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::UInt32Size(
+        this->_internal_config_id());
+  }
 
-TChatService::~TChatService() {}
+  // uint32 count = 3;
+  if (this->_internal_count() != 0) {
+    total_size += 1 +
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::UInt32Size(
+        this->_internal_count());
+  }
 
-const ::google::protobuf::ServiceDescriptor *TChatService::descriptor() {
-  ::google::protobuf::internal::AssignDescriptors(&descriptor_table_protocol_2ftest_5fservice_2eproto);
-  return file_level_service_descriptors_protocol_2ftest_5fservice_2eproto[3];
+  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
+    return ::PROTOBUF_NAMESPACE_ID::internal::ComputeUnknownFieldsSize(
+        _internal_metadata_, total_size, &_cached_size_);
+  }
+  int cached_size = ::PROTOBUF_NAMESPACE_ID::internal::ToCachedSize(total_size);
+  SetCachedSize(cached_size);
+  return total_size;
 }
 
-void TChatService::UpdateInfo(const ::tpn::protocol::TUpdateInfoRequest *request, bool client /*= false*/, bool server /*= false*/) {
-  LOG_DEBUG("{} Server called client method TChatService.UpdateInfo(tpn.protocol.TUpdateInfoRequest{{ {}  }})", GetCallerInfo(), request->ShortDebugString());
-  SendRequest(service_hash_, 1 | (client ? 0x40000000 : 0) | (server ? 0x80000000 : 0), request);
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData TItem::_class_data_ = {
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSizeCheck,
+    TItem::MergeImpl
+};
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*TItem::GetClassData() const { return &_class_data_; }
+
+void TItem::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message*to,
+                      const ::PROTOBUF_NAMESPACE_ID::Message&from) {
+  static_cast<TItem *>(to)->MergeFrom(
+      static_cast<const TItem &>(from));
+}
+
+
+void TItem::MergeFrom(const TItem& from) {
+// @@protoc_insertion_point(class_specific_merge_from_start:tpn.protocol.TItem)
+  GOOGLE_DCHECK_NE(&from, this);
+  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  attrs_.MergeFrom(from.attrs_);
+  gems_.MergeFrom(from.gems_);
+  if (!from._internal_name().empty()) {
+    _internal_set_name(from._internal_name());
+  }
+  if (from._internal_guid() != 0) {
+    _internal_set_guid(from._internal_guid());
+  }
+  if (from._internal_config_id() != 0) {
+    _internal_set_config_id(from._internal_config_id());
+  }
+  if (from._internal_count() != 0) {
+    _internal_set_count(from._internal_count());
+  }
+  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+}
+
+void TItem::CopyFrom(const TItem& from) {
+// @@protoc_insertion_point(class_specific_copy_from_start:tpn.protocol.TItem)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool TItem::IsInitialized() const {
+  return true;
+}
+
+void TItem::InternalSwap(TItem* other) {
+  using std::swap;
+  _internal_metadata_.InternalSwap(&other->_internal_metadata_);
+  attrs_.InternalSwap(&other->attrs_);
+  gems_.InternalSwap(&other->gems_);
+  ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr::InternalSwap(
+      &::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(),
+      &name_, GetArenaForAllocation(),
+      &other->name_, other->GetArenaForAllocation()
+  );
+  ::PROTOBUF_NAMESPACE_ID::internal::memswap<
+      PROTOBUF_FIELD_OFFSET(TItem, count_)
+      + sizeof(TItem::count_)
+      - PROTOBUF_FIELD_OFFSET(TItem, guid_)>(
+          reinterpret_cast<char*>(&guid_),
+          reinterpret_cast<char*>(&other->guid_));
+}
+
+::PROTOBUF_NAMESPACE_ID::Metadata TItem::GetMetadata() const {
+  return ::PROTOBUF_NAMESPACE_ID::internal::AssignDescriptors(
+      &descriptor_table_protocol_2ftest_5fservice_2eproto_getter, &descriptor_table_protocol_2ftest_5fservice_2eproto_once,
+      file_level_metadata_protocol_2ftest_5fservice_2eproto[6]);
+}
+
+// ===================================================================
+
+class TInventoryRequest::_Internal {
+ public:
+};
+
+TInventoryRequest::TInventoryRequest(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                         bool is_message_owned)
+  : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned),
+  items_(arena) {
+  SharedCtor();
+  if (!is_message_owned) {
+    RegisterArenaDtor(arena);
+  }
+  // @@protoc_insertion_point(arena_constructor:tpn.protocol.TInventoryRequest)
+}
+TInventoryRequest::TInventoryRequest(const TInventoryRequest& from)
+  : ::PROTOBUF_NAMESPACE_ID::Message(),
+      items_(from.items_) {
+  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+  // @@protoc_insertion_point(copy_constructor:tpn.protocol.TInventoryRequest)
+}
+
+inline void TInventoryRequest::SharedCtor() {
+}
+
+TInventoryRequest::~TInventoryRequest() {
+  // @@protoc_insertion_point(destructor:tpn.protocol.TInventoryRequest)
+  if (GetArenaForAllocation() != nullptr) return;
+  SharedDtor();
+  _internal_metadata_.Delete<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+}
+
+inline void TInventoryRequest::SharedDtor() {
+  GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
+}
+
+void TInventoryRequest::ArenaDtor(void* object) {
+  TInventoryRequest* _this = reinterpret_cast< TInventoryRequest* >(object);
+  (void)_this;
+}
+void TInventoryRequest::RegisterArenaDtor(::PROTOBUF_NAMESPACE_ID::Arena*) {
+}
+void TInventoryRequest::SetCachedSize(int size) const {
+  _cached_size_.Set(size);
+}
+
+void TInventoryRequest::Clear() {
+// @@protoc_insertion_point(message_clear_start:tpn.protocol.TInventoryRequest)
+  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  items_.Clear();
+  _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+}
+
+const char* TInventoryRequest::_InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) {
+#define CHK_(x) if (PROTOBUF_PREDICT_FALSE(!(x))) goto failure
+  while (!ctx->Done(&ptr)) {
+    ::PROTOBUF_NAMESPACE_ID::uint32 tag;
+    ptr = ::PROTOBUF_NAMESPACE_ID::internal::ReadTag(ptr, &tag);
+    switch (tag >> 3) {
+      // repeated .tpn.protocol.TItem items = 1;
+      case 1:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 10)) {
+          ptr -= 1;
+          do {
+            ptr += 1;
+            ptr = ctx->ParseMessage(_internal_add_items(), ptr);
+            CHK_(ptr);
+            if (!ctx->DataAvailable(ptr)) break;
+          } while (::PROTOBUF_NAMESPACE_ID::internal::ExpectTag<10>(ptr));
+        } else goto handle_unusual;
+        continue;
+      default: {
+      handle_unusual:
+        if ((tag == 0) || ((tag & 7) == 4)) {
+          CHK_(ptr);
+          ctx->SetLastTag(tag);
+          goto success;
+        }
+        ptr = UnknownFieldParse(tag,
+            _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
+            ptr, ctx);
+        CHK_(ptr != nullptr);
+        continue;
+      }
+    }  // switch
+  }  // while
+success:
+  return ptr;
+failure:
+  ptr = nullptr;
+  goto success;
+#undef CHK_
+}
+
+::PROTOBUF_NAMESPACE_ID::uint8* TInventoryRequest::_InternalSerialize(
+    ::PROTOBUF_NAMESPACE_ID::uint8* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
+  // @@protoc_insertion_point(serialize_to_array_start:tpn.protocol.TInventoryRequest)
+  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  // repeated .tpn.protocol.TItem items = 1;
+  for (unsigned int i = 0,
+      n = static_cast<unsigned int>(this->_internal_items_size()); i < n; i++) {
+    target = stream->EnsureSpace(target);
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::
+      InternalWriteMessage(1, this->_internal_items(i), target, stream);
+  }
+
+  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormat::InternalSerializeUnknownFieldsToArray(
+        _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:tpn.protocol.TInventoryRequest)
+  return target;
+}
+
+size_t TInventoryRequest::ByteSizeLong() const {
+// @@protoc_insertion_point(message_byte_size_start:tpn.protocol.TInventoryRequest)
+  size_t total_size = 0;
+
+  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  // repeated .tpn.protocol.TItem items = 1;
+  total_size += 1UL * this->_internal_items_size();
+  for (const auto& msg : this->items_) {
+    total_size +=
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::MessageSize(msg);
+  }
+
+  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
+    return ::PROTOBUF_NAMESPACE_ID::internal::ComputeUnknownFieldsSize(
+        _internal_metadata_, total_size, &_cached_size_);
+  }
+  int cached_size = ::PROTOBUF_NAMESPACE_ID::internal::ToCachedSize(total_size);
+  SetCachedSize(cached_size);
+  return total_size;
+}
+
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData TInventoryRequest::_class_data_ = {
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSizeCheck,
+    TInventoryRequest::MergeImpl
+};
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*TInventoryRequest::GetClassData() const { return &_class_data_; }
+
+void TInventoryRequest::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message*to,
+                      const ::PROTOBUF_NAMESPACE_ID::Message&from) {
+  static_cast<TInventoryRequest *>(to)->MergeFrom(
+      static_cast<const TInventoryRequest &>(from));
+}
+
+
+void TInventoryRequest::MergeFrom(const TInventoryRequest& from) {
+// @@protoc_insertion_point(class_specific_merge_from_start:tpn.protocol.TInventoryRequest)
+  GOOGLE_DCHECK_NE(&from, this);
+  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  items_.MergeFrom(from.items_);
+  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+}
+
+void TInventoryRequest::CopyFrom(const TInventoryRequest& from) {
+// @@protoc_insertion_point(class_specific_copy_from_start:tpn.protocol.TInventoryRequest)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool TInventoryRequest::IsInitialized() const {
+  return true;
+}
+
+void TInventoryRequest::InternalSwap(TInventoryRequest* other) {
+  using std::swap;
+  _internal_metadata_.InternalSwap(&other->_internal_metadata_);
+  items_.InternalSwap(&other->items_);
+}
+
+::PROTOBUF_NAMESPACE_ID::Metadata TInventoryRequest::GetMetadata() const {
+  return ::PROTOBUF_NAMESPACE_ID::internal::AssignDescriptors(
+      &descriptor_table_protocol_2ftest_5fservice_2eproto_getter, &descriptor_table_protocol_2ftest_5fservice_2eproto_once,
+      file_level_metadata_protocol_2ftest_5fservice_2eproto[7]);
+}
+
+// ===================================================================
+
+class TInventoryResponse::_Internal {
+ public:
+};
+
+TInventoryResponse::TInventoryResponse(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                         bool is_message_owned)
+  : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned),
+  items_(arena) {
+  SharedCtor();
+  if (!is_message_owned) {
+    RegisterArenaDtor(arena);
+  }
+  // @@protoc_insertion_point(arena_constructor:tpn.protocol.TInventoryResponse)
+}
+TInventoryResponse::TInventoryResponse(const TInventoryResponse& from)
+  : ::PROTOBUF_NAMESPACE_ID::Message(),
+      items_(from.items_) {
+  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+  // @@protoc_insertion_point(copy_constructor:tpn.protocol.TInventoryResponse)
+}
+
+inline void TInventoryResponse::SharedCtor() {
+}
+
+TInventoryResponse::~TInventoryResponse() {
+  // @@protoc_insertion_point(destructor:tpn.protocol.TInventoryResponse)
+  if (GetArenaForAllocation() != nullptr) return;
+  SharedDtor();
+  _internal_metadata_.Delete<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+}
+
+inline void TInventoryResponse::SharedDtor() {
+  GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
+}
+
+void TInventoryResponse::ArenaDtor(void* object) {
+  TInventoryResponse* _this = reinterpret_cast< TInventoryResponse* >(object);
+  (void)_this;
+}
+void TInventoryResponse::RegisterArenaDtor(::PROTOBUF_NAMESPACE_ID::Arena*) {
+}
+void TInventoryResponse::SetCachedSize(int size) const {
+  _cached_size_.Set(size);
+}
+
+void TInventoryResponse::Clear() {
+// @@protoc_insertion_point(message_clear_start:tpn.protocol.TInventoryResponse)
+  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  items_.Clear();
+  _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+}
+
+const char* TInventoryResponse::_InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) {
+#define CHK_(x) if (PROTOBUF_PREDICT_FALSE(!(x))) goto failure
+  while (!ctx->Done(&ptr)) {
+    ::PROTOBUF_NAMESPACE_ID::uint32 tag;
+    ptr = ::PROTOBUF_NAMESPACE_ID::internal::ReadTag(ptr, &tag);
+    switch (tag >> 3) {
+      // repeated .tpn.protocol.TItem items = 1;
+      case 1:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 10)) {
+          ptr -= 1;
+          do {
+            ptr += 1;
+            ptr = ctx->ParseMessage(_internal_add_items(), ptr);
+            CHK_(ptr);
+            if (!ctx->DataAvailable(ptr)) break;
+          } while (::PROTOBUF_NAMESPACE_ID::internal::ExpectTag<10>(ptr));
+        } else goto handle_unusual;
+        continue;
+      default: {
+      handle_unusual:
+        if ((tag == 0) || ((tag & 7) == 4)) {
+          CHK_(ptr);
+          ctx->SetLastTag(tag);
+          goto success;
+        }
+        ptr = UnknownFieldParse(tag,
+            _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
+            ptr, ctx);
+        CHK_(ptr != nullptr);
+        continue;
+      }
+    }  // switch
+  }  // while
+success:
+  return ptr;
+failure:
+  ptr = nullptr;
+  goto success;
+#undef CHK_
+}
+
+::PROTOBUF_NAMESPACE_ID::uint8* TInventoryResponse::_InternalSerialize(
+    ::PROTOBUF_NAMESPACE_ID::uint8* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
+  // @@protoc_insertion_point(serialize_to_array_start:tpn.protocol.TInventoryResponse)
+  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  // repeated .tpn.protocol.TItem items = 1;
+  for (unsigned int i = 0,
+      n = static_cast<unsigned int>(this->_internal_items_size()); i < n; i++) {
+    target = stream->EnsureSpace(target);
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::
+      InternalWriteMessage(1, this->_internal_items(i), target, stream);
+  }
+
+  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormat::InternalSerializeUnknownFieldsToArray(
+        _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:tpn.protocol.TInventoryResponse)
+  return target;
+}
+
+size_t TInventoryResponse::ByteSizeLong() const {
+// @@protoc_insertion_point(message_byte_size_start:tpn.protocol.TInventoryResponse)
+  size_t total_size = 0;
+
+  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  // repeated .tpn.protocol.TItem items = 1;
+  total_size += 1UL * this->_internal_items_size();
+  for (const auto& msg : this->items_) {
+    total_size +=
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::MessageSize(msg);
+  }
+
+  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
+    return ::PROTOBUF_NAMESPACE_ID::internal::ComputeUnknownFieldsSize(
+        _internal_metadata_, total_size, &_cached_size_);
+  }
+  int cached_size = ::PROTOBUF_NAMESPACE_ID::internal::ToCachedSize(total_size);
+  SetCachedSize(cached_size);
+  return total_size;
+}
+
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData TInventoryResponse::_class_data_ = {
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSizeCheck,
+    TInventoryResponse::MergeImpl
+};
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*TInventoryResponse::GetClassData() const { return &_class_data_; }
+
+void TInventoryResponse::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message*to,
+                      const ::PROTOBUF_NAMESPACE_ID::Message&from) {
+  static_cast<TInventoryResponse *>(to)->MergeFrom(
+      static_cast<const TInventoryResponse &>(from));
+}
+
+
+void TInventoryResponse::MergeFrom(const TInventoryResponse& from) {
+// @@protoc_insertion_point(class_specific_merge_from_start:tpn.protocol.TInventoryResponse)
+  GOOGLE_DCHECK_NE(&from, this);
+  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  items_.MergeFrom(from.items_);
+  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+}
+
+void TInventoryResponse::CopyFrom(const TInventoryResponse& from) {
+// @@protoc_insertion_point(class_specific_copy_from_start:tpn.protocol.TInventoryResponse)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool TInventoryResponse::IsInitialized() const {
+  return true;
+}
+
+void TInventoryResponse::InternalSwap(TInventoryResponse* other) {
+  using std::swap;
+  _internal_metadata_.InternalSwap(&other->_internal_metadata_);
+  items_.InternalSwap(&other->items_);
+}
+
+::PROTOBUF_NAMESPACE_ID::Metadata TInventoryResponse::GetMetadata() const {
+  return ::PROTOBUF_NAMESPACE_ID::internal::AssignDescriptors(
+      &descriptor_table_protocol_2ftest_5fservice_2eproto_getter, &descriptor_table_protocol_2ftest_5fservice_2eproto_once,
+      file_level_metadata_protocol_2ftest_5fservice_2eproto[8]);
+}
+
+// ===================================================================
+
+TestService1::TestService1()
+  : service_hash_(ServiceHash::value) {}
+
+TestService1::~TestService1() {}
+
+const ::google::protobuf::ServiceDescriptor *TestService1::descriptor() {
+  ::google::protobuf::internal::AssignDescriptors(&descriptor_table_protocol_2ftest_5fservice_2eproto);
+  return file_level_service_descriptors_protocol_2ftest_5fservice_2eproto[0];
+}
+
+void TestService1::ProcessClientRequest11(const ::tpn::protocol::SearchRequest *request, bool client /*= false*/, bool server /*= false*/) {
+  LOG_DEBUG("{} Server called client method TestService1.ProcessClientRequest11(tpn.protocol.SearchRequest{{ {}  }})", GetCallerInfo(), request->ShortDebugString());
+  SendRequest(service_hash_, 1 | (client ? 0x40000000 : 0) | (server ? 0x80000000 : 0), request);
+}
+
+void TestService1::ProcessClientRequest12(const ::tpn::protocol::SearchRequest *request, std::function<void(const ::tpn::protocol::SearchResponse *)> response_callback, bool client /*= false*/, bool server /*= false*/) {
+  LOG_DEBUG("{} Server called client method TestService1.ProcessClientRequest12(tpn.protocol.SearchRequest{{ {} }})", GetCallerInfo(), request->ShortDebugString());
+  std::function<void(MessageBuffer)> callback = [response_callback](MessageBuffer buffer) -> void {
+    ::tpn::protocol::SearchResponse response;
+    if (response.ParseFromArray(buffer.GetReadPointer(), buffer.GetActiveSize()))
+      response_callback(&response);
+  };
+  SendRequest(service_hash_, 2 | (client ? 0x40000000 : 0) | (server ? 0x80000000 : 0), request, std::move(callback));
+}
+
+void TestService1::CallServerMethod(uint32_t token, uint32_t method_id, MessageBuffer /*buffer*/) {
+  LOG_ERROR("{} Server tried to call server method {}", GetCallerInfo(), method_id);
+}
+
+// ===================================================================
+
+TestService2::TestService2()
+  : service_hash_(ServiceHash::value) {}
+
+TestService2::~TestService2() {}
+
+const ::google::protobuf::ServiceDescriptor *TestService2::descriptor() {
+  ::google::protobuf::internal::AssignDescriptors(&descriptor_table_protocol_2ftest_5fservice_2eproto);
+  return file_level_service_descriptors_protocol_2ftest_5fservice_2eproto[1];
+}
+
+constexpr TestService2::ServerMethodEntry TestService2::kServerMethods[kServerMethodTableSize] = {
+  {2, &TestService2::ServerCallProcessClientRequest22},
+  {1, &TestService2::ServerCallProcessClientRequest21},
+};
+
+void TestService2::CallServerMethod(uint32_t token, uint32_t method_id, MessageBuffer buffer) {
+  const ServerMethodEntry &entry = kServerMethods[(method_id & 0x3FFFFFFF) % kServerMethodTableSize];
+  if (nullptr != entry.method && entry.method_id == (method_id & 0x3FFFFFFF)) {
+    entry.method(this, token, method_id, buffer);
+    return;
+  }
+  LOG_ERROR("Bad method id {}.", method_id);
+  SendResponse(service_hash_, method_id, token, kErrorCodeInvalidMethod);
+}
+
+void TestService2::ServerCallProcessClientRequest21(TestService2 *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer) {
+  ::tpn::protocol::SearchRequest request;
+  if (!request.ParseFromArray(buffer.GetReadPointer(), buffer.GetActiveSize())) {
+    LOG_DEBUG("{} Failed to parse request for TestService2.ProcessClientRequest21 server method call.", self->GetCallerInfo());
+    self->SendResponse(self->service_hash_, method_id, token, kErrorCodeMalformedRequest);
+    return;
+  }
+  ::tpn::protocol::ErrorCode status = self->HandleProcessClientRequest21(&request);
+  LOG_DEBUG("{} Client called server method TestService2.ProcessClientRequest21(tpn.protocol.SearchRequest{{ {} }}) status {}.", self->GetCallerInfo(), request.ShortDebugString(), status);
+  if (kErrorCodeOk != status)
+    self->SendResponse(self->service_hash_, method_id, token, status);
+}
+
+void TestService2::ServerCallProcessClientRequest22(TestService2 *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer) {
+  ::tpn::protocol::SearchRequest request;
+  if (!request.ParseFromArray(buffer.GetReadPointer(), buffer.GetActiveSize())) {
+    LOG_DEBUG("{} Failed to parse request for TestService2.ProcessClientRequest22 server method call.", self->GetCallerInfo());
+    self->SendResponse(self->service_hash_, method_id, token, kErrorCodeMalformedRequest);
+    return;
+  }
+  LOG_DEBUG("{} Client called server method TestService2.ProcessClientRequest22(tpn.protocol.SearchRequest{{ {} }}).", self->GetCallerInfo(), request.ShortDebugString());
+  ::tpn::protocol::SearchResponse response;
+  ::tpn::ServiceContinuation<::tpn::protocol::SearchResponse> continuation(&TestService2::ServerContinueProcessClientRequest22, token, method_id, nullptr);
+  ::tpn::protocol::ErrorCode status = self->HandleProcessClientRequest22(&request, &response, continuation);
+  if (continuation)
+    continuation(self, status, &response);
+}
+
+void TestService2::ServerContinueProcessClientRequest22(ServiceBase *service, uint32_t token, uint32_t method_id, ::tpn::ServiceArena */*arena*/, ::tpn::protocol::ErrorCode status, const ::tpn::protocol::SearchResponse *response) {
+  TestService2 *self = static_cast<TestService2 *>(service);
+  LOG_DEBUG("{} Client called server method TestService2.ProcessClientRequest22() returned tpn.protocol.SearchResponse{{ {} }} status {}.", self->GetCallerInfo(), response->ShortDebugString(), status);
+  if (kErrorCodeOk == status)
+    self->SendResponse(self->service_hash_, method_id, token, response);
+  else
+    self->SendResponse(self->service_hash_, method_id, token, status);
+}
+
+::tpn::protocol::ErrorCode TestService2::HandleProcessClientRequest21(const ::tpn::protocol::SearchRequest *request) {
+  LOG_ERROR("{} Client tried to call not implemented method TestService2.ProcessClientRequest21({{ {} }})", GetCallerInfo(), request->ShortDebugString());
+  return kErrorCodeNotImplemented;
+}
+
+::tpn::protocol::ErrorCode TestService2::HandleProcessClientRequest22(const ::tpn::protocol::SearchRequest *request, ::tpn::protocol::SearchResponse *response, ::tpn::ServiceContinuation<::tpn::protocol::SearchResponse> &continuation) {
+  LOG_ERROR("{} Client tried to call not implemented method TestService2.ProcessClientRequest22({{ {} }})", GetCallerInfo(), request->ShortDebugString());
+  return kErrorCodeNotImplemented;
+}
+
+// ===================================================================
+
+TestService3::TestService3()
+  : service_hash_(ServiceHash::value) {}
+
+TestService3::~TestService3() {}
+
+const ::google::protobuf::ServiceDescriptor *TestService3::descriptor() {
+  ::google::protobuf::internal::AssignDescriptors(&descriptor_table_protocol_2ftest_5fservice_2eproto);
+  return file_level_service_descriptors_protocol_2ftest_5fservice_2eproto[2];
+}
+
+void TestService3::ProcessClientRequest31(const ::tpn::protocol::SearchRequest *request, bool client /*= false*/, bool server /*= false*/) {
+  LOG_DEBUG("{} Server called client method TestService3.ProcessClientRequest31(tpn.protocol.SearchRequest{{ {}  }})", GetCallerInfo(), request->ShortDebugString());
+  SendRequest(service_hash_, 1 | (client ? 0x40000000 : 0) | (server ? 0x80000000 : 0), request);
+}
+
+void TestService3::ProcessClientRequest32(const ::tpn::protocol::SearchRequest *request, std::function<void(const ::tpn::protocol::SearchResponse *)> response_callback, bool client /*= false*/, bool server /*= false*/) {
+  LOG_DEBUG("{} Server called client method TestService3.ProcessClientRequest32(tpn.protocol.SearchRequest{{ {} }})", GetCallerInfo(), request->ShortDebugString());
+  std::function<void(MessageBuffer)> callback = [response_callback](MessageBuffer buffer) -> void {
+    ::tpn::protocol::SearchResponse response;
+    if (response.ParseFromArray(buffer.GetReadPointer(), buffer.GetActiveSize()))
+      response_callback(&response);
+  };
+  SendRequest(service_hash_, 2 | (client ? 0x40000000 : 0) | (server ? 0x80000000 : 0), request, std::move(callback));
+}
+
+constexpr TestService3::ServerMethodEntry TestService3::kServerMethods[kServerMethodTableSize] = {
+  {2, &TestService3::ServerCallProcessClientRequest32},
+  {1, &TestService3::ServerCallProcessClientRequest31},
+};
+
+void TestService3::CallServerMethod(uint32_t token, uint32_t method_id, MessageBuffer buffer) {
+  const ServerMethodEntry &entry = kServerMethods[(method_id & 0x3FFFFFFF) % kServerMethodTableSize];
+  if (nullptr != entry.method && entry.method_id == (method_id & 0x3FFFFFFF)) {
+    entry.method(this, token, method_id, buffer);
+    return;
+  }
+  LOG_ERROR("Bad method id {}.", method_id);
+  SendResponse(service_hash_, method_id, token, kErrorCodeInvalidMethod);
+}
+
+void TestService3::ServerCallProcessClientRequest31(TestService3 *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer) {
+  ::tpn::protocol::SearchRequest request;
+  if (!request.ParseFromArray(buffer.GetReadPointer(), buffer.GetActiveSize())) {
+    LOG_DEBUG("{} Failed to parse request for TestService3.ProcessClientRequest31 server method call.", self->GetCallerInfo());
+    self->SendResponse(self->service_hash_, method_id, token, kErrorCodeMalformedRequest);
+    return;
+  }
+  ::tpn::protocol::ErrorCode status = self->HandleProcessClientRequest31(&request);
+  LOG_DEBUG("{} Client called server method TestService3.ProcessClientRequest31(tpn.protocol.SearchRequest{{ {} }}) status {}.", self->GetCallerInfo(), request.ShortDebugString(), status);
+  if (kErrorCodeOk != status)
+    self->SendResponse(self->service_hash_, method_id, token, status);
+}
+
+void TestService3::ServerCallProcessClientRequest32(TestService3 *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer) {
+  ::tpn::protocol::SearchRequest request;
+  if (!request.ParseFromArray(buffer.GetReadPointer(), buffer.GetActiveSize())) {
+    LOG_DEBUG("{} Failed to parse request for TestService3.ProcessClientRequest32 server method call.", self->GetCallerInfo());
+    self->SendResponse(self->service_hash_, method_id, token, kErrorCodeMalformedRequest);
+    return;
+  }
+  LOG_DEBUG("{} Client called server method TestService3.ProcessClientRequest32(tpn.protocol.SearchRequest{{ {} }}).", self->GetCallerInfo(), request.ShortDebugString());
+  ::tpn::protocol::SearchResponse response;
+  ::tpn::ServiceContinuation<::tpn::protocol::SearchResponse> continuation(&TestService3::ServerContinueProcessClientRequest32, token, method_id, nullptr);
+  ::tpn::protocol::ErrorCode status = self->HandleProcessClientRequest32(&request, &response, continuation);
+  if (continuation)
+    continuation(self, status, &response);
+}
+
+void TestService3::ServerContinueProcessClientRequest32(ServiceBase *service, uint32_t token, uint32_t method_id, ::tpn::ServiceArena */*arena*/, ::tpn::protocol::ErrorCode status, const ::tpn::protocol::SearchResponse *response) {
+  TestService3 *self = static_cast<TestService3 *>(service);
+  LOG_DEBUG("{} Client called server method TestService3.ProcessClientRequest32() returned tpn.protocol.SearchResponse{{ {} }} status {}.", self->GetCallerInfo(), response->ShortDebugString(), status);
+  if (kErrorCodeOk == status)
+    self->SendResponse(self->service_hash_, method_id, token, response);
+  else
+    self->SendResponse(self->service_hash_, method_id, token, status);
+}
+
+::tpn::protocol::ErrorCode TestService3::HandleProcessClientRequest31(const ::tpn::protocol::SearchRequest *request) {
+  LOG_ERROR("{} Client tried to call not implemented method TestService3.ProcessClientRequest31({{ {} }})", GetCallerInfo(), request->ShortDebugString());
+  return kErrorCodeNotImplemented;
+}
+
+::tpn::protocol::ErrorCode TestService3::HandleProcessClientRequest32(const ::tpn::protocol::SearchRequest *request, ::tpn::protocol::SearchResponse *response, ::tpn::ServiceContinuation<::tpn::protocol::SearchResponse> &continuation) {
+  LOG_ERROR("{} Client tried to call not implemented method TestService3.ProcessClientRequest32({{ {} }})", GetCallerInfo(), request->ShortDebugString());
+  return kErrorCodeNotImplemented;
+}
+
+// ===================================================================
+
+TChatService::TChatService()
+  : service_hash_(ServiceHash::value) {}
+
+TChatService::~TChatService() {}
+
+const ::google::protobuf::ServiceDescriptor *TChatService::descriptor() {
+  ::google::protobuf::internal::AssignDescriptors(&descriptor_table_protocol_2ftest_5fservice_2eproto);
+  return file_level_service_descriptors_protocol_2ftest_5fservice_2eproto[3];
+}
+
+void TChatService::UpdateInfo(const ::tpn::protocol::TUpdateInfoRequest *request, bool client /*= false*/, bool server /*= false*/) {
+  LOG_DEBUG("{} Server called client method TChatService.UpdateInfo(tpn.protocol.TUpdateInfoRequest{{ {}  }})", GetCallerInfo(), request->ShortDebugString());
+  SendRequest(service_hash_, 1 | (client ? 0x40000000 : 0) | (server ? 0x80000000 : 0), request);
 }
 
 void TChatService::Chat(const ::tpn::protocol::TChatRequest *request, bool client /*= false*/, bool server /*= false*/) {
@@ -1747,39 +2586,45 @@ void TChatService::Chat(const ::tpn::protocol::TChatRequest *request, bool clien
   SendRequest(service_hash_, 2 | (client ? 0x40000000 : 0) | (server ? 0x80000000 : 0), request);
 }
 
+constexpr TChatService::ServerMethodEntry TChatService::kServerMethods[kServerMethodTableSize] = {
+  {2, &TChatService::ServerCallChat},
+  {1, &TChatService::ServerCallUpdateInfo},
+};
+
 void TChatService::CallServerMethod(uint32_t token, uint32_t method_id, MessageBuffer buffer) {
-  switch(method_id & 0x3FFFFFFF) {
-    case 1: {
-      ::tpn::protocol::TUpdateInfoRequest request;
-      if (!request.ParseFromArray(buffer.GetReadPointer(), buffer.GetActiveSize())) {
-        LOG_DEBUG("{} Failed to parse request for TChatService.UpdateInfo server method call.", GetCallerInfo());
-        SendResponse(service_hash_, method_id, token, kErrorCodeMalformedRequest);
-        return;
-      }
-      ::tpn::protocol::ErrorCode status = HandleUpdateInfo(&request);
-      LOG_DEBUG("{} Client called server method TChatService.UpdateInfo(tpn.protocol.TUpdateInfoRequest{{ {} }}) status {}.", GetCallerInfo(), request.ShortDebugString(), status);
-      if (kErrorCodeOk != status)
-        SendResponse(service_hash_, method_id, token, status);
-      break;
-    }
-    case 2: {
-      ::tpn::protocol::TChatRequest request;
-      if (!request.ParseFromArray(buffer.GetReadPointer(), buffer.GetActiveSize())) {
-        LOG_DEBUG("{} Failed to parse request for TChatService.Chat server method call.", GetCallerInfo());
-        SendResponse(service_hash_, method_id, token, kErrorCodeMalformedRequest);
-        return;
-      }
-      ::tpn::protocol::ErrorCode status = HandleChat(&request);
-      LOG_DEBUG("{} Client called server method TChatService.Chat(tpn.protocol.TChatRequest{{ {} }}) status {}.", GetCallerInfo(), request.ShortDebugString(), status);
-      if (kErrorCodeOk != status)
-        SendResponse(service_hash_, method_id, token, status);
-      break;
-    }
-    default:
-      LOG_ERROR("Bad method id {}.", method_id);
-      SendResponse(service_hash_, method_id, token, kErrorCodeInvalidMethod);
-      break;
-    }
+  const ServerMethodEntry &entry = kServerMethods[(method_id & 0x3FFFFFFF) % kServerMethodTableSize];
+  if (nullptr != entry.method && entry.method_id == (method_id & 0x3FFFFFFF)) {
+    entry.method(this, token, method_id, buffer);
+    return;
+  }
+  LOG_ERROR("Bad method id {}.", method_id);
+  SendResponse(service_hash_, method_id, token, kErrorCodeInvalidMethod);
+}
+
+void TChatService::ServerCallUpdateInfo(TChatService *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer) {
+  ::tpn::protocol::TUpdateInfoRequest request;
+  if (!request.ParseFromArray(buffer.GetReadPointer(), buffer.GetActiveSize())) {
+    LOG_DEBUG("{} Failed to parse request for TChatService.UpdateInfo server method call.", self->GetCallerInfo());
+    self->SendResponse(self->service_hash_, method_id, token, kErrorCodeMalformedRequest);
+    return;
+  }
+  ::tpn::protocol::ErrorCode status = self->HandleUpdateInfo(&request);
+  LOG_DEBUG("{} Client called server method TChatService.UpdateInfo(tpn.protocol.TUpdateInfoRequest{{ {} }}) status {}.", self->GetCallerInfo(), request.ShortDebugString(), status);
+  if (kErrorCodeOk != status)
+    self->SendResponse(self->service_hash_, method_id, token, status);
+}
+
+void TChatService::ServerCallChat(TChatService *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer) {
+  ::tpn::protocol::TChatRequest request;
+  if (!request.ParseFromArray(buffer.GetReadPointer(), buffer.GetActiveSize())) {
+    LOG_DEBUG("{} Failed to parse request for TChatService.Chat server method call.", self->GetCallerInfo());
+    self->SendResponse(self->service_hash_, method_id, token, kErrorCodeMalformedRequest);
+    return;
+  }
+  ::tpn::protocol::ErrorCode status = self->HandleChat(&request);
+  LOG_DEBUG("{} Client called server method TChatService.Chat(tpn.protocol.TChatRequest{{ {} }}) status {}.", self->GetCallerInfo(), request.ShortDebugString(), status);
+  if (kErrorCodeOk != status)
+    self->SendResponse(self->service_hash_, method_id, token, status);
 }
 
 ::tpn::protocol::ErrorCode TChatService::HandleUpdateInfo(const ::tpn::protocol::TUpdateInfoRequest *request) {
@@ -1813,6 +2658,160 @@ void TChatListener::CallServerMethod(uint32_t token, uint32_t method_id, Message
   LOG_ERROR("{} Server tried to call server method {}", GetCallerInfo(), method_id);
 }
 
+// ===================================================================
+
+TInventoryService::TInventoryService()
+  : service_hash_(ServiceHash::value) {}
+
+TInventoryService::~TInventoryService() {}
+
+const ::google::protobuf::ServiceDescriptor *TInventoryService::descriptor() {
+  ::google::protobuf::internal::AssignDescriptors(&descriptor_table_protocol_2ftest_5fservice_2eproto);
+  return file_level_service_descriptors_protocol_2ftest_5fservice_2eproto[5];
+}
+
+constexpr TInventoryService::ServerMethodEntry TInventoryService::kServerMethods[kServerMethodTableSize] = {
+  {2, &TInventoryService::ServerCallUpdate},
+  {1, &TInventoryService::ServerCallSync},
+};
+
+void TInventoryService::CallServerMethod(uint32_t token, uint32_t method_id, MessageBuffer buffer) {
+  const ServerMethodEntry &entry = kServerMethods[(method_id & 0x3FFFFFFF) % kServerMethodTableSize];
+  if (nullptr != entry.method && entry.method_id == (method_id & 0x3FFFFFFF)) {
+    entry.method(this, token, method_id, buffer);
+    return;
+  }
+  LOG_ERROR("Bad method id {}.", method_id);
+  SendResponse(service_hash_, method_id, token, kErrorCodeInvalidMethod);
+}
+
+void TInventoryService::ServerCallSync(TInventoryService *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer) {
+  ::tpn::protocol::TInventoryRequest request;
+  if (!request.ParseFromArray(buffer.GetReadPointer(), buffer.GetActiveSize())) {
+    LOG_DEBUG("{} Failed to parse request for TInventoryService.Sync server method call.", self->GetCallerInfo());
+    self->SendResponse(self->service_hash_, method_id, token, kErrorCodeMalformedRequest);
+    return;
+  }
+  LOG_DEBUG("{} Client called server method TInventoryService.Sync(tpn.protocol.TInventoryRequest{{ {} }}).", self->GetCallerInfo(), request.ShortDebugString());
+  ::tpn::protocol::TInventoryResponse response;
+  ::tpn::ServiceContinuation<::tpn::protocol::TInventoryResponse> continuation(&TInventoryService::ServerContinueSync, token, method_id, nullptr);
+  ::tpn::protocol::ErrorCode status = self->HandleSync(&request, &response, continuation);
+  if (continuation)
+    continuation(self, status, &response);
+}
+
+void TInventoryService::ServerContinueSync(ServiceBase *service, uint32_t token, uint32_t method_id, ::tpn::ServiceArena */*arena*/, ::tpn::protocol::ErrorCode status, const ::tpn::protocol::TInventoryResponse *response) {
+  TInventoryService *self = static_cast<TInventoryService *>(service);
+  LOG_DEBUG("{} Client called server method TInventoryService.Sync() returned tpn.protocol.TInventoryResponse{{ {} }} status {}.", self->GetCallerInfo(), response->ShortDebugString(), status);
+  if (kErrorCodeOk == status)
+    self->SendResponse(self->service_hash_, method_id, token, response);
+  else
+    self->SendResponse(self->service_hash_, method_id, token, status);
+}
+
+void TInventoryService::ServerCallUpdate(TInventoryService *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer) {
+  ::tpn::protocol::TInventoryRequest request;
+  if (!request.ParseFromArray(buffer.GetReadPointer(), buffer.GetActiveSize())) {
+    LOG_DEBUG("{} Failed to parse request for TInventoryService.Update server method call.", self->GetCallerInfo());
+    self->SendResponse(self->service_hash_, method_id, token, kErrorCodeMalformedRequest);
+    return;
+  }
+  ::tpn::protocol::ErrorCode status = self->HandleUpdate(&request);
+  LOG_DEBUG("{} Client called server method TInventoryService.Update(tpn.protocol.TInventoryRequest{{ {} }}) status {}.", self->GetCallerInfo(), request.ShortDebugString(), status);
+  if (kErrorCodeOk != status)
+    self->SendResponse(self->service_hash_, method_id, token, status);
+}
+
+::tpn::protocol::ErrorCode TInventoryService::HandleSync(const ::tpn::protocol::TInventoryRequest *request, ::tpn::protocol::TInventoryResponse *response, ::tpn::ServiceContinuation<::tpn::protocol::TInventoryResponse> &continuation) {
+  LOG_ERROR("{} Client tried to call not implemented method TInventoryService.Sync({{ {} }})", GetCallerInfo(), request->ShortDebugString());
+  return kErrorCodeNotImplemented;
+}
+
+::tpn::protocol::ErrorCode TInventoryService::HandleUpdate(const ::tpn::protocol::TInventoryRequest *request) {
+  LOG_ERROR("{} Client tried to call not implemented method TInventoryService.Update({{ {} }})", GetCallerInfo(), request->ShortDebugString());
+  return kErrorCodeNotImplemented;
+}
+
+// ===================================================================
+
+TInventoryArenaService::TInventoryArenaService()
+  : service_hash_(ServiceHash::value) {}
+
+TInventoryArenaService::~TInventoryArenaService() {}
+
+const ::google::protobuf::ServiceDescriptor *TInventoryArenaService::descriptor() {
+  ::google::protobuf::internal::AssignDescriptors(&descriptor_table_protocol_2ftest_5fservice_2eproto);
+  return file_level_service_descriptors_protocol_2ftest_5fservice_2eproto[6];
+}
+
+constexpr TInventoryArenaService::ServerMethodEntry TInventoryArenaService::kServerMethods[kServerMethodTableSize] = {
+  {2, &TInventoryArenaService::ServerCallUpdate},
+  {1, &TInventoryArenaService::ServerCallSync},
+};
+
+void TInventoryArenaService::CallServerMethod(uint32_t token, uint32_t method_id, MessageBuffer buffer) {
+  const ServerMethodEntry &entry = kServerMethods[(method_id & 0x3FFFFFFF) % kServerMethodTableSize];
+  if (nullptr != entry.method && entry.method_id == (method_id & 0x3FFFFFFF)) {
+    entry.method(this, token, method_id, buffer);
+    return;
+  }
+  LOG_ERROR("Bad method id {}.", method_id);
+  SendResponse(service_hash_, method_id, token, kErrorCodeInvalidMethod);
+}
+
+void TInventoryArenaService::ServerCallSync(TInventoryArenaService *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer) {
+  ::tpn::ServiceArena *arena = ::tpn::ServiceArena::Acquire();
+  ::tpn::protocol::TInventoryRequest *request = arena->CreateMessage<::tpn::protocol::TInventoryRequest>();
+  if (!request->ParseFromArray(buffer.GetReadPointer(), buffer.GetActiveSize())) {
+    arena->Release();
+    LOG_DEBUG("{} Failed to parse request for TInventoryArenaService.Sync server method call.", self->GetCallerInfo());
+    self->SendResponse(self->service_hash_, method_id, token, kErrorCodeMalformedRequest);
+    return;
+  }
+  LOG_DEBUG("{} Client called server method TInventoryArenaService.Sync(tpn.protocol.TInventoryRequest{{ {} }}).", self->GetCallerInfo(), request->ShortDebugString());
+  ::tpn::protocol::TInventoryResponse *response = arena->CreateMessage<::tpn::protocol::TInventoryResponse>();
+  ::tpn::ServiceContinuation<::tpn::protocol::TInventoryResponse> continuation(&TInventoryArenaService::ServerContinueSync, token, method_id, arena);
+  ::tpn::protocol::ErrorCode status = self->HandleSync(request, response, continuation);
+  if (continuation)
+    continuation(self, status, response);
+}
+
+void TInventoryArenaService::ServerContinueSync(ServiceBase *service, uint32_t token, uint32_t method_id, ::tpn::ServiceArena *arena, ::tpn::protocol::ErrorCode status, const ::tpn::protocol::TInventoryResponse *response) {
+  TInventoryArenaService *self = static_cast<TInventoryArenaService *>(service);
+  LOG_DEBUG("{} Client called server method TInventoryArenaService.Sync() returned tpn.protocol.TInventoryResponse{{ {} }} status {}.", self->GetCallerInfo(), response->ShortDebugString(), status);
+  if (kErrorCodeOk == status)
+    self->SendResponse(self->service_hash_, method_id, token, response);
+  else
+    self->SendResponse(self->service_hash_, method_id, token, status);
+  arena->Release();
+}
+
+void TInventoryArenaService::ServerCallUpdate(TInventoryArenaService *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer) {
+  ::tpn::ServiceArena *arena = ::tpn::ServiceArena::Acquire();
+  ::tpn::protocol::TInventoryRequest *request = arena->CreateMessage<::tpn::protocol::TInventoryRequest>();
+  if (!request->ParseFromArray(buffer.GetReadPointer(), buffer.GetActiveSize())) {
+    arena->Release();
+    LOG_DEBUG("{} Failed to parse request for TInventoryArenaService.Update server method call.", self->GetCallerInfo());
+    self->SendResponse(self->service_hash_, method_id, token, kErrorCodeMalformedRequest);
+    return;
+  }
+  ::tpn::protocol::ErrorCode status = self->HandleUpdate(request);
+  LOG_DEBUG("{} Client called server method TInventoryArenaService.Update(tpn.protocol.TInventoryRequest{{ {} }}) status {}.", self->GetCallerInfo(), request->ShortDebugString(), status);
+  arena->Release();
+  if (kErrorCodeOk != status)
+    self->SendResponse(self->service_hash_, method_id, token, status);
+}
+
+::tpn::protocol::ErrorCode TInventoryArenaService::HandleSync(const ::tpn::protocol::TInventoryRequest *request, ::tpn::protocol::TInventoryResponse *response, ::tpn::ServiceContinuation<::tpn::protocol::TInventoryResponse> &continuation) {
+  LOG_ERROR("{} Client tried to call not implemented method TInventoryArenaService.Sync({{ {} }})", GetCallerInfo(), request->ShortDebugString());
+  return kErrorCodeNotImplemented;
+}
+
+::tpn::protocol::ErrorCode TInventoryArenaService::HandleUpdate(const ::tpn::protocol::TInventoryRequest *request) {
+  LOG_ERROR("{} Client tried to call not implemented method TInventoryArenaService.Update({{ {} }})", GetCallerInfo(), request->ShortDebugString());
+  return kErrorCodeNotImplemented;
+}
+
 
 // @@protoc_insertion_point(namespace_scope)
 }  // namespace protocol
@@ -1836,6 +2835,15 @@ template<> PROTOBUF_NOINLINE ::tpn::protocol::TChatRequest* Arena::CreateMaybeMe
 template<> PROTOBUF_NOINLINE ::tpn::protocol::TChatNtf* Arena::CreateMaybeMessage< ::tpn::protocol::TChatNtf >(Arena* arena) {
   return Arena::CreateMessageInternal< ::tpn::protocol::TChatNtf >(arena);
 }
+template<> PROTOBUF_NOINLINE ::tpn::protocol::TItem* Arena::CreateMaybeMessage< ::tpn::protocol::TItem >(Arena* arena) {
+  return Arena::CreateMessageInternal< ::tpn::protocol::TItem >(arena);
+}
+template<> PROTOBUF_NOINLINE ::tpn::protocol::TInventoryRequest* Arena::CreateMaybeMessage< ::tpn::protocol::TInventoryRequest >(Arena* arena) {
+  return Arena::CreateMessageInternal< ::tpn::protocol::TInventoryRequest >(arena);
+}
+template<> PROTOBUF_NOINLINE ::tpn::protocol::TInventoryResponse* Arena::CreateMaybeMessage< ::tpn::protocol::TInventoryResponse >(Arena* arena) {
+  return Arena::CreateMessageInternal< ::tpn::protocol::TInventoryResponse >(arena);
+}
 PROTOBUF_NAMESPACE_CLOSE
 
 // @@protoc_insertion_point(global_scope)
@@ -53,7 +53,7 @@ struct TableStruct_protocol_2ftest_5fservice_2eproto {
     PROTOBUF_SECTION_VARIABLE(protodesc_cold);
   static const ::PROTOBUF_NAMESPACE_ID::internal::AuxiliaryParseTableField aux[]
     PROTOBUF_SECTION_VARIABLE(protodesc_cold);
-  static const ::PROTOBUF_NAMESPACE_ID::internal::ParseTable schema[6]
+  static const ::PROTOBUF_NAMESPACE_ID::internal::ParseTable schema[9]
     PROTOBUF_SECTION_VARIABLE(protodesc_cold);
   static const ::PROTOBUF_NAMESPACE_ID::internal::FieldMetadata field_metadata[];
   static const ::PROTOBUF_NAMESPACE_ID::internal::SerializationTable serialization_table[];
@@ -77,6 +77,15 @@ extern TChatNtfDefaultTypeInternal _TChatNtf_default_instance_;
 class TChatRequest;
 struct TChatRequestDefaultTypeInternal;
 extern TChatRequestDefaultTypeInternal _TChatRequest_default_instance_;
+class TInventoryRequest;
+struct TInventoryRequestDefaultTypeInternal;
+extern TInventoryRequestDefaultTypeInternal _TInventoryRequest_default_instance_;
+class TInventoryResponse;
+struct TInventoryResponseDefaultTypeInternal;
+extern TInventoryResponseDefaultTypeInternal _TInventoryResponse_default_instance_;
+class TItem;
+struct TItemDefaultTypeInternal;
+extern TItemDefaultTypeInternal _TItem_default_instance_;
 class TUpdateInfoRequest;
 struct TUpdateInfoRequestDefaultTypeInternal;
 extern TUpdateInfoRequestDefaultTypeInternal _TUpdateInfoRequest_default_instance_;
@@ -88,6 +97,9 @@ template<> ::tpn::protocol::SearchRequest* Arena::CreateMaybeMessage<::tpn::prot
 template<> ::tpn::protocol::SearchResponse* Arena::CreateMaybeMessage<::tpn::protocol::SearchResponse>(Arena*);
 template<> ::tpn::protocol::TChatNtf* Arena::CreateMaybeMessage<::tpn::protocol::TChatNtf>(Arena*);
 template<> ::tpn::protocol::TChatRequest* Arena::CreateMaybeMessage<::tpn::protocol::TChatRequest>(Arena*);
+template<> ::tpn::protocol::TInventoryRequest* Arena::CreateMaybeMessage<::tpn::protocol::TInventoryRequest>(Arena*);
+template<> ::tpn::protocol::TInventoryResponse* Arena::CreateMaybeMessage<::tpn::protocol::TInventoryResponse>(Arena*);
+template<> ::tpn::protocol::TItem* Arena::CreateMaybeMessage<::tpn::protocol::TItem>(Arena*);
 template<> ::tpn::protocol::TUpdateInfoRequest* Arena::CreateMaybeMessage<::tpn::protocol::TUpdateInfoRequest>(Arena*);
 PROTOBUF_NAMESPACE_CLOSE
 namespace tpn {
@@ -1035,6 +1047,524 @@ class TChatNtf final :
   mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
   friend struct ::TableStruct_protocol_2ftest_5fservice_2eproto;
 };
+// -------------------------------------------------------------------
+
+class TItem final :
+    public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:tpn.protocol.TItem) */ {
+ public:
+  inline TItem() : TItem(nullptr) {}
+  ~TItem() override;
+  explicit constexpr TItem(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
+
+  TItem(const TItem& from);
+  TItem(TItem&& from) noexcept
+    : TItem() {
+    *this = ::std::move(from);
+  }
+
+  inline TItem& operator=(const TItem& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  inline TItem& operator=(TItem&& from) noexcept {
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()) {
+      InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* descriptor() {
+    return GetDescriptor();
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
+    return default_instance().GetMetadata().descriptor;
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
+    return default_instance().GetMetadata().reflection;
+  }
+  static const TItem& default_instance() {
+    return *internal_default_instance();
+  }
+  static inline const TItem* internal_default_instance() {
+    return reinterpret_cast<const TItem*>(
+               &_TItem_default_instance_);
+  }
+  static constexpr int kIndexInFileMessages =
+    6;
+
+  friend void swap(TItem& a, TItem& b) {
+    a.Swap(&b);
+  }
+  inline void Swap(TItem* other) {
+    if (other == this) return;
+    if (GetOwningArena() == other->GetOwningArena()) {
+      InternalSwap(other);
+    } else {
+      ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
+    }
+  }
+  void UnsafeArenaSwap(TItem* other) {
+    if (other == this) return;
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
+    InternalSwap(other);
+  }
+
+  // implements Message ----------------------------------------------
+
+  inline TItem* New() const final {
+    return new TItem();
+  }
+
+  TItem* New(::PROTOBUF_NAMESPACE_ID::Arena* arena) const final {
+    return CreateMaybeMessage<TItem>(arena);
+  }
+  using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
+  void CopyFrom(const TItem& from);
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  void MergeFrom(const TItem& from);
+  private:
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message*to, const ::PROTOBUF_NAMESPACE_ID::Message&from);
+  public:
+  PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
+  bool IsInitialized() const final;
+
+  size_t ByteSizeLong() const final;
+  const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
+  ::PROTOBUF_NAMESPACE_ID::uint8* _InternalSerialize(
+      ::PROTOBUF_NAMESPACE_ID::uint8* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
+  int GetCachedSize() const final { return _cached_size_.Get(); }
+
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const final;
+  void InternalSwap(TItem* other);
+  friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
+  static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
+    return "tpn.protocol.TItem";
+  }
+  protected:
+  explicit TItem(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
+  private:
+  static void ArenaDtor(void* object);
+  inline void RegisterArenaDtor(::PROTOBUF_NAMESPACE_ID::Arena* arena);
+  public:
+
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
+
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  enum : int {
+    kAttrsFieldNumber = 5,
+    kGemsFieldNumber = 6,
+    kNameFieldNumber = 4,
+    kGuidFieldNumber = 1,
+    kConfigIdFieldNumber = 2,
+    kCountFieldNumber = 3,
+  };
+  // repeated uint32 attrs = 5;
+  int attrs_size() const;
+  private:
+  int _internal_attrs_size() const;
+  public:
+  void clear_attrs();
+  private:
+  ::PROTOBUF_NAMESPACE_ID::uint32 _internal_attrs(int index) const;
+  const ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >&
+      _internal_attrs() const;
+  void _internal_add_attrs(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >*
+      _internal_mutable_attrs();
+  public:
+  ::PROTOBUF_NAMESPACE_ID::uint32 attrs(int index) const;
+  void set_attrs(int index, ::PROTOBUF_NAMESPACE_ID::uint32 value);
+  void add_attrs(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  const ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >&
+      attrs() const;
+  ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >*
+      mutable_attrs();
+
+  // repeated .tpn.protocol.TItem gems = 6;
+  int gems_size() const;
+  private:
+  int _internal_gems_size() const;
+  public:
+  void clear_gems();
+  ::tpn::protocol::TItem* mutable_gems(int index);
+  ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::tpn::protocol::TItem >*
+      mutable_gems();
+  private:
+  const ::tpn::protocol::TItem& _internal_gems(int index) const;
+  ::tpn::protocol::TItem* _internal_add_gems();
+  public:
+  const ::tpn::protocol::TItem& gems(int index) const;
+  ::tpn::protocol::TItem* add_gems();
+  const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::tpn::protocol::TItem >&
+      gems() const;
+
+  // string name = 4;
+  void clear_name();
+  const std::string& name() const;
+  template <typename ArgT0 = const std::string&, typename... ArgT>
+  void set_name(ArgT0&& arg0, ArgT... args);
+  std::string* mutable_name();
+  PROTOBUF_MUST_USE_RESULT std::string* release_name();
+  void set_allocated_name(std::string* name);
+  private:
+  const std::string& _internal_name() const;
+  inline PROTOBUF_ALWAYS_INLINE void _internal_set_name(const std::string& value);
+  std::string* _internal_mutable_name();
+  public:
+
+  // uint64 guid = 1;
+  void clear_guid();
+  ::PROTOBUF_NAMESPACE_ID::uint64 guid() const;
+  void set_guid(::PROTOBUF_NAMESPACE_ID::uint64 value);
+  private:
+  ::PROTOBUF_NAMESPACE_ID::uint64 _internal_guid() const;
+  void _internal_set_guid(::PROTOBUF_NAMESPACE_ID::uint64 value);
+  public:
+
+  // uint32 config_id = 2;
+  void clear_config_id();
+  ::PROTOBUF_NAMESPACE_ID::uint32 config_id() const;
+  void set_config_id(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  private:
+  ::PROTOBUF_NAMESPACE_ID::uint32 _internal_config_id() const;
+  void _internal_set_config_id(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  public:
+
+  // uint32 count = 3;
+  void clear_count();
+  ::PROTOBUF_NAMESPACE_ID::uint32 count() const;
+  void set_count(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  private:
+  ::PROTOBUF_NAMESPACE_ID::uint32 _internal_count() const;
+  void _internal_set_count(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  public:
+
+  // @@protoc_insertion_point(class_scope:tpn.protocol.TItem)
+ private:
+  class _Internal;
+
+  template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
+  typedef void InternalArenaConstructable_;
+  typedef void DestructorSkippable_;
+  ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 > attrs_;
+  mutable std::atomic<int> _attrs_cached_byte_size_;
+  ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::tpn::protocol::TItem > gems_;
+  ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr name_;
+  ::PROTOBUF_NAMESPACE_ID::uint64 guid_;
+  ::PROTOBUF_NAMESPACE_ID::uint32 config_id_;
+  ::PROTOBUF_NAMESPACE_ID::uint32 count_;
+  mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+  friend struct ::TableStruct_protocol_2ftest_5fservice_2eproto;
+};
+// -------------------------------------------------------------------
+
+class TInventoryRequest final :
+    public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:tpn.protocol.TInventoryRequest) */ {
+ public:
+  inline TInventoryRequest() : TInventoryRequest(nullptr) {}
+  ~TInventoryRequest() override;
+  explicit constexpr TInventoryRequest(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
+
+  TInventoryRequest(const TInventoryRequest& from);
+  TInventoryRequest(TInventoryRequest&& from) noexcept
+    : TInventoryRequest() {
+    *this = ::std::move(from);
+  }
+
+  inline TInventoryRequest& operator=(const TInventoryRequest& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  inline TInventoryRequest& operator=(TInventoryRequest&& from) noexcept {
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()) {
+      InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* descriptor() {
+    return GetDescriptor();
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
+    return default_instance().GetMetadata().descriptor;
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
+    return default_instance().GetMetadata().reflection;
+  }
+  static const TInventoryRequest& default_instance() {
+    return *internal_default_instance();
+  }
+  static inline const TInventoryRequest* internal_default_instance() {
+    return reinterpret_cast<const TInventoryRequest*>(
+               &_TInventoryRequest_default_instance_);
+  }
+  static constexpr int kIndexInFileMessages =
+    7;
+
+  friend void swap(TInventoryRequest& a, TInventoryRequest& b) {
+    a.Swap(&b);
+  }
+  inline void Swap(TInventoryRequest* other) {
+    if (other == this) return;
+    if (GetOwningArena() == other->GetOwningArena()) {
+      InternalSwap(other);
+    } else {
+      ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
+    }
+  }
+  void UnsafeArenaSwap(TInventoryRequest* other) {
+    if (other == this) return;
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
+    InternalSwap(other);
+  }
+
+  // implements Message ----------------------------------------------
+
+  inline TInventoryRequest* New() const final {
+    return new TInventoryRequest();
+  }
+
+  TInventoryRequest* New(::PROTOBUF_NAMESPACE_ID::Arena* arena) const final {
+    return CreateMaybeMessage<TInventoryRequest>(arena);
+  }
+  using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
+  void CopyFrom(const TInventoryRequest& from);
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  void MergeFrom(const TInventoryRequest& from);
+  private:
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message*to, const ::PROTOBUF_NAMESPACE_ID::Message&from);
+  public:
+  PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
+  bool IsInitialized() const final;
+
+  size_t ByteSizeLong() const final;
+  const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
+  ::PROTOBUF_NAMESPACE_ID::uint8* _InternalSerialize(
+      ::PROTOBUF_NAMESPACE_ID::uint8* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
+  int GetCachedSize() const final { return _cached_size_.Get(); }
+
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const final;
+  void InternalSwap(TInventoryRequest* other);
+  friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
+  static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
+    return "tpn.protocol.TInventoryRequest";
+  }
+  protected:
+  explicit TInventoryRequest(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
+  private:
+  static void ArenaDtor(void* object);
+  inline void RegisterArenaDtor(::PROTOBUF_NAMESPACE_ID::Arena* arena);
+  public:
+
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
+
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  enum : int {
+    kItemsFieldNumber = 1,
+  };
+  // repeated .tpn.protocol.TItem items = 1;
+  int items_size() const;
+  private:
+  int _internal_items_size() const;
+  public:
+  void clear_items();
+  ::tpn::protocol::TItem* mutable_items(int index);
+  ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::tpn::protocol::TItem >*
+      mutable_items();
+  private:
+  const ::tpn::protocol::TItem& _internal_items(int index) const;
+  ::tpn::protocol::TItem* _internal_add_items();
+  public:
+  const ::tpn::protocol::TItem& items(int index) const;
+  ::tpn::protocol::TItem* add_items();
+  const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::tpn::protocol::TItem >&
+      items() const;
+
+  // @@protoc_insertion_point(class_scope:tpn.protocol.TInventoryRequest)
+ private:
+  class _Internal;
+
+  template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
+  typedef void InternalArenaConstructable_;
+  typedef void DestructorSkippable_;
+  ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::tpn::protocol::TItem > items_;
+  mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+  friend struct ::TableStruct_protocol_2ftest_5fservice_2eproto;
+};
+// -------------------------------------------------------------------
+
+class TInventoryResponse final :
+    public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:tpn.protocol.TInventoryResponse) */ {
+ public:
+  inline TInventoryResponse() : TInventoryResponse(nullptr) {}
+  ~TInventoryResponse() override;
+  explicit constexpr TInventoryResponse(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
+
+  TInventoryResponse(const TInventoryResponse& from);
+  TInventoryResponse(TInventoryResponse&& from) noexcept
+    : TInventoryResponse() {
+    *this = ::std::move(from);
+  }
+
+  inline TInventoryResponse& operator=(const TInventoryResponse& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  inline TInventoryResponse& operator=(TInventoryResponse&& from) noexcept {
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()) {
+      InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* descriptor() {
+    return GetDescriptor();
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
+    return default_instance().GetMetadata().descriptor;
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
+    return default_instance().GetMetadata().reflection;
+  }
+  static const TInventoryResponse& default_instance() {
+    return *internal_default_instance();
+  }
+  static inline const TInventoryResponse* internal_default_instance() {
+    return reinterpret_cast<const TInventoryResponse*>(
+               &_TInventoryResponse_default_instance_);
+  }
+  static constexpr int kIndexInFileMessages =
+    8;
+
+  friend void swap(TInventoryResponse& a, TInventoryResponse& b) {
+    a.Swap(&b);
+  }
+  inline void Swap(TInventoryResponse* other) {
+    if (other == this) return;
+    if (GetOwningArena() == other->GetOwningArena()) {
+      InternalSwap(other);
+    } else {
+      ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
+    }
+  }
+  void UnsafeArenaSwap(TInventoryResponse* other) {
+    if (other == this) return;
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
+    InternalSwap(other);
+  }
+
+  // implements Message ----------------------------------------------
+
+  inline TInventoryResponse* New() const final {
+    return new TInventoryResponse();
+  }
+
+  TInventoryResponse* New(::PROTOBUF_NAMESPACE_ID::Arena* arena) const final {
+    return CreateMaybeMessage<TInventoryResponse>(arena);
+  }
+  using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
+  void CopyFrom(const TInventoryResponse& from);
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  void MergeFrom(const TInventoryResponse& from);
+  private:
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message*to, const ::PROTOBUF_NAMESPACE_ID::Message&from);
+  public:
+  PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
+  bool IsInitialized() const final;
+
+  size_t ByteSizeLong() const final;
+  const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
+  ::PROTOBUF_NAMESPACE_ID::uint8* _InternalSerialize(
+      ::PROTOBUF_NAMESPACE_ID::uint8* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
+  int GetCachedSize() const final { return _cached_size_.Get(); }
+
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const final;
+  void InternalSwap(TInventoryResponse* other);
+  friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
+  static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
+    return "tpn.protocol.TInventoryResponse";
+  }
+  protected:
+  explicit TInventoryResponse(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
+  private:
+  static void ArenaDtor(void* object);
+  inline void RegisterArenaDtor(::PROTOBUF_NAMESPACE_ID::Arena* arena);
+  public:
+
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
+
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  enum : int {
+    kItemsFieldNumber = 1,
+  };
+  // repeated .tpn.protocol.TItem items = 1;
+  int items_size() const;
+  private:
+  int _internal_items_size() const;
+  public:
+  void clear_items();
+  ::tpn::protocol::TItem* mutable_items(int index);
+  ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::tpn::protocol::TItem >*
+      mutable_items();
+  private:
+  const ::tpn::protocol::TItem& _internal_items(int index) const;
+  ::tpn::protocol::TItem* _internal_add_items();
+  public:
+  const ::tpn::protocol::TItem& items(int index) const;
+  ::tpn::protocol::TItem* add_items();
+  const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::tpn::protocol::TItem >&
+      items() const;
+
+  // @@protoc_insertion_point(class_scope:tpn.protocol.TInventoryResponse)
+ private:
+  class _Internal;
+
+  template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
+  typedef void InternalArenaConstructable_;
+  typedef void DestructorSkippable_;
+  ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::tpn::protocol::TItem > items_;
+  mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+  friend struct ::TableStruct_protocol_2ftest_5fservice_2eproto;
+};
 // ===================================================================
 
 class TestService1 : public ServiceBase {
@@ -1074,9 +1604,24 @@ class TestService2 : public ServiceBase {
  protected:
   // outbound methods --------------------------------------------------
   virtual ::tpn::protocol::ErrorCode HandleProcessClientRequest21(const ::tpn::protocol::SearchRequest *request);
-  virtual ::tpn::protocol::ErrorCode HandleProcessClientRequest22(const ::tpn::protocol::SearchRequest *request, ::tpn::protocol::SearchResponse *response, std::function<void(ServiceBase*, ::tpn::protocol::ErrorCode, const ::google::protobuf::Message *)> &continuation);
+  virtual ::tpn::protocol::ErrorCode HandleProcessClientRequest22(const ::tpn::protocol::SearchRequest *request, ::tpn::protocol::SearchResponse *response, ::tpn::ServiceContinuation<::tpn::protocol::SearchResponse> &continuation);
 
  private:
+  // server method table ----------------------------------------------
+  using ServerMethod = void (*)(TestService2 *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer);
+
+  struct ServerMethodEntry {
+    uint32_t method_id;
+    ServerMethod method;
+  };
+
+  static constexpr uint32_t kServerMethodTableSize = 2;
+  static const ServerMethodEntry kServerMethods[kServerMethodTableSize];
+
+  static void ServerCallProcessClientRequest21(TestService2 *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer);
+  static void ServerCallProcessClientRequest22(TestService2 *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer);
+  static void ServerContinueProcessClientRequest22(ServiceBase *service, uint32_t token, uint32_t method_id, ::tpn::ServiceArena *arena, ::tpn::protocol::ErrorCode status, const ::tpn::protocol::SearchResponse *response);
+
   uint32_t service_hash_{0};
 
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(TestService2);
@@ -1102,9 +1647,24 @@ class TestService3 : public ServiceBase {
  protected:
   // outbound methods --------------------------------------------------
   virtual ::tpn::protocol::ErrorCode HandleProcessClientRequest31(const ::tpn::protocol::SearchRequest *request);
-  virtual ::tpn::protocol::ErrorCode HandleProcessClientRequest32(const ::tpn::protocol::SearchRequest *request, ::tpn::protocol::SearchResponse *response, std::function<void(ServiceBase*, ::tpn::protocol::ErrorCode, const ::google::protobuf::Message *)> &continuation);
+  virtual ::tpn::protocol::ErrorCode HandleProcessClientRequest32(const ::tpn::protocol::SearchRequest *request, ::tpn::protocol::SearchResponse *response, ::tpn::ServiceContinuation<::tpn::protocol::SearchResponse> &continuation);
 
  private:
+  // server method table ----------------------------------------------
+  using ServerMethod = void (*)(TestService3 *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer);
+
+  struct ServerMethodEntry {
+    uint32_t method_id;
+    ServerMethod method;
+  };
+
+  static constexpr uint32_t kServerMethodTableSize = 2;
+  static const ServerMethodEntry kServerMethods[kServerMethodTableSize];
+
+  static void ServerCallProcessClientRequest31(TestService3 *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer);
+  static void ServerCallProcessClientRequest32(TestService3 *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer);
+  static void ServerContinueProcessClientRequest32(ServiceBase *service, uint32_t token, uint32_t method_id, ::tpn::ServiceArena *arena, ::tpn::protocol::ErrorCode status, const ::tpn::protocol::SearchResponse *response);
+
   uint32_t service_hash_{0};
 
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(TestService3);
@@ -1133,6 +1693,20 @@ class TChatService : public ServiceBase {
   virtual ::tpn::protocol::ErrorCode HandleChat(const ::tpn::protocol::TChatRequest *request);
 
  private:
+  // server method table ----------------------------------------------
+  using ServerMethod = void (*)(TChatService *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer);
+
+  struct ServerMethodEntry {
+    uint32_t method_id;
+    ServerMethod method;
+  };
+
+  static constexpr uint32_t kServerMethodTableSize = 2;
+  static const ServerMethodEntry kServerMethods[kServerMethodTableSize];
+
+  static void ServerCallUpdateInfo(TChatService *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer);
+  static void ServerCallChat(TChatService *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer);
+
   uint32_t service_hash_{0};
 
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(TChatService);
@@ -1160,6 +1734,84 @@ class TChatListener : public ServiceBase {
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(TChatListener);
 };
 
+// -------------------------------------------------------------------
+
+class TInventoryService : public ServiceBase {
+ public:
+
+  TInventoryService();
+  virtual ~TInventoryService();
+
+  using ServiceHash = std::integral_constant<uint32_t, 0x7D1FBE4Cu>;
+
+  static const ::google::protobuf::ServiceDescriptor *descriptor();
+
+  void CallServerMethod(uint32_t token, uint32_t method_id, MessageBuffer buffer) final;
+ protected:
+  // outbound methods --------------------------------------------------
+  virtual ::tpn::protocol::ErrorCode HandleSync(const ::tpn::protocol::TInventoryRequest *request, ::tpn::protocol::TInventoryResponse *response, ::tpn::ServiceContinuation<::tpn::protocol::TInventoryResponse> &continuation);
+  virtual ::tpn::protocol::ErrorCode HandleUpdate(const ::tpn::protocol::TInventoryRequest *request);
+
+ private:
+  // server method table ----------------------------------------------
+  using ServerMethod = void (*)(TInventoryService *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer);
+
+  struct ServerMethodEntry {
+    uint32_t method_id;
+    ServerMethod method;
+  };
+
+  static constexpr uint32_t kServerMethodTableSize = 2;
+  static const ServerMethodEntry kServerMethods[kServerMethodTableSize];
+
+  static void ServerCallSync(TInventoryService *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer);
+  static void ServerContinueSync(ServiceBase *service, uint32_t token, uint32_t method_id, ::tpn::ServiceArena *arena, ::tpn::protocol::ErrorCode status, const ::tpn::protocol::TInventoryResponse *response);
+  static void ServerCallUpdate(TInventoryService *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer);
+
+  uint32_t service_hash_{0};
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(TInventoryService);
+};
+
+// -------------------------------------------------------------------
+
+class TInventoryArenaService : public ServiceBase {
+ public:
+
+  TInventoryArenaService();
+  virtual ~TInventoryArenaService();
+
+  using ServiceHash = std::integral_constant<uint32_t, 0x19553443u>;
+
+  static const ::google::protobuf::ServiceDescriptor *descriptor();
+
+  void CallServerMethod(uint32_t token, uint32_t method_id, MessageBuffer buffer) final;
+ protected:
+  // outbound methods --------------------------------------------------
+  virtual ::tpn::protocol::ErrorCode HandleSync(const ::tpn::protocol::TInventoryRequest *request, ::tpn::protocol::TInventoryResponse *response, ::tpn::ServiceContinuation<::tpn::protocol::TInventoryResponse> &continuation);
+  virtual ::tpn::protocol::ErrorCode HandleUpdate(const ::tpn::protocol::TInventoryRequest *request);
+
+ private:
+  // server method table ----------------------------------------------
+  using ServerMethod = void (*)(TInventoryArenaService *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer);
+
+  struct ServerMethodEntry {
+    uint32_t method_id;
+    ServerMethod method;
+  };
+
+  static constexpr uint32_t kServerMethodTableSize = 2;
+  static const ServerMethodEntry kServerMethods[kServerMethodTableSize];
+
+  static void ServerCallSync(TInventoryArenaService *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer);
+  static void ServerContinueSync(ServiceBase *service, uint32_t token, uint32_t method_id, ::tpn::ServiceArena *arena, ::tpn::protocol::ErrorCode status, const ::tpn::protocol::TInventoryResponse *response);
+  static void ServerCallUpdate(TInventoryArenaService *self, uint32_t token, uint32_t method_id, MessageBuffer &buffer);
+
+  uint32_t service_hash_{0};
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(TInventoryArenaService);
+};
+
 // ===================================================================
 
 
@@ -1651,6 +2303,291 @@ TChatNtf::mutable_message_list() {
   return &message_list_;
 }
 
+// -------------------------------------------------------------------
+
+// TItem
+
+// uint64 guid = 1;
+inline void TItem::clear_guid() {
+  guid_ = uint64_t{0u};
+}
+inline ::PROTOBUF_NAMESPACE_ID::uint64 TItem::_internal_guid() const {
+  return guid_;
+}
+inline ::PROTOBUF_NAMESPACE_ID::uint64 TItem::guid() const {
+  // @@protoc_insertion_point(field_get:tpn.protocol.TItem.guid)
+  return _internal_guid();
+}
+inline void TItem::_internal_set_guid(::PROTOBUF_NAMESPACE_ID::uint64 value) {
+  
+  guid_ = value;
+}
+inline void TItem::set_guid(::PROTOBUF_NAMESPACE_ID::uint64 value) {
+  _internal_set_guid(value);
+  // @@protoc_insertion_point(field_set:tpn.protocol.TItem.guid)
+}
+
+// uint32 config_id = 2;
+inline void TItem::clear_config_id() {
+  config_id_ = 0u;
+}
+inline ::PROTOBUF_NAMESPACE_ID::uint32 TItem::_internal_config_id() const {
+  return config_id_;
+}
+inline ::PROTOBUF_NAMESPACE_ID::uint32 TItem::config_id() const {
+  // @@protoc_insertion_point(field_get:tpn.protocol.TItem.config_id)
+  return _internal_config_id();
+}
+inline void TItem::_internal_set_config_id(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+  
+  config_id_ = value;
+}
+inline void TItem::set_config_id(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+  _internal_set_config_id(value);
+  // @@protoc_insertion_point(field_set:tpn.protocol.TItem.config_id)
+}
+
+// uint32 count = 3;
+inline void TItem::clear_count() {
+  count_ = 0u;
+}
+inline ::PROTOBUF_NAMESPACE_ID::uint32 TItem::_internal_count() const {
+  return count_;
+}
+inline ::PROTOBUF_NAMESPACE_ID::uint32 TItem::count() const {
+  // @@protoc_insertion_point(field_get:tpn.protocol.TItem.count)
+  return _internal_count();
+}
+inline void TItem::_internal_set_count(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+  
+  count_ = value;
+}
+inline void TItem::set_count(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+  _internal_set_count(value);
+  // @@protoc_insertion_point(field_set:tpn.protocol.TItem.count)
+}
+
+// string name = 4;
+inline void TItem::clear_name() {
+  name_.ClearToEmpty();
+}
+inline const std::string& TItem::name() const {
+  // @@protoc_insertion_point(field_get:tpn.protocol.TItem.name)
+  return _internal_name();
+}
+template <typename ArgT0, typename... ArgT>
+inline PROTOBUF_ALWAYS_INLINE
+void TItem::set_name(ArgT0&& arg0, ArgT... args) {
+ 
+ name_.Set(::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr::EmptyDefault{}, static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
+  // @@protoc_insertion_point(field_set:tpn.protocol.TItem.name)
+}
+inline std::string* TItem::mutable_name() {
+  std::string* _s = _internal_mutable_name();
+  // @@protoc_insertion_point(field_mutable:tpn.protocol.TItem.name)
+  return _s;
+}
+inline const std::string& TItem::_internal_name() const {
+  return name_.Get();
+}
+inline void TItem::_internal_set_name(const std::string& value) {
+  
+  name_.Set(::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr::EmptyDefault{}, value, GetArenaForAllocation());
+}
+inline std::string* TItem::_internal_mutable_name() {
+  
+  return name_.Mutable(::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr::EmptyDefault{}, GetArenaForAllocation());
+}
+inline std::string* TItem::release_name() {
+  // @@protoc_insertion_point(field_release:tpn.protocol.TItem.name)
+  return name_.Release(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(), GetArenaForAllocation());
+}
+inline void TItem::set_allocated_name(std::string* name) {
+  if (name != nullptr) {
+    
+  } else {
+    
+  }
+  name_.SetAllocated(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited(), name,
+      GetArenaForAllocation());
+  // @@protoc_insertion_point(field_set_allocated:tpn.protocol.TItem.name)
+}
+
+// repeated uint32 attrs = 5;
+inline int TItem::_internal_attrs_size() const {
+  return attrs_.size();
+}
+inline int TItem::attrs_size() const {
+  return _internal_attrs_size();
+}
+inline void TItem::clear_attrs() {
+  attrs_.Clear();
+}
+inline ::PROTOBUF_NAMESPACE_ID::uint32 TItem::_internal_attrs(int index) const {
+  return attrs_.Get(index);
+}
+inline ::PROTOBUF_NAMESPACE_ID::uint32 TItem::attrs(int index) const {
+  // @@protoc_insertion_point(field_get:tpn.protocol.TItem.attrs)
+  return _internal_attrs(index);
+}
+inline void TItem::set_attrs(int index, ::PROTOBUF_NAMESPACE_ID::uint32 value) {
+  attrs_.Set(index, value);
+  // @@protoc_insertion_point(field_set:tpn.protocol.TItem.attrs)
+}
+inline void TItem::_internal_add_attrs(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+  attrs_.Add(value);
+}
+inline void TItem::add_attrs(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+  _internal_add_attrs(value);
+  // @@protoc_insertion_point(field_add:tpn.protocol.TItem.attrs)
+}
+inline const ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >&
+TItem::_internal_attrs() const {
+  return attrs_;
+}
+inline const ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >&
+TItem::attrs() const {
+  // @@protoc_insertion_point(field_list:tpn.protocol.TItem.attrs)
+  return _internal_attrs();
+}
+inline ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >*
+TItem::_internal_mutable_attrs() {
+  return &attrs_;
+}
+inline ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >*
+TItem::mutable_attrs() {
+  // @@protoc_insertion_point(field_mutable_list:tpn.protocol.TItem.attrs)
+  return _internal_mutable_attrs();
+}
+
+// repeated .tpn.protocol.TItem gems = 6;
+inline int TItem::_internal_gems_size() const {
+  return gems_.size();
+}
+inline int TItem::gems_size() const {
+  return _internal_gems_size();
+}
+inline void TItem::clear_gems() {
+  gems_.Clear();
+}
+inline ::tpn::protocol::TItem* TItem::mutable_gems(int index) {
+  // @@protoc_insertion_point(field_mutable:tpn.protocol.TItem.gems)
+  return gems_.Mutable(index);
+}
+inline ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::tpn::protocol::TItem >*
+TItem::mutable_gems() {
+  // @@protoc_insertion_point(field_mutable_list:tpn.protocol.TItem.gems)
+  return &gems_;
+}
+inline const ::tpn::protocol::TItem& TItem::_internal_gems(int index) const {
+  return gems_.Get(index);
+}
+inline const ::tpn::protocol::TItem& TItem::gems(int index) const {
+  // @@protoc_insertion_point(field_get:tpn.protocol.TItem.gems)
+  return _internal_gems(index);
+}
+inline ::tpn::protocol::TItem* TItem::_internal_add_gems() {
+  return gems_.Add();
+}
+inline ::tpn::protocol::TItem* TItem::add_gems() {
+  ::tpn::protocol::TItem* _add = _internal_add_gems();
+  // @@protoc_insertion_point(field_add:tpn.protocol.TItem.gems)
+  return _add;
+}
+inline const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::tpn::protocol::TItem >&
+TItem::gems() const {
+  // @@protoc_insertion_point(field_list:tpn.protocol.TItem.gems)
+  return gems_;
+}
+
+// -------------------------------------------------------------------
+
+// TInventoryRequest
+
+// repeated .tpn.protocol.TItem items = 1;
+inline int TInventoryRequest::_internal_items_size() const {
+  return items_.size();
+}
+inline int TInventoryRequest::items_size() const {
+  return _internal_items_size();
+}
+inline void TInventoryRequest::clear_items() {
+  items_.Clear();
+}
+inline ::tpn::protocol::TItem* TInventoryRequest::mutable_items(int index) {
+  // @@protoc_insertion_point(field_mutable:tpn.protocol.TInventoryRequest.items)
+  return items_.Mutable(index);
+}
+inline ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::tpn::protocol::TItem >*
+TInventoryRequest::mutable_items() {
+  // @@protoc_insertion_point(field_mutable_list:tpn.protocol.TInventoryRequest.items)
+  return &items_;
+}
+inline const ::tpn::protocol::TItem& TInventoryRequest::_internal_items(int index) const {
+  return items_.Get(index);
+}
+inline const ::tpn::protocol::TItem& TInventoryRequest::items(int index) const {
+  // @@protoc_insertion_point(field_get:tpn.protocol.TInventoryRequest.items)
+  return _internal_items(index);
+}
+inline ::tpn::protocol::TItem* TInventoryRequest::_internal_add_items() {
+  return items_.Add();
+}
+inline ::tpn::protocol::TItem* TInventoryRequest::add_items() {
+  ::tpn::protocol::TItem* _add = _internal_add_items();
+  // @@protoc_insertion_point(field_add:tpn.protocol.TInventoryRequest.items)
+  return _add;
+}
+inline const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::tpn::protocol::TItem >&
+TInventoryRequest::items() const {
+  // @@protoc_insertion_point(field_list:tpn.protocol.TInventoryRequest.items)
+  return items_;
+}
+
+// -------------------------------------------------------------------
+
+// TInventoryResponse
+
+// repeated .tpn.protocol.TItem items = 1;
+inline int TInventoryResponse::_internal_items_size() const {
+  return items_.size();
+}
+inline int TInventoryResponse::items_size() const {
+  return _internal_items_size();
+}
+inline void TInventoryResponse::clear_items() {
+  items_.Clear();
+}
+inline ::tpn::protocol::TItem* TInventoryResponse::mutable_items(int index) {
+  // @@protoc_insertion_point(field_mutable:tpn.protocol.TInventoryResponse.items)
+  return items_.Mutable(index);
+}
+inline ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::tpn::protocol::TItem >*
+TInventoryResponse::mutable_items() {
+  // @@protoc_insertion_point(field_mutable_list:tpn.protocol.TInventoryResponse.items)
+  return &items_;
+}
+inline const ::tpn::protocol::TItem& TInventoryResponse::_internal_items(int index) const {
+  return items_.Get(index);
+}
+inline const ::tpn::protocol::TItem& TInventoryResponse::items(int index) const {
+  // @@protoc_insertion_point(field_get:tpn.protocol.TInventoryResponse.items)
+  return _internal_items(index);
+}
+inline ::tpn::protocol::TItem* TInventoryResponse::_internal_add_items() {
+  return items_.Add();
+}
+inline ::tpn::protocol::TItem* TInventoryResponse::add_items() {
+  ::tpn::protocol::TItem* _add = _internal_add_items();
+  // @@protoc_insertion_point(field_add:tpn.protocol.TInventoryResponse.items)
+  return _add;
+}
+inline const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::tpn::protocol::TItem >&
+TInventoryResponse::items() const {
+  // @@protoc_insertion_point(field_list:tpn.protocol.TInventoryResponse.items)
+  return items_;
+}
+
 #ifdef __GNUC__
   #pragma GCC diagnostic pop
 #endif  // __GNUC__
@@ -1664,6 +2601,12 @@ TChatNtf::mutable_message_list() {
 
 // -------------------------------------------------------------------
 
+// -------------------------------------------------------------------
+
+// -------------------------------------------------------------------
+
+// -------------------------------------------------------------------
+
 
 // @@protoc_insertion_point(namespace_scope)
 
@@ -0,0 +1,135 @@
+//
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "service_arena.h"
+
+#include <vector>
+
+#include "buffer_pool.h"
+
+namespace tpn {
+
+namespace {
+
+std::atomic<size_t> s_arena_acquires{0};  ///< 获取次数
+std::atomic<size_t> s_arena_creates{0};   ///< 新建arena次数
+
+/// 扩展块从缓冲池申请
+void *AllocateArenaBlock(size_t size) {
+  return BufferPool::AllocateObject(size);
+}
+
+/// 扩展块归还缓冲池
+void DeallocateArenaBlock(void *block, size_t size) {
+  BufferPool::DeallocateObject(block, size);
+}
+
+/// 生成arena参数
+///  @param[in]   initial_block   初始块
+///  @return arena参数
+google::protobuf::ArenaOptions MakeArenaOptions(char *initial_block) {
+  google::protobuf::ArenaOptions options;
+  options.initial_block      = initial_block;
+  options.initial_block_size = kServiceArenaInitialBlockSize;
+  options.block_alloc        = &AllocateArenaBlock;
+  options.block_dealloc      = &DeallocateArenaBlock;
+  return options;
+}
+
+}  // namespace
+
+/// 线程的arena缓存
+struct ServiceArenaCache {
+  ~ServiceArenaCache() {
+    // 还在使用中的arena由最后一次释放删除
+    for (auto *arena : arenas) {
+      if (ServiceArena::kServiceArenaStateIdle ==
+          arena->state_.exchange(ServiceArena::kServiceArenaStateOrphan,
+                                 std::memory_order_acq_rel)) {
+        delete arena;
+      }
+    }
+  }
+
+  std::vector<ServiceArena *> arenas;  ///< 本线程的arena
+};
+
+thread_local ServiceArenaCache t_arena_cache;
+
+ServiceArena *ServiceArena::Acquire() {
+  s_arena_acquires.fetch_add(1, std::memory_order_relaxed);
+
+  ServiceArena *arena = nullptr;
+  for (auto *cached : t_arena_cache.arenas) {
+    // 只有所属线程会把空闲改为使用中
+    if (kServiceArenaStateIdle ==
+        cached->state_.load(std::memory_order_acquire)) {
+      cached->state_.store(kServiceArenaStateBusy, std::memory_order_relaxed);
+      arena = cached;
+      break;
+    }
+  }
+
+  if (nullptr == arena) {
+    s_arena_creates.fetch_add(1, std::memory_order_relaxed);
+    if (t_arena_cache.arenas.size() < kServiceArenaThreadMaxCount) {
+      arena = new ServiceArena(kServiceArenaStateBusy);
+      t_arena_cache.arenas.push_back(arena);
+    } else {
+      // 缓存满了，释放时直接删除
+      arena = new ServiceArena(kServiceArenaStateOrphan);
+    }
+  }
+
+  arena->refs_.store(1, std::memory_order_relaxed);
+  return arena;
+}
+
+ServiceArenaStats ServiceArena::GetStats() {
+  return ServiceArenaStats{s_arena_acquires.load(std::memory_order_relaxed),
+                           s_arena_creates.load(std::memory_order_relaxed)};
+}
+
+void ServiceArena::Release() {
+  if (1 != refs_.fetch_sub(1, std::memory_order_acq_rel)) {
+    return;
+  }
+
+  if (kServiceArenaStateOrphan == state_.load(std::memory_order_acquire)) {
+    delete this;
+    return;
+  }
+
+  arena_.Reset();
+
+  ServiceArenaState expected = kServiceArenaStateBusy;
+  if (!state_.compare_exchange_strong(expected, kServiceArenaStateIdle,
+                                      std::memory_order_acq_rel)) {
+    // 重置期间所属线程退出了
+    delete this;
+  }
+}
+
+ServiceArena::ServiceArena(ServiceArenaState state)
+    : arena_(MakeArenaOptions(initial_block_)), state_(state) {}
+
+}  // namespace tpn
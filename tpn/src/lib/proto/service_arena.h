@@ -0,0 +1,103 @@
+//
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef TYPHOON_ZERO_TPN_SRC_LIB_PROTO_SERVICE_ARENA_H_
+#define TYPHOON_ZERO_TPN_SRC_LIB_PROTO_SERVICE_ARENA_H_
+
+#include <atomic>
+
+#include <google/protobuf/arena.h>
+
+#include "define.h"
+
+namespace tpn {
+
+/// arena初始块大小 8KB
+static constexpr size_t kServiceArenaInitialBlockSize = 8 * 1024;
+/// 每个线程最多缓存的arena数，异步回应未发出时同一线程会占用多个arena
+static constexpr size_t kServiceArenaThreadMaxCount = 16;
+
+/// RPC分发arena统计
+struct ServiceArenaStats {
+  size_t acquires{0};  ///< 获取次数
+  size_t creates{0};   ///< 新建arena次数
+};
+
+/// RPC分发使用的arena
+/// 每个线程缓存若干arena，服务分发时取一个空闲的，请求、回应都在上面创建，
+/// continuation只捕获arena指针。引用归零时整体重置，
+/// 扩展块来自 @see BufferPool ，稳定后不再访问全局堆。
+/// 异步回应时必须恰好调用一次continuation，否则arena不会归还
+class TPN_PROTO_API ServiceArena {
+ public:
+  /// 获取当前线程空闲的arena
+  ///  @return 引用数为1的arena
+  static ServiceArena *Acquire();
+
+  /// 获取统计
+  ///  @return 统计数据
+  static ServiceArenaStats GetStats();
+
+  /// 在arena上创建消息
+  ///  @tparam      T       消息类型
+  ///  @return 消息
+  template <typename T>
+  T *CreateMessage() {
+    return google::protobuf::Arena::CreateMessage<T>(&arena_);
+  }
+
+  /// 获取arena
+  ///  @return arena
+  google::protobuf::Arena *GetArena() { return &arena_; }
+
+  /// 增加引用
+  void AddRef() { refs_.fetch_add(1, std::memory_order_relaxed); }
+
+  /// 释放引用，归零后重置arena，可以在其他线程调用
+  void Release();
+
+ private:
+  friend struct ServiceArenaCache;
+
+  /// arena状态
+  enum ServiceArenaState : uint32_t {
+    kServiceArenaStateIdle = 0,  ///< 空闲
+    kServiceArenaStateBusy,      ///< 使用中
+    kServiceArenaStateOrphan,    ///< 所属线程已退出，释放时删除
+  };
+
+  /// 构造函数
+  ///  @param[in]   state     初始状态
+  explicit ServiceArena(ServiceArenaState state);
+
+  ~ServiceArena() = default;
+
+  /// 初始块，arena的首个内部结构也在其中，需要比arena晚析构
+  alignas(8) char initial_block_[kServiceArenaInitialBlockSize];
+  google::protobuf::Arena arena_;         ///< arena
+  std::atomic<uint32_t> refs_{0};         ///< 引用数
+  std::atomic<ServiceArenaState> state_;  ///< 状态
+};
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_SRC_LIB_PROTO_SERVICE_ARENA_H_
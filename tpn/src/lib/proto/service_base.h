@@ -23,7 +23,9 @@
 #ifndef TYPHOON_ZERO_TPN_SRC_LIB_PROTO_SERVICE_BASE_H_
 #define TYPHOON_ZERO_TPN_SRC_LIB_PROTO_SERVICE_BASE_H_
 
+#include <cstddef>
 #include <string>
+#include <utility>
 #include <functional>
 
 #include "define.h"
@@ -42,6 +44,8 @@ class Message;
 
 namespace tpn {
 
+class ServiceArena;
+
 /// 抽象服务
 class TPN_PROTO_API ServiceBase {
  public:
@@ -94,6 +98,77 @@ class TPN_PROTO_API ServiceBase {
   virtual std::string GetCallerInfo() const = 0;
 };
 
+/// 类型化的回应continuation
+/// 生成代码填入静态回调与调用上下文，构造与调用都不申请内存。
+/// 处理函数返回时continuation仍有效则由分发代码立即回应；
+/// 异步回应时把它移走保存，之后恰好调用一次
+///  @tparam  ResponseType    回应类型
+template <typename ResponseType>
+class ServiceContinuation {
+ public:
+  /// 回调签名
+  using Callback = void (*)(ServiceBase *service, uint32_t token,
+                            uint32_t method_id, ServiceArena *arena,
+                            protocol::ErrorCode status,
+                            const ResponseType *response);
+
+  ServiceContinuation() = default;
+
+  /// 构造函数
+  ///  @param[in]   callback    生成的回应回调
+  ///  @param[in]   token       令牌
+  ///  @param[in]   method_id   对应服务中的方法编号
+  ///  @param[in]   arena       请求所在的arena，非arena模式为空
+  ServiceContinuation(Callback callback, uint32_t token, uint32_t method_id,
+                      ServiceArena *arena) noexcept
+      : callback_(callback),
+        token_(token),
+        method_id_(method_id),
+        arena_(arena) {}
+
+  ServiceContinuation(ServiceContinuation &&other) noexcept
+      : callback_(std::exchange(other.callback_, nullptr)),
+        token_(other.token_),
+        method_id_(other.method_id_),
+        arena_(other.arena_) {}
+
+  ServiceContinuation &operator=(ServiceContinuation &&other) noexcept {
+    callback_  = std::exchange(other.callback_, nullptr);
+    token_     = other.token_;
+    method_id_ = other.method_id_;
+    arena_     = other.arena_;
+    return *this;
+  }
+
+  /// 置空，处理函数已自行回应时使用
+  ServiceContinuation &operator=(std::nullptr_t) noexcept {
+    callback_ = nullptr;
+    return *this;
+  }
+
+  ServiceContinuation(const ServiceContinuation &) = delete;
+  ServiceContinuation &operator=(const ServiceContinuation &) = delete;
+
+  /// 是否还未回应
+  explicit operator bool() const noexcept { return nullptr != callback_; }
+
+  /// 回应，调用后置空
+  ///  @param[in]   service     发送回应的服务
+  ///  @param[in]   status      状态
+  ///  @param[in]   response    回应数据
+  void operator()(ServiceBase *service, protocol::ErrorCode status,
+                  const ResponseType *response) {
+    std::exchange(callback_, nullptr)(service, token_, method_id_, arena_,
+                                      status, response);
+  }
+
+ private:
+  Callback callback_{nullptr};    ///< 回应回调
+  uint32_t token_{0};             ///< 令牌
+  uint32_t method_id_{0};         ///< 方法编号
+  ServiceArena *arena_{nullptr};  ///< 请求所在的arena
+};
+
 }  // namespace tpn
 
 #endif  // TYPHOON_ZERO_TPN_SRC_LIB_PROTO_SERVICE_BASE_H_
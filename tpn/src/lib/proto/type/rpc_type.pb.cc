@@ -49,7 +49,9 @@ constexpr Header::Header(
   , token_(0u)
   , size_(0u)
   , status_(0)
-{}
+
+  , flags_(0u)
+  , raw_size_(0u){}
 struct HeaderDefaultTypeInternal {
   constexpr HeaderDefaultTypeInternal()
     : _instance(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized{}) {}
@@ -88,6 +90,8 @@ const ::PROTOBUF_NAMESPACE_ID::uint32 TableStruct_type_2frpc_5ftype_2eproto::off
   PROTOBUF_FIELD_OFFSET(::tpn::protocol::Header, token_),
   PROTOBUF_FIELD_OFFSET(::tpn::protocol::Header, size_),
   PROTOBUF_FIELD_OFFSET(::tpn::protocol::Header, status_),
+  PROTOBUF_FIELD_OFFSET(::tpn::protocol::Header, flags_),
+  PROTOBUF_FIELD_OFFSET(::tpn::protocol::Header, raw_size_),
 };
 static const ::PROTOBUF_NAMESPACE_ID::internal::MigrationSchema schemas[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
   { 0, -1, sizeof(::tpn::protocol::NoResponse)},
@@ -105,11 +109,12 @@ const char descriptor_table_protodef_type_2frpc_5ftype_2eproto[] PROTOBUF_SECTIO
   "\n\023type/rpc_type.proto\022\014tpn.protocol\032#pgt"
   "_custom/pgt_custom_options.proto\032\020error_"
   "code.proto\"\014\n\nNoResponse\")\n\007Address\022\020\n\010a"
-  "dd_ress\030\001 \001(\t\022\014\n\004port\030\002 \001(\r\"w\n\006Header\022\024\n"
-  "\014service_hash\030\001 \001(\007\022\021\n\tmethod_id\030\002 \001(\r\022\r"
-  "\n\005token\030\003 \001(\r\022\014\n\004size\030\004 \001(\r\022\'\n\006status\030\005 "
-  "\001(\0162\027.tpn.protocol.ErrorCodeB\005H\001\200\001\000P\000P\001b"
-  "\006proto3"
+  "dd_ress\030\001 \001(\t\022\014\n\004port\030\002 \001(\r\"\230\001\n\006Header\022\024"
+  "\n\014service_hash\030\001 \001(\007\022\021\n\tmethod_id\030\002 \001(\r\022"
+  "\r\n\005token\030\003 \001(\r\022\014\n\004size\030\004 \001(\r\022\'\n\006status\030\005"
+  " \001(\0162\027.tpn.protocol.ErrorCode\022\r\n\005flags\030\006"
+  " \001(\r\022\020\n\010raw_size\030\007 \001(\rB\005H\001\200\001\000P\000P\001b\006proto"
+  "3"
   ;
 static const ::PROTOBUF_NAMESPACE_ID::internal::DescriptorTable*const descriptor_table_type_2frpc_5ftype_2eproto_deps[2] = {
   &::descriptor_table_error_5fcode_2eproto,
@@ -117,7 +122,7 @@ static const ::PROTOBUF_NAMESPACE_ID::internal::DescriptorTable*const descriptor
 };
 static ::PROTOBUF_NAMESPACE_ID::internal::once_flag descriptor_table_type_2frpc_5ftype_2eproto_once;
 const ::PROTOBUF_NAMESPACE_ID::internal::DescriptorTable descriptor_table_type_2frpc_5ftype_2eproto = {
-  false, false, 287, descriptor_table_protodef_type_2frpc_5ftype_2eproto, "type/rpc_type.proto", 
+  false, false, 321, descriptor_table_protodef_type_2frpc_5ftype_2eproto, "type/rpc_type.proto", 
   &descriptor_table_type_2frpc_5ftype_2eproto_once, descriptor_table_type_2frpc_5ftype_2eproto_deps, 2, 3,
   schemas, file_default_instances, TableStruct_type_2frpc_5ftype_2eproto::offsets,
   file_level_metadata_type_2frpc_5ftype_2eproto, file_level_enum_descriptors_type_2frpc_5ftype_2eproto, file_level_service_descriptors_type_2frpc_5ftype_2eproto,
@@ -530,16 +535,16 @@ Header::Header(const Header& from)
   : ::PROTOBUF_NAMESPACE_ID::Message() {
   _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
   ::memcpy(&service_hash_, &from.service_hash_,
-    static_cast<size_t>(reinterpret_cast<char*>(&status_) -
-    reinterpret_cast<char*>(&service_hash_)) + sizeof(status_));
+    static_cast<size_t>(reinterpret_cast<char*>(&raw_size_) -
+    reinterpret_cast<char*>(&service_hash_)) + sizeof(raw_size_));
   // @@protoc_insertion_point(copy_constructor:tpn.protocol.Header)
 }
 
 inline void Header::SharedCtor() {
 ::memset(reinterpret_cast<char*>(this) + static_cast<size_t>(
     reinterpret_cast<char*>(&service_hash_) - reinterpret_cast<char*>(this)),
-    0, static_cast<size_t>(reinterpret_cast<char*>(&status_) -
-    reinterpret_cast<char*>(&service_hash_)) + sizeof(status_));
+    0, static_cast<size_t>(reinterpret_cast<char*>(&raw_size_) -
+    reinterpret_cast<char*>(&service_hash_)) + sizeof(raw_size_));
 }
 
 Header::~Header() {
@@ -570,8 +575,8 @@ void Header::Clear() {
   (void) cached_has_bits;
 
   ::memset(&service_hash_, 0, static_cast<size_t>(
-      reinterpret_cast<char*>(&status_) -
-      reinterpret_cast<char*>(&service_hash_)) + sizeof(status_));
+      reinterpret_cast<char*>(&raw_size_) -
+      reinterpret_cast<char*>(&service_hash_)) + sizeof(raw_size_));
   _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
 }
 
@@ -617,6 +622,20 @@ const char* Header::_InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::int
           _internal_set_status(static_cast<::tpn::protocol::ErrorCode>(val));
         } else goto handle_unusual;
         continue;
+      // uint32 flags = 6;
+      case 6:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 48)) {
+          flags_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+          CHK_(ptr);
+        } else goto handle_unusual;
+        continue;
+      // uint32 raw_size = 7;
+      case 7:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 56)) {
+          raw_size_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+          CHK_(ptr);
+        } else goto handle_unusual;
+        continue;
       default: {
       handle_unusual:
         if ((tag == 0) || ((tag & 7) == 4)) {
@@ -677,6 +696,18 @@ failure:
       5, this->_internal_status(), target);
   }
 
+  // uint32 flags = 6;
+  if (this->_internal_flags() != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteUInt32ToArray(6, this->_internal_flags(), target);
+  }
+
+  // uint32 raw_size = 7;
+  if (this->_internal_raw_size() != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteUInt32ToArray(7, this->_internal_raw_size(), target);
+  }
+
   if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
     target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormat::InternalSerializeUnknownFieldsToArray(
         _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
@@ -725,6 +756,20 @@ size_t Header::ByteSizeLong() const {
       ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::EnumSize(this->_internal_status());
   }
 
+  // uint32 flags = 6;
+  if (this->_internal_flags() != 0) {
+    total_size += 1 +
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::UInt32Size(
+        this->_internal_flags());
+  }
+
+  // uint32 raw_size = 7;
+  if (this->_internal_raw_size() != 0) {
+    total_size += 1 +
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::UInt32Size(
+        this->_internal_raw_size());
+  }
+
   if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
     return ::PROTOBUF_NAMESPACE_ID::internal::ComputeUnknownFieldsSize(
         _internal_metadata_, total_size, &_cached_size_);
@@ -768,6 +813,12 @@ void Header::MergeFrom(const Header& from) {
   if (from._internal_status() != 0) {
     _internal_set_status(from._internal_status());
   }
+  if (from._internal_flags() != 0) {
+    _internal_set_flags(from._internal_flags());
+  }
+  if (from._internal_raw_size() != 0) {
+    _internal_set_raw_size(from._internal_raw_size());
+  }
   _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
 }
 
@@ -786,8 +837,8 @@ void Header::InternalSwap(Header* other) {
   using std::swap;
   _internal_metadata_.InternalSwap(&other->_internal_metadata_);
   ::PROTOBUF_NAMESPACE_ID::internal::memswap<
-      PROTOBUF_FIELD_OFFSET(Header, status_)
-      + sizeof(Header::status_)
+      PROTOBUF_FIELD_OFFSET(Header, raw_size_)
+      + sizeof(Header::raw_size_)
       - PROTOBUF_FIELD_OFFSET(Header, service_hash_)>(
           reinterpret_cast<char*>(&service_hash_),
           reinterpret_cast<char*>(&other->service_hash_));
@@ -480,6 +480,8 @@ class Header final :
     kTokenFieldNumber = 3,
     kSizeFieldNumber = 4,
     kStatusFieldNumber = 5,
+    kFlagsFieldNumber = 6,
+    kRawSizeFieldNumber = 7,
   };
   // fixed32 service_hash = 1;
   void clear_service_hash();
@@ -526,6 +528,24 @@ class Header final :
   void _internal_set_status(::tpn::protocol::ErrorCode value);
   public:
 
+  // uint32 flags = 6;
+  void clear_flags();
+  ::PROTOBUF_NAMESPACE_ID::uint32 flags() const;
+  void set_flags(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  private:
+  ::PROTOBUF_NAMESPACE_ID::uint32 _internal_flags() const;
+  void _internal_set_flags(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  public:
+
+  // uint32 raw_size = 7;
+  void clear_raw_size();
+  ::PROTOBUF_NAMESPACE_ID::uint32 raw_size() const;
+  void set_raw_size(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  private:
+  ::PROTOBUF_NAMESPACE_ID::uint32 _internal_raw_size() const;
+  void _internal_set_raw_size(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  public:
+
   // @@protoc_insertion_point(class_scope:tpn.protocol.Header)
  private:
   class _Internal;
@@ -538,6 +558,8 @@ class Header final :
   ::PROTOBUF_NAMESPACE_ID::uint32 token_;
   ::PROTOBUF_NAMESPACE_ID::uint32 size_;
   int status_;
+  ::PROTOBUF_NAMESPACE_ID::uint32 flags_;
+  ::PROTOBUF_NAMESPACE_ID::uint32 raw_size_;
   mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
   friend struct ::TableStruct_type_2frpc_5ftype_2eproto;
 };
@@ -726,6 +748,46 @@ inline void Header::set_status(::tpn::protocol::ErrorCode value) {
   // @@protoc_insertion_point(field_set:tpn.protocol.Header.status)
 }
 
+// uint32 flags = 6;
+inline void Header::clear_flags() {
+  flags_ = 0u;
+}
+inline ::PROTOBUF_NAMESPACE_ID::uint32 Header::_internal_flags() const {
+  return flags_;
+}
+inline ::PROTOBUF_NAMESPACE_ID::uint32 Header::flags() const {
+  // @@protoc_insertion_point(field_get:tpn.protocol.Header.flags)
+  return _internal_flags();
+}
+inline void Header::_internal_set_flags(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+  
+  flags_ = value;
+}
+inline void Header::set_flags(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+  _internal_set_flags(value);
+  // @@protoc_insertion_point(field_set:tpn.protocol.Header.flags)
+}
+
+// uint32 raw_size = 7;
+inline void Header::clear_raw_size() {
+  raw_size_ = 0u;
+}
+inline ::PROTOBUF_NAMESPACE_ID::uint32 Header::_internal_raw_size() const {
+  return raw_size_;
+}
+inline ::PROTOBUF_NAMESPACE_ID::uint32 Header::raw_size() const {
+  // @@protoc_insertion_point(field_get:tpn.protocol.Header.raw_size)
+  return _internal_raw_size();
+}
+inline void Header::_internal_set_raw_size(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+  
+  raw_size_ = value;
+}
+inline void Header::set_raw_size(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+  _internal_set_raw_size(value);
+  // @@protoc_insertion_point(field_set:tpn.protocol.Header.raw_size)
+}
+
 #ifdef __GNUC__
   #pragma GCC diagnostic pop
 #endif  // __GNUC__
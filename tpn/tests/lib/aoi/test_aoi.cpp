@@ -22,9 +22,14 @@
 
 #include "../../test_include.h"
 
+#include <chrono>
+#include <cmath>
+#include <random>
+
 #include "log.h"
 #include "aoi.h"
 #include "aoi_node.h"
+#include "aoi_snapshot.h"
 #include "config.h"
 
 #ifndef _TPN_AOI_CONFIG_TEST_FILE
@@ -53,10 +58,9 @@ class AOINode1 : public tpn::aoi::AOINode {
 };
 
 TEST_CASE("data1", "data") {
-  std::string config_error;
-  if (!g_config->Load(_TPN_AOI_CONFIG_TEST_FILE, {}, config_error)) {
+  if (auto error = g_config->Load(_TPN_AOI_CONFIG_TEST_FILE, {})) {
     fmt::print(stderr, "Error in config file {}, error {}\n",
-               _TPN_AOI_CONFIG_TEST_FILE, config_error);
+               _TPN_AOI_CONFIG_TEST_FILE, *error);
     return;
   }
 
@@ -84,3 +88,199 @@ TEST_CASE("data1", "data") {
 
   std::this_thread::sleep_for(3s);
 }
+
+TEST_CASE("aoi_snapshot_delta", "[aoi]") {
+  using namespace tpn;
+  using namespace tpn::aoi;
+
+  constexpr size_t kEntityCount   = 200;
+  constexpr uint32_t kTickCount   = 200;
+  constexpr uint32_t kTickRate    = 20;
+  constexpr float kWorldSize      = 80.f;
+  constexpr float kViewRadius     = 30.f;
+  constexpr float kMoveStep       = 5.f / kTickRate;
+  constexpr size_t kFullWatchers  = 20;
+  constexpr uint32_t kResetTick   = 100;
+  constexpr uint32_t kNaiveRecord = 8 + 12 + 12 + 8;
+
+  struct Actor {
+    uint64_t guid{0};
+    Position3D pos;
+    Direction3D dir;
+    uint32_t state{0};
+    uint32_t hp{0};
+    bool moving{false};
+  };
+
+  // 200个玩家挤在80x80的区域，视野半径30
+  std::mt19937 rng(20211024);
+  std::uniform_real_distribution<float> unit(0.f, 1.f);
+  std::vector<Actor> actors(kEntityCount);
+  for (size_t i = 0; i < kEntityCount; ++i) {
+    actors[i].guid = (uint64_t(1) << 48) | (i * 37 + 1000);
+    actors[i].pos  = Position3D(unit(rng) * kWorldSize, 0.f,
+                                unit(rng) * kWorldSize);
+    actors[i].dir.SetYaw(unit(rng) * 6.2831853f);
+    actors[i].hp = 1000;
+  }
+
+  SnapshotFrame frame;
+  SnapshotEncoder encoder;
+  std::vector<SnapshotWatcher> watchers(kEntityCount);
+  std::vector<SnapshotDecoder> decoders(kEntityCount);
+  std::vector<ByteBuffer> buffers(kEntityCount);
+  // 从不确认的观察者，每帧都是全量同步
+  std::vector<SnapshotWatcher> full_watchers(kFullWatchers);
+  std::vector<ByteBuffer> full_buffers(kFullWatchers);
+  // 确认延迟2到5帧，每个元素为 <到达帧, 确认帧>
+  std::vector<std::vector<std::pair<uint32_t, uint32_t>>> acks(kEntityCount);
+
+  size_t delta_bytes   = 0;
+  size_t full_bytes    = 0;
+  size_t naive_bytes   = 0;
+  size_t visible_count = 0;
+  size_t full_frames   = 0;
+  std::chrono::nanoseconds encode_cost{0};
+  std::vector<EntitySnapshot> expected;
+
+  for (uint32_t tick = 1; tick <= kTickCount; ++tick) {
+    // 七成玩家移动，偶尔转向、掉血和切换状态
+    for (auto &actor : actors) {
+      if (unit(rng) < 0.1f) {
+        actor.moving = unit(rng) < 0.7f;
+      }
+      if (actor.moving) {
+        if (unit(rng) < 0.1f) {
+          actor.dir.SetYaw(actor.dir.GetYaw() + (unit(rng) - 0.5f));
+        }
+        float yaw = actor.dir.GetYaw();
+        actor.pos.x += std::cos(yaw) * kMoveStep;
+        actor.pos.z += std::sin(yaw) * kMoveStep;
+        if (actor.pos.x < 0.f || actor.pos.x > kWorldSize ||
+            actor.pos.z < 0.f || actor.pos.z > kWorldSize) {
+          actor.pos.x = std::clamp(actor.pos.x, 0.f, kWorldSize);
+          actor.pos.z = std::clamp(actor.pos.z, 0.f, kWorldSize);
+          actor.dir.SetYaw(yaw + 3.1415926f);
+        }
+      }
+      if (unit(rng) < 0.05f) {
+        actor.hp -= 10;
+      }
+      if (unit(rng) < 0.01f) {
+        actor.state ^= 0x4;
+      }
+    }
+
+    frame.Reset(tick);
+    for (const auto &actor : actors) {
+      frame.Add(actor.guid, actor.pos, actor.dir, actor.state, actor.hp);
+    }
+    for (size_t i = 0; i < kEntityCount; ++i) {
+      watchers[i].ClearVisible();
+      for (size_t j = 0; j < kEntityCount; ++j) {
+        if ((actors[j].pos - actors[i].pos).length() <= kViewRadius) {
+          watchers[i].AddVisible(uint32_t(j));
+        }
+      }
+      visible_count += watchers[i].GetVisible().size();
+      naive_bytes += watchers[i].GetVisible().size() * kNaiveRecord;
+    }
+    for (size_t i = 0; i < kFullWatchers; ++i) {
+      full_watchers[i].ClearVisible();
+      for (uint32_t index : watchers[i].GetVisible()) {
+        full_watchers[i].AddVisible(index);
+      }
+    }
+
+    // 客户端重连，之后必须退回全量同步
+    if (kResetTick == tick) {
+      watchers[0].Reset();
+      decoders[0] = SnapshotDecoder();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    encoder.EncodeBatch(frame, watchers.data(), buffers.data(), kEntityCount);
+    encode_cost += std::chrono::steady_clock::now() - start;
+    encoder.EncodeBatch(frame, full_watchers.data(), full_buffers.data(),
+                        kFullWatchers);
+
+    for (size_t i = 0; i < kFullWatchers; ++i) {
+      full_bytes += full_buffers[i].GetSize();
+      full_buffers[i].Clear();
+    }
+
+    for (size_t i = 0; i < kEntityCount; ++i) {
+      ByteBuffer &buffer = buffers[i];
+      delta_bytes += buffer.GetSize();
+      if (kSnapshotNoBaseline == buffer.Read<uint32_t>(sizeof(uint32_t))) {
+        ++full_frames;
+      }
+
+      // 丢失5%的帧，客户端不会确认丢失的帧
+      if (unit(rng) >= 0.05f) {
+        REQUIRE(decoders[i].Decode(buffer));
+        REQUIRE(buffer.GetReadPos() == buffer.GetSize());
+
+        expected.clear();
+        for (uint32_t index : watchers[i].GetVisible()) {
+          expected.emplace_back(frame.GetEntities()[index]);
+        }
+        std::sort(expected.begin(), expected.end(),
+                  [](const auto &left, const auto &right) {
+                    return left.guid < right.guid;
+                  });
+        REQUIRE(decoders[i].GetView().tick == tick);
+        REQUIRE(decoders[i].GetView().entities == expected);
+
+        if (unit(rng) >= 0.05f) {
+          acks[i].emplace_back(tick + 2 + uint32_t(i % 4), tick);
+        }
+      }
+      buffer.Clear();
+
+      auto &pending = acks[i];
+      for (auto iter = pending.begin(); iter != pending.end();) {
+        if (iter->first <= tick) {
+          watchers[i].Ack(iter->second);
+          iter = pending.erase(iter);
+        } else {
+          ++iter;
+        }
+      }
+    }
+  }
+
+  // 量化误差不超过半个精度单位
+  for (const auto &snapshot : frame.GetEntities()) {
+    const Actor &actor = actors[(snapshot.guid & 0xFFFFFF) / 37 - 27];
+    REQUIRE(actor.guid == snapshot.guid);
+    REQUIRE(std::abs(snapshot.GetPosition().x - actor.pos.x) <=
+            0.5f / kSnapshotPositionScale + 1e-4f);
+    REQUIRE(std::abs(snapshot.GetPosition().z - actor.pos.z) <=
+            0.5f / kSnapshotPositionScale + 1e-4f);
+  }
+
+  // 收到首个确认之前和重连之后退回全量同步
+  REQUIRE(full_frames >= kEntityCount + 1);
+
+  double frames       = double(kEntityCount) * kTickCount;
+  double delta_tick   = delta_bytes / frames;
+  double full_tick    = full_bytes / (double(kFullWatchers) * kTickCount);
+  double naive_tick   = naive_bytes / frames;
+  double visible_tick = visible_count / frames;
+  REQUIRE(delta_tick * 3 < full_tick * 2);
+  REQUIRE(delta_tick * 4 < naive_tick);
+
+  fmt::print(
+      "aoi snapshot {} players {} ticks, visible {:.1f} per player\n"
+      "  naive  {:.0f} B/tick {:.1f} kbps\n"
+      "  full   {:.0f} B/tick {:.1f} kbps\n"
+      "  delta  {:.0f} B/tick {:.1f} kbps, full frames {}\n"
+      "  encode {:.2f} us per tick for all players\n",
+      kEntityCount, kTickCount, visible_tick, naive_tick,
+      naive_tick * kTickRate * 8 / 1000, full_tick,
+      full_tick * kTickRate * 8 / 1000, delta_tick,
+      delta_tick * kTickRate * 8 / 1000, full_frames,
+      std::chrono::duration<double, std::micro>(encode_cost).count() /
+          kTickCount);
+}
@@ -658,3 +658,439 @@ TEST_CASE("linked_list", "[common]") {
 
   ;
 }
+
+// coarse_clock
+#include "coarse_clock.h"
+#include "platform.h"
+
+TEST_CASE("coarse_clock", "[common]") {
+  constexpr int32_t kLoopCount = 10000000;
+  g_coarse_clock->Enable(CoarseClockUser::kCoarseClockUserNet);
+
+  auto now = SystemClock::now();
+  auto coarse_now = g_coarse_clock->SystemNow(CoarseClockUser::kCoarseClockUserNet);
+  REQUIRE(std::chrono::abs(now - coarse_now) < MilliSeconds(50));
+
+  // 未开启的子系统仍然拿到真实时间
+  REQUIRE_FALSE(g_coarse_clock->IsEnabled(CoarseClockUser::kCoarseClockUserLog));
+
+  int64_t sum = 0;
+  auto start = SteadyClock::now();
+  for (int32_t i = 0; i < kLoopCount; ++i) {
+    sum += SystemClock::now().time_since_epoch().count();
+  }
+  auto system_cost = SteadyClock::now() - start;
+
+  start = SteadyClock::now();
+  for (int32_t i = 0; i < kLoopCount; ++i) {
+    sum += g_coarse_clock->SystemNow(CoarseClockUser::kCoarseClockUserNet)
+               .time_since_epoch()
+               .count();
+  }
+  auto coarse_cost = SteadyClock::now() - start;
+
+  fmt::print("coarse_clock {} calls system {}ms coarse {}ms ({})\n", kLoopCount,
+             std::chrono::duration_cast<MilliSeconds>(system_cost).count(),
+             std::chrono::duration_cast<MilliSeconds>(coarse_cost).count(),
+             sum != 0);
+
+  char datetime[kCoarseDateTimeSize];
+  now = g_coarse_clock->SystemNow(CoarseClockUser::kCoarseClockUserNet);
+  if (g_coarse_clock->CopyDateTime(now, false, datetime)) {
+    REQUIRE(std::string_view(datetime, kCoarseDateTimeSize) ==
+            fmt::format("{:%Y-%m-%d %H:%M:%S}",
+                        Localtime(SystemClock::to_time_t(now))));
+  }
+  if (g_coarse_clock->CopyDateTime(now, true, datetime)) {
+    REQUIRE(std::string_view(datetime, kCoarseDateTimeSize) ==
+            fmt::format("{:%Y-%m-%d %H:%M:%S}",
+                        GmTime(SystemClock::to_time_t(now))));
+  }
+
+  g_coarse_clock->Disable(CoarseClockUser::kCoarseClockUserNet);
+  REQUIRE_FALSE(g_coarse_clock->IsEnabled(CoarseClockUser::kCoarseClockUserNet));
+}
+
+// message_buffer
+#include <thread>
+
+#include "message_buffer.h"
+
+TEST_CASE("message_buffer", "[common]") {
+  constexpr int32_t kLoopCount = 100000;
+
+  // 预热后同尺寸的申请释放全部命中线程缓存
+  { MessageBuffer warm(1000); }
+  auto stats = BufferPool::GetStats();
+  for (int32_t i = 0; i < kLoopCount; ++i) {
+    MessageBuffer buffer(1000);
+    buffer.Write(&i, sizeof(i));
+    REQUIRE(buffer.GetCapacity() == 1024);
+  }
+  REQUIRE(BufferPool::GetStats().heap_allocations == stats.heap_allocations);
+
+  // 扩容保留已写数据
+  MessageBuffer buffer(16);
+  for (int32_t i = 0; i < 1000; ++i) {
+    buffer.EnsureFreeSpace();
+    if (buffer.GetRemainingSpace() < sizeof(i)) {
+      buffer.Resize(buffer.GetBufferSize() + sizeof(i));
+    }
+    buffer.Write(&i, sizeof(i));
+  }
+  REQUIRE(buffer.GetActiveSize() == 1000 * sizeof(int32_t));
+  for (int32_t i = 0; i < 1000; ++i) {
+    int32_t value = 0;
+    memcpy(&value, buffer.GetReadPointer(), sizeof(value));
+    REQUIRE(value == i);
+    buffer.ReadCompleted(sizeof(value));
+  }
+
+  // 移动后原缓冲为空
+  MessageBuffer moved(std::move(buffer));
+  REQUIRE(buffer.GetBufferSize() == 0);
+  REQUIRE(buffer.GetCapacity() == 0);
+  REQUIRE(moved.GetBufferSize() >= 1000 * sizeof(int32_t));
+
+  // 共享缓冲引用计数
+  MessageBuffer payload(64);
+  payload.Write("typhoon", 7);
+  auto shared = MakeSharedMessageBuffer(std::move(payload));
+  REQUIRE(shared.GetUseCount() == 1);
+  {
+    SharedMessageBuffer copy = shared;
+    REQUIRE(shared.GetUseCount() == 2);
+    REQUIRE(copy->GetActiveSize() == 7);
+    REQUIRE(0 == memcmp(copy->GetBasePointer(), "typhoon", 7));
+  }
+  REQUIRE(shared.GetUseCount() == 1);
+  SharedMessageBuffer other(std::move(shared));
+  REQUIRE_FALSE(shared);
+  REQUIRE(other.GetUseCount() == 1);
+
+  // 逻辑线程释放io线程申请的缓冲，经中心空闲链表回到申请线程
+  constexpr int32_t kBatchCount = 1000;
+  std::vector<MessageBuffer> batch;
+  for (int32_t round = 0; round < 10; ++round) {
+    for (int32_t i = 0; i < kBatchCount; ++i) {
+      batch.emplace_back(256);
+    }
+    std::thread([moved_batch = std::move(batch)]() mutable {
+      moved_batch.clear();
+    }).join();
+    batch.clear();
+  }
+  stats = BufferPool::GetStats();
+  for (int32_t i = 0; i < kBatchCount; ++i) {
+    batch.emplace_back(256);
+  }
+  REQUIRE(BufferPool::GetStats().heap_allocations == stats.heap_allocations);
+  REQUIRE(BufferPool::GetStats().central_transfers > 0);
+
+  // 只申请不归还的线程退出时，从中心空闲链表取回的其余块也要交回
+  constexpr int32_t kIdleCount = 32;
+  std::vector<MessageBuffer> idle;
+  for (int32_t i = 0; i < kIdleCount; ++i) {
+    idle.emplace_back(8192);
+  }
+  std::thread([moved_idle = std::move(idle)]() mutable {
+    moved_idle.clear();
+  }).join();
+  idle.clear();
+  std::thread([&idle]() { idle.emplace_back(8192); }).join();
+  stats = BufferPool::GetStats();
+  for (int32_t i = 1; i < kIdleCount; ++i) {
+    idle.emplace_back(8192);
+  }
+  REQUIRE(BufferPool::GetStats().heap_allocations == stats.heap_allocations);
+}
+
+// byte_buffer
+TEST_CASE("byte_buffer_bench", "[common]") {
+  constexpr int32_t kLoopCount   = 200000;
+  constexpr int32_t kEntityCount = 32;
+
+  // 实体移动快照：打包的guid + 打包的坐标 + 朝向 + 时间
+  struct Movement {
+    uint64_t guid;
+    float x, y, z;
+    float orientation;
+    uint32_t time;
+  };
+  std::vector<Movement> movements;
+  for (int32_t i = 0; i < kEntityCount; ++i) {
+    movements.push_back({0x1F00000000000000ull | (uint64_t(i) * 7919),
+                         float(i * 4), float(i * 8), float(i),
+                         float(i) / kEntityCount, uint32_t(i * 100)});
+  }
+  constexpr size_t kMovementMaxSize = ByteBuffer::kPackedUInt64MaxSize +
+                                      ByteBuffer::kPackedXYZSize +
+                                      sizeof(float) + sizeof(uint32_t);
+
+  size_t sum  = 0;
+  auto start  = SteadyClock::now();
+  for (int32_t loop = 0; loop < kLoopCount; ++loop) {
+    ByteBuffer buffer;
+    for (auto &movement : movements) {
+      buffer.AppendPackedUInt64(movement.guid);
+      buffer.AppendPackXYZ(movement.x, movement.y, movement.z);
+      buffer << movement.orientation;
+      buffer << movement.time;
+    }
+    sum += buffer.GetSize();
+  }
+  auto append_cost = SteadyClock::now() - start;
+
+  start = SteadyClock::now();
+  for (int32_t loop = 0; loop < kLoopCount; ++loop) {
+    ByteBuffer buffer;
+    auto writer = buffer.BeginWrite(kMovementMaxSize * movements.size());
+    for (auto &movement : movements) {
+      writer.WritePackedUInt64(movement.guid);
+      writer.WritePackXYZ(movement.x, movement.y, movement.z);
+      writer.Write(movement.orientation);
+      writer.Write(movement.time);
+    }
+    buffer.EndWrite(writer);
+    sum += buffer.GetSize();
+  }
+  auto writer_cost = SteadyClock::now() - start;
+
+  // 两种写法结果一致
+  ByteBuffer append_buffer;
+  ByteBuffer writer_buffer;
+  auto writer = writer_buffer.BeginWrite(kMovementMaxSize * movements.size());
+  for (auto &movement : movements) {
+    append_buffer.AppendPackedUInt64(movement.guid);
+    append_buffer.AppendPackXYZ(movement.x, movement.y, movement.z);
+    append_buffer << movement.orientation << movement.time;
+    writer.WritePackedUInt64(movement.guid);
+    writer.WritePackXYZ(movement.x, movement.y, movement.z);
+    writer.Write(movement.orientation);
+    writer.Write(movement.time);
+  }
+  writer_buffer.EndWrite(writer);
+  REQUIRE(append_buffer.GetSize() == writer_buffer.GetSize());
+  REQUIRE(0 == memcmp(append_buffer.GetContents(), writer_buffer.GetContents(),
+                      append_buffer.GetSize()));
+  // 小快照不离开内联存储
+  ByteBuffer small_buffer;
+  for (int32_t i = 0; i < 8; ++i) {
+    small_buffer.AppendPackedUInt64(movements[i].guid);
+    small_buffer.AppendPackXYZ(movements[i].x, movements[i].y, movements[i].z);
+  }
+  REQUIRE(small_buffer.GetCapacity() == ByteBuffer::kByteBufferInlineSize);
+
+  start = SteadyClock::now();
+  for (int32_t loop = 0; loop < kLoopCount; ++loop) {
+    append_buffer.SetReadPos(0);
+    for (int32_t i = 0; i < kEntityCount; ++i) {
+      uint64_t guid = 0;
+      append_buffer.ReadPackedUInt64(guid);
+      sum += guid + append_buffer.Read<uint32_t>();
+      sum += size_t(append_buffer.Read<float>());
+      sum += append_buffer.Read<uint32_t>();
+    }
+  }
+  auto read_cost = SteadyClock::now() - start;
+
+  start = SteadyClock::now();
+  for (int32_t loop = 0; loop < kLoopCount; ++loop) {
+    writer_buffer.SetReadPos(0);
+    for (int32_t i = 0; i < kEntityCount; ++i) {
+      uint64_t guid = 0;
+      writer_buffer.ReadPackedUInt64(guid);
+      auto reader = writer_buffer.BeginRead(ByteBuffer::kPackedXYZSize +
+                                            sizeof(float) + sizeof(uint32_t));
+      sum += guid + reader.Read<uint32_t>();
+      sum += size_t(reader.Read<float>());
+      sum += reader.Read<uint32_t>();
+      writer_buffer.EndRead(reader);
+    }
+  }
+  auto reader_cost = SteadyClock::now() - start;
+
+  // 读游标按结构体检查一次边界
+  writer_buffer.SetReadPos(0);
+  for (auto &movement : movements) {
+    auto reader = writer_buffer.BeginRead(
+        (std::min)(kMovementMaxSize,
+                   writer_buffer.GetSize() - writer_buffer.GetReadPos()));
+    REQUIRE(reader.ReadPackedUInt64() == movement.guid);
+    REQUIRE(reader.Read<uint32_t>() ==
+            ByteBuffer::PackXYZ(movement.x, movement.y, movement.z));
+    REQUIRE(reader.Read<float>() == movement.orientation);
+    REQUIRE(reader.Read<uint32_t>() == movement.time);
+    writer_buffer.EndRead(reader);
+  }
+  REQUIRE(writer_buffer.GetReadPos() == writer_buffer.GetSize());
+  REQUIRE_THROWS_AS(writer_buffer.BeginRead(1), ByteBufferException);
+
+  // 超出内联存储后从缓冲池扩容，内容保留
+  ByteBuffer large;
+  for (int32_t i = 0; i < 1000; ++i) {
+    large << uint32_t(i);
+  }
+  REQUIRE(large.GetCapacity() > ByteBuffer::kByteBufferInlineSize);
+  ByteBuffer moved(std::move(large));
+  REQUIRE(large.IsEmpty());
+  for (int32_t i = 0; i < 1000; ++i) {
+    REQUIRE(moved.Read<uint32_t>() == uint32_t(i));
+  }
+
+  auto to_ns = [](auto cost) {
+    return double(std::chrono::duration_cast<NanoSeconds>(cost).count()) /
+           (double(kLoopCount) * kEntityCount);
+  };
+  fmt::print(
+      "byte_buffer {} snapshots x {} entities ns/entity append {:.1f} "
+      "writer {:.1f} read {:.1f} reader {:.1f} ({})\n",
+      kLoopCount, kEntityCount, to_ns(append_cost), to_ns(writer_cost),
+      to_ns(read_cost), to_ns(reader_cost), sum != 0);
+}
+
+TEST_CASE("byte_buffer_codec_bench", "[common]") {
+  constexpr int32_t kLoopCount     = 200;
+  constexpr size_t kPositionCount = 10000;
+  constexpr int32_t kStateBits     = 7;
+
+  // 一万个实体的guid、坐标与状态位
+  std::vector<uint64_t> guids(kPositionCount);
+  std::vector<float> positions(kPositionCount * 3);
+  std::vector<uint32_t> states(kPositionCount);
+  for (size_t i = 0; i < kPositionCount; ++i) {
+    guids[i] = (uint64_t(i % 5) << 56) | (uint64_t(i) * 7919 % 100000);
+    positions[i * 3]     = float(int32_t(i % 2000) - 1000) * 0.2f;
+    positions[i * 3 + 1] = float(int32_t(i * 7 % 2000) - 1000) * 0.25f;
+    positions[i * 3 + 2] = float(int32_t(i * 3 % 1000) - 500) * 0.25f;
+    states[i]            = uint32_t(i * 13) & ((1u << kStateBits) - 1);
+  }
+
+  auto encode_scalar = [&](ByteBuffer &buffer) {
+    for (size_t i = 0; i < kPositionCount; ++i) {
+      buffer.AppendPackedUInt64(guids[i]);
+    }
+    for (size_t i = 0; i < kPositionCount; ++i) {
+      buffer.AppendPackXYZ(positions[i * 3], positions[i * 3 + 1],
+                           positions[i * 3 + 2]);
+    }
+    for (size_t i = 0; i < kPositionCount; ++i) {
+      buffer.WriteBits(states[i], kStateBits);
+    }
+    buffer.FlushBits();
+  };
+  auto encode_batch = [&](ByteBuffer &buffer) {
+    buffer.AppendPackedUInt64(guids.data(), kPositionCount);
+    buffer.AppendPackXYZ(positions.data(), kPositionCount);
+    buffer.WriteBits(states.data(), kPositionCount, kStateBits);
+    buffer.FlushBits();
+  };
+
+  // 批量编码与逐个编码字节一致
+  ByteBuffer scalar_buffer;
+  ByteBuffer batch_buffer;
+  encode_scalar(scalar_buffer);
+  encode_batch(batch_buffer);
+  REQUIRE(scalar_buffer.GetSize() == batch_buffer.GetSize());
+  REQUIRE(0 == memcmp(scalar_buffer.GetContents(), batch_buffer.GetContents(),
+                      scalar_buffer.GetSize()));
+
+  // 批量解码还原原值，坐标按0.25量化
+  std::vector<uint64_t> read_guids(kPositionCount);
+  std::vector<float> read_positions(kPositionCount * 3);
+  std::vector<uint32_t> read_states(kPositionCount);
+  batch_buffer.ReadPackedUInt64(read_guids.data(), kPositionCount);
+  batch_buffer.ReadPackXYZ(read_positions.data(), kPositionCount);
+  batch_buffer.ReadBits(read_states.data(), kPositionCount, kStateBits);
+  REQUIRE(read_guids == guids);
+  REQUIRE(read_states == states);
+  for (size_t i = 0; i < kPositionCount * 3; ++i) {
+    REQUIRE(read_positions[i] == float(int32_t(positions[i] * 4.0f)) * 0.25f);
+  }
+  REQUIRE_THROWS_AS(batch_buffer.ReadPackedUInt64(read_guids.data(), 1),
+                    ByteBufferException);
+
+  // 与逐位读写交替使用时位状态保持一致
+  ByteBuffer mixed_scalar;
+  ByteBuffer mixed_batch;
+  mixed_scalar.WriteBits(5, 3);
+  mixed_batch.WriteBits(5, 3);
+  for (size_t i = 0; i < 11; ++i) {
+    mixed_scalar.WriteBits(states[i], kStateBits);
+  }
+  mixed_batch.WriteBits(states.data(), 11, kStateBits);
+  mixed_scalar.WriteBit(true);
+  mixed_batch.WriteBit(true);
+  mixed_scalar.FlushBits();
+  mixed_batch.FlushBits();
+  REQUIRE(mixed_scalar.GetSize() == mixed_batch.GetSize());
+  REQUIRE(0 == memcmp(mixed_scalar.GetContents(), mixed_batch.GetContents(),
+                      mixed_scalar.GetSize()));
+  REQUIRE(mixed_batch.ReadBits(3) == 5);
+  mixed_batch.ReadBits(read_states.data(), 5, kStateBits);
+  for (size_t i = 5; i < 11; ++i) {
+    REQUIRE(mixed_batch.ReadBits(kStateBits) == states[i]);
+  }
+  REQUIRE(mixed_batch.ReadBit());
+  REQUIRE(std::equal(read_states.begin(), read_states.begin() + 5,
+                     states.begin()));
+
+  size_t sum = 0;
+  auto start = SteadyClock::now();
+  for (int32_t loop = 0; loop < kLoopCount; ++loop) {
+    ByteBuffer buffer(kPositionCount * 16, ByteBuffer::ReserveFlag{});
+    encode_scalar(buffer);
+    sum += buffer.GetSize();
+  }
+  auto scalar_encode_cost = SteadyClock::now() - start;
+
+  start = SteadyClock::now();
+  for (int32_t loop = 0; loop < kLoopCount; ++loop) {
+    ByteBuffer buffer(kPositionCount * 16, ByteBuffer::ReserveFlag{});
+    encode_batch(buffer);
+    sum += buffer.GetSize();
+  }
+  auto batch_encode_cost = SteadyClock::now() - start;
+
+  start = SteadyClock::now();
+  for (int32_t loop = 0; loop < kLoopCount; ++loop) {
+    scalar_buffer.SetReadPos(0);
+    scalar_buffer.ResetBitPos();
+    for (size_t i = 0; i < kPositionCount; ++i) {
+      scalar_buffer.ReadPackedUInt64(read_guids[i]);
+    }
+    for (size_t i = 0; i < kPositionCount; ++i) {
+      ByteBuffer::UnpackXYZ(scalar_buffer.Read<uint32_t>(),
+                            read_positions[i * 3], read_positions[i * 3 + 1],
+                            read_positions[i * 3 + 2]);
+    }
+    for (size_t i = 0; i < kPositionCount; ++i) {
+      read_states[i] = scalar_buffer.ReadBits(kStateBits);
+    }
+    sum += read_guids.back() + read_states.back();
+  }
+  auto scalar_decode_cost = SteadyClock::now() - start;
+
+  start = SteadyClock::now();
+  for (int32_t loop = 0; loop < kLoopCount; ++loop) {
+    batch_buffer.SetReadPos(0);
+    batch_buffer.ResetBitPos();
+    batch_buffer.ReadPackedUInt64(read_guids.data(), kPositionCount);
+    batch_buffer.ReadPackXYZ(read_positions.data(), kPositionCount);
+    batch_buffer.ReadBits(read_states.data(), kPositionCount, kStateBits);
+    sum += read_guids.back() + read_states.back();
+  }
+  auto batch_decode_cost = SteadyClock::now() - start;
+  REQUIRE(read_guids == guids);
+  REQUIRE(read_states == states);
+
+  auto to_ns = [](auto cost) {
+    return double(std::chrono::duration_cast<NanoSeconds>(cost).count()) /
+           (double(kLoopCount) * kPositionCount);
+  };
+  fmt::print(
+      "byte_buffer codec {} positions ns/position encode scalar {:.2f} "
+      "batch {:.2f} decode scalar {:.2f} batch {:.2f} ({})\n",
+      kPositionCount, to_ns(scalar_encode_cost), to_ns(batch_encode_cost),
+      to_ns(scalar_decode_cost), to_ns(batch_decode_cost), sum != 0);
+}
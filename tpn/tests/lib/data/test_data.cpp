@@ -22,12 +22,24 @@
 
 #include "../../test_include.h"
 
+#include <cstring>
+
+#include <span>
+#include <fstream>
+#include <filesystem>
+
 #include "log.h"
 #include "utils.h"
 #include "config.h"
 #include "fmt_wrap.h"
+#include "flat_data.h"
+#include "chrono_wrap.h"
 #include "data_entry.h"
 
+#if (TPN_PLATFORM == TPN_PLATFORM_UNIX)
+#  include <unistd.h>
+#endif
+
 #ifndef _TPN_DATA_CONFIG_TEST_FILE
 #  define _TPN_DATA_CONFIG_TEST_FILE "config_data_test.json"
 #endif
@@ -72,3 +84,256 @@ TEST_CASE("data1", "data") {
 
   std::this_thread::sleep_for(3s);
 }
+
+/// 常驻内存大小 仅用于对比
+static size_t GetResidentBytes() {
+#if (TPN_PLATFORM == TPN_PLATFORM_UNIX)
+  std::ifstream statm("/proc/self/statm");
+  size_t total = 0, resident = 0;
+  statm >> total >> resident;
+  return resident * static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+#else
+  return 0;
+#endif
+}
+
+TEST_CASE("data flat", "data") {
+  if (auto error = g_config->Load(_TPN_DATA_CONFIG_TEST_FILE, {})) {
+    fmt::print(stderr, "Error in config file {}, error {}\n",
+               _TPN_DATA_CONFIG_TEST_FILE, *error);
+    return;
+  }
+
+  tpn::log::Init();
+  std::shared_ptr<void> log_handle(nullptr,
+                                   [](void *) { tpn::log::Shutdown(); });
+
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+  std::shared_ptr<void> protobuf_handle(
+      nullptr, [](void *) { google::protobuf::ShutdownProtobufLibrary(); });
+
+  LOG_INFO("data flat start");
+
+  if (nullptr == g_data_hub->GetDataHubEntryItem(1)) {
+    REQUIRE(tpn::data::Init());
+  }
+  REQUIRE(tpn::data::InitFlat());
+
+  for (uint32_t id = 0; id < 8; ++id) {
+    auto *item      = g_data_hub->GetDataHubEntryItem(id);
+    auto *flat_item = g_data_hub->GetFlatDataHubEntryItem(id);
+    REQUIRE((nullptr == item) == (nullptr == flat_item));
+    if (nullptr != item) {
+      REQUIRE(item->id() == flat_item->id);
+      REQUIRE(item->type() == flat_item->type);
+      REQUIRE(item->sub_type() == flat_item->sub_type);
+      REQUIRE(item->quality() == flat_item->quality);
+      REQUIRE(item->name() == g_data_hub->GetFlatString(flat_item->name));
+    }
+
+    auto *level      = g_data_hub->GetDataHubEntryLevel(id);
+    auto *flat_level = g_data_hub->GetFlatDataHubEntryLevel(id);
+    REQUIRE((nullptr == level) == (nullptr == flat_level));
+    if (nullptr != level) {
+      REQUIRE(level->exp() == flat_level->exp);
+    }
+
+    for (uint32_t lv = 0; lv < 5; ++lv) {
+      auto *skill      = g_data_hub->GetDataHubEntrySkill(id, lv);
+      auto *flat_skill = g_data_hub->GetFlatDataHubEntrySkill(id, lv);
+      REQUIRE((nullptr == skill) == (nullptr == flat_skill));
+      if (nullptr != skill) {
+        REQUIRE(skill->type() == flat_skill->type);
+        REQUIRE(skill->name() == g_data_hub->GetFlatString(flat_skill->name));
+      }
+    }
+  }
+
+  // 缺表的文件加载失败后不能留下指向旧映射或新映射的行数据
+  {
+    using FlatItem = tpn::data::DataHubMgr::FlatDataHubEntryItem;
+    auto flat_path = (std::filesystem::temp_directory_path() /
+                      "tpn_test_data_hub_partial.flat")
+                         .generic_string();
+    tpn::FlatDataWriter writer;
+    FlatItem row{1, 1, 1, writer.AppendString("partial"), 1};
+    std::vector<uint8_t> rows(sizeof(FlatItem));
+    std::memcpy(rows.data(), &row, sizeof(row));
+    REQUIRE(writer.AddTable("item", sizeof(FlatItem), std::move(rows)));
+    std::string error;
+    REQUIRE(writer.Write(flat_path, error));
+
+    REQUIRE_FALSE(g_data_hub->LoadFlat(flat_path, error));
+    REQUIRE(nullptr == g_data_hub->GetFlatDataHubEntryItem(1));
+    REQUIRE(nullptr == g_data_hub->GetFlatDataHubEntryLevel(1));
+    REQUIRE_FALSE(g_data_hub->LoadFlat(flat_path + ".missing", error));
+    REQUIRE(nullptr == g_data_hub->GetFlatDataHubEntryItem(1));
+    std::filesystem::remove(flat_path);
+
+    REQUIRE(tpn::data::InitFlat());
+  }
+
+  LOG_INFO("data flat end");
+}
+
+TEST_CASE("data flat validate", "data") {
+  auto flat_path = (std::filesystem::temp_directory_path() /
+                    "tpn_test_data_hub_crafted.flat")
+                       .generic_string();
+
+  std::vector<uint8_t> content;
+  {
+    tpn::FlatDataWriter writer;
+    std::vector<uint8_t> rows(sizeof(uint64_t) * 4);
+    writer.AppendString("crafted");
+    REQUIRE(writer.AddTable("item", sizeof(uint64_t), std::move(rows)));
+    std::string error;
+    REQUIRE(writer.Write(flat_path, error));
+
+    std::ifstream input(flat_path, std::ifstream::binary);
+    content.assign(std::istreambuf_iterator<char>(input),
+                   std::istreambuf_iterator<char>());
+    REQUIRE(content.size() > sizeof(tpn::FlatDataHeader));
+  }
+
+  // 改写后的文件应当在校验阶段失败, 不能因偏移加大小回绕而通过
+  auto open_crafted = [&](auto &&modify) {
+    auto crafted = content;
+    modify(crafted.data());
+    {
+      std::ofstream output(flat_path,
+                           std::ofstream::binary | std::ofstream::trunc);
+      output.write(reinterpret_cast<const char *>(crafted.data()),
+                   static_cast<std::streamsize>(crafted.size()));
+    }
+    tpn::FlatDataFile file;
+    std::string error;
+    return file.Open(flat_path, error);
+  };
+
+  REQUIRE(open_crafted([](uint8_t *) {}));
+
+  REQUIRE_FALSE(open_crafted([](uint8_t *data) {
+    auto *header = reinterpret_cast<tpn::FlatDataHeader *>(data);
+    header->string_pool_size = UINT64_MAX - header->string_pool_offset + 2;
+  }));
+
+  REQUIRE_FALSE(open_crafted([](uint8_t *data) {
+    auto *header = reinterpret_cast<tpn::FlatDataHeader *>(data);
+    header->string_pool_offset = UINT64_MAX;
+  }));
+
+  REQUIRE_FALSE(open_crafted([](uint8_t *data) {
+    auto *table = reinterpret_cast<tpn::FlatDataTable *>(
+        data + sizeof(tpn::FlatDataHeader));
+    table->rows_offset = UINT64_MAX & ~(tpn::kFlatDataAlignment - 1);
+  }));
+
+  REQUIRE_FALSE(open_crafted([](uint8_t *data) {
+    auto *table = reinterpret_cast<tpn::FlatDataTable *>(
+        data + sizeof(tpn::FlatDataHeader));
+    table->row_count = UINT32_MAX;
+    table->row_size  = UINT32_MAX;
+  }));
+
+  std::filesystem::remove(flat_path);
+}
+
+TEST_CASE("data flat cold start", "[.][bench]") {
+  using tpn::data::DataHubMgr;
+  using FlatItem = DataHubMgr::FlatDataHubEntryItem;
+
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+  constexpr uint32_t kRows = 200000;
+
+  auto tmp_dir   = std::filesystem::temp_directory_path();
+  auto bin_path  = (tmp_dir / "tpn_bench_data_hub.bin").generic_string();
+  auto flat_path = (tmp_dir / "tpn_bench_data_hub.flat").generic_string();
+
+  // 构造同样内容的两种格式
+  {
+    tpn::data::DataHubEntryItem entry;
+    tpn::FlatDataWriter writer;
+    std::vector<uint8_t> rows(sizeof(FlatItem) * kRows);
+    for (uint32_t i = 0; i < kRows; ++i) {
+      auto name  = fmt::format("item_{}", i);
+      auto *data = entry.add_datas();
+      data->set_id(i);
+      data->set_type(i % 7);
+      data->set_sub_type(i % 13);
+      data->set_name(name);
+      data->set_quality(i % 5);
+
+      FlatItem row{i, i % 7, i % 13, writer.AppendString(name), i % 5};
+      std::memcpy(rows.data() + i * sizeof(FlatItem), &row, sizeof(row));
+    }
+
+    tpn::data::DataHubMap data_map;
+    (*data_map.mutable_datas())["item"].PackFrom(entry);
+    std::fstream output(bin_path, std::fstream::out | std::fstream::trunc |
+                                      std::fstream::binary);
+    REQUIRE(data_map.SerializeToOstream(&output));
+
+    REQUIRE(writer.AddTable("item", sizeof(FlatItem), std::move(rows)));
+    std::string error;
+    REQUIRE(writer.Write(flat_path, error));
+  }
+
+  // protobuf 解析 + 拷贝进map
+  auto pb_rss   = GetResidentBytes();
+  auto pb_start = tpn::SteadyClock::now();
+  std::map<uint32_t, tpn::data::DataHubEntryItem::Item> item_map;
+  {
+    tpn::data::DataHubMap data_map;
+    std::fstream input(bin_path, std::fstream::in | std::fstream::binary);
+    REQUIRE(data_map.ParseFromIstream(&input));
+    for (auto &&[key, val] : data_map.datas()) {
+      tpn::data::DataHubEntryItem entry;
+      val.UnpackTo(&entry);
+      for (auto &&data : entry.datas()) {
+        item_map.emplace(data.id(), data);
+      }
+    }
+  }
+  auto pb_cost = tpn::SteadyClock::now() - pb_start;
+  pb_rss       = GetResidentBytes() - pb_rss;
+
+  // 平坦数据 映射
+  auto flat_rss   = GetResidentBytes();
+  auto flat_start = tpn::SteadyClock::now();
+  tpn::FlatDataFile flat_file;
+  std::span<const FlatItem> flat_rows;
+  {
+    std::string error;
+    REQUIRE(flat_file.Open(flat_path, error));
+    REQUIRE(flat_file.GetRows("item", flat_rows));
+  }
+  auto flat_cost = tpn::SteadyClock::now() - flat_start;
+  flat_rss       = GetResidentBytes() - flat_rss;
+
+  REQUIRE(kRows == item_map.size());
+  REQUIRE(kRows == flat_rows.size());
+  for (uint32_t i = 0; i < kRows; i += 997) {
+    auto iter = std::lower_bound(
+        flat_rows.begin(), flat_rows.end(), i,
+        [](const FlatItem &row, uint32_t key) { return row.id < key; });
+    REQUIRE(flat_rows.end() != iter);
+    REQUIRE(item_map[i].name() == flat_file.GetString(iter->name));
+  }
+
+  fmt::print(
+      "rows: {}\n"
+      "protobuf cold start: {} us, rss: {} KB\n"
+      "flat     cold start: {} us, rss: {} KB\n",
+      kRows,
+      std::chrono::duration_cast<tpn::MicroSeconds>(pb_cost).count(),
+      pb_rss / 1024,
+      std::chrono::duration_cast<tpn::MicroSeconds>(flat_cost).count(),
+      flat_rss / 1024);
+
+  flat_file.Close();
+  std::filesystem::remove(bin_path);
+  std::filesystem::remove(flat_path);
+}
@@ -0,0 +1,34 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef TYPHOON_ZERO_TPN_TESTS_LIB_NET_ALLOC_COUNTER_H_
+#define TYPHOON_ZERO_TPN_TESTS_LIB_NET_ALLOC_COUNTER_H_
+
+#include <atomic>
+#include <cstdint>
+
+/// 进程内的堆申请次数，由 alloc_counter.cpp 替换全局 operator new 统计，
+/// 需要统计的测试把 alloc_counter.cpp 加入可执行文件源文件
+/// 客户端与服务器在同一进程时，统计的是两端的总开销
+extern std::atomic<uint64_t> g_heap_allocations;
+
+#endif  // TYPHOON_ZERO_TPN_TESTS_LIB_NET_ALLOC_COUNTER_H_
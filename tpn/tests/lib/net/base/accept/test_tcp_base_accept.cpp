@@ -0,0 +1,237 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if (TPN_PLATFORM == TPN_PLATFORM_UNIX)
+#  include <sys/resource.h>
+#endif
+
+#include "log.h"
+#include "config.h"
+#include "chrono_wrap.h"
+
+#include "net.h"
+
+#ifndef _TPN_NET_BASE_ACCEPT_CONFIG_TEST_FILE
+#  define _TPN_NET_BASE_ACCEPT_CONFIG_TEST_FILE \
+    "config_net_base_accept_test.json"
+#endif
+
+using namespace tpn;
+using namespace tpn::net;
+
+/// 连接发起端，每个线程用阻塞连接打开一组套接字
+class AcceptConnector {
+ public:
+  /// 连接服务器
+  ///  @param[in]   threads   连接线程数
+  ///  @param[in]   count     每个线程的连接数
+  ///  @param[in]   port      服务器端口
+  ///  @return 连接成功数
+  size_t Connect(size_t threads, size_t count, unsigned short port) {
+    asio::ip::tcp::endpoint endpoint(asio::ip::make_address("127.0.0.1"), port);
+    this->sockets_.resize(threads);
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < threads; ++i) {
+      workers.emplace_back([this, endpoint, count, &sockets = sockets_[i]]() {
+        for (size_t j = 0; j < count; ++j) {
+          auto &socket = sockets.emplace_back(
+              std::make_unique<asio::ip::tcp::socket>(this->context_));
+          std::error_code ec;
+          socket->connect(endpoint, ec);
+          if (ec) {
+            sockets.pop_back();
+            continue;
+          }
+          ++this->connected_;
+        }
+      });
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+    return this->connected_.load();
+  }
+
+  /// 关闭所有连接
+  void Close() {
+    this->sockets_.clear();
+    this->connected_ = 0;
+  }
+
+ private:
+  asio::io_context context_{1};
+  std::vector<std::vector<std::unique_ptr<asio::ip::tcp::socket>>> sockets_;
+  std::atomic<size_t> connected_{0};
+};
+
+/// 连接速率基准
+///  @param[in]   name        组名
+///  @param[in]   options     监听选项
+///  @param[in]   io_count    服务器io线程数
+///  @param[in]   threads     连接线程数
+///  @param[in]   count       每个线程的连接数
+///  @return 成功返回true
+bool AcceptBench(const char *name, const TcpServerOptions &options,
+                 size_t io_count, size_t threads, size_t count) {
+  TcpServer server(io_count);
+  server.SetServerOptions(options);
+  if (!server.Start("127.0.0.1", "9994")) {
+    LOG_ERROR("{} accept server start error", name);
+    return false;
+  }
+
+  AcceptConnector connector;
+  std::clock_t c1 = std::clock();
+  auto t1         = SteadyClock::now();
+  size_t connected = connector.Connect(threads, count, 9994);
+  while (connected != server.GetSessionCount() &&
+         SteadyClock::now() - t1 < std::chrono::seconds(60)) {
+    std::this_thread::sleep_for(1ms);
+  }
+  auto cost = std::chrono::duration_cast<MilliSeconds>(SteadyClock::now() - t1);
+  std::clock_t cpu = std::clock() - c1;
+
+  // 检查会话所在io线程分布与接受时设置的套接字选项
+  std::map<IoHandle *, size_t> spread;
+  size_t no_delay = 0;
+  server.ApplyAllSession(
+      [&spread, &no_delay](std::shared_ptr<TcpSession> &session) {
+        ++spread[&session->GetIoHandle()];
+        if (session->IsNodelay()) {
+          ++no_delay;
+        }
+      });
+
+  size_t sessions = server.GetSessionCount();
+  LOG_INFO(
+      "{} acceptors {} sessions {}/{} cost {}ms cpu {}ms rate {}/s "
+      "io handles {} nodelay {}",
+      name, server.GetAcceptorCount(), sessions, threads * count, cost.count(),
+      cpu * 1000 / CLOCKS_PER_SEC,
+      sessions * 1000 / (std::max)(cost.count(), MilliSeconds::rep{1}),
+      spread.size(), no_delay);
+
+  bool ok = connected == threads * count && sessions == connected;
+  if (options.no_delay) {
+    ok = ok && no_delay == sessions;
+  }
+  // 单个接受器轮询分配，端口复用时由内核按四元组散列分配，都应覆盖所有io线程
+  ok = ok && spread.size() == io_count;
+
+  connector.Close();
+  server.Stop();
+  return ok;
+}
+
+/// 同一服务器交替以端口复用和单接受器重新启动，
+/// 收缩接受器列表时上次停止投递的关闭处理可能还未执行
+///  @param[in]   io_count    服务器io线程数
+///  @param[in]   rounds      启动次数
+///  @return 成功返回true
+bool RestartTest(size_t io_count, size_t rounds) {
+  TcpServer server(io_count);
+  for (size_t i = 0; i < rounds; ++i) {
+    TcpServerOptions options;
+    options.reuse_port = (0 == i % 2);
+    server.SetServerOptions(options);
+    if (!server.Start("127.0.0.1", "9994")) {
+      LOG_ERROR("Restart round {} server start error", i);
+      return false;
+    }
+
+    AcceptConnector connector;
+    size_t connected = connector.Connect(1, 16, 9994);
+    auto t1          = SteadyClock::now();
+    while (connected != server.GetSessionCount() &&
+           SteadyClock::now() - t1 < std::chrono::seconds(30)) {
+      std::this_thread::sleep_for(1ms);
+    }
+
+    bool ok = connected == 16 && server.GetSessionCount() == connected;
+    connector.Close();
+    server.Stop();
+    if (!ok) {
+      LOG_ERROR("Restart round {} acceptors {} sessions {}", i,
+                server.GetAcceptorCount(), connected);
+      return false;
+    }
+  }
+
+  LOG_INFO("Restart rounds {} check true", rounds);
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  if (auto error = g_config->Load(_TPN_NET_BASE_ACCEPT_CONFIG_TEST_FILE, {})) {
+    printf("Error in config file: %s\n", (*error).c_str());
+    return 1;
+  }
+
+  tpn::log::Init();
+  std::shared_ptr<void> log_handle(nullptr,
+                                   [](void *) { tpn::log::Shutdown(); });
+
+  size_t threads = argc > 1 ? std::stoul(argv[1]) : 4;
+  size_t count   = argc > 2 ? std::stoul(argv[2]) : 2000;
+
+#if (TPN_PLATFORM == TPN_PLATFORM_UNIX)
+  // 客户端和服务器在同一进程，每个会话占用两个文件描述符
+  rlimit limit{};
+  if (0 == getrlimit(RLIMIT_NOFILE, &limit)) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+    size_t max_count = (limit.rlim_cur - 256) / 2 / threads;
+    if (count > max_count) {
+      LOG_WARN("Accept connections {} limited to {} by RLIMIT_NOFILE {}", count,
+               max_count, limit.rlim_cur);
+      count = max_count;
+    }
+  }
+#endif
+
+  bool ok = AcceptBench("Default", TcpServerOptions{}, 4, threads, count);
+
+  TcpServerOptions options;
+  options.reuse_port   = true;
+  options.backlog      = 4096;
+  options.accept_batch = 16;
+  options.no_delay     = true;
+  ok = AcceptBench("ReusePort", options, 4, threads, count) && ok;
+  ok = RestartTest(4, 8) && ok;
+
+  if (!ok) {
+    LOG_ERROR("Accept bench failed");
+    return 1;
+  }
+
+  return 0;
+}
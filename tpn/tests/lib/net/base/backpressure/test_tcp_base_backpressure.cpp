@@ -0,0 +1,279 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "log.h"
+#include "config.h"
+#include "chrono_wrap.h"
+
+#include "net.h"
+
+#include "../test_receiver.h"
+
+#ifndef _TPN_NET_BASE_BACKPRESSURE_CONFIG_TEST_FILE
+#  define _TPN_NET_BASE_BACKPRESSURE_CONFIG_TEST_FILE \
+    "config_net_base_backpressure_test.json"
+#endif
+
+using namespace tpn;
+using namespace tpn::net;
+
+/// 每个逻辑帧广播的消息数
+static constexpr size_t kTickMessages = 8;
+
+std::atomic<size_t> g_high_count{0};  ///< 高水位通知次数
+std::atomic<size_t> g_low_count{0};   ///< 低水位通知次数
+
+/// 统计水位通知的会话
+class BackpressureSession
+    : public TcpSessionBase<BackpressureSession, TemplateArgsTcpSession> {
+ public:
+  using TcpSessionBase<BackpressureSession,
+                       TemplateArgsTcpSession>::TcpSessionBase;
+
+  void FireSendHighWatermark(std::shared_ptr<BackpressureSession> &this_ptr,
+                             size_t bytes) {
+    ++g_high_count;
+  }
+
+  void FireSendLowWatermark(std::shared_ptr<BackpressureSession> &this_ptr,
+                            size_t bytes) {
+    ++g_low_count;
+  }
+};
+
+using BackpressureServer = TcpServerBridge<BackpressureSession>;
+
+/// 条件成立或超时前循环等待，期间记录会话发送队列字节数的峰值
+///  @param[in]   server    服务器
+///  @param[in]   peak      发送队列字节数峰值
+///  @param[in]   cond      等待条件
+template <typename Cond>
+void WaitFor(BackpressureServer &server, size_t &peak, Cond &&cond) {
+  auto t1 = SteadyClock::now();
+  while (!cond() && SteadyClock::now() - t1 < std::chrono::seconds(30)) {
+    server.ApplyAllSession(
+        [&peak](std::shared_ptr<BackpressureSession> &session) {
+          peak = (std::max)(peak, session->GetSendQueueBytes());
+        });
+    std::this_thread::sleep_for(1ms);
+  }
+}
+
+/// 不读取的客户端在广播下超限被断开，其他客户端不受影响
+///  @param[in]   readers   读取的连接数
+///  @param[in]   rounds    广播次数
+///  @param[in]   size      消息大小
+///  @return 成功返回true
+bool DisconnectTest(size_t readers, size_t rounds, size_t size) {
+  TcpServerOptions options;
+  options.send_buffer_size          = 16 * 1024;
+  options.send_queue.max_bytes      = 1024 * 1024;
+  options.send_queue.high_watermark = 256 * 1024;
+  options.send_queue.low_watermark  = 64 * 1024;
+  options.send_queue.overflow       = SendOverflowPolicy::kDisconnect;
+
+  BackpressureServer server(2);
+  server.SetServerOptions(options);
+  if (!server.Start("127.0.0.1", "9993")) {
+    LOG_ERROR("backpressure server start error");
+    return false;
+  }
+
+  // 一个不读取的连接模拟网络很差的手机客户端，其他连接收到多少读多少
+  TestReceiver peers;
+  auto *stalled = peers.ConnectStalled(9993, 4096);
+  if (!stalled || readers != peers.Connect(readers, 9993)) {
+    LOG_ERROR("backpressure connect error");
+    return false;
+  }
+
+  size_t peak = 0;
+  WaitFor(server, peak,
+          [&]() { return readers + 1 == server.GetSessionCount(); });
+
+  g_high_count = 0;
+  g_low_count  = 0;
+
+  MessageBuffer payload(size);
+  std::fill_n(payload.GetWritePointer(), size, static_cast<uint8_t>('b'));
+  payload.WriteCompleted(size);
+
+  // 按逻辑帧广播，读取的连接跟上后才进入下一帧
+  auto t1 = SteadyClock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    server.Broadcast(MessageBuffer(payload));
+    if (0 == (i + 1) % kTickMessages) {
+      WaitFor(server, peak,
+              [&]() { return peers.GetMin() >= (i + 1) * size; });
+    }
+  }
+  WaitFor(server, peak,
+          [&]() { return peers.GetMin() >= rounds * size; });
+  auto elapsed =
+      std::chrono::duration_cast<MilliSeconds>(SteadyClock::now() - t1);
+
+  bool ok = (readers == server.GetSessionCount()) &&
+            (peers.GetMin() == rounds * size) && (g_high_count > 0) &&
+            (peak <= options.send_queue.max_bytes);
+  LOG_INFO(
+      "Disconnect policy rounds {} size {} broadcast {} MB per session in "
+      "{}ms sessions {}/{} stalled received {} high {} peak queue {} max {} "
+      "check {}",
+      rounds, size, rounds * size / (1024 * 1024), elapsed.count(),
+      server.GetSessionCount(), readers + 1, stalled->received.load(),
+      g_high_count.load(), peak, options.send_queue.max_bytes, ok);
+
+  server.Stop();
+  peers.Stop();
+  return ok;
+}
+
+/// 不读取的客户端在广播下丢弃可丢弃的消息，保持连接，开始读取后回落到低水位
+///  @param[in]   readers   读取的连接数
+///  @param[in]   rounds    广播次数
+///  @param[in]   size      消息大小
+///  @return 成功返回true
+bool DropTest(size_t readers, size_t rounds, size_t size) {
+  TcpServerOptions options;
+  options.send_buffer_size          = 16 * 1024;
+  options.send_queue.max_bytes      = 1024 * 1024;
+  options.send_queue.high_watermark = 256 * 1024;
+  options.send_queue.low_watermark  = 64 * 1024;
+  options.send_queue.overflow       = SendOverflowPolicy::kDropUnreliable;
+
+  BackpressureServer server(2);
+  server.SetServerOptions(options);
+  if (!server.Start("127.0.0.1", "9993")) {
+    LOG_ERROR("backpressure server start error");
+    return false;
+  }
+
+  // 一个不读取的连接模拟网络很差的手机客户端，其他连接收到多少读多少
+  TestReceiver peers;
+  auto *stalled = peers.ConnectStalled(9993, 4096);
+  if (!stalled || readers != peers.Connect(readers, 9993)) {
+    LOG_ERROR("backpressure connect error");
+    return false;
+  }
+
+  size_t peak = 0;
+  WaitFor(server, peak,
+          [&]() { return readers + 1 == server.GetSessionCount(); });
+
+  g_high_count = 0;
+  g_low_count  = 0;
+
+  MessageBuffer payload(size);
+  std::fill_n(payload.GetWritePointer(), size, static_cast<uint8_t>('u'));
+  payload.WriteCompleted(size);
+  auto unreliable = MakeSharedMessageBuffer(std::move(payload));
+
+  MessageBuffer position(64);
+  std::fill_n(position.GetWritePointer(), 64, static_cast<uint8_t>('p'));
+  position.WriteCompleted(64);
+  auto latest = MakeSharedMessageBuffer(std::move(position));
+
+  // 每轮一条可丢弃的大消息，加上16个实体各一条最新值消息
+  std::vector<std::shared_ptr<BackpressureSession>> sessions;
+  server.ApplyAllSession(
+      [&sessions](std::shared_ptr<BackpressureSession> &session) {
+        sessions.emplace_back(session);
+      });
+
+  auto t1 = SteadyClock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    for (auto &session : sessions) {
+      session->SendUnreliable(unreliable);
+      session->SendLatest(i % 16, latest);
+    }
+    if (0 == (i + 1) % kTickMessages) {
+      WaitFor(server, peak, [&]() {
+        return peers.GetMin() >= (i + 1) * (size + 64);
+      });
+    }
+  }
+
+  size_t expected = rounds * (size + 64);
+  WaitFor(server, peak, [&]() { return peers.GetMin() >= expected; });
+  auto elapsed =
+      std::chrono::duration_cast<MilliSeconds>(SteadyClock::now() - t1);
+
+  size_t dropped = 0;
+  for (auto &session : sessions) {
+    dropped = (std::max)(dropped, session->GetSendQueueDropped());
+  }
+
+  // 开始读取后队列排空，回落到低水位
+  peers.Drain(*stalled);
+  WaitFor(server, peak, [&]() { return g_low_count >= g_high_count; });
+  sessions.clear();
+
+  bool ok = (readers + 1 == server.GetSessionCount()) && (dropped > 0) &&
+            (g_high_count > 0) && (g_low_count == g_high_count) &&
+            (peak <= options.send_queue.max_bytes);
+  LOG_INFO(
+      "Drop policy rounds {} size {} sent {} MB per session in {}ms sessions "
+      "{}/{} stalled dropped {} received {} high {} low {} peak queue {} "
+      "max {} check {}",
+      rounds, size, rounds * size / (1024 * 1024), elapsed.count(),
+      server.GetSessionCount(), readers + 1, dropped, stalled->received.load(),
+      g_high_count.load(), g_low_count.load(), peak,
+      options.send_queue.max_bytes, ok);
+
+  server.Stop();
+  peers.Stop();
+  return ok;
+}
+
+int main(int argc, char *argv[]) {
+  if (auto error =
+          g_config->Load(_TPN_NET_BASE_BACKPRESSURE_CONFIG_TEST_FILE, {})) {
+    printf("Error in config file: %s\n", (*error).c_str());
+    return 1;
+  }
+
+  tpn::log::Init();
+  std::shared_ptr<void> log_handle(nullptr,
+                                   [](void *) { tpn::log::Shutdown(); });
+
+  size_t rounds = argc > 1 ? std::stoul(argv[1]) : 2000;
+
+  if (!DisconnectTest(4, rounds, 16 * 1024)) {
+    LOG_ERROR("Backpressure disconnect test failed");
+    return 1;
+  }
+
+  if (!DropTest(4, rounds, 16 * 1024)) {
+    LOG_ERROR("Backpressure drop test failed");
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,197 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "log.h"
+#include "config.h"
+#include "chrono_wrap.h"
+
+#include "net.h"
+
+#include "../test_receiver.h"
+
+#ifndef _TPN_NET_BASE_BALANCE_CONFIG_TEST_FILE
+#  define _TPN_NET_BASE_BALANCE_CONFIG_TEST_FILE \
+    "config_net_base_balance_test.json"
+#endif
+
+using namespace tpn;
+using namespace tpn::net;
+
+/// 等待服务器会话数
+///  @param[in]   server      服务器
+///  @param[in]   count       会话数
+void WaitSessions(TcpServer &server, size_t count) {
+  auto t1 = SteadyClock::now();
+  while (count != server.GetSessionCount() &&
+         SteadyClock::now() - t1 < std::chrono::seconds(30)) {
+    std::this_thread::sleep_for(1ms);
+  }
+}
+
+/// 倾斜流量基准
+/// 先连入少量持续大流量的热点会话，流量采样后再连入大量空闲会话，
+/// 统计空闲会话落在热点io线程上的数量
+///  @param[in]   name        组名
+///  @param[in]   options     io对象池选项
+///  @param[in]   io_count    服务器io线程数
+///  @param[in]   hot         热点会话数
+///  @param[in]   cold        空闲会话数
+///  @param[out]  cold_on_hot 落在热点io线程上的空闲会话平均数
+///  @param[out]  cold_on_rest 落在其他io线程上的空闲会话平均数
+///  @return 成功返回true
+bool BalanceBench(const char *name, const IoPoolOptions &options,
+                  size_t io_count, size_t hot, size_t cold,
+                  double &cold_on_hot, double &cold_on_rest) {
+  TcpServer server(io_count);
+  server.SetIoPoolOptions(options);
+  if (!server.Start("127.0.0.1", "9995")) {
+    LOG_ERROR("{} balance server start error", name);
+    return false;
+  }
+
+  TestReceiver receiver(16384);
+  size_t connected = receiver.Connect(hot, 9995);
+  WaitSessions(server, connected);
+
+  std::vector<std::shared_ptr<TcpSession>> hot_sessions;
+  std::set<IoHandle *> hot_handles;
+  server.ApplyAllSession([&](std::shared_ptr<TcpSession> &session) {
+    hot_sessions.emplace_back(session);
+    hot_handles.emplace(&session->GetIoHandle());
+  });
+
+  // 每毫秒给热点会话各发16K，约16MB/s
+  std::atomic<bool> pumping{true};
+  std::thread pump([&hot_sessions, &pumping]() {
+    MessageBuffer payload(16384);
+    payload.WriteCompleted(16384);
+    auto shared = MakeSharedMessageBuffer(std::move(payload));
+    while (pumping) {
+      for (auto &session : hot_sessions) {
+        session->Send(shared);
+      }
+      std::this_thread::sleep_for(1ms);
+    }
+  });
+
+  // 等待一个以上的采样间隔
+  std::this_thread::sleep_for(MilliSeconds(kIoLoadSampleInterval * 3 / 2));
+
+  connected += receiver.Connect(cold, 9995);
+  WaitSessions(server, connected);
+
+  pumping = false;
+  pump.join();
+
+  std::map<IoHandle *, size_t> spread;
+  server.ApplyAllSession([&spread](std::shared_ptr<TcpSession> &session) {
+    ++spread[&session->GetIoHandle()];
+  });
+
+  size_t on_hot  = 0;
+  size_t on_rest = 0;
+  for (size_t i = 0; i < server.GetIoPoolSize(); ++i) {
+    IoHandle &io_handle = server.GetIoHandleByIndex(i);
+    size_t sessions     = spread[&io_handle];
+    bool is_hot         = hot_handles.count(&io_handle) > 0;
+    if (is_hot) {
+      on_hot += sessions;
+    } else {
+      on_rest += sessions;
+    }
+    LOG_INFO("{} io handle {} hot {} sessions {} bytes {} score {}", name, i,
+             is_hot, sessions, io_handle.GetLoad().GetBytes(),
+             io_handle.GetLoad().GetScore());
+  }
+
+  // 扣除热点会话本身
+  on_hot -= hot_sessions.size();
+  size_t rest_count = io_count - hot_handles.size();
+  cold_on_hot  = static_cast<double>(on_hot) / hot_handles.size();
+  cold_on_rest = rest_count > 0 ? static_cast<double>(on_rest) / rest_count : 0;
+  LOG_INFO(
+      "{} sessions {}/{} idle sessions per hot io thread {:.1f} per other io "
+      "thread {:.1f}",
+      name, server.GetSessionCount(), hot + cold, cold_on_hot, cold_on_rest);
+
+  hot_sessions.clear();
+  server.Stop();
+  return connected == hot + cold;
+}
+
+int main(int argc, char *argv[]) {
+  if (auto error =
+          g_config->Load(_TPN_NET_BASE_BALANCE_CONFIG_TEST_FILE, {})) {
+    printf("Error in config file: %s\n", (*error).c_str());
+    return 1;
+  }
+
+  tpn::log::Init();
+  std::shared_ptr<void> log_handle(nullptr,
+                                   [](void *) { tpn::log::Shutdown(); });
+
+  size_t io_count = argc > 1 ? std::stoul(argv[1]) : 4;
+  size_t hot      = argc > 2 ? std::stoul(argv[2]) : 2;
+  size_t cold     = argc > 3 ? std::stoul(argv[3]) : 400;
+
+  double rr_hot   = 0;
+  double rr_rest  = 0;
+  double ll_hot   = 0;
+  double ll_rest  = 0;
+  double p2c_hot  = 0;
+  double p2c_rest = 0;
+
+  IoPoolOptions options;
+  bool ok = BalanceBench("RoundRobin", options, io_count, hot, cold, rr_hot,
+                         rr_rest);
+
+  options.select_policy = IoSelectPolicy::kIoSelectPolicyLeastLoaded;
+  ok = BalanceBench("LeastLoaded", options, io_count, hot, cold, ll_hot,
+                    ll_rest) &&
+       ok;
+
+  // 绑定cpu只验证启动与停止
+  options.select_policy = IoSelectPolicy::kIoSelectPolicyPowerOfTwo;
+  options.cpu_affinity  = true;
+  options.numa_aware    = true;
+  ok = BalanceBench("PowerOfTwo", options, io_count, hot, cold, p2c_hot,
+                    p2c_rest) &&
+       ok;
+
+  // 负载感知的策略应该让热点io线程少接空闲会话
+  ok = ok && ll_hot < ll_rest && p2c_hot < p2c_rest;
+  if (!ok) {
+    LOG_ERROR("Balance bench failed");
+    return 1;
+  }
+
+  return 0;
+}
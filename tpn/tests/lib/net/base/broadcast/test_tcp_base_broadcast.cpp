@@ -0,0 +1,175 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if (TPN_PLATFORM == TPN_PLATFORM_UNIX)
+#  include <sys/resource.h>
+#endif
+
+#include "log.h"
+#include "config.h"
+#include "chrono_wrap.h"
+
+#include "net.h"
+
+#include "../test_receiver.h"
+
+#ifndef _TPN_NET_BASE_BROADCAST_CONFIG_TEST_FILE
+#  define _TPN_NET_BASE_BROADCAST_CONFIG_TEST_FILE \
+    "config_net_base_broadcast_test.json"
+#endif
+
+using namespace tpn;
+using namespace tpn::net;
+
+/// 广播基准
+///  @param[in]   count       会话数
+///  @param[in]   io_count    服务器io线程数
+///  @param[in]   rounds      广播次数
+///  @param[in]   size        消息大小
+///  @return 成功返回true
+bool BroadcastBench(size_t count, size_t io_count, size_t rounds, size_t size) {
+  TcpServer server(io_count);
+  if (!server.Start("127.0.0.1", "9993")) {
+    LOG_ERROR("broadcast server start error");
+    return false;
+  }
+
+  TestReceiver receiver;
+  size_t connected = receiver.Connect(count, 9993);
+
+  auto t1 = SteadyClock::now();
+  while (connected != server.GetSessionCount() &&
+         SteadyClock::now() - t1 < std::chrono::seconds(30)) {
+    std::this_thread::sleep_for(1ms);
+  }
+  LOG_INFO("Broadcast sessions {}/{} io threads {}", server.GetSessionCount(),
+           count, io_count);
+
+  MessageBuffer payload(size);
+  std::fill_n(payload.GetWritePointer(), size, static_cast<uint8_t>('b'));
+  payload.WriteCompleted(size);
+
+  // 对照组：每个会话拷贝一份缓冲，分别从调用线程投递到会话所在io线程
+  std::clock_t c1 = std::clock();
+  auto t2         = SteadyClock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    server.ApplyAllSession([&payload](std::shared_ptr<TcpSession> &session) {
+      MessageBuffer copy(payload);
+      session->Send(std::move(copy));
+    });
+  }
+  auto copy_call =
+      std::chrono::duration_cast<MilliSeconds>(SteadyClock::now() - t2);
+  t2 = SteadyClock::now();
+  WaitReceived(receiver, connected * rounds * size);
+  auto copy_wait =
+      std::chrono::duration_cast<MilliSeconds>(SteadyClock::now() - t2);
+  std::clock_t copy_cpu = std::clock() - c1;
+
+  // 广播：序列化一次，每个io线程一个任务
+  c1 = std::clock();
+  t2 = SteadyClock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    server.Broadcast(MessageBuffer(payload));
+  }
+  auto broadcast_call =
+      std::chrono::duration_cast<MilliSeconds>(SteadyClock::now() - t2);
+  t2 = SteadyClock::now();
+  WaitReceived(receiver, 2 * connected * rounds * size);
+  auto broadcast_wait =
+      std::chrono::duration_cast<MilliSeconds>(SteadyClock::now() - t2);
+  std::clock_t broadcast_cpu = std::clock() - c1;
+
+  // 指定会话广播
+  std::vector<std::shared_ptr<TcpSession>> targets;
+  server.ApplyAllSession([&targets](std::shared_ptr<TcpSession> &session) {
+    targets.emplace_back(session);
+  });
+  auto shared = MakeSharedMessageBuffer(MessageBuffer(payload));
+  size_t sent = server.Broadcast(shared, targets.begin(), targets.end());
+  WaitReceived(receiver, (2 * rounds + 1) * connected * size);
+  targets.clear();
+
+  LOG_INFO(
+      "Per session copy sessions {} rounds {} size {} call {}ms delivered {}ms "
+      "cpu {}ms",
+      connected, rounds, size, copy_call.count(), copy_wait.count(),
+      copy_cpu * 1000 / CLOCKS_PER_SEC);
+  LOG_INFO(
+      "Broadcast sessions {} rounds {} size {} call {}ms delivered {}ms cpu "
+      "{}ms",
+      connected, rounds, size, broadcast_call.count(), broadcast_wait.count(),
+      broadcast_cpu * 1000 / CLOCKS_PER_SEC);
+
+  bool ok = receiver.Check((2 * rounds + 1) * size) && sent == connected;
+  LOG_INFO("Broadcast received {} bytes, expected {} per session check {}",
+           receiver.GetTotal(), (2 * rounds + 1) * size, ok);
+
+  server.Stop();
+  receiver.Stop();
+  return ok && connected == count;
+}
+
+int main(int argc, char *argv[]) {
+  if (auto error =
+          g_config->Load(_TPN_NET_BASE_BROADCAST_CONFIG_TEST_FILE, {})) {
+    printf("Error in config file: %s\n", (*error).c_str());
+    return 1;
+  }
+
+  tpn::log::Init();
+  std::shared_ptr<void> log_handle(nullptr,
+                                   [](void *) { tpn::log::Shutdown(); });
+
+  size_t count  = argc > 1 ? std::stoul(argv[1]) : 10000;
+  size_t rounds = argc > 2 ? std::stoul(argv[2]) : 10;
+
+#if (TPN_PLATFORM == TPN_PLATFORM_UNIX)
+  // 客户端和服务器在同一进程，每个会话占用两个文件描述符
+  rlimit limit{};
+  if (0 == getrlimit(RLIMIT_NOFILE, &limit)) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+    size_t max_count = (limit.rlim_cur - 256) / 2;
+    if (count > max_count) {
+      LOG_WARN("Broadcast sessions {} limited to {} by RLIMIT_NOFILE {}", count,
+               max_count, limit.rlim_cur);
+      count = max_count;
+    }
+  }
+#endif
+
+  if (!BroadcastBench(count, 2, rounds, 256)) {
+    LOG_ERROR("Broadcast bench failed");
+    return 1;
+  }
+
+  return 0;
+}
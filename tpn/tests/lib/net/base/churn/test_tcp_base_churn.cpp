@@ -0,0 +1,139 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "log.h"
+#include "config.h"
+#include "chrono_wrap.h"
+
+#include "net.h"
+
+#ifndef _TPN_NET_BASE_CHURN_CONFIG_TEST_FILE
+#  define _TPN_NET_BASE_CHURN_CONFIG_TEST_FILE \
+    "config_net_base_churn_test.json"
+#endif
+
+using namespace tpn;
+using namespace tpn::net;
+
+/// 每次接受都从全局堆创建会话的服务器，用作对照组
+class TcpServerHeap : public TcpServerBase<TcpServerHeap, TcpSession> {
+ public:
+  using TcpServerBase<TcpServerHeap, TcpSession>::TcpServerBase;
+
+  std::shared_ptr<TcpSession> MakeSession() {
+    return std::make_shared<TcpSession>(
+        this->GetIoHandleByIndex(), this->session_mgr_, this->buffer_max_,
+        this->buffer_prepare_);
+  }
+};
+
+/// 连接/断开抖动测试
+///  @tparam      ServerType    服务器类型
+///  @param[in]   name          测试名称
+///  @param[in]   port          监听端口
+///  @param[in]   io_count      服务器io线程数
+///  @param[in]   thread_count  客户端线程数
+///  @param[in]   loop_count    每个客户端线程连接次数
+template <typename ServerType>
+void ChurnBench(std::string_view name, std::string_view port,
+                size_t io_count, size_t thread_count, size_t loop_count) {
+  ServerType server(io_count);
+  if (!server.Start("127.0.0.1", port)) {
+    LOG_ERROR("{} start error", name);
+    return;
+  }
+
+  std::atomic<size_t> connected{0};
+  auto t1 = SteadyClock::now();
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads.emplace_back([&]() {
+      asio::io_context context(1);
+      asio::ip::tcp::endpoint endpoint(asio::ip::make_address("127.0.0.1"),
+                                       static_cast<unsigned short>(
+                                           std::stoi(std::string(port))));
+      for (size_t n = 0; n < loop_count; ++n) {
+        asio::ip::tcp::socket socket(context);
+        std::error_code ec;
+        socket.connect(endpoint, ec);
+        if (!ec) {
+          ++connected;
+        }
+        socket.close(ec);
+      }
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // 等待服务器释放所有会话
+  while (0 != server.GetSessionCount()) {
+    std::this_thread::sleep_for(1ms);
+  }
+
+  auto cost = std::chrono::duration_cast<MilliSeconds>(SteadyClock::now() - t1);
+
+  size_t reserved = 0;
+  for (size_t i = 0; i < io_count; ++i) {
+    reserved += server.GetIoHandleByIndex(i).GetSessionPool()->GetReservedSize();
+  }
+
+  LOG_INFO("{} connects {} cost {}ms rate {:.0f}/s pool reserved {}KB", name,
+           connected.load(), cost.count(),
+           connected.load() * 1000.0 /
+               static_cast<double>((std::max<int64_t>)(cost.count(), 1)),
+           reserved / 1024);
+
+  server.Stop();
+}
+
+int main(int argc, char *argv[]) {
+  if (auto error = g_config->Load(_TPN_NET_BASE_CHURN_CONFIG_TEST_FILE, {})) {
+    printf("Error in config file: %s\n", (*error).c_str());
+    return 1;
+  }
+
+  tpn::log::Init();
+  std::shared_ptr<void> log_handle(nullptr,
+                                   [](void *) { tpn::log::Shutdown(); });
+
+  size_t loop_count   = argc > 1 ? std::stoul(argv[1]) : 5000;
+  size_t thread_count = argc > 2 ? std::stoul(argv[2]) : 4;
+  size_t io_count     = argc > 3 ? std::stoul(argv[3]) : 2;
+
+  LOG_INFO("Tcp churn bench threads {} loops {} io {}", thread_count,
+           loop_count, io_count);
+
+  ChurnBench<TcpServerHeap>("heap", "9992", io_count, thread_count,
+                            loop_count);
+  ChurnBench<TcpServer>("pool", "9993", io_count, thread_count, loop_count);
+
+  return 0;
+}
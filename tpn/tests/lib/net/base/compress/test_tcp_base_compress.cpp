@@ -0,0 +1,522 @@
+//
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <array>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+#include "log.h"
+#include "config.h"
+#include "chrono_wrap.h"
+#include "byte_converter.h"
+
+#include "net.h"
+
+#ifndef _TPN_NET_BASE_COMPRESS_CONFIG_TEST_FILE
+#  define _TPN_NET_BASE_COMPRESS_CONFIG_TEST_FILE \
+    "config_net_base_compress_test.json"
+#endif
+
+using namespace tpn;
+using namespace tpn::net;
+
+/// 回显会话，收到的包原样发回，发送时按服务器的压缩参数压缩
+class CompressSession
+    : public TcpSessionBase<CompressSession, TemplateArgsTcpSession> {
+ public:
+  using TcpSessionBase<CompressSession,
+                       TemplateArgsTcpSession>::TcpSessionBase;
+
+  void FireRecv(std::shared_ptr<CompressSession> &this_ptr,
+                protocol::Header &&header, MessageBuffer &&packet);
+};
+
+using CompressServer = TcpServerBridge<CompressSession>;
+
+/// 组帧
+///  @param[in]   payload     包体
+///  @return 完整的帧
+MessageBuffer MakeFrame(const void *payload, size_t size) {
+  protocol::Header header;
+  header.set_service_hash(0x5a17c0de);
+  header.set_method_id(7);
+  header.set_size(static_cast<uint32_t>(size));
+
+  uint16_t header_length = static_cast<uint16_t>(header.ByteSizeLong());
+  uint16_t header_bytes  = header_length;
+  EndianRefMakeLittle(header_bytes);
+
+  MessageBuffer frame(kHeaderBytes + header_length + size);
+  frame.Write(&header_bytes, kHeaderBytes);
+  header.SerializeWithCachedSizesToArray(frame.GetWritePointer());
+  frame.WriteCompleted(header_length);
+  frame.Write(payload, size);
+  return frame;
+}
+
+void CompressSession::FireRecv(std::shared_ptr<CompressSession> &this_ptr,
+                               protocol::Header &&header,
+                               MessageBuffer &&packet) {
+  this_ptr->Send(MakeFrame(packet.GetReadPointer(), packet.GetActiveSize()));
+}
+
+/// 合成protobuf包体，模拟场景快照
+/// repeated Entity { uint64 id = 1; float x = 2; float y = 3; float z = 4;
+///                   string name = 5; uint32 hp = 6; uint32 state = 7;
+///                   repeated uint32 buffs = 8 [packed]; }
+///  @param[in]   rng         随机数
+///  @param[in]   size        包体最小长度
+///  @return 序列化后的包体
+std::string MakePayload(std::mt19937 &rng, size_t size) {
+  static const std::array<const char *, 8> kGuilds = {
+      "StormRiders", "IronWolves", "NightBlades", "SunKeepers",
+      "FrostFang",   "EmberGuard", "VoidWalkers", "StarForge"};
+
+  std::string payload;
+  google::protobuf::io::StringOutputStream stream(&payload);
+  google::protobuf::io::CodedOutputStream out(&stream);
+
+  std::uniform_int_distribution<uint32_t> id_dist(100000, 100999);
+  std::uniform_real_distribution<float> pos_dist(0.0f, 512.0f);
+  std::uniform_int_distribution<uint32_t> small_dist(0, 7);
+
+  std::string entity;
+  while (static_cast<size_t>(out.ByteCount()) < size) {
+    entity.clear();
+    {
+      google::protobuf::io::StringOutputStream entity_stream(&entity);
+      google::protobuf::io::CodedOutputStream entity_out(&entity_stream);
+
+      uint32_t id = id_dist(rng);
+      entity_out.WriteTag((1 << 3) | 0);
+      entity_out.WriteVarint64(id);
+      for (uint32_t field = 2; field <= 4; ++field) {
+        entity_out.WriteTag((field << 3) | 5);
+        // 坐标量化到0.5，与服务器的格子精度一致
+        float pos = static_cast<int>(pos_dist(rng) * 2) / 2.0f;
+        entity_out.WriteLittleEndian32(*reinterpret_cast<uint32_t *>(&pos));
+      }
+      std::string name =
+          fmt::format("player_{}@{}", id, kGuilds[small_dist(rng)]);
+      entity_out.WriteTag((5 << 3) | 2);
+      entity_out.WriteVarint32(static_cast<uint32_t>(name.size()));
+      entity_out.WriteString(name);
+      entity_out.WriteTag((6 << 3) | 0);
+      entity_out.WriteVarint32(1000 + small_dist(rng) * 250);
+      entity_out.WriteTag((7 << 3) | 0);
+      entity_out.WriteVarint32(small_dist(rng) & 0x3);
+      uint8_t buffs[4];
+      for (auto &buff : buffs) {
+        buff = static_cast<uint8_t>(10 + small_dist(rng));
+      }
+      entity_out.WriteTag((8 << 3) | 2);
+      entity_out.WriteVarint32(sizeof(buffs));
+      entity_out.WriteRaw(buffs, sizeof(buffs));
+    }
+
+    out.WriteTag((1 << 3) | 2);
+    out.WriteVarint32(static_cast<uint32_t>(entity.size()));
+    out.WriteString(entity);
+  }
+  out.Trim();
+  return payload;
+}
+
+/// 生成一组包体
+///  @param[in]   seed        随机种子
+///  @param[in]   count       包体数
+///  @param[in]   size        包体最小长度
+///  @return 包体
+std::vector<std::string> MakePayloads(uint32_t seed, size_t count,
+                                      size_t size) {
+  std::mt19937 rng(seed);
+  std::vector<std::string> payloads;
+  for (size_t i = 0; i < count; ++i) {
+    payloads.emplace_back(MakePayload(rng, size));
+  }
+  return payloads;
+}
+
+/// 解析帧并解压
+///  @param[in]   codec       编解码器
+///  @param[in]   frame       帧
+///  @param[out]  header      包头
+///  @param[out]  packet      包体
+///  @return 成功返回true
+bool DecodeFrame(FrameCodec &codec, const MessageBuffer &frame,
+                 protocol::Header &header, MessageBuffer &packet) {
+  const uint8_t *data = frame.GetBasePointer();
+  uint16_t header_length = *reinterpret_cast<const uint16_t *>(data);
+  EndianRefMakeLittle(header_length);
+  if (!header.ParseFromArray(data + kHeaderBytes, header_length)) {
+    return false;
+  }
+
+  const uint8_t *body = data + kHeaderBytes + header_length;
+  if (header.flags() & kHeaderFlagCompressed) {
+    return codec.DecompressPacket(header, body, header.size(),
+                                  (std::numeric_limits<size_t>::max)(), packet);
+  }
+
+  packet.Resize(header.size());
+  packet.Reset();
+  packet.Write(body, header.size());
+  return true;
+}
+
+/// 编解码基准
+///  @param[in]   name        组名
+///  @param[in]   options     压缩参数
+///  @param[in]   payloads    包体
+///  @param[in]   rounds      重复次数
+///  @param[out]  ratio       压缩后与压缩前的包体总长之比
+///  @return 往返后的数据一致返回true
+bool CodecBench(const std::string &name,
+                const std::shared_ptr<const FrameCompressOptions> &options,
+                const std::vector<std::string> &payloads, size_t rounds,
+                double &ratio) {
+  std::vector<MessageBuffer> frames;
+  size_t raw_bytes = 0;
+  for (const auto &payload : payloads) {
+    frames.emplace_back(MakeFrame(payload.data(), payload.size()));
+    raw_bytes += frames.back().GetBufferSize();
+  }
+
+  FrameCodec sender(options);
+  FrameCodec receiver(options);
+
+  std::vector<MessageBuffer> compressed(frames.size(), MessageBuffer(0));
+  size_t compressed_bytes = 0;
+  auto t1                 = SteadyClock::now();
+  for (size_t round = 0; round < rounds; ++round) {
+    compressed_bytes = 0;
+    for (size_t i = 0; i < frames.size(); ++i) {
+      if (!sender.CompressFrame(frames[i].GetBasePointer(),
+                                frames[i].GetBufferSize(), compressed[i])) {
+        compressed[i] = frames[i];
+      }
+      compressed_bytes += compressed[i].GetBufferSize();
+    }
+  }
+  auto t2 = SteadyClock::now();
+
+  bool ok = true;
+  protocol::Header header;
+  MessageBuffer packet(0);
+  for (size_t round = 0; round < rounds; ++round) {
+    for (size_t i = 0; i < compressed.size(); ++i) {
+      if (!DecodeFrame(receiver, compressed[i], header, packet)) {
+        ok = false;
+      } else if (0 == round) {
+        ok = ok && (payloads[i].size() == packet.GetActiveSize()) &&
+             (0 == memcmp(payloads[i].data(), packet.GetReadPointer(),
+                          payloads[i].size())) &&
+             (0 == header.flags()) && (7 == header.method_id());
+      }
+    }
+  }
+  auto t3 = SteadyClock::now();
+
+  double mb = static_cast<double>(raw_bytes * rounds) / (1024 * 1024);
+  ratio     = static_cast<double>(compressed_bytes) / raw_bytes;
+  LOG_INFO(
+      "{:<16} frames {} x {} raw {} wire {} ratio {:.3f} deflate {:.0f} us/MB "
+      "inflate {:.0f} us/MB roundtrip {}",
+      name, frames.size(), rounds, raw_bytes, compressed_bytes, ratio,
+      std::chrono::duration<double, std::micro>(t2 - t1).count() / mb,
+      std::chrono::duration<double, std::micro>(t3 - t2).count() / mb, ok);
+  return ok;
+}
+
+/// 读取一个完整的帧
+///  @param[in]   socket      套接字
+///  @param[out]  frame       帧
+///  @return 成功返回true
+bool ReadFrame(asio::ip::tcp::socket &socket, MessageBuffer &frame) {
+  std::error_code ec;
+  uint16_t header_length = 0;
+  asio::read(socket, asio::buffer(&header_length, kHeaderBytes), ec);
+  if (ec) {
+    return false;
+  }
+  EndianRefMakeLittle(header_length);
+
+  std::vector<uint8_t> header_data(header_length);
+  asio::read(socket, asio::buffer(header_data), ec);
+  protocol::Header header;
+  if (ec || !header.ParseFromArray(header_data.data(), header_length)) {
+    return false;
+  }
+
+  std::vector<uint8_t> body(header.size());
+  asio::read(socket, asio::buffer(body), ec);
+  if (ec) {
+    return false;
+  }
+
+  uint16_t header_bytes = header_length;
+  EndianRefMakeLittle(header_bytes);
+  frame.Resize(kHeaderBytes + header_length + body.size());
+  frame.Reset();
+  frame.Write(&header_bytes, kHeaderBytes);
+  frame.Write(header_data.data(), header_data.size());
+  frame.Write(body.data(), body.size());
+  return true;
+}
+
+/// 端到端验证
+/// 客户端发送压缩帧，服务器解压后回显，回显的帧由服务器压缩，
+/// 最后发送字典不一致的帧，服务器应该断开连接
+///  @param[in]   options     双方的压缩参数
+///  @param[in]   payloads    包体
+///  @return 成功返回true
+bool EchoBench(const std::shared_ptr<const FrameCompressOptions> &options,
+               const std::vector<std::string> &payloads) {
+  CompressServer server(1);
+  TcpServerOptions server_options;
+  server_options.compress = options;
+  server.SetServerOptions(server_options);
+  if (!server.Start("127.0.0.1", "9994")) {
+    LOG_ERROR("compress server start error");
+    return false;
+  }
+
+  asio::io_context context(1);
+  asio::ip::tcp::socket socket(context);
+  std::error_code ec;
+  socket.connect(
+      asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), 9994), ec);
+  if (ec) {
+    LOG_ERROR("compress client connect error {}", ec);
+    return false;
+  }
+
+  FrameCodec codec(options);
+  MessageBuffer compressed(0);
+  MessageBuffer echo(0);
+  MessageBuffer packet(0);
+  protocol::Header header;
+  size_t raw_bytes  = 0;
+  size_t sent_bytes = 0;
+  size_t recv_bytes = 0;
+  size_t recv_compressed = 0;
+  bool ok = true;
+  for (const auto &payload : payloads) {
+    MessageBuffer frame = MakeFrame(payload.data(), payload.size());
+    raw_bytes += frame.GetBufferSize();
+    const MessageBuffer *send = &frame;
+    if (codec.CompressFrame(frame.GetBasePointer(), frame.GetBufferSize(),
+                            compressed)) {
+      send = &compressed;
+    }
+    sent_bytes += send->GetBufferSize();
+    asio::write(socket,
+                asio::buffer(send->GetBasePointer(), send->GetBufferSize()),
+                ec);
+
+    if (ec || !ReadFrame(socket, echo)) {
+      ok = false;
+      break;
+    }
+    recv_bytes += echo.GetBufferSize();
+
+    uint16_t header_length =
+        *reinterpret_cast<const uint16_t *>(echo.GetBasePointer());
+    EndianRefMakeLittle(header_length);
+    header.ParseFromArray(echo.GetBasePointer() + kHeaderBytes, header_length);
+    if (header.flags() & kHeaderFlagCompressed) {
+      ++recv_compressed;
+    }
+
+    ok = ok && DecodeFrame(codec, echo, header, packet) &&
+         (payload.size() == packet.GetActiveSize()) &&
+         (0 == memcmp(payload.data(), packet.GetReadPointer(), payload.size()));
+  }
+
+  // 用不同的字典压缩，服务器解压失败后断开
+  auto other_options        = std::make_shared<FrameCompressOptions>(*options);
+  other_options->dictionary = std::make_shared<const std::string>(
+      FrameCodec::TrainDictionary(MakePayloads(99, 64, 1024), 4096));
+  FrameCodec other(other_options);
+  MessageBuffer frame =
+      MakeFrame(payloads.front().data(), payloads.front().size());
+  bool mismatch_closed = false;
+  if (other.CompressFrame(frame.GetBasePointer(), frame.GetBufferSize(),
+                          compressed)) {
+    asio::write(socket,
+                asio::buffer(compressed.GetBasePointer(),
+                             compressed.GetBufferSize()),
+                ec);
+    mismatch_closed = !ReadFrame(socket, echo);
+  }
+
+  LOG_INFO(
+      "echo frames {} raw {} sent {} received {} compressed echoes {} "
+      "roundtrip {} mismatched dictionary closed {}",
+      payloads.size(), raw_bytes, sent_bytes, recv_bytes, recv_compressed, ok,
+      mismatch_closed);
+
+  socket.close(ec);
+  server.Stop();
+  return ok && mismatch_closed && (recv_compressed == payloads.size());
+}
+
+/// 发送一个帧，服务器应该断开连接
+///  @param[in]   name        用例名
+///  @param[in]   options     服务器的压缩参数，可以为空
+///  @param[in]   frame       帧
+///  @return 服务器断开返回true
+bool ExpectClosed(const char *name,
+                  const std::shared_ptr<const FrameCompressOptions> &options,
+                  const MessageBuffer &frame) {
+  CompressServer server(1);
+  TcpServerOptions server_options;
+  server_options.compress = options;
+  server.SetServerOptions(server_options);
+  if (!server.Start("127.0.0.1", "9994")) {
+    LOG_ERROR("compress server start error");
+    return false;
+  }
+
+  asio::io_context context(1);
+  asio::ip::tcp::socket socket(context);
+  std::error_code ec;
+  socket.connect(
+      asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), 9994), ec);
+  asio::write(socket,
+              asio::buffer(frame.GetBasePointer(), frame.GetBufferSize()), ec);
+
+  MessageBuffer echo(0);
+  bool closed = !ec && !ReadFrame(socket, echo);
+  LOG_INFO("{} closed {}", name, closed);
+
+  socket.close(ec);
+  server.Stop();
+  return closed;
+}
+
+/// 对端构造的压缩帧
+/// 声明的解压长度超过上限时，服务器不按它申请内存，直接断开；
+/// 没有设置压缩参数的服务器不接受压缩帧
+///  @param[in]   options     压缩参数
+///  @param[in]   payload     包体
+///  @return 两种情况服务器都断开返回true
+bool RejectBench(const std::shared_ptr<const FrameCompressOptions> &options,
+                 const std::string &payload) {
+  protocol::Header header;
+  header.set_service_hash(0x5a17c0de);
+  header.set_method_id(7);
+  header.set_flags(kHeaderFlagCompressed);
+  header.set_raw_size((std::numeric_limits<uint32_t>::max)());
+  header.set_size(8);
+
+  uint16_t header_length = static_cast<uint16_t>(header.ByteSizeLong());
+  uint16_t header_bytes  = header_length;
+  EndianRefMakeLittle(header_bytes);
+  MessageBuffer bomb(kHeaderBytes + header_length + header.size());
+  bomb.Write(&header_bytes, kHeaderBytes);
+  header.SerializeWithCachedSizesToArray(bomb.GetWritePointer());
+  bomb.WriteCompleted(header_length);
+  const uint8_t garbage[8] = {0x78, 0x01, 0xed, 0xc1, 0x01, 0x0d, 0x00, 0x00};
+  bomb.Write(garbage, sizeof(garbage));
+
+  FrameCodec codec(options);
+  MessageBuffer frame = MakeFrame(payload.data(), payload.size());
+  MessageBuffer compressed(0);
+  if (!codec.CompressFrame(frame.GetBasePointer(), frame.GetBufferSize(),
+                           compressed)) {
+    LOG_ERROR("compress reject payload not compressed");
+    return false;
+  }
+
+  bool bomb_closed  = ExpectClosed("oversized raw_size", options, bomb);
+  bool plain_closed = ExpectClosed("compressed frame without options",
+                                   nullptr, compressed);
+  return bomb_closed && plain_closed;
+}
+
+int main(int argc, char *argv[]) {
+  if (auto error =
+          g_config->Load(_TPN_NET_BASE_COMPRESS_CONFIG_TEST_FILE, {})) {
+    printf("Error in config file: %s\n", (*error).c_str());
+    return 1;
+  }
+
+  tpn::log::Init();
+  std::shared_ptr<void> log_handle(nullptr,
+                                   [](void *) { tpn::log::Shutdown(); });
+
+  size_t count  = argc > 1 ? std::stoul(argv[1]) : 256;
+  size_t rounds = argc > 2 ? std::stoul(argv[2]) : 8;
+
+  // 训练样本与测试包体使用不同的随机种子
+  auto samples = MakePayloads(1, 512, 1024);
+
+  auto plain      = std::make_shared<FrameCompressOptions>();
+  plain->enable   = true;
+  auto small_dict = std::make_shared<FrameCompressOptions>(*plain);
+  small_dict->dictionary = std::make_shared<const std::string>(
+      FrameCodec::TrainDictionary(samples, 4096));
+  auto large_dict = std::make_shared<FrameCompressOptions>(*plain);
+  large_dict->dictionary = std::make_shared<const std::string>(
+      FrameCodec::TrainDictionary(samples, kFrameDictionaryMaxSize));
+  LOG_INFO("dictionary sizes {} {}", small_dict->dictionary->size(),
+           large_dict->dictionary->size());
+
+  bool ok          = true;
+  bool dict_better = true;
+  for (size_t size : {1024, 4096, 16384}) {
+    auto payloads = MakePayloads(static_cast<uint32_t>(size), count, size);
+    double plain_ratio = 0;
+    double small_ratio = 0;
+    double large_ratio = 0;
+    ok = CodecBench(fmt::format("{}B no dict", size), plain, payloads, rounds,
+                    plain_ratio) &&
+         ok;
+    ok = CodecBench(fmt::format("{}B dict 4K", size), small_dict, payloads,
+                    rounds, small_ratio) &&
+         ok;
+    ok = CodecBench(fmt::format("{}B dict 32K", size), large_dict, payloads,
+                    rounds, large_ratio) &&
+         ok;
+    if (1024 == size) {
+      dict_better = small_ratio < plain_ratio && large_ratio < plain_ratio;
+    }
+  }
+
+  ok = EchoBench(small_dict, MakePayloads(2, 64, 2048)) && ok;
+  ok = RejectBench(small_dict, MakePayloads(3, 1, 2048).front()) && ok;
+
+  // 小包最依赖字典
+  if (!ok || !dict_better) {
+    LOG_ERROR("Compress bench failed ok {} dictionary better {}", ok,
+              dict_better);
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,181 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "log.h"
+#include "config.h"
+#include "chrono_wrap.h"
+
+#include "net.h"
+
+#include "../../alloc_counter.h"
+#include "../test_receiver.h"
+
+#ifndef _TPN_NET_BASE_EVENT_CONFIG_TEST_FILE
+#  define _TPN_NET_BASE_EVENT_CONFIG_TEST_FILE "config_net_base_event_test.json"
+#endif
+
+using namespace tpn;
+using namespace tpn::net;
+
+/// 稳定后每条消息允许的堆申请次数，不含消息缓冲池自身向全局堆的申请
+static constexpr double kEventAllocationsPerMessage = 0.05;
+
+/// 一轮发送的结果
+struct EventResult {
+  size_t messages{0};     ///< 消息数
+  uint64_t allocations{0};  ///< 发送路径的堆申请次数
+  double seconds{0};      ///< 发送到全部收到的耗时
+};
+
+/// 发送消息并统计
+///  @tparam      SendFunc    发送函数类型 void(std::shared_ptr<TcpSession> &)
+///  @param[in]   sessions    会话
+///  @param[in]   receiver    接收端
+///  @param[in]   messages    每个会话的消息数
+///  @param[in]   size        消息大小
+///  @param[in]   send        发送函数
+///  @return 统计结果
+template <typename SendFunc>
+EventResult Measure(std::vector<std::shared_ptr<TcpSession>> &sessions,
+                    const TestReceiver &receiver, size_t messages,
+                    size_t size, SendFunc &&send) {
+  EventResult result;
+  result.messages = messages * sessions.size();
+
+  size_t total       = receiver.GetTotal() + result.messages * size;
+  uint64_t allocated = g_heap_allocations.load();
+  size_t pooled      = BufferPool::GetStats().heap_allocations;
+  auto t1            = SteadyClock::now();
+  for (auto &session : sessions) {
+    send(session);
+  }
+  if (!WaitReceived(receiver, total)) {
+    result.messages = 0;
+  }
+  result.seconds = std::chrono::duration<double>(SteadyClock::now() - t1).count();
+  // 一轮的消息同时在队列中，消息缓冲超出池的缓存上限时会向全局堆申请，
+  // 这部分与事件队列无关，单独扣除
+  result.allocations = g_heap_allocations.load() - allocated -
+                       (BufferPool::GetStats().heap_allocations - pooled);
+  return result;
+}
+
+/// 会话事件队列基准
+///  @param[in]   count       会话数
+///  @param[in]   messages    每个会话的消息数
+///  @param[in]   size        消息大小
+///  @return 成功返回true
+bool EventBench(size_t count, size_t messages, size_t size) {
+  TcpServer server(2);
+  if (!server.Start("127.0.0.1", "9993")) {
+    LOG_ERROR("event server start error");
+    return false;
+  }
+
+  TestReceiver receiver(65536);
+  size_t connected = receiver.Connect(count, 9993);
+
+  auto t1 = SteadyClock::now();
+  while (connected != server.GetSessionCount() &&
+         SteadyClock::now() - t1 < std::chrono::seconds(30)) {
+    std::this_thread::sleep_for(1ms);
+  }
+
+  std::vector<std::shared_ptr<TcpSession>> sessions;
+  server.ApplyAllSession([&sessions](std::shared_ptr<TcpSession> &session) {
+    sessions.emplace_back(session);
+  });
+
+  MessageBuffer payload(size);
+  std::fill_n(payload.GetWritePointer(), size, static_cast<uint8_t>('e'));
+  payload.WriteCompleted(size);
+
+  auto from_strand = [&](std::shared_ptr<TcpSession> &session) {
+    session->Post([session, &payload, messages]() {
+      for (size_t i = 0; i < messages; ++i) {
+        session->Send(MessageBuffer(payload));
+      }
+    });
+  };
+  auto from_thread = [&](std::shared_ptr<TcpSession> &session) {
+    for (size_t i = 0; i < messages; ++i) {
+      session->Send(MessageBuffer(payload));
+    }
+  };
+
+  // 预热，让缓冲池、处理程序缓存和事件队列长到稳定的大小
+  Measure(sessions, receiver, messages, size, from_strand);
+  Measure(sessions, receiver, messages, size, from_thread);
+
+  bool ok = true;
+  for (auto &[name, result] :
+       {std::make_pair("strand", Measure(sessions, receiver, messages, size,
+                                         from_strand)),
+        std::make_pair("thread", Measure(sessions, receiver, messages, size,
+                                         from_thread))}) {
+    double per_msg = result.messages > 0
+                         ? static_cast<double>(result.allocations) /
+                               result.messages
+                         : 0;
+    LOG_INFO(
+        "Send from {} sessions {} messages {} size {} msgs/s {:.0f} "
+        "allocations/msg {:.3f}",
+        name, connected, result.messages, size,
+        result.messages / result.seconds, per_msg);
+    ok = ok && (result.messages == messages * connected) &&
+         (per_msg < kEventAllocationsPerMessage);
+  }
+
+  sessions.clear();
+  server.Stop();
+  receiver.Stop();
+  return ok && connected == count;
+}
+
+int main(int argc, char *argv[]) {
+  if (auto error = g_config->Load(_TPN_NET_BASE_EVENT_CONFIG_TEST_FILE, {})) {
+    printf("Error in config file: %s\n", (*error).c_str());
+    return 1;
+  }
+
+  tpn::log::Init();
+  std::shared_ptr<void> log_handle(nullptr,
+                                   [](void *) { tpn::log::Shutdown(); });
+
+  size_t count    = argc > 1 ? std::stoul(argv[1]) : 64;
+  size_t messages = argc > 2 ? std::stoul(argv[2]) : 20000;
+
+  if (!EventBench(count, messages, 64)) {
+    LOG_ERROR("Event bench failed");
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,260 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <atomic>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fstream>
+
+#include "log.h"
+#include "config.h"
+#include "chrono_wrap.h"
+
+#include "net.h"
+
+#ifndef _TPN_NET_BASE_IDLE_CONFIG_TEST_FILE
+#  define _TPN_NET_BASE_IDLE_CONFIG_TEST_FILE "config_net_base_idle_test.json"
+#endif
+
+using namespace tpn;
+using namespace tpn::net;
+
+/// 获取进程常驻内存，非linux平台返回0
+///  @return 常驻内存字节数
+size_t GetResidentSize() {
+#if (TPN_PLATFORM == TPN_PLATFORM_UNIX)
+  std::ifstream statm("/proc/self/statm");
+  size_t total = 0, resident = 0;
+  if (statm >> total >> resident) {
+    return resident * 4096;
+  }
+#endif
+  return 0;
+}
+
+/// 静默超时短的tcp会话
+class TcpSessionIdle
+    : public TcpSessionBase<TcpSessionIdle, TemplateArgsTcpSession> {
+ public:
+  template <typename... Args>
+  explicit TcpSessionIdle(Args &&...args)
+      : TcpSessionBase<TcpSessionIdle, TemplateArgsTcpSession>(
+            std::forward<Args>(args)...) {
+    this->SetSilenceTimeoutDuration(MilliSeconds(1500));
+  }
+};
+
+/// 不发数据的连接应当在静默超时后被断开
+///  @param[in]   count     连接数
+///  @return 成功返回true
+bool SilenceTimeoutTest(size_t count) {
+  TcpServerBridge<TcpSessionIdle> server(2);
+  if (!server.Start("127.0.0.1", "9995")) {
+    LOG_ERROR("idle server start error");
+    return false;
+  }
+
+  asio::io_context context(1);
+  asio::ip::tcp::endpoint endpoint(asio::ip::make_address("127.0.0.1"), 9995);
+  std::vector<asio::ip::tcp::socket> sockets;
+  for (size_t i = 0; i < count; ++i) {
+    std::error_code ec;
+    sockets.emplace_back(context).connect(endpoint, ec);
+  }
+
+  auto t1 = SteadyClock::now();
+  while (count != server.GetSessionCount() &&
+         SteadyClock::now() - t1 < std::chrono::seconds(5)) {
+    std::this_thread::sleep_for(1ms);
+  }
+  size_t connected = server.GetSessionCount();
+
+  while (0 != server.GetSessionCount() &&
+         SteadyClock::now() - t1 < std::chrono::seconds(10)) {
+    std::this_thread::sleep_for(10ms);
+  }
+  auto cost = std::chrono::duration_cast<MilliSeconds>(SteadyClock::now() - t1);
+
+  LOG_INFO("Silence timeout sessions {}/{} released in {}ms, left {}",
+           connected, count, cost.count(), server.GetSessionCount());
+
+  bool ok = (count == connected && 0 == server.GetSessionCount() &&
+             cost >= MilliSeconds(1500));
+  server.Stop();
+  return ok;
+}
+
+/// 每个会话一个asio定时器，模拟原来的静默定时器
+///  @param[in]   count     会话数
+///  @param[in]   rounds    每个定时器到期次数
+///  @param[in]   timeout   超时时长
+void TimerBench(size_t count, size_t rounds, MilliSeconds timeout) {
+  asio::io_context context(1);
+  asio::io_context::strand strand(context);
+
+  size_t rss = GetResidentSize();
+  std::vector<std::unique_ptr<asio::steady_timer>> timers;
+  std::vector<size_t> fired(count, 0);
+  timers.reserve(count);
+
+  std::function<void(size_t)> post = [&](size_t i) {
+    timers[i]->expires_after(timeout);
+    timers[i]->async_wait(
+        asio::bind_executor(strand, [&, i](const std::error_code &ec) {
+          if (!ec && ++fired[i] < rounds) {
+            post(i);
+          }
+        }));
+  };
+
+  auto t1 = SteadyClock::now();
+  std::clock_t c1 = std::clock();
+  for (size_t i = 0; i < count; ++i) {
+    timers.emplace_back(std::make_unique<asio::steady_timer>(context));
+    post(i);
+  }
+  size_t armed_rss = GetResidentSize();
+
+  context.run();
+
+  LOG_INFO(
+      "asio timers {} rounds {} per session {}B rss {}KB cpu {}ms wall {}ms",
+      count, rounds, sizeof(asio::steady_timer),
+      (static_cast<int64_t>(armed_rss) - static_cast<int64_t>(rss)) / 1024,
+      (std::clock() - c1) * 1000 / CLOCKS_PER_SEC,
+      std::chrono::duration_cast<MilliSeconds>(SteadyClock::now() - t1)
+          .count());
+}
+
+/// 空闲回收器基准
+struct ReaperBenchContext {
+  IdleReaper *reaper{nullptr};
+  IdleNode *nodes{nullptr};
+  std::vector<size_t> fired;
+  size_t rounds{0};
+  SteadyClock::duration timeout;
+};
+
+/// 所有节点登记到一个空闲回收器
+///  @param[in]   count     会话数
+///  @param[in]   rounds    每个节点到期次数
+///  @param[in]   timeout   超时时长
+void ReaperBench(size_t count, size_t rounds, MilliSeconds timeout) {
+  asio::io_context context(1);
+  asio::io_context::strand strand(context);
+
+  size_t rss = GetResidentSize();
+  IdleReaper reaper(strand, timeout / 10);
+  std::unique_ptr<IdleNode[]> nodes(new IdleNode[count]);
+
+  ReaperBenchContext bench;
+  bench.reaper  = &reaper;
+  bench.nodes   = nodes.get();
+  bench.fired   = std::vector<size_t>(count, 0);
+  bench.rounds  = rounds;
+  bench.timeout = timeout;
+
+  auto t1 = SteadyClock::now();
+  std::clock_t c1 = std::clock();
+  asio::post(strand, [&]() {
+    for (size_t i = 0; i < count; ++i) {
+      nodes[i].owner  = &bench;
+      nodes[i].expire = [](IdleNode &node) {
+        auto *bench = static_cast<ReaperBenchContext *>(node.owner);
+        size_t i    = static_cast<size_t>(&node - bench->nodes);
+        if (++bench->fired[i] < bench->rounds) {
+          bench->reaper->Link(node, bench->timeout);
+        }
+      };
+      reaper.Link(nodes[i], timeout);
+    }
+  });
+  context.run_one();
+  size_t armed_rss = GetResidentSize();
+
+  context.run();
+
+  LOG_INFO(
+      "idle reaper {} rounds {} per session {}B rss {}KB cpu {}ms wall {}ms",
+      count, rounds, sizeof(IdleNode),
+      (static_cast<int64_t>(armed_rss) - static_cast<int64_t>(rss)) / 1024,
+      (std::clock() - c1) * 1000 / CLOCKS_PER_SEC,
+      std::chrono::duration_cast<MilliSeconds>(SteadyClock::now() - t1)
+          .count());
+
+  // 收包时更新存活时间的开销
+  asio::post(strand, [&]() {
+    IdleNode node;
+    reaper.Link(node, timeout);
+
+    constexpr size_t kLoop = 10000000;
+    int64_t sum = 0;
+
+    auto t2 = SteadyClock::now();
+    for (size_t i = 0; i < kLoop; ++i) {
+      sum += SystemClock::now().time_since_epoch().count() & 1;
+    }
+    auto t3 = SteadyClock::now();
+    for (size_t i = 0; i < kLoop; ++i) {
+      sum += reaper.GetNow().time_since_epoch().count() & 1;
+    }
+    auto t4 = SteadyClock::now();
+
+    reaper.Unlink(node);
+
+    LOG_INFO("alive time {} updates system clock {}ms cached clock {}ms ({})",
+             kLoop, std::chrono::duration_cast<MilliSeconds>(t3 - t2).count(),
+             std::chrono::duration_cast<MilliSeconds>(t4 - t3).count(), sum);
+  });
+  context.restart();
+  context.run();
+}
+
+int main(int argc, char *argv[]) {
+  if (auto error = g_config->Load(_TPN_NET_BASE_IDLE_CONFIG_TEST_FILE, {})) {
+    printf("Error in config file: %s\n", (*error).c_str());
+    return 1;
+  }
+
+  tpn::log::Init();
+  std::shared_ptr<void> log_handle(nullptr,
+                                   [](void *) { tpn::log::Shutdown(); });
+
+  size_t count  = argc > 1 ? std::stoul(argv[1]) : 100000;
+  size_t rounds = argc > 2 ? std::stoul(argv[2]) : 5;
+
+  LOG_INFO("Idle bench sessions {} rounds {}", count, rounds);
+
+  // 先测回收器，避免复用定时器测试释放的内存导致常驻内存统计偏小
+  ReaperBench(count, rounds, MilliSeconds(200));
+  TimerBench(count, rounds, MilliSeconds(200));
+
+  if (!SilenceTimeoutTest(200)) {
+    LOG_ERROR("Silence timeout test failed");
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,265 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <atomic>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fstream>
+
+#include "log.h"
+#include "config.h"
+#include "chrono_wrap.h"
+
+#include "net.h"
+
+#ifndef _TPN_NET_BASE_POST_CONFIG_TEST_FILE
+#  define _TPN_NET_BASE_POST_CONFIG_TEST_FILE "config_net_base_post_test.json"
+#endif
+
+using namespace tpn;
+using namespace tpn::net;
+
+/// 获取进程常驻内存，非linux平台返回0
+///  @return 常驻内存字节数
+size_t GetResidentSize() {
+#if (TPN_PLATFORM == TPN_PLATFORM_UNIX)
+  std::ifstream statm("/proc/self/statm");
+  size_t total = 0, resident = 0;
+  if (statm >> total >> resident) {
+    return resident * 4096;
+  }
+#endif
+  return 0;
+}
+
+/// 延迟任务基准统计
+struct PostBenchResult {
+  size_t fired{0};                    ///< 执行的任务数
+  SteadyClock::duration early{0};     ///< 最大提前量
+  SteadyClock::duration late{0};      ///< 最大延后量
+};
+
+/// 每个延迟任务一个asio定时器，模拟原来的 PostWrap::Post(func, delay)
+///  @param[in]   count     任务数
+///  @param[in]   spread    延迟分布范围
+void TimerBench(size_t count, MilliSeconds spread) {
+  asio::io_context context(1);
+  asio::io_context::strand strand(context);
+  PostBenchResult result;
+
+  size_t rss = GetResidentSize();
+  auto t1 = SteadyClock::now();
+  std::clock_t c1 = std::clock();
+  for (size_t i = 0; i < count; ++i) {
+    auto delay = MilliSeconds(i % spread.count());
+    auto due   = SteadyClock::now() + delay;
+    auto timer = std::make_unique<asio::steady_timer>(context);
+    timer->expires_after(delay);
+    auto &timer_ref = *timer;
+    timer_ref.async_wait(asio::bind_executor(
+        strand, [&result, due, timer = std::move(timer)](
+                    const std::error_code &ec) mutable {
+          ++result.fired;
+          result.late = (std::max)(result.late, SteadyClock::now() - due);
+        }));
+  }
+  size_t armed_rss = GetResidentSize();
+  auto post_cost   = SteadyClock::now() - t1;
+
+  context.run();
+
+  LOG_INFO(
+      "asio timers {}/{} post {}ms rss {}KB cpu {}ms wall {}ms late {}ms",
+      result.fired, count,
+      std::chrono::duration_cast<MilliSeconds>(post_cost).count(),
+      (static_cast<int64_t>(armed_rss) - static_cast<int64_t>(rss)) / 1024,
+      (std::clock() - c1) * 1000 / CLOCKS_PER_SEC,
+      std::chrono::duration_cast<MilliSeconds>(SteadyClock::now() - t1).count(),
+      std::chrono::duration_cast<MilliSeconds>(result.late).count());
+}
+
+/// 所有延迟任务登记到一个时间轮
+///  @param[in]   count     任务数
+///  @param[in]   spread    延迟分布范围
+///  @return 全部任务按时执行返回true
+bool WheelBench(size_t count, MilliSeconds spread) {
+  asio::io_context context(1);
+  asio::io_context::strand strand(context);
+  PostBenchResult result;
+
+  size_t rss = GetResidentSize();
+  TimerWheel wheel(strand);
+  LinkedListHead owner;
+
+  auto t1 = SteadyClock::now();
+  std::clock_t c1 = std::clock();
+  asio::post(strand, [&]() {
+    for (size_t i = 0; i < count; ++i) {
+      auto delay = MilliSeconds(i % spread.count());
+      auto due   = SteadyClock::now() + delay;
+      wheel.Add(MakeTimerWheelTask(
+                    [&result, due]() {
+                      auto now = SteadyClock::now();
+                      ++result.fired;
+                      result.early = (std::max)(result.early, due - now);
+                      result.late  = (std::max)(result.late, now - due);
+                    },
+                    nullptr),
+                delay, owner);
+    }
+  });
+  context.run_one();
+  size_t armed_rss = GetResidentSize();
+  auto post_cost   = SteadyClock::now() - t1;
+
+  context.run();
+
+  LOG_INFO(
+      "timer wheel {}/{} post {}ms rss {}KB cpu {}ms wall {}ms late {}ms "
+      "early {}us",
+      result.fired, count,
+      std::chrono::duration_cast<MilliSeconds>(post_cost).count(),
+      (static_cast<int64_t>(armed_rss) - static_cast<int64_t>(rss)) / 1024,
+      (std::clock() - c1) * 1000 / CLOCKS_PER_SEC,
+      std::chrono::duration_cast<MilliSeconds>(SteadyClock::now() - t1).count(),
+      std::chrono::duration_cast<MilliSeconds>(result.late).count(),
+      std::chrono::duration_cast<MicroSeconds>(result.early).count());
+
+  return count == result.fired && 0 == wheel.GetSize() &&
+         result.early <= SteadyClock::duration::zero();
+}
+
+/// 时间轮任务节点从缓冲池申请，预热后反复登记不再向全局堆申请
+///  @param[in]   count     每轮任务数
+///  @return 成功返回true
+bool WheelPoolTest(size_t count) {
+  asio::io_context context(1);
+  asio::io_context::strand strand(context);
+  TimerWheel wheel(strand);
+  LinkedListHead owner;
+  size_t fired = 0;
+
+  auto round = [&]() {
+    asio::post(strand, [&]() {
+      for (size_t i = 0; i < count; ++i) {
+        wheel.Add(MakeTimerWheelTask([&fired]() { ++fired; }, nullptr),
+                  MilliSeconds(i % 20), owner);
+      }
+    });
+    context.restart();
+    context.run();
+  };
+
+  round();
+  auto allocations = BufferPool::GetStats().heap_allocations;
+  round();
+  round();
+  allocations = BufferPool::GetStats().heap_allocations - allocations;
+
+  LOG_INFO("timer wheel pool rounds 2 tasks {} fired {} heap allocations {}",
+           count, fired, allocations);
+  return 3 * count == fired && 0 == allocations;
+}
+
+/// 服务器上的延迟任务，停止时未到期的任务应当立即执行
+///  @return 成功返回true
+bool ServerPostTest() {
+  TcpServer server(1);
+  if (!server.Start("127.0.0.1", "9994")) {
+    LOG_ERROR("post server start error");
+    return false;
+  }
+
+  std::atomic<size_t> fired{0};
+  std::atomic<int64_t> min_delay{INT64_MAX};
+  auto t1 = SteadyClock::now();
+  for (size_t i = 0; i < 100; ++i) {
+    server.Post(
+        [&]() {
+          auto cost =
+              std::chrono::duration_cast<MilliSeconds>(SteadyClock::now() - t1)
+                  .count();
+          int64_t expected = min_delay.load();
+          while (cost < expected &&
+                 !min_delay.compare_exchange_weak(expected, cost)) {
+          }
+          ++fired;
+        },
+        MilliSeconds(50));
+  }
+
+  auto future = server.Post([]() { return 42; }, MilliSeconds(20),
+                            asio::use_future);
+  int value = future.get();
+
+  while (100 != fired && SteadyClock::now() - t1 < std::chrono::seconds(5)) {
+    std::this_thread::sleep_for(1ms);
+  }
+
+  std::atomic<size_t> stopped{0};
+  for (size_t i = 0; i < 10; ++i) {
+    server.Post([&]() { ++stopped; }, std::chrono::seconds(60));
+  }
+  server.Stop();
+
+  LOG_INFO("Server post fired {} min delay {}ms future {} flushed on stop {}",
+           fired.load(), min_delay.load(), value, stopped.load());
+
+  return 100 == fired && min_delay >= 50 && 42 == value && 10 == stopped;
+}
+
+int main(int argc, char *argv[]) {
+  if (auto error = g_config->Load(_TPN_NET_BASE_POST_CONFIG_TEST_FILE, {})) {
+    printf("Error in config file: %s\n", (*error).c_str());
+    return 1;
+  }
+
+  tpn::log::Init();
+  std::shared_ptr<void> log_handle(nullptr,
+                                   [](void *) { tpn::log::Shutdown(); });
+
+  size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+  LOG_INFO("Post bench tasks {}", count);
+
+  // 先测时间轮，避免复用定时器测试释放的内存导致常驻内存统计偏小
+  if (!WheelBench(count, MilliSeconds(1000))) {
+    LOG_ERROR("Timer wheel bench failed");
+    return 1;
+  }
+  TimerBench(count, MilliSeconds(1000));
+
+  if (!WheelPoolTest(10000)) {
+    LOG_ERROR("Timer wheel pool test failed");
+    return 1;
+  }
+
+  if (!ServerPostTest()) {
+    LOG_ERROR("Server post test failed");
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,337 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <atomic>
+#include <ctime>
+#include <memory>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "log.h"
+#include "config.h"
+#include "chrono_wrap.h"
+
+#include "net.h"
+
+#ifndef _TPN_NET_BASE_REGISTRY_CONFIG_TEST_FILE
+#  define _TPN_NET_BASE_REGISTRY_CONFIG_TEST_FILE \
+    "config_net_base_registry_test.json"
+#endif
+
+using namespace tpn;
+using namespace tpn::net;
+
+/// 只用于注册表基准的会话，满足SessionMgr对会话类型的要求
+struct RegistrySession {
+  using key_type = size_t;
+
+  explicit RegistrySession(IoHandle &handle) : io_handle(handle) {}
+
+  const key_type GetHashKey() const {
+    return reinterpret_cast<key_type>(this);
+  }
+  IoHandle &GetIoHandle() { return this->io_handle; }
+  void Send(const SharedMessageBuffer &) {}
+
+  IoHandle &io_handle;
+  bool in_session_mgr_{false};
+  SessionHandle session_handle_{kInvalidSessionHandle};
+};
+
+/// 旧的注册表：一把读写锁保护一个哈希表
+class LegacyRegistry {
+ public:
+  void Emplace(const std::shared_ptr<RegistrySession> &session_sptr) {
+    std::unique_lock<std::shared_mutex> guard(this->mutex_);
+    this->sessions_.try_emplace(session_sptr->GetHashKey(), session_sptr);
+  }
+
+  void Erase(const std::shared_ptr<RegistrySession> &session_sptr) {
+    std::unique_lock<std::shared_mutex> guard(this->mutex_);
+    this->sessions_.erase(session_sptr->GetHashKey());
+  }
+
+  std::shared_ptr<RegistrySession> Find(size_t key) {
+    std::shared_lock<std::shared_mutex> guard(this->mutex_);
+    auto iter = this->sessions_.find(key);
+    return this->sessions_.end() == iter ? nullptr : iter->second;
+  }
+
+ private:
+  std::unordered_map<size_t, std::shared_ptr<RegistrySession>> sessions_;
+  std::shared_mutex mutex_;
+};
+
+/// 查找方式
+enum class LookupMode { kLegacy, kKey, kHandle };
+
+/// 并发查找基准
+/// 常驻会话之外，churn线程不断注册移除会话，查找线程随机查找常驻会话
+///  @param[in]   mode        查找方式
+///  @param[in]   resident    常驻会话数
+///  @param[in]   threads     查找线程数
+///  @param[in]   duration    持续时间
+///  @param[out]  lookups     查找次数
+///  @param[out]  churns      注册移除次数
+///  @return 所有查找都命中返回true
+bool LookupBench(LookupMode mode, size_t resident, size_t threads,
+                 MilliSeconds duration, size_t &lookups, size_t &churns) {
+  IoHandle io_handle;
+  SessionMgr<RegistrySession> session_mgr(io_handle);
+  LegacyRegistry legacy;
+
+  auto emplace = [&](const std::shared_ptr<RegistrySession> &session_sptr) {
+    if (LookupMode::kLegacy == mode) {
+      legacy.Emplace(session_sptr);
+    } else {
+      session_mgr.Emplace(session_sptr, [](bool) {});
+    }
+  };
+  auto erase = [&](const std::shared_ptr<RegistrySession> &session_sptr) {
+    if (LookupMode::kLegacy == mode) {
+      legacy.Erase(session_sptr);
+    } else {
+      session_mgr.Erase(session_sptr, [](bool) {});
+    }
+  };
+
+  std::vector<std::shared_ptr<RegistrySession>> sessions;
+  std::vector<size_t> keys;
+  std::vector<SessionHandle> handles;
+  for (size_t i = 0; i < resident; ++i) {
+    auto &session_sptr =
+        sessions.emplace_back(std::make_shared<RegistrySession>(io_handle));
+    emplace(session_sptr);
+    keys.emplace_back(session_sptr->GetHashKey());
+    handles.emplace_back(session_sptr->session_handle_);
+  }
+
+  std::atomic<bool> running{true};
+  std::atomic<size_t> total_lookups{0};
+  std::atomic<size_t> misses{0};
+  std::atomic<size_t> total_churns{0};
+
+  std::thread churn([&]() {
+    size_t count = 0;
+    std::vector<std::shared_ptr<RegistrySession>> batch(64);
+    while (running) {
+      for (auto &session_sptr : batch) {
+        session_sptr = std::make_shared<RegistrySession>(io_handle);
+        emplace(session_sptr);
+      }
+      for (auto &session_sptr : batch) {
+        erase(session_sptr);
+      }
+      count += batch.size();
+    }
+    total_churns = count;
+  });
+
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t]() {
+      std::minstd_rand random(static_cast<std::minstd_rand::result_type>(t));
+      size_t count = 0;
+      size_t miss  = 0;
+      while (running) {
+        for (size_t i = 0; i < 1024; ++i) {
+          size_t index = random() % resident;
+          std::shared_ptr<RegistrySession> session_sptr;
+          switch (mode) {
+            case LookupMode::kLegacy:
+              session_sptr = legacy.Find(keys[index]);
+              break;
+            case LookupMode::kKey:
+              session_sptr = session_mgr.Find(keys[index]);
+              break;
+            case LookupMode::kHandle:
+              session_sptr = session_mgr.Resolve(handles[index]);
+              break;
+          }
+          if (session_sptr != sessions[index]) {
+            ++miss;
+          }
+        }
+        count += 1024;
+      }
+      total_lookups += count;
+      misses += miss;
+    });
+  }
+
+  std::this_thread::sleep_for(duration);
+  running = false;
+  churn.join();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  lookups = total_lookups;
+  churns  = total_churns;
+
+  // 移除后旧句柄失效
+  bool ok = 0 == misses;
+  if (LookupMode::kLegacy != mode) {
+    erase(sessions.front());
+    ok = ok && !session_mgr.Resolve(handles.front()) &&
+         resident - 1 == session_mgr.GetSize();
+  }
+  return ok;
+}
+
+/// 真实服务器上连接不断建立断开时，用句柄跨线程查找会话
+///  @param[in]   threads     查找线程数
+///  @param[in]   rounds      连接断开轮数
+///  @param[in]   count       每轮连接数
+///  @return 成功返回true
+bool ServerChurnTest(size_t threads, size_t rounds, size_t count) {
+  TcpServer server(4);
+  if (!server.Start("127.0.0.1", "9996")) {
+    LOG_ERROR("registry server start error");
+    return false;
+  }
+
+  std::mutex handles_mutex;
+  std::vector<SessionHandle> handles;
+  std::atomic<bool> running{true};
+  std::atomic<size_t> found{0};
+  std::atomic<size_t> expired{0};
+
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t]() {
+      std::minstd_rand random(static_cast<std::minstd_rand::result_type>(t));
+      while (running) {
+        SessionHandle handle = kInvalidSessionHandle;
+        {
+          std::lock_guard<std::mutex> guard(handles_mutex);
+          if (!handles.empty()) {
+            handle = handles[random() % handles.size()];
+          }
+        }
+        if (server.FindSession(handle)) {
+          ++found;
+        } else {
+          ++expired;
+        }
+      }
+    });
+  }
+
+  asio::io_context context;
+  asio::ip::tcp::endpoint endpoint(asio::ip::make_address("127.0.0.1"), 9996);
+  size_t connected = 0;
+  for (size_t round = 0; round < rounds; ++round) {
+    std::vector<asio::ip::tcp::socket> sockets;
+    for (size_t i = 0; i < count; ++i) {
+      std::error_code ec;
+      auto &socket = sockets.emplace_back(context);
+      socket.connect(endpoint, ec);
+      connected += ec ? 0 : 1;
+    }
+
+    auto t1 = SteadyClock::now();
+    while (sockets.size() != server.GetSessionCount() &&
+           SteadyClock::now() - t1 < std::chrono::seconds(10)) {
+      std::this_thread::sleep_for(1ms);
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(handles_mutex);
+      server.ApplyAllSession([&handles](std::shared_ptr<TcpSession> &session) {
+        handles.emplace_back(session->GetSessionHandle());
+      });
+    }
+
+    sockets.clear();
+    t1 = SteadyClock::now();
+    while (0 != server.GetSessionCount() &&
+           SteadyClock::now() - t1 < std::chrono::seconds(10)) {
+      std::this_thread::sleep_for(1ms);
+    }
+  }
+
+  running = false;
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  // 所有会话都已断开，旧句柄全部失效
+  size_t alive = 0;
+  for (auto handle : handles) {
+    alive += server.FindSession(handle) ? 1 : 0;
+  }
+
+  LOG_INFO(
+      "Registry server churn connected {} handles {} resolved {} expired {} "
+      "alive after close {}",
+      connected, handles.size(), found.load(), expired.load(), alive);
+
+  server.Stop();
+  return connected == rounds * count && 0 == alive && found > 0;
+}
+
+int main(int argc, char *argv[]) {
+  if (auto error =
+          g_config->Load(_TPN_NET_BASE_REGISTRY_CONFIG_TEST_FILE, {})) {
+    printf("Error in config file: %s\n", (*error).c_str());
+    return 1;
+  }
+
+  tpn::log::Init();
+  std::shared_ptr<void> log_handle(nullptr,
+                                   [](void *) { tpn::log::Shutdown(); });
+
+  size_t threads  = argc > 1 ? std::stoul(argv[1]) : 16;
+  size_t resident = argc > 2 ? std::stoul(argv[2]) : 10000;
+
+  bool ok = true;
+  const char *names[] = {"Legacy single lock", "Sharded key", "Handle"};
+  for (auto mode :
+       {LookupMode::kLegacy, LookupMode::kKey, LookupMode::kHandle}) {
+    size_t lookups = 0;
+    size_t churns  = 0;
+    std::clock_t c1 = std::clock();
+    bool result = LookupBench(mode, resident, threads, MilliSeconds(1000),
+                              lookups, churns);
+    std::clock_t cpu = std::clock() - c1;
+    LOG_INFO(
+        "{} lookup threads {} resident {} lookups {}/s churn {}/s cpu {}ms "
+        "check {}",
+        names[static_cast<size_t>(mode)], threads, resident, lookups, churns,
+        cpu * 1000 / CLOCKS_PER_SEC, result);
+    ok = result && ok;
+  }
+
+  ok = ServerChurnTest(threads, 10, 200) && ok;
+
+  if (!ok) {
+    LOG_ERROR("Registry bench failed");
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,185 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef TYPHOON_ZERO_TPN_TESTS_LIB_NET_BASE_TEST_RECEIVER_H_
+#define TYPHOON_ZERO_TPN_TESTS_LIB_NET_BASE_TEST_RECEIVER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "chrono_wrap.h"
+
+#include "net.h"
+
+/// 测试接收端，用原生套接字连接服务器，所有连接在一个io线程中读取并计数，
+/// 也可以连入暂不读取的连接，模拟网络很差的客户端
+class TestReceiver {
+ public:
+  /// 单个连接
+  struct Peer {
+    Peer(asio::io_context &context, size_t buffer_size)
+        : socket(context), data(buffer_size) {}
+
+    asio::ip::tcp::socket socket;     ///< 套接字
+    std::vector<uint8_t> data;        ///< 接收缓冲
+    std::atomic<size_t> received{0};  ///< 接收字节数
+  };
+
+  /// 构造函数
+  ///  @param[in]   buffer_size   每个连接的接收缓冲大小
+  explicit TestReceiver(size_t buffer_size = 4096) : buffer_size_(buffer_size) {
+    this->thread_ = std::thread([this]() { this->context_.run(); });
+  }
+
+  ~TestReceiver() { this->Stop(); }
+
+  /// 连接服务器并开始读取，可以多次调用
+  ///  @param[in]   count     连接数
+  ///  @param[in]   port      服务器端口
+  ///  @return 连接成功数
+  size_t Connect(size_t count, unsigned short port) {
+    size_t connected = 0;
+    for (size_t i = 0; i < count; ++i) {
+      auto peer = this->ConnectPeer(port, 0);
+      if (!peer) {
+        continue;
+      }
+      this->Drain(*peer);
+      this->peers_.emplace_back(std::move(peer));
+      ++connected;
+    }
+    return connected;
+  }
+
+  /// 连接服务器但不读取，直到 Drain 才开始读取
+  /// 先缩小接收缓冲再连接，窗口才会按缩小后的大小协商
+  ///  @param[in]   port                  服务器端口
+  ///  @param[in]   receive_buffer_size   套接字接收缓冲大小
+  ///  @return 连接成功返回连接，失败返回nullptr
+  Peer *ConnectStalled(unsigned short port, size_t receive_buffer_size) {
+    auto peer = this->ConnectPeer(port, receive_buffer_size);
+    if (!peer) {
+      return nullptr;
+    }
+    return this->stalled_.emplace_back(std::move(peer)).get();
+  }
+
+  /// 连接开始读取
+  ///  @param[in]   peer      连接
+  void Drain(Peer &peer) {
+    asio::post(this->context_, [this, &peer]() { this->Read(peer); });
+  }
+
+  /// 停止读取
+  void Stop() {
+    this->context_.stop();
+    if (this->thread_.joinable()) {
+      this->thread_.join();
+    }
+  }
+
+  /// 获取所有连接的接收字节数
+  size_t GetTotal() const { return this->total_.load(); }
+
+  /// 获取读取的连接的最少接收字节数
+  size_t GetMin() const {
+    size_t received = (std::numeric_limits<size_t>::max)();
+    for (auto &peer : this->peers_) {
+      received = (std::min)(received, peer->received.load());
+    }
+    return received;
+  }
+
+  /// 检查每个读取的连接都收到了指定字节数
+  ///  @param[in]   expected  字节数
+  bool Check(size_t expected) const {
+    return std::all_of(this->peers_.begin(), this->peers_.end(),
+                       [expected](auto &peer) {
+                         return expected == peer->received.load();
+                       });
+  }
+
+ private:
+  std::unique_ptr<Peer> ConnectPeer(unsigned short port,
+                                    size_t receive_buffer_size) {
+    asio::ip::tcp::endpoint endpoint(asio::ip::make_address("127.0.0.1"), port);
+    auto peer = std::make_unique<Peer>(this->context_, this->buffer_size_);
+    std::error_code ec;
+    if (0 != receive_buffer_size) {
+      peer->socket.open(asio::ip::tcp::v4(), ec);
+      peer->socket.set_option(
+          asio::socket_base::receive_buffer_size(
+              static_cast<int>(receive_buffer_size)),
+          ec);
+    }
+    peer->socket.connect(endpoint, ec);
+    if (ec) {
+      return nullptr;
+    }
+    return peer;
+  }
+
+  void Read(Peer &peer) {
+    peer.socket.async_read_some(
+        asio::buffer(peer.data),
+        [this, &peer](const std::error_code &ec, size_t bytes) {
+          if (ec) {
+            return;
+          }
+          peer.received += bytes;
+          this->total_ += bytes;
+          this->Read(peer);
+        });
+  }
+
+ private:
+  size_t buffer_size_;
+  asio::io_context context_{1};
+  asio::executor_work_guard<asio::io_context::executor_type> work_{
+      context_.get_executor()};
+  std::vector<std::unique_ptr<Peer>> peers_;
+  std::vector<std::unique_ptr<Peer>> stalled_;
+  std::atomic<size_t> total_{0};
+  std::thread thread_;
+};
+
+/// 等待接收端收到指定字节数
+///  @param[in]   receiver    接收端
+///  @param[in]   total       总字节数
+///  @param[in]   timeout     超时时间
+///  @return 全部收到返回true
+inline bool WaitReceived(
+    const TestReceiver &receiver, size_t total,
+    std::chrono::seconds timeout = std::chrono::seconds(60)) {
+  auto t1 = tpn::SteadyClock::now();
+  while (receiver.GetTotal() < total &&
+         tpn::SteadyClock::now() - t1 < timeout) {
+    std::this_thread::yield();
+  }
+  return receiver.GetTotal() >= total;
+}
+
+#endif  // TYPHOON_ZERO_TPN_TESTS_LIB_NET_BASE_TEST_RECEIVER_H_
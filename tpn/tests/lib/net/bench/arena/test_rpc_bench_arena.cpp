@@ -0,0 +1,316 @@
+//
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "log.h"
+#include "config.h"
+#include "chrono_wrap.h"
+
+#include "test_service.pb.h"
+#include "message_buffer.h"
+#include "service_arena.h"
+#include "error_code.pb.h"
+
+#include "../../alloc_counter.h"
+
+#ifndef _TPN_NET_BENCH_ARENA_CONFIG_TEST_FILE
+#  define _TPN_NET_BENCH_ARENA_CONFIG_TEST_FILE \
+    "config_net_bench_arena_test.json"
+#endif
+
+using namespace tpn;
+
+using Continuation = ServiceContinuation<protocol::TInventoryResponse>;
+
+/// 背包服务，堆模式与arena模式共用同一份逻辑
+///  @tparam      Base      生成的服务基类
+template <typename Base>
+class InventoryService : public Base {
+ public:
+  /// 设置是否异步回应
+  ///  @param[in]   async     异步时continuation保存到 pending_
+  void SetAsync(bool async) { async_ = async; }
+
+  /// 获取挂起的回应
+  ///  @return 挂起的continuation与回应
+  std::vector<Continuation> TakePending(
+      std::vector<const protocol::TInventoryResponse *> &responses) {
+    responses.swap(pending_responses_);
+    return std::move(pending_);
+  }
+
+  protocol::ErrorCode GetLastStatus() const { return last_status_; }
+  uint64_t GetResponses() const { return responses_; }
+  uint64_t GetCounts() const { return counts_; }
+  size_t GetResponseSize() const { return response_data_.size(); }
+
+ protected:
+  protocol::ErrorCode HandleSync(const protocol::TInventoryRequest *request,
+                                 protocol::TInventoryResponse *response,
+                                 Continuation &continuation) override {
+    response->mutable_items()->CopyFrom(request->items());
+    if (async_) {
+      pending_.emplace_back(std::move(continuation));
+      pending_responses_.emplace_back(response);
+      continuation = nullptr;
+    }
+    return protocol::kErrorCodeOk;
+  }
+
+  protocol::ErrorCode HandleUpdate(
+      const protocol::TInventoryRequest *request) override {
+    for (auto &&item : request->items()) {
+      counts_ += item.count();
+      for (auto &&gem : item.gems()) {
+        counts_ += gem.count();
+      }
+    }
+    return protocol::kErrorCodeOk;
+  }
+
+  void SendRequest(uint32_t service_hash, uint32_t method_id,
+                   const google::protobuf::Message *request,
+                   std::function<void(MessageBuffer)> callback) override {}
+
+  void SendRequest(uint32_t service_hash, uint32_t method_id,
+                   const google::protobuf::Message *request) override {}
+
+  void SendResponse(uint32_t service_hash, uint32_t method_id,
+                    uint32_t token, protocol::ErrorCode status) override {
+    last_status_ = status;
+  }
+
+  /// 序列化到复用的缓冲区，模拟发送
+  void SendResponse(uint32_t service_hash, uint32_t method_id,
+                    uint32_t token,
+                    const google::protobuf::Message *response) override {
+    response_data_.resize(response->ByteSizeLong());
+    response->SerializeToArray(response_data_.data(),
+                               static_cast<int>(response_data_.size()));
+    ++responses_;
+  }
+
+  std::string GetCallerInfo() const override { return "bench"; }
+
+ private:
+  bool async_{false};                   ///< 是否异步回应
+  uint64_t responses_{0};               ///< 回应次数
+  uint64_t counts_{0};                  ///< 更新的数量和
+  std::vector<uint8_t> response_data_;  ///< 回应数据
+  std::vector<Continuation> pending_;   ///< 挂起的continuation
+  std::vector<const protocol::TInventoryResponse *>
+      pending_responses_;  ///< 挂起的回应
+  /// 最后一次只带状态的回应
+  protocol::ErrorCode last_status_{protocol::kErrorCodeOk};
+};
+
+using HeapInventoryService  = InventoryService<protocol::TInventoryService>;
+using ArenaInventoryService =
+    InventoryService<protocol::TInventoryArenaService>;
+
+/// 测试结果
+struct BenchResult {
+  double nanos_per_call{0};        ///< 每次调用耗时
+  double allocations_per_call{0};  ///< 每次调用的堆申请次数
+};
+
+/// 构造请求，重复字段较多的背包同步
+///  @param[in]   items     物品数
+///  @return 序列化后的请求
+MessageBuffer MakeRequest(int items) {
+  protocol::TInventoryRequest request;
+  for (int i = 0; i < items; ++i) {
+    auto item = request.add_items();
+    item->set_guid(0x100000000ull + i);
+    item->set_config_id(1000 + i);
+    item->set_count(i + 1);
+    item->set_name("item_name_" + std::to_string(i));
+    for (int j = 0; j < 4; ++j) {
+      item->add_attrs(i * 4 + j);
+    }
+    for (int j = 0; j < 2; ++j) {
+      auto gem = item->add_gems();
+      gem->set_guid(0x200000000ull + i * 2 + j);
+      gem->set_config_id(2000 + j);
+      gem->set_count(1);
+      gem->set_name("gem_" + std::to_string(j));
+    }
+  }
+
+  std::string data = request.SerializeAsString();
+  MessageBuffer buffer(data.size());
+  buffer.Write(data.data(), data.size());
+  return buffer;
+}
+
+/// 同步调用测试
+///  @param[in]   service       服务
+///  @param[in]   method_id     方法编号
+///  @param[in]   request       请求数据
+///  @param[in]   calls         调用次数
+///  @return 测试结果
+BenchResult RunCalls(ServiceBase &service, uint32_t method_id,
+                     const MessageBuffer &request, int calls) {
+  for (int i = 0; i < calls / 10; ++i) {
+    service.CallServerMethod(i, method_id, request);
+  }
+
+  uint64_t allocations = g_heap_allocations.load();
+  auto t1              = SteadyClock::now();
+  for (int i = 0; i < calls; ++i) {
+    service.CallServerMethod(i, method_id, request);
+  }
+  auto t2 = SteadyClock::now();
+
+  BenchResult result;
+  result.nanos_per_call =
+      static_cast<double>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1)
+              .count()) /
+      calls;
+  result.allocations_per_call =
+      static_cast<double>(g_heap_allocations.load() - allocations) / calls;
+  return result;
+}
+
+/// 异步回应测试，回应在其他线程发出，arena在其他线程归还
+///  @param[in]   request       请求数据
+///  @return 是否正确
+bool RunAsync(const MessageBuffer &request) {
+  ArenaInventoryService service;
+  service.SetAsync(true);
+
+  ServiceArenaStats stats1 = ServiceArena::GetStats();
+  constexpr int kRounds    = 100;
+  constexpr int kPending   = 8;
+  for (int round = 0; round < kRounds; ++round) {
+    for (int i = 0; i < kPending; ++i) {
+      service.CallServerMethod(i, 1, request);
+    }
+
+    std::vector<const protocol::TInventoryResponse *> responses;
+    std::vector<Continuation> pending = service.TakePending(responses);
+    if (pending.size() != kPending) {
+      LOG_ERROR("pending {} != {}", pending.size(), kPending);
+      return false;
+    }
+    std::thread worker([&]() {
+      for (size_t i = 0; i < pending.size(); ++i) {
+        pending[i](&service, protocol::kErrorCodeOk, responses[i]);
+      }
+    });
+    worker.join();
+  }
+  ServiceArenaStats stats2 = ServiceArena::GetStats();
+
+  size_t acquires = stats2.acquires - stats1.acquires;
+  size_t creates  = stats2.creates - stats1.creates;
+  LOG_INFO("async responses {} acquires {} creates {}",
+           service.GetResponses(), acquires, creates);
+  if (service.GetResponses() != kRounds * kPending ||
+      acquires != kRounds * kPending) {
+    return false;
+  }
+
+  // 挂起的arena在其他线程归还后可以被本线程复用，不会持续新建
+  if (creates > kPending) {
+    LOG_ERROR("arena not reused, creates {}", creates);
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  if (auto error = g_config->Load(_TPN_NET_BENCH_ARENA_CONFIG_TEST_FILE, {})) {
+    printf("Error in config file: %s\n", (*error).c_str());
+    return 1;
+  }
+
+  tpn::log::Init();
+  std::shared_ptr<void> log_handle(nullptr,
+                                   [](void *) { tpn::log::Shutdown(); });
+
+  int items = argc > 1 ? std::atoi(argv[1]) : 64;
+  int calls = argc > 2 ? std::atoi(argv[2]) : 20000;
+  if (items <= 0 || calls <= 0) {
+    printf("usage: %s [items=64] [calls=20000]\n", argv[0]);
+    return 1;
+  }
+
+  MessageBuffer request = MakeRequest(items);
+  LOG_INFO("request items {} size {}", items, request.GetActiveSize());
+
+  HeapInventoryService heap_service;
+  ArenaInventoryService arena_service;
+
+  BenchResult heap_sync    = RunCalls(heap_service, 1, request, calls);
+  BenchResult arena_sync   = RunCalls(arena_service, 1, request, calls);
+  BenchResult heap_update  = RunCalls(heap_service, 2, request, calls);
+  BenchResult arena_update = RunCalls(arena_service, 2, request, calls);
+
+  LOG_INFO("sync   heap  {:.1f} ns/call {:.2f} allocs/call",
+           heap_sync.nanos_per_call, heap_sync.allocations_per_call);
+  LOG_INFO("sync   arena {:.1f} ns/call {:.2f} allocs/call",
+           arena_sync.nanos_per_call, arena_sync.allocations_per_call);
+  LOG_INFO("update heap  {:.1f} ns/call {:.2f} allocs/call",
+           heap_update.nanos_per_call, heap_update.allocations_per_call);
+  LOG_INFO("update arena {:.1f} ns/call {:.2f} allocs/call",
+           arena_update.nanos_per_call, arena_update.allocations_per_call);
+
+  if (heap_service.GetResponseSize() != arena_service.GetResponseSize() ||
+      heap_service.GetCounts() != arena_service.GetCounts()) {
+    LOG_ERROR("heap and arena results differ");
+    return 1;
+  }
+
+  // 稳定后arena模式的堆申请只剩MessageBuffer之外的少量开销
+  if (arena_sync.allocations_per_call >= heap_sync.allocations_per_call ||
+      arena_update.allocations_per_call >= heap_update.allocations_per_call) {
+    LOG_ERROR("arena mode does not reduce allocations");
+    return 1;
+  }
+
+  // 方法表之外的编号走默认分支
+  for (uint32_t method_id : {0u, 3u, 4u, 0x40000005u}) {
+    arena_service.CallServerMethod(0, method_id, request);
+    if (protocol::kErrorCodeInvalidMethod != arena_service.GetLastStatus()) {
+      LOG_ERROR("method {:#x} should be invalid", method_id);
+      return 1;
+    }
+  }
+
+  if (!RunAsync(request)) {
+    LOG_ERROR("async arena test failed");
+    return 1;
+  }
+
+  LOG_INFO("arena bench ok");
+  return 0;
+}
@@ -0,0 +1,579 @@
+//
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "log.h"
+#include "config.h"
+#include "chrono_wrap.h"
+
+#include "rpc_type.pb.h"
+#include "test_service.pb.h"
+#include "message_buffer.h"
+#include "buffer_pool.h"
+
+#include "net.h"
+
+#include "byte_converter.h"
+#include "service.h"
+#include "service_mgr.h"
+#include "error_code.pb.h"
+
+#include "../../alloc_counter.h"
+
+#ifndef _TPN_NET_BENCH_COROUTINE_CONFIG_TEST_FILE
+#  define _TPN_NET_BENCH_COROUTINE_CONFIG_TEST_FILE \
+    "config_net_bench_coroutine_test.json"
+#endif
+
+using namespace tpn;
+using namespace tpn::net;
+
+/// 延迟直方图，对数线性分桶，记录是O(1)且不申请内存
+class LatencyHistogram {
+ public:
+  static constexpr uint32_t kSubBucketBits = 5;
+  static constexpr uint64_t kSubBuckets    = uint64_t(1) << kSubBucketBits;
+  static constexpr size_t kBuckets         = 64 * kSubBuckets;
+
+  void Record(uint64_t value) {
+    ++counts_[GetIndex(value)];
+    ++count_;
+    sum_ += value;
+    max_ = (std::max)(max_, value);
+  }
+
+  void Merge(const LatencyHistogram &other) {
+    for (size_t i = 0; i < kBuckets; ++i) {
+      counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    max_ = (std::max)(max_, other.max_);
+  }
+
+  uint64_t GetPercentile(double percentile) const {
+    uint64_t target = static_cast<uint64_t>(percentile / 100.0 * count_ + 0.5);
+    target          = (std::clamp)(target, uint64_t(1), count_);
+    uint64_t total  = 0;
+    for (size_t i = 0; (count_ > 0) && (i < kBuckets); ++i) {
+      total += counts_[i];
+      if (total >= target) {
+        return (std::min)(GetLower(i), max_);
+      }
+    }
+    return max_;
+  }
+
+  uint64_t GetCount() const { return count_; }
+  double GetMean() const {
+    return count_ > 0 ? static_cast<double>(sum_) / count_ : 0;
+  }
+
+ private:
+  static size_t GetIndex(uint64_t value) {
+    if (value < 2 * kSubBuckets) {
+      return static_cast<size_t>(value);
+    }
+    uint32_t shift = static_cast<uint32_t>(std::bit_width(value)) -
+                     (kSubBucketBits + 1);
+    return (shift + 1) * kSubBuckets + ((value >> shift) - kSubBuckets);
+  }
+
+  static uint64_t GetLower(size_t index) {
+    if (index < 2 * kSubBuckets) {
+      return index;
+    }
+    uint32_t shift = static_cast<uint32_t>(index / kSubBuckets) - 1;
+    return ((index % kSubBuckets) + kSubBuckets) << shift;
+  }
+
+ private:
+  std::array<uint64_t, kBuckets> counts_{};  ///< 各桶计数
+  uint64_t count_{0};                        ///< 总数
+  uint64_t sum_{0};                          ///< 总和
+  uint64_t max_{0};                          ///< 最大值
+};
+
+/// 压测参数
+struct BenchOptions {
+  size_t clients{16};        ///< 客户端会话数，每个客户端一个io线程
+  size_t message_size{64};   ///< 请求query长度
+  size_t pipeline{8};        ///< 每个会话同时等待回应的调用数
+  double seconds{3};         ///< 统计时长
+  double warmup{1};          ///< 预热时长，不计入统计
+  size_t timeout_ms{1000};   ///< 调用超时
+  size_t io_threads{0};      ///< 服务器io线程数，0为硬件线程数
+  std::string mode{"both"};  ///< callback、coroutine 或 both
+};
+
+/// 压测结果
+struct BenchResult {
+  uint64_t count{0};        ///< 统计窗口内完成的调用数
+  uint64_t errors{0};       ///< 失败的调用数
+  double rpc_per_sec{0};    ///< 每秒调用数
+  double allocations{0};    ///< 每次调用的堆申请次数
+  double mean_us{0};        ///< 平均延迟
+  double p99_us{0};         ///< p99延迟
+};
+
+/// 是否在统计窗口内
+std::atomic<bool> g_measuring{false};
+/// 是否继续调用
+std::atomic<bool> g_running{true};
+
+/// 获取单调时钟纳秒
+int64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             SteadyClock::now().time_since_epoch())
+      .count();
+}
+
+/// 组帧
+///  @param[in]   header      包头，size由调用者设置
+///  @param[in]   body        包体，可以为空
+///  @return 完整的帧
+MessageBuffer MakeFrame(protocol::Header &header,
+                        const google::protobuf::Message *body) {
+  uint16_t header_length = static_cast<uint16_t>(header.ByteSizeLong());
+  uint16_t header_bytes  = header_length;
+  EndianRefMakeLittle(header_bytes);
+
+  MessageBuffer frame(kHeaderBytes + header_length + header.size());
+  frame.Write(&header_bytes, kHeaderBytes);
+  header.SerializeWithCachedSizesToArray(frame.GetWritePointer());
+  frame.WriteCompleted(header_length);
+  if (body) {
+    body->SerializeWithCachedSizesToArray(frame.GetWritePointer());
+    frame.WriteCompleted(header.size());
+  }
+  return frame;
+}
+
+class BenchSession;
+
+/// 服务器的服务分发器
+ServiceMgr<BenchSession> g_bench_dispatcher;
+
+/// 服务器会话，请求经ServiceMgr分发到生成的服务代码
+class BenchSession
+    : public TcpSessionBase<BenchSession, TemplateArgsTcpSession> {
+ public:
+  using TcpSessionBase<BenchSession, TemplateArgsTcpSession>::TcpSessionBase;
+
+  void SendRequest(uint32_t service_hash, uint32_t method_id,
+                   const google::protobuf::Message *request,
+                   std::function<void(MessageBuffer)> callback) {}
+
+  void SendRequest(uint32_t service_hash, uint32_t method_id,
+                   const google::protobuf::Message *request) {}
+
+  void SendResponse(uint32_t service_hash, uint32_t method_id, uint32_t token,
+                    protocol::ErrorCode status) {
+    protocol::Header header;
+    header.set_service_hash(service_hash);
+    header.set_method_id(method_id);
+    header.set_token(token);
+    header.set_status(status);
+    Send(MakeFrame(header, nullptr));
+  }
+
+  void SendResponse(uint32_t service_hash, uint32_t method_id, uint32_t token,
+                    const google::protobuf::Message *response) {
+    protocol::Header header;
+    header.set_service_hash(service_hash);
+    header.set_method_id(method_id);
+    header.set_token(token);
+    header.set_size(static_cast<uint32_t>(response->ByteSizeLong()));
+    Send(MakeFrame(header, response));
+  }
+
+  std::string GetCallerInfo() const { return "BenchSession"; }
+
+  void FireRecv(std::shared_ptr<BenchSession> &this_ptr,
+                protocol::Header &&header, MessageBuffer &&packet) {
+    g_bench_dispatcher.Dispatch(this_ptr, header.service_hash(),
+                                header.token(), header.method_id(),
+                                std::move(packet));
+  }
+};
+
+using BenchServer = TcpServerBridge<BenchSession>;
+
+/// 回显服务，把请求的query作为第一个结果的url返回
+class BenchService : public Service<BenchSession, protocol::TestService3> {
+ public:
+  using Service<BenchSession, protocol::TestService3>::Service;
+
+ protected:
+  protocol::ErrorCode HandleProcessClientRequest32(
+      const protocol::SearchRequest *request,
+      protocol::SearchResponse *response,
+      ServiceContinuation<protocol::SearchResponse> &continuation) override {
+    response->add_results()->set_url(request->query());
+    return kErrorCodeOk;
+  }
+};
+
+/// 压测客户端
+/// 两种写法发出相同的 AsyncCall，只有完成标记不同
+class BenchClient : public TcpClientBase<BenchClient, TemplateArgsTcpClient> {
+ public:
+  using Super = TcpClientBase<BenchClient, TemplateArgsTcpClient>;
+
+  /// 构造函数
+  ///  @param[in]   options     压测参数
+  ///  @param[in]   request     请求
+  BenchClient(const BenchOptions &options,
+              const protocol::SearchRequest &request)
+      : Super(),
+        options_(options),
+        request_(request),
+        timeout_(MilliSeconds(options.timeout_ms)) {}
+
+  /// 回调写法，每条流水线在回调中发出下一次调用
+  void StartCallbacks() {
+    for (size_t i = 0; i < options_.pipeline; ++i) {
+      active_.fetch_add(1);
+      Post([this]() { CallNext(); });
+    }
+  }
+
+  /// 协程写法，每条流水线一个协程
+  void StartCoroutines() {
+    for (size_t i = 0; i < options_.pipeline; ++i) {
+      active_.fetch_add(1);
+      CoSpawn(CallLoop());
+    }
+  }
+
+  /// 检查发送、收帧和调用超时，在压测前运行
+  ///  @return 失败原因，成功返回空
+  Awaitable<std::string> CheckPrimitives() {
+    static constexpr uint32_t kRawToken = 0x7fffffff;
+
+    try {
+      // 自己组帧发送，回应不匹配任何调用，由等待收帧的协程取走
+      protocol::Header header;
+      header.set_service_hash(protocol::TestService3::ServiceHash::value);
+      header.set_method_id(2);
+      header.set_token(kRawToken);
+      header.set_size(static_cast<uint32_t>(request_.ByteSizeLong()));
+      size_t bytes = co_await AsyncSend(MakeFrame(header, &request_));
+      if (0 == bytes) {
+        co_return "send no bytes";
+      }
+
+      RpcFrame frame = co_await AsyncRecvFrame();
+      if ((kRawToken != frame.header.token()) ||
+          (kErrorCodeOk != frame.header.status())) {
+        co_return "recv unexpected frame";
+      }
+
+      // 服务器丢弃未注册服务的请求，调用只能超时
+      try {
+        co_await AsyncCall(0, 2, request_, MilliSeconds(20));
+        co_return "call not timed out";
+      } catch (std::system_error &e) {
+        if (asio::error::timed_out != e.code()) {
+          throw;
+        }
+      }
+      if (GetPendingCallCount() > 0) {
+        co_return "call still pending";
+      }
+    } catch (std::system_error &e) {
+      co_return e.code().message();
+    }
+    co_return std::string();
+  }
+
+  /// 仍在调用的流水线数
+  size_t GetActive() const { return active_.load(); }
+
+  /// 以下只在客户端停止后读取
+  const LatencyHistogram &GetHistogram() const { return histogram_; }
+  uint64_t GetErrors() const { return errors_; }
+
+ private:
+  void CallNext() {
+    int64_t sent = NowNanos();
+    AsyncCall(protocol::TestService3::ServiceHash::value, 2, request_,
+              timeout_,
+              [this, sent](const std::error_code &ec, RpcFrame frame) {
+                if (Record(sent, ec, frame.header) &&
+                    g_running.load(std::memory_order_relaxed)) {
+                  CallNext();
+                  return;
+                }
+                active_.fetch_sub(1);
+              });
+  }
+
+  Awaitable<> CallLoop() {
+    try {
+      while (g_running.load(std::memory_order_relaxed)) {
+        int64_t sent   = NowNanos();
+        RpcFrame frame = co_await AsyncCall(
+            protocol::TestService3::ServiceHash::value, 2, request_,
+            timeout_);
+        if (!Record(sent, std::error_code(), frame.header)) {
+          break;
+        }
+      }
+    } catch (std::system_error &e) {
+      Record(0, e.code(), protocol::Header::default_instance());
+    }
+    active_.fetch_sub(1);
+  }
+
+  /// 记录一次调用
+  ///  @return 成功返回true
+  bool Record(int64_t sent, const std::error_code &ec,
+              const protocol::Header &header) {
+    bool ok = !ec && (kErrorCodeOk == header.status());
+    if (g_measuring.load(std::memory_order_relaxed)) {
+      if (!ok) {
+        ++errors_;
+      } else {
+        histogram_.Record(
+            static_cast<uint64_t>((std::max)(NowNanos() - sent, int64_t(0))));
+      }
+    }
+    return ok;
+  }
+
+ private:
+  const BenchOptions &options_;             ///< 压测参数
+  const protocol::SearchRequest &request_;  ///< 请求
+  SteadyClock::duration timeout_;           ///< 调用超时
+  std::atomic<size_t> active_{0};           ///< 仍在调用的流水线数
+  LatencyHistogram histogram_;              ///< 回应延迟
+  uint64_t errors_{0};                      ///< 失败的调用数
+};
+
+/// 运行一轮压测
+///  @param[in]   options     压测参数
+///  @param[in]   request     请求
+///  @param[in]   coroutine   是否使用协程写法
+///  @return 压测结果
+BenchResult RunBench(const BenchOptions &options,
+                     const protocol::SearchRequest &request, bool coroutine) {
+  BenchResult result;
+
+  std::vector<std::unique_ptr<BenchClient>> clients;
+  for (size_t i = 0; i < options.clients; ++i) {
+    auto client = std::make_unique<BenchClient>(options, request);
+    try {
+      client->AsyncConnect("127.0.0.1", "9994", asio::use_future).get();
+    } catch (std::system_error &e) {
+      LOG_ERROR("bench client {} connect error {}", i, e.code());
+      ++result.errors;
+      break;
+    }
+    clients.emplace_back(std::move(client));
+  }
+
+  if (coroutine && !clients.empty()) {
+    std::string error =
+        clients.front()
+            ->CoSpawn(clients.front()->CheckPrimitives(), asio::use_future)
+            .get();
+    if (!error.empty()) {
+      LOG_ERROR("bench client check error {}", error);
+      ++result.errors;
+    }
+  }
+
+  g_running = true;
+  for (auto &client : clients) {
+    if (coroutine) {
+      client->StartCoroutines();
+    } else {
+      client->StartCallbacks();
+    }
+  }
+
+  std::this_thread::sleep_for(std::chrono::duration<double>(options.warmup));
+
+  uint64_t allocations = g_heap_allocations.load();
+  size_t pooled        = BufferPool::GetStats().heap_allocations;
+  auto t1              = SteadyClock::now();
+  g_measuring          = true;
+  std::this_thread::sleep_for(std::chrono::duration<double>(options.seconds));
+  g_measuring = false;
+  auto t2     = SteadyClock::now();
+  // 缓冲池的中心链表满时会向全局堆申请，与调用模型无关，不计入
+  allocations = g_heap_allocations.load() - allocations -
+                (BufferPool::GetStats().heap_allocations - pooled);
+
+  // 等流水线上的调用都完成后再停止，协程不会挂在已停止的strand上
+  g_running = false;
+  for (auto &client : clients) {
+    while (client->GetActive() > 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    client->Stop();
+  }
+
+  LatencyHistogram histogram;
+  for (auto &client : clients) {
+    histogram.Merge(client->GetHistogram());
+    result.errors += client->GetErrors();
+  }
+
+  double elapsed     = std::chrono::duration<double>(t2 - t1).count();
+  result.count       = histogram.GetCount();
+  result.rpc_per_sec = result.count / elapsed;
+  result.allocations =
+      result.count > 0 ? static_cast<double>(allocations) / result.count : 0;
+  result.mean_us = histogram.GetMean() / 1000.0;
+  result.p99_us  = histogram.GetPercentile(99) / 1000.0;
+  if (clients.size() != options.clients) {
+    ++result.errors;
+  }
+  return result;
+}
+
+/// 解析命令行 --key=value
+///  @param[in]   argc
+///  @param[in]   argv
+///  @param[out]  options     压测参数
+///  @return 成功返回true
+bool ParseOptions(int argc, char *argv[], BenchOptions &options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    size_t pos           = arg.find('=');
+    if (!arg.starts_with("--") || std::string_view::npos == pos) {
+      return false;
+    }
+
+    std::string_view key = arg.substr(2, pos - 2);
+    std::string value(arg.substr(pos + 1));
+    if ("clients" == key) {
+      options.clients = std::stoul(value);
+    } else if ("size" == key) {
+      options.message_size = std::stoul(value);
+    } else if ("pipeline" == key) {
+      options.pipeline = (std::max)(std::stoul(value), 1ul);
+    } else if ("seconds" == key) {
+      options.seconds = std::stod(value);
+    } else if ("warmup" == key) {
+      options.warmup = std::stod(value);
+    } else if ("timeout" == key) {
+      options.timeout_ms = std::stoul(value);
+    } else if ("io" == key) {
+      options.io_threads = std::stoul(value);
+    } else if (("mode" == key) &&
+               (("callback" == value) || ("coroutine" == value) ||
+                ("both" == value))) {
+      options.mode = value;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  if (auto error =
+          g_config->Load(_TPN_NET_BENCH_COROUTINE_CONFIG_TEST_FILE, {})) {
+    printf("Error in config file: %s\n", (*error).c_str());
+    return 1;
+  }
+
+  tpn::log::Init();
+  std::shared_ptr<void> log_handle(nullptr,
+                                   [](void *) { tpn::log::Shutdown(); });
+
+  BenchOptions options;
+  if (!ParseOptions(argc, argv, options)) {
+    printf(
+        "usage: %s [--clients=16] [--size=64] [--pipeline=8] [--seconds=3] "
+        "[--warmup=1] [--timeout=1000] [--io=0] "
+        "[--mode=callback|coroutine|both]\n",
+        argv[0]);
+    return 1;
+  }
+  size_t io_threads = options.io_threads > 0
+                          ? options.io_threads
+                          : (std::max)(std::thread::hardware_concurrency(), 1u);
+
+  g_bench_dispatcher.AddService<BenchService>();
+
+  BenchServer server(io_threads);
+  if (!server.Start("127.0.0.1", "9994")) {
+    LOG_ERROR("bench server start error");
+    return 1;
+  }
+
+  protocol::SearchRequest request;
+  request.set_query(std::string(options.message_size, 'q'));
+  request.set_page_number(1);
+  request.set_result_per_page(10);
+
+  LOG_INFO("clients {} size {} pipeline {} timeout {}ms io {} seconds {:.2f}",
+           options.clients, options.message_size, options.pipeline,
+           options.timeout_ms, io_threads, options.seconds);
+
+  bool failed = false;
+  for (bool coroutine : {false, true}) {
+    const char *mode = coroutine ? "coroutine" : "callback";
+    if (("both" != options.mode) && (mode != options.mode)) {
+      continue;
+    }
+
+    BenchResult result = RunBench(options, request, coroutine);
+    LOG_INFO(
+        "{:<9} rpc {} rpc/s {:.0f} latency mean {:.1f}us p99 {:.1f}us "
+        "allocations/rpc {:.2f} errors {}",
+        mode, result.count, result.rpc_per_sec, result.mean_us, result.p99_us,
+        result.allocations, result.errors);
+    printf(
+        "{\"mode\":\"%s\",\"rpc\":%llu,\"rpc_per_sec\":%.1f,"
+        "\"mean_us\":%.1f,\"p99_us\":%.1f,\"allocations_per_rpc\":%.3f,"
+        "\"errors\":%llu}\n",
+        mode, static_cast<unsigned long long>(result.count),
+        result.rpc_per_sec, result.mean_us, result.p99_us, result.allocations,
+        static_cast<unsigned long long>(result.errors));
+
+    failed = failed || (0 == result.count) || (result.errors > 0);
+  }
+
+  server.Stop();
+
+  if (failed) {
+    LOG_ERROR("bench failed");
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,576 @@
+//
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "log.h"
+#include "config.h"
+#include "chrono_wrap.h"
+#include "git_revision.h"
+
+#include "rpc_type.pb.h"
+#include "test_service.pb.h"
+#include "message_buffer.h"
+
+#include "net.h"
+
+#include "byte_converter.h"
+#include "service.h"
+#include "service_mgr.h"
+#include "error_code.pb.h"
+
+#include "../../alloc_counter.h"
+
+#ifndef _TPN_NET_BENCH_LOADGEN_CONFIG_TEST_FILE
+#  define _TPN_NET_BENCH_LOADGEN_CONFIG_TEST_FILE \
+    "config_net_bench_loadgen_test.json"
+#endif
+
+using namespace tpn;
+using namespace tpn::net;
+
+/// 延迟直方图
+/// 与HdrHistogram相同的对数线性分桶，每个2的幂区间等分为 kSubBuckets 份，
+/// 相对误差不超过 1/kSubBuckets，记录是O(1)且不申请内存
+class LatencyHistogram {
+ public:
+  static constexpr uint32_t kSubBucketBits = 5;
+  static constexpr uint64_t kSubBuckets    = uint64_t(1) << kSubBucketBits;
+  static constexpr size_t kBuckets         = 64 * kSubBuckets;
+
+  /// 记录一个值
+  ///  @param[in]   value     纳秒
+  void Record(uint64_t value) {
+    ++counts_[GetIndex(value)];
+    ++count_;
+    sum_ += value;
+    max_ = (std::max)(max_, value);
+  }
+
+  /// 合并
+  ///  @param[in]   other     另一个直方图
+  void Merge(const LatencyHistogram &other) {
+    for (size_t i = 0; i < kBuckets; ++i) {
+      counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    max_ = (std::max)(max_, other.max_);
+  }
+
+  /// 获取分位值
+  ///  @param[in]   percentile  百分位 [0, 100]
+  ///  @return 分位所在桶的中值，纳秒
+  uint64_t GetPercentile(double percentile) const {
+    if (0 == count_) {
+      return 0;
+    }
+    if (percentile >= 100.0) {
+      return max_;
+    }
+
+    uint64_t target = static_cast<uint64_t>(percentile / 100.0 * count_ + 0.5);
+    target          = (std::clamp)(target, uint64_t(1), count_);
+    uint64_t total  = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+      total += counts_[i];
+      if (total >= target) {
+        return (std::min)(GetMedian(i), max_);
+      }
+    }
+    return max_;
+  }
+
+  uint64_t GetCount() const { return count_; }
+  uint64_t GetMax() const { return max_; }
+  double GetMean() const {
+    return count_ > 0 ? static_cast<double>(sum_) / count_ : 0;
+  }
+
+ private:
+  static size_t GetIndex(uint64_t value) {
+    if (value < 2 * kSubBuckets) {
+      return static_cast<size_t>(value);
+    }
+    uint32_t shift = static_cast<uint32_t>(std::bit_width(value)) -
+                     (kSubBucketBits + 1);
+    return (shift + 1) * kSubBuckets + ((value >> shift) - kSubBuckets);
+  }
+
+  static uint64_t GetMedian(size_t index) {
+    if (index < 2 * kSubBuckets) {
+      return index;
+    }
+    uint32_t shift = static_cast<uint32_t>(index / kSubBuckets) - 1;
+    uint64_t lower = ((index % kSubBuckets) + kSubBuckets) << shift;
+    return lower + ((uint64_t(1) << shift) >> 1);
+  }
+
+ private:
+  std::array<uint64_t, kBuckets> counts_{};  ///< 各桶计数
+  uint64_t count_{0};                        ///< 总数
+  uint64_t sum_{0};                          ///< 总和
+  uint64_t max_{0};                          ///< 最大值
+};
+
+/// 压测参数
+struct BenchOptions {
+  size_t clients{16};        ///< 客户端会话数，每个客户端一个io线程
+  size_t message_size{256};  ///< 请求包体长度
+  size_t pipeline{8};        ///< 每个会话最多未回应的请求数
+  size_t batch{1};           ///< 每帧最多合并的消息数，1为不合批
+  double rate{0};            ///< 每个会话每秒请求数，0表示收到回应立即补发
+  double seconds{5};         ///< 统计时长
+  double warmup{1};          ///< 预热时长，不计入统计
+  size_t io_threads{0};      ///< 服务器io线程数，0为硬件线程数
+  std::string output{"bench_loadgen.jsonl"};  ///< 结果追加写入的文件
+  std::string label;  ///< 结果标签，区分同一提交的不同运行
+};
+
+/// 是否在统计窗口内
+std::atomic<bool> g_measuring{false};
+/// 是否继续发送
+std::atomic<bool> g_running{true};
+
+/// 获取单调时钟纳秒
+int64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             SteadyClock::now().time_since_epoch())
+      .count();
+}
+
+/// 组帧
+///  @param[in]   header      包头，size由调用者设置
+///  @param[in]   body        包体
+///  @param[in]   size        包体长度
+///  @return 完整的帧
+MessageBuffer MakeFrame(protocol::Header &header, const void *body,
+                        size_t size) {
+  uint16_t header_length = static_cast<uint16_t>(header.ByteSizeLong());
+  uint16_t header_bytes  = header_length;
+  EndianRefMakeLittle(header_bytes);
+
+  MessageBuffer frame(kHeaderBytes + header_length + size);
+  frame.Write(&header_bytes, kHeaderBytes);
+  header.SerializeWithCachedSizesToArray(frame.GetWritePointer());
+  frame.WriteCompleted(header_length);
+  if (size > 0) {
+    frame.Write(body, size);
+  }
+  return frame;
+}
+
+class BenchSession;
+
+/// 服务器的服务分发器
+ServiceMgr<BenchSession> g_bench_dispatcher;
+
+/// 服务器会话，请求经ServiceMgr分发到生成的服务代码
+class BenchSession
+    : public TcpSessionBase<BenchSession, TemplateArgsTcpSession> {
+ public:
+  using TcpSessionBase<BenchSession, TemplateArgsTcpSession>::TcpSessionBase;
+
+  void SendRequest(uint32_t service_hash, uint32_t method_id,
+                   const google::protobuf::Message *request,
+                   std::function<void(MessageBuffer)> callback) {}
+
+  void SendRequest(uint32_t service_hash, uint32_t method_id,
+                   const google::protobuf::Message *request) {}
+
+  void SendResponse(uint32_t service_hash, uint32_t method_id, uint32_t token,
+                    protocol::ErrorCode status) {
+    protocol::Header header;
+    header.set_service_hash(service_hash);
+    header.set_method_id(method_id);
+    header.set_token(token);
+    header.set_status(status);
+    SendBatched(MakeFrame(header, nullptr, 0));
+  }
+
+  void SendResponse(uint32_t service_hash, uint32_t method_id, uint32_t token,
+                    const google::protobuf::Message *response) {
+    protocol::Header header;
+    header.set_service_hash(service_hash);
+    header.set_method_id(method_id);
+    header.set_token(token);
+    header.set_size(static_cast<uint32_t>(response->ByteSizeLong()));
+
+    MessageBuffer frame = MakeFrame(header, nullptr, 0);
+    frame.Resize(frame.GetBufferSize() + header.size());
+    response->SerializeWithCachedSizesToArray(frame.GetWritePointer());
+    frame.WriteCompleted(header.size());
+    SendBatched(std::move(frame));
+  }
+
+  std::string GetCallerInfo() const { return "BenchSession"; }
+
+  void FireRecv(std::shared_ptr<BenchSession> &this_ptr,
+                protocol::Header &&header, MessageBuffer &&packet) {
+    g_bench_dispatcher.Dispatch(this_ptr, header.service_hash(),
+                                header.token(), header.method_id(),
+                                std::move(packet));
+  }
+};
+
+using BenchServer = TcpServerBridge<BenchSession>;
+
+/// 回显服务，把请求的query作为第一个结果的url返回
+class BenchService : public Service<BenchSession, protocol::TestService3> {
+ public:
+  using Service<BenchSession, protocol::TestService3>::Service;
+
+ protected:
+  protocol::ErrorCode HandleProcessClientRequest32(
+      const protocol::SearchRequest *request,
+      protocol::SearchResponse *response,
+      ServiceContinuation<protocol::SearchResponse> &continuation) override {
+    response->add_results()->set_url(request->query());
+    return kErrorCodeOk;
+  }
+};
+
+/// 压测客户端
+class BenchClient : public TcpClientBase<BenchClient, TemplateArgsTcpClient> {
+ public:
+  using Super = TcpClientBase<BenchClient, TemplateArgsTcpClient>;
+
+  /// 构造函数
+  ///  @param[in]   options     压测参数
+  ///  @param[in]   request     序列化好的请求包体
+  BenchClient(const BenchOptions &options, const std::string &request)
+      : Super(),
+        options_(options),
+        request_(request),
+        send_times_(std::bit_ceil((std::max)(options.pipeline, size_t(1)))) {
+    // 闭环时收到回应后补发的请求在本轮事件处理结束时合为一帧，
+    // 定速发送时由发送线程在每轮结束时刷新
+    FrameBatchOptions batch;
+    batch.max_messages = options.batch;
+    batch.auto_flush   = (0 == options.rate);
+    SetBatchOptions(batch);
+  }
+
+  /// 发送一个请求
+  ///  @param[in]   intended    计划发送的时间，延迟从计划时间算起，
+  ///                           避免发送被阻塞时漏计排队时间
+  void SendRequest(int64_t intended) {
+    uint32_t token = static_cast<uint32_t>(sent_.fetch_add(1));
+    send_times_[token & (send_times_.size() - 1)].store(
+        intended, std::memory_order_relaxed);
+    outstanding_.fetch_add(1, std::memory_order_relaxed);
+
+    protocol::Header header;
+    header.set_service_hash(protocol::TestService3::ServiceHash::value);
+    header.set_method_id(2);
+    header.set_token(token);
+    header.set_size(static_cast<uint32_t>(request_.size()));
+    SendBatched(MakeFrame(header, request_.data(), request_.size()));
+  }
+
+  void FireConnect(std::shared_ptr<BenchClient> &this_ptr,
+                   std::error_code ec) {
+    if (ec || (options_.rate > 0)) {
+      return;
+    }
+
+    int64_t now = NowNanos();
+    for (size_t i = 0; i < options_.pipeline; ++i) {
+      SendRequest(now);
+    }
+    FlushBatch();
+  }
+
+  void FireRecv(std::shared_ptr<BenchClient> &this_ptr,
+                protocol::Header &&header, MessageBuffer &&packet) {
+    int64_t now = NowNanos();
+    int64_t sent =
+        send_times_[header.token() & (send_times_.size() - 1)].load(
+            std::memory_order_relaxed);
+    outstanding_.fetch_sub(1, std::memory_order_relaxed);
+
+    if (g_measuring.load(std::memory_order_relaxed)) {
+      if (kErrorCodeOk != header.status()) {
+        ++errors_;
+      }
+      histogram_.Record(
+          static_cast<uint64_t>((std::max)(now - sent, int64_t(0))));
+      bytes_ += kHeaderBytes + header.ByteSizeLong() + packet.GetActiveSize();
+    }
+
+    if ((0 == options_.rate) && g_running.load(std::memory_order_relaxed)) {
+      SendRequest(now);
+    }
+  }
+
+  size_t GetSent() const { return sent_.load(std::memory_order_relaxed); }
+  size_t GetOutstanding() const {
+    return outstanding_.load(std::memory_order_relaxed);
+  }
+
+  /// 以下只在客户端停止后读取
+  const LatencyHistogram &GetHistogram() const { return histogram_; }
+  uint64_t GetErrors() const { return errors_; }
+  uint64_t GetBytes() const { return bytes_; }
+
+ private:
+  const BenchOptions &options_;                   ///< 压测参数
+  const std::string &request_;                    ///< 请求包体
+  std::vector<std::atomic<int64_t>> send_times_;  ///< 按令牌记录的发送时间
+  std::atomic<size_t> sent_{0};                   ///< 已发送请求数
+  std::atomic<size_t> outstanding_{0};            ///< 未回应请求数
+  LatencyHistogram histogram_;                    ///< 回应延迟
+  uint64_t errors_{0};                            ///< 错误回应数
+  uint64_t bytes_{0};                             ///< 统计窗口内收到的字节
+};
+
+/// 定速发送
+/// 每个会话按计划时间发送，未回应的请求达到流水线深度时推迟发送，
+/// 推迟的时间计入延迟
+void PaceRequests(const BenchOptions &options,
+                  std::vector<std::unique_ptr<BenchClient>> &clients,
+                  int64_t start) {
+  const double interval = 1e9 / options.rate;
+  while (g_running.load(std::memory_order_relaxed)) {
+    int64_t now = NowNanos();
+    for (size_t i = 0; i < clients.size(); ++i) {
+      BenchClient &client = *clients[i];
+      // 各会话的计划时间错开，避免同时突发
+      int64_t offset = static_cast<int64_t>(interval * i / clients.size());
+      for (;;) {
+        int64_t intended =
+            start + offset + static_cast<int64_t>(interval * client.GetSent());
+        if ((intended > now) ||
+            (client.GetOutstanding() >= options.pipeline)) {
+          break;
+        }
+        client.SendRequest(intended);
+      }
+      client.FlushBatch();
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
+
+/// 解析命令行 --key=value
+///  @param[in]   argc
+///  @param[in]   argv
+///  @param[out]  options     压测参数
+///  @return 成功返回true
+bool ParseOptions(int argc, char *argv[], BenchOptions &options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    size_t pos           = arg.find('=');
+    if (!arg.starts_with("--") || std::string_view::npos == pos) {
+      return false;
+    }
+
+    std::string_view key = arg.substr(2, pos - 2);
+    std::string value(arg.substr(pos + 1));
+    if ("clients" == key) {
+      options.clients = std::stoul(value);
+    } else if ("size" == key) {
+      options.message_size = std::stoul(value);
+    } else if ("pipeline" == key) {
+      options.pipeline = (std::max)(std::stoul(value), 1ul);
+    } else if ("batch" == key) {
+      options.batch = (std::max)(std::stoul(value), 1ul);
+    } else if ("rate" == key) {
+      options.rate = std::stod(value);
+    } else if ("seconds" == key) {
+      options.seconds = std::stod(value);
+    } else if ("warmup" == key) {
+      options.warmup = std::stod(value);
+    } else if ("io" == key) {
+      options.io_threads = std::stoul(value);
+    } else if ("output" == key) {
+      options.output = value;
+    } else if ("label" == key) {
+      options.label = value;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  if (auto error =
+          g_config->Load(_TPN_NET_BENCH_LOADGEN_CONFIG_TEST_FILE, {})) {
+    printf("Error in config file: %s\n", (*error).c_str());
+    return 1;
+  }
+
+  tpn::log::Init();
+  std::shared_ptr<void> log_handle(nullptr,
+                                   [](void *) { tpn::log::Shutdown(); });
+
+  BenchOptions options;
+  if (!ParseOptions(argc, argv, options)) {
+    printf(
+        "usage: %s [--clients=16] [--size=256] [--pipeline=8] [--batch=1] "
+        "[--rate=0] [--seconds=5] [--warmup=1] [--io=0] "
+        "[--output=bench_loadgen.jsonl] [--label=]\n",
+        argv[0]);
+    return 1;
+  }
+  size_t io_threads = options.io_threads > 0
+                          ? options.io_threads
+                          : (std::max)(std::thread::hardware_concurrency(), 1u);
+
+  g_bench_dispatcher.AddService<BenchService>();
+
+  // 服务器在一次拆包分发中产生的回应合为一帧
+  TcpServerOptions server_options;
+  server_options.batch.max_messages = options.batch;
+
+  BenchServer server(io_threads);
+  server.SetServerOptions(server_options);
+  if (!server.Start("127.0.0.1", "9993")) {
+    LOG_ERROR("bench server start error");
+    return 1;
+  }
+
+  protocol::SearchRequest request;
+  request.set_query(std::string(options.message_size, 'q'));
+  request.set_page_number(1);
+  request.set_result_per_page(10);
+  std::string request_data = request.SerializeAsString();
+
+  std::vector<std::unique_ptr<BenchClient>> clients;
+  for (size_t i = 0; i < options.clients; ++i) {
+    auto client = std::make_unique<BenchClient>(options, request_data);
+    if (!client->Start("127.0.0.1", "9993")) {
+      LOG_ERROR("bench client {} connect error", i);
+      break;
+    }
+    clients.emplace_back(std::move(client));
+  }
+
+  std::thread pacer;
+  if (options.rate > 0) {
+    pacer = std::thread(PaceRequests, std::cref(options), std::ref(clients),
+                        NowNanos());
+  }
+
+  std::this_thread::sleep_for(
+      std::chrono::duration<double>(options.warmup));
+
+  auto frames_sent = [&clients]() {
+    size_t frames = 0;
+    for (auto &client : clients) {
+      frames += client->GetBatchFramesSent();
+    }
+    return frames;
+  };
+
+  uint64_t allocations = g_heap_allocations.load();
+  size_t frames        = frames_sent();
+  auto t1              = SteadyClock::now();
+  g_measuring          = true;
+  std::this_thread::sleep_for(
+      std::chrono::duration<double>(options.seconds));
+  g_measuring = false;
+  auto t2     = SteadyClock::now();
+  allocations = g_heap_allocations.load() - allocations;
+  frames      = frames_sent() - frames;
+
+  g_running = false;
+  if (pacer.joinable()) {
+    pacer.join();
+  }
+  for (auto &client : clients) {
+    client->Stop();
+  }
+  server.Stop();
+
+  LatencyHistogram histogram;
+  uint64_t errors = 0;
+  uint64_t bytes  = 0;
+  for (auto &client : clients) {
+    histogram.Merge(client->GetHistogram());
+    errors += client->GetErrors();
+    bytes += client->GetBytes();
+  }
+
+  double elapsed  = std::chrono::duration<double>(t2 - t1).count();
+  uint64_t count  = histogram.GetCount();
+  double msgs     = count / elapsed;
+  double per_msg  = count > 0 ? static_cast<double>(allocations) / count : 0;
+  double mb       = bytes / elapsed / (1024 * 1024);
+  // 回显服务一次分发产生的回应合为一帧，回应帧数与请求帧数相同
+  double frame_rate = frames * 2 / elapsed;
+  auto us         = [](uint64_t ns) { return ns / 1000.0; };
+
+  LOG_INFO(
+      "clients {}/{} size {} pipeline {} batch {} rate {} io {} "
+      "seconds {:.2f}",
+      clients.size(), options.clients, options.message_size, options.pipeline,
+      options.batch, options.rate, io_threads, elapsed);
+  LOG_INFO(
+      "rpc {} rpc/s {:.0f} frames/s {:.0f} response MB/s {:.2f} errors {} "
+      "allocations/rpc {:.2f}",
+      count, msgs, frame_rate, mb, errors, per_msg);
+  for (double percentile : {50.0, 75.0, 90.0, 99.0, 99.9, 99.99, 100.0}) {
+    LOG_INFO("latency p{:<6} {:>10.1f} us", percentile,
+             us(histogram.GetPercentile(percentile)));
+  }
+
+  // 每次运行追加一行，按revision比较不同提交的结果
+  std::string result = fmt::format(
+      "{{\"revision\":\"{}\",\"date\":\"{}\",\"branch\":\"{}\","
+      "\"label\":\"{}\","
+      "\"clients\":{},\"size\":{},\"pipeline\":{},\"batch\":{},"
+      "\"rate\":{},\"io\":{},"
+      "\"seconds\":{:.3f},\"rpc\":{},\"rpc_per_sec\":{:.1f},"
+      "\"frames_per_sec\":{:.1f},\"response_mb_per_sec\":{:.3f},"
+      "\"errors\":{},\"allocations_per_rpc\":{:.3f},"
+      "\"latency_us\":{{\"mean\":{:.1f},\"p50\":{:.1f},\"p90\":{:.1f},"
+      "\"p99\":{:.1f},\"p999\":{:.1f},\"max\":{:.1f}}}}}\n",
+      git::GetHash(), git::GetDate(), git::GetBranch(), options.label,
+      clients.size(),
+      options.message_size, options.pipeline, options.batch, options.rate,
+      io_threads, elapsed, count, msgs, frame_rate, mb, errors, per_msg,
+      histogram.GetMean() / 1000.0, us(histogram.GetPercentile(50)),
+      us(histogram.GetPercentile(90)), us(histogram.GetPercentile(99)),
+      us(histogram.GetPercentile(99.9)), us(histogram.GetMax()));
+  if (FILE *file = std::fopen(options.output.c_str(), "a")) {
+    std::fputs(result.c_str(), file);
+    std::fclose(file);
+  }
+  printf("%s", result.c_str());
+
+  if ((clients.size() != options.clients) || (0 == count) || (errors > 0)) {
+    LOG_ERROR("bench failed");
+    return 1;
+  }
+
+  return 0;
+}
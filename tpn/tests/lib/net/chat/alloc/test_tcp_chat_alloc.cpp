@@ -0,0 +1,209 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "log.h"
+#include "config.h"
+#include "chrono_wrap.h"
+#include "byte_converter.h"
+
+#include "rpc_type.pb.h"
+#include "test_service.pb.h"
+
+#include "net.h"
+
+#include "chat_server.hpp"
+
+#ifndef _TPN_NET_CHAT_ALLOC_CONFIG_TEST_FILE
+#  define _TPN_NET_CHAT_ALLOC_CONFIG_TEST_FILE \
+    "config_net_chat_alloc_test.json"
+#endif
+
+using namespace tpn;
+using namespace tpn::net;
+
+/// 序列化一个聊天请求包
+///  @param[in]   method_id   方法编号
+///  @param[in]   request     请求
+///  @return 消息包
+MessageBuffer MakeChatPacket(uint32_t method_id,
+                             const google::protobuf::Message &request) {
+  protocol::Header header;
+  header.set_service_hash(protocol::TChatService::ServiceHash::value);
+  header.set_method_id(method_id);
+  header.set_size(request.ByteSizeLong());
+
+  uint16_t header_size = (uint16_t)header.ByteSizeLong();
+  EndianRefMakeLittle(header_size);
+
+  MessageBuffer packet(sizeof(header_size) + header.GetCachedSize() +
+                       request.GetCachedSize());
+  packet.Write(&header_size, sizeof(header_size));
+  uint8_t *ptr = packet.GetWritePointer();
+  packet.WriteCompleted(header.GetCachedSize());
+  header.SerializePartialToArray(ptr, header.GetCachedSize());
+  ptr = packet.GetWritePointer();
+  packet.WriteCompleted(request.GetCachedSize());
+  request.SerializeToArray(ptr, request.GetCachedSize());
+  return packet;
+}
+
+/// 聊天客户端，只统计收到的通知数
+class TcpChatAllocClient
+    : public TcpClientBase<TcpChatAllocClient, TemplateArgsTcpClient> {
+ public:
+  using Super = TcpClientBase<TcpChatAllocClient, TemplateArgsTcpClient>;
+
+  using Super::Send;
+  using Super::TcpClientBase;
+
+  void FireRecv(std::shared_ptr<TcpChatAllocClient> &this_ptr,
+                protocol::Header &&header, MessageBuffer &&packet) {
+    if (0 != packet.GetActiveSize()) {
+      ++this->notifies_;
+    }
+  }
+
+  void FireConnect(std::shared_ptr<TcpChatAllocClient> &this_ptr,
+                   std::error_code ec) {
+    protocol::TUpdateInfoRequest request;
+    request.set_name(fmt::format("alloc_{}", reinterpret_cast<size_t>(this)));
+    Send(MakeChatPacket(0x40000001, request));
+    this->joined_ = true;
+  }
+
+  size_t GetNotifies() const { return this->notifies_.load(); }
+
+  bool IsJoined() const { return this->joined_.load(); }
+
+ private:
+  std::atomic<size_t> notifies_{0};  ///< 收到的通知数
+  std::atomic<bool> joined_{false};  ///< 是否已经发送加入请求
+};
+
+/// 每个客户端发送一轮聊天消息，等待所有客户端收到全部通知
+///  @param[in]   clients     客户端
+///  @param[in]   rounds      每个客户端发送的消息数
+///  @param[in]   expected    发送前所有客户端已收到的通知总数
+///  @return 发送后所有客户端收到的通知总数
+size_t ChatRounds(std::vector<std::unique_ptr<TcpChatAllocClient>> &clients,
+                  size_t rounds, size_t expected) {
+  protocol::TChatRequest request;
+  request.set_message("handler allocator steady state");
+
+  auto total = [&clients]() {
+    size_t count = 0;
+    for (auto &client : clients) {
+      count += client->GetNotifies();
+    }
+    return count;
+  };
+
+  for (size_t i = 0; i < rounds; ++i) {
+    for (auto &client : clients) {
+      client->Send(MakeChatPacket(0x40000002, request));
+    }
+
+    // 每轮等通知送达，使在途的异步操作数与预热时一致
+    expected += clients.size() * clients.size();
+    auto t1 = SteadyClock::now();
+    while (total() < expected &&
+           SteadyClock::now() - t1 < std::chrono::seconds(10)) {
+      std::this_thread::sleep_for(100us);
+    }
+  }
+  return total();
+}
+
+int main(int argc, char *argv[]) {
+  if (auto error = g_config->Load(_TPN_NET_CHAT_ALLOC_CONFIG_TEST_FILE, {})) {
+    printf("Error in config file: %s\n", (*error).c_str());
+    return 1;
+  }
+
+  tpn::log::Init();
+  std::shared_ptr<void> log_handle(nullptr,
+                                   [](void *) { tpn::log::Shutdown(); });
+
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+  std::shared_ptr<void> protobuf_handle(
+      nullptr, [](void *) { google::protobuf::ShutdownProtobufLibrary(); });
+
+  size_t count  = argc > 1 ? std::stoul(argv[1]) : 8;
+  size_t rounds = argc > 2 ? std::stoul(argv[2]) : 200;
+
+  test::TcpChatServer server;
+  if (!server.Start("127.0.0.1", "9997")) {
+    LOG_ERROR("chat alloc server start error");
+    return 1;
+  }
+
+  std::vector<std::unique_ptr<TcpChatAllocClient>> clients;
+  for (size_t i = 0; i < count; ++i) {
+    auto &client = clients.emplace_back(std::make_unique<TcpChatAllocClient>());
+    client->Start("127.0.0.1", "9997");
+  }
+
+  auto t1 = SteadyClock::now();
+  while (SteadyClock::now() - t1 < std::chrono::seconds(10) &&
+         !std::all_of(clients.begin(), clients.end(),
+                      [](auto &client) { return client->IsJoined(); })) {
+    std::this_thread::sleep_for(1ms);
+  }
+  // 等加入请求处理完
+  std::this_thread::sleep_for(100ms);
+
+  // 预热：填满各会话的处理程序槽位与各线程的缓存
+  size_t notifies = ChatRounds(clients, rounds, 0);
+
+  HandlerAllocStats before = HandlerCache::GetStats();
+  size_t expected = notifies + rounds * count * count;
+  notifies        = ChatRounds(clients, rounds, notifies);
+  HandlerAllocStats after = HandlerCache::GetStats();
+
+  size_t heap_allocations =
+      after.heap_allocations - before.heap_allocations;
+  LOG_INFO(
+      "Chat clients {} rounds {} notifies {}/{} handler heap allocations "
+      "warm up {} steady state {}",
+      count, rounds, notifies, expected, before.heap_allocations,
+      heap_allocations);
+
+  for (auto &client : clients) {
+    client->Stop();
+  }
+  server.Stop();
+
+  if (notifies != expected || 0 != heap_allocations) {
+    LOG_ERROR("Chat alloc test failed");
+    return 1;
+  }
+
+  return 0;
+}
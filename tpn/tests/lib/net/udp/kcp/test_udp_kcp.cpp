@@ -0,0 +1,312 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <atomic>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "log.h"
+#include "config.h"
+#include "chrono_wrap.h"
+#include "byte_converter.h"
+#include "random_hub.h"
+
+#include "net.h"
+
+#ifndef _TPN_NET_UDP_KCP_CONFIG_TEST_FILE
+#  define _TPN_NET_UDP_KCP_CONFIG_TEST_FILE "config_net_udp_kcp_test.json"
+#endif
+
+using namespace tpn;
+using namespace tpn::net;
+
+/// 模拟丢包率(百分比)
+static std::atomic<uint32_t> s_loss_percent{0};
+
+/// 按模拟丢包率判断是否丢弃数据报
+static bool ShouldDrop() { return RandU32() % 100 < s_loss_percent.load(); }
+
+/// 组装 [u16 协议头长度][协议头][协议体] 格式的数据包
+///  @param[in]   body      协议体
+///  @param[in]   size      协议体长度
+///  @return 数据包
+static MessageBuffer MakePacket(const uint8_t *body, size_t size) {
+  protocol::Header header;
+  header.set_size(static_cast<uint32_t>(size));
+
+  uint16_t header_size = (uint16_t)header.ByteSizeLong();
+  EndianRefMakeLittle(header_size);
+
+  MessageBuffer packet(sizeof(header_size) + header.GetCachedSize() + size);
+  packet.Write(&header_size, sizeof(header_size));
+  uint8_t *ptr = packet.GetWritePointer();
+  packet.WriteCompleted(header.GetCachedSize());
+  header.SerializePartialToArray(ptr, header.GetCachedSize());
+  packet.Write(body, size);
+  return packet;
+}
+
+/// 两个kcp对象通过内存中的有损链路通信，检查消息完整有序到达
+///  @param[in]   loss_percent  丢包率
+///  @param[in]   count         消息数
+///  @return 成功返回true
+bool KcpCoreTest(uint32_t loss_percent, uint32_t count) {
+  std::deque<std::string> link_ab, link_ba;
+
+  Kcp a(0x1234, [&](const uint8_t *data, size_t size) {
+    if (RandU32() % 100 >= loss_percent) {
+      link_ab.emplace_back(reinterpret_cast<const char *>(data), size);
+    }
+  });
+  Kcp b(0x1234, [&](const uint8_t *data, size_t size) {
+    if (RandU32() % 100 >= loss_percent) {
+      link_ba.emplace_back(reinterpret_cast<const char *>(data), size);
+    }
+  });
+
+  // 与 KcpStream 相同的快速模式
+  a.SetOptions(KcpOptions{});
+  b.SetOptions(KcpOptions{});
+
+  uint32_t sent = 0, recvd = 0, current = 0;
+  MessageBuffer buffer;
+  while (recvd < count && current < 600000) {
+    // 每个时钟周期发送若干条长度不一的消息，包含需要分片的大消息
+    for (int i = 0; i < 4 && sent < count && a.GetWaitSend() < 256; ++i) {
+      std::string msg(8 + (sent * 37) % 3000, static_cast<char>(sent));
+      std::memcpy(msg.data(), &sent, sizeof(sent));
+      if (!a.Send(reinterpret_cast<const uint8_t *>(msg.data()), msg.size())) {
+        LOG_ERROR("Kcp core send {} error", sent);
+        return false;
+      }
+      ++sent;
+    }
+
+    a.Update(current);
+    b.Update(current);
+
+    while (!link_ab.empty()) {
+      b.Input(reinterpret_cast<const uint8_t *>(link_ab.front().data()),
+              link_ab.front().size(), current);
+      link_ab.pop_front();
+    }
+    while (!link_ba.empty()) {
+      a.Input(reinterpret_cast<const uint8_t *>(link_ba.front().data()),
+              link_ba.front().size(), current);
+      link_ba.pop_front();
+    }
+
+    while (b.Recv(buffer)) {
+      uint32_t seq = 0;
+      std::memcpy(&seq, buffer.GetReadPointer(), sizeof(seq));
+      if (seq != recvd || buffer.GetActiveSize() != 8 + (seq * 37) % 3000) {
+        LOG_ERROR("Kcp core recv seq {} size {} expect {}", seq,
+                  buffer.GetActiveSize(), recvd);
+        return false;
+      }
+      ++recvd;
+    }
+
+    current += 10;
+  }
+
+  LOG_INFO("Kcp core loss {}% messages {}/{} cost {}ms srtt {}ms retransmit {}",
+           loss_percent, recvd, count, current, a.GetSrtt(),
+           a.GetRetransmit());
+  return recvd == count;
+}
+
+/// 回显会话，按模拟丢包率丢弃收到的数据报
+class UdpSessionEcho
+    : public UdpSessionBase<UdpSessionEcho, TemplateArgsUdpSession> {
+ public:
+  using Super = UdpSessionBase<UdpSessionEcho, TemplateArgsUdpSession>;
+  using Super::Super;
+
+  void KcpHandleDatagram(const uint8_t *data, size_t size,
+                         std::shared_ptr<UdpSessionEcho> &this_ptr) {
+    if (!ShouldDrop()) {
+      Super::KcpHandleDatagram(data, size, this_ptr);
+    }
+  }
+
+  void FireRecv(std::shared_ptr<UdpSessionEcho> &this_ptr,
+                protocol::Header &&header, MessageBuffer &&packet) {
+    Send(MakePacket(packet.GetReadPointer(), packet.GetActiveSize()));
+  }
+};
+
+/// 测量往返延迟的客户端，按模拟丢包率丢弃收到的数据报
+class UdpClientTest
+    : public UdpClientBase<UdpClientTest, TemplateArgsUdpClient> {
+ public:
+  using Super = UdpClientBase<UdpClientTest, TemplateArgsUdpClient>;
+  using Super::Super;
+
+  void KcpHandleDatagram(const uint8_t *data, size_t size,
+                         std::shared_ptr<UdpClientTest> &this_ptr) {
+    if (!ShouldDrop()) {
+      Super::KcpHandleDatagram(data, size, this_ptr);
+    }
+  }
+
+  void FireConnect(std::shared_ptr<UdpClientTest> &this_ptr,
+                   std::error_code ec) {
+    if (!ec) {
+      SendNext();
+    }
+  }
+
+  void FireRecv(std::shared_ptr<UdpClientTest> &this_ptr,
+                protocol::Header &&header, MessageBuffer &&packet) {
+    uint32_t seq = 0;
+    if (packet.GetActiveSize() < sizeof(seq)) {
+      error_ = true;
+      return;
+    }
+    std::memcpy(&seq, packet.GetReadPointer(), sizeof(seq));
+    if (seq != seq_ || packet.GetActiveSize() != PayloadSize(seq)) {
+      LOG_ERROR("UdpClientTest recv seq {} size {} expect {}", seq,
+                packet.GetActiveSize(), seq_);
+      error_ = true;
+      return;
+    }
+
+    auto rtt = std::chrono::duration_cast<MicroSeconds>(SteadyClock::now() -
+                                                        send_time_);
+    total_rtt_ += rtt.count();
+    max_rtt_ = (std::max)(max_rtt_, static_cast<int64_t>(rtt.count()));
+
+    if (++seq_ >= count_) {
+      done_ = true;
+      return;
+    }
+    SendNext();
+  }
+
+  /// 每条消息的长度，部分消息超过mtu需要分片
+  static size_t PayloadSize(uint32_t seq) { return 8 + (seq * 131) % 4000; }
+
+  void SendNext() {
+    std::string msg(PayloadSize(seq_), 'k');
+    std::memcpy(msg.data(), &seq_, sizeof(seq_));
+    send_time_ = SteadyClock::now();
+    Send(MakePacket(reinterpret_cast<const uint8_t *>(msg.data()),
+                    msg.size()));
+  }
+
+  uint32_t count_{0};
+  uint32_t seq_{0};
+  std::atomic<bool> done_{false};
+  std::atomic<bool> error_{false};
+  SteadyClock::time_point send_time_;
+  int64_t total_rtt_{0};
+  int64_t max_rtt_{0};
+};
+
+/// 回环地址上的kcp回显测试
+///  @param[in]   port          监听端口
+///  @param[in]   loss_percent  丢包率
+///  @param[in]   count         往返次数
+///  @return 成功返回true
+bool KcpEchoTest(std::string_view port, uint32_t loss_percent, uint32_t count) {
+  s_loss_percent = loss_percent;
+
+  UdpServerBridge<UdpSessionEcho> server(1);
+  if (!server.Start("127.0.0.1", port)) {
+    LOG_ERROR("Udp server start error {}", GetLastError());
+    return false;
+  }
+
+  UdpClientTest client;
+  client.count_ = count;
+  if (!client.Start("127.0.0.1", port)) {
+    LOG_ERROR("Udp client start error {}", GetLastError());
+    server.Stop();
+    return false;
+  }
+
+  auto t1 = SteadyClock::now();
+  while (!client.done_ && !client.error_ &&
+         SteadyClock::now() - t1 < std::chrono::seconds(30)) {
+    std::this_thread::sleep_for(1ms);
+  }
+  auto cost =
+      std::chrono::duration_cast<MilliSeconds>(SteadyClock::now() - t1);
+
+  bool ok = client.done_ && !client.error_;
+  LOG_INFO(
+      "Kcp echo loss {}% round trips {}/{} cost {}ms avg rtt {}us max rtt {}us "
+      "sessions {}",
+      loss_percent, client.seq_, count, cost.count(),
+      client.seq_ ? client.total_rtt_ / client.seq_ : 0, client.max_rtt_,
+      server.GetSessionCount());
+
+  client.Stop();
+
+  // 客户端关闭时通知服务器释放会话
+  t1 = SteadyClock::now();
+  while (0 != server.GetSessionCount() &&
+         SteadyClock::now() - t1 < std::chrono::seconds(5)) {
+    std::this_thread::sleep_for(1ms);
+  }
+  if (0 != server.GetSessionCount()) {
+    LOG_ERROR("Udp server session not released {}", server.GetSessionCount());
+    ok = false;
+  }
+
+  server.Stop();
+  s_loss_percent = 0;
+  return ok;
+}
+
+int main(int argc, char *argv[]) {
+  if (auto error = g_config->Load(_TPN_NET_UDP_KCP_CONFIG_TEST_FILE, {})) {
+    printf("Error in config file: %s\n", (*error).c_str());
+    return 1;
+  }
+
+  tpn::log::Init();
+  std::shared_ptr<void> log_handle(nullptr,
+                                   [](void *) { tpn::log::Shutdown(); });
+
+  uint32_t count = argc > 1 ? std::stoul(argv[1]) : 1000;
+
+  int result = 0;
+  for (uint32_t loss : {0u, 10u, 30u}) {
+    if (!KcpCoreTest(loss, count)) {
+      LOG_ERROR("Kcp core test loss {}% failed", loss);
+      result = 1;
+    }
+  }
+
+  for (uint32_t loss : {0u, 5u}) {
+    if (!KcpEchoTest("9994", loss, count)) {
+      LOG_ERROR("Kcp echo test loss {}% failed", loss);
+      result = 1;
+    }
+  }
+
+  return result;
+}
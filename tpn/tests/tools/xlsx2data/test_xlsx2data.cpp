@@ -0,0 +1,199 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "../../test_include.h"
+
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/unknown_field_set.h>
+
+#include "log.h"
+#include "config.h"
+#include "fmt_wrap.h"
+
+#include "generator_hub.h"
+#include "bin_generator.h"
+#include "analyst.h"
+#include "flat_data.h"
+
+#ifndef _TPN_XLSX2DATA_CONFIG_TEST_FILE
+#  define _TPN_XLSX2DATA_CONFIG_TEST_FILE "config_xlsx2data_test.json"
+#endif
+
+#ifndef _TPN_XLSX2DATA_TEST_DATA_DIR
+#  define _TPN_XLSX2DATA_TEST_DATA_DIR "xlsx2data/data"
+#endif
+
+#ifndef _TPN_XLSX2DATA_TEST_OUTPUT_DIR
+#  define _TPN_XLSX2DATA_TEST_OUTPUT_DIR "."
+#endif
+
+namespace {
+
+/// 加载测试配置
+/// 配置中的输出目录是相对路径, 先切到构建目录, 避免写到源码树等任意工作目录下
+bool LoadTestConfig() {
+  std::error_code ec;
+  std::filesystem::current_path(_TPN_XLSX2DATA_TEST_OUTPUT_DIR, ec);
+  if (ec) {
+    fmt::print(stderr, "Error in output dir {}, error {}\n",
+               _TPN_XLSX2DATA_TEST_OUTPUT_DIR, ec.message());
+    return false;
+  }
+
+  if (auto error = g_config->Load(_TPN_XLSX2DATA_CONFIG_TEST_FILE, {})) {
+    fmt::print(stderr, "Error in config file {}, error {}\n",
+               _TPN_XLSX2DATA_CONFIG_TEST_FILE, *error);
+    return false;
+  }
+
+  return true;
+}
+
+std::string ReadBinFile() {
+  std::string path =
+      fmt::format("{}/{}.bin", g_config->GetStringDefault("xlsx_bin_dir", ""),
+                  g_config->GetStringDefault("xlsx_file_prefix", "data_hub"));
+  std::ifstream ifs(path, std::ios::in | std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(ifs),
+                     std::istreambuf_iterator<char>());
+}
+
+}  // namespace
+
+TEST_CASE("xlsx2data integer cell", "xlsx2data") {
+  if (!LoadTestConfig()) {
+    return;
+  }
+
+  tpn::log::Init();
+  std::shared_ptr<void> log_handle(nullptr,
+                                   [](void *) { tpn::log::Shutdown(); });
+
+  tpn::FlatDataWriter writer;
+  uint8_t row[8] = {};
+
+  // 超出范围或带有多余字符的单元格报错，不截断
+  tpn::xlsx::AnalystField i32_field;
+  REQUIRE(i32_field.Analyze("value@i32"));
+  REQUIRE(i32_field.GenerateFlatData(writer, row, "2147483647"));
+  REQUIRE(i32_field.GenerateFlatData(writer, row, "-2147483648"));
+  REQUIRE_FALSE(i32_field.GenerateFlatData(writer, row, "2147483648"));
+  REQUIRE_FALSE(i32_field.GenerateFlatData(writer, row, "-2147483649"));
+  REQUIRE_FALSE(i32_field.GenerateFlatData(writer, row, "12abc"));
+
+  // 无符号类型不接受负数回绕
+  tpn::xlsx::AnalystField u32_field;
+  REQUIRE(u32_field.Analyze("value@u32"));
+  REQUIRE(u32_field.GenerateFlatData(writer, row, "4294967295"));
+  REQUIRE_FALSE(u32_field.GenerateFlatData(writer, row, "-1"));
+  REQUIRE_FALSE(u32_field.GenerateFlatData(writer, row, "4294967296"));
+}
+
+TEST_CASE("xlsx2data new sheet", "xlsx2data") {
+  if (!LoadTestConfig()) {
+    return;
+  }
+
+  tpn::log::Init();
+  std::shared_ptr<void> log_handle(nullptr,
+                                   [](void *) { tpn::log::Shutdown(); });
+
+  // 工具编译时的data_hub.pb中没有这张表
+  REQUIRE(nullptr ==
+          google::protobuf::DescriptorPool::generated_pool()
+              ->FindMessageTypeByName("tpn.data.DataHubEntryFresh"));
+
+  auto data_dir = std::filesystem::path("xlsx2data_test/fresh_data");
+  std::filesystem::create_directories(data_dir);
+  {
+    xlnt::workbook workbook;
+    auto sheet = workbook.active_sheet();
+    sheet.title("@Fresh");
+    sheet.cell("A1").value("id@u32@!");
+    sheet.cell("B1").value("score@i64@*");
+    sheet.cell("C1").value("name@str@*");
+    sheet.cell("A2").value("id");
+    sheet.cell("B2").value("score");
+    sheet.cell("C2").value("name");
+    sheet.cell("A3").value("1");
+    sheet.cell("B3").value("-5");
+    sheet.cell("C3").value("first");
+    sheet.cell("A4").value("2");
+    sheet.cell("B4").value("7");
+    sheet.cell("C4").value("second");
+    workbook.save((data_dir / "fresh.xlsx").generic_string());
+  }
+
+  // 新表直接生成bin 不需要先用新的data_hub.pb重新编译工具
+  std::string error;
+  REQUIRE(g_xlsx2data_generator->Load(data_dir.generic_string(), error));
+  REQUIRE(g_xlsx2data_generator->Generate());
+
+  tpn::data::DataHubMap data_map;
+  REQUIRE(data_map.ParseFromString(ReadBinFile()));
+  REQUIRE(1 == data_map.datas().count("fresh"));
+  auto &any = data_map.datas().at("fresh");
+  REQUIRE(any.type_url() == "type.googleapis.com/tpn.data.DataHubEntryFresh");
+
+  // 按线格式检查 datas = 1 中每行的 id = 1
+  google::protobuf::UnknownFieldSet entry;
+  REQUIRE(entry.ParseFromString(any.value()));
+  REQUIRE(2 == entry.field_count());
+  for (int i = 0; i < entry.field_count(); ++i) {
+    REQUIRE(1 == entry.field(i).number());
+    google::protobuf::UnknownFieldSet row;
+    REQUIRE(row.ParseFromString(entry.field(i).length_delimited()));
+    REQUIRE(row.field_count() > 0);
+    REQUIRE(1 == row.field(0).number());
+    REQUIRE(static_cast<uint64_t>(i + 1) == row.field(0).varint());
+  }
+
+  std::filesystem::remove_all(data_dir);
+}
+
+TEST_CASE("xlsx2data bin direct", "xlsx2data") {
+  if (!LoadTestConfig()) {
+    return;
+  }
+
+  tpn::log::Init();
+  std::shared_ptr<void> log_handle(nullptr,
+                                   [](void *) { tpn::log::Shutdown(); });
+
+  // 直接由单元格反射生成 bin
+  std::string error;
+  REQUIRE(g_xlsx2data_generator->Load(_TPN_XLSX2DATA_TEST_DATA_DIR, error));
+  REQUIRE(g_xlsx2data_generator->Generate());
+  std::string direct_bin = ReadBinFile();
+  REQUIRE_FALSE(direct_bin.empty());
+
+  // 旧路径由 json 生成 bin, 会关闭 protobuf 库, 必须最后执行
+  tpn::xlsx::BinGenerator bin_gen;
+  REQUIRE(bin_gen.Generate());
+  std::string json_bin = ReadBinFile();
+  REQUIRE(direct_bin == json_bin);
+}
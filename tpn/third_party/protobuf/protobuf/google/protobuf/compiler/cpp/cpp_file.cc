@@ -1421,6 +1421,7 @@ void FileGenerator::GeneratePGTSourceInclude(io::Printer *printer) {
   if (file_->service_count() > 0) {
     printer->Print("#include \"log.h\"\n");
     printer->Print("#include \"debug_hub.h\"\n");
+    printer->Print("#include \"service_arena.h\"\n");
   }
 }
 
@@ -33,6 +33,10 @@
 //  Sanjay Ghemawat, Jeff Dean, and others.
 
 #include <google/protobuf/compiler/cpp/cpp_service.h>
+
+#include <algorithm>
+#include <vector>
+
 #include <google/protobuf/compiler/cpp/cpp_helpers.h>
 #include <google/protobuf/compiler/cpp/cpp_options.h>
 #include <google/protobuf/io/printer.h>
@@ -136,9 +140,19 @@ void ServiceGenerator::GenerateInterface(io::Printer *printer) {
 
   printer->Outdent();
 
+  printer->Print("\n"
+                 " private:\n");
+
+  if (!descriptor_->options().HasExtension(tpn::protocol::service_options) ||
+      descriptor_->options()
+          .GetExtension(tpn::protocol::service_options)
+          .outbound()) {
+    printer->Indent();
+    GenerateServerMethodTableDeclarations(printer);
+    printer->Outdent();
+  }
+
   printer->Print(vars_,
-                 "\n"
-                 " private:\n"
                  "  uint32_t service_hash_{0};\n"
                  "\n"
                  "  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS($classname$);\n"
@@ -229,10 +243,8 @@ void ServiceGenerator::GenerateServerMethodSignatures(io::Printer *printer) {
       printer->Print(
           sub_vars,
           "virtual ::tpn::protocol::ErrorCode Handle$name$(const $input_type$ "
-          "*request, "
-          "$output_type$ *response, std::function<void(ServiceBase*, "
-          "::tpn::protocol::ErrorCode, "
-          "const ::google::protobuf::Message *)> &continuation);\n");
+          "*request, $output_type$ *response, "
+          "::tpn::ServiceContinuation<$output_type$> &continuation);\n");
     } else {
       printer->Print(sub_vars,
                      "virtual ::tpn::protocol::ErrorCode Handle$name$(const "
@@ -295,95 +307,223 @@ void ServiceGenerator::GenerateClientMethodImplementations(
   }
 }
 
-void ServiceGenerator::GenerateServerCallMethod(io::Printer *printer) {
-  printer->Print(vars_,
-                 "void $classname$::CallServerMethod(uint32_t token, uint32_t "
-                 "method_id, MessageBuffer buffer) {\n"
-                 "  switch(method_id & 0x3FFFFFFF) {\n");
+void ServiceGenerator::GenerateServerMethodTableDeclarations(
+    io::Printer *printer) {
+  std::map<std::string, std::string> sub_vars;
+  sub_vars["classname"]  = vars_["classname"];
+  sub_vars["table_size"] = SimpleItoa(GetServerMethodTableSize());
 
-  for (int i = 0; i < descriptor_->method_count(); i++) {
+  printer->Print(
+      sub_vars,
+      "// server method table "
+      "----------------------------------------------\n"
+      "using ServerMethod = void (*)($classname$ *self, uint32_t token, "
+      "uint32_t method_id, MessageBuffer &buffer);\n"
+      "\n"
+      "struct ServerMethodEntry {\n"
+      "  uint32_t method_id;\n"
+      "  ServerMethod method;\n"
+      "};\n"
+      "\n"
+      "static constexpr uint32_t kServerMethodTableSize = $table_size$;\n"
+      "static const ServerMethodEntry "
+      "kServerMethods[kServerMethodTableSize];\n"
+      "\n");
+
+  for (int i = 0; i < descriptor_->method_count(); ++i) {
     const MethodDescriptor *method = descriptor_->method(i);
     if (!method->options().HasExtension(tpn::protocol::method_options)) {
       continue;
     }
-    std::map<std::string, std::string> sub_vars;
-    sub_vars["classname"] = vars_["classname"];
-    sub_vars["name"]      = method->name();
-    sub_vars["full_name"] = descriptor_->name() + "." + method->name();
-    sub_vars["method_id"] = SimpleItoa(
-        method->options().GetExtension(tpn::protocol::method_options).id());
-    sub_vars["input_type"]       = ClassName(method->input_type(), true);
-    sub_vars["output_type"]      = ClassName(method->output_type(), true);
-    sub_vars["input_type_name"]  = method->input_type()->full_name();
-    sub_vars["output_type_name"] = method->output_type()->full_name();
 
-    printer->Print(sub_vars,
-                   "    case $method_id$: {\n"
-                   "      $input_type$ request;\n"
-                   "      if (!request.ParseFromArray(buffer.GetReadPointer(), "
-                   "buffer.GetActiveSize())) {\n"
-                   "        LOG_DEBUG(\"{} Failed to parse request for "
-                   "$full_name$ server method call.\", GetCallerInfo());\n"
-                   "        SendResponse(service_hash_, method_id, token, "
-                   "kErrorCodeMalformedRequest);\n"
-                   "        return;\n"
-                   "      }\n");
+    sub_vars["name"]        = method->name();
+    sub_vars["output_type"] = ClassName(method->output_type(), true);
 
+    printer->Print(sub_vars,
+                   "static void ServerCall$name$($classname$ *self, uint32_t "
+                   "token, uint32_t method_id, MessageBuffer &buffer);\n");
     if ("NoResponse" != method->output_type()->name()) {
       printer->Print(
           sub_vars,
-          "      LOG_DEBUG(\"{} Client called server method "
-          "$full_name$($input_type_name${{ {} }}).\", GetCallerInfo(), "
-          "request.ShortDebugString());\n"
-          "      std::function<void(ServiceBase*, ::tpn::protocol::ErrorCode, "
-          "const ::google::protobuf::Message *)> continuation = [token, "
-          "method_id](ServiceBase *service, ::tpn::protocol::ErrorCode status, "
-          "const ::google::protobuf::Message *response) {\n"
-          "        TPN_ASSERT(response->GetDescriptor() == "
-          "$output_type$::descriptor(), \"response descriptor error {} != "
-          "{}\", response->GetDescriptor()->DebugString(), "
-          "$output_type$::descriptor()->DebugString());\n"
-          "        $classname$* self = static_cast<$classname$*>(service);\n"
-          "        LOG_DEBUG(\"{} Client called server method $full_name$() "
-          "returned $output_type_name${{ {} }} status {}.\", "
-          "self->GetCallerInfo(), response->ShortDebugString(), status);\n"
-          "        if (kErrorCodeOk == status)\n"
-          "          self->SendResponse(self->service_hash_, method_id, token, "
-          "response);\n"
-          "        else\n"
-          "          self->SendResponse(self->service_hash_, method_id, token, "
-          "status);\n"
-          "      };\n"
-          "      $output_type$ response;\n"
-          "      ::tpn::protocol::ErrorCode status = Handle$name$(&request, "
-          "&response, continuation);\n"
-          "      if (continuation)\n"
-          "        continuation(this, status, &response);\n");
-    } else {
-      printer->Print(
-          sub_vars,
-          "      ::tpn::protocol::ErrorCode status = Handle$name$(&request);\n"
-          "      LOG_DEBUG(\"{} Client called server "
-          "method $full_name$($input_type_name${{ {} }}) status {}.\", "
-          "GetCallerInfo(), request.ShortDebugString(), status);\n"
-          "      if (kErrorCodeOk != status)\n"
-          "        SendResponse(service_hash_, method_id, token, status);\n");
+          "static void ServerContinue$name$(ServiceBase *service, uint32_t "
+          "token, uint32_t method_id, ::tpn::ServiceArena *arena, "
+          "::tpn::protocol::ErrorCode status, const $output_type$ "
+          "*response);\n");
+    }
+  }
+
+  printer->Print("\n");
+}
+
+void ServiceGenerator::GenerateServerCallMethod(io::Printer *printer) {
+  // 方法表按 method_id % kServerMethodTableSize 完美散列，表在编译期初始化，
+  // 分发是一次取模和一次间接调用
+  std::vector<const MethodDescriptor *> table(GetServerMethodTableSize(),
+                                              nullptr);
+  for (int i = 0; i < descriptor_->method_count(); i++) {
+    const MethodDescriptor *method = descriptor_->method(i);
+    if (!method->options().HasExtension(tpn::protocol::method_options)) {
+      continue;
+    }
+    table[GetServerMethodId(method) % table.size()] = method;
+  }
+
+  printer->Print(vars_,
+                 "constexpr $classname$::ServerMethodEntry "
+                 "$classname$::kServerMethods[kServerMethodTableSize] = {\n");
+  for (const MethodDescriptor *method : table) {
+    if (nullptr == method) {
+      printer->Print("  {0, nullptr},\n");
+      continue;
     }
 
+    std::map<std::string, std::string> sub_vars;
+    sub_vars["classname"] = vars_["classname"];
+    sub_vars["name"]      = method->name();
+    sub_vars["method_id"] = SimpleItoa(GetServerMethodId(method));
     printer->Print(sub_vars,
-                   "      break;\n"
-                   "    }\n");
+                   "  {$method_id$, &$classname$::ServerCall$name$},\n");
   }
+  printer->Print("};\n"
+                 "\n");
 
   printer->Print(vars_,
-                 "    default:\n"
-                 "      LOG_ERROR(\"Bad method id {}.\", method_id);\n"
-                 "      SendResponse(service_hash_, method_id, token, "
+                 "void $classname$::CallServerMethod(uint32_t token, uint32_t "
+                 "method_id, MessageBuffer buffer) {\n"
+                 "  const ServerMethodEntry &entry = kServerMethods[(method_id "
+                 "& 0x3FFFFFFF) % kServerMethodTableSize];\n"
+                 "  if (nullptr != entry.method && entry.method_id == "
+                 "(method_id & 0x3FFFFFFF)) {\n"
+                 "    entry.method(this, token, method_id, buffer);\n"
+                 "    return;\n"
+                 "  }\n"
+                 "  LOG_ERROR(\"Bad method id {}.\", method_id);\n"
+                 "  SendResponse(service_hash_, method_id, token, "
                  "kErrorCodeInvalidMethod);\n"
-                 "      break;\n"
-                 "    }\n"
                  "}\n"
                  "\n");
+
+  for (int i = 0; i < descriptor_->method_count(); i++) {
+    const MethodDescriptor *method = descriptor_->method(i);
+    if (!method->options().HasExtension(tpn::protocol::method_options)) {
+      continue;
+    }
+
+    GenerateServerCallImplementation(printer, method);
+  }
+}
+
+void ServiceGenerator::GenerateServerCallImplementation(
+    io::Printer *printer, const MethodDescriptor *method) {
+  // arena模式下请求、回应在线程缓存的arena上创建，
+  // continuation只带arena指针，回应发出后释放引用，arena整体重置
+  const bool arena =
+      descriptor_->options().HasExtension(tpn::protocol::service_options) &&
+      descriptor_->options()
+          .GetExtension(tpn::protocol::service_options)
+          .arena();
+
+  std::map<std::string, std::string> sub_vars;
+  sub_vars["classname"]        = vars_["classname"];
+  sub_vars["name"]             = method->name();
+  sub_vars["full_name"]        = descriptor_->name() + "." + method->name();
+  sub_vars["input_type"]       = ClassName(method->input_type(), true);
+  sub_vars["output_type"]      = ClassName(method->output_type(), true);
+  sub_vars["input_type_name"]  = method->input_type()->full_name();
+  sub_vars["output_type_name"] = method->output_type()->full_name();
+  if (arena) {
+    sub_vars["request_decl"] =
+        "  ::tpn::ServiceArena *arena = ::tpn::ServiceArena::Acquire();\n"
+        "  " +
+        sub_vars["input_type"] + " *request = arena->CreateMessage<" +
+        sub_vars["input_type"] + ">();\n";
+    sub_vars["response_decl"] = "  " + sub_vars["output_type"] +
+                                " *response = arena->CreateMessage<" +
+                                sub_vars["output_type"] + ">();\n";
+    sub_vars["request"]        = "request";
+    sub_vars["request_member"] = "request->";
+    sub_vars["response"]       = "response";
+    sub_vars["arena"]          = "arena";
+    sub_vars["arena_param"]    = "arena";
+  } else {
+    sub_vars["request_decl"]   = "  " + sub_vars["input_type"] + " request;\n";
+    sub_vars["response_decl"] = "  " + sub_vars["output_type"] + " response;\n";
+    sub_vars["request"]        = "&request";
+    sub_vars["request_member"] = "request.";
+    sub_vars["response"]       = "&response";
+    sub_vars["arena"]          = "nullptr";
+    sub_vars["arena_param"]    = "/*arena*/";
+  }
+
+  printer->Print(sub_vars,
+                 "void $classname$::ServerCall$name$($classname$ *self, "
+                 "uint32_t token, uint32_t method_id, MessageBuffer &buffer) "
+                 "{\n"
+                 "$request_decl$"
+                 "  if (!$request_member$ParseFromArray("
+                 "buffer.GetReadPointer(), buffer.GetActiveSize())) {\n");
+  if (arena) {
+    printer->Print("    arena->Release();\n");
+  }
+  printer->Print(sub_vars,
+                 "    LOG_DEBUG(\"{} Failed to parse request for "
+                 "$full_name$ server method call.\", self->GetCallerInfo());\n"
+                 "    self->SendResponse(self->service_hash_, method_id, "
+                 "token, kErrorCodeMalformedRequest);\n"
+                 "    return;\n"
+                 "  }\n");
+
+  if ("NoResponse" != method->output_type()->name()) {
+    printer->Print(
+        sub_vars,
+        "  LOG_DEBUG(\"{} Client called server method "
+        "$full_name$($input_type_name${{ {} }}).\", self->GetCallerInfo(), "
+        "$request_member$ShortDebugString());\n"
+        "$response_decl$"
+        "  ::tpn::ServiceContinuation<$output_type$> continuation("
+        "&$classname$::ServerContinue$name$, token, method_id, $arena$);\n"
+        "  ::tpn::protocol::ErrorCode status = self->Handle$name$($request$, "
+        "$response$, continuation);\n"
+        "  if (continuation)\n"
+        "    continuation(self, status, $response$);\n"
+        "}\n"
+        "\n"
+        "void $classname$::ServerContinue$name$(ServiceBase *service, "
+        "uint32_t token, uint32_t method_id, ::tpn::ServiceArena "
+        "*$arena_param$, ::tpn::protocol::ErrorCode status, const "
+        "$output_type$ *response) {\n"
+        "  $classname$ *self = static_cast<$classname$ *>(service);\n"
+        "  LOG_DEBUG(\"{} Client called server method $full_name$() "
+        "returned $output_type_name${{ {} }} status {}.\", "
+        "self->GetCallerInfo(), response->ShortDebugString(), status);\n"
+        "  if (kErrorCodeOk == status)\n"
+        "    self->SendResponse(self->service_hash_, method_id, token, "
+        "response);\n"
+        "  else\n"
+        "    self->SendResponse(self->service_hash_, method_id, token, "
+        "status);\n");
+    if (arena) {
+      printer->Print("  arena->Release();\n");
+    }
+  } else {
+    printer->Print(
+        sub_vars,
+        "  ::tpn::protocol::ErrorCode status = self->Handle$name$($request$);\n"
+        "  LOG_DEBUG(\"{} Client called server "
+        "method $full_name$($input_type_name${{ {} }}) status {}.\", "
+        "self->GetCallerInfo(), $request_member$ShortDebugString(), "
+        "status);\n");
+    if (arena) {
+      printer->Print("  arena->Release();\n");
+    }
+    printer->Print(
+        "  if (kErrorCodeOk != status)\n"
+        "    self->SendResponse(self->service_hash_, method_id, token, "
+        "status);\n");
+  }
+
+  printer->Print("}\n"
+                 "\n");
 }
 
 void ServiceGenerator::GenerateServerImplementations(io::Printer *printer) {
@@ -404,10 +544,8 @@ void ServiceGenerator::GenerateServerImplementations(io::Printer *printer) {
       printer->Print(
           sub_vars,
           "::tpn::protocol::ErrorCode $classname$::Handle$name$(const "
-          "$input_type$ *request, "
-          "$output_type$ *response, std::function<void(ServiceBase*, "
-          "::tpn::protocol::ErrorCode, "
-          "const ::google::protobuf::Message *)>& continuation) {\n"
+          "$input_type$ *request, $output_type$ *response, "
+          "::tpn::ServiceContinuation<$output_type$> &continuation) {\n"
           "  LOG_ERROR(\"{} Client tried to call not implemented method "
           "$full_name$({{ {} }})\", GetCallerInfo(), "
           "request->ShortDebugString());\n"
@@ -429,6 +567,45 @@ void ServiceGenerator::GenerateServerImplementations(io::Printer *printer) {
   }
 }
 
+uint32_t ServiceGenerator::GetServerMethodId(const MethodDescriptor *method) {
+  return method->options().GetExtension(tpn::protocol::method_options).id() &
+         0x3FFFFFFF;
+}
+
+uint32_t ServiceGenerator::GetServerMethodTableSize() {
+  std::vector<uint32_t> ids;
+  for (int i = 0; i < descriptor_->method_count(); ++i) {
+    const MethodDescriptor *method = descriptor_->method(i);
+    if (method->options().HasExtension(tpn::protocol::method_options)) {
+      ids.push_back(GetServerMethodId(method));
+    }
+  }
+  if (ids.empty()) {
+    return 1;
+  }
+
+  // 取使 id % size 互不冲突的最小表长，size = max(id) + 1 时必然成立
+  uint32_t max_id = *std::max_element(ids.begin(), ids.end());
+  for (uint32_t size = static_cast<uint32_t>(ids.size()); size <= max_id + 1;
+       ++size) {
+    std::vector<bool> used(size, false);
+    bool perfect = true;
+    for (uint32_t id : ids) {
+      if (used[id % size]) {
+        perfect = false;
+        break;
+      }
+      used[id % size] = true;
+    }
+    if (perfect) {
+      return size;
+    }
+  }
+
+  GOOGLE_LOG(FATAL) << descriptor_->full_name() << " has duplicate method id.";
+  return max_id + 1;
+}
+
 std::string ServiceGenerator::HashToHex(uint64_t num) {
   if (0 == num) {
     return std::string("0");
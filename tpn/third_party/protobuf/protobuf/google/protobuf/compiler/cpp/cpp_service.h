@@ -87,10 +87,19 @@ class ServiceGenerator {
 
   void GenerateClientMethodImplementations(io::Printer *printer);
 
+  // Generate the server method table, indexed by a perfect hash of the
+  // method id.
+  void GenerateServerMethodTableDeclarations(io::Printer *printer);
+
   // Generate the CallMethod() method of the service.
   void GenerateServerCallMethod(io::Printer *printer);
+  void GenerateServerCallImplementation(io::Printer *printer,
+                                        const MethodDescriptor *method);
   void GenerateServerImplementations(io::Printer *printer);
 
+  uint32_t GetServerMethodId(const MethodDescriptor *method);
+  uint32_t GetServerMethodTableSize();
+
   std::string HashToHex(uint64_t num);
   std::uint32_t HashServiceName(std::string const &name);
 
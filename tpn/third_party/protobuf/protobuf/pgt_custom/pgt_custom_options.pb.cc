@@ -22,7 +22,8 @@ constexpr TPNServiceOptions::TPNServiceOptions(
   ::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized)
   : descriptor_name_(&::PROTOBUF_NAMESPACE_ID::internal::fixed_address_empty_string)
   , inbound_(false)
-  , outbound_(false){}
+  , outbound_(false)
+  , arena_(false){}
 struct TPNServiceOptionsDefaultTypeInternal {
   constexpr TPNServiceOptionsDefaultTypeInternal()
     : _instance(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized{}) {}
@@ -59,6 +60,7 @@ const ::PROTOBUF_NAMESPACE_ID::uint32 TableStruct_pgt_5fcustom_5foptions_2eproto
   PROTOBUF_FIELD_OFFSET(::tpn::protocol::TPNServiceOptions, descriptor_name_),
   PROTOBUF_FIELD_OFFSET(::tpn::protocol::TPNServiceOptions, inbound_),
   PROTOBUF_FIELD_OFFSET(::tpn::protocol::TPNServiceOptions, outbound_),
+  PROTOBUF_FIELD_OFFSET(::tpn::protocol::TPNServiceOptions, arena_),
   ~0u,  // no _has_bits_
   PROTOBUF_FIELD_OFFSET(::tpn::protocol::TPNMethodOptions, _internal_metadata_),
   ~0u,  // no _extensions_
@@ -68,7 +70,7 @@ const ::PROTOBUF_NAMESPACE_ID::uint32 TableStruct_pgt_5fcustom_5foptions_2eproto
 };
 static const ::PROTOBUF_NAMESPACE_ID::internal::MigrationSchema schemas[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
   { 0, -1, sizeof(::tpn::protocol::TPNServiceOptions)},
-  { 8, -1, sizeof(::tpn::protocol::TPNMethodOptions)},
+  { 9, -1, sizeof(::tpn::protocol::TPNMethodOptions)},
 };
 
 static ::PROTOBUF_NAMESPACE_ID::Message const * const file_default_instances[] = {
@@ -78,22 +80,22 @@ static ::PROTOBUF_NAMESPACE_ID::Message const * const file_default_instances[] =
 
 const char descriptor_table_protodef_pgt_5fcustom_5foptions_2eproto[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) =
   "\n\030pgt_custom_options.proto\022\014tpn.protocol"
-  "\032 google/protobuf/descriptor.proto\"O\n\021TP"
+  "\032 google/protobuf/descriptor.proto\"^\n\021TP"
   "NServiceOptions\022\027\n\017descriptor_name\030\001 \001(\t"
-  "\022\017\n\007inbound\030\002 \001(\010\022\020\n\010outbound\030\003 \001(\010\"\036\n\020T"
-  "PNMethodOptions\022\n\n\002id\030\001 \001(\r:[\n\017service_o"
-  "ptions\022\037.google.protobuf.ServiceOptions\030"
-  "\220\277\005 \001(\0132\037.tpn.protocol.TPNServiceOptions"
-  ":X\n\016method_options\022\036.google.protobuf.Met"
-  "hodOptions\030\220\277\005 \001(\0132\036.tpn.protocol.TPNMet"
-  "hodOptionsB\005H\001\200\001\000b\006proto3"
+  "\022\017\n\007inbound\030\002 \001(\010\022\020\n\010outbound\030\003 \001(\010\022\r\n\005a"
+  "rena\030\004 \001(\010\"\036\n\020TPNMethodOptions\022\n\n\002id\030\001 \001"
+  "(\r:[\n\017service_options\022\037.google.protobuf."
+  "ServiceOptions\030\220\277\005 \001(\0132\037.tpn.protocol.TP"
+  "NServiceOptions:X\n\016method_options\022\036.goog"
+  "le.protobuf.MethodOptions\030\220\277\005 \001(\0132\036.tpn."
+  "protocol.TPNMethodOptionsB\005H\001\200\001\000b\006proto3"
   ;
 static const ::PROTOBUF_NAMESPACE_ID::internal::DescriptorTable*const descriptor_table_pgt_5fcustom_5foptions_2eproto_deps[1] = {
   &::descriptor_table_google_2fprotobuf_2fdescriptor_2eproto,
 };
 static ::PROTOBUF_NAMESPACE_ID::internal::once_flag descriptor_table_pgt_5fcustom_5foptions_2eproto_once;
 const ::PROTOBUF_NAMESPACE_ID::internal::DescriptorTable descriptor_table_pgt_5fcustom_5foptions_2eproto = {
-  false, false, 385, descriptor_table_protodef_pgt_5fcustom_5foptions_2eproto, "pgt_custom_options.proto", 
+  false, false, 400, descriptor_table_protodef_pgt_5fcustom_5foptions_2eproto, "pgt_custom_options.proto", 
   &descriptor_table_pgt_5fcustom_5foptions_2eproto_once, descriptor_table_pgt_5fcustom_5foptions_2eproto_deps, 1, 2,
   schemas, file_default_instances, TableStruct_pgt_5fcustom_5foptions_2eproto::offsets,
   file_level_metadata_pgt_5fcustom_5foptions_2eproto, file_level_enum_descriptors_pgt_5fcustom_5foptions_2eproto, file_level_service_descriptors_pgt_5fcustom_5foptions_2eproto,
@@ -131,8 +133,8 @@ TPNServiceOptions::TPNServiceOptions(const TPNServiceOptions& from)
       GetArenaForAllocation());
   }
   ::memcpy(&inbound_, &from.inbound_,
-    static_cast<size_t>(reinterpret_cast<char*>(&outbound_) -
-    reinterpret_cast<char*>(&inbound_)) + sizeof(outbound_));
+    static_cast<size_t>(reinterpret_cast<char*>(&arena_) -
+    reinterpret_cast<char*>(&inbound_)) + sizeof(arena_));
   // @@protoc_insertion_point(copy_constructor:tpn.protocol.TPNServiceOptions)
 }
 
@@ -140,8 +142,8 @@ inline void TPNServiceOptions::SharedCtor() {
 descriptor_name_.UnsafeSetDefault(&::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited());
 ::memset(reinterpret_cast<char*>(this) + static_cast<size_t>(
     reinterpret_cast<char*>(&inbound_) - reinterpret_cast<char*>(this)),
-    0, static_cast<size_t>(reinterpret_cast<char*>(&outbound_) -
-    reinterpret_cast<char*>(&inbound_)) + sizeof(outbound_));
+    0, static_cast<size_t>(reinterpret_cast<char*>(&arena_) -
+    reinterpret_cast<char*>(&inbound_)) + sizeof(arena_));
 }
 
 TPNServiceOptions::~TPNServiceOptions() {
@@ -174,8 +176,8 @@ void TPNServiceOptions::Clear() {
 
   descriptor_name_.ClearToEmpty();
   ::memset(&inbound_, 0, static_cast<size_t>(
-      reinterpret_cast<char*>(&outbound_) -
-      reinterpret_cast<char*>(&inbound_)) + sizeof(outbound_));
+      reinterpret_cast<char*>(&arena_) -
+      reinterpret_cast<char*>(&inbound_)) + sizeof(arena_));
   _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
 }
 
@@ -208,6 +210,13 @@ const char* TPNServiceOptions::_InternalParse(const char* ptr, ::PROTOBUF_NAMESP
           CHK_(ptr);
         } else goto handle_unusual;
         continue;
+      // bool arena = 4;
+      case 4:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 32)) {
+          arena_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else goto handle_unusual;
+        continue;
       default: {
       handle_unusual:
         if ((tag == 0) || ((tag & 7) == 4)) {
@@ -259,6 +268,12 @@ failure:
     target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteBoolToArray(3, this->_internal_outbound(), target);
   }
 
+  // bool arena = 4;
+  if (this->_internal_arena() != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteBoolToArray(4, this->_internal_arena(), target);
+  }
+
   if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
     target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormat::InternalSerializeUnknownFieldsToArray(
         _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
@@ -292,6 +307,11 @@ size_t TPNServiceOptions::ByteSizeLong() const {
     total_size += 1 + 1;
   }
 
+  // bool arena = 4;
+  if (this->_internal_arena() != 0) {
+    total_size += 1 + 1;
+  }
+
   if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
     return ::PROTOBUF_NAMESPACE_ID::internal::ComputeUnknownFieldsSize(
         _internal_metadata_, total_size, &_cached_size_);
@@ -329,6 +349,9 @@ void TPNServiceOptions::MergeFrom(const TPNServiceOptions& from) {
   if (from._internal_outbound() != 0) {
     _internal_set_outbound(from._internal_outbound());
   }
+  if (from._internal_arena() != 0) {
+    _internal_set_arena(from._internal_arena());
+  }
   _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
 }
 
@@ -352,8 +375,8 @@ void TPNServiceOptions::InternalSwap(TPNServiceOptions* other) {
       &other->descriptor_name_, other->GetArenaForAllocation()
   );
   ::PROTOBUF_NAMESPACE_ID::internal::memswap<
-      PROTOBUF_FIELD_OFFSET(TPNServiceOptions, outbound_)
-      + sizeof(TPNServiceOptions::outbound_)
+      PROTOBUF_FIELD_OFFSET(TPNServiceOptions, arena_)
+      + sizeof(TPNServiceOptions::arena_)
       - PROTOBUF_FIELD_OFFSET(TPNServiceOptions, inbound_)>(
           reinterpret_cast<char*>(&inbound_),
           reinterpret_cast<char*>(&other->inbound_));
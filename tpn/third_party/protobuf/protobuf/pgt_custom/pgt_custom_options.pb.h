@@ -191,6 +191,7 @@ class TPNServiceOptions final :
     kDescriptorNameFieldNumber = 1,
     kInboundFieldNumber = 2,
     kOutboundFieldNumber = 3,
+    kArenaFieldNumber = 4,
   };
   // string descriptor_name = 1;
   void clear_descriptor_name();
@@ -224,6 +225,15 @@ class TPNServiceOptions final :
   void _internal_set_outbound(bool value);
   public:
 
+  // bool arena = 4;
+  void clear_arena();
+  bool arena() const;
+  void set_arena(bool value);
+  private:
+  bool _internal_arena() const;
+  void _internal_set_arena(bool value);
+  public:
+
   // @@protoc_insertion_point(class_scope:tpn.protocol.TPNServiceOptions)
  private:
   class _Internal;
@@ -234,6 +244,7 @@ class TPNServiceOptions final :
   ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr descriptor_name_;
   bool inbound_;
   bool outbound_;
+  bool arena_;
   mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
   friend struct ::TableStruct_pgt_5fcustom_5foptions_2eproto;
 };
@@ -481,6 +492,26 @@ inline void TPNServiceOptions::set_outbound(bool value) {
   // @@protoc_insertion_point(field_set:tpn.protocol.TPNServiceOptions.outbound)
 }
 
+// bool arena = 4;
+inline void TPNServiceOptions::clear_arena() {
+  arena_ = false;
+}
+inline bool TPNServiceOptions::_internal_arena() const {
+  return arena_;
+}
+inline bool TPNServiceOptions::arena() const {
+  // @@protoc_insertion_point(field_get:tpn.protocol.TPNServiceOptions.arena)
+  return _internal_arena();
+}
+inline void TPNServiceOptions::_internal_set_arena(bool value) {
+  
+  arena_ = value;
+}
+inline void TPNServiceOptions::set_arena(bool value) {
+  _internal_set_arena(value);
+  // @@protoc_insertion_point(field_set:tpn.protocol.TPNServiceOptions.arena)
+}
+
 // -------------------------------------------------------------------
 
 // TPNMethodOptions
@@ -26,6 +26,8 @@
 #include <filesystem>
 
 #include <google/protobuf/stubs/common.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
 #include <google/protobuf/util/json_util.h>
 #include <rapidjson/writer.h>
 #include <rapidjson/document.h>
@@ -102,7 +104,11 @@ bool BinGenerator::Generate() {
 
     std::fstream output(bin_file_path, std::fstream::out | std::fstream::trunc |
                                            std::fstream::binary);
-    if (!data_map.SerializeToOstream(&output)) {
+    google::protobuf::io::OstreamOutputStream output_stream(&output);
+    google::protobuf::io::CodedOutputStream coded_output(&output_stream);
+    // map 默认按哈希顺序序列化 确定性序列化保证多次生成结果一致
+    coded_output.SetSerializationDeterministic(true);
+    if (!data_map.SerializeToCodedStream(&coded_output)) {
       LOG_ERROR("Failed to write data_hub protobuf bin.");
       return false;
     }
@@ -65,6 +65,8 @@ bool CppGenerator::Load(std::string &error) {
   printer_.Reset();
   init_flag_ = true;
   init_printer_.Reset();
+  flat_printer_.Reset();
+  reset_printer_.Reset();
   bin_printer_.Reset();
 
   // license
@@ -103,6 +105,12 @@ bool CppGenerator::Analyze(xlnt::worksheet &worksheet) {
       LOG_ERROR("cpp generator cpp head data error, title: {}", title_raw);
       return false;
     }
+    if (!g_xlsx2data_generator->GetAnalyst().GenerateCppFlatHeadData(
+            printer_, title_raw)) {
+      LOG_ERROR("cpp generator cpp flat head data error, title: {}",
+                title_raw);
+      return false;
+    }
     cpp_file_head_.Write(printer_.GetBuf());
 
     // 源文件
@@ -114,6 +122,13 @@ bool CppGenerator::Analyze(xlnt::worksheet &worksheet) {
     }
     init_flag_ = false;
     printer_.Println("");
+    if (!g_xlsx2data_generator->GetAnalyst().GenerateCppFlatSourceData(
+            printer_, flat_printer_, reset_printer_, title_raw)) {
+      LOG_ERROR("cpp generator cpp flat srouce data error, title: {}",
+                title_raw);
+      return false;
+    }
+    printer_.Println("");
     cpp_file_src_.Write(printer_.GetBuf());
   }
 
@@ -129,6 +144,8 @@ bool CppGenerator::GenerateTail() {
   GenerateHeadGuardEnd();
 
   GenerateSourceMethodInit();
+  GenerateSourceMethodLoadFlat();
+  GenerateSourceMethodResetFlat();
   GenerateSourceSingleton();
   GenerateSourceNamespaceEnd();
 
@@ -148,10 +165,12 @@ bool CppGenerator::GenerateTail() {
 void CppGenerator::GenerateHeadInclude() {
   printer_.Reset();
   printer_.Println("#include <map>");
+  printer_.Println("#include <span>");
   printer_.Println("#include <string>");
   printer_.Println("#include <string_view>");
   printer_.Println("");
   printer_.Println("#include \"define.h\"");
+  printer_.Println("#include \"flat_data.h\"");
   printer_.Println("#include \"data_hub.pb.h\"");
   printer_.Println("");
   cpp_file_head_.Write(printer_.GetBuf());
@@ -214,6 +233,8 @@ void CppGenerator::GenerateHeadMethodBegin() {
   GenerateHeadMethodReLoad();
   GenerateHeadMethodInit();
   GenerateHeadMethodGetPath();
+  GenerateHeadMethodLoadFlat();
+  GenerateHeadMethodGetFlatString();
 
   cpp_file_head_.Write(printer_.GetBuf());
 }
@@ -236,12 +257,25 @@ void CppGenerator::GenerateHeadMethodGetPath() {
   printer_.Println("std::string_view GetPath();");
 }
 
+void CppGenerator::GenerateHeadMethodLoadFlat() {
+  printer_.Println(
+      "bool LoadFlat(std::string_view path, std::string &error);");
+}
+
+void CppGenerator::GenerateHeadMethodGetFlatString() {
+  printer_.Println(
+      "std::string_view GetFlatString(const FlatDataStr &str) const;");
+}
+
 void CppGenerator::GenerateHeadMethodEnd() {
   printer_.Reset();
   printer_.Println("");
   printer_.Println(" private:");
   printer_.Indent();
+  printer_.Println("void ResetFlat();");
+  printer_.Println("");
   printer_.Println("std::string path_;");
+  printer_.Println("FlatDataFile flat_file_;");
   cpp_file_head_.Write(printer_.GetBuf());
 }
 
@@ -269,7 +303,9 @@ void CppGenerator::GenerateSourceInclude() {
   printer_.Reset();
   printer_.Println("#include \"data_hub.h\"");
   printer_.Println("");
+  printer_.Println("#include <tuple>");
   printer_.Println("#include <fstream>");
+  printer_.Println("#include <algorithm>");
   printer_.Println("#include <filesystem>");
   printer_.Println("");
   printer_.Println("#include \"utils.h\"");
@@ -305,6 +341,7 @@ void CppGenerator::GenerateSourceMethod() {
   GenerateSourceMethodLoad();
   GenerateSourceMethodReLoad();
   GenerateSourceMethodGetPath();
+  GenerateSourceMethodGetFlatString();
   cpp_file_src_.Write(printer_.GetBuf());
 }
 
@@ -390,6 +427,60 @@ void CppGenerator::GenerateSourceMethodGetPath() {
   printer_.Println("");
 }
 
+void CppGenerator::GenerateSourceMethodLoadFlat() {
+  printer_.Reset();
+  printer_.Println(
+      fmt::format("bool {}LoadFlat(std::string_view path, std::string &error) {{",
+                  GetCppDataHubMgrNameWithArea()));
+  printer_.Println(
+      "  // 重新打开会先关闭旧映射，任一步失败都不能留下指向映射的行数据");
+  printer_.Println("  ResetFlat();");
+  printer_.Println("  if (!flat_file_.Open(path, error)) {");
+  printer_.Println("    return false;");
+  printer_.Println("  }");
+  printer_.Println("");
+  cpp_file_src_.Write(printer_.GetBuf());
+
+  cpp_file_src_.Write(flat_printer_.GetBuf());
+  flat_printer_.Reset();
+
+  printer_.Reset();
+  printer_.Println("");
+  printer_.Println("  return true;");
+  printer_.Println("}");
+  printer_.Println("");
+  cpp_file_src_.Write(printer_.GetBuf());
+}
+
+void CppGenerator::GenerateSourceMethodResetFlat() {
+  printer_.Reset();
+  printer_.Println(
+      fmt::format("void {}ResetFlat() {{", GetCppDataHubMgrNameWithArea()));
+  cpp_file_src_.Write(printer_.GetBuf());
+
+  cpp_file_src_.Write(reset_printer_.GetBuf());
+  reset_printer_.Reset();
+
+  printer_.Reset();
+  printer_.Println("  flat_file_.Close();");
+  printer_.Println("}");
+  printer_.Println("");
+  cpp_file_src_.Write(printer_.GetBuf());
+}
+
+void CppGenerator::GenerateSourceMethodGetFlatString() {
+  printer_.Println(fmt::format(
+      "std::string_view {}GetFlatString(const FlatDataStr &str) const {{",
+      GetCppDataHubMgrNameWithArea()));
+  printer_.Indent();
+
+  printer_.Println("return flat_file_.GetString(str);");
+
+  printer_.Outdent();
+  printer_.Println("}");
+  printer_.Println("");
+}
+
 void CppGenerator::GenerateSourceSingleton() {
   printer_.Reset();
   printer_.Println(
@@ -408,6 +499,8 @@ void CppGenerator::GenerateBinGenerator() {
       "#include <filesystem>\n"
       "\n"
       "#include <google/protobuf/stubs/common.h>\n"
+      "#include <google/protobuf/io/coded_stream.h>\n"
+      "#include <google/protobuf/io/zero_copy_stream_impl.h>\n"
       "#include <google/protobuf/util/json_util.h>\n"
       "#include <rapidjson/document.h>\n"
       "#include <rapidjson/writer.h>\n"
@@ -487,7 +580,12 @@ void CppGenerator::GenerateBinGenerator() {
       "\n"
       "    std::fstream output(bin_file_path, std::fstream::out | "
       "std::fstream::trunc | std::fstream::binary);\n"
-      "    if (!data_map.SerializeToOstream(&output)) {{\n"
+      "    google::protobuf::io::OstreamOutputStream output_stream(&output);\n"
+      "    google::protobuf::io::CodedOutputStream "
+      "coded_output(&output_stream);\n"
+      "    // map 默认按哈希顺序序列化 确定性序列化保证多次生成结果一致\n"
+      "    coded_output.SetSerializationDeterministic(true);\n"
+      "    if (!data_map.SerializeToCodedStream(&coded_output)) {{\n"
       "      LOG_ERROR(\"Failed to write data_hub protobuf bin.\");\n"
       "      return false;\n"
       "    }}\n"
@@ -88,6 +88,12 @@ class TPN_XLSX2DATA_API CppGenerator {
   /// 头文方法 获取路径
   void GenerateHeadMethodGetPath();
 
+  /// 头文方法 加载平坦数据
+  void GenerateHeadMethodLoadFlat();
+
+  /// 头文方法 获取平坦数据字符串
+  void GenerateHeadMethodGetFlatString();
+
   /// 头文件方法结束
   void GenerateHeadMethodEnd();
 
@@ -122,6 +128,15 @@ class TPN_XLSX2DATA_API CppGenerator {
   /// 源文方法 获取路径
   void GenerateSourceMethodGetPath();
 
+  /// 源文方法 加载平坦数据
+  void GenerateSourceMethodLoadFlat();
+
+  /// 源文方法 清空平坦数据
+  void GenerateSourceMethodResetFlat();
+
+  /// 源文方法 获取平坦数据字符串
+  void GenerateSourceMethodGetFlatString();
+
   /// 源文件类单例
   void GenerateSourceSingleton();
 
@@ -136,6 +151,8 @@ class TPN_XLSX2DATA_API CppGenerator {
   Printer printer_;           ///< 打印器
   bool init_flag_{true};      ///< init函数标记
   Printer init_printer_;      ///< init函数打印器
+  Printer flat_printer_;      ///< LoadFlat函数打印器
+  Printer reset_printer_;     ///< ResetFlat函数打印器
   Printer bin_printer_;       ///< bin_generator文件打印器
 };
 
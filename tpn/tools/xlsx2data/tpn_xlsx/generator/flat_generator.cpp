@@ -0,0 +1,164 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "flat_generator.h"
+
+#include <cstring>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "log.h"
+#include "config.h"
+#include "debug_hub.h"
+#include "fmt_wrap.h"
+#include "utils.h"
+#include "helper.h"
+#include "analyst.h"
+#include "generator_hub.h"
+
+namespace tpn {
+
+namespace xlsx {
+
+FlatGenerator::FlatGenerator() {}
+
+FlatGenerator::~FlatGenerator() {}
+
+bool FlatGenerator::Load(std::string &error) {
+  file_path_ = fmt::format(
+      "{}/{}.flat", g_config->GetStringDefault("xlsx_bin_dir", "xlsx2data/bin"),
+      g_xlsx2data_generator->GetFilePrefix());
+  writer_.Reset();
+  return true;
+}
+
+bool FlatGenerator::Analyze(xlnt::worksheet &worksheet,
+                            FlatSheetFragment &fragment) const {
+  LOG_INFO("flat generator start analyze worksheet : {}", worksheet.title());
+
+  auto &&ranges = worksheet.rows();
+  if (ranges.length() > 0) {
+    std::string title_raw = GetSheetTitle(worksheet.title());
+    TPN_ASSERT(!title_raw.empty(), "sheet title error, title : {}",
+               worksheet.title());
+
+    auto &analyst = g_xlsx2data_generator->GetAnalyst();
+    auto row_size = analyst.GetFlatRowSize(title_raw);
+    if (0 == row_size) {
+      LOG_ERROR("flat generator row size error, title: {}", title_raw);
+      return false;
+    }
+
+    auto &strings = fragment.strings;
+    strings.Reset();
+
+    // 0 格式 1 注释 >2 数据
+    size_t row_count = ranges.length() > 2 ? ranges.length() - 2 : 0;
+    std::vector<uint8_t> rows(row_count * row_size, 0);
+    for (size_t idx = 2; idx < ranges.length(); ++idx) {
+      auto *row = rows.data() + (idx - 2) * row_size;
+      for (size_t i = 0; i < ranges[idx].length(); ++i) {  // 数据分析
+        if (!analyst.GenerateFlatData(strings, row, title_raw, i,
+                                      ranges[idx][i].to_string())) {
+          LOG_ERROR(
+              "flat generator flat data error, title: {}, idx: {}, index: {}, "
+              "data: {}",
+              title_raw, idx, i, ranges[idx][i].to_string());
+          return false;
+        }
+      }
+    }
+
+    // 按主键排序 运行时二分查找
+    std::vector<size_t> order(row_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+      return analyst.CompareFlatRow(strings, title_raw,
+                                    rows.data() + lhs * row_size,
+                                    rows.data() + rhs * row_size) < 0;
+    });
+
+    std::vector<uint8_t> sorted_rows(rows.size(), 0);
+    for (size_t i = 0; i < row_count; ++i) {
+      auto *row = rows.data() + order[i] * row_size;
+      if (i > 0 && 0 == analyst.CompareFlatRow(
+                            strings, title_raw,
+                            sorted_rows.data() + (i - 1) * row_size, row)) {
+        LOG_ERROR("flat generator key repeated, title: {}, row: {}", title_raw,
+                  order[i] + 2);
+        return false;
+      }
+      std::memcpy(sorted_rows.data() + i * row_size, row, row_size);
+    }
+
+    fragment.title_raw = std::move(title_raw);
+    fragment.row_size  = row_size;
+    fragment.rows      = std::move(sorted_rows);
+    fragment.valid     = true;
+  }
+
+  LOG_INFO("flat generator finish analyze worksheet : {}", worksheet.title());
+  return true;
+}
+
+bool FlatGenerator::Commit(FlatSheetFragment &fragment) {
+  if (!fragment.valid) {
+    return true;
+  }
+
+  auto &analyst = g_xlsx2data_generator->GetAnalyst();
+  for (size_t offset = 0; offset < fragment.rows.size();
+       offset += fragment.row_size) {
+    analyst.MergeFlatRow(writer_, fragment.strings, fragment.title_raw,
+                         fragment.rows.data() + offset);
+  }
+
+  if (!writer_.AddTable(LowercaseString(fragment.title_raw),
+                        static_cast<uint32_t>(fragment.row_size),
+                        std::move(fragment.rows))) {
+    LOG_ERROR("flat generator add table error, title: {}",
+              fragment.title_raw);
+    return false;
+  }
+
+  fragment.strings.Reset();
+  return true;
+}
+
+bool FlatGenerator::Generate() {
+  LOG_INFO("flat generator start generate flat file");
+
+  std::string error;
+  if (!writer_.Write(file_path_, error)) {
+    LOG_ERROR("flat generator write error: {}", error);
+    return false;
+  }
+
+  LOG_INFO("flat generator finish generate flat file");
+  return true;
+}
+
+}  // namespace xlsx
+
+}  // namespace tpn
@@ -0,0 +1,84 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef TYPHOON_ZERO_TPN_TOOLS_XLSX2DATA_TPN_XLSX_GENERATOR_FLAT_GENERATOR_H_
+#define TYPHOON_ZERO_TPN_TOOLS_XLSX2DATA_TPN_XLSX_GENERATOR_FLAT_GENERATOR_H_
+
+#include <string>
+#include <vector>
+
+#include "flat_data.h"
+#include "xlsx2data_common.h"
+
+namespace tpn {
+
+namespace xlsx {
+
+/// 平坦数据工作表片段
+/// 分析阶段各工作表并行生成，字符串先写入片段自己的字符串池
+struct FlatSheetFragment {
+  std::string title_raw;      ///< 表名
+  size_t row_size{0};         ///< 行大小
+  std::vector<uint8_t> rows;  ///< 按主键排序后的行数据
+  FlatDataWriter strings;     ///< 片段字符串池
+  bool valid{false};          ///< 是否有数据
+};
+
+/// 平坦数据文件生成器
+/// 每张表按主键排序后写入，运行时mmap后二分查找，无需解析
+class TPN_XLSX2DATA_API FlatGenerator {
+ public:
+  FlatGenerator();
+  ~FlatGenerator();
+
+  /// 加载配置
+  ///  @param[out]  error     读取数据错误信息
+  ///  @return 加载成功返回true
+  bool Load(std::string &error);
+
+  /// 分析数据
+  /// 只读取分析器，可在多个线程中同时分析不同的工作表
+  ///  @param[in]   worksheet         工作表
+  ///  @param[out]  fragment          工作表片段
+  ///  @return 成功返回true
+  bool Analyze(xlnt::worksheet &worksheet, FlatSheetFragment &fragment) const;
+
+  /// 提交片段
+  /// 按工作表顺序调用，字符串合并到全局字符串池，保证输出与顺序执行一致
+  ///  @param[in]   fragment          工作表片段
+  ///  @return 成功返回true
+  bool Commit(FlatSheetFragment &fragment);
+
+  /// 生成数据
+  ///  @return 生成成功返回true
+  bool Generate();
+
+ private:
+  FlatDataWriter writer_;   ///< 平坦数据写入器
+  std::string file_path_;   ///< 输出文件路径
+};
+
+}  // namespace xlsx
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_TOOLS_XLSX2DATA_TPN_XLSX_GENERATOR_FLAT_GENERATOR_H_
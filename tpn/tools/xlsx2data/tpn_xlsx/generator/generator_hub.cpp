@@ -20,13 +20,22 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
+
 #include "generator_hub.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <filesystem>
+#include <fstream>
+#include <future>
+#include <thread>
 
 #include "log.h"
 #include "config.h"
 #include "debug_hub.h"
+#include "fmt_wrap.h"
+#include "thread_pool.h"
 #include "helper.h"
 
 namespace fs = std::filesystem;
@@ -35,6 +44,36 @@ namespace tpn {
 
 namespace xlsx {
 
+namespace {
+
+/// 哈希清单文件头
+static constexpr std::string_view s_hash_file_head = "# xlsx2data hashes v2";
+
+/// 生成器版本，输出格式改变时递增，使旧清单失效
+static constexpr uint32_t s_generator_version = 2;
+
+/// 等待所有任务结束
+///  @param[in]   futures   任务结果
+///  @return 全部成功返回true
+bool WaitAll(std::vector<std::future<bool>> &futures) {
+  // 任务引用了调用方的局部变量，失败时也必须等待全部结束
+  bool ret = true;
+  for (auto &&future : futures) {
+    try {
+      ret = future.get() && ret;
+    } catch (const std::exception &ex) {
+      LOG_ERROR("xlsx generator task exception error : {}", ex.what());
+      ret = false;
+    } catch (...) {
+      LOG_ERROR("xlsx generator task exception ...");
+      ret = false;
+    }
+  }
+  return ret;
+}
+
+}  // namespace
+
 bool GeneratorHub::Load(std::string_view path, std::string &error,
                         bool reload /* = false */) {
   if (!reload) {
@@ -43,7 +82,7 @@ bool GeneratorHub::Load(std::string_view path, std::string &error,
 
   xlsx_file_paths_.clear();
 
-  auto xlsx_path = fs::path(path);
+  auto xlsx_path = fs::path(path_);
   xlsx_path.make_preferred();
 
   try {
@@ -59,7 +98,14 @@ bool GeneratorHub::Load(std::string_view path, std::string &error,
       return false;
     }
 
+    // 目录遍历顺序不确定 排序保证输出稳定
+    std::sort(xlsx_file_paths_.begin(), xlsx_file_paths_.end());
+
     file_prefix_ = g_config->GetStringDefault("xlsx_file_prefix", "data_hub");
+    hash_file_path_ = fmt::format(
+        "{}/{}.hash",
+        g_config->GetStringDefault("xlsx_bin_dir", "xlsx2data/bin"),
+        file_prefix_);
   } catch (fs::filesystem_error &e) {
     error = std::string{e.what()} + " (" + path_ + ") ";
     return false;
@@ -68,7 +114,30 @@ bool GeneratorHub::Load(std::string_view path, std::string &error,
     return false;
   }
 
-  if (!json_gen_.Load(error)) {
+  json_enable_   = g_config->GetBoolDefault("xlsx_json_enable", true);
+  bin_from_json_ = g_config->GetBoolDefault("xlsx_bin_from_json", false);
+  if (bin_from_json_ && !json_enable_) {
+    error = "xlsx_bin_from_json need xlsx_json_enable";
+    return false;
+  }
+
+  if (!LoadHashes(error)) {
+    return false;
+  }
+  LoadOutputs();
+
+  // 生成器加载时会截断输出文件 数据未改变时不加载
+  up_to_date_ = !g_config->GetBoolDefault("xlsx_force_generate", false) &&
+                IsUpToDate();
+  if (up_to_date_) {
+    return true;
+  }
+
+  if (json_enable_ && !json_gen_.Load(error)) {
+    return false;
+  }
+
+  if (!bin_from_json_ && !pb_gen_.Load(error)) {
     return false;
   }
 
@@ -80,89 +149,104 @@ bool GeneratorHub::Load(std::string_view path, std::string &error,
     return false;
   }
 
+  if (!flat_gen_.Load(error)) {
+    return false;
+  }
+
   return true;
 }
 
 bool GeneratorHub::Reload(std::string &error) { return Load({}, error, true); }
 
 bool GeneratorHub::Generate() {
-  LOG_INFO("xlsx generator start generate");
+  if (up_to_date_) {
+    LOG_INFO("xlsx generator workbooks unchanged, skip generate, hash file: {}",
+             hash_file_path_);
+    return true;
+  }
 
-  for (auto &&path : xlsx_file_paths_) {
-    LOG_INFO("xlsx generator start generate path: {}", path);
+  LOG_INFO("xlsx generator start generate");
+  auto start_time = std::chrono::steady_clock::now();
 
-    xlnt::workbook wb;
-    try {
-      wb.load(path);
-    } catch (xlnt::exception &e) {
-      LOG_ERROR("xlsx generator load workbook {} exception error : {}", path,
-                e.what());
-      return false;
-    } catch (...) {
-      LOG_ERROR("xlsx generator load workbook {} exception ...", path);
-      return false;
-    }
+  auto thread_count = g_config->GetI32Default("xlsx_thread_count", 0);
+  if (thread_count <= 0) {
+    thread_count =
+        std::max(1, static_cast<int32_t>(std::thread::hardware_concurrency()));
+  }
+  ThreadPool pool(static_cast<size_t>(thread_count));
+
+  // 并行加载工作簿
+  std::vector<xlnt::workbook> workbooks(xlsx_file_paths_.size());
+  std::vector<std::future<bool>> futures;
+  futures.reserve(xlsx_file_paths_.size());
+  for (size_t i = 0; i < xlsx_file_paths_.size(); ++i) {
+    futures.emplace_back(pool.Submit([this, &workbooks, i]() {
+      return LoadWorkbook(xlsx_file_paths_[i], workbooks[i]);
+    }));
+  }
+  if (!WaitAll(futures)) {
+    return false;
+  }
 
-    for (auto &&sheet : wb) {
-      if (!SheetTitleIsOutput(sheet.title())) {
-        continue;
+  // 按路径与工作表顺序收集需要输出的工作表
+  std::vector<xlnt::worksheet> sheets;
+  for (size_t i = 0; i < workbooks.size(); ++i) {
+    for (auto &&sheet : workbooks[i]) {
+      if (SheetTitleIsOutput(sheet.title())) {
+        sheets.emplace_back(sheet);
       }
+    }
+  }
 
-      LOG_INFO("xlsx generator start generate anlayst path: {}, sheet: {}",
-               path, sheet.title());
-      // 分析器
-      if (!GenerateAnlayst(sheet)) {
-        LOG_ERROR("xlsx generator generate anlayst error path: {}, sheet: {}",
-                  path, sheet.title());
-        return false;
-      }
-      LOG_INFO("xlsx generator finish generate anlayst path: {}, sheet: {}",
-               path, sheet.title());
-
-      LOG_INFO("xlsx generator start generate json path: {}, sheet: {}", path,
-               sheet.title());
-      // 原生数据
-      if (!GenerateJson(sheet)) {
-        LOG_ERROR("xlsx generator generate json error path: {}, sheet: {}",
-                  path, sheet.title());
-        return false;
-      }
-      LOG_INFO("xlsx generator finish generate json path: {}, sheet: {}", path,
-               sheet.title());
-
-      LOG_INFO("xlsx generator start generate proto path: {}, sheet: {}", path,
-               sheet.title());
-      // proto描述文件
-      if (!GenerateProto(sheet)) {
-        LOG_ERROR("xlsx generator generate proto error path: {}, sheet: {}",
-                  path, sheet.title());
-        return false;
-      }
-      LOG_INFO("xlsx generator finish generate proto path: {}, sheet: {}", path,
-               sheet.title());
-
-      LOG_INFO("xlsx generator start generate cpp path: {}, sheet: {}", path,
-               sheet.title());
-      // cpp文件
-      if (!GenerateCpp(sheet)) {
-        LOG_ERROR("xlsx generator generate cpp error path: {}, sheet: {}", path,
-                  sheet.title());
-        return false;
-      }
-      LOG_INFO("xlsx generator finish generate cpp path: {}, sheet: {}", path,
-               sheet.title());
+  // 分析器只读取表头 顺序执行
+  for (auto &&sheet : sheets) {
+    LOG_INFO("xlsx generator start generate anlayst sheet: {}", sheet.title());
+    if (!GenerateAnlayst(sheet)) {
+      LOG_ERROR("xlsx generator generate anlayst error sheet: {}",
+                sheet.title());
+      return false;
     }
+    LOG_INFO("xlsx generator finish generate anlayst sheet: {}", sheet.title());
+  }
 
-    LOG_INFO("xlsx generator finish generate path: {}", path);
+  // 直接生成bin时 消息类型来自本次的表头 而不是工具编译时的data_hub.pb
+  if (!bin_from_json_ && !GeneratePbDescriptors(sheets)) {
+    LOG_ERROR("xlsx generator generate pb descriptors error");
+    return false;
   }
 
-  LOG_INFO("xlsx generator start generate json file");
-  // json 文件生成
-  if (!GenerateJsonFile()) {
-    LOG_ERROR("xlsx generator generate json file error");
+  // 并行分析数据行
+  std::vector<JsonSheetFragment> json_fragments(sheets.size());
+  std::vector<PbSheetFragment> pb_fragments(sheets.size());
+  std::vector<FlatSheetFragment> flat_fragments(sheets.size());
+  futures.clear();
+  for (size_t i = 0; i < sheets.size(); ++i) {
+    futures.emplace_back(pool.Submit([&, i]() {
+      return GenerateFragment(sheets[i], json_fragments[i], pb_fragments[i],
+                              flat_fragments[i]);
+    }));
+  }
+  if (!WaitAll(futures)) {
     return false;
   }
-  LOG_INFO("xlsx generator finish generate json file");
+
+  // 按顺序提交
+  for (size_t i = 0; i < sheets.size(); ++i) {
+    if (!CommitSheet(sheets[i], json_fragments[i], pb_fragments[i],
+                     flat_fragments[i])) {
+      return false;
+    }
+  }
+
+  if (json_enable_) {
+    LOG_INFO("xlsx generator start generate json file");
+    // json 文件生成
+    if (!GenerateJsonFile()) {
+      LOG_ERROR("xlsx generator generate json file error");
+      return false;
+    }
+    LOG_INFO("xlsx generator finish generate json file");
+  }
 
   LOG_INFO("xlsx generator start generate cpp tail");
   // cpp 尾部内容生成
@@ -180,7 +264,24 @@ bool GeneratorHub::Generate() {
   }
   LOG_INFO("xlsx generator finish generate protobuf bin");
 
-  LOG_INFO("xlsx generator finish generate");
+  LOG_INFO("xlsx generator start generate flat file");
+  // 平坦数据文件生成
+  if (!GenerateFlatFile()) {
+    LOG_ERROR("xlsx generator generate flat file error");
+    return false;
+  }
+  LOG_INFO("xlsx generator finish generate flat file");
+
+  if (!SaveHashes()) {
+    LOG_WARN("xlsx generator save hash file error: {}", hash_file_path_);
+  }
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start_time);
+  LOG_INFO(
+      "xlsx generator finish generate, workbooks: {}, sheets: {}, threads: {}, "
+      "wall time: {}ms",
+      workbooks.size(), sheets.size(), thread_count, elapsed.count());
 
   return true;
 }
@@ -189,12 +290,105 @@ std::string_view GeneratorHub::GetFilePrefix() const { return file_prefix_; }
 
 Analyst &GeneratorHub::GetAnalyst() { return analyst_; }
 
+bool GeneratorHub::LoadWorkbook(std::string_view path,
+                                xlnt::workbook &workbook) {
+  LOG_INFO("xlsx generator start load workbook path: {}", path);
+  try {
+    workbook.load(std::string(path.data(), path.length()));
+  } catch (xlnt::exception &e) {
+    LOG_ERROR("xlsx generator load workbook {} exception error : {}", path,
+              e.what());
+    return false;
+  } catch (...) {
+    LOG_ERROR("xlsx generator load workbook {} exception ...", path);
+    return false;
+  }
+  LOG_INFO("xlsx generator finish load workbook path: {}", path);
+  return true;
+}
+
 bool GeneratorHub::GenerateAnlayst(xlnt::worksheet &worksheet) {
   return analyst_.Analyze(worksheet);
 }
 
-bool GeneratorHub::GenerateJson(xlnt::worksheet &worksheet) {
-  return json_gen_.Analyze(worksheet);
+bool GeneratorHub::GeneratePbDescriptors(
+    std::vector<xlnt::worksheet> &sheets) {
+  Printer printer;
+  proto_gen_.GenerateHead(printer);
+  for (auto &&sheet : sheets) {
+    if (!proto_gen_.GenerateMessage(sheet, printer)) {
+      return false;
+    }
+  }
+
+  auto &buf = printer.GetBuf();
+  return pb_gen_.BuildDescriptors(std::string_view(buf.data(), buf.size()));
+}
+
+bool GeneratorHub::GenerateFragment(xlnt::worksheet &worksheet,
+                                    JsonSheetFragment &json_fragment,
+                                    PbSheetFragment &pb_fragment,
+                                    FlatSheetFragment &flat_fragment) {
+  // 原生数据
+  if (json_enable_ && !json_gen_.Analyze(worksheet, json_fragment)) {
+    LOG_ERROR("xlsx generator generate json error sheet: {}",
+              worksheet.title());
+    return false;
+  }
+
+  // protobuf数据
+  if (!bin_from_json_ && !pb_gen_.Analyze(worksheet, pb_fragment)) {
+    LOG_ERROR("xlsx generator generate pb error sheet: {}", worksheet.title());
+    return false;
+  }
+
+  // 平坦数据
+  if (!flat_gen_.Analyze(worksheet, flat_fragment)) {
+    LOG_ERROR("xlsx generator generate flat error sheet: {}",
+              worksheet.title());
+    return false;
+  }
+
+  return true;
+}
+
+bool GeneratorHub::CommitSheet(xlnt::worksheet &worksheet,
+                               JsonSheetFragment &json_fragment,
+                               PbSheetFragment &pb_fragment,
+                               FlatSheetFragment &flat_fragment) {
+  // 原生数据
+  if (!json_gen_.Commit(json_fragment)) {
+    LOG_ERROR("xlsx generator commit json error sheet: {}", worksheet.title());
+    return false;
+  }
+
+  // protobuf数据
+  if (!pb_gen_.Commit(pb_fragment)) {
+    LOG_ERROR("xlsx generator commit pb error sheet: {}", worksheet.title());
+    return false;
+  }
+
+  // proto描述文件
+  if (!GenerateProto(worksheet)) {
+    LOG_ERROR("xlsx generator generate proto error sheet: {}",
+              worksheet.title());
+    return false;
+  }
+
+  // cpp文件
+  if (!GenerateCpp(worksheet)) {
+    LOG_ERROR("xlsx generator generate cpp error sheet: {}",
+              worksheet.title());
+    return false;
+  }
+
+  // 平坦数据
+  if (!flat_gen_.Commit(flat_fragment)) {
+    LOG_ERROR("xlsx generator commit flat error sheet: {}", worksheet.title());
+    return false;
+  }
+
+  return true;
 }
 
 bool GeneratorHub::GenerateProto(xlnt::worksheet &worksheet) {
@@ -209,7 +403,135 @@ bool GeneratorHub::GenerateJsonFile() { return json_gen_.Generate(); }
 
 bool GeneratorHub::GenerateCppTail() { return cpp_gen_.GenerateTail(); }
 
-bool GeneratorHub::GeneraBin() { return bin_gen_.Generate(); }
+bool GeneratorHub::GeneraBin() {
+  return bin_from_json_ ? bin_gen_.Generate() : pb_gen_.Generate();
+}
+
+bool GeneratorHub::GenerateFlatFile() { return flat_gen_.Generate(); }
+
+bool GeneratorHub::LoadHashes(std::string &error) {
+  xlsx_file_hashes_.assign(xlsx_file_paths_.size(), 0);
+  for (size_t i = 0; i < xlsx_file_paths_.size(); ++i) {
+    if (!GetFileHash(xlsx_file_paths_[i], xlsx_file_hashes_[i])) {
+      error = "hash workbook error (" + xlsx_file_paths_[i] + ") ";
+      return false;
+    }
+  }
+  return true;
+}
+
+void GeneratorHub::LoadOutputs() {
+  auto json_dir = g_config->GetStringDefault("xlsx_json_dir", "xlsx2data/json");
+  auto bin_dir  = g_config->GetStringDefault("xlsx_bin_dir", "xlsx2data/bin");
+  auto proto_dir =
+      g_config->GetStringDefault("xlsx_proto_dir", "xlsx2data/proto");
+  auto cpp_dir = g_config->GetStringDefault("xlsx_cpp_dir", "xlsx2data/cpp");
+  auto generator_dir =
+      g_config->GetStringDefault("xlsx_generator_dir", "xlsx2data/generator");
+
+  hash_config_ = fmt::format(
+      "# version={} json_enable={} bin_from_json={} prefix={} json_dir={} "
+      "bin_dir={} proto_dir={} cpp_dir={} generator_dir={}",
+      s_generator_version, json_enable_, bin_from_json_, file_prefix_, json_dir,
+      bin_dir, proto_dir, cpp_dir, generator_dir);
+
+  output_paths_.clear();
+  if (json_enable_) {
+    output_paths_.emplace_back(
+        fmt::format("{}/{}.json", json_dir, file_prefix_));
+  }
+  output_paths_.emplace_back(fmt::format("{}/{}.bin", bin_dir, file_prefix_));
+  output_paths_.emplace_back(fmt::format("{}/{}.flat", bin_dir, file_prefix_));
+  output_paths_.emplace_back(
+      fmt::format("{}/{}.proto", proto_dir, file_prefix_));
+  output_paths_.emplace_back(fmt::format("{}/{}.h", cpp_dir, file_prefix_));
+  output_paths_.emplace_back(fmt::format("{}/{}.cpp", cpp_dir, file_prefix_));
+  output_paths_.emplace_back(
+      fmt::format("{}/bin_generator.cpp", generator_dir));
+}
+
+bool GeneratorHub::IsUpToDate() const {
+  std::ifstream file(hash_file_path_);
+  if (!file) {
+    return false;
+  }
+
+  std::string line;
+  if (!std::getline(file, line) || s_hash_file_head != line) {
+    return false;
+  }
+
+  if (!std::getline(file, line) || hash_config_ != line) {
+    LOG_INFO("xlsx generator config changed");
+    return false;
+  }
+
+  // 输出文件被删除时同样需要重新生成
+  for (auto &&output_path : output_paths_) {
+    std::error_code ec;
+    if (!fs::exists(fs::path(output_path), ec)) {
+      LOG_INFO("xlsx generator output missing: {}", output_path);
+      return false;
+    }
+  }
+
+  bool ret = true;
+  size_t count = 0;
+  while (std::getline(file, line)) {
+    auto pos = line.find(' ');
+    if (std::string::npos == pos) {
+      return false;
+    }
+
+    auto hash = std::strtoull(line.substr(0, pos).c_str(), nullptr, 16);
+    auto path = line.substr(pos + 1);
+    auto iter = std::lower_bound(xlsx_file_paths_.begin(),
+                                 xlsx_file_paths_.end(), path);
+    if (xlsx_file_paths_.end() == iter || *iter != path) {
+      LOG_INFO("xlsx generator workbook removed: {}", path);
+      ret = false;
+      continue;
+    }
+
+    ++count;
+    auto index = static_cast<size_t>(iter - xlsx_file_paths_.begin());
+    if (xlsx_file_hashes_[index] != hash) {
+      LOG_INFO("xlsx generator workbook changed: {}", path);
+      ret = false;
+    }
+  }
+
+  if (count != xlsx_file_paths_.size()) {
+    LOG_INFO("xlsx generator workbook added");
+    ret = false;
+  }
+
+  return ret;
+}
+
+bool GeneratorHub::SaveHashes() const {
+  auto hash_path = fs::path(hash_file_path_);
+  hash_path.make_preferred();
+
+  std::error_code ec;
+  if (hash_path.has_parent_path()) {
+    fs::create_directories(hash_path.parent_path(), ec);
+  }
+
+  std::ofstream file(hash_path, std::ios::out | std::ios::trunc);
+  if (!file) {
+    return false;
+  }
+
+  file << s_hash_file_head << '\n';
+  file << hash_config_ << '\n';
+  for (size_t i = 0; i < xlsx_file_paths_.size(); ++i) {
+    file << fmt::format("{:016x} {}\n", xlsx_file_hashes_[i],
+                        xlsx_file_paths_[i]);
+  }
+
+  return static_cast<bool>(file);
+}
 
 TPN_SINGLETON_IMPL(GeneratorHub)
 
@@ -26,6 +26,7 @@
 #include <vector>
 #include <string>
 #include <string_view>
+#include <cstdint>
 
 #include "file_helper.h"
 #include "xlsx2data_common.h"
@@ -34,12 +35,16 @@
 #include "proto_generator.h"
 #include "cpp_generator.h"
 #include "bin_generator.h"
+#include "pb_generator.h"
+#include "flat_generator.h"
 
 namespace tpn {
 
 namespace xlsx {
 
 /// 生成器中枢
+/// 工作簿并行加载，工作表数据行并行分析，再按路径与工作表顺序提交，
+/// 输出与单线程执行完全一致
 class TPN_XLSX2DATA_API GeneratorHub {
  public:
   /// 加载数据
@@ -55,6 +60,7 @@ class TPN_XLSX2DATA_API GeneratorHub {
   bool Reload(std::string &error);
 
   /// 生成数据
+  /// 所有工作簿内容哈希与上次生成一致时直接跳过
   ///  @return 生成成功返回true
   bool Generate();
 
@@ -67,15 +73,46 @@ class TPN_XLSX2DATA_API GeneratorHub {
   Analyst &GetAnalyst();
 
  private:
+  /// 加载工作簿
+  ///  @param[in]   path          工作簿路径
+  ///  @param[out]  workbook      工作簿
+  ///  @return 成功返回true
+  bool LoadWorkbook(std::string_view path, xlnt::workbook &workbook);
+
   /// 生成分析器
   ///  @param[in]   worksheet     工作表
   ///  @return 成功返回true
   bool GenerateAnlayst(xlnt::worksheet &worksheet);
 
-  /// 生成json
+  /// 由本次的表头生成protobuf消息类型
+  /// 在分析器之后 数据片段之前执行
+  ///  @param[in]   sheets        需要输出的工作表
+  ///  @return 成功返回true
+  bool GeneratePbDescriptors(std::vector<xlnt::worksheet> &sheets);
+
+  /// 生成工作表数据片段
+  /// 在线程池中执行
   ///  @param[in]   worksheet     工作表
+  ///  @param[out]  json_fragment json片段
+  ///  @param[out]  pb_fragment   protobuf片段
+  ///  @param[out]  flat_fragment 平坦数据片段
   ///  @return 成功返回true
-  bool GenerateJson(xlnt::worksheet &worksheet);
+  bool GenerateFragment(xlnt::worksheet &worksheet,
+                        JsonSheetFragment &json_fragment,
+                        PbSheetFragment &pb_fragment,
+                        FlatSheetFragment &flat_fragment);
+
+  /// 提交工作表
+  /// 按工作表顺序执行
+  ///  @param[in]   worksheet     工作表
+  ///  @param[in]   json_fragment json片段
+  ///  @param[in]   pb_fragment   protobuf片段
+  ///  @param[in]   flat_fragment 平坦数据片段
+  ///  @return 成功返回true
+  bool CommitSheet(xlnt::worksheet &worksheet,
+                   JsonSheetFragment &json_fragment,
+                   PbSheetFragment &pb_fragment,
+                   FlatSheetFragment &flat_fragment);
 
   /// 生成proto
   ///  @param[in]   worksheet     工作表
@@ -99,15 +136,45 @@ class TPN_XLSX2DATA_API GeneratorHub {
   ///  @return 成功返回true
   bool GeneraBin();
 
+  /// 生成平坦数据文件
+  ///  @return 成功返回true
+  bool GenerateFlatFile();
+
+ private:
+  /// 计算所有工作簿内容哈希
+  ///  @param[out]  error     错误信息
+  ///  @return 成功返回true
+  bool LoadHashes(std::string &error);
+
+  /// 收集影响输出的配置与所有预期输出文件
+  void LoadOutputs();
+
+  /// 工作簿内容、生成配置与上次生成一致且输出文件齐全
+  ///  @return 一致返回true
+  bool IsUpToDate() const;
+
+  /// 保存哈希清单
+  ///  @return 成功返回true
+  bool SaveHashes() const;
+
  private:
   std::string path_;                          ///< 数据文件夹路径
   std::vector<std::string> xlsx_file_paths_;  ///< 所有需要解析的数据路径
+  std::vector<uint64_t> xlsx_file_hashes_;    ///< 数据内容哈希
+  std::string hash_file_path_;                ///< 哈希清单路径
+  std::string hash_config_;                   ///< 影响输出的配置
+  std::vector<std::string> output_paths_;     ///< 预期输出文件路径
+  bool up_to_date_{false};                    ///< 数据未改变标记
+  bool json_enable_{true};                    ///< 是否输出json
+  bool bin_from_json_{false};                 ///< bin是否由json转换
   std::string file_prefix_;                   ///< 文件前缀
   Analyst analyst_;                           ///< 分析器
   JsonGenerator json_gen_;                    ///< json生成器
   ProtoGenerator proto_gen_;                  ///< proto生成器
   CppGenerator cpp_gen_;                      ///< cpp生成器
-  BinGenerator bin_gen_;                      ///< bin生成器
+  BinGenerator bin_gen_;                      ///< bin生成器 json转换
+  PbGenerator pb_gen_;                        ///< bin生成器 反射直接生成
+  FlatGenerator flat_gen_;                    ///< 平坦数据生成器
 
   TPN_SINGLETON_DECL(GeneratorHub)
 };
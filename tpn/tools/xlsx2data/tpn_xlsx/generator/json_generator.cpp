@@ -74,7 +74,8 @@ bool JsonGenerator::Load(std::string &error) {
   return true;
 }
 
-bool JsonGenerator::Analyze(xlnt::worksheet &worksheet) {
+bool JsonGenerator::Analyze(xlnt::worksheet &worksheet,
+                            JsonSheetFragment &fragment) const {
   LOG_INFO("json generator start analyze worksheet : {}", worksheet.title());
 
   auto &&ranges = worksheet.rows();
@@ -83,18 +84,13 @@ bool JsonGenerator::Analyze(xlnt::worksheet &worksheet) {
     TPN_ASSERT(!title_raw.empty(), "sheet title error, title : {}",
                worksheet.title());
 
-    // 获取json的根节点
-    rapidjson::Value key;
-    key.SetString(GetMapVarName().data(), GetMapVarName().length(),
-                  document_.GetAllocator());
-    auto &datas = document_[key.Move()];
-    TPN_ASSERT(datas.IsObject(), "document_ encode error, key : {}",
-               key.GetString());
+    auto &document = fragment.document;
+    document.SetObject();
 
     rapidjson::Value title_key;
     // json 工作表节点
     std::string title = LowercaseString(title_raw);
-    title_key.SetString(title.data(), title.length(), document_.GetAllocator());
+    title_key.SetString(title.data(), title.length(), document.GetAllocator());
 
     rapidjson::Value title_val(rapidjson::kObjectType);
 
@@ -103,14 +99,14 @@ bool JsonGenerator::Analyze(xlnt::worksheet &worksheet) {
     // any 类型的反射type
     rapidjson::Value type_val;
     type_val.SetString(type_name.data(), type_name.length(),
-                       document_.GetAllocator());
+                       document.GetAllocator());
 
-    title_val.AddMember("@type", type_val.Move(), document_.GetAllocator());
+    title_val.AddMember("@type", type_val.Move(), document.GetAllocator());
 
     // repeated 数据
     rapidjson::Value data_key;
     data_key.SetString(GetArrVarName().data(), GetArrVarName().length(),
-                       document_.GetAllocator());
+                       document.GetAllocator());
 
     rapidjson::Value data_val;
     data_val.SetArray();
@@ -120,7 +116,7 @@ bool JsonGenerator::Analyze(xlnt::worksheet &worksheet) {
       rapidjson::Value row_data(rapidjson::kObjectType);
       for (size_t i = 0; i < ranges[idx].length(); ++i) {  // 数据分析
         if (!g_xlsx2data_generator->GetAnalyst().GenerateJsonData(
-                document_, row_data, title_raw, i,
+                document, row_data, title_raw, i,
                 ranges[idx][i].to_string())) {
           LOG_ERROR(
               "json generator json data error, title: {}, idx: {}, index: {}, "
@@ -129,17 +125,44 @@ bool JsonGenerator::Analyze(xlnt::worksheet &worksheet) {
           return false;
         }
       }
-      data_val.PushBack(row_data.Move(), document_.GetAllocator());
+      data_val.PushBack(row_data.Move(), document.GetAllocator());
     }
 
     title_val.AddMember(data_key.Move(), data_val.Move(),
-                        document_.GetAllocator());
+                        document.GetAllocator());
+
+    document.AddMember(title_key.Move(), title_val.Move(),
+                       document.GetAllocator());
+    fragment.valid = true;
+  }
+
+  LOG_INFO("json generator finish analyze worksheet : {}", worksheet.title());
+  return true;
+}
 
+bool JsonGenerator::Commit(JsonSheetFragment &fragment) {
+  if (!fragment.valid) {
+    return true;
+  }
+
+  // 获取json的根节点
+  rapidjson::Value key;
+  key.SetString(GetMapVarName().data(), GetMapVarName().length(),
+                document_.GetAllocator());
+  auto &datas = document_[key.Move()];
+  TPN_ASSERT(datas.IsObject(), "document_ encode error, key : {}",
+             key.GetString());
+
+  // 片段使用自己的分配器 需要深拷贝到document_
+  for (auto &&member : fragment.document.GetObject()) {
+    rapidjson::Value title_key(member.name, document_.GetAllocator());
+    rapidjson::Value title_val(member.value, document_.GetAllocator());
     datas.AddMember(title_key.Move(), title_val.Move(),
                     document_.GetAllocator());
   }
 
-  LOG_INFO("json generator finish analyze worksheet : {}", worksheet.title());
+  fragment.document.SetNull();
+  fragment.document.GetAllocator().Clear();
   return true;
 }
 
@@ -34,6 +34,13 @@ namespace tpn {
 
 namespace xlsx {
 
+/// json工作表片段
+/// 分析阶段各工作表并行生成，使用片段自己的分配器
+struct JsonSheetFragment {
+  rapidjson::Document document;  ///< 工作表节点 {title: {...}}
+  bool valid{false};             ///< 是否有数据
+};
+
 /// json文件生成器
 class TPN_XLSX2DATA_API JsonGenerator {
  public:
@@ -46,9 +53,17 @@ class TPN_XLSX2DATA_API JsonGenerator {
   bool Load(std::string &error);
 
   /// 分析数据
+  /// 只读取分析器，可在多个线程中同时分析不同的工作表
   ///  @param[in]   worksheet         工作表
+  ///  @param[out]  fragment          工作表片段
+  ///  @return 成功返回true
+  bool Analyze(xlnt::worksheet &worksheet, JsonSheetFragment &fragment) const;
+
+  /// 提交片段
+  /// 按工作表顺序调用，保证输出与顺序执行一致
+  ///  @param[in]   fragment          工作表片段
   ///  @return 成功返回true
-  bool Analyze(xlnt::worksheet &worksheet);
+  bool Commit(JsonSheetFragment &fragment);
 
   /// 生成数据
   ///  @return 成功返回true
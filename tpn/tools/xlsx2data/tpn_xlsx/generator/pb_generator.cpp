@@ -0,0 +1,232 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include "pb_generator.h"
+
+#include <memory>
+#include <fstream>
+#include <filesystem>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/compiler/parser.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/tokenizer.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+#include "log.h"
+#include "config.h"
+#include "debug_hub.h"
+#include "fmt_wrap.h"
+#include "utils.h"
+#include "helper.h"
+#include "analyst.h"
+#include "generator_hub.h"
+
+namespace fs = std::filesystem;
+
+namespace tpn {
+
+namespace xlsx {
+
+namespace {
+
+/// proto描述解析与构建错误输出到日志
+class PbErrorCollector : public google::protobuf::io::ErrorCollector,
+                         public google::protobuf::DescriptorPool::ErrorCollector {
+ public:
+  void AddError(int line, google::protobuf::io::ColumnNumber column,
+                const std::string &message) override {
+    LOG_ERROR("pb generator parse proto error, line: {}, column: {}, {}",
+              line + 1, column + 1, message);
+  }
+
+  void AddError(const std::string &filename, const std::string &element_name,
+                const google::protobuf::Message *descriptor,
+                ErrorLocation location, const std::string &message) override {
+    LOG_ERROR("pb generator build proto error, file: {}, element: {}, {}",
+              filename, element_name, message);
+  }
+};
+
+}  // namespace
+
+PbGenerator::PbGenerator() {}
+
+PbGenerator::~PbGenerator() {}
+
+bool PbGenerator::Load(std::string &error) {
+  file_path_ = fmt::format(
+      "{}/{}.bin", g_config->GetStringDefault("xlsx_bin_dir", "xlsx2data/bin"),
+      g_xlsx2data_generator->GetFilePrefix());
+  data_map_.Clear();
+  factory_.reset();
+  pool_.reset();
+  return true;
+}
+
+bool PbGenerator::BuildDescriptors(std::string_view proto_content) {
+  factory_.reset();
+  pool_.reset();
+
+  PbErrorCollector collector;
+  google::protobuf::io::ArrayInputStream input(
+      proto_content.data(), static_cast<int>(proto_content.size()));
+  google::protobuf::io::Tokenizer tokenizer(&input, &collector);
+  google::protobuf::compiler::Parser parser;
+  parser.RecordErrorsTo(&collector);
+
+  google::protobuf::FileDescriptorProto file_proto;
+  if (!parser.Parse(&tokenizer, &file_proto)) {
+    LOG_ERROR("pb generator parse generated proto error");
+    return false;
+  }
+  file_proto.set_name(
+      fmt::format("{}.proto", g_xlsx2data_generator->GetFilePrefix()));
+
+  // 不以编译时的描述池为底层 避免与旧的同名消息冲突
+  auto pool = std::make_unique<google::protobuf::DescriptorPool>();
+  google::protobuf::FileDescriptorProto any_proto;
+  google::protobuf::Any::descriptor()->file()->CopyTo(&any_proto);
+  if (nullptr == pool->BuildFileCollectingErrors(any_proto, &collector) ||
+      nullptr == pool->BuildFileCollectingErrors(file_proto, &collector)) {
+    LOG_ERROR("pb generator build generated proto error");
+    return false;
+  }
+
+  pool_    = std::move(pool);
+  factory_ = std::make_unique<google::protobuf::DynamicMessageFactory>();
+  return true;
+}
+
+bool PbGenerator::Analyze(xlnt::worksheet &worksheet,
+                          PbSheetFragment &fragment) const {
+  LOG_INFO("pb generator start analyze worksheet : {}", worksheet.title());
+
+  auto &&ranges = worksheet.rows();
+  if (ranges.length() > 2) {  // 第三行及以上为数据
+    std::string title_raw = GetSheetTitle(worksheet.title());
+    TPN_ASSERT(!title_raw.empty(), "sheet title error, title : {}",
+               worksheet.title());
+
+    std::string type_name =
+        fmt::format("tpn.data.{}", GetDataHubEntryName(title_raw));
+    if (nullptr == pool_ || nullptr == factory_) {
+      LOG_ERROR("pb generator descriptors not built, message: {}", type_name);
+      return false;
+    }
+
+    auto *descriptor = pool_->FindMessageTypeByName(type_name);
+    if (nullptr == descriptor) {
+      LOG_ERROR("pb generator couldn't find message: {}", type_name);
+      return false;
+    }
+
+    auto *datas_field =
+        descriptor->FindFieldByName(std::string(GetArrVarName()));
+    if (nullptr == datas_field || !datas_field->is_repeated() ||
+        google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE !=
+            datas_field->cpp_type()) {
+      LOG_ERROR("pb generator message: {} datas field error", type_name);
+      return false;
+    }
+
+    // 动态消息工厂获取原型时加锁 可在多个线程中同时调用
+    std::unique_ptr<google::protobuf::Message> entry(
+        factory_->GetPrototype(descriptor)->New());
+    auto *reflection = entry->GetReflection();
+    auto &analyst    = g_xlsx2data_generator->GetAnalyst();
+
+    // 0 格式 1 注释 >2 数据
+    for (size_t idx = 2; idx < ranges.length(); ++idx) {
+      auto *row_message = reflection->AddMessage(entry.get(), datas_field);
+      for (size_t i = 0; i < ranges[idx].length(); ++i) {  // 数据分析
+        if (!analyst.GenerateProtoMessage(*row_message, title_raw, i,
+                                          ranges[idx][i].to_string())) {
+          LOG_ERROR(
+              "pb generator message data error, title: {}, idx: {}, index: {}, "
+              "data: {}",
+              title_raw, idx, i, ranges[idx][i].to_string());
+          return false;
+        }
+      }
+    }
+
+    fragment.key = LowercaseString(title_raw);
+    fragment.data.PackFrom(*entry);
+    fragment.valid = true;
+  }
+
+  LOG_INFO("pb generator finish analyze worksheet : {}", worksheet.title());
+  return true;
+}
+
+bool PbGenerator::Commit(PbSheetFragment &fragment) {
+  if (!fragment.valid) {
+    return true;
+  }
+
+  (*data_map_.mutable_datas())[fragment.key].Swap(&fragment.data);
+  return true;
+}
+
+bool PbGenerator::Generate() {
+  LOG_INFO("pb generator start generate bin file");
+
+  try {
+    auto bin_path = fs::path(file_path_);
+    bin_path.make_preferred();
+    auto bin_file = fs::absolute(bin_path);
+    if (!fs::exists(bin_file.parent_path())) {
+      fs::create_directories(bin_file.parent_path());
+    }
+
+    std::fstream output(bin_file, std::fstream::out | std::fstream::trunc |
+                                      std::fstream::binary);
+    google::protobuf::io::OstreamOutputStream output_stream(&output);
+    google::protobuf::io::CodedOutputStream coded_output(&output_stream);
+    // map 默认按哈希顺序序列化 确定性序列化保证多次生成结果一致
+    coded_output.SetSerializationDeterministic(true);
+    if (!data_map_.SerializeToCodedStream(&coded_output)) {
+      LOG_ERROR("pb generator failed to write data_hub protobuf bin.");
+      return false;
+    }
+  } catch (fs::filesystem_error &e) {
+    LOG_ERROR("{},error: {}", file_path_, e.what());
+    return false;
+  } catch (const std::exception &ex) {
+    LOG_ERROR("{},error: {}", file_path_, ex.what());
+    return false;
+  }
+
+  data_map_.Clear();
+
+  LOG_INFO("pb generator finish generate bin file");
+  return true;
+}
+
+}  // namespace xlsx
+
+}  // namespace tpn
@@ -0,0 +1,99 @@
+//
+//           ┌┬┐┬ ┬┌─┐┬ ┬┌─┐┌─┐┌┐┌
+//            │ └┬┘├─┘├─┤│ ││ ││││
+//            ┴  ┴ ┴  ┴ ┴└─┘└─┘┘└┘
+//
+// This file is part of the typhoon Project.
+// Copyright (C) 2021 stanley0207@163.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef TYPHOON_ZERO_TPN_TOOLS_XLSX2DATA_TPN_XLSX_GENERATOR_PB_GENERATOR_H_
+#define TYPHOON_ZERO_TPN_TOOLS_XLSX2DATA_TPN_XLSX_GENERATOR_PB_GENERATOR_H_
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <google/protobuf/any.pb.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/dynamic_message.h>
+
+#include "xlsx2data_common.h"
+#include "data_hub.pb.h"
+
+namespace tpn {
+
+namespace xlsx {
+
+/// protobuf工作表片段
+/// 分析阶段各工作表并行生成
+struct PbSheetFragment {
+  std::string key;             ///< 数据键 工作表名小写
+  google::protobuf::Any data;  ///< 打包后的工作表数据
+  bool valid{false};           ///< 是否有数据
+};
+
+/// protobuf bin文件直接生成器
+/// 根据分析器的字段类型通过反射直接填充消息，不经过json
+/// 消息类型由本次生成的proto描述动态构建，新增工作表或字段无需先重新编译工具
+class TPN_XLSX2DATA_API PbGenerator {
+ public:
+  PbGenerator();
+  ~PbGenerator();
+
+  /// 加载配置
+  ///  @param[out]  error     读取数据错误信息
+  ///  @return 加载成功返回true
+  bool Load(std::string &error);
+
+  /// 构建消息类型
+  /// 在分析数据之前调用
+  ///  @param[in]   proto_content     本次生成的proto描述内容
+  ///  @return 成功返回true
+  bool BuildDescriptors(std::string_view proto_content);
+
+  /// 分析数据
+  /// 只读取分析器，可在多个线程中同时分析不同的工作表
+  ///  @param[in]   worksheet         工作表
+  ///  @param[out]  fragment          工作表片段
+  ///  @return 成功返回true
+  bool Analyze(xlnt::worksheet &worksheet, PbSheetFragment &fragment) const;
+
+  /// 提交片段
+  /// 按工作表顺序调用
+  ///  @param[in]   fragment          工作表片段
+  ///  @return 成功返回true
+  bool Commit(PbSheetFragment &fragment);
+
+  /// 生成数据
+  ///  @return 生成成功返回true
+  bool Generate();
+
+ private:
+  data::DataHubMap data_map_;  ///< 所有数据
+  std::string file_path_;      ///< 输出文件路径
+  std::unique_ptr<google::protobuf::DescriptorPool>
+      pool_;  ///< 本次生成的消息类型
+  std::unique_ptr<google::protobuf::DynamicMessageFactory>
+      factory_;  ///< 动态消息工厂 必须先于pool_析构
+};
+
+}  // namespace xlsx
+
+}  // namespace tpn
+
+#endif  // TYPHOON_ZERO_TPN_TOOLS_XLSX2DATA_TPN_XLSX_GENERATOR_PB_GENERATOR_H_
@@ -54,48 +54,60 @@ bool ProtoGenerator::Load(std::string &error) {
   }
 
   printer_.Reset();
+  GenerateHead(printer_);
+  proto_file_.Write(printer_.GetBuf());
+
+  return true;
+}
+
+bool ProtoGenerator::Analyze(xlnt::worksheet &worksheet) {
+  LOG_INFO("proto generator start analyze worksheet : {}", worksheet.title());
 
+  printer_.Reset();  // 重置一下缓冲流
+  if (!GenerateMessage(worksheet, printer_)) {
+    return false;
+  }
+  proto_file_.Write(printer_.GetBuf());
+
+  LOG_INFO("proto generator finish analyze worksheet : {}", worksheet.title());
+  return true;
+}
+
+void ProtoGenerator::GenerateHead(Printer &printer) const {
   // license
   auto license = GetLicense();
-  printer_.Print(license);
+  printer.Print(license);
 
   // proto3 head
   auto proto3_head = GetProto3Head();
-  printer_.Print(proto3_head);
+  printer.Print(proto3_head);
 
   // map
   auto data_hub_map = GetProto3DataHubMap();
-  printer_.Print(data_hub_map);
-
-  proto_file_.Write(printer_.GetBuf());
-
-  return true;
+  printer.Print(data_hub_map);
 }
 
-bool ProtoGenerator::Analyze(xlnt::worksheet &worksheet) {
-  LOG_INFO("proto generator start analyze worksheet : {}", worksheet.title());
-
+bool ProtoGenerator::GenerateMessage(xlnt::worksheet &worksheet,
+                                     Printer &printer) const {
   auto &&ranges = worksheet.rows();
   if (ranges.length() > 0) {
-    printer_.Reset();  // 重置一下缓冲流
-
     std::string title_raw = GetSheetTitle(worksheet.title());
     TPN_ASSERT(!title_raw.empty(), "sheet title error, title : {}",
                worksheet.title());
 
     std::string title = CapitalizeFirstLetter(title_raw);
 
-    printer_.Println(fmt::format("message {} {{", GetProto3MessageName(title)));
-    printer_.Indent();
+    printer.Println(fmt::format("message {} {{", GetProto3MessageName(title)));
+    printer.Indent();
 
-    printer_.Println(fmt::format("message {} {{", title));
-    printer_.Indent();
+    printer.Println(fmt::format("message {} {{", title));
+    printer.Indent();
 
     // 字段解析
     auto &&row = ranges[0];
     for (size_t i = 0; i < row.length(); ++i) {
       if (!g_xlsx2data_generator->GetAnalyst().GenerateProtoData(
-              printer_, title_raw, i)) {
+              printer, title_raw, i)) {
         LOG_ERROR(
             "proto generator proto data error, title: {}, index: {}, data: {}",
             title_raw, i, row[i].to_string());
@@ -103,18 +115,15 @@ bool ProtoGenerator::Analyze(xlnt::worksheet &worksheet) {
       }
     }
 
-    printer_.Outdent();
-    printer_.Println("}");
-    printer_.Println(fmt::format("repeated {} datas = 1;", title));
-
-    printer_.Outdent();
-    printer_.Println("}");
-    printer_.Println("");
+    printer.Outdent();
+    printer.Println("}");
+    printer.Println(fmt::format("repeated {} datas = 1;", title));
 
-    proto_file_.Write(printer_.GetBuf());
+    printer.Outdent();
+    printer.Println("}");
+    printer.Println("");
   }
 
-  LOG_INFO("proto generator finish analyze worksheet : {}", worksheet.title());
   return true;
 }
 
@@ -49,6 +49,17 @@ class TPN_XLSX2DATA_API ProtoGenerator {
   ///  @return 成功返回true
   bool Analyze(xlnt::worksheet &worksheet);
 
+  /// 生成proto文件头 包括license与DataHubMap
+  ///  @param[in]   printer           打印器
+  void GenerateHead(Printer &printer) const;
+
+  /// 生成工作表的消息描述
+  /// 只读取分析器，不写文件
+  ///  @param[in]   worksheet         工作表
+  ///  @param[in]   printer           打印器
+  ///  @return 成功返回true
+  bool GenerateMessage(xlnt::worksheet &worksheet, Printer &printer) const;
+
  private:
   FileHelper proto_file_;  ///< proto数据
   Printer printer_;        ///< 打印器
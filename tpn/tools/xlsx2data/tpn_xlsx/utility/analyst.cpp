@@ -22,6 +22,15 @@
 
 #include "analyst.h"
 
+#include <cstring>
+
+#include <algorithm>
+#include <charconv>
+#include <limits>
+
+#include <google/protobuf/message.h>
+#include <google/protobuf/descriptor.h>
+
 #include "utils.h"
 #include "log.h"
 #include "debug_hub.h"
@@ -30,6 +39,100 @@ namespace tpn {
 
 namespace xlsx {
 
+namespace {
+
+/// 写入平坦数据字段
+template <typename T>
+void WriteFlatValue(uint8_t *dst, const T &value) {
+  std::memcpy(dst, &value, sizeof(T));
+}
+
+/// 读取平坦数据字段
+template <typename T>
+T ReadFlatValue(const uint8_t *src) {
+  T value;
+  std::memcpy(&value, src, sizeof(T));
+  return value;
+}
+
+/// 比较平坦数据字段
+template <typename T>
+int CompareFlatValue(const uint8_t *lhs, const uint8_t *rhs) {
+  auto lhs_val = ReadFlatValue<T>(lhs);
+  auto rhs_val = ReadFlatValue<T>(rhs);
+  return lhs_val < rhs_val ? -1 : (rhs_val < lhs_val ? 1 : 0);
+}
+
+/// 解析整数单元格
+/// 整个单元格必须是目标类型范围内的整数，不截断、不回绕
+///  @param[in]   name      字段名
+///  @param[in]   data      单元格内容
+///  @param[out]  value     整数值
+///  @return 成功返回true
+template <typename T>
+bool ParseIntegerCell(std::string_view name, std::string_view data, T &value) {
+  auto *end      = data.data() + data.size();
+  auto [ptr, ec] = std::from_chars(data.data(), end, value);
+  if (std::errc::result_out_of_range == ec) {
+    LOG_ERROR("{} value out of range [{}, {}], cell: {}", name,
+              (std::numeric_limits<T>::min)(), (std::numeric_limits<T>::max)(),
+              data);
+    return false;
+  }
+  if (std::errc() != ec || end != ptr) {
+    LOG_ERROR("{} value is not an integer, cell: {}", name, data);
+    return false;
+  }
+  return true;
+}
+
+/// 查找protobuf字段
+/// 普通字段与proto描述同名，复合类型字段为小写
+const google::protobuf::FieldDescriptor *FindProtoField(
+    const google::protobuf::Message &message, std::string_view name) {
+  auto *descriptor = message.GetDescriptor();
+  auto *field = descriptor->FindFieldByName(std::string(name));
+  if (nullptr == field) {
+    field = descriptor->FindFieldByName(LowercaseString(name));
+  }
+  return field;
+}
+
+/// protobuf字段类型是否与表类型一致
+/// 工具内的data_hub.pb与表结构不一致时反射写入会直接崩溃，需要提前检查
+bool CheckProtoField(const google::protobuf::FieldDescriptor *field,
+                     XlsxDataType type) {
+  using FieldDescriptor = google::protobuf::FieldDescriptor;
+  switch (type) {
+    case XlsxDataType::kXlsxDataTypeDouble:
+      return FieldDescriptor::CPPTYPE_DOUBLE == field->cpp_type();
+    case XlsxDataType::kXlsxDataTypeFloat:
+      return FieldDescriptor::CPPTYPE_FLOAT == field->cpp_type();
+    case XlsxDataType::kXlsxDataTypeI32:
+      return FieldDescriptor::CPPTYPE_INT32 == field->cpp_type();
+    case XlsxDataType::kXlsxDataTypeI64:
+      return FieldDescriptor::CPPTYPE_INT64 == field->cpp_type();
+    case XlsxDataType::kXlsxDataTypeU32:
+      return FieldDescriptor::CPPTYPE_UINT32 == field->cpp_type();
+    case XlsxDataType::kXlsxDataTypeU64:
+      return FieldDescriptor::CPPTYPE_UINT64 == field->cpp_type();
+    case XlsxDataType::kXlsxDataTypeBool:
+      return FieldDescriptor::CPPTYPE_BOOL == field->cpp_type();
+    case XlsxDataType::kXlsxDataTypeStr:
+      return FieldDescriptor::CPPTYPE_STRING == field->cpp_type();
+    case XlsxDataType::kXlsxDataTypeComplexObj:
+      return FieldDescriptor::CPPTYPE_MESSAGE == field->cpp_type() &&
+             !field->is_repeated();
+    case XlsxDataType::kXlsxDataTypeComplexArr:
+      return FieldDescriptor::CPPTYPE_MESSAGE == field->cpp_type() &&
+             field->is_repeated();
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
 AnalystField::AnalystField() {}
 
 AnalystField::~AnalystField() {}
@@ -96,6 +199,24 @@ bool AnalystField::GenerateProtoData(Printer &printer, size_t index) {
   return GenerateProtoData(printer, type_, name_, index);
 }
 
+bool AnalystField::GenerateProtoMessage(google::protobuf::Message &row_message,
+                                        std::string_view data) {
+  // 检查约束
+  switch (constraint_type_) {
+    case XlsxDataConstraintType::kXlsxDataConstraintTypePrimaryKey:
+    case XlsxDataConstraintType::kXlsxDataConstraintTypeNotEmpty: {
+      TPN_ASSERT(!data.empty(), "{} constraint could'nt be empty", name_);
+    } break;
+    default: {
+      if (data.empty()) {  // 允许为空
+        return true;
+      }
+    } break;
+  }
+
+  return GenerateProtoMessage(row_message, type_, name_, data);
+}
+
 void AnalystField::GenerateCppFieldKeys(std::string &field_keys,
                                         std::string &field_comments) {
   if (!IsCppFieldKeys()) {
@@ -119,6 +240,125 @@ bool AnalystField::IsCppFieldKeys() {
   return true;
 }
 
+bool AnalystField::GenerateFlatData(FlatDataWriter &writer, uint8_t *row,
+                                    std::string_view data) {
+  // 检查约束
+  switch (constraint_type_) {
+    case XlsxDataConstraintType::kXlsxDataConstraintTypePrimaryKey:
+    case XlsxDataConstraintType::kXlsxDataConstraintTypeNotEmpty: {
+      TPN_ASSERT(!data.empty(), "{} constraint could'nt be empty", name_);
+    } break;
+    default: {
+      if (data.empty()) {  // 允许为空 保持零值
+        return true;
+      }
+    } break;
+  }
+
+  std::string data_str(data.data(), data.length());
+  auto *dst = row + flat_offset_;
+  switch (type_) {
+    case XlsxDataType::kXlsxDataTypeDouble: {
+      WriteFlatValue(dst, std::stod(data_str));
+    } break;
+    case XlsxDataType::kXlsxDataTypeFloat: {
+      WriteFlatValue(dst, std::stof(data_str));
+    } break;
+    case XlsxDataType::kXlsxDataTypeI32: {
+      int32_t value = 0;
+      if (!ParseIntegerCell(name_, data, value)) {
+        return false;
+      }
+      WriteFlatValue(dst, value);
+    } break;
+    case XlsxDataType::kXlsxDataTypeI64: {
+      int64_t value = 0;
+      if (!ParseIntegerCell(name_, data, value)) {
+        return false;
+      }
+      WriteFlatValue(dst, value);
+    } break;
+    case XlsxDataType::kXlsxDataTypeU32: {
+      uint32_t value = 0;
+      if (!ParseIntegerCell(name_, data, value)) {
+        return false;
+      }
+      WriteFlatValue(dst, value);
+    } break;
+    case XlsxDataType::kXlsxDataTypeU64: {
+      uint64_t value = 0;
+      if (!ParseIntegerCell(name_, data, value)) {
+        return false;
+      }
+      WriteFlatValue(dst, value);
+    } break;
+    case XlsxDataType::kXlsxDataTypeBool: {
+      WriteFlatValue(dst, StringToBool(data_str));
+    } break;
+    case XlsxDataType::kXlsxDataTypeStr:
+    case XlsxDataType::kXlsxDataTypeComplexObj:
+    case XlsxDataType::kXlsxDataTypeComplexArr: {  // 复合类型保存原始文本
+      WriteFlatValue(dst, writer.AppendString(data_str));
+    } break;
+    case XlsxDataType::kXlsxDataTypeDesc: {  // 注释跳过
+      return true;
+    } break;
+    default:
+      return false;
+  }
+
+  return true;
+}
+
+int AnalystField::CompareFlatData(const FlatDataWriter &writer,
+                                  const uint8_t *lhs,
+                                  const uint8_t *rhs) const {
+  lhs += flat_offset_;
+  rhs += flat_offset_;
+  switch (type_) {
+    case XlsxDataType::kXlsxDataTypeI32: {
+      return CompareFlatValue<int32_t>(lhs, rhs);
+    } break;
+    case XlsxDataType::kXlsxDataTypeI64: {
+      return CompareFlatValue<int64_t>(lhs, rhs);
+    } break;
+    case XlsxDataType::kXlsxDataTypeU32: {
+      return CompareFlatValue<uint32_t>(lhs, rhs);
+    } break;
+    case XlsxDataType::kXlsxDataTypeU64: {
+      return CompareFlatValue<uint64_t>(lhs, rhs);
+    } break;
+    case XlsxDataType::kXlsxDataTypeStr: {
+      auto ret =
+          writer.GetString(ReadFlatValue<FlatDataStr>(lhs))
+              .compare(writer.GetString(ReadFlatValue<FlatDataStr>(rhs)));
+      return ret < 0 ? -1 : (ret > 0 ? 1 : 0);
+    } break;
+    default: {
+      TPN_ASSERT(false, "type:{} couldn't be primary key", type_);
+      return 0;
+    } break;
+  }
+}
+
+void AnalystField::MergeFlatData(FlatDataWriter &writer,
+                                 const FlatDataWriter &source,
+                                 uint8_t *row) const {
+  switch (type_) {
+    case XlsxDataType::kXlsxDataTypeStr:
+    case XlsxDataType::kXlsxDataTypeComplexObj:
+    case XlsxDataType::kXlsxDataTypeComplexArr: {
+      auto *dst = row + flat_offset_;
+      auto str  = source.GetString(ReadFlatValue<FlatDataStr>(dst));
+      WriteFlatValue(dst, writer.AppendString(str));
+    } break;
+    default:
+      break;
+  }
+}
+
+void AnalystField::SetFlatOffset(size_t offset) { flat_offset_ = offset; }
+
 std::string_view AnalystField::GetName() { return name_; }
 
 tpn::xlsx::XlsxDataType AnalystField::GetType() { return type_; }
@@ -233,16 +473,32 @@ bool AnalystField::GenerateJsonData(rapidjson::Document &document,
       val.SetFloat(std::stof(data_str));
     } break;
     case XlsxDataType::kXlsxDataTypeI32: {
-      val.SetInt(std::stol(data_str));
+      int32_t value = 0;
+      if (!ParseIntegerCell(name, data, value)) {
+        return false;
+      }
+      val.SetInt(value);
     } break;
     case XlsxDataType::kXlsxDataTypeI64: {
-      val.SetInt64(std::stoll(data_str));
+      int64_t value = 0;
+      if (!ParseIntegerCell(name, data, value)) {
+        return false;
+      }
+      val.SetInt64(value);
     } break;
     case XlsxDataType::kXlsxDataTypeU32: {
-      val.SetUint(std::stoul(data_str));
+      uint32_t value = 0;
+      if (!ParseIntegerCell(name, data, value)) {
+        return false;
+      }
+      val.SetUint(value);
     } break;
     case XlsxDataType::kXlsxDataTypeU64: {
-      val.SetUint64(std::stoull(data_str));
+      uint64_t value = 0;
+      if (!ParseIntegerCell(name, data, value)) {
+        return false;
+      }
+      val.SetUint64(value);
     } break;
     case XlsxDataType::kXlsxDataTypeBool: {
       val.SetBool(StringToBool(data_str));
@@ -394,6 +650,145 @@ bool AnalystField::GenerateProtoData(Printer &printer, XlsxDataType type,
   return true;
 }
 
+bool AnalystField::GenerateProtoMessage(google::protobuf::Message &message,
+                                        XlsxDataType type,
+                                        std::string_view name,
+                                        std::string_view data) {
+  if (XlsxDataType::kXlsxDataTypeDesc == type) {  // 注释跳过
+    return true;
+  }
+
+  auto *field = FindProtoField(message, name);
+  if (nullptr == field || !CheckProtoField(field, type)) {
+    LOG_ERROR("proto field mismatch, message: {}, field: {}, type: {}",
+              message.GetDescriptor()->full_name(), name, type);
+    return false;
+  }
+
+  std::string data_str(data.data(), data.length());
+  auto *reflection = message.GetReflection();
+  switch (type) {
+    case XlsxDataType::kXlsxDataTypeDouble: {
+      reflection->SetDouble(&message, field, std::stod(data_str));
+    } break;
+    case XlsxDataType::kXlsxDataTypeFloat: {
+      reflection->SetFloat(&message, field, std::stof(data_str));
+    } break;
+    case XlsxDataType::kXlsxDataTypeI32: {
+      int32_t value = 0;
+      if (!ParseIntegerCell(name, data, value)) {
+        return false;
+      }
+      reflection->SetInt32(&message, field, value);
+    } break;
+    case XlsxDataType::kXlsxDataTypeI64: {
+      int64_t value = 0;
+      if (!ParseIntegerCell(name, data, value)) {
+        return false;
+      }
+      reflection->SetInt64(&message, field, value);
+    } break;
+    case XlsxDataType::kXlsxDataTypeU32: {
+      uint32_t value = 0;
+      if (!ParseIntegerCell(name, data, value)) {
+        return false;
+      }
+      reflection->SetUInt32(&message, field, value);
+    } break;
+    case XlsxDataType::kXlsxDataTypeU64: {
+      uint64_t value = 0;
+      if (!ParseIntegerCell(name, data, value)) {
+        return false;
+      }
+      reflection->SetUInt64(&message, field, value);
+    } break;
+    case XlsxDataType::kXlsxDataTypeBool: {
+      reflection->SetBool(&message, field, StringToBool(data_str));
+    } break;
+    case XlsxDataType::kXlsxDataTypeStr: {
+      reflection->SetString(&message, field, std::move(data_str));
+    } break;
+    case XlsxDataType::kXlsxDataTypeComplexObj: {
+      if (!GenerateProtoMessageComplexObj(
+              *reflection->MutableMessage(&message, field), data_str,
+              complex_field_.first)) {
+        return false;
+      }
+    } break;
+    case XlsxDataType::kXlsxDataTypeComplexArr: {
+      if (!GenerateProtoMessageComplexArr(message, field, data_str)) {
+        return false;
+      }
+    } break;
+    default:
+      return false;
+  }
+
+  return true;
+}
+
+bool AnalystField::GenerateProtoMessageComplexObj(
+    google::protobuf::Message &message, std::string_view data,
+    std::string_view delimiter) {
+  TPN_ASSERT(1 == delimiter.length(),
+             "{} obj delimiter only be one, {} is error, {}", name_, delimiter,
+             data);
+  auto data_vec = Tokenize(data, delimiter);
+  TPN_ASSERT(data_vec.size() == complex_field_.second.size(),
+             "{} data length error, {}", name_, data_vec);
+  for (size_t i = 0; i < data_vec.size(); ++i) {
+    if (!GenerateProtoMessage(message, complex_field_.second[i],
+                              "p{}"_format(i + 1), data_vec[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool AnalystField::GenerateProtoMessageComplexArr(
+    google::protobuf::Message &message,
+    const google::protobuf::FieldDescriptor *field, std::string_view data,
+    size_t delimiter_index /*= 0*/) {
+  // -2时需要转换为obj解析
+  TPN_ASSERT(delimiter_index < complex_field_.first.length() - 1,
+             "delimiter index error, {} < {}", delimiter_index,
+             complex_field_.first);
+
+  auto *reflection = message.GetReflection();
+  std::string delimiter = std::string(1, complex_field_.first[delimiter_index]);
+  auto data_vec         = Tokenize(data, delimiter);
+  if (delimiter_index == complex_field_.first.length() - 2) {  // obj
+    std::string delimiter_obj =
+        std::string(1, complex_field_.first[complex_field_.first.length() - 1]);
+
+    for (auto &&data_str : data_vec) {
+      if (!GenerateProtoMessageComplexObj(
+              *reflection->AddMessage(&message, field), data_str,
+              delimiter_obj)) {
+        return false;
+      }
+    }
+  } else {
+    std::string key_name = fmt::format("nest{}", delimiter_index + 1);
+    for (auto &&data_str : data_vec) {
+      auto *nest_message = reflection->AddMessage(&message, field);
+      auto *nest_field   = FindProtoField(*nest_message, key_name);
+      if (nullptr == nest_field ||
+          !CheckProtoField(nest_field, XlsxDataType::kXlsxDataTypeComplexArr)) {
+        LOG_ERROR("proto field mismatch, message: {}, field: {}",
+                  nest_message->GetDescriptor()->full_name(), key_name);
+        return false;
+      }
+      if (!GenerateProtoMessageComplexArr(*nest_message, nest_field, data_str,
+                                          delimiter_index + 1)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
 AnalystSheet::AnalystSheet() {}
 
 AnalystSheet::AnalystSheet(std::string_view sheet_title)
@@ -433,6 +828,14 @@ bool AnalystSheet::GenerateProtoData(Printer &printer, size_t index) {
   return fields_[index].GenerateProtoData(printer, index + 1);
 }
 
+bool AnalystSheet::GenerateProtoMessage(google::protobuf::Message &row_message,
+                                        size_t index, std::string_view data) {
+  TPN_ASSERT(index < fields_.size(), "index error, index: {}, fields size: {}",
+             index, fields_.size());
+
+  return fields_[index].GenerateProtoMessage(row_message, data);
+}
+
 bool AnalystSheet::GenerateCppHeadData(Printer &printer) {
   std::string field_comments = "///";
   std::string field_keys     = "";
@@ -579,6 +982,203 @@ bool AnalystSheet::GenerateCppSourceData(Printer &printer,
   return true;
 }
 
+void AnalystSheet::GenerateFlatLayout() {
+  size_t offset    = 0;
+  size_t max_align = 1;
+  for (auto &&field : fields_) {
+    auto size  = GetFlatSizeByType(field.GetType());
+    auto align = GetFlatAlignByType(field.GetType());
+    if (0 == size) {  // 不导出
+      continue;
+    }
+    offset = (offset + align - 1) / align * align;
+    field.SetFlatOffset(offset);
+    offset += size;
+    max_align = std::max(max_align, align);
+  }
+
+  flat_row_size_ = (offset + max_align - 1) / max_align * max_align;
+}
+
+size_t AnalystSheet::GetFlatRowSize() const { return flat_row_size_; }
+
+bool AnalystSheet::GenerateFlatData(FlatDataWriter &writer, uint8_t *row,
+                                    size_t index, std::string_view data) {
+  TPN_ASSERT(index < fields_.size(), "index error, index: {}, fields size: {}",
+             index, fields_.size());
+
+  return fields_[index].GenerateFlatData(writer, row, data);
+}
+
+int AnalystSheet::CompareFlatRow(const FlatDataWriter &writer,
+                                 const uint8_t *lhs, const uint8_t *rhs) {
+  for (auto &&field : fields_) {
+    if (!field.IsCppFieldKeys()) {
+      continue;
+    }
+
+    auto ret = field.CompareFlatData(writer, lhs, rhs);
+    if (0 != ret) {
+      return ret;
+    }
+  }
+
+  return 0;
+}
+
+void AnalystSheet::MergeFlatRow(FlatDataWriter &writer,
+                                const FlatDataWriter &source,
+                                uint8_t *row) const {
+  for (auto &&field : fields_) {
+    field.MergeFlatData(writer, source, row);
+  }
+}
+
+bool AnalystSheet::GenerateCppFlatHeadData(Printer &printer) {
+  std::string field_comments = "///";
+  std::string field_keys     = "";
+  for (auto &&field : fields_) {
+    if (!field.IsCppFieldKeys()) {
+      continue;
+    }
+
+    auto key_type = XlsxDataType::kXlsxDataTypeStr == field.GetType()
+                        ? std::string("std::string_view")
+                        : GetCppTypeByType(field.GetType());
+    field_keys += fmt::format("{} {}, ", key_type, field.GetName());
+    field_comments += fmt::format(" {}-{}", key_type, field.GetName());
+  }
+
+  Trim(field_keys);
+  if (field_keys.empty()) {
+    LOG_ERROR("{} not have primary key", sheet_title_);
+    return false;
+  }
+
+  std::string flat_name =
+      fmt::format("Flat{}", GetProto3MessageName(sheet_title_));
+
+  printer.Println("");
+  printer.Println(" public:");
+  printer.Indent();
+  printer.Println(fmt::format("/// {} 平坦数据行", sheet_title_));
+  printer.Println(fmt::format("struct {} {{", flat_name));
+  printer.Indent();
+  for (auto &&field : fields_) {
+    if (0 == GetFlatSizeByType(field.GetType())) {
+      continue;
+    }
+    printer.Println(fmt::format("{} {};", GetCppFlatTypeByType(field.GetType()),
+                                field.GetName()));
+  }
+  printer.Outdent();
+  printer.Println("};");
+  printer.Println(
+      fmt::format("static_assert({} == sizeof({}), \"flat row layout "
+                  "changed\");",
+                  flat_row_size_, flat_name));
+  printer.Println("");
+  printer.Println(field_comments);
+  std::string_view field_keys_strv(field_keys.data(), field_keys.length() - 1);
+  printer.Println(fmt::format("const {0} *Get{0}({1}) const;", flat_name,
+                              field_keys_strv));
+  printer.Outdent();
+
+  printer.Println(" private:");
+  printer.Indent();
+  printer.Println(fmt::format("std::span<const {}> flat_{}_rows_;", flat_name,
+                              LowercaseString(sheet_title_)));
+  printer.Outdent();
+
+  return true;
+}
+
+bool AnalystSheet::GenerateCppFlatSourceData(Printer &printer,
+                                             Printer &load_printer,
+                                             Printer &reset_printer) {
+  std::string field_comments = "///";
+  std::string field_keys     = "";
+  std::string key_args       = "";
+  std::string row_args       = "";
+  std::string iter_args      = "";
+  bool capture_this          = false;
+  for (auto &&field : fields_) {
+    if (!field.IsCppFieldKeys()) {
+      continue;
+    }
+
+    bool is_str   = XlsxDataType::kXlsxDataTypeStr == field.GetType();
+    auto key_type = is_str ? std::string("std::string_view")
+                           : GetCppTypeByType(field.GetType());
+    field_keys += fmt::format("{} {}, ", key_type, field.GetName());
+    field_comments += fmt::format(" {}-{}", key_type, field.GetName());
+    key_args += fmt::format("{}, ", field.GetName());
+    if (is_str) {
+      row_args += fmt::format("GetFlatString(row.{}), ", field.GetName());
+      iter_args += fmt::format("GetFlatString(iter->{}), ", field.GetName());
+      capture_this = true;
+    } else {
+      row_args += fmt::format("row.{}, ", field.GetName());
+      iter_args += fmt::format("iter->{}, ", field.GetName());
+    }
+  }
+
+  Trim(field_keys);
+  Trim(key_args);
+  Trim(row_args);
+  Trim(iter_args);
+  if (field_keys.empty()) {
+    LOG_ERROR("{} not have primary key", sheet_title_);
+    return false;
+  }
+
+  std::string flat_name =
+      fmt::format("Flat{}", GetProto3MessageName(sheet_title_));
+  std::string rows_name =
+      fmt::format("flat_{}_rows_", LowercaseString(sheet_title_));
+  std::string_view field_keys_strv(field_keys.data(), field_keys.length() - 1);
+  std::string_view key_args_strv(key_args.data(), key_args.length() - 1);
+  std::string_view row_args_strv(row_args.data(), row_args.length() - 1);
+  std::string_view iter_args_strv(iter_args.data(), iter_args.length() - 1);
+
+  printer.Println(field_comments);
+  printer.Println(fmt::format("const {0}{1} *{0}Get{1}({2}) const {{",
+                              GetCppDataHubMgrNameWithArea(), flat_name,
+                              field_keys_strv));
+  printer.Indent();
+  printer.Println(
+      fmt::format("auto map_key = std::make_tuple({});", key_args_strv));
+  printer.Println("auto iter    = std::lower_bound(");
+  printer.Println(
+      fmt::format("    {0}.begin(), {0}.end(), map_key,", rows_name));
+  printer.Println(fmt::format("    [{}](const {} &row, const auto &key) {{",
+                              capture_this ? "this" : "", flat_name));
+  printer.Println(fmt::format("      return std::make_tuple({}) < key;",
+                              row_args_strv));
+  printer.Println("    });");
+  printer.Println(fmt::format("if ({}.end() == iter ||", rows_name));
+  printer.Println(fmt::format("    std::make_tuple({}) != map_key) {{",
+                              iter_args_strv));
+  printer.Println("  return nullptr;");
+  printer.Println("}");
+  printer.Println("return &(*iter);");
+  printer.Outdent();
+  printer.Println("}");
+
+  load_printer.Println(
+      fmt::format("  if (!flat_file_.GetRows(\"{}\", {})) {{",
+                  LowercaseString(sheet_title_), rows_name));
+  load_printer.Println(fmt::format(
+      "    error = \"flat table error ({}) \";", LowercaseString(sheet_title_)));
+  load_printer.Println("    ResetFlat();");
+  load_printer.Println("    return false;");
+  load_printer.Println("  }");
+
+  reset_printer.Println(fmt::format("  {} = {{}};", rows_name));
+
+  return true;
+}
+
 std::string_view AnalystSheet::GetSheetTitle() const { return sheet_title_; }
 
 void AnalystSheet::PrintStorage() const {
@@ -610,6 +1210,8 @@ bool Analyst::Analyze(xlnt::worksheet &worksheet) {
     Analyze(title_raw, cell.to_string());
   }
 
+  sheet_umap_[title_raw].GenerateFlatLayout();
+
   LOG_INFO("analyst finish analyze worksheet : {}", worksheet.title());
   return true;
 }
@@ -657,6 +1259,17 @@ bool Analyst::GenerateProtoData(Printer &printer, std::string_view sheet_title,
   return iter->second.GenerateProtoData(printer, index);
 }
 
+bool Analyst::GenerateProtoMessage(google::protobuf::Message &row_message,
+                                   std::string_view sheet_title, size_t index,
+                                   std::string_view data) {
+  std::string title_key(sheet_title.data(), sheet_title.length());
+  auto iter = sheet_umap_.find(title_key);
+  TPN_ASSERT(sheet_umap_.end() != iter,
+             "data not in analyst, title: {}, data: {}", sheet_title, data);
+
+  return iter->second.GenerateProtoMessage(row_message, index, data);
+}
+
 bool Analyst::GenerateCppHeadData(Printer &printer,
                                   std::string_view sheet_title) {
   std::string title_key(sheet_title.data(), sheet_title.length());
@@ -678,6 +1291,69 @@ bool Analyst::GenerateCppSourceData(Printer &printer, Printer &init_printer,
   return iter->second.GenerateCppSourceData(printer, init_printer, init_flag);
 }
 
+size_t Analyst::GetFlatRowSize(std::string_view sheet_title) {
+  std::string title_key(sheet_title.data(), sheet_title.length());
+  auto iter = sheet_umap_.find(title_key);
+  TPN_ASSERT(sheet_umap_.end() != iter, "data not in analyst, title: {}",
+             sheet_title);
+
+  return iter->second.GetFlatRowSize();
+}
+
+bool Analyst::GenerateFlatData(FlatDataWriter &writer, uint8_t *row,
+                               std::string_view sheet_title, size_t index,
+                               std::string_view data) {
+  std::string title_key(sheet_title.data(), sheet_title.length());
+  auto iter = sheet_umap_.find(title_key);
+  TPN_ASSERT(sheet_umap_.end() != iter,
+             "data not in analyst, title: {}, data: {}", sheet_title, data);
+
+  return iter->second.GenerateFlatData(writer, row, index, data);
+}
+
+int Analyst::CompareFlatRow(const FlatDataWriter &writer,
+                            std::string_view sheet_title, const uint8_t *lhs,
+                            const uint8_t *rhs) {
+  std::string title_key(sheet_title.data(), sheet_title.length());
+  auto iter = sheet_umap_.find(title_key);
+  TPN_ASSERT(sheet_umap_.end() != iter, "data not in analyst, title: {}",
+             sheet_title);
+
+  return iter->second.CompareFlatRow(writer, lhs, rhs);
+}
+
+void Analyst::MergeFlatRow(FlatDataWriter &writer, const FlatDataWriter &source,
+                           std::string_view sheet_title, uint8_t *row) {
+  std::string title_key(sheet_title.data(), sheet_title.length());
+  auto iter = sheet_umap_.find(title_key);
+  TPN_ASSERT(sheet_umap_.end() != iter, "data not in analyst, title: {}",
+             sheet_title);
+
+  iter->second.MergeFlatRow(writer, source, row);
+}
+
+bool Analyst::GenerateCppFlatHeadData(Printer &printer,
+                                      std::string_view sheet_title) {
+  std::string title_key(sheet_title.data(), sheet_title.length());
+  auto iter = sheet_umap_.find(title_key);
+  TPN_ASSERT(sheet_umap_.end() != iter, "data not in analyst, title: {}",
+             sheet_title);
+
+  return iter->second.GenerateCppFlatHeadData(printer);
+}
+
+bool Analyst::GenerateCppFlatSourceData(Printer &printer, Printer &load_printer,
+                                        Printer &reset_printer,
+                                        std::string_view sheet_title) {
+  std::string title_key(sheet_title.data(), sheet_title.length());
+  auto iter = sheet_umap_.find(title_key);
+  TPN_ASSERT(sheet_umap_.end() != iter, "data not in analyst, title: {}",
+             sheet_title);
+
+  return iter->second.GenerateCppFlatSourceData(printer, load_printer,
+                                                reset_printer);
+}
+
 }  // namespace xlsx
 
 }  // namespace tpn
@@ -30,9 +30,17 @@
 
 #include <rapidjson/document.h>
 
+#include "flat_data.h"
 #include "xlsx2data_common.h"
 #include "helper.h"
 
+namespace google::protobuf {
+
+class Message;
+class FieldDescriptor;
+
+}  // namespace google::protobuf
+
 namespace tpn {
 
 namespace xlsx {
@@ -79,6 +87,14 @@ class TPN_XLSX2DATA_API AnalystField {
   ///  @return 成功返回true
   bool GenerateProtoData(Printer &printer, size_t index);
 
+  /// 生成protobuf消息数据
+  /// 通过反射直接写入行消息，与json数据规则一致
+  ///  @param[in]   row_message   行消息
+  ///  @param[in]   data          要解析的数据
+  ///  @return 成功返回true
+  bool GenerateProtoMessage(google::protobuf::Message &row_message,
+                            std::string_view data);
+
   /// 生成cpp头文件方法声明
   ///  @param[in]   field_keys      字段key集合
   ///  @param[in]   field_comments  字段key注释
@@ -90,6 +106,33 @@ class TPN_XLSX2DATA_API AnalystField {
   ///  @return 是返回true
   bool IsCppFieldKeys();
 
+  /// 生成平坦数据
+  ///  @param[in]   writer        平坦数据写入器 字符串写入字符串池
+  ///  @param[in]   row           行数据起始地址
+  ///  @param[in]   data          要解析的数据
+  ///  @return 成功返回true
+  bool GenerateFlatData(FlatDataWriter &writer, uint8_t *row,
+                        std::string_view data);
+
+  /// 比较平坦数据中的字段
+  ///  @param[in]   writer        平坦数据写入器 用来获取字符串
+  ///  @param[in]   lhs           行数据起始地址
+  ///  @param[in]   rhs           行数据起始地址
+  ///  @return 小于返回负数 等于返回0 大于返回正数
+  int CompareFlatData(const FlatDataWriter &writer, const uint8_t *lhs,
+                      const uint8_t *rhs) const;
+
+  /// 合并平坦数据中的字符串到目标字符串池
+  ///  @param[in]   writer        目标平坦数据写入器
+  ///  @param[in]   source        行数据所属的平坦数据写入器
+  ///  @param[in]   row           行数据起始地址
+  void MergeFlatData(FlatDataWriter &writer, const FlatDataWriter &source,
+                     uint8_t *row) const;
+
+  /// 设置平坦数据中的字段偏移
+  ///  @param[in]   offset        行内偏移
+  void SetFlatOffset(size_t offset);
+
   /// 获取字段名
   ///  @return 字段名
   std::string_view GetName();
@@ -175,6 +218,36 @@ class TPN_XLSX2DATA_API AnalystField {
   bool GenerateProtoData(Printer &printer, XlsxDataType type,
                          std::string_view name, size_t index);
 
+  /// 生成protobuf消息数据
+  ///  @param[in]   message         消息
+  ///  @param[in]   type            类型
+  ///  @param[in]   name            要解析的字段名
+  ///  @param[in]   data            要解析的数据
+  ///  @return 成功返回true
+  bool GenerateProtoMessage(google::protobuf::Message &message,
+                            XlsxDataType type, std::string_view name,
+                            std::string_view data);
+
+  /// 生成protobuf消息数据 复合对象
+  ///  @param[in]   message         对象消息
+  ///  @param[in]   data            要解析的数据
+  ///  @param[in]   delimiter       分隔符
+  ///  @return 成功返回true
+  bool GenerateProtoMessageComplexObj(google::protobuf::Message &message,
+                                      std::string_view data,
+                                      std::string_view delimiter);
+
+  /// 生成protobuf消息数据 复合对象数组
+  ///  @param[in]   message           数组字段所属消息
+  ///  @param[in]   field             数组字段
+  ///  @param[in]   data              要解析的数据
+  ///  @param[in]   delimiter_index   分隔符位置
+  ///  @return 成功返回true
+  bool GenerateProtoMessageComplexArr(
+      google::protobuf::Message &message,
+      const google::protobuf::FieldDescriptor *field, std::string_view data,
+      size_t delimiter_index = 0);
+
  private:
   std::string name_;                                    ///< 字段名
   XlsxDataType type_{XlsxDataType::kXlsxDataTypeNone};  ///< 字段类型
@@ -184,6 +257,7 @@ class TPN_XLSX2DATA_API AnalystField {
       XlsxDataExportType::kXlsxDataExportTypeBoth};  ///< 导出类型
   AnalystComplexField
       complex_field_;  ///< 复合类型字段，只有当type_为kXlsxDataTypeComplexObj或者kXlsxDataTypeComplexArr生效
+  size_t flat_offset_{0};  ///< 平坦数据行内偏移
 };
 
 /// 分析表
@@ -218,6 +292,14 @@ class TPN_XLSX2DATA_API AnalystSheet {
   ///  @return 成功返回true
   bool GenerateProtoData(Printer &printer, size_t index);
 
+  /// 生成protobuf消息数据
+  ///  @param[in]   row_message   行消息
+  ///  @param[in]   index         数据表中下标
+  ///  @param[in]   data          要解析的数据
+  ///  @return 成功返回true
+  bool GenerateProtoMessage(google::protobuf::Message &row_message,
+                            size_t index, std::string_view data);
+
   /// 生成cpp头文件方法声明
   ///  @param[in]   printer       打印器
   ///  @return 成功返回true
@@ -231,6 +313,51 @@ class TPN_XLSX2DATA_API AnalystSheet {
   bool GenerateCppSourceData(Printer &printer, Printer &init_printer,
                              bool init_flag);
 
+  /// 生成平坦数据行布局
+  /// 字段按自然对齐依次排列，行大小按最大对齐向上取整，与编译器结构体布局一致
+  void GenerateFlatLayout();
+
+  /// 获取平坦数据行大小
+  ///  @return 行大小
+  size_t GetFlatRowSize() const;
+
+  /// 生成平坦数据
+  ///  @param[in]   writer        平坦数据写入器
+  ///  @param[in]   row           行数据起始地址
+  ///  @param[in]   index         数据表中下标
+  ///  @param[in]   data          要解析的数据
+  ///  @return 成功返回true
+  bool GenerateFlatData(FlatDataWriter &writer, uint8_t *row, size_t index,
+                        std::string_view data);
+
+  /// 按主键比较平坦数据行
+  ///  @param[in]   writer        平坦数据写入器
+  ///  @param[in]   lhs           行数据起始地址
+  ///  @param[in]   rhs           行数据起始地址
+  ///  @return 小于返回负数 等于返回0 大于返回正数
+  int CompareFlatRow(const FlatDataWriter &writer, const uint8_t *lhs,
+                     const uint8_t *rhs);
+
+  /// 合并平坦数据行中的字符串到目标字符串池
+  ///  @param[in]   writer        目标平坦数据写入器
+  ///  @param[in]   source        行数据所属的平坦数据写入器
+  ///  @param[in]   row           行数据起始地址
+  void MergeFlatRow(FlatDataWriter &writer, const FlatDataWriter &source,
+                    uint8_t *row) const;
+
+  /// 生成cpp头文件平坦数据行结构与方法声明
+  ///  @param[in]   printer       打印器
+  ///  @return 成功返回true
+  bool GenerateCppFlatHeadData(Printer &printer);
+
+  /// 生成cpp源文件平坦数据方法实现
+  ///  @param[in]   printer       打印器
+  ///  @param[in]   load_printer  LoadFlat函数打印器
+  ///  @param[in]   reset_printer ResetFlat函数打印器
+  ///  @return 成功返回true
+  bool GenerateCppFlatSourceData(Printer &printer, Printer &load_printer,
+                                 Printer &reset_printer);
+
   /// 获取表名
   ///  @return 表名
   std::string_view GetSheetTitle() const;
@@ -242,6 +369,7 @@ class TPN_XLSX2DATA_API AnalystSheet {
  private:
   std::string sheet_title_;           ///< 表名
   std::vector<AnalystField> fields_;  ///< 字段
+  size_t flat_row_size_{0};           ///< 平坦数据行大小
 };
 
 /// 分析器
@@ -276,6 +404,16 @@ class TPN_XLSX2DATA_API Analyst {
   bool GenerateProtoData(Printer &printer, std::string_view sheet_title,
                          size_t index);
 
+  /// 生成protobuf消息数据
+  ///  @param[in]   row_message   行消息
+  ///  @param[in]   sheet_title   要解析的工作表名
+  ///  @param[in]   index         数据表中下标
+  ///  @param[in]   data          要解析的数据
+  ///  @return 成功返回true
+  bool GenerateProtoMessage(google::protobuf::Message &row_message,
+                            std::string_view sheet_title, size_t index,
+                            std::string_view data);
+
   /// 生成cpp头文件方法声明
   ///  @param[in]   printer       打印器
   ///  @param[in]   sheet_title   要解析的工作表名
@@ -291,6 +429,55 @@ class TPN_XLSX2DATA_API Analyst {
   bool GenerateCppSourceData(Printer &printer, Printer &init_printer,
                              bool init_flag, std::string_view sheet_title);
 
+  /// 获取平坦数据行大小
+  ///  @param[in]   sheet_title   要解析的工作表名
+  ///  @return 行大小
+  size_t GetFlatRowSize(std::string_view sheet_title);
+
+  /// 生成平坦数据
+  ///  @param[in]   writer        平坦数据写入器
+  ///  @param[in]   row           行数据起始地址
+  ///  @param[in]   sheet_title   要解析的工作表名
+  ///  @param[in]   index         数据表中下标
+  ///  @param[in]   data          要解析的数据
+  ///  @return 成功返回true
+  bool GenerateFlatData(FlatDataWriter &writer, uint8_t *row,
+                        std::string_view sheet_title, size_t index,
+                        std::string_view data);
+
+  /// 按主键比较平坦数据行
+  ///  @param[in]   writer        平坦数据写入器
+  ///  @param[in]   sheet_title   要解析的工作表名
+  ///  @param[in]   lhs           行数据起始地址
+  ///  @param[in]   rhs           行数据起始地址
+  ///  @return 小于返回负数 等于返回0 大于返回正数
+  int CompareFlatRow(const FlatDataWriter &writer, std::string_view sheet_title,
+                     const uint8_t *lhs, const uint8_t *rhs);
+
+  /// 合并平坦数据行中的字符串到目标字符串池
+  ///  @param[in]   writer        目标平坦数据写入器
+  ///  @param[in]   source        行数据所属的平坦数据写入器
+  ///  @param[in]   sheet_title   要解析的工作表名
+  ///  @param[in]   row           行数据起始地址
+  void MergeFlatRow(FlatDataWriter &writer, const FlatDataWriter &source,
+                    std::string_view sheet_title, uint8_t *row);
+
+  /// 生成cpp头文件平坦数据行结构与方法声明
+  ///  @param[in]   printer       打印器
+  ///  @param[in]   sheet_title   要解析的工作表名
+  ///  @return 成功返回true
+  bool GenerateCppFlatHeadData(Printer &printer, std::string_view sheet_title);
+
+  /// 生成cpp源文件平坦数据方法实现
+  ///  @param[in]   printer       打印器
+  ///  @param[in]   load_printer  LoadFlat函数打印器
+  ///  @param[in]   reset_printer ResetFlat函数打印器
+  ///  @param[in]   sheet_title   要解析的工作表名
+  ///  @return 成功返回true
+  bool GenerateCppFlatSourceData(Printer &printer, Printer &load_printer,
+                                 Printer &reset_printer,
+                                 std::string_view sheet_title);
+
  private:
   /// 分析字段
   /// 字段会追加到之前分析的表 fields_中
@@ -22,6 +22,9 @@
 
 #include "helper.h"
 
+#include <fstream>
+#include <vector>
+
 #include "generator_hub.h"
 
 namespace tpn {
@@ -32,6 +35,10 @@ namespace {
 
 static constexpr std::string_view s_formatter_char = " ";  // 缩进方式
 
+static constexpr uint64_t s_fnv_offset_basis = 14695981039346656037ULL;
+static constexpr uint64_t s_fnv_prime        = 1099511628211ULL;
+static constexpr size_t s_hash_buffer_size   = 64 * 1024;
+
 }  // namespace
 
 bool WorkBookIsOutput(std::string_view file_name) {
@@ -87,6 +94,27 @@ std::string LowercaseFirstLetter(std::string_view strv) {
   return ret;
 }
 
+bool GetFileHash(std::string_view path, uint64_t &hash) {
+  std::ifstream file(std::string(path.data(), path.length()),
+                     std::ios::in | std::ios::binary);
+  if (!file) {
+    return false;
+  }
+
+  hash = s_fnv_offset_basis;
+  std::vector<char> buf(s_hash_buffer_size);
+  while (file) {
+    file.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+    auto count = static_cast<size_t>(file.gcount());
+    for (size_t i = 0; i < count; ++i) {
+      hash ^= static_cast<uint8_t>(buf[i]);
+      hash *= s_fnv_prime;
+    }
+  }
+
+  return file.eof();
+}
+
 Printer::Printer() {}
 
 Printer::~Printer() {}
@@ -23,6 +23,7 @@
 #ifndef TYPHOON_ZERO_TPN_TOOLS_XLSX2DATA_TPN_XLSX_UTILITY_HELPER_H_
 #define TYPHOON_ZERO_TPN_TOOLS_XLSX2DATA_TPN_XLSX_UTILITY_HELPER_H_
 
+#include <cstdint>
 #include <string>
 #include <string_view>
 
@@ -68,6 +69,12 @@ TPN_XLSX2DATA_API std::string CapitalizeFirstLetter(std::string_view strv);
 ///  @return 转换后的字符串
 TPN_XLSX2DATA_API std::string LowercaseFirstLetter(std::string_view strv);
 
+/// 计算文件内容哈希 FNV-1a 64位
+///  @param[in]   path      文件路径
+///  @param[out]  hash      哈希值
+///  @return 成功返回true
+TPN_XLSX2DATA_API bool GetFileHash(std::string_view path, uint64_t &hash);
+
 /// 格式控制
 class TPN_XLSX2DATA_API Printer {
  public:
@@ -26,6 +26,7 @@
 #include <unordered_map>
 
 #include "debug_hub.h"
+#include "flat_data.h"
 #include "helper.h"
 
 namespace tpn {
@@ -284,6 +285,58 @@ std::string GetCppTypeByType(XlsxDataType type) {
   return std::move(ret);
 }
 
+std::string GetCppFlatTypeByType(XlsxDataType type) {
+  switch (type) {
+    case XlsxDataType::kXlsxDataTypeStr:
+    case XlsxDataType::kXlsxDataTypeComplexObj:
+    case XlsxDataType::kXlsxDataTypeComplexArr: {
+      return "FlatDataStr";
+    } break;
+    default: {
+      return GetCppTypeByType(type);
+    } break;
+  }
+}
+
+size_t GetFlatSizeByType(XlsxDataType type) {
+  switch (type) {
+    case XlsxDataType::kXlsxDataTypeDouble:
+    case XlsxDataType::kXlsxDataTypeI64:
+    case XlsxDataType::kXlsxDataTypeU64: {
+      return 8;
+    } break;
+    case XlsxDataType::kXlsxDataTypeFloat:
+    case XlsxDataType::kXlsxDataTypeI32:
+    case XlsxDataType::kXlsxDataTypeU32: {
+      return 4;
+    } break;
+    case XlsxDataType::kXlsxDataTypeBool: {
+      return 1;
+    } break;
+    case XlsxDataType::kXlsxDataTypeStr:
+    case XlsxDataType::kXlsxDataTypeComplexObj:
+    case XlsxDataType::kXlsxDataTypeComplexArr: {
+      return sizeof(FlatDataStr);
+    } break;
+    default: {
+      return 0;
+    } break;
+  }
+}
+
+size_t GetFlatAlignByType(XlsxDataType type) {
+  switch (type) {
+    case XlsxDataType::kXlsxDataTypeStr:
+    case XlsxDataType::kXlsxDataTypeComplexObj:
+    case XlsxDataType::kXlsxDataTypeComplexArr: {
+      return alignof(FlatDataStr);
+    } break;
+    default: {
+      return GetFlatSizeByType(type);
+    } break;
+  }
+}
+
 std::string_view GetCppDataHubMgrName() { return s_cpp_data_hub_mgr; }
 
 std::string_view GetCppDataHubMgrNameWithArea() {
@@ -148,6 +148,22 @@ TPN_XLSX2DATA_API bool IsCppKeyType(XlsxDataType type);
 ///  @return 返回cpp对应的内部自定义类型
 TPN_XLSX2DATA_API std::string GetCppTypeByType(XlsxDataType type);
 
+/// 根据类型获取平坦数据中的cpp类型
+/// 字符串与复合类型均以字符串引用保存
+///  @param[in]   type            类型
+///  @return 返回平坦数据对应的cpp类型
+TPN_XLSX2DATA_API std::string GetCppFlatTypeByType(XlsxDataType type);
+
+/// 根据类型获取平坦数据中的字段大小
+///  @param[in]   type            类型
+///  @return 字段大小 不导出的类型返回0
+TPN_XLSX2DATA_API size_t GetFlatSizeByType(XlsxDataType type);
+
+/// 根据类型获取平坦数据中的字段对齐
+///  @param[in]   type            类型
+///  @return 字段对齐 不导出的类型返回0
+TPN_XLSX2DATA_API size_t GetFlatAlignByType(XlsxDataType type);
+
 /// 获取cpp文件的管理器名称
 //   @return cpp文件的管理器名称
 TPN_XLSX2DATA_API std::string_view GetCppDataHubMgrName();